@@ -12,6 +12,16 @@
 #import "BugSplatTestSupport.h"
 #import "BugSplatUploadService.h"
 #import "BugSplatHangTracker.h"
+#import "BugSplatWatchdog.h"
+#import "BugSplatLaunchState.h"
+#import "BugSplatCPUMonitor.h"
+#import "BugSplatLaunchTimeline.h"
+
+@class BugSplatHangReportSlot;
+@class BugSplatLogRingFile;
+@class BugSplatLatencyHistogramFile;
+@class BugSplatLaunchStateFile;
+@class BugSplatResourceRingFile;
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -19,12 +29,50 @@ NS_ASSUME_NONNULL_BEGIN
  * Class extension to expose private methods for testing.
  * These methods are implemented in the main BugSplat class.
  */
-@interface BugSplat () <BugSplatHangTrackerDelegate>
+@interface BugSplat () <BugSplatHangTrackerDelegate, BugSplatWatchdogDelegate, BugSplatCPUMonitorDelegate>
 
 - (BOOL)shouldSendCrashSilently:(NSDictionary *)metadata;
 - (NSString *)resolvedApplicationName;
 - (NSString *)resolvedApplicationVersion;
 - (nullable NSString *)crashesDirectoryPath;
+- (nullable NSData *)crashReportDataForFilename:(NSString *)crashFilename;
+- (void)persistCrashReportData:(NSData *)crashData;
+- (nullable NSString *)stageRawCrashReportData:(NSData *)crashData;
+- (void)reserveHangReportSlot;
+- (void)recoverReservedHangReport;
+- (nullable BugSplatHangReportSlot *)hangReportSlot;
+- (void)updateCrashReporterCustomData;
+- (void)openLogBuffer;
+- (nullable NSString *)logBufferPath;
+- (nullable NSData *)previousSessionLog;
+- (nullable BugSplatLogRingFile *)logRingFile;
+- (void)openLatencyHistogram;
+- (nullable NSString *)latencyHistogramPath;
+- (nullable BugSplatLatencyHistogramFile *)latencyHistogramFile;
+- (nullable NSDictionary<NSString *, NSString *> *)previousSessionLatencyAttributes;
+- (void)openResourceSamples;
+- (nullable NSString *)resourceSamplesPath;
+- (nullable BugSplatResourceRingFile *)resourceRingFile;
+- (nullable NSData *)previousSessionResources;
+- (void)openLaunchState;
+- (nullable NSString *)launchStatePath;
+- (nullable BugSplatLaunchStateFile *)launchStateFile;
+- (void)queuePreviousSessionTerminationReport;
+- (BOOL)queueTerminationReportForState:(const BugSplatLaunchState *)state termination:(BugSplatTermination)termination;
+- (void)startCPUMonitoringIfEnabled;
+- (nullable BugSplatCPUMonitor *)cpuMonitor;
+- (nullable NSString *)persistCPUReportWithUsage:(double)usage
+                                          budget:(double)budget
+                                            span:(NSTimeInterval)span
+                                  hottestThreads:(NSArray<BugSplatCPUThreadUsage *> *)threads;
+- (void)beginLaunchMonitoringWithTimeline:(BugSplatLaunchTimeline *)timeline;
+- (nullable BugSplatLaunchTimeline *)launchTimeline;
+- (void)launchReachedMark:(BugSplatLaunchMark)mark;
+- (void)sampleSlowLaunch;
+- (nullable NSString *)launchCrashMarkerPath;
+- (void)beginLaunchCrashDetection;
+- (NSUInteger)launchCrashCount;
+- (BOOL)uploadLaunchCrashReportSynchronously;
 
 @end
 
@@ -88,7 +136,7 @@ NS_ASSUME_NONNULL_BEGIN
 #pragma mark - Hang Detection Testing
 
 /**
- * Create the internal plumbing (serial queue, launch id) that `-start` would
+ * Create the internal plumbing (serial queue, launch id, snapshot buffer) that `-start` would
  * normally set up for hang detection. Lets tests exercise the hang delegate
  * methods without starting the real tracker or enabling the crash reporter.
  */
@@ -101,6 +149,19 @@ NS_ASSUME_NONNULL_BEGIN
 /// The basename of the hang report most recently persisted by the hang delegate.
 - (nullable NSString *)currentHangFilename;
 
+/// The basename of the hang report persisted for a stalled watchdog target; waits for the hang queue.
+- (nullable NSString *)hangFilenameForTargetNamed:(NSString *)name;
+
+/// Hang cause attributes (category, innermost app frame) for `thread`'s current backtrace.
+- (NSDictionary<NSString *, NSString *> *)hangCauseAttributesForThread:(mach_port_t)thread;
+
+#pragma mark - Asynchronous Start Testing
+
+/// Serial queue that asynchronous `-start` ingests and drains crash reports on;
+/// `dispatch_sync` on this queue to wait for that work to finish. Nil until `-start`
+/// runs with `startAsynchronously` set.
+- (nullable dispatch_queue_t)ingestQueueForTesting;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -18,6 +18,8 @@ FOUNDATION_EXPORT const unsigned char BugSplatVersionString[];
 #import <BugSplat/BugSplatDelegate.h>
 #import <BugSplat/BugSplatAttachment.h>
 #import <BugSplat/BugSplatFeedbackResult.h>
+#import <BugSplat/BugSplatLogBuffer.h>
+#import <BugSplat/BugSplatHangHeartbeat.h>
 #if TARGET_OS_OSX
 #import <BugSplat/BugSplatMac.h>
 #endif
@@ -31,6 +33,26 @@ NS_ASSUME_NONNULL_BEGIN
 
 @protocol BugSplatDelegate;
 
+/// Severity of the SDK's own diagnostic messages. Each level includes the ones before it.
+typedef NS_ENUM(NSInteger, BugSplatLogLevel) {
+    BugSplatLogLevelNone = 0,
+    BugSplatLogLevelError = 1,
+    BugSplatLogLevelWarning = 2,
+    BugSplatLogLevelInfo = 3,
+    BugSplatLogLevelDebug = 4,
+};
+
+/// Receives the SDK's diagnostic messages, without a "BugSplat:" prefix. Called on the logging thread.
+typedef void (^BugSplatLogHandler)(BugSplatLogLevel level, NSString *message);
+
+/// How hang detection observes the main thread.
+typedef NS_ENUM(NSInteger, BugSplatHangDetectionMode) {
+    /// A watchdog thread periodically dispatches a block to the main queue and counts unanswered ones.
+    BugSplatHangDetectionModePing = 0,
+    /// The main run loop records a heartbeat timestamp that the watchdog reads; see `hangDetectionMode`.
+    BugSplatHangDetectionModeHeartbeat = 1,
+};
+
 @interface BugSplat : NSObject
 
 /*!
@@ -45,6 +67,28 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (void)start;
 
+/**
+ * Most verbose level of the SDK's own diagnostic messages that is logged.
+ *
+ * Messages below this level are skipped before they are formatted. `BugSplatLogLevelDebug`
+ * messages (every pipeline step, attachment and file cleanup) are only compiled into builds
+ * with `DEBUG` set - or with `BUGSPLAT_LOG_DEBUG=1` - and are dropped from release builds
+ * regardless of this setting. `BugSplatLogLevelInfo` adds one line per start, persisted report
+ * and upload.
+ *
+ * Default: BugSplatLogLevelWarning
+ */
+@property (class, nonatomic, assign) BugSplatLogLevel logLevel;
+
+/**
+ * Route the SDK's diagnostic messages to the host app's logger instead of the unified
+ * logging system (subsystem `com.bugsplat`). Only messages that pass `logLevel` are delivered.
+ * Set to nil to restore the default.
+ *
+ * Default: nil
+ */
+@property (class, nonatomic, copy, nullable) BugSplatLogHandler logHandler;
+
 /**
  * Set the delegate
  *
@@ -182,10 +226,21 @@ NS_ASSUME_NONNULL_BEGIN
  * with `bugsplat-hang-` (duration, detection time, app state, launch id) that can be used
  * to correlate with crashes from the same launch.
  *
+ * Hang reports are also classified by what the hung thread is waiting in:
+ * `bugsplat-hang-category` is one of `mutex`, `semaphore`, `condition-wait`, `dispatch-sync`,
+ * `file-io`, `socket-io`, `sqlite`, `xpc-sync`, `ipc`, `sleep`, `idle`, `busy` (running app
+ * code) or `unknown`, and `bugsplat-hang-app-frame` names the innermost frame in the app's own
+ * code as `<image>+0x<offset>`. Hangs recorded into reserved storage (`reserveHangReportStorage`)
+ * carry the same cause attributes once they are queued on the next launch.
+ *
  * Detection is suppressed when a debugger is attached or the app is not active. As a
  * consequence, hangs that begin while the app is in the background (including those
  * terminated by background-task expiration) are not reported.
  *
+ * The watchdog polls less often while the main thread answers quickly (down to twice per
+ * threshold), returns to five polls per threshold as soon as it slows, and does not wake
+ * at all while the app is inactive.
+ *
  * This property is a no-op inside app extensions.
  *
  * When this property is YES, `-start` must be invoked on the main thread - the
@@ -209,6 +264,481 @@ NS_ASSUME_NONNULL_BEGIN
  */
 @property (nonatomic, assign) NSTimeInterval hangDetectionThreshold;
 
+/**
+ * How the main thread is observed when `enableHangDetection` is YES.
+ *
+ * `BugSplatHangDetectionModeHeartbeat` installs a main run-loop observer that records a
+ * monotonic timestamp on every loop pass and marks the loop idle while it waits for events.
+ * The watchdog only reads that timestamp: nothing is dispatched to the main queue, the
+ * watchdog wakes about once per threshold instead of two to five times, and the reported hang
+ * duration is the exact time since the loop last made progress. Apps whose main thread runs
+ * its own loop instead of the run loop call `BugSplatHangHeartbeatTick` once per iteration
+ * and `BugSplatHangHeartbeatIdle` before blocking for input (see BugSplatHangHeartbeat.h).
+ *
+ * Must be set before `-start` is invoked.
+ *
+ * Default: BugSplatHangDetectionModePing
+ */
+@property (nonatomic, assign) BugSplatHangDetectionMode hangDetectionMode;
+
+/**
+ * Profile the main thread while it is stalled, so hang reports show where the time went
+ * rather than only where the main thread was when the hang was declared.
+ *
+ * Once the main thread has been unresponsive for half of `hangDetectionThreshold`, its stack
+ * is sampled every 10 ms until it recovers or the hang is declared. The samples are merged into
+ * a call tree attached to the hang report as `BugSplatHangProfile.txt`: a `samples <n>` line,
+ * then one line per frame - depth, samples through the frame, samples ending in it, and
+ * `image+offset` (plus the nearest symbol when one is known) - heaviest paths first.
+ *
+ * Hangs recorded into reserved storage (`reserveHangReportStorage`) carry the profile too; it is
+ * attached when the record is queued on the next launch.
+ * Has no effect unless `enableHangDetection` is YES. Must be set before `-start` is invoked.
+ *
+ * Default: NO
+ */
+@property (nonatomic, assign) BOOL enableHangSampling;
+
+/**
+ * Record how responsive the main thread is across the whole session, not just whether it hung.
+ *
+ * Every main-thread latency the hang detector observes goes into a fixed-size histogram
+ * (about 7 KB, within 1.6%): each ping round trip, or in heartbeat mode each run-loop stretch
+ * between waits. The histogram lives in a memory-mapped file, so it survives a crash. Crash and
+ * hang reports carry the session's `bugsplat-latency-count`, `-p50-ms`, `-p90-ms`, `-p99-ms`
+ * and `-max-ms` attributes; the current session's values are available from
+ * `mainThreadLatencyAtPercentile:`.
+ *
+ * Has no effect unless `enableHangDetection` is YES. Must be set before `-start` is invoked.
+ *
+ * Default: NO
+ */
+@property (nonatomic, assign) BOOL enableLatencyHistogram;
+
+/// Number of main-thread latencies recorded this session (see `enableLatencyHistogram`).
+@property (nonatomic, readonly) NSUInteger mainThreadLatencySampleCount;
+
+/**
+ * Main-thread latency at `percentile` (0-100) this session, e.g. 50 for the median, 99 for
+ * p99 and 100 for the maximum. 0 when nothing has been recorded.
+ */
+- (NSTimeInterval)mainThreadLatencyAtPercentile:(double)percentile;
+
+/**
+ * Attach the last few minutes of the app's resource usage to crash, hang and feedback reports.
+ *
+ * The hang detector's watchdog thread samples the process every `resourceSampleInterval` -
+ * memory footprint, CPU time, thread count and open file descriptors - into a fixed ring of
+ * the last 64 samples in a memory-mapped file, so the samples survive a crash. Sampling rides
+ * on the watchdog's existing wakeups and costs a few tens of microseconds per sample. Reports
+ * carry the samples as `BugSplatResources.csv` (time, footprint in MB, CPU use as a percentage
+ * of one core, threads, file descriptors): the previous session's for a crash, fatal hang or
+ * termination it ended with, the current session's for a hang or feedback.
+ *
+ * Has no effect unless `enableHangDetection` is YES. Must be set before `-start` is invoked.
+ *
+ * Default: NO
+ */
+@property (nonatomic, assign) BOOL enableResourceSampling;
+
+/**
+ * Seconds between resource samples when `enableResourceSampling` is YES. Samples are taken at
+ * the first watchdog wakeup due, so the spacing can stretch while the watchdog backs off, and
+ * sampling stops while it is parked (the app is inactive). Must be set before `-start`.
+ *
+ * Default: 5
+ */
+@property (nonatomic, assign) NSTimeInterval resourceSampleInterval;
+
+/**
+ * Report sustained high CPU use, such as a background thread spinning in a loop.
+ *
+ * A timer samples the CPU time of the process and of each of its threads every
+ * `cpuUsageWindow / 12` seconds (at least one). When the process has used more than
+ * `cpuUsageBudget` of one core on average over the last `cpuUsageWindow` seconds, a live
+ * report is queued with the busiest thread marked as crashed. The report's attributes give
+ * the usage, the budget, the window and the busiest threads with their share. Another report
+ * is made only after a full window back under budget, and at most `maxCPUReportsPerSession`
+ * times per session. Nothing is reported while a debugger is attached.
+ *
+ * Independent of `enableHangDetection`. Must be set before `-start` is invoked.
+ *
+ * Default: NO
+ */
+@property (nonatomic, assign) BOOL enableCPUMonitoring;
+
+/**
+ * Share of one core the app may use on average over `cpuUsageWindow` before it is reported,
+ * e.g. 0.8 for 80% of one core or 1.5 for one and a half cores. Must be set before `-start`.
+ *
+ * Default: 0.8
+ */
+@property (nonatomic, assign) double cpuUsageBudget;
+
+/**
+ * Seconds over which CPU use is averaged when `enableCPUMonitoring` is YES. Longer windows
+ * ignore bursts such as launch or a big import. Must be set before `-start`.
+ *
+ * Default: 60
+ */
+@property (nonatomic, assign) NSTimeInterval cpuUsageWindow;
+
+/**
+ * Most high-CPU reports queued per session; 0 for no limit. Must be set before `-start`.
+ *
+ * Default: 1
+ */
+@property (nonatomic, assign) NSUInteger maxCPUReportsPerSession;
+
+/**
+ * Report launches that take longer than `slowLaunchThreshold`, with a startup timeline.
+ *
+ * The timeline measures from the process start time the kernel recorded to `-start`, to the
+ * first block the main queue serves after `-start` (the hang detector's first ping when it
+ * runs in ping mode) and to `-markLaunchReady`. The launch ends at the ready mark when
+ * `waitsForLaunchReadyMark` is YES, otherwise at the first main-queue block. If the launch
+ * has not ended when the threshold passes, the main thread is sampled then. A launch that
+ * ends over the threshold is queued as a silent report with that sample, the timeline as
+ * `BugSplatLaunchTimeline.txt`, and attributes with each mark in milliseconds. The report's
+ * application version lets launch times be compared across releases.
+ *
+ * Launches the system prewarmed, and launches with a debugger attached, are not reported:
+ * their process start says nothing about how long the user waited. A launch that never
+ * ends is not reported either; if the watchdog kills it, `enableTerminationDetection`
+ * reports that. Must be set before `-start` is invoked, which should be as early in the
+ * launch as possible.
+ *
+ * Default: NO
+ */
+@property (nonatomic, assign) BOOL enableLaunchMonitoring;
+
+/**
+ * Seconds from process start after which a launch is reported as slow when
+ * `enableLaunchMonitoring` is YES. Must be set before `-start`.
+ *
+ * Default: 5
+ */
+@property (nonatomic, assign) NSTimeInterval slowLaunchThreshold;
+
+/**
+ * End the launch at `-markLaunchReady` rather than the first main-queue block. Set this when
+ * the app calls `-markLaunchReady` on every launch; otherwise launches are never measured to
+ * their end. Must be set before `-start`.
+ *
+ * Default: NO
+ */
+@property (nonatomic, assign) BOOL waitsForLaunchReadyMark;
+
+/**
+ * Mark the app ready to use, e.g. once its first screen has loaded its content. Records the
+ * ready mark of the startup timeline (see `enableLaunchMonitoring`); only the first call per
+ * launch counts, and calls before `-start` are ignored. Safe from any thread.
+ */
+- (void)markLaunchReady;
+
+/**
+ * Get the report of a crash during launch to BugSplat even when the app crashes on every launch.
+ *
+ * A launch that crashes within `launchCrashWindow` seconds of `-start` is a launch crash. A
+ * report queued the usual way after such a crash is uploaded in the background and is lost
+ * when the app crashes again before the upload finishes. After `launchCrashLoopThreshold`
+ * launch crashes in a row, `-start` enters safe mode instead: the newest crash is persisted
+ * without delegate attachments, the previous session's log or resource samples, or the
+ * delegate's application log, is never shown in a dialog, and is uploaded before `-start`
+ * returns, blocking for at most `launchCrashUploadTimeout` seconds. Other queued reports wait
+ * for a launch that does not crash. The report carries a `bugsplat-launch-crash-count`
+ * attribute. Applies in asynchronous start mode as well. Must be set before `-start`.
+ *
+ * Default: NO
+ */
+@property (nonatomic, assign) BOOL enableLaunchCrashSafeMode;
+
+/**
+ * Seconds after `-start` within which a crash counts as a launch crash when
+ * `enableLaunchCrashSafeMode` is YES. Must be set before `-start`.
+ *
+ * Default: 10
+ */
+@property (nonatomic, assign) NSTimeInterval launchCrashWindow;
+
+/**
+ * Launch crashes in a row that put `-start` in safe mode when `enableLaunchCrashSafeMode`
+ * is YES; at least 1. Must be set before `-start`.
+ *
+ * Default: 2
+ */
+@property (nonatomic, assign) NSUInteger launchCrashLoopThreshold;
+
+/**
+ * Longest time in seconds `-start` blocks to upload the newest crash in safe mode (see
+ * `enableLaunchCrashSafeMode`). Keep it well under the system's launch watchdog limit. Must
+ * be set before `-start`.
+ *
+ * Default: 5
+ */
+@property (nonatomic, assign) NSTimeInterval launchCrashUploadTimeout;
+
+/**
+ * YES when this launch's `-start` entered safe mode after repeated launch crashes (see
+ * `enableLaunchCrashSafeMode`).
+ */
+@property (nonatomic, readonly, getter=isInLaunchCrashSafeMode) BOOL inLaunchCrashSafeMode;
+
+/**
+ * Report a hang of a serial dispatch queue, e.g. a database or networking queue.
+ *
+ * Equivalent to `monitorTargetNamed:threshold:pingDispatcher:` with a dispatcher that
+ * `dispatch_async`s the ping onto `queue`. Only serial queues are meaningful: a concurrent
+ * queue services the ping on another thread and never appears hung. A queue is not bound
+ * to a thread, so its report has no crashed thread; it captures every thread instead.
+ */
+- (BOOL)monitorQueue:(dispatch_queue_t)queue name:(NSString *)name threshold:(NSTimeInterval)threshold;
+
+/**
+ * Report a hang of a worker thread, queue or custom event loop.
+ *
+ * All monitored targets share one watchdog thread (separate from the main-thread hang detector).
+ * It keeps one ping outstanding per target, handing it to `pingDispatcher` to run on the target -
+ * for a thread with its own loop, queue the block and run it on the next iteration. A target whose
+ * ping has not run after `threshold` seconds (at least 0.1) is reported like a main-thread hang:
+ * an `App Hang (Fatal)` report whose crashed thread is the thread that last ran one of the
+ * target's pings, with a `bugsplat-hang-target` attribute naming it. That assumes the pings
+ * always run on the same thread; for a dispatch queue use `monitorQueue:name:threshold:`. As on the main thread,
+ * the report is discarded if the target recovers, and nothing is reported while a debugger is
+ * attached.
+ *
+ * Can be called any time, independently of `enableHangDetection`; a no-op inside app extensions.
+ *
+ * @return NO if `name` is already monitored.
+ */
+- (BOOL)monitorTargetNamed:(NSString *)name
+                 threshold:(NSTimeInterval)threshold
+            pingDispatcher:(void (^)(dispatch_block_t ping))pingDispatcher;
+
+/// Stop monitoring a target added with `monitorQueue:name:threshold:` or `monitorTargetNamed:threshold:pingDispatcher:`.
+- (void)stopMonitoringTargetNamed:(NSString *)name;
+
+/**
+ * Reserve storage for a hang report when hang detection starts, instead of creating files
+ * when a hang is detected.
+ *
+ * When set to YES, a fixed-size file is created, sized and memory-mapped next to the crash
+ * queue as part of `-start`. A detected hang is then recorded by copying the live report
+ * and the crash-time metadata into that mapping - no files are created and the report is not
+ * formatted while the app is hung, so a hang that ends in a watchdog kill is still recorded.
+ * The record is converted into a regular queued report on the next launch. Hangs the app
+ * recovers from are discarded as before.
+ *
+ * Has no effect unless `enableHangDetection` is YES. Must be set before `-start` is invoked.
+ *
+ * Default: NO
+ */
+@property (nonatomic, assign) BOOL reserveHangReportStorage;
+
+/**
+ * Seconds the main thread must stay hung before a full hang report is captured.
+ *
+ * By default a full live report - every thread plus all loaded images - is generated and
+ * formatted as soon as a hang is detected, although most hangs recover shortly afterwards and
+ * their report is deleted again. Set this above `hangDetectionThreshold` to capture a hang in two
+ * tiers: at detection only the main thread's backtrace and the images it references are written
+ * as a small text report, which costs one stack walk and a few kilobytes of I/O. If the main
+ * thread is still hung after `hangReportEscalationThreshold` seconds, that report is replaced by
+ * the full one (in reserved storage when `reserveHangReportStorage` is YES). A hang that ends in a
+ * watchdog kill before then is reported with the main thread only.
+ *
+ * Has no effect unless `enableHangDetection` is YES. Must be set before `-start` is invoked.
+ *
+ * Default: 0 (full report at detection)
+ */
+@property (nonatomic, assign) NSTimeInterval hangReportEscalationThreshold;
+
+/**
+ * Move crash ingestion and pending-report processing off the thread that calls `-start`.
+ *
+ * When set to YES before `-start` is invoked, `-start` only reads the previous session's
+ * raw report (if any) into memory, enables crash capture and returns. Parsing and formatting
+ * that report, gathering delegate attachments and the application log, writing it to disk
+ * and draining the queue of pending reports then run on a private background queue.
+ * Crashes that occur during that work are captured, which is not the case in the default
+ * synchronous mode.
+ *
+ * In this mode the delegate methods `attachmentForBugSplat:`, `attachmentsForBugSplat:`,
+ * `applicationLogForBugSplat:`, `bugSplatWillShowSubmitCrashReportAlert:` and
+ * `bugSplatWillSendCrashReport:` (for reports sent without a dialog) are invoked on that
+ * background queue. Crash report dialogs are still presented, and upload results delivered,
+ * on the main thread.
+ *
+ * Default: NO
+ */
+@property (nonatomic, assign) BOOL startAsynchronously;
+
+/**
+ * Persist crash and hang reports as raw PLCrashReporter data and format them as text only
+ * when they are picked up for submission.
+ *
+ * By default a crash is formatted while it is ingested during `-start`, and a hang report is
+ * formatted as soon as the hang is detected - even though a hang the app recovers from is
+ * deleted again without ever being sent. With this property set to YES, that formatting is
+ * skipped; the report is formatted off the main thread right before it is shown or uploaded,
+ * and the formatted text is cached on disk so retries after a failed upload reuse it.
+ *
+ * When a deferred report is processed from the main thread, `bugSplatWillShowSubmitCrashReportAlert:`
+ * is invoked on a background queue.
+ *
+ * Must be set before `-start` is invoked.
+ *
+ * Default: NO
+ */
+@property (nonatomic, assign) BOOL deferCrashReportFormatting;
+
+/**
+ * Write smaller crash and hang reports.
+ *
+ * When set to YES, the text report lists only the binary images that contain at least one
+ * of its frames (plus the main executable), and threads other than the crashed thread and
+ * the main thread are cut to their innermost `slimmedThreadFrameLimit` frames. The crashed
+ * and main threads are always reported in full, and every frame that is reported can still
+ * be symbolicated.
+ *
+ * Applies when a report is formatted; with `deferCrashReportFormatting` that is when it is
+ * first picked up for submission.
+ *
+ * Default: NO
+ */
+@property (nonatomic, assign) BOOL slimCrashReports;
+
+/**
+ * Number of innermost frames kept for threads other than the crashed and main threads when
+ * `slimCrashReports` is YES. Zero keeps every frame.
+ *
+ * Default: 10
+ */
+@property (nonatomic, assign) NSUInteger slimmedThreadFrameLimit;
+
+/**
+ * Keep a crash-surviving log of recent app messages and attach it to the next report.
+ *
+ * When set to YES before `-start` is invoked, `-start` opens a fixed-size, memory-mapped
+ * log file next to the crash queue. Messages written with `BugSplatLogBufferWrite`,
+ * `BugSplatLogBufferWriteString` or `BugSplatLogBufferPrintf` (see BugSplatLogBuffer.h) are
+ * copied into it without locks or allocation, from any thread. Because the file is mapped,
+ * the messages survive a crash or watchdog kill; on the next launch the newest of them are
+ * attached as `BugSplatLog.txt` to the report of the crash (or fatal hang recorded with
+ * `reserveHangReportStorage`) that ended the previous session. The log then starts over.
+ *
+ * Unlike `applicationLogForBugSplat:`, which runs on the next launch, this captures what the
+ * crashed session logged.
+ *
+ * Default: NO
+ */
+@property (nonatomic, assign) BOOL enableLogBuffer;
+
+/**
+ * Size in bytes of the log buffer when `enableLogBuffer` is YES. Each message costs 16 bytes
+ * of framing plus its length rounded up to 8; when the buffer is full the oldest messages are
+ * overwritten. Messages longer than a quarter of the buffer are truncated.
+ *
+ * Must be set before `-start` is invoked.
+ *
+ * Default: 65536 (64 KB)
+ */
+@property (nonatomic, assign) NSUInteger logBufferSize;
+
+/**
+ * Report launches the system terminated without a crash report: out-of-memory kills and
+ * watchdog terminations.
+ *
+ * When set to YES before `-start` is invoked, each launch keeps a small memory-mapped record
+ * next to the crash queue: whether it exited normally, whether it was in the foreground, its
+ * memory footprint (sampled every few seconds and on memory pressure), the system memory
+ * pressure, whether the main thread was hung, and the app and OS versions. On the next launch
+ * the record is checked against the usual explanations - a crash report, a debugger, an app or
+ * OS update, a reboot. A launch none of them explains is reported as `Watchdog Termination
+ * (Inferred)` if its main thread was hung (this needs `enableHangDetection`), otherwise as
+ * `Out of Memory (Inferred)` if it was in the foreground. Terminations in the background are
+ * routine and not reported. The report carries `bugsplat-termination-reason`, `-app-state`,
+ * `-footprint-mb`, `-footprint-limit-mb`, `-peak-footprint-mb`, `-memory-pressure`,
+ * `-memory-warnings` and `-session-seconds` attributes, and is sent without a dialog.
+ *
+ * iOS and tvOS only; has no effect on macOS or in app extensions.
+ *
+ * Default: NO
+ */
+@property (nonatomic, assign) BOOL enableTerminationDetection;
+
+/**
+ * Merge repeated occurrences of the same crash into a single pending report.
+ *
+ * When YES, each new crash gets a signature computed from its exception type and the top
+ * frames of the faulting stack. If a report with the same signature is still waiting to be
+ * sent and its most recent occurrence is within `crashCoalescingWindow`, the new crash is
+ * folded into it rather than queued (and later uploaded, with attachments) on its own.
+ * The merged report carries the attributes `bugsplat-occurrence-count`,
+ * `bugsplat-first-occurrence` and `bugsplat-last-occurrence`.
+ *
+ * Intended for crash loops: the dashboard sees one report with an accurate count instead
+ * of one upload per launch. The report text and attachments are those of the first
+ * occurrence.
+ *
+ * Must be set before `-start` is invoked.
+ *
+ * Default: NO
+ */
+@property (nonatomic, assign) BOOL coalesceRepeatedCrashes;
+
+/**
+ * Maximum time in seconds between the last merged occurrence of a crash and a new one for
+ * `coalesceRepeatedCrashes` to merge them.
+ *
+ * Default: 3600 (one hour)
+ */
+@property (nonatomic, assign) NSTimeInterval crashCoalescingWindow;
+
+/**
+ * Maximum number of reports kept in the on-disk queue of reports waiting to be sent.
+ *
+ * Reports accumulate when uploads fail, e.g. on a device that is offline for a long time.
+ * When `-start` finds the queue over any of the `maximumPendingReport...` quotas, it deletes
+ * reports (with their attachments) until the queue fits: first those older than
+ * `maximumPendingReportAge`, then hang reports before crash reports and crash reports before
+ * ones the user submitted with comments, oldest first. The newest report is always kept.
+ * Evictions are counted in `reportsEvictedForAge`, `reportsEvictedForCount` and
+ * `reportsEvictedForSize`.
+ *
+ * Default: 0 (unlimited)
+ */
+@property (nonatomic, assign) NSUInteger maximumPendingReportCount;
+
+/**
+ * Maximum total size in bytes of queued reports, metadata and attachments.
+ *
+ * @see maximumPendingReportCount
+ *
+ * Default: 0 (unlimited)
+ */
+@property (nonatomic, assign) unsigned long long maximumPendingReportBytes;
+
+/**
+ * Maximum age in seconds of a queued report, measured from its (most recent) occurrence.
+ *
+ * Unlike `expirationTimeInterval` on macOS, which only skips the dialog, this deletes the report.
+ *
+ * @see maximumPendingReportCount
+ *
+ * Default: 0 (unlimited)
+ */
+@property (nonatomic, assign) NSTimeInterval maximumPendingReportAge;
+
+/// Number of queued reports deleted for exceeding `maximumPendingReportAge`, across all launches.
+@property (nonatomic, readonly) NSUInteger reportsEvictedForAge;
+
+/// Number of queued reports deleted for exceeding `maximumPendingReportCount`, across all launches.
+@property (nonatomic, readonly) NSUInteger reportsEvictedForCount;
+
+/// Number of queued reports deleted for exceeding `maximumPendingReportBytes`, across all launches.
+@property (nonatomic, readonly) NSUInteger reportsEvictedForSize;
+
 /**
  * Add an attribute and value to a dictionary of attributes that will potentially be included in a crash report.
  * If the attribute is an invalid XML entity name, or the attribute+value pair cannot be set,
@@ -253,6 +783,19 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (BOOL)setValue:(nullable NSString *)value forAttribute:(NSString *)attribute NS_SWIFT_NAME(set(_:for:));
 
+/**
+ * Set several attributes at once, with the same rules as `setValue:forAttribute:`.
+ * An `NSNull` value removes its attribute.
+ *
+ * Attributes may be set from any thread. Changes are written to the crash reporter shortly after
+ * they are made (about 100 ms), once for any number of changes in that interval, so a crash in
+ * that interval is reported with the attributes as they were before.
+ *
+ * @return NO if any entry had an empty attribute name or a value that is neither a string nor `NSNull`;
+ * the remaining entries are still applied.
+ */
+- (BOOL)setAttributes:(NSDictionary<NSString *, id> *)attributes NS_SWIFT_NAME(set(attributes:));
+
 /**
  * Submits user feedback (non-crash) to BugSplat.
  *
@@ -23,6 +23,24 @@
 #import "BugSplatTestSupport.h"
 #import "BugSplat+Testing.h"
 #import "BugSplatHangTracker.h"
+#import "BugSplatHangSampler.h"
+#import "BugSplatLatencyHistogramFile.h"
+#import "BugSplatLaunchStateFile.h"
+#import "BugSplatResourceRingFile.h"
+#import "BugSplatCPUMonitor.h"
+#import "BugSplatLaunchTimeline.h"
+#import "BugSplatWatchdog.h"
+#import "BugSplatHangSnapshot.h"
+#import "BugSplatHangClassifier.h"
+#import "BugSplatImageList.h"
+#import "BugSplatMetadataCodec.h"
+#import "BugSplatCrashSignature.h"
+#import "BugSplatCrashQueuePolicy.h"
+#import "BugSplatCrashReportTextWriter.h"
+#import "BugSplatAttributeStore.h"
+#import "BugSplatLogRingFile.h"
+#import "BugSplatHangReportSlot.h"
+#import "BugSplatLogging.h"
 
 #if TARGET_OS_OSX
 #import "BugSplatCrashReportWindow.h"
@@ -34,20 +52,188 @@
 NSString *const kBugSplatUserDefaultsUserName = @"com.bugsplat.userName";
 NSString *const kBugSplatUserDefaultsUserEmail = @"com.bugsplat.userEmail";
 NSString *const kBugSplatUserDefaultsAlwaysSend = @"com.bugsplat.alwaysSend";
+// Cumulative crash queue eviction counters
+NSString *const kBugSplatUserDefaultsEvictedForAge = @"com.bugsplat.reportsEvictedForAge";
+NSString *const kBugSplatUserDefaultsEvictedForCount = @"com.bugsplat.reportsEvictedForCount";
+NSString *const kBugSplatUserDefaultsEvictedForSize = @"com.bugsplat.reportsEvictedForSize";
 
 // File extensions for persisted crash data
 static NSString *const kBugSplatCrashFileExtension = @"crash";
+// Raw PLCrashReporter protobuf, persisted instead of .crash text when formatting is deferred.
+static NSString *const kBugSplatRawCrashFileExtension = @"plcrash";
 static NSString *const kBugSplatMetaFileExtension = @"meta";
 static NSString *const kBugSplatAttachmentFileExtension = @"data";
 
 // Suffix appended to hang-report filenames so they can be distinguished from crash filenames on disk.
 static NSString *const kBugSplatHangFilenameSuffix = @"-hang";
 
+// Reserved hang report slot, kept beside (not in) the crashes directory so the queue scanner ignores it.
+// A valid record from a previous launch is renamed to the pending name before the slot is reused.
+static NSString *const kBugSplatHangSlotFilename = @"HangReport.slot";
+static NSString *const kBugSplatHangSlotPendingFilename = @"HangReport.slot.pending";
+
+// Log buffer file, kept next to the Crashes directory, and the attachment made from it
+static NSString *const kBugSplatLogBufferFilename = @"Log.ring";
+static NSString *const kBugSplatLogAttachmentFilename = @"BugSplatLog.txt";
+
+// Hang sampling: stack samples start at this fraction of the hang threshold, taken at this interval.
+static const double kBugSplatHangSamplingStallFraction = 0.5;
+static const NSTimeInterval kBugSplatHangSamplingInterval = 0.01;
+static NSString *const kBugSplatHangProfileFilename = @"BugSplatHangProfile.txt";
+
+// Exception name hang reports are filed under, in both capture tiers.
+static NSString *const kBugSplatHangExceptionName = @"App Hang (Fatal)";
+// Deepest main-thread backtrace a first-tier hang snapshot keeps.
+static const NSUInteger kBugSplatHangSnapshotMaxFrames = 256;
+
+// Main-thread latency histogram file, kept next to the Crashes directory, and the attributes made from it
+static NSString *const kBugSplatLatencyHistogramFilename = @"Latency.hist";
+static NSString *const kBugSplatLatencyAttrCount = @"bugsplat-latency-count";
+static NSString *const kBugSplatLatencyAttrP50 = @"bugsplat-latency-p50-ms";
+static NSString *const kBugSplatLatencyAttrP90 = @"bugsplat-latency-p90-ms";
+static NSString *const kBugSplatLatencyAttrP99 = @"bugsplat-latency-p99-ms";
+static NSString *const kBugSplatLatencyAttrMax = @"bugsplat-latency-max-ms";
+
+// Resource samples, kept next to the Crashes directory, and the attachment made from them
+static NSString *const kBugSplatResourceSamplesFilename = @"Resources.ring";
+static NSString *const kBugSplatResourceAttachmentFilename = @"BugSplatResources.csv";
+static const size_t kBugSplatResourceSampleCapacity = 64;
+
+// Sustained high CPU reports and their attributes
+static NSString *const kBugSplatCPUFilenameSuffix = @"-cpu";
+static NSString *const kBugSplatCPUExceptionName = @"Excessive CPU Use";
+static NSString *const kBugSplatCPUAttrPercent = @"bugsplat-cpu-percent";
+static NSString *const kBugSplatCPUAttrBudgetPercent = @"bugsplat-cpu-budget-percent";
+static NSString *const kBugSplatCPUAttrWindowSeconds = @"bugsplat-cpu-window-seconds";
+static NSString *const kBugSplatCPUAttrHotThreads = @"bugsplat-cpu-hot-threads";
+// Busiest threads named in the hot threads attribute.
+static const NSUInteger kBugSplatCPUReportedThreadCount = 3;
+
+// Slow launch reports, their timeline attachment and attributes
+static NSString *const kBugSplatLaunchFilenameSuffix = @"-launch";
+static NSString *const kBugSplatLaunchExceptionName = @"Slow Launch";
+static NSString *const kBugSplatLaunchTimelineFilename = @"BugSplatLaunchTimeline.txt";
+static NSString *const kBugSplatLaunchAttrDuration = @"bugsplat-launch-duration-ms";
+static NSString *const kBugSplatLaunchAttrThreshold = @"bugsplat-launch-threshold-ms";
+static NSString *const kBugSplatLaunchAttrEnd = @"bugsplat-launch-end";
+// Time from process start to a mark, keyed by the mark's name, e.g. bugsplat-launch-ready-ms.
+static NSString *const kBugSplatLaunchAttrMarkFormat = @"bugsplat-launch-%@-ms";
+
+// Launch crash marker, kept next to the Crashes directory while a launch is within
+// launchCrashWindow of -start, holding how many launches before it crashed in a row
+static NSString *const kBugSplatLaunchCrashMarkerFilename = @"LaunchCrash.marker";
+static NSString *const kBugSplatLaunchCrashAttrCount = @"bugsplat-launch-crash-count";
+
+// Launch state sentinel, kept next to the Crashes directory, and the report inferred from it
+static NSString *const kBugSplatLaunchStateFilename = @"Launch.state";
+static NSString *const kBugSplatTerminationFilenameSuffix = @"-termination";
+static const NSTimeInterval kBugSplatLaunchStateSampleInterval = 5.0;
+static NSString *const kBugSplatTerminationAttrReason = @"bugsplat-termination-reason";
+static NSString *const kBugSplatTerminationAttrAppState = @"bugsplat-termination-app-state";
+static NSString *const kBugSplatTerminationAttrFootprint = @"bugsplat-termination-footprint-mb";
+static NSString *const kBugSplatTerminationAttrFootprintLimit = @"bugsplat-termination-footprint-limit-mb";
+static NSString *const kBugSplatTerminationAttrPeakFootprint = @"bugsplat-termination-peak-footprint-mb";
+static NSString *const kBugSplatTerminationAttrMemoryPressure = @"bugsplat-termination-memory-pressure";
+static NSString *const kBugSplatTerminationAttrMemoryWarnings = @"bugsplat-termination-memory-warnings";
+static NSString *const kBugSplatTerminationAttrSessionSeconds = @"bugsplat-termination-session-seconds";
+
 // Attribute keys attached to hang reports (and to crash reports sharing the same launch).
 static NSString *const kBugSplatHangAttrDurationMs = @"bugsplat-hang-duration-ms";
 static NSString *const kBugSplatHangAttrDetectedAt = @"bugsplat-hang-detected-at";
 static NSString *const kBugSplatHangAttrAppState = @"bugsplat-hang-app-state";
 static NSString *const kBugSplatHangAttrLaunchId = @"bugsplat-hang-launch-id";
+// Name of the monitored target (see monitorTargetNamed:) that hung; absent for the main thread.
+static NSString *const kBugSplatHangAttrTarget = @"bugsplat-hang-target";
+// Why the hung thread is blocked (see BugSplatHangClassifier.h), and its innermost app frame.
+static NSString *const kBugSplatHangAttrCategory = @"bugsplat-hang-category";
+static NSString *const kBugSplatHangAttrAppFrame = @"bugsplat-hang-app-frame";
+
+/// A hang's cause in fixed-size storage, so classifying a hang allocates nothing.
+typedef struct {
+    /// A BugSplatHangClassify category; NULL if the backtrace was empty.
+    const char *category;
+    /// Innermost frame in the app's own code as `<image>+0x<offset>`; empty if there is none.
+    char appFrame[128];
+} BugSplatHangCause;
+
+/// The app bundle's path with a trailing slash. Resolved once, when the hang queue is created.
+static const char *BugSplatAppBundlePrefix(void)
+{
+    static const char *prefix;
+    static dispatch_once_t once;
+    dispatch_once(&once, ^{
+        NSString *bundlePrefix = [[NSBundle mainBundle].bundlePath stringByAppendingString:@"/"];
+        prefix = strdup(bundlePrefix.fileSystemRepresentation ?: "/");
+    });
+    return prefix;
+}
+
+/**
+ * Classify a hung thread's backtrace (return addresses, innermost first) with the built-in
+ * rules: the blocking category, and the innermost frame in the app's own code - the main
+ * executable or anything else inside the app bundle. Frames are resolved through
+ * BugSplatImageList rather than dladdr, so this is safe while the hung thread holds the dyld
+ * lock, and it allocates nothing.
+ */
+static void BugSplatClassifyHangFrames(const uint64_t *addresses, size_t count, BugSplatHangCause *cause)
+{
+    cause->category = NULL;
+    cause->appFrame[0] = '\0';
+    count = MIN(count, kBugSplatHangSnapshotMaxFrames);
+    if (count == 0) {
+        return;
+    }
+    const char *appPrefix = BugSplatAppBundlePrefix();
+    size_t appPrefixLength = strlen(appPrefix);
+
+    BugSplatHangFrame frames[kBugSplatHangSnapshotMaxFrames];
+    memset(frames, 0, count * sizeof(BugSplatHangFrame));
+    BugSplatImage appImage = { 0 };
+    size_t resolved = 0;
+    while (resolved < count) {
+        // Return addresses point past the call; look up the call itself.
+        uint64_t address = resolved == 0 ? addresses[0] : addresses[resolved] - 1;
+        BugSplatImage image;
+        BugSplatHangFrame *frame = &frames[resolved++];
+        if (!BugSplatImageListFindAddress(address, &image)) {
+            continue;
+        }
+        frame->image = image.name;
+        frame->symbol = BugSplatImageFindSymbol(&image, address, NULL);
+        frame->isApp = strncmp(image.path, appPrefix, appPrefixLength) == 0;
+        if (frame->isApp) {
+            // Nothing beyond the innermost app frame is matched.
+            appImage = image;
+            break;
+        }
+    }
+
+    BugSplatHangClassification classification = BugSplatHangClassify(frames, resolved, BugSplatHangDefaultRules,
+                                                                      BugSplatHangDefaultRuleCount);
+    cause->category = classification.category;
+    if (classification.appFrame != BugSplatHangNoFrame) {
+        snprintf(cause->appFrame, sizeof(cause->appFrame), "%s+0x%llx", frames[classification.appFrame].image,
+                 addresses[classification.appFrame] - appImage.base);
+    }
+}
+
+/// `cause` as report attributes; empty if the backtrace was not classified.
+static NSDictionary<NSString *, NSString *> *BugSplatHangCauseAttributes(const BugSplatHangCause *cause)
+{
+    NSMutableDictionary<NSString *, NSString *> *attributes = [NSMutableDictionary dictionary];
+    if (cause->category) {
+        attributes[kBugSplatHangAttrCategory] = @(cause->category);
+    }
+    if (cause->appFrame[0] != '\0') {
+        attributes[kBugSplatHangAttrAppFrame] = @(cause->appFrame);
+    }
+    return attributes;
+}
+
+// Attribute keys attached to reports that repeated crashes were coalesced into.
+static NSString *const kBugSplatCoalesceAttrOccurrenceCount = @"bugsplat-occurrence-count";
+static NSString *const kBugSplatCoalesceAttrFirstOccurrence = @"bugsplat-first-occurrence";
+static NSString *const kBugSplatCoalesceAttrLastOccurrence = @"bugsplat-last-occurrence";
 
 // Keys for crash metadata
 static NSString *const kBugSplatMetaKeyUserName = @"userName";
@@ -63,24 +249,68 @@ static NSString *const kBugSplatMetaKeyApplicationName = @"applicationName";
 static NSString *const kBugSplatMetaKeyApplicationVersion = @"applicationVersion";
 static NSString *const kBugSplatMetaKeyAppKey = @"appKey";
 static NSString *const kBugSplatMetaKeyNotes = @"notes";
+// Crash coalescing
+static NSString *const kBugSplatMetaKeySignature = @"signature";
+static NSString *const kBugSplatMetaKeyOccurrenceCount = @"occurrenceCount";
+static NSString *const kBugSplatMetaKeyLastOccurrence = @"lastOccurrence";
+
+// Attribute changes within this interval share one crash reporter customData update
+static const NSTimeInterval kBugSplatCustomDataUpdateDelay = 0.1;
 
-@interface BugSplat () <BugSplatHangTrackerDelegate>
+@interface BugSplat () <BugSplatHangTrackerDelegate, BugSplatWatchdogDelegate, BugSplatCPUMonitorDelegate>
 
 @property (atomic, assign) BOOL isStartInvoked;
 @property (atomic, assign) BOOL sendingInProgress;
-@property (nonatomic, nullable) NSDictionary<NSString *, NSString *> *attributes;
+@property (nonatomic, strong) BugSplatAttributeStore *attributeStore;
+// Snapshot of attributeStore
+@property (nonatomic, readonly, nullable) NSDictionary<NSString *, NSString *> *attributes;
 @property (nonatomic, strong) id<BugSplatCrashReporterProtocol> crashReporterInternal;
 @property (nonatomic, strong, nullable) id<BugSplatCrashStorageProtocol> crashStorageInternal;
 @property (nonatomic, strong, nullable) id<BugSplatUserDefaultsProtocol> userDefaultsInternal;
 @property (nonatomic, strong, nullable) id<BugSplatBundleProtocol> bundleInternal;
 @property (nonatomic, strong, nullable) BugSplatUploadService *uploadService;
-@property (nonatomic, copy, nullable) NSString *currentCrashFilename;
+@property (atomic, copy, nullable) NSString *currentCrashFilename;
 @property (nonatomic, assign) BOOL isTestInstance;
 
 @property (nonatomic, strong, nullable) BugSplatHangTracker *hangTracker;
 @property (atomic, copy, nullable) NSString *currentHangFilename;
 @property (nonatomic, copy, nullable) NSString *launchId;
 @property (nonatomic, strong, nullable) dispatch_queue_t hangQueue;
+@property (nonatomic, strong, nullable) BugSplatHangReportSlot *hangReportSlot;
+@property (nonatomic, strong, nullable) BugSplatHangSampler *hangSampler;
+// First-tier hang capture when hangReportEscalationThreshold is set; hang queue only.
+@property (nonatomic, strong, nullable) BugSplatHangSnapshot *hangSnapshot;
+// Bumped on every main-thread hang and recovery, so a pending escalation can tell its hang ended; hang queue only.
+@property (nonatomic, assign) NSUInteger hangGeneration;
+@property (nonatomic, strong, nullable) BugSplatWatchdog *watchdog;
+// Persisted hang report per stalled watchdog target; hang queue only.
+@property (nonatomic, strong) NSMutableDictionary<NSString *, NSString *> *targetHangFilenames;
+@property (nonatomic, strong, nullable) BugSplatLatencyHistogramFile *latencyHistogramFile;
+// Latency attributes of the previous session, added to the report of the crash or hang that ended it.
+@property (nonatomic, copy, nullable) NSDictionary<NSString *, NSString *> *previousSessionLatencyAttributes;
+@property (nonatomic, strong, nullable) BugSplatLaunchStateFile *launchStateFile;
+// How the previous launch ended, inferred from its launch state when this launch's was opened.
+@property (nonatomic, assign) BugSplatTermination previousSessionTermination;
+// Footprint timer and memory pressure source feeding launchStateFile.
+@property (nonatomic, strong, nullable) dispatch_source_t launchStateTimer;
+@property (nonatomic, strong, nullable) dispatch_source_t memoryPressureSource;
+@property (nonatomic, strong, nullable) BugSplatLogRingFile *logRingFile;
+// Written only from the hang tracker's watchdog thread.
+@property (nonatomic, strong, nullable) BugSplatResourceRingFile *resourceRingFile;
+// Resource samples left by the previous session, attached to the report of how it ended.
+@property (atomic, strong, nullable) NSData *previousSessionResources;
+@property (nonatomic, strong, nullable) BugSplatCPUMonitor *cpuMonitor;
+@property (atomic, strong, nullable) BugSplatLaunchTimeline *launchTimeline;
+@property (nonatomic, assign, readwrite, getter=isInLaunchCrashSafeMode) BOOL inLaunchCrashSafeMode;
+// Launches in a row, ending with the previous one, that crashed within launchCrashWindow of -start.
+@property (nonatomic, assign) NSUInteger launchCrashCount;
+// Live report sampling the main thread when a launch passed the slow launch threshold; hang queue only.
+@property (nonatomic, strong, nullable) NSData *slowLaunchReportData;
+// Log buffer contents left by the previous session, attached to its crash or fatal hang.
+@property (atomic, strong, nullable) NSData *previousSessionLog;
+// Last customData blob handed to PLCrashReporter; copied into the hang slot as the hang's metadata.
+@property (atomic, strong, nullable) NSData *crashTimeMetadata;
+@property (nonatomic, strong, readonly) dispatch_queue_t ingestQueue;
 
 #if TARGET_OS_OSX
 @property (nonatomic, strong, nullable) BugSplatCrashReportWindow *crashReportWindow;
@@ -94,6 +324,10 @@ static NSString *const kBugSplatMetaKeyNotes = @"notes";
     NSString *_applicationName;
     NSString *_applicationVersion;
     NSNumber *_debuggerAttachedOverride;
+    dispatch_queue_t _ingestQueue;
+
+    // Set while a debounced customData update is scheduled; see scheduleCrashReporterCustomDataUpdate.
+    _Atomic(bool) _customDataUpdateScheduled;
 
     // Mach port of the main thread, captured on the main thread during -start (or test
     // setup). Used to mark main as the crashed thread when generating a live hang report
@@ -116,6 +350,26 @@ static NSString *const kBugSplatMetaKeyNotes = @"notes";
     return sharedInstance;
 }
 
++ (BugSplatLogLevel)logLevel
+{
+    return BugSplatLogGetLevel();
+}
+
++ (void)setLogLevel:(BugSplatLogLevel)logLevel
+{
+    BugSplatLogSetLevel(logLevel);
+}
+
++ (BugSplatLogHandler)logHandler
+{
+    return BugSplatLogGetHandler();
+}
+
++ (void)setLogHandler:(BugSplatLogHandler)logHandler
+{
+    BugSplatLogSetHandler(logHandler);
+}
+
 - (BOOL)isDebuggerAttached
 {
     if (_debuggerAttachedOverride != nil) {
@@ -127,7 +381,7 @@ static NSString *const kBugSplatMetaKeyNotes = @"notes";
     size_t size = sizeof(info);
 
     if (sysctl(mib, sizeof(mib) / sizeof(*mib), &info, &size, NULL, 0) != 0) {
-        NSLog(@"BugSplat: Failed to query debugger status via sysctl; assuming debugger is attached");
+        BugSplatLogWarning(@"Failed to query debugger status via sysctl; assuming debugger is attached");
         return YES;
     }
 
@@ -142,6 +396,18 @@ static NSString *const kBugSplatMetaKeyNotes = @"notes";
         self.currentCrashFilename = nil;
         self.isTestInstance = NO;
         self.hangDetectionThreshold = 2.0;
+        self.crashCoalescingWindow = 3600.0;
+        self.slimmedThreadFrameLimit = 10;
+        self.logBufferSize = 64 * 1024;
+        self.resourceSampleInterval = 5.0;
+        self.cpuUsageBudget = 0.8;
+        self.cpuUsageWindow = 60.0;
+        self.maxCPUReportsPerSession = 1;
+        self.slowLaunchThreshold = 5.0;
+        self.launchCrashWindow = 10.0;
+        self.launchCrashLoopThreshold = 2;
+        self.launchCrashUploadTimeout = 5.0;
+        self.attributeStore = [[BugSplatAttributeStore alloc] init];
 
         // Configure PLCrashReporter
         // Note: Mach exception handling is not available on tvOS, use BSD signal handling instead
@@ -190,6 +456,18 @@ static NSString *const kBugSplatMetaKeyNotes = @"notes";
         self.currentCrashFilename = nil;
         self.isTestInstance = YES;
         self.hangDetectionThreshold = 2.0;
+        self.crashCoalescingWindow = 3600.0;
+        self.slimmedThreadFrameLimit = 10;
+        self.logBufferSize = 64 * 1024;
+        self.resourceSampleInterval = 5.0;
+        self.cpuUsageBudget = 0.8;
+        self.cpuUsageWindow = 60.0;
+        self.maxCPUReportsPerSession = 1;
+        self.slowLaunchThreshold = 5.0;
+        self.launchCrashWindow = 10.0;
+        self.launchCrashLoopThreshold = 2;
+        self.launchCrashUploadTimeout = 5.0;
+        self.attributeStore = [[BugSplatAttributeStore alloc] init];
 
         _crashReporterInternal = crashReporter;
         _crashStorageInternal = crashStorage;
@@ -215,53 +493,100 @@ static NSString *const kBugSplatMetaKeyNotes = @"notes";
 
 - (void)start
 {
-    NSLog(@"BugSplat start...");
+    NSDate *startDate = [NSDate date];
+    BugSplatLogInfo(@"Starting");
 
-    // Debug: Check what bundle and info dictionary we're reading from
-    NSBundle *mainBundle = [NSBundle mainBundle];
-    NSLog(@"BugSplat: mainBundle = %@", mainBundle);
-    NSLog(@"BugSplat: bundleIdentifier = %@", mainBundle.bundleIdentifier);
-    NSLog(@"BugSplat: infoDictionary = %@", mainBundle.infoDictionary);
-    NSLog(@"BugSplat: BugSplatDatabase from infoDictionary = %@", [mainBundle objectForInfoDictionaryKey:@"BugSplatDatabase"]);
-    NSLog(@"BugSplat: self.bundleProtocol = %@", self.bundleProtocol);
-    NSLog(@"BugSplat: self.bugSplatDatabase = %@", self.bugSplatDatabase);
+    if (!self.startAsynchronously) {
+        [self logStartDiagnostics];
+    }
 
     if (!self.bugSplatDatabase) {
-        NSLog(@"*** BugSplatDatabase is nil. Please add this key/value to your app's Info.plist or set bugSplatDatabase before invoking start. ***");
+        BugSplatLogError(@"BugSplatDatabase is nil. Please add this key/value to your app's Info.plist or set bugSplatDatabase before invoking start.");
         NSAssert(NO, @"*** BugSplatDatabase is nil. Please add this key/value to your app's Info.plist or set bugSplatDatabase before invoking start. ***");
         self.isStartInvoked = NO;
         return;
     }
 
     if (self.isStartInvoked) {
-        NSLog(@"*** BugSplat `start` was already invoked. ***");
+        BugSplatLogWarning(@"`start` was already invoked.");
         return;
     }
 
-    NSLog(@"BugSplat Database: [%@]", self.bugSplatDatabase);
-    NSLog(@"BugSplat Application: [%@] Version: [%@]", self.resolvedApplicationName, self.resolvedApplicationVersion);
+    BugSplatLogInfo(@"Database: [%@]", self.bugSplatDatabase);
+    BugSplatLogInfo(@"Application: [%@] Version: [%@]", self.resolvedApplicationName, self.resolvedApplicationVersion);
     
-    // Create upload service
-    self.uploadService = [[BugSplatUploadService alloc] initWithDatabase:self.bugSplatDatabase
-                                                         applicationName:self.resolvedApplicationName
-                                                      applicationVersion:self.resolvedApplicationVersion];
-    
-    // First, check for any NEW crash report from PLCrashReporter
-    // The crash-time metadata is embedded in the crash report via customData
-    if ([self.crashReporter hasPendingCrashReport]) {
-        [self handleNewCrashFromPLCrashReporter];
+    // Create upload service (unless one was injected for testing)
+    if (!self.uploadService) {
+        self.uploadService = [[BugSplatUploadService alloc] initWithDatabase:self.bugSplatDatabase
+                                                             applicationName:self.resolvedApplicationName
+                                                          applicationVersion:self.resolvedApplicationVersion];
     }
     
-    // Then, process any pending crash reports from our crashes directory
-    // This includes both new crashes and previously failed uploads
-    [self processPendingCrashReports];
+    // Pick up the previous session's log, latencies and resource samples before this session starts writing over them
+    [self openLogBuffer];
+    [self openLatencyHistogram];
+    [self openResourceSamples];
+    [self openLaunchState];
+    [self startLaunchStateMonitoring];
+
+    // Must run while the previous session's crash report is still pending
+    [self beginLaunchCrashDetection];
+
+    NSData *pendingCrashData = nil;
+    NSString *stagedCrashFilename = nil;
+    if (self.inLaunchCrashSafeMode) {
+        // The app keeps crashing during launch: get the newest report out before this launch
+        // crashes too. Other queued reports wait for a launch that survives.
+        if ([self.crashReporter hasPendingCrashReport]) {
+            [self handleNewCrashFromPLCrashReporter];
+        }
+        [self uploadLaunchCrashReportSynchronously];
+        [self recoverReservedHangReport];
+        [self enforceCrashQueueQuotas];
+    } else if (self.startAsynchronously) {
+        // Take the previous session's report off PLCrashReporter's hands now. Once the
+        // reporter is enabled below, a new crash would overwrite it before the ingest
+        // queue gets to it. Its raw bytes go to the crashes directory before the purge, so
+        // a crash or kill before the ingest queue runs cannot lose it; parsing, formatting,
+        // attachments and metadata follow on the ingest queue.
+        if ([self.crashReporter hasPendingCrashReport]) {
+            pendingCrashData = [self loadPendingCrashReportData];
+            if (pendingCrashData) {
+                stagedCrashFilename = [self stageRawCrashReportData:pendingCrashData];
+            }
+            [self.crashReporter purgePendingCrashReport];
+        }
+    } else {
+        // Finish reports an earlier launch staged but did not get to persist
+        [self resumeInterruptedCrashIngestion];
+
+        // First, check for any NEW crash report from PLCrashReporter
+        // The crash-time metadata is embedded in the crash report via customData
+        if ([self.crashReporter hasPendingCrashReport]) {
+            [self handleNewCrashFromPLCrashReporter];
+        }
+        
+        // Queue a fatal hang recorded in the reserved slot by the previous launch
+        [self recoverReservedHangReport];
+        
+        // Queue a report for a previous launch the system killed without one
+        [self queuePreviousSessionTerminationReport];
+        
+        // Drop reports beyond the configured quotas before anything is shown or uploaded
+        [self enforceCrashQueueQuotas];
+        
+        // Then, process any pending crash reports from our crashes directory
+        // This includes both new crashes and previously failed uploads
+        [self processPendingCrashReports];
+    }
     
     // When a debugger is attached, PLCrashReporter's Mach exception handler conflicts
     // with LLDB's exception ports, causing SIGTRAP (signal 5) termination.
-    // Skip enabling the crash reporter but still process pending crashes above.
+    // Skip enabling the crash reporter but still process pending crashes.
     if ([self isDebuggerAttached]) {
-        NSLog(@"BugSplat: Debugger attached - crash reporting disabled for this session");
+        BugSplatLogWarning(@"Debugger attached - crash reporting disabled for this session");
         self.isStartInvoked = YES;
+        [self scheduleCrashIngestionWithPendingData:pendingCrashData stagedFilename:stagedCrashFilename];
         return;
     }
 
@@ -272,13 +597,71 @@ static NSString *const kBugSplatMetaKeyNotes = @"notes";
     // Enable crash reporter for this session
     NSError *error = nil;
     if (![self.crashReporter enableCrashReporterAndReturnError:&error]) {
-        NSLog(@"BugSplat: Failed to enable crash reporter: %@", error);
+        BugSplatLogError(@"Failed to enable crash reporter: %@", error);
+        [self scheduleCrashIngestionWithPendingData:pendingCrashData stagedFilename:stagedCrashFilename];
         return;
     }
 
+    [self beginLaunchMonitoringWithStartDate:startDate];
     [self startHangDetectionIfEnabled];
+    [self observeFirstMainQueueBlockIfNeeded];
+    [self startCPUMonitoringIfEnabled];
 
     self.isStartInvoked = YES;
+
+    [self scheduleCrashIngestionWithPendingData:pendingCrashData stagedFilename:stagedCrashFilename];
+}
+
+- (void)logStartDiagnostics
+{
+    // Debug: Check what bundle and info dictionary we're reading from
+    if (!BugSplatLogIsEnabled(BugSplatLogLevelDebug)) {
+        return;
+    }
+    NSBundle *mainBundle = [NSBundle mainBundle];
+    BugSplatLogDebug(@"mainBundle = %@", mainBundle);
+    BugSplatLogDebug(@"bundleIdentifier = %@", mainBundle.bundleIdentifier);
+    BugSplatLogDebug(@"infoDictionary = %@", mainBundle.infoDictionary);
+    BugSplatLogDebug(@"BugSplatDatabase from infoDictionary = %@", [mainBundle objectForInfoDictionaryKey:@"BugSplatDatabase"]);
+    BugSplatLogDebug(@"self.bundleProtocol = %@", self.bundleProtocol);
+    BugSplatLogDebug(@"self.bugSplatDatabase = %@", self.bugSplatDatabase);
+}
+
+/// Serial queue for crash ingestion and deferred formatting, created on first use.
+- (dispatch_queue_t)ingestQueue
+{
+    @synchronized (self) {
+        if (!_ingestQueue) {
+            _ingestQueue = dispatch_queue_create("com.bugsplat.ingest",
+                                                 dispatch_queue_attr_make_with_qos_class(DISPATCH_QUEUE_SERIAL, QOS_CLASS_UTILITY, 0));
+        }
+        return _ingestQueue;
+    }
+}
+
+/**
+ * In asynchronous start mode, persist the previous session's crash (if any, already staged
+ * as `stagedFilename`) and drain the crash queue on the ingest queue. No-op in synchronous
+ * mode, where -start already did both, and in launch crash safe mode.
+ */
+- (void)scheduleCrashIngestionWithPendingData:(nullable NSData *)pendingCrashData
+                               stagedFilename:(nullable NSString *)stagedFilename
+{
+    if (!self.startAsynchronously || self.inLaunchCrashSafeMode) {
+        return;
+    }
+    dispatch_async(self.ingestQueue, ^{
+        [self logStartDiagnostics];
+        [self resumeInterruptedCrashIngestion];
+        if (pendingCrashData) {
+            BugSplatLogDebug(@"Processing new crash report from PLCrashReporter...");
+            [self persistCrashReportData:pendingCrashData stagedFilename:stagedFilename fromPreviousSession:YES];
+        }
+        [self recoverReservedHangReport];
+        [self queuePreviousSessionTerminationReport];
+        [self enforceCrashQueueQuotas];
+        [self processPendingCrashReports];
+    });
 }
 
 #pragma mark - Hang Detection
@@ -303,7 +686,7 @@ static NSString *const kBugSplatMetaKeyNotes = @"notes";
         return;
     }
     if ([self isRunningInAppExtension]) {
-        NSLog(@"BugSplat: Hang detection not supported in app extensions; skipping");
+        BugSplatLogWarning(@"Hang detection not supported in app extensions; skipping");
         return;
     }
 
@@ -322,9 +705,10 @@ static NSString *const kBugSplatMetaKeyNotes = @"notes";
         [self setValue:self.launchId forAttribute:kBugSplatHangAttrLaunchId];
     }
 
-    // Serialize hang delegate callbacks so detect / recover can't race on file I/O.
-    if (!self.hangQueue) {
-        self.hangQueue = dispatch_queue_create("com.bugsplat.hang-handler", DISPATCH_QUEUE_SERIAL);
+    [self createHangQueueIfNeeded];
+
+    if (self.reserveHangReportStorage) {
+        [self reserveHangReportSlot];
     }
 
 #if TARGET_OS_IOS || TARGET_OS_TV
@@ -344,9 +728,43 @@ static NSString *const kBugSplatMetaKeyNotes = @"notes";
                                                             isAppActiveBlock:^BOOL {
         return [BugSplat isApplicationActive];
     }];
+    self.hangTracker.usesHeartbeat = self.hangDetectionMode == BugSplatHangDetectionModeHeartbeat;
+    self.hangTracker.latencyHistogram = self.latencyHistogramFile.histogram;
+    BugSplatResourceRingFile *resourceRingFile = self.resourceRingFile;
+    if (resourceRingFile) {
+        self.hangTracker.periodicWorkInterval = self.resourceSampleInterval;
+        self.hangTracker.periodicWork = ^{
+            [resourceRingFile recordCurrentUsage];
+        };
+    }
+    if (self.hangReportEscalationThreshold > self.hangTracker.thresholdSeconds) {
+        self.hangSnapshot = [[BugSplatHangSnapshot alloc] initWithMaxFrames:kBugSplatHangSnapshotMaxFrames];
+    }
+    [self createHangSamplerIfEnabled];
+    if (self.hangSampler) {
+        self.hangTracker.stallThresholdSeconds = self.hangTracker.thresholdSeconds * kBugSplatHangSamplingStallFraction;
+    }
+    if (self.launchTimeline && !self.hangTracker.usesHeartbeat) {
+        // The first ping is dispatched as the tracker starts, so its answer is the launch's first main-queue block.
+        self.hangTracker.firstPongHandler = ^{
+            [weakSelf launchReachedMark:BugSplatLaunchMarkFirstMainQueueBlock];
+        };
+    }
 
     [self.hangTracker start];
-    NSLog(@"BugSplat: Hang detection enabled (threshold %.2fs)", self.hangTracker.thresholdSeconds);
+
+#if TARGET_OS_IOS || TARGET_OS_TV
+    // The watchdog parks while the app is inactive. Registered after the active-state
+    // observers, so the cached state is already true when the tracker re-polls.
+    [[NSNotificationCenter defaultCenter] addObserverForName:UIApplicationDidBecomeActiveNotification
+                                                      object:nil
+                                                       queue:[NSOperationQueue mainQueue]
+                                                  usingBlock:^(NSNotification *note) {
+        [weakSelf.hangTracker wake];
+    }];
+#endif
+    BugSplatLogInfo(@"Hang detection enabled (threshold %.2fs, %@)", self.hangTracker.thresholdSeconds,
+                    self.hangTracker.usesHeartbeat ? @"heartbeat" : @"ping");
 }
 
 #if TARGET_OS_IOS || TARGET_OS_TV
@@ -410,85 +828,350 @@ static _Atomic(bool) sBugSplatApplicationActive = true;
 #endif
 }
 
+- (void)createHangQueueIfNeeded
+{
+    // Serialize hang delegate callbacks so detect / recover can't race on file I/O.
+    @synchronized (self) {
+        if (!self.hangQueue) {
+            // Hang reports attribute frames to images from the hang queue, where dladdr could
+            // wait on a hung thread that holds the dyld lock.
+            BugSplatImageListInstall();
+            (void)BugSplatAppBundlePrefix();
+            self.hangQueue = dispatch_queue_create("com.bugsplat.hang-handler", DISPATCH_QUEUE_SERIAL);
+            self.targetHangFilenames = [NSMutableDictionary dictionary];
+        }
+    }
+}
+
+/// Sampler for the main thread when hang sampling is on. Needs the main thread's port.
+- (void)createHangSamplerIfEnabled
+{
+    if (!self.enableHangSampling || self.hangSampler || _mainThreadMachPort == MACH_PORT_NULL) {
+        return;
+    }
+    // Room for the stall-to-hang span twice over, in case the hang is declared late.
+    NSTimeInterval threshold = MAX(self.hangDetectionThreshold, 0.1);
+    NSUInteger maxSamples = (NSUInteger)ceil(threshold * (1.0 - kBugSplatHangSamplingStallFraction) * 2.0 / kBugSplatHangSamplingInterval);
+    self.hangSampler = [[BugSplatHangSampler alloc] initWithThread:_mainThreadMachPort
+                                                          interval:kBugSplatHangSamplingInterval
+                                                        maxSamples:maxSamples];
+}
+
 #pragma mark - BugSplatHangTrackerDelegate
 
+- (void)hangTracker:(BugSplatHangTracker *)tracker didDetectStallWithDuration:(NSTimeInterval)duration
+{
+    [self.hangSampler begin];
+}
+
+- (void)hangTrackerDidEndStall:(BugSplatHangTracker *)tracker
+{
+    [self.hangSampler cancel];
+}
+
 - (void)hangTracker:(BugSplatHangTracker *)tracker
 didDetectHangWithDuration:(NSTimeInterval)duration
            appState:(NSString *)appState
 {
+    // Recorded before the report is written: a kill in between is still a watchdog termination.
+    BugSplatLaunchState *launchState = self.launchStateFile.state;
+    if (launchState) {
+        BugSplatLaunchStateSetHangState(launchState, BugSplatLaunchHangUnreported);
+    }
+
     // Callback runs on the tracker's watchdog thread; marshal to our serial queue.
     dispatch_async(self.hangQueue, ^{
-        [self persistHangReportWithDuration:duration appState:appState];
+        if (self.hangSnapshot) {
+            [self persistHangSnapshotWithDuration:duration appState:appState];
+        } else {
+            [self persistHangReportWithDuration:duration appState:appState];
+        }
+        if (launchState && (self.currentHangFilename || self.hangReportSlot.hasValidRecord)) {
+            BugSplatLaunchStateSetHangState(launchState, BugSplatLaunchHangReported);
+        }
     });
 }
 
 - (void)hangTrackerDidRecoverFromHang:(BugSplatHangTracker *)tracker
 {
+    [self.hangSampler cancel];
     dispatch_async(self.hangQueue, ^{
+        self.hangGeneration++;
+        [self.hangReportSlot invalidate];
+        if (self.launchStateFile) {
+            BugSplatLaunchStateSetHangState(self.launchStateFile.state, BugSplatLaunchHangNone);
+        }
         NSString *filename = self.currentHangFilename;
         self.currentHangFilename = nil;
         if (filename) {
             [self cleanupCrashReportWithFilename:filename];
-            NSLog(@"BugSplat: Main thread recovered from hang; removed persisted report %@", filename);
+            BugSplatLogDebug(@"Main thread recovered from hang; removed persisted report %@", filename);
+        }
+    });
+}
+
+#pragma mark - Monitored Targets
+
+- (BOOL)monitorQueue:(dispatch_queue_t)queue name:(NSString *)name threshold:(NSTimeInterval)threshold
+{
+    // A queue's pings run on whichever pool thread GCD picks, so no thread is worth naming
+    return [self monitorTargetNamed:name threshold:threshold recordsThread:NO pingDispatcher:^(dispatch_block_t ping) {
+        dispatch_async(queue, ping);
+    }];
+}
+
+- (BOOL)monitorTargetNamed:(NSString *)name
+                 threshold:(NSTimeInterval)threshold
+            pingDispatcher:(void (^)(dispatch_block_t ping))pingDispatcher
+{
+    return [self monitorTargetNamed:name threshold:threshold recordsThread:YES pingDispatcher:pingDispatcher];
+}
+
+- (BOOL)monitorTargetNamed:(NSString *)name
+                 threshold:(NSTimeInterval)threshold
+             recordsThread:(BOOL)recordsThread
+            pingDispatcher:(void (^)(dispatch_block_t ping))pingDispatcher
+{
+    if (name.length == 0 || !pingDispatcher) {
+        return NO;
+    }
+    if ([self isRunningInAppExtension]) {
+        BugSplatLogWarning(@"Hang detection not supported in app extensions; not monitoring %@", name);
+        return NO;
+    }
+    [self createHangQueueIfNeeded];
+    @synchronized (self) {
+        if (!self.watchdog) {
+            __weak __typeof(self) weakSelf = self;
+            self.watchdog = [[BugSplatWatchdog alloc] initWithDelegate:self isDebuggerAttachedBlock:^BOOL {
+                __strong __typeof(weakSelf) strongSelf = weakSelf;
+                return strongSelf ? [strongSelf isDebuggerAttached] : NO;
+            }];
+        }
+    }
+    BOOL added = [self.watchdog addTargetWithName:name
+                                        threshold:threshold
+                                    recordsThread:recordsThread
+                                   pingDispatcher:pingDispatcher];
+    if (added) {
+        BugSplatLogInfo(@"Monitoring %@ (threshold %.2fs)", name, threshold);
+    } else {
+        BugSplatLogWarning(@"%@ is already monitored", name);
+    }
+    return added;
+}
+
+- (void)stopMonitoringTargetNamed:(NSString *)name
+{
+    [self.watchdog removeTargetWithName:name];
+}
+
+#pragma mark - BugSplatWatchdogDelegate
+
+- (void)watchdog:(BugSplatWatchdog *)watchdog
+      targetNamed:(NSString *)name
+didStallWithDuration:(NSTimeInterval)duration
+           thread:(mach_port_t)thread
+{
+    NSString *appState = [BugSplat isApplicationActive] ? @"active" : @"background";
+    dispatch_async(self.hangQueue, ^{
+        [self persistHangReportWithDuration:duration appState:appState targetName:name thread:thread profile:nil];
+    });
+}
+
+- (void)watchdog:(BugSplatWatchdog *)watchdog targetNamedDidRecover:(NSString *)name
+{
+    dispatch_async(self.hangQueue, ^{
+        NSString *filename = self.targetHangFilenames[name];
+        [self.targetHangFilenames removeObjectForKey:name];
+        if (filename) {
+            [self cleanupCrashReportWithFilename:filename];
+            BugSplatLogDebug(@"%@ recovered from hang; removed persisted report %@", name, filename);
         }
     });
 }
 
+#pragma mark - Hang Reports
+
+- (void)persistHangReportWithDuration:(NSTimeInterval)duration appState:(NSString *)appState
+{
+    // Stop sampling before the live report suspends the main thread for its own snapshot.
+    NSData *profile = [self.hangSampler finish];
+    [self persistHangReportWithDuration:duration appState:appState targetName:nil thread:_mainThreadMachPort profile:profile];
+}
+
 /**
- * Capture a live report via PLCrashReporter with a synthetic "App Hang (Fatal)" exception,
- * text-format it, and persist it (plus metadata) to the crashes directory so the normal
- * next-launch scanner uploads it through the existing pipeline. Called on the hang queue.
+ * First capture tier: record only the main thread's backtrace as a small text report, then
+ * upgrade it to a full live report if the main thread is still hung once
+ * `hangReportEscalationThreshold` has passed. Most hangs recover before that, and their
+ * snapshot is deleted having cost one stack walk and a few kilobytes of I/O. Called on the hang queue.
  */
-- (void)persistHangReportWithDuration:(NSTimeInterval)duration appState:(NSString *)appState
+- (void)persistHangSnapshotWithDuration:(NSTimeInterval)duration appState:(NSString *)appState
 {
-    NSString *reason = [NSString stringWithFormat:@"Main thread unresponsive for %.0f ms", duration * 1000.0];
-    NSException *hangException = [NSException exceptionWithName:@"App Hang (Fatal)"
-                                                         reason:reason
-                                                       userInfo:nil];
+    NSUInteger generation = ++self.hangGeneration;
+    uint64_t detectedAt = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+    NSData *profile = [self.hangSampler finish];
 
-    NSError *error = nil;
-    NSData *liveReportData = nil;
-    PLCrashReporter *plCrashReporter = (PLCrashReporter *)self.crashReporterInternal;
-    mach_port_t mainThreadPort = _mainThreadMachPort;
-    @try {
-        if (mainThreadPort != MACH_PORT_NULL) {
-            // Mark main as the crashed thread so the dashboard's crashed-thread view
-            // points at what's actually hung, rather than the hang-queue worker.
-            liveReportData = [plCrashReporter generateLiveReportWithThread:mainThreadPort
-                                                                 exception:hangException
-                                                                     error:&error];
-        } else {
-            liveReportData = [plCrashReporter generateLiveReportWithException:hangException error:&error];
+    NSString *reason = [NSString stringWithFormat:@"Main thread unresponsive for %.0f ms", duration * 1000.0];
+    if ([self.hangSnapshot captureThread:_mainThreadMachPort]) {
+        NSData *reportText = [self.hangSnapshot reportTextWithExceptionName:kBugSplatHangExceptionName reason:reason];
+        NSDictionary *causeAttributes = [self hangCauseAttributesForFrames:self.hangSnapshot.frames
+                                                                     count:self.hangSnapshot.frameCount];
+        NSString *filename = [self persistHangReportFilesWithDuration:duration
+                                                             appState:appState
+                                                           attributes:causeAttributes
+                                                              profile:profile
+                                                          writeReport:^BOOL(NSString *basePath) {
+            return [reportText writeToFile:[basePath stringByAppendingPathExtension:kBugSplatCrashFileExtension] atomically:YES];
+        }];
+        if (filename) {
+            self.currentHangFilename = filename;
+            BugSplatLogInfo(@"Persisted hang snapshot %@ (duration %.0fms, %lu frames)",
+                            filename, duration * 1000.0, (unsigned long)self.hangSnapshot.frameCount);
         }
-    } @catch (NSException *exception) {
-        NSLog(@"BugSplat: Exception generating live hang report: %@ - %@", exception.name, exception.reason);
-        return;
+    } else {
+        BugSplatLogWarning(@"Failed to capture main thread for hang snapshot");
     }
 
-    if (!liveReportData || liveReportData.length == 0) {
-        NSLog(@"BugSplat: Failed to generate live hang report: %@", error);
-        return;
-    }
+    NSTimeInterval delay = MAX(self.hangReportEscalationThreshold - duration, 0);
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(delay * NSEC_PER_SEC)), self.hangQueue, ^{
+        if (self.hangGeneration != generation) {
+            return;
+        }
+        NSTimeInterval stalled = duration + (NSTimeInterval)(clock_gettime_nsec_np(CLOCK_UPTIME_RAW) - detectedAt) / NSEC_PER_SEC;
+        NSString *snapshotFilename = self.currentHangFilename;
+        if (![self persistHangReportWithDuration:stalled appState:appState targetName:nil thread:self->_mainThreadMachPort profile:profile]) {
+            return;
+        }
+        // The full report (in files or the reserved slot) replaces the snapshot.
+        if (snapshotFilename) {
+            [self cleanupCrashReportWithFilename:snapshotFilename];
+            if ([self.currentHangFilename isEqualToString:snapshotFilename]) {
+                self.currentHangFilename = nil;
+            }
+        }
+        BugSplatLogInfo(@"Main thread still hung after %.0f ms; escalated to a full hang report", stalled * 1000.0);
+    });
+}
 
-    NSString *reportText = nil;
-    @try {
-        PLCrashReport *parsed = [[PLCrashReport alloc] initWithData:liveReportData error:&error];
-        if (parsed) {
-            reportText = [PLCrashReportTextFormatter stringValueForCrashReport:parsed
-                                                                withTextFormat:PLCrashReportTextFormatiOS];
+/// Cause attributes for `thread`'s current backtrace; empty if it cannot be sampled.
+- (NSDictionary<NSString *, NSString *> *)hangCauseAttributesForThread:(mach_port_t)thread
+{
+    uint64_t frames[kBugSplatHangSnapshotMaxFrames];
+    size_t count = BugSplatSampleThreadStack(thread, frames, kBugSplatHangSnapshotMaxFrames);
+    return [self hangCauseAttributesForFrames:frames count:count];
+}
+
+/// Cause attributes for a backtrace; see BugSplatClassifyHangFrames.
+- (NSDictionary<NSString *, NSString *> *)hangCauseAttributesForFrames:(const uint64_t *)addresses count:(size_t)count
+{
+    BugSplatHangCause cause;
+    BugSplatClassifyHangFrames(addresses, count, &cause);
+    return BugSplatHangCauseAttributes(&cause);
+}
+
+/**
+ * Capture a live report via PLCrashReporter with a synthetic "App Hang (Fatal)" exception,
+ * text-format it (unless formatting is deferred), and persist it (plus metadata) to the crashes directory so the normal
+ * next-launch scanner uploads it through the existing pipeline. Called on the hang queue.
+ *
+ * `targetName` is nil for the main thread, which alone uses the reserved slot;
+ * `thread` is marked as the crashed thread.
+ *
+ * @return YES if the report was recorded in the reserved slot or in files.
+ */
+- (BOOL)persistHangReportWithDuration:(NSTimeInterval)duration
+                             appState:(NSString *)appState
+                           targetName:(nullable NSString *)targetName
+                               thread:(mach_port_t)thread
+                              profile:(nullable NSData *)profile
+{
+    NSString *reason = [NSString stringWithFormat:@"%@ unresponsive for %.0f ms", targetName ?: @"Main thread", duration * 1000.0];
+    NSException *hangException = [NSException exceptionWithName:kBugSplatHangExceptionName
+                                                         reason:reason
+                                                       userInfo:nil];
+    // The backtrace the cause is classified from is taken once, just before the live report
+    // captures the same thread, and classified only after the report is captured.
+    uint64_t frames[kBugSplatHangSnapshotMaxFrames];
+    size_t frameCount = BugSplatSampleThreadStack(thread, frames, kBugSplatHangSnapshotMaxFrames);
+    // Mark the hung thread as the crashed thread so the dashboard's crashed-thread view
+    // points at what's actually hung, rather than the hang-queue worker.
+    NSData *liveReportData = [self liveReportDataWithThread:thread exception:hangException];
+    if (!liveReportData) {
+        return NO;
+    }
+    BugSplatHangCause cause;
+    BugSplatClassifyHangFrames(frames, frameCount, &cause);
+
+    // Reserved slot: copy the raw report, the pre-encoded metadata, the profile and the cause
+    // into the mapped file. Formatting, metadata and the queued report files are produced on the next launch.
+    if (self.hangReportSlot && !targetName) {
+        NSData *crashTimeMetadata = self.crashTimeMetadata;
+        if ([self.hangReportSlot recordReportBytes:liveReportData.bytes
+                                      reportLength:liveReportData.length
+                                     metadataBytes:crashTimeMetadata.bytes
+                                    metadataLength:crashTimeMetadata.length
+                                      profileBytes:profile.bytes
+                                     profileLength:profile.length
+                                     causeCategory:cause.category
+                                          appFrame:cause.appFrame
+                                        durationMs:(uint64_t)(duration * 1000.0)
+                                        detectedAt:[NSDate timeIntervalSinceReferenceDate]
+                                          appState:appState.UTF8String]) {
+            return YES;
         }
-    } @catch (NSException *exception) {
-        NSLog(@"BugSplat: Exception formatting live hang report: %@ - %@", exception.name, exception.reason);
+        BugSplatLogWarning(@"Hang report exceeds reserved slot (%lu bytes); persisting to files",
+              (unsigned long)(liveReportData.length + crashTimeMetadata.length + profile.length));
+    }
+
+    NSMutableDictionary<NSString *, NSString *> *attributes = [BugSplatHangCauseAttributes(&cause) mutableCopy];
+    if (targetName) {
+        attributes[kBugSplatHangAttrTarget] = targetName;
+    }
+
+    // Hangs the main thread recovers from are deleted again, so with deferred formatting
+    // the raw report is written as-is and only formatted if it is ever submitted.
+    NSString *hangFilename = [self persistHangReportFilesWithDuration:duration
+                                                             appState:appState
+                                                           attributes:attributes
+                                                              profile:profile
+                                                          writeReport:^BOOL(NSString *basePath) {
+        return [self writeLiveReportData:liveReportData
+                              toBasePath:basePath
+                           exceptionName:kBugSplatHangExceptionName
+                                  reason:reason];
+    }];
+    if (!hangFilename) {
+        return NO;
     }
 
-    if (reportText.length == 0) {
-        reportText = [NSString stringWithFormat:@"App Hang (Fatal)\n%@\n[Hang report text unavailable]\n", reason];
+    if (targetName) {
+        self.targetHangFilenames[targetName] = hangFilename;
+    } else {
+        self.currentHangFilename = hangFilename;
     }
+    BugSplatLogInfo(@"Persisted hang report %@ (duration %.0fms, state %@)",
+          hangFilename, duration * 1000.0, appState);
+    return YES;
+}
 
+/**
+ * Write one hang report into the crashes directory: `writeReport` writes the report itself
+ * given the path without extension, followed by the metadata (with `attributes` added) and
+ * the profile attachment.
+ *
+ * @return The report's basename, or nil (leaving nothing behind) on failure.
+ */
+- (nullable NSString *)persistHangReportFilesWithDuration:(NSTimeInterval)duration
+                                                 appState:(NSString *)appState
+                                               attributes:(NSDictionary<NSString *, NSString *> *)attributes
+                                                  profile:(nullable NSData *)profile
+                                              writeReport:(BOOL (^)(NSString *basePath))writeReport
+{
     NSString *crashesDir = [self crashesDirectoryPath];
     if (!crashesDir) {
-        NSLog(@"BugSplat: Failed to get crashes directory for hang report");
-        return;
+        BugSplatLogError(@"Failed to get crashes directory for hang report");
+        return nil;
     }
 
     // Use millisecond precision so a hang -> recover -> hang cycle inside the
@@ -498,62 +1181,1045 @@ didDetectHangWithDuration:(NSTimeInterval)duration
     NSString *hangFilename = [NSString stringWithFormat:@"%.0f%@",
                               [NSDate timeIntervalSinceReferenceDate] * 1000.0,
                               kBugSplatHangFilenameSuffix];
-
-    NSData *textData = [reportText dataUsingEncoding:NSUTF8StringEncoding];
-    NSString *crashFilePath = [[crashesDir stringByAppendingPathComponent:hangFilename]
-                               stringByAppendingPathExtension:kBugSplatCrashFileExtension];
-    if (![textData writeToFile:crashFilePath atomically:YES]) {
-        NSLog(@"BugSplat: Failed to write hang report to disk");
-        return;
+    NSString *basePath = [crashesDir stringByAppendingPathComponent:hangFilename];
+    if (!writeReport(basePath)) {
+        BugSplatLogError(@"Failed to write hang report to disk");
+        return nil;
     }
 
     // Build metadata. Unlike crashes there is no PLCrashReporter customData to extract from,
     // so we snapshot current values directly - this is safe because the main thread is hung
     // and nothing else is mutating these properties while this runs.
+    NSDictionary *metadata = [self hangReportMetadataWithCrashTimeProperties:nil
+                                                                  durationMs:duration * 1000.0
+                                                                  detectedAt:[NSDate date]
+                                                                    appState:appState
+                                                                    launchId:self.launchId];
+    metadata = [self metadata:metadata addingAttributes:[self latencyAttributesForHistogramFile:self.latencyHistogramFile]];
+    metadata = [self metadata:metadata addingAttributes:attributes];
+
+    NSString *metaFilePath = [basePath stringByAppendingPathExtension:kBugSplatMetaFileExtension];
+    if (![BugSplatMetadataCodec writeMetadata:metadata toFile:metaFilePath]) {
+        // Without the .meta file the next-launch scanner sees an orphan .crash that
+        // lacks userSubmitted=YES, database, and attributes - it would either fail to
+        // upload or surface a dialog instead of the intended silent submit. Drop the
+        // .crash too so we don't leak a half-formed report.
+        BugSplatLogError(@"Failed to write hang metadata; removing orphan crash file");
+        [[NSFileManager defaultManager] removeItemAtPath:[basePath stringByAppendingPathExtension:kBugSplatCrashFileExtension] error:nil];
+        [[NSFileManager defaultManager] removeItemAtPath:[basePath stringByAppendingPathExtension:kBugSplatRawCrashFileExtension] error:nil];
+        return nil;
+    }
+
+    NSMutableArray<BugSplatAttachment *> *attachments = [NSMutableArray array];
+    if (profile) {
+        [attachments addObject:[[BugSplatAttachment alloc] initWithFilename:kBugSplatHangProfileFilename
+                                                             attachmentData:profile
+                                                                contentType:@"text/plain"]];
+    }
+    BugSplatAttachment *resourceAttachment = [self currentSessionResourceAttachment];
+    if (resourceAttachment) {
+        [attachments addObject:resourceAttachment];
+    }
+    if (attachments.count > 0) {
+        [self persistAttachments:attachments forCrashFilename:hangFilename];
+    }
+    return hangFilename;
+}
+
+/**
+ * Metadata for a hang report. Identity properties come from `properties` (a decoded
+ * crash-time customData blob) when given, otherwise from the current values.
+ */
+- (NSDictionary *)hangReportMetadataWithCrashTimeProperties:(nullable NSDictionary *)properties
+                                                 durationMs:(double)durationMs
+                                                 detectedAt:(NSDate *)detectedAt
+                                                   appState:(nullable NSString *)appState
+                                                   launchId:(nullable NSString *)launchId
+{
     NSMutableDictionary *metadata = [NSMutableDictionary dictionary];
     NSISO8601DateFormatter *isoFormatter = [[NSISO8601DateFormatter alloc] init];
     isoFormatter.formatOptions = NSISO8601DateFormatWithInternetDateTime;
-    NSDate *now = [NSDate date];
-    NSString *nowISO = [isoFormatter stringFromDate:now];
-
-    metadata[kBugSplatMetaKeyTimestamp] = nowISO;
-    metadata[kBugSplatMetaKeyDatabase] = self.bugSplatDatabase;
-    metadata[kBugSplatMetaKeyApplicationName] = self.resolvedApplicationName;
-    metadata[kBugSplatMetaKeyApplicationVersion] = self.resolvedApplicationVersion;
-    if (self.userName) metadata[kBugSplatMetaKeyUserName] = self.userName;
-    if (self.userEmail) metadata[kBugSplatMetaKeyUserEmail] = self.userEmail;
-    if (self.appKey) metadata[kBugSplatMetaKeyAppKey] = self.appKey;
-    if (self.notes) metadata[kBugSplatMetaKeyNotes] = self.notes;
-
-    NSMutableDictionary<NSString *, NSString *> *attributes = self.attributes
-        ? [self.attributes mutableCopy]
+    NSString *detectedAtISO = [isoFormatter stringFromDate:detectedAt];
+
+    metadata[kBugSplatMetaKeyTimestamp] = detectedAtISO;
+    if (properties) {
+        for (NSString *key in @[kBugSplatMetaKeyDatabase, kBugSplatMetaKeyApplicationName, kBugSplatMetaKeyApplicationVersion,
+                                kBugSplatMetaKeyUserName, kBugSplatMetaKeyUserEmail, kBugSplatMetaKeyAppKey, kBugSplatMetaKeyNotes]) {
+            if (properties[key]) metadata[key] = properties[key];
+        }
+    } else {
+        metadata[kBugSplatMetaKeyDatabase] = self.bugSplatDatabase;
+        metadata[kBugSplatMetaKeyApplicationName] = self.resolvedApplicationName;
+        metadata[kBugSplatMetaKeyApplicationVersion] = self.resolvedApplicationVersion;
+        if (self.userName) metadata[kBugSplatMetaKeyUserName] = self.userName;
+        if (self.userEmail) metadata[kBugSplatMetaKeyUserEmail] = self.userEmail;
+        if (self.appKey) metadata[kBugSplatMetaKeyAppKey] = self.appKey;
+        if (self.notes) metadata[kBugSplatMetaKeyNotes] = self.notes;
+    }
+
+    NSDictionary *baseAttributes = properties ? properties[kBugSplatMetaKeyAttributes] : self.attributes;
+    NSMutableDictionary<NSString *, NSString *> *attributes = baseAttributes
+        ? [baseAttributes mutableCopy]
         : [NSMutableDictionary dictionary];
-    attributes[kBugSplatHangAttrDurationMs] = [NSString stringWithFormat:@"%.0f", duration * 1000.0];
-    attributes[kBugSplatHangAttrDetectedAt] = nowISO;
+    attributes[kBugSplatHangAttrDurationMs] = [NSString stringWithFormat:@"%.0f", durationMs];
+    attributes[kBugSplatHangAttrDetectedAt] = detectedAtISO;
     attributes[kBugSplatHangAttrAppState] = appState ?: @"unknown";
-    if (self.launchId) {
-        attributes[kBugSplatHangAttrLaunchId] = self.launchId;
+    if (launchId) {
+        attributes[kBugSplatHangAttrLaunchId] = launchId;
     }
     metadata[kBugSplatMetaKeyAttributes] = attributes;
 
     // Mark auto-submittable so the next-launch scanner uploads silently without showing a dialog.
     metadata[kBugSplatMetaKeyUserSubmitted] = @YES;
+    return metadata;
+}
 
-    NSString *metaFilePath = [[crashesDir stringByAppendingPathComponent:hangFilename]
-                              stringByAppendingPathExtension:kBugSplatMetaFileExtension];
-    if (![metadata writeToFile:metaFilePath atomically:YES]) {
-        // Without the .meta file the next-launch scanner sees an orphan .crash that
-        // lacks userSubmitted=YES, database, and attributes - it would either fail to
-        // upload or surface a dialog instead of the intended silent submit. Drop the
-        // .crash too so we don't leak a half-formed report.
-        NSLog(@"BugSplat: Failed to write hang metadata; removing orphan crash file");
-        [[NSFileManager defaultManager] removeItemAtPath:crashFilePath error:nil];
-        return;
-    }
+#pragma mark - Reserved Hang Report Slot
 
-    self.currentHangFilename = hangFilename;
-    NSLog(@"BugSplat: Persisted hang report %@ (duration %.0fms, state %@)",
-          hangFilename, duration * 1000.0, appState);
+- (nullable NSString *)hangReportSlotPathWithFilename:(NSString *)filename
+{
+    NSString *crashesDir = [self crashesDirectoryPath];
+    return crashesDir ? [[crashesDir stringByDeletingLastPathComponent] stringByAppendingPathComponent:filename] : nil;
+}
+
+/**
+ * Reserve the hang report slot for this launch. A valid record left by the previous launch
+ * is first moved aside for recoverReservedHangReport, so the new slot can't overwrite it.
+ */
+- (void)reserveHangReportSlot
+{
+    NSString *slotPath = [self hangReportSlotPathWithFilename:kBugSplatHangSlotFilename];
+    NSString *pendingPath = [self hangReportSlotPathWithFilename:kBugSplatHangSlotPendingFilename];
+    if (!slotPath || !pendingPath) {
+        return;
+    }
+    if ([BugSplatHangReportSlot fileAtPathHasValidRecord:slotPath]) {
+        [[NSFileManager defaultManager] removeItemAtPath:pendingPath error:nil];
+        rename(slotPath.fileSystemRepresentation, pendingPath.fileSystemRepresentation);
+    }
+
+    BugSplatHangReportSlot *slot = [[BugSplatHangReportSlot alloc] initWithPath:slotPath
+                                                                       capacity:kBugSplatHangReportSlotDefaultCapacity];
+    if (!slot) {
+        BugSplatLogWarning(@"Could not reserve hang report slot; hangs will be persisted to new files");
+        return;
+    }
+    [slot invalidate];
+    if (self.launchId) {
+        [slot setLaunchId:self.launchId];
+    }
+    self.hangReportSlot = slot;
+}
+
+/**
+ * Convert a hang recorded in the reserved slot by a previous launch into a regular queued
+ * report (<ms>-hang report + .meta, plus the hang profile if one was recorded), then discard
+ * the record.
+ */
+- (void)recoverReservedHangReport
+{
+    NSString *slotPath = [self hangReportSlotPathWithFilename:kBugSplatHangSlotFilename];
+    NSString *pendingPath = [self hangReportSlotPathWithFilename:kBugSplatHangSlotPendingFilename];
+    if (!slotPath || !pendingPath) {
+        return;
+    }
+    // Without a reservation this launch, the previous launch's record is still in place.
+    if (!self.hangReportSlot && [BugSplatHangReportSlot fileAtPathHasValidRecord:slotPath]) {
+        [[NSFileManager defaultManager] removeItemAtPath:pendingPath error:nil];
+        rename(slotPath.fileSystemRepresentation, pendingPath.fileSystemRepresentation);
+    }
+    if (![BugSplatHangReportSlot fileAtPathHasValidRecord:pendingPath]) {
+        [[NSFileManager defaultManager] removeItemAtPath:pendingPath error:nil];
+        return;
+    }
+
+    BugSplatHangReportSlot *record = [[BugSplatHangReportSlot alloc] initWithPath:pendingPath
+                                                                         capacity:kBugSplatHangReportSlotDefaultCapacity];
+    NSData *reportData = record.reportData;
+    NSString *crashesDir = [self crashesDirectoryPath];
+    if (reportData.length > 0 && crashesDir) {
+        NSDictionary *properties = record.metadataData ? [BugSplatMetadataCodec metadataWithData:record.metadataData] : nil;
+        NSString *hangFilename = [NSString stringWithFormat:@"%.0f%@", record.detectedAt * 1000.0, kBugSplatHangFilenameSuffix];
+        NSString *basePath = [crashesDir stringByAppendingPathComponent:hangFilename];
+
+        NSString *reason = [NSString stringWithFormat:@"Main thread unresponsive for %llu ms", record.durationMs];
+        BOOL reportWritten = [self writeLiveReportData:reportData
+                                            toBasePath:basePath
+                                         exceptionName:kBugSplatHangExceptionName
+                                                reason:reason];
+
+        NSDictionary *metadata = [self hangReportMetadataWithCrashTimeProperties:properties
+                                                                      durationMs:(double)record.durationMs
+                                                                      detectedAt:[NSDate dateWithTimeIntervalSinceReferenceDate:record.detectedAt]
+                                                                        appState:record.appState
+                                                                        launchId:record.launchId];
+        metadata = [self metadata:metadata addingAttributes:self.previousSessionLatencyAttributes];
+        NSMutableDictionary<NSString *, NSString *> *causeAttributes = [NSMutableDictionary dictionary];
+        causeAttributes[kBugSplatHangAttrCategory] = record.causeCategory;
+        causeAttributes[kBugSplatHangAttrAppFrame] = record.appFrame;
+        metadata = [self metadata:metadata addingAttributes:causeAttributes];
+        if (reportWritten
+            && [BugSplatMetadataCodec writeMetadata:metadata toFile:[basePath stringByAppendingPathExtension:kBugSplatMetaFileExtension]]) {
+            NSMutableArray<BugSplatAttachment *> *attachments = [NSMutableArray array];
+            NSData *profile = record.profileData;
+            if (profile) {
+                [attachments addObject:[[BugSplatAttachment alloc] initWithFilename:kBugSplatHangProfileFilename
+                                                                     attachmentData:profile
+                                                                        contentType:@"text/plain"]];
+            }
+            [self persistAttachments:attachments withPreviousSessionAttachmentsForCrashFilename:hangFilename];
+            BugSplatLogInfo(@"Queued hang report %@ from reserved slot (duration %llums)", hangFilename, record.durationMs);
+        } else {
+            BugSplatLogError(@"Failed to queue hang report from reserved slot");
+            [self cleanupCrashReportWithFilename:hangFilename];
+        }
+    }
+
+    record = nil;
+    [[NSFileManager defaultManager] removeItemAtPath:pendingPath error:nil];
+}
+
+#pragma mark - Log Buffer
+
+- (nullable NSString *)logBufferPath
+{
+    NSString *crashesDir = [self crashesDirectoryPath];
+    return crashesDir ? [[crashesDir stringByDeletingLastPathComponent] stringByAppendingPathComponent:kBugSplatLogBufferFilename] : nil;
+}
+
+/**
+ * Keep what the previous session logged for its crash report, then open the log buffer
+ * for this session, emptied, and route the BugSplatLogBuffer functions to it.
+ */
+- (void)openLogBuffer
+{
+    if (!self.enableLogBuffer || self.logRingFile) {
+        return;
+    }
+    NSString *path = [self logBufferPath];
+    if (!path) {
+        return;
+    }
+
+    self.previousSessionLog = [BugSplatLogRingFile tailOfFileAtPath:path maxLength:self.logBufferSize];
+
+    BugSplatLogRingFile *logRingFile = [[BugSplatLogRingFile alloc] initWithPath:path capacity:self.logBufferSize];
+    if (!logRingFile) {
+        BugSplatLogWarning(@"Could not open log buffer; log messages will not be recorded");
+        return;
+    }
+    [logRingFile reset];
+    [logRingFile activate];
+    self.logRingFile = logRingFile;
+}
+
+/// The previous session's log as an attachment, or nil if it logged nothing.
+- (nullable BugSplatAttachment *)previousSessionLogAttachment
+{
+    NSData *log = self.previousSessionLog;
+    if (log.length == 0) {
+        return nil;
+    }
+    return [[BugSplatAttachment alloc] initWithFilename:kBugSplatLogAttachmentFilename
+                                         attachmentData:log
+                                            contentType:@"text/plain"];
+}
+
+/**
+ * Attach `attachments` and what the previous session left - its log and resource samples -
+ * to the report queued as `crashFilename`.
+ */
+- (void)persistAttachments:(NSArray<BugSplatAttachment *> *)attachments
+withPreviousSessionAttachmentsForCrashFilename:(NSString *)crashFilename
+{
+    NSMutableArray<BugSplatAttachment *> *allAttachments = [attachments mutableCopy];
+    BugSplatAttachment *logAttachment = [self previousSessionLogAttachment];
+    if (logAttachment) {
+        [allAttachments addObject:logAttachment];
+    }
+    BugSplatAttachment *resourceAttachment = [self previousSessionResourceAttachment];
+    if (resourceAttachment) {
+        [allAttachments addObject:resourceAttachment];
+    }
+    if (allAttachments.count > 0) {
+        [self persistAttachments:allAttachments forCrashFilename:crashFilename];
+    }
+}
+
+#pragma mark - Latency Histogram
+
+- (nullable NSString *)latencyHistogramPath
+{
+    NSString *crashesDir = [self crashesDirectoryPath];
+    return crashesDir ? [[crashesDir stringByDeletingLastPathComponent] stringByAppendingPathComponent:kBugSplatLatencyHistogramFilename] : nil;
+}
+
+/**
+ * Keep the previous session's latency summary for its crash or hang report, then empty the
+ * histogram for this session. The hang tracker records into it once it starts.
+ */
+- (void)openLatencyHistogram
+{
+    if (!self.enableLatencyHistogram || !self.enableHangDetection || self.latencyHistogramFile) {
+        return;
+    }
+    NSString *path = [self latencyHistogramPath];
+    if (!path) {
+        return;
+    }
+    BugSplatLatencyHistogramFile *file = [[BugSplatLatencyHistogramFile alloc] initWithPath:path];
+    if (!file) {
+        BugSplatLogWarning(@"Could not open latency histogram; main-thread latency will not be recorded");
+        return;
+    }
+    self.previousSessionLatencyAttributes = [self latencyAttributesForHistogramFile:file];
+    [file reset];
+    self.latencyHistogramFile = file;
+}
+
+/// Report attributes summarizing `file`, or nil if it holds no values.
+- (nullable NSDictionary<NSString *, NSString *> *)latencyAttributesForHistogramFile:(nullable BugSplatLatencyHistogramFile *)file
+{
+    uint64_t count = file.count;
+    if (count == 0) {
+        return nil;
+    }
+    NSString *(^milliseconds)(double) = ^NSString *(double percentile) {
+        return [NSString stringWithFormat:@"%.1f", [file valueAtPercentile:percentile] / 1000.0];
+    };
+    return @{
+        kBugSplatLatencyAttrCount: [NSString stringWithFormat:@"%llu", count],
+        kBugSplatLatencyAttrP50: milliseconds(50),
+        kBugSplatLatencyAttrP90: milliseconds(90),
+        kBugSplatLatencyAttrP99: milliseconds(99),
+        kBugSplatLatencyAttrMax: milliseconds(100),
+    };
+}
+
+/// `metadata` with `attributes` merged into its attributes.
+- (NSDictionary *)metadata:(NSDictionary *)metadata addingAttributes:(nullable NSDictionary<NSString *, NSString *> *)attributes
+{
+    if (attributes.count == 0) {
+        return metadata;
+    }
+    NSMutableDictionary *merged = [metadata mutableCopy];
+    NSMutableDictionary *mergedAttributes = [metadata[kBugSplatMetaKeyAttributes] mutableCopy] ?: [NSMutableDictionary dictionary];
+    [mergedAttributes addEntriesFromDictionary:attributes];
+    merged[kBugSplatMetaKeyAttributes] = mergedAttributes;
+    return merged;
+}
+
+- (NSUInteger)mainThreadLatencySampleCount
+{
+    return (NSUInteger)self.latencyHistogramFile.count;
+}
+
+- (NSTimeInterval)mainThreadLatencyAtPercentile:(double)percentile
+{
+    BugSplatLatencyHistogramFile *file = self.latencyHistogramFile;
+    return file ? [file valueAtPercentile:percentile] / 1e6 : 0;
+}
+
+#pragma mark - Resource Samples
+
+- (nullable NSString *)resourceSamplesPath
+{
+    NSString *crashesDir = [self crashesDirectoryPath];
+    return crashesDir ? [[crashesDir stringByDeletingLastPathComponent] stringByAppendingPathComponent:kBugSplatResourceSamplesFilename] : nil;
+}
+
+/**
+ * Keep the previous session's resource samples for the report of how it ended, then empty
+ * the ring for this session. The hang tracker's watchdog thread samples into it once it starts.
+ */
+- (void)openResourceSamples
+{
+    if (!self.enableResourceSampling || !self.enableHangDetection || self.resourceRingFile) {
+        return;
+    }
+    NSString *path = [self resourceSamplesPath];
+    if (!path) {
+        return;
+    }
+    self.previousSessionResources = [BugSplatResourceRingFile CSVOfFileAtPath:path];
+
+    BugSplatResourceRingFile *file = [[BugSplatResourceRingFile alloc] initWithPath:path capacity:kBugSplatResourceSampleCapacity];
+    if (!file) {
+        BugSplatLogWarning(@"Could not open resource samples; resource usage will not be recorded");
+        return;
+    }
+    [file reset];
+    self.resourceRingFile = file;
+}
+
+- (nullable BugSplatAttachment *)resourceAttachmentWithCSV:(nullable NSData *)csv
+{
+    if (csv.length == 0) {
+        return nil;
+    }
+    return [[BugSplatAttachment alloc] initWithFilename:kBugSplatResourceAttachmentFilename
+                                         attachmentData:csv
+                                            contentType:@"text/csv"];
+}
+
+/// The previous session's resource samples as an attachment, or nil if it recorded none.
+- (nullable BugSplatAttachment *)previousSessionResourceAttachment
+{
+    return [self resourceAttachmentWithCSV:self.previousSessionResources];
+}
+
+/// This session's resource samples so far as an attachment, or nil if none were recorded.
+- (nullable BugSplatAttachment *)currentSessionResourceAttachment
+{
+    return [self resourceAttachmentWithCSV:[self.resourceRingFile CSV]];
+}
+
+#pragma mark - Silent Reports
+
+/**
+ * Metadata for a report BugSplat queues on its own rather than for a crash: the current
+ * identity properties and attributes, submitted without asking the user.
+ */
+- (NSDictionary *)silentReportMetadataWithTimestamp:(NSDate *)timestamp
+{
+    NSISO8601DateFormatter *isoFormatter = [[NSISO8601DateFormatter alloc] init];
+    isoFormatter.formatOptions = NSISO8601DateFormatWithInternetDateTime;
+    NSMutableDictionary *properties = [NSMutableDictionary dictionary];
+    properties[kBugSplatMetaKeyTimestamp] = [isoFormatter stringFromDate:timestamp];
+    properties[kBugSplatMetaKeyDatabase] = self.bugSplatDatabase;
+    properties[kBugSplatMetaKeyApplicationName] = self.resolvedApplicationName;
+    properties[kBugSplatMetaKeyApplicationVersion] = self.resolvedApplicationVersion;
+    if (self.userName) properties[kBugSplatMetaKeyUserName] = self.userName;
+    if (self.userEmail) properties[kBugSplatMetaKeyUserEmail] = self.userEmail;
+    if (self.appKey) properties[kBugSplatMetaKeyAppKey] = self.appKey;
+    if (self.notes) properties[kBugSplatMetaKeyNotes] = self.notes;
+    properties[kBugSplatMetaKeyUserSubmitted] = @YES;
+    return [self metadata:properties addingAttributes:self.attributes];
+}
+
+/// A live PLCrashReporter report with `thread` (if any) marked as crashed, or nil on failure.
+- (nullable NSData *)liveReportDataWithThread:(mach_port_t)thread exception:(NSException *)exception
+{
+    NSError *error = nil;
+    NSData *liveReportData = nil;
+    PLCrashReporter *plCrashReporter = (PLCrashReporter *)self.crashReporterInternal;
+    @try {
+        if (thread != MACH_PORT_NULL) {
+            liveReportData = [plCrashReporter generateLiveReportWithThread:thread exception:exception error:&error];
+        } else {
+            liveReportData = [plCrashReporter generateLiveReportWithException:exception error:&error];
+        }
+    } @catch (NSException *caught) {
+        BugSplatLogError(@"Exception generating live %@ report: %@ - %@", exception.name, caught.name, caught.reason);
+        return nil;
+    }
+    if (liveReportData.length == 0) {
+        BugSplatLogError(@"Failed to generate live %@ report: %@", exception.name, error);
+        return nil;
+    }
+    return liveReportData;
+}
+
+/**
+ * Write a live PLCrashReporter report to `basePath`: raw when formatting is deferred,
+ * otherwise as text, falling back to the exception name and reason if it cannot be formatted.
+ */
+- (BOOL)writeLiveReportData:(NSData *)liveReportData
+                 toBasePath:(NSString *)basePath
+              exceptionName:(NSString *)exceptionName
+                     reason:(NSString *)reason
+{
+    if (self.deferCrashReportFormatting) {
+        return [liveReportData writeToFile:[basePath stringByAppendingPathExtension:kBugSplatRawCrashFileExtension] atomically:YES];
+    }
+    NSString *crashFilePath = [basePath stringByAppendingPathExtension:kBugSplatCrashFileExtension];
+    if ([self writeTextForCrashReportData:liveReportData toFile:crashFilePath]) {
+        return YES;
+    }
+    NSString *reportText = [NSString stringWithFormat:@"%@\n%@\n[Report text unavailable]\n", exceptionName, reason];
+    return [[reportText dataUsingEncoding:NSUTF8StringEncoding] writeToFile:crashFilePath atomically:YES];
+}
+
+#pragma mark - CPU Monitoring
+
+- (void)startCPUMonitoringIfEnabled
+{
+    if (!self.enableCPUMonitoring || self.cpuMonitor) {
+        return;
+    }
+    [self createHangQueueIfNeeded];
+    __weak typeof(self) weakSelf = self;
+    self.cpuMonitor = [[BugSplatCPUMonitor alloc] initWithBudget:self.cpuUsageBudget
+                                                          window:self.cpuUsageWindow
+                                                      maxReports:self.maxCPUReportsPerSession
+                                                        delegate:self
+                                         isDebuggerAttachedBlock:^BOOL{
+        __strong typeof(weakSelf) strongSelf = weakSelf;
+        return strongSelf ? [strongSelf isDebuggerAttached] : NO;
+    }];
+    [self.cpuMonitor start];
+    BugSplatLogInfo(@"CPU monitoring started (budget %.0f%% of one core over %.0fs)",
+                    self.cpuMonitor.budget * 100.0, self.cpuMonitor.window);
+}
+
+- (void)cpuMonitor:(BugSplatCPUMonitor *)monitor
+didExceedBudgetWithUsage:(double)usage
+              span:(NSTimeInterval)span
+    hottestThreads:(NSArray<BugSplatCPUThreadUsage *> *)threads
+{
+    // Report writing shares the hang queue's file I/O; the thread usages keep their ports alive until then.
+    double budget = monitor.budget;
+    dispatch_async(self.hangQueue, ^{
+        [self persistCPUReportWithUsage:usage budget:budget span:span hottestThreads:threads];
+    });
+}
+
+/// Attributes of a high-CPU report: usage, budget and window, and the busiest threads with their share.
+- (NSDictionary<NSString *, NSString *> *)cpuReportAttributesWithUsage:(double)usage
+                                                                budget:(double)budget
+                                                                  span:(NSTimeInterval)span
+                                                        hottestThreads:(NSArray<BugSplatCPUThreadUsage *> *)threads
+{
+    NSMutableArray<NSString *> *hotThreads = [NSMutableArray array];
+    for (BugSplatCPUThreadUsage *thread in threads) {
+        if (hotThreads.count == kBugSplatCPUReportedThreadCount) {
+            break;
+        }
+        [hotThreads addObject:thread.description];
+    }
+    return @{
+        kBugSplatCPUAttrPercent: [NSString stringWithFormat:@"%.1f", usage * 100.0],
+        kBugSplatCPUAttrBudgetPercent: [NSString stringWithFormat:@"%.0f", budget * 100.0],
+        kBugSplatCPUAttrWindowSeconds: [NSString stringWithFormat:@"%.0f", span],
+        kBugSplatCPUAttrHotThreads: [hotThreads componentsJoinedByString:@", "],
+    };
+}
+
+/**
+ * Queue a live report for sustained high CPU use, with the busiest thread still alive marked
+ * as the crashed thread. Runs on the hang queue.
+ *
+ * @return The report's basename, or nil on failure.
+ */
+- (nullable NSString *)persistCPUReportWithUsage:(double)usage
+                                          budget:(double)budget
+                                            span:(NSTimeInterval)span
+                                  hottestThreads:(NSArray<BugSplatCPUThreadUsage *> *)threads
+{
+    NSString *crashesDir = [self crashesDirectoryPath];
+    if (!crashesDir) {
+        BugSplatLogError(@"Failed to get crashes directory for CPU report");
+        return nil;
+    }
+
+    BugSplatCPUThreadUsage *hottest = nil;
+    for (BugSplatCPUThreadUsage *thread in threads) {
+        if (thread.thread != MACH_PORT_NULL) {
+            hottest = thread;
+            break;
+        }
+    }
+    NSString *reason = [NSString stringWithFormat:@"%.0f%% of one core over %.0f s (budget %.0f%%)%@",
+                        usage * 100.0, span, budget * 100.0,
+                        threads.count > 0 ? [NSString stringWithFormat:@"; busiest: %@", threads.firstObject] : @""];
+    NSException *cpuException = [NSException exceptionWithName:kBugSplatCPUExceptionName reason:reason userInfo:nil];
+
+    NSData *liveReportData = [self liveReportDataWithThread:hottest ? hottest.thread : MACH_PORT_NULL exception:cpuException];
+    if (!liveReportData) {
+        return nil;
+    }
+
+    NSDate *now = [NSDate date];
+    NSString *filename = [NSString stringWithFormat:@"%.0f%@", now.timeIntervalSinceReferenceDate * 1000.0, kBugSplatCPUFilenameSuffix];
+    NSString *basePath = [crashesDir stringByAppendingPathComponent:filename];
+    if (![self writeLiveReportData:liveReportData toBasePath:basePath exceptionName:kBugSplatCPUExceptionName reason:reason]) {
+        BugSplatLogError(@"Failed to write CPU report to disk");
+        return nil;
+    }
+
+    // Sent without a dialog, like hangs: the app is still running and nobody asked for it.
+    NSDictionary *metadata = [self silentReportMetadataWithTimestamp:now];
+    metadata = [self metadata:metadata addingAttributes:[self cpuReportAttributesWithUsage:usage budget:budget span:span hottestThreads:threads]];
+    if (![BugSplatMetadataCodec writeMetadata:metadata toFile:[basePath stringByAppendingPathExtension:kBugSplatMetaFileExtension]]) {
+        BugSplatLogError(@"Failed to write CPU report metadata");
+        [self cleanupCrashReportWithFilename:filename];
+        return nil;
+    }
+
+    BugSplatAttachment *resourceAttachment = [self currentSessionResourceAttachment];
+    if (resourceAttachment) {
+        [self persistAttachments:@[resourceAttachment] forCrashFilename:filename];
+    }
+    BugSplatLogInfo(@"Queued CPU report %@ (%.0f%% over %.0fs)", filename, usage * 100.0, span);
+    return filename;
+}
+
+#pragma mark - Launch Monitoring
+
+/// The mark a launch ends at: the ready mark if the app makes one on every launch.
+- (BugSplatLaunchMark)launchEndMark
+{
+    return self.waitsForLaunchReadyMark ? BugSplatLaunchMarkReady : BugSplatLaunchMarkFirstMainQueueBlock;
+}
+
+/**
+ * Begin the startup timeline for this launch, with `-start` called at `startDate`. Runs
+ * before hang detection starts, so the tracker's first ping can mark the first main-queue block.
+ */
+- (void)beginLaunchMonitoringWithStartDate:(NSDate *)startDate
+{
+    if (!self.enableLaunchMonitoring || self.launchTimeline) {
+        return;
+    }
+#if TARGET_OS_IOS || TARGET_OS_TV
+    // A prewarmed process was started ahead of time by the system, not by the user.
+    if ([[NSProcessInfo processInfo].environment[@"ActivePrewarm"] isEqualToString:@"1"]) {
+        BugSplatLogInfo(@"Launch was prewarmed; not monitoring it");
+        return;
+    }
+#endif
+    NSDate *processStartDate = [BugSplatLaunchTimeline currentProcessStartDate];
+    if (!processStartDate) {
+        BugSplatLogWarning(@"Could not read the process start time; launch monitoring disabled");
+        return;
+    }
+    BugSplatLaunchTimeline *timeline = [[BugSplatLaunchTimeline alloc] initWithProcessStartDate:processStartDate];
+    [timeline recordMark:BugSplatLaunchMarkStart atDate:startDate];
+    [self beginLaunchMonitoringWithTimeline:timeline];
+}
+
+/// Adopt `timeline` and sample the main thread once the slow launch threshold passes.
+- (void)beginLaunchMonitoringWithTimeline:(BugSplatLaunchTimeline *)timeline
+{
+    if ([NSThread isMainThread] && _mainThreadMachPort == MACH_PORT_NULL) {
+        _mainThreadMachPort = pthread_mach_thread_np(pthread_self());
+    }
+    [self createHangQueueIfNeeded];
+    self.launchTimeline = timeline;
+
+    NSTimeInterval untilThreshold = MAX(self.slowLaunchThreshold - [[NSDate date] timeIntervalSinceDate:timeline.processStartDate], 0);
+    __weak __typeof(self) weakSelf = self;
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(untilThreshold * NSEC_PER_SEC)), self.hangQueue, ^{
+        [weakSelf sampleSlowLaunch];
+    });
+}
+
+/// Mark the first main-queue block, unless the hang tracker's first ping already does.
+- (void)observeFirstMainQueueBlockIfNeeded
+{
+    if (!self.launchTimeline || self.hangTracker.firstPongHandler) {
+        return;
+    }
+    __weak __typeof(self) weakSelf = self;
+    dispatch_async(dispatch_get_main_queue(), ^{
+        [weakSelf launchReachedMark:BugSplatLaunchMarkFirstMainQueueBlock];
+    });
+}
+
+- (void)markLaunchReady
+{
+    [self launchReachedMark:BugSplatLaunchMarkReady];
+}
+
+- (void)launchReachedMark:(BugSplatLaunchMark)mark
+{
+    BugSplatLaunchTimeline *timeline = self.launchTimeline;
+    if (![timeline recordMark:mark atDate:[NSDate date]] || mark != [self launchEndMark]) {
+        return;
+    }
+    dispatch_async(self.hangQueue, ^{
+        [self finishLaunchMonitoring];
+    });
+}
+
+/**
+ * Sample the main thread while the launch is still running past the threshold, for the
+ * report made when it ends. Runs on the hang queue.
+ */
+- (void)sampleSlowLaunch
+{
+    BugSplatLaunchTimeline *timeline = self.launchTimeline;
+    if (!timeline || self.slowLaunchReportData || [timeline timeToMark:[self launchEndMark]] >= 0) {
+        return;
+    }
+    NSString *reason = [NSString stringWithFormat:@"Launch still running %.0f ms after process start (threshold %.0f ms)",
+                        [[NSDate date] timeIntervalSinceDate:timeline.processStartDate] * 1000.0, self.slowLaunchThreshold * 1000.0];
+    NSException *launchException = [NSException exceptionWithName:kBugSplatLaunchExceptionName reason:reason userInfo:nil];
+    self.slowLaunchReportData = [self liveReportDataWithThread:_mainThreadMachPort exception:launchException];
+}
+
+/**
+ * Queue a report if the launch that just ended took longer than the threshold. Runs on the
+ * hang queue.
+ *
+ * @return The report's basename, or nil if the launch was not slow or the report failed.
+ */
+- (nullable NSString *)finishLaunchMonitoring
+{
+    BugSplatLaunchTimeline *timeline = self.launchTimeline;
+    NSTimeInterval duration = [timeline timeToMark:[self launchEndMark]];
+    NSData *liveReportData = self.slowLaunchReportData;
+    self.slowLaunchReportData = nil;
+    if (duration < 0 || duration <= self.slowLaunchThreshold) {
+        return nil;
+    }
+
+    NSString *reason = [NSString stringWithFormat:@"Launch took %.0f ms to %@ (threshold %.0f ms)",
+                        duration * 1000.0, BugSplatLaunchMarkName([self launchEndMark]), self.slowLaunchThreshold * 1000.0];
+    if (!liveReportData) {
+        // The threshold check had not run yet; the main thread is past the slow part, but the report still carries the timeline.
+        NSException *launchException = [NSException exceptionWithName:kBugSplatLaunchExceptionName reason:reason userInfo:nil];
+        liveReportData = [self liveReportDataWithThread:_mainThreadMachPort exception:launchException];
+        if (!liveReportData) {
+            return nil;
+        }
+    }
+
+    NSString *crashesDir = [self crashesDirectoryPath];
+    if (!crashesDir) {
+        BugSplatLogError(@"Failed to get crashes directory for slow launch report");
+        return nil;
+    }
+    NSDate *now = [NSDate date];
+    NSString *filename = [NSString stringWithFormat:@"%.0f%@", now.timeIntervalSinceReferenceDate * 1000.0, kBugSplatLaunchFilenameSuffix];
+    NSString *basePath = [crashesDir stringByAppendingPathComponent:filename];
+    if (![self writeLiveReportData:liveReportData toBasePath:basePath exceptionName:kBugSplatLaunchExceptionName reason:reason]) {
+        BugSplatLogError(@"Failed to write slow launch report to disk");
+        return nil;
+    }
+
+    NSMutableDictionary<NSString *, NSString *> *launchAttributes = [@{
+        kBugSplatLaunchAttrDuration: [NSString stringWithFormat:@"%.0f", duration * 1000.0],
+        kBugSplatLaunchAttrThreshold: [NSString stringWithFormat:@"%.0f", self.slowLaunchThreshold * 1000.0],
+        kBugSplatLaunchAttrEnd: BugSplatLaunchMarkName([self launchEndMark]),
+    } mutableCopy];
+    for (NSUInteger mark = 0; mark < BugSplatLaunchMarkCount; mark++) {
+        NSTimeInterval time = [timeline timeToMark:mark];
+        if (time >= 0) {
+            NSString *key = [NSString stringWithFormat:kBugSplatLaunchAttrMarkFormat, BugSplatLaunchMarkName(mark)];
+            launchAttributes[key] = [NSString stringWithFormat:@"%.0f", time * 1000.0];
+        }
+    }
+    NSDictionary *metadata = [self silentReportMetadataWithTimestamp:now];
+    metadata = [self metadata:metadata addingAttributes:launchAttributes];
+    if (![BugSplatMetadataCodec writeMetadata:metadata toFile:[basePath stringByAppendingPathExtension:kBugSplatMetaFileExtension]]) {
+        BugSplatLogError(@"Failed to write slow launch report metadata");
+        [self cleanupCrashReportWithFilename:filename];
+        return nil;
+    }
+
+    NSMutableArray<BugSplatAttachment *> *attachments = [NSMutableArray array];
+    [attachments addObject:[[BugSplatAttachment alloc] initWithFilename:kBugSplatLaunchTimelineFilename
+                                                         attachmentData:[[timeline timelineDescription] dataUsingEncoding:NSUTF8StringEncoding]
+                                                            contentType:@"text/plain"]];
+    BugSplatAttachment *resourceAttachment = [self currentSessionResourceAttachment];
+    if (resourceAttachment) {
+        [attachments addObject:resourceAttachment];
+    }
+    [self persistAttachments:attachments forCrashFilename:filename];
+    BugSplatLogInfo(@"Queued slow launch report %@ (%.0f ms)", filename, duration * 1000.0);
+    return filename;
+}
+
+#pragma mark - Launch Crash Safe Mode
+
+- (nullable NSString *)launchCrashMarkerPath
+{
+    NSString *crashesDir = [self crashesDirectoryPath];
+    return crashesDir ? [[crashesDir stringByDeletingLastPathComponent] stringByAppendingPathComponent:kBugSplatLaunchCrashMarkerFilename] : nil;
+}
+
+/**
+ * Count the launches in a row that crashed within `launchCrashWindow` of `-start`, enter safe
+ * mode if there were `launchCrashLoopThreshold` of them, and mark this launch as within the
+ * window until it passes. A marker left by the previous launch means it ended within the
+ * window; with a crash report pending, it ended in a crash. Must run before the pending
+ * report is taken from PLCrashReporter.
+ */
+- (void)beginLaunchCrashDetection
+{
+    if (!self.enableLaunchCrashSafeMode) {
+        return;
+    }
+    NSString *markerPath = [self launchCrashMarkerPath];
+    if (!markerPath) {
+        return;
+    }
+
+    NSString *marker = [NSString stringWithContentsOfFile:markerPath encoding:NSUTF8StringEncoding error:nil];
+    NSUInteger count = 0;
+    if (marker && [self.crashReporter hasPendingCrashReport]) {
+        count = (NSUInteger)MAX(marker.integerValue, 0) + 1;
+    }
+    self.launchCrashCount = count;
+    self.inLaunchCrashSafeMode = count >= MAX(self.launchCrashLoopThreshold, (NSUInteger)1);
+    if (count > 0) {
+        BugSplatLogWarning(@"Previous %lu launch(es) crashed within %.0f s of start%@", (unsigned long)count,
+                           self.launchCrashWindow, self.inLaunchCrashSafeMode ? @"; entering safe mode" : @"");
+    }
+
+    NSError *error = nil;
+    NSString *contents = [NSString stringWithFormat:@"%lu", (unsigned long)count];
+    if (![contents writeToFile:markerPath atomically:YES encoding:NSUTF8StringEncoding error:&error]) {
+        BugSplatLogError(@"Failed to write launch crash marker: %@", error);
+        return;
+    }
+
+    // A launch that lives through the window ends the streak
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(MAX(self.launchCrashWindow, 0) * NSEC_PER_SEC)),
+                   dispatch_get_global_queue(QOS_CLASS_UTILITY, 0), ^{
+        [[NSFileManager defaultManager] removeItemAtPath:markerPath error:nil];
+    });
+}
+
+/**
+ * Upload the report just persisted from PLCrashReporter, without its attachments, blocking
+ * for at most `launchCrashUploadTimeout`. A report that is not uploaded stays queued and is
+ * retried like any other.
+ *
+ * @return YES if the report was uploaded and removed from the queue.
+ */
+- (BOOL)uploadLaunchCrashReportSynchronously
+{
+    NSString *crashFilename = self.currentCrashFilename;
+    NSString *crashesDir = [self crashesDirectoryPath];
+    if (!crashFilename || !crashesDir) {
+        return NO;
+    }
+    NSData *crashReportData = [self crashReportDataForFilename:crashFilename];
+    if (!crashReportData) {
+        return NO;
+    }
+    NSString *metaFilePath = [[crashesDir stringByAppendingPathComponent:crashFilename]
+                              stringByAppendingPathExtension:kBugSplatMetaFileExtension];
+    NSDictionary *metadata = [BugSplatMetadataCodec metadataWithContentsOfFile:metaFilePath] ?: @{};
+    BugSplatCrashMetadata *uploadMetadata = [self uploadMetadataWithPersistedMetadata:metadata
+                                                                             userName:metadata[kBugSplatMetaKeyUserName]
+                                                                            userEmail:metadata[kBugSplatMetaKeyUserEmail]
+                                                                             comments:metadata[kBugSplatMetaKeyComments]];
+
+    BugSplatLogInfo(@"Uploading launch crash report %@ before start returns (timeout %.1f s)...",
+                    crashFilename, self.launchCrashUploadTimeout);
+    NSError *error = nil;
+    BOOL uploaded = [self.uploadService uploadCrashReportSynchronously:crashReportData
+                                                         crashFilename:@"crash.crashlog"
+                                                           attachments:nil
+                                                              metadata:uploadMetadata
+                                                               timeout:self.launchCrashUploadTimeout
+                                                                 error:&error];
+    if (!uploaded) {
+        BugSplatLogWarning(@"Failed to upload launch crash report %@: %@ (will retry on next launch)", crashFilename, error);
+        return NO;
+    }
+    BugSplatLogInfo(@"Launch crash report %@ uploaded successfully", crashFilename);
+    [self cleanupCrashReportWithFilename:crashFilename];
+    return YES;
+}
+
+#pragma mark - Termination Detection
+
+- (nullable NSString *)launchStatePath
+{
+    NSString *crashesDir = [self crashesDirectoryPath];
+    return crashesDir ? [[crashesDir stringByDeletingLastPathComponent] stringByAppendingPathComponent:kBugSplatLaunchStateFilename] : nil;
+}
+
+/**
+ * Infer how the previous launch ended from the state it left, then begin this launch's state.
+ * Must run before the previous session's crash report is taken from PLCrashReporter, which
+ * is how a crash is told apart from a kill.
+ */
+- (void)openLaunchState
+{
+#if TARGET_OS_OSX
+    // macOS does not terminate apps for memory use or unresponsiveness.
+    return;
+#else
+    if (!self.enableTerminationDetection || self.launchStateFile || [self isRunningInAppExtension]) {
+        return;
+    }
+    NSString *path = [self launchStatePath];
+    if (!path) {
+        return;
+    }
+    BugSplatLaunchStateFile *file = [[BugSplatLaunchStateFile alloc] initWithPath:path];
+    if (!file) {
+        BugSplatLogWarning(@"Could not open launch state; terminations without a crash report will not be detected");
+        return;
+    }
+
+    NSString *appVersion = self.resolvedApplicationVersion;
+    NSString *osVersion = [BugSplatLaunchStateFile operatingSystemVersion];
+    BugSplatLaunchContext context = {
+        .appVersion = appVersion.UTF8String,
+        .osVersion = osVersion.UTF8String,
+        .bootTime = [BugSplatLaunchStateFile bootTime],
+        .crashReported = [self.crashReporter hasPendingCrashReport],
+    };
+    self.previousSessionTermination = BugSplatLaunchStateInferTermination(file.previousState, &context);
+    if (file.previousState) {
+        BugSplatLogInfo(@"Previous launch ended: %s", BugSplatTerminationName(self.previousSessionTermination));
+    }
+
+    [file beginLaunchWithAppVersion:appVersion];
+    if ([self isDebuggerAttached]) {
+        atomic_store_explicit(&file.state->debuggerAttached, 1, memory_order_relaxed);
+    }
+    [file recordMemoryFootprint];
+    [file activate];
+    self.launchStateFile = file;
+#endif
+}
+
+/**
+ * Keep this launch's state current: app state from UIKit notifications, and the memory
+ * footprint every few seconds and whenever the system reports memory pressure.
+ */
+- (void)startLaunchStateMonitoring
+{
+#if TARGET_OS_IOS || TARGET_OS_TV
+    BugSplatLaunchStateFile *file = self.launchStateFile;
+    if (!file || self.launchStateTimer || self.isTestInstance) {
+        return;
+    }
+    void (^setAppState)(BugSplatLaunchAppState) = ^(BugSplatLaunchAppState appState) {
+        BugSplatLaunchStateSetAppState(file.state, appState, [BugSplatLaunchStateFile now]);
+    };
+    switch ([UIApplication sharedApplication].applicationState) {
+        case UIApplicationStateActive: setAppState(BugSplatLaunchAppStateActive); break;
+        case UIApplicationStateInactive: setAppState(BugSplatLaunchAppStateInactive); break;
+        case UIApplicationStateBackground: setAppState(BugSplatLaunchAppStateBackground); break;
+    }
+
+    NSNotificationCenter *center = [NSNotificationCenter defaultCenter];
+    NSOperationQueue *mainQueue = [NSOperationQueue mainQueue];
+    NSDictionary<NSNotificationName, NSNumber *> *transitions = @{
+        UIApplicationDidBecomeActiveNotification: @(BugSplatLaunchAppStateActive),
+        UIApplicationWillResignActiveNotification: @(BugSplatLaunchAppStateInactive),
+        UIApplicationWillEnterForegroundNotification: @(BugSplatLaunchAppStateInactive),
+        UIApplicationDidEnterBackgroundNotification: @(BugSplatLaunchAppStateBackground),
+    };
+    [transitions enumerateKeysAndObjectsUsingBlock:^(NSNotificationName name, NSNumber *appState, BOOL *stop) {
+        [center addObserverForName:name object:nil queue:mainQueue usingBlock:^(NSNotification *note) {
+            setAppState((BugSplatLaunchAppState)appState.intValue);
+        }];
+    }];
+    [center addObserverForName:UIApplicationDidReceiveMemoryWarningNotification object:nil queue:mainQueue usingBlock:^(NSNotification *note) {
+        atomic_fetch_add_explicit(&file.state->memoryWarnings, 1, memory_order_relaxed);
+        [file recordMemoryFootprint];
+    }];
+
+    dispatch_queue_t queue = dispatch_queue_create("com.bugsplat.launch-state",
+                                                   dispatch_queue_attr_make_with_qos_class(DISPATCH_QUEUE_SERIAL, QOS_CLASS_UTILITY, 0));
+    dispatch_source_t timer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, queue);
+    dispatch_source_set_timer(timer, dispatch_time(DISPATCH_TIME_NOW, (int64_t)(kBugSplatLaunchStateSampleInterval * NSEC_PER_SEC)),
+                              (uint64_t)(kBugSplatLaunchStateSampleInterval * NSEC_PER_SEC),
+                              (uint64_t)(kBugSplatLaunchStateSampleInterval * NSEC_PER_SEC / 2));
+    dispatch_source_set_event_handler(timer, ^{
+        [file recordMemoryFootprint];
+    });
+    dispatch_resume(timer);
+    self.launchStateTimer = timer;
+
+    dispatch_source_t pressure = dispatch_source_create(DISPATCH_SOURCE_TYPE_MEMORYPRESSURE, 0,
+        DISPATCH_MEMORYPRESSURE_NORMAL | DISPATCH_MEMORYPRESSURE_WARN | DISPATCH_MEMORYPRESSURE_CRITICAL, queue);
+    dispatch_source_set_event_handler(pressure, ^{
+        unsigned long level = dispatch_source_get_data(pressure);
+        BugSplatLaunchStateSetMemoryPressure(file.state, (level & DISPATCH_MEMORYPRESSURE_CRITICAL) ? BugSplatLaunchMemoryPressureCritical
+                                                    : (level & DISPATCH_MEMORYPRESSURE_WARN) ? BugSplatLaunchMemoryPressureWarning
+                                                    : BugSplatLaunchMemoryPressureNormal);
+        [file recordMemoryFootprint];
+    });
+    dispatch_resume(pressure);
+    self.memoryPressureSource = pressure;
+#endif
+}
+
+/**
+ * Queue a report for a previous launch that was killed for memory or by the watchdog: it left
+ * no crash report of its own, so the report is the launch state it last recorded.
+ */
+- (void)queuePreviousSessionTerminationReport
+{
+    BugSplatTermination termination = self.previousSessionTermination;
+    const BugSplatLaunchState *previous = self.launchStateFile.previousState;
+    // Once per launch: the async ingest queue and a later -start must not queue it again.
+    self.previousSessionTermination = BugSplatTerminationUnknown;
+    if (!BugSplatTerminationIsReportable(termination) || !previous) {
+        return;
+    }
+    [self queueTerminationReportForState:previous termination:termination];
+}
+
+- (BOOL)queueTerminationReportForState:(const BugSplatLaunchState *)state termination:(BugSplatTermination)termination
+{
+    NSString *crashesDir = [self crashesDirectoryPath];
+    if (!crashesDir) {
+        return NO;
+    }
+
+    // The last time the previous launch is known to have been alive.
+    uint64_t lastSeen = MAX(atomic_load(&state->stateChangedAt), atomic_load(&state->footprintSampledAt));
+    lastSeen = MAX(lastSeen, state->launchTime);
+    NSDate *lastSeenDate = [NSDate dateWithTimeIntervalSince1970:(NSTimeInterval)lastSeen];
+    NSString *filename = [NSString stringWithFormat:@"%.0f%@", lastSeenDate.timeIntervalSinceReferenceDate * 1000.0,
+                          kBugSplatTerminationFilenameSuffix];
+    NSString *basePath = [crashesDir stringByAppendingPathComponent:filename];
+
+    NSString *(^megabytes)(uint64_t) = ^NSString *(uint64_t bytes) {
+        return [NSString stringWithFormat:@"%.1f", bytes / (1024.0 * 1024.0)];
+    };
+    uint64_t footprint = atomic_load(&state->footprint);
+    uint64_t footprintLimit = atomic_load(&state->footprintLimit);
+    NSString *appState = @(BugSplatLaunchAppStateName((BugSplatLaunchAppState)atomic_load(&state->appState)));
+    NSString *memoryPressure = @(BugSplatLaunchMemoryPressureName((BugSplatLaunchMemoryPressure)atomic_load(&state->memoryPressure)));
+    NSMutableDictionary<NSString *, NSString *> *terminationAttributes = [@{
+        kBugSplatTerminationAttrReason: @(BugSplatTerminationName(termination)),
+        kBugSplatTerminationAttrAppState: appState,
+        kBugSplatTerminationAttrFootprint: megabytes(footprint),
+        kBugSplatTerminationAttrPeakFootprint: megabytes(atomic_load(&state->peakFootprint)),
+        kBugSplatTerminationAttrMemoryPressure: memoryPressure,
+        kBugSplatTerminationAttrMemoryWarnings: [NSString stringWithFormat:@"%u", atomic_load(&state->memoryWarnings)],
+        kBugSplatTerminationAttrSessionSeconds: [NSString stringWithFormat:@"%llu", lastSeen - state->launchTime],
+    } mutableCopy];
+    if (footprintLimit > 0) {
+        terminationAttributes[kBugSplatTerminationAttrFootprintLimit] = megabytes(footprintLimit);
+    }
+
+    NSString *exceptionName = termination == BugSplatTerminationWatchdog ? @"Watchdog Termination (Inferred)" : @"Out of Memory (Inferred)";
+    NSString *explanation = termination == BugSplatTerminationWatchdog
+        ? @"The app was terminated while its main thread was hung, before a hang report could be written."
+        : @"The app was terminated in the foreground without a crash report; the system most likely reclaimed its memory.";
+    NSMutableString *reportText = [NSMutableString stringWithFormat:@"%@\n%@\n\n", exceptionName, explanation];
+    [reportText appendFormat:@"App Version:     %s\n", state->appVersion];
+    [reportText appendFormat:@"OS Version:      %s\n", state->osVersion];
+    [reportText appendFormat:@"Launched:        %@\n", [NSDate dateWithTimeIntervalSince1970:(NSTimeInterval)state->launchTime]];
+    [reportText appendFormat:@"Last Seen:       %@ (%@ s after launch)\n", lastSeenDate, terminationAttributes[kBugSplatTerminationAttrSessionSeconds]];
+    [reportText appendFormat:@"App State:       %@\n", appState];
+    [reportText appendFormat:@"Footprint:       %@ MB", terminationAttributes[kBugSplatTerminationAttrFootprint]];
+    if (footprintLimit > 0) {
+        [reportText appendFormat:@" of %@ MB", terminationAttributes[kBugSplatTerminationAttrFootprintLimit]];
+    }
+    [reportText appendFormat:@" (peak %@ MB)\n", terminationAttributes[kBugSplatTerminationAttrPeakFootprint]];
+    [reportText appendFormat:@"Memory Pressure: %@, %@ memory warnings\n", memoryPressure, terminationAttributes[kBugSplatTerminationAttrMemoryWarnings]];
+
+    // Sent without a dialog, like fatal hangs: nobody saw this session end.
+    NSDictionary *metadata = [self silentReportMetadataWithTimestamp:lastSeenDate];
+    metadata = [self metadata:metadata addingAttributes:self.previousSessionLatencyAttributes];
+    metadata = [self metadata:metadata addingAttributes:terminationAttributes];
+
+    BOOL written = [[reportText dataUsingEncoding:NSUTF8StringEncoding] writeToFile:[basePath stringByAppendingPathExtension:kBugSplatCrashFileExtension]
+                                                                         atomically:YES]
+        && [BugSplatMetadataCodec writeMetadata:metadata toFile:[basePath stringByAppendingPathExtension:kBugSplatMetaFileExtension]];
+    if (!written) {
+        BugSplatLogError(@"Failed to queue termination report");
+        [self cleanupCrashReportWithFilename:filename];
+        return NO;
+    }
+    [self persistAttachments:@[] withPreviousSessionAttachmentsForCrashFilename:filename];
+    BugSplatLogInfo(@"Queued %s termination report %@ (footprint %@ MB, %@)", BugSplatTerminationName(termination),
+                    filename, terminationAttributes[kBugSplatTerminationAttrFootprint], appState);
+    return YES;
 }
 
 #pragma mark - Crash Report Handling
@@ -565,79 +2231,184 @@ didDetectHangWithDuration:(NSTimeInterval)duration
  */
 - (void)handleNewCrashFromPLCrashReporter
 {
-    NSLog(@"BugSplat: Processing new crash report from PLCrashReporter...");
+    BugSplatLogDebug(@"Processing new crash report from PLCrashReporter...");
+    
+    NSData *crashData = [self loadPendingCrashReportData];
+    if (crashData) {
+        [self persistCrashReportData:crashData];
+    }
     
+    // IMPORTANT: Purge PLCrashReporter's pending report now that we've saved a copy
+    // This ensures we don't process the same crash twice
+    [self.crashReporter purgePendingCrashReport];
+    BugSplatLogDebug(@"Purged PLCrashReporter pending report (copy saved for retry)");
+}
+
+/**
+ * Load the raw pending report from PLCrashReporter. Returns nil if it cannot be read;
+ * the caller is responsible for purging the pending report either way.
+ */
+- (nullable NSData *)loadPendingCrashReportData
+{
     NSError *error = nil;
     NSData *crashData = nil;
     
     @try {
         crashData = [self.crashReporter loadPendingCrashReportDataAndReturnError:&error];
     } @catch (NSException *exception) {
-        NSLog(@"BugSplat: Exception loading crash report: %@ - %@", exception.name, exception.reason);
-        [self.crashReporter purgePendingCrashReport];
-        return;
+        BugSplatLogError(@"Exception loading crash report: %@ - %@", exception.name, exception.reason);
+        return nil;
     }
     
     if (!crashData || crashData.length == 0) {
-        NSLog(@"BugSplat: Failed to load crash report: %@", error);
-        [self.crashReporter purgePendingCrashReport];
+        BugSplatLogError(@"Failed to load crash report: %@", error);
+        return nil;
+    }
+    return crashData;
+}
+
+/**
+ * Write a raw PLCrashReporter report to the crashes directory as it is, before anything
+ * parses it. `persistCrashReportData:stagedFilename:fromPreviousSession:` completes it;
+ * until then it has no metadata, which is how a later launch recognises it.
+ *
+ * @return The report's basename, or nil if it could not be written.
+ */
+- (nullable NSString *)stageRawCrashReportData:(NSData *)crashData
+{
+    NSString *crashesDir = [self crashesDirectoryPath];
+    if (!crashesDir) {
+        BugSplatLogError(@"Failed to get crashes directory");
+        return nil;
+    }
+    NSString *crashFilename = [NSString stringWithFormat:@"%.0f", [NSDate timeIntervalSinceReferenceDate]];
+    NSString *rawFilePath = [[crashesDir stringByAppendingPathComponent:crashFilename]
+                             stringByAppendingPathExtension:kBugSplatRawCrashFileExtension];
+    if (![crashData writeToFile:rawFilePath atomically:YES]) {
+        BugSplatLogError(@"Failed to stage crash report");
+        return nil;
+    }
+    return crashFilename;
+}
+
+/**
+ * Persist raw reports staged by an earlier launch that ended before it got to them. Such a
+ * report has no metadata and is named for a time before this process started; anything
+ * newer is this process's own and may still be mid-write.
+ */
+- (void)resumeInterruptedCrashIngestion
+{
+    NSDate *processStartDate = [BugSplatLaunchTimeline currentProcessStartDate];
+    if (!processStartDate) {
         return;
     }
+    NSString *crashesDir = [self crashesDirectoryPath];
+    NSFileManager *fileManager = [NSFileManager defaultManager];
+    for (NSString *crashFilename in [self getPendingCrashFiles]) {
+        if (crashFilename.doubleValue >= processStartDate.timeIntervalSinceReferenceDate) {
+            continue;
+        }
+        NSString *basePath = [crashesDir stringByAppendingPathComponent:crashFilename];
+        if ([fileManager fileExistsAtPath:[basePath stringByAppendingPathExtension:kBugSplatMetaFileExtension]]) {
+            continue;
+        }
+        NSData *crashData = [NSData dataWithContentsOfFile:[basePath stringByAppendingPathExtension:kBugSplatRawCrashFileExtension]];
+        if (!crashData) {
+            continue;
+        }
+        BugSplatLogInfo(@"Resuming ingestion of staged crash report %@", crashFilename);
+        [self persistCrashReportData:crashData stagedFilename:crashFilename fromPreviousSession:NO];
+    }
+}
+
+- (void)persistCrashReportData:(NSData *)crashData
+{
+    [self persistCrashReportData:crashData stagedFilename:nil fromPreviousSession:YES];
+}
+
+/**
+ * Parse a raw PLCrashReporter report and persist its text, attachments and metadata
+ * to the crashes directory.
+ *
+ * @param stagedFilename Basename the raw report was already staged under, or nil.
+ * @param fromPreviousSession NO when the report is older than the previous session, whose
+ *        log, resource samples and latencies then say nothing about it.
+ */
+- (void)persistCrashReportData:(NSData *)crashData
+                stagedFilename:(nullable NSString *)stagedFilename
+           fromPreviousSession:(BOOL)fromPreviousSession
+{
+    NSError *error = nil;
     
-    // Parse crash report to get text representation
+    // Parse crash report for its timestamp and crash-time customData
     PLCrashReport *crashReport = nil;
-    NSString *crashReportText = nil;
     
     @try {
         crashReport = [[PLCrashReport alloc] initWithData:crashData error:&error];
-        if (crashReport) {
-            crashReportText = [PLCrashReportTextFormatter stringValueForCrashReport:crashReport
-                                                                     withTextFormat:PLCrashReportTextFormatiOS];
-        }
     } @catch (NSException *exception) {
-        NSLog(@"BugSplat: Exception parsing crash report: %@ - %@", exception.name, exception.reason);
+        BugSplatLogError(@"Exception parsing crash report: %@ - %@", exception.name, exception.reason);
     }
     
-    // Ensure we have some crash report text
-    if (!crashReportText || crashReportText.length == 0) {
-        crashReportText = @"[Crash report text unavailable]";
+    // Use the actual crash time from the crash report, fall back to current time if unavailable
+    NSDate *crashTimestamp = crashReport.systemInfo.timestamp ?: [NSDate date];
+    
+    // Fold a repeat of a crash that is already queued into that report instead of persisting a new one
+    NSString *signature = nil;
+    if (self.coalesceRepeatedCrashes && crashReport) {
+        signature = [BugSplatCrashSignature signatureForCrashReport:crashReport frameCount:kBugSplatCrashSignatureFrameCount];
+        if (signature && [self coalesceCrashWithSignature:signature timestamp:crashTimestamp]) {
+            if (stagedFilename) {
+                [self cleanupCrashReportWithFilename:stagedFilename];
+            }
+            return;
+        }
     }
     
     // Generate a unique filename for this crash based on timestamp
-    NSString *crashFilename = [NSString stringWithFormat:@"%.0f", [NSDate timeIntervalSinceReferenceDate]];
+    NSString *crashFilename = stagedFilename ?: [NSString stringWithFormat:@"%.0f", [NSDate timeIntervalSinceReferenceDate]];
     self.currentCrashFilename = crashFilename;
     
-    // Persist the crash report text to disk
+    // Persist the crash report to disk
     NSString *crashesDir = [self crashesDirectoryPath];
     if (!crashesDir) {
-        NSLog(@"BugSplat: Failed to get crashes directory");
-        [self.crashReporter purgePendingCrashReport];
-        return;
-    }
-    
-    NSData *textCrashData = [crashReportText dataUsingEncoding:NSUTF8StringEncoding];
-    if (!textCrashData) {
-        NSLog(@"BugSplat: Failed to encode crash report text");
-        [self.crashReporter purgePendingCrashReport];
+        BugSplatLogError(@"Failed to get crashes directory");
         return;
     }
     
+    // Either the raw report, formatted when it is first picked up for submission, or its text
+    // streamed straight to disk
+    BOOL writeRaw = self.deferCrashReportFormatting && crashReport;
+    NSString *crashFileExtension = writeRaw ? kBugSplatRawCrashFileExtension : kBugSplatCrashFileExtension;
     NSString *crashFilePath = [[crashesDir stringByAppendingPathComponent:crashFilename] 
-                               stringByAppendingPathExtension:kBugSplatCrashFileExtension];
-    BOOL writeSuccess = [textCrashData writeToFile:crashFilePath atomically:YES];
+                               stringByAppendingPathExtension:crashFileExtension];
+    BOOL writeSuccess = NO;
+    if (writeRaw) {
+        writeSuccess = stagedFilename || [crashData writeToFile:crashFilePath atomically:YES];
+    } else {
+        writeSuccess = crashReport && [self writeTextForCrashReport:crashReport toFile:crashFilePath];
+        if (!writeSuccess) {
+            // Ensure we have some crash report text
+            writeSuccess = [[@"[Crash report text unavailable]" dataUsingEncoding:NSUTF8StringEncoding] writeToFile:crashFilePath atomically:YES];
+        }
+    }
     if (!writeSuccess) {
-        NSLog(@"BugSplat: Failed to write crash report to disk");
-        [self.crashReporter purgePendingCrashReport];
+        BugSplatLogError(@"Failed to write crash report to disk");
         return;
     }
     
-    NSLog(@"BugSplat: Persisted crash report to %@.%@", crashFilename, kBugSplatCrashFileExtension);
+    BugSplatLogInfo(@"Persisted crash report to %@.%@", crashFilename, crashFileExtension);
+    
+    // In launch crash safe mode, skip everything that runs app code or reads more than the report
+    BOOL safeMode = self.inLaunchCrashSafeMode;
     
     // IMMEDIATELY gather attachments from delegate and persist to disk
     // This captures attachment data early, before app state changes
     NSMutableArray<BugSplatAttachment *> *attachments = [NSMutableArray array];
     
     @try {
+        if (safeMode) {
+            // No attachments
+        } else
 #if TARGET_OS_OSX
         if ([self.delegate respondsToSelector:@selector(attachmentsForBugSplat:)]) {
             NSArray *delegateAttachments = [self.delegate attachmentsForBugSplat:self];
@@ -653,7 +2424,18 @@ didDetectHangWithDuration:(NSTimeInterval)duration
             }
         }
     } @catch (NSException *exception) {
-        NSLog(@"BugSplat: Exception in delegate attachment method: %@ - %@", exception.name, exception.reason);
+        BugSplatLogError(@"Exception in delegate attachment method: %@ - %@", exception.name, exception.reason);
+    }
+    
+    // What the crashed session wrote to the log buffer, and its resource usage
+    BOOL attachSessionContext = fromPreviousSession && !safeMode;
+    BugSplatAttachment *logAttachment = attachSessionContext ? [self previousSessionLogAttachment] : nil;
+    if (logAttachment) {
+        [attachments addObject:logAttachment];
+    }
+    BugSplatAttachment *resourceAttachment = attachSessionContext ? [self previousSessionResourceAttachment] : nil;
+    if (resourceAttachment) {
+        [attachments addObject:resourceAttachment];
     }
     
     // Persist attachments to disk with crash filename prefix
@@ -665,25 +2447,24 @@ didDetectHangWithDuration:(NSTimeInterval)duration
     // The crash-time properties are embedded in the crash report via PLCrashReporter's customData
     NSMutableDictionary *metadata = [NSMutableDictionary dictionary];
     
-    // Use the actual crash time from the crash report, fall back to current time if unavailable
-    NSDate *crashTimestamp = crashReport.systemInfo.timestamp ?: [NSDate date];
-    
     // Store as ISO 8601 string for reliable persistence and API compatibility
     NSISO8601DateFormatter *isoFormatter = [[NSISO8601DateFormatter alloc] init];
     isoFormatter.formatOptions = NSISO8601DateFormatWithInternetDateTime;
     NSString *crashTimeISO = [isoFormatter stringFromDate:crashTimestamp];
     metadata[kBugSplatMetaKeyTimestamp] = crashTimeISO;
+    if (signature) {
+        metadata[kBugSplatMetaKeySignature] = signature;
+    }
     
     // Extract crash-time properties from PLCrashReporter's customData
     // This data was set BEFORE the crash occurred and is bundled WITH the crash
+    // Crashes from SDK versions before the binary format carry a keyed archive; the codec reads both.
     NSDictionary *crashTimeProperties = nil;
     if (crashReport.customData) {
         @try {
-            crashTimeProperties = [NSKeyedUnarchiver unarchivedObjectOfClass:[NSDictionary class]
-                                                                    fromData:crashReport.customData
-                                                                       error:nil];
+            crashTimeProperties = [BugSplatMetadataCodec metadataWithData:crashReport.customData];
         } @catch (NSException *exception) {
-            NSLog(@"BugSplat: Exception deserializing customData: %@ - %@", exception.name, exception.reason);
+            BugSplatLogError(@"Exception deserializing customData: %@ - %@", exception.name, exception.reason);
         }
     }
     
@@ -714,14 +2495,14 @@ didDetectHangWithDuration:(NSTimeInterval)duration
             metadata[kBugSplatMetaKeyAttributes] = crashTimeProperties[kBugSplatMetaKeyAttributes];
         }
         
-        NSLog(@"BugSplat: Extracted crash-time metadata from crash report - database: %@, app: %@ %@",
+        BugSplatLogDebug(@"Extracted crash-time metadata from crash report - database: %@, app: %@ %@",
               metadata[kBugSplatMetaKeyDatabase],
               metadata[kBugSplatMetaKeyApplicationName],
               metadata[kBugSplatMetaKeyApplicationVersion]);
     } else {
         // No customData in crash report - this is an old crash or customData wasn't set
         // Fall back to current values
-        NSLog(@"BugSplat: No crash-time metadata in crash report, using current values");
+        BugSplatLogDebug(@"No crash-time metadata in crash report, using current values");
         metadata[kBugSplatMetaKeyDatabase] = self.bugSplatDatabase;
         metadata[kBugSplatMetaKeyApplicationName] = self.resolvedApplicationName;
         metadata[kBugSplatMetaKeyApplicationVersion] = self.resolvedApplicationVersion;
@@ -729,28 +2510,98 @@ didDetectHangWithDuration:(NSTimeInterval)duration
         if (self.userEmail) metadata[kBugSplatMetaKeyUserEmail] = self.userEmail;
         if (self.appKey) metadata[kBugSplatMetaKeyAppKey] = self.appKey;
         if (self.notes) metadata[kBugSplatMetaKeyNotes] = self.notes;
-        if (self.attributes) metadata[kBugSplatMetaKeyAttributes] = self.attributes;
+        NSDictionary<NSString *, NSString *> *attributes = self.attributes;
+        if (attributes) metadata[kBugSplatMetaKeyAttributes] = attributes;
     }
     
     // Get application log from delegate
     @try {
-        if ([self.delegate respondsToSelector:@selector(applicationLogForBugSplat:)]) {
+        if (!safeMode && [self.delegate respondsToSelector:@selector(applicationLogForBugSplat:)]) {
             NSString *appLog = [self.delegate applicationLogForBugSplat:self];
             if (appLog) metadata[kBugSplatMetaKeyApplicationLog] = appLog;
         }
     } @catch (NSException *exception) {
-        NSLog(@"BugSplat: Exception in applicationLogForBugSplat delegate: %@ - %@", exception.name, exception.reason);
+        BugSplatLogError(@"Exception in applicationLogForBugSplat delegate: %@ - %@", exception.name, exception.reason);
     }
     
-    // Persist metadata
+    // Persist metadata, with how responsive the crashed session's main thread was, or how
+    // many launches in a row have crashed
+    NSDictionary<NSString *, NSString *> *extraAttributes = fromPreviousSession ? self.previousSessionLatencyAttributes : nil;
+    if (safeMode) {
+        metadata[kBugSplatMetaKeyUserSubmitted] = @YES;
+        extraAttributes = @{ kBugSplatLaunchCrashAttrCount: [NSString stringWithFormat:@"%lu", (unsigned long)self.launchCrashCount] };
+    }
     NSString *metaFilePath = [[crashesDir stringByAppendingPathComponent:crashFilename] 
                               stringByAppendingPathExtension:kBugSplatMetaFileExtension];
-    [metadata writeToFile:metaFilePath atomically:YES];
+    [BugSplatMetadataCodec writeMetadata:[self metadata:metadata addingAttributes:extraAttributes]
+                                  toFile:metaFilePath];
     
-    // IMPORTANT: Purge PLCrashReporter's pending report now that we've saved a copy
-    // This ensures we don't process the same crash twice
-    [self.crashReporter purgePendingCrashReport];
-    NSLog(@"BugSplat: Purged PLCrashReporter pending report (copy saved for retry)");
+    // The text now stands in for the staged raw report
+    if (stagedFilename && !writeRaw) {
+        [[NSFileManager defaultManager] removeItemAtPath:[[crashesDir stringByAppendingPathComponent:crashFilename]
+                                                          stringByAppendingPathExtension:kBugSplatRawCrashFileExtension]
+                                                   error:nil];
+    }
+}
+
+/**
+ * Merge a crash into the newest pending report with the same signature whose last occurrence
+ * is within `crashCoalescingWindow`. The merged report keeps the first occurrence's text and
+ * attachments; its metadata and attributes carry the occurrence count and first/last times.
+ *
+ * @return YES if the crash was merged and needs no report of its own.
+ */
+- (BOOL)coalesceCrashWithSignature:(NSString *)signature timestamp:(NSDate *)crashTimestamp
+{
+    NSString *crashesDir = [self crashesDirectoryPath];
+    if (!crashesDir) {
+        return NO;
+    }
+    
+    NSISO8601DateFormatter *isoFormatter = [[NSISO8601DateFormatter alloc] init];
+    isoFormatter.formatOptions = NSISO8601DateFormatWithInternetDateTime;
+    
+    for (NSString *crashFilename in [[self getPendingCrashFiles] reverseObjectEnumerator]) {
+        NSString *metaFilePath = [[crashesDir stringByAppendingPathComponent:crashFilename]
+                                  stringByAppendingPathExtension:kBugSplatMetaFileExtension];
+        NSDictionary *metadata = [BugSplatMetadataCodec metadataWithContentsOfFile:metaFilePath];
+        if (![metadata[kBugSplatMetaKeySignature] isEqual:signature]) {
+            continue;
+        }
+        
+        NSString *firstOccurrenceISO = metadata[kBugSplatMetaKeyTimestamp];
+        NSString *lastOccurrenceISO = metadata[kBugSplatMetaKeyLastOccurrence] ?: firstOccurrenceISO;
+        NSDate *lastOccurrence = lastOccurrenceISO ? [isoFormatter dateFromString:lastOccurrenceISO] : nil;
+        if (!lastOccurrence || [crashTimestamp timeIntervalSinceDate:lastOccurrence] > self.crashCoalescingWindow) {
+            continue;
+        }
+        
+        NSUInteger occurrenceCount = MAX([metadata[kBugSplatMetaKeyOccurrenceCount] unsignedIntegerValue], 1) + 1;
+        NSString *crashTimeISO = [isoFormatter stringFromDate:crashTimestamp];
+        
+        NSMutableDictionary *updatedMetadata = [metadata mutableCopy];
+        updatedMetadata[kBugSplatMetaKeyOccurrenceCount] = @(occurrenceCount);
+        updatedMetadata[kBugSplatMetaKeyLastOccurrence] = crashTimeISO;
+        
+        NSMutableDictionary<NSString *, NSString *> *attributes = [metadata[kBugSplatMetaKeyAttributes] mutableCopy]
+            ?: [NSMutableDictionary dictionary];
+        attributes[kBugSplatCoalesceAttrOccurrenceCount] = [NSString stringWithFormat:@"%lu", (unsigned long)occurrenceCount];
+        attributes[kBugSplatCoalesceAttrFirstOccurrence] = firstOccurrenceISO ?: crashTimeISO;
+        attributes[kBugSplatCoalesceAttrLastOccurrence] = crashTimeISO;
+        updatedMetadata[kBugSplatMetaKeyAttributes] = attributes;
+        
+        if (![BugSplatMetadataCodec writeMetadata:updatedMetadata toFile:metaFilePath]) {
+            BugSplatLogError(@"Failed to update coalesced crash metadata for %@", crashFilename);
+            return NO;
+        }
+        
+        self.currentCrashFilename = crashFilename;
+        BugSplatLogInfo(@"Coalesced repeated crash into pending report %@ (%lu occurrences)",
+              crashFilename, (unsigned long)occurrenceCount);
+        return YES;
+    }
+    
+    return NO;
 }
 
 /**
@@ -764,17 +2615,17 @@ didDetectHangWithDuration:(NSTimeInterval)duration
 - (void)processPendingCrashReports
 {
     if (self.sendingInProgress) {
-        NSLog(@"BugSplat: Sending already in progress, skipping");
+        BugSplatLogDebug(@"Sending already in progress, skipping");
         return;
     }
     
     NSArray<NSString *> *pendingCrashFiles = [self getPendingCrashFiles];
     if (pendingCrashFiles.count == 0) {
-        NSLog(@"BugSplat: No pending crash reports found");
+        BugSplatLogDebug(@"No pending crash reports found");
         return;
     }
     
-    NSLog(@"BugSplat: Found %lu pending crash report(s)", (unsigned long)pendingCrashFiles.count);
+    BugSplatLogInfo(@"Found %lu pending crash report(s)", (unsigned long)pendingCrashFiles.count);
     self.sendingInProgress = YES;
     
     // Process the newest crash first (last in the sorted array)
@@ -782,23 +2633,24 @@ didDetectHangWithDuration:(NSTimeInterval)duration
     NSString *crashFilename = pendingCrashFiles.lastObject;
     self.currentCrashFilename = crashFilename;
     
-    NSString *crashesDir = [self crashesDirectoryPath];
-    NSString *crashFilePath = [[crashesDir stringByAppendingPathComponent:crashFilename] 
-                               stringByAppendingPathExtension:kBugSplatCrashFileExtension];
-    
-    // Load crash report text
-    NSData *crashData = [NSData dataWithContentsOfFile:crashFilePath];
-    if (!crashData || crashData.length == 0) {
-        NSLog(@"BugSplat: Failed to load crash report from %@, cleaning up", crashFilename);
-        [self cleanupCrashReportWithFilename:crashFilename];
-        self.sendingInProgress = NO;
-        [self processPendingCrashReports];
+    // Reports persisted in raw form are formatted on first use; keep that work off the main thread.
+    if ([NSThread isMainThread] && [self isRawOnlyCrashReportWithFilename:crashFilename]) {
+        dispatch_async(self.ingestQueue, ^{
+            [self processPendingCrashReportWithFilename:crashFilename];
+        });
         return;
     }
+    [self processPendingCrashReportWithFilename:crashFilename];
+}
+
+- (void)processPendingCrashReportWithFilename:(NSString *)crashFilename
+{
+    NSString *crashesDir = [self crashesDirectoryPath];
     
-    NSString *crashReportText = [[NSString alloc] initWithData:crashData encoding:NSUTF8StringEncoding];
-    if (!crashReportText) {
-        NSLog(@"BugSplat: Failed to decode crash report text, cleaning up");
+    // Load crash report bytes; they go into the upload archive as-is.
+    NSData *crashReportData = [self crashReportDataForFilename:crashFilename];
+    if (!crashReportData) {
+        BugSplatLogWarning(@"Failed to load crash report from %@, cleaning up", crashFilename);
         [self cleanupCrashReportWithFilename:crashFilename];
         self.sendingInProgress = NO;
         [self processPendingCrashReports];
@@ -808,29 +2660,136 @@ didDetectHangWithDuration:(NSTimeInterval)duration
     // Load metadata
     NSString *metaFilePath = [[crashesDir stringByAppendingPathComponent:crashFilename] 
                               stringByAppendingPathExtension:kBugSplatMetaFileExtension];
-    NSDictionary *metadata = [NSDictionary dictionaryWithContentsOfFile:metaFilePath];
+    NSDictionary *metadata = [BugSplatMetadataCodec metadataWithContentsOfFile:metaFilePath];
     
     // Determine if we should send silently or show a dialog
     BOOL sendSilently = [self shouldSendCrashSilently:metadata];
     
     if (sendSilently) {
-        NSLog(@"BugSplat: Sending crash %@ silently", crashFilename);
+        BugSplatLogDebug(@"Sending crash %@ silently", crashFilename);
         [self submitCrashSilentlyWithFilename:crashFilename
-                              crashReportText:crashReportText
+                              crashReportData:crashReportData
                                      metadata:metadata];
     } else {
 #if TARGET_OS_OSX
         [self showCrashReportDialogForFilename:crashFilename 
-                               crashReportText:crashReportText 
+                               crashReportData:crashReportData 
                                       metadata:metadata];
 #else
         [self showCrashReportAlertForFilename:crashFilename 
-                              crashReportText:crashReportText 
+                              crashReportData:crashReportData 
                                      metadata:metadata];
 #endif
     }
 }
 
+/**
+ * Returns YES when a report was persisted as raw PLCrashReporter data and has not been
+ * formatted yet.
+ */
+- (BOOL)isRawOnlyCrashReportWithFilename:(NSString *)crashFilename
+{
+    NSString *basePath = [[self crashesDirectoryPath] stringByAppendingPathComponent:crashFilename];
+    NSFileManager *fileManager = [NSFileManager defaultManager];
+    return ![fileManager fileExistsAtPath:[basePath stringByAppendingPathExtension:kBugSplatCrashFileExtension]]
+        && [fileManager fileExistsAtPath:[basePath stringByAppendingPathExtension:kBugSplatRawCrashFileExtension]];
+}
+
+/**
+ * Load the text of a persisted report as UTF-8 bytes. The .crash file is memory-mapped where
+ * the file system allows it and is not decoded; see crashReportDisplayTextForData: for the
+ * one place that needs a string. Raw reports are formatted here and the text is cached as the
+ * report's .crash file, so retries after a failed upload don't format again.
+ * Returns nil if the report is missing or empty.
+ */
+- (nullable NSData *)crashReportDataForFilename:(NSString *)crashFilename
+{
+    NSString *basePath = [[self crashesDirectoryPath] stringByAppendingPathComponent:crashFilename];
+    NSString *crashFilePath = [basePath stringByAppendingPathExtension:kBugSplatCrashFileExtension];
+    
+    // Persisted files are only ever replaced atomically, never truncated in place, so the
+    // mapping stays valid for as long as the upload holds on to it.
+    NSData *crashData = [NSData dataWithContentsOfFile:crashFilePath options:NSDataReadingMappedIfSafe error:nil];
+    if (crashData.length > 0) {
+        return crashData;
+    }
+    
+    NSString *rawFilePath = [basePath stringByAppendingPathExtension:kBugSplatRawCrashFileExtension];
+    NSData *rawData = [NSData dataWithContentsOfFile:rawFilePath options:NSDataReadingMappedIfSafe error:nil];
+    if (rawData.length == 0) {
+        return nil;
+    }
+    
+    // The text is streamed into the .crash file, then mapped back in for the upload.
+    if ([self writeTextForCrashReportData:rawData toFile:crashFilePath]) {
+        [[NSFileManager defaultManager] removeItemAtPath:rawFilePath error:nil];
+        BugSplatLogDebug(@"Formatted deferred crash report %@", crashFilename);
+        return [NSData dataWithContentsOfFile:crashFilePath options:NSDataReadingMappedIfSafe error:nil];
+    }
+    
+    NSData *textCrashData = [@"[Crash report text unavailable]" dataUsingEncoding:NSUTF8StringEncoding];
+    if ([textCrashData writeToFile:crashFilePath atomically:YES]) {
+        [[NSFileManager defaultManager] removeItemAtPath:rawFilePath error:nil];
+    } else {
+        BugSplatLogWarning(@"Failed to cache formatted crash report %@; will format again on retry", crashFilename);
+    }
+    return textCrashData;
+}
+
+#if TARGET_OS_OSX
+/**
+ * Decode report bytes for display in the crash report dialog. This is the only consumer
+ * that needs a string, so it is also the only place the bytes are validated as UTF-8.
+ */
+- (NSString *)crashReportDisplayTextForData:(NSData *)crashReportData
+{
+    NSString *crashReportText = [[NSString alloc] initWithData:crashReportData encoding:NSUTF8StringEncoding];
+    if (!crashReportText) {
+        BugSplatLogWarning(@"Crash report is not valid UTF-8; showing it lossily converted");
+        crashReportText = [[NSString alloc] initWithData:crashReportData encoding:NSISOLatin1StringEncoding];
+    }
+    return crashReportText ?: @"[Crash report text unavailable]";
+}
+#endif
+
+/**
+ * Parse raw PLCrashReporter data and stream its text to `path`, replacing the file only once
+ * complete. Returns NO on failure, leaving `path` untouched.
+ */
+- (BOOL)writeTextForCrashReportData:(NSData *)crashData toFile:(NSString *)path
+{
+    PLCrashReport *crashReport = nil;
+    @try {
+        NSError *error = nil;
+        crashReport = [[PLCrashReport alloc] initWithData:crashData error:&error];
+        if (!crashReport) {
+            BugSplatLogError(@"Failed to parse crash report: %@", error);
+            return NO;
+        }
+    } @catch (NSException *exception) {
+        BugSplatLogError(@"Exception parsing crash report: %@ - %@", exception.name, exception.reason);
+        return NO;
+    }
+    return [self writeTextForCrashReport:crashReport toFile:path];
+}
+
+/// Stream the text of a parsed report to `path`. Returns NO on failure.
+- (BOOL)writeTextForCrashReport:(PLCrashReport *)crashReport toFile:(NSString *)path
+{
+    @try {
+        BugSplatCrashReportTextOptions *options = self.slimCrashReports
+            ? [BugSplatCrashReportTextOptions slimOptionsWithFrameLimit:self.slimmedThreadFrameLimit]
+            : nil;
+        if ([BugSplatCrashReportTextWriter writeCrashReport:crashReport toFile:path options:options]) {
+            return YES;
+        }
+        BugSplatLogError(@"Failed to write crash report text");
+    } @catch (NSException *exception) {
+        BugSplatLogError(@"Exception formatting crash report: %@ - %@", exception.name, exception.reason);
+    }
+    return NO;
+}
+
 /**
  * Determine if a crash should be sent silently (without showing a dialog).
  */
@@ -853,12 +2812,12 @@ didDetectHangWithDuration:(NSTimeInterval)duration
         if (self.expirationTimeInterval > 0 && timestamp) {
             NSTimeInterval timeSinceCrash = [[NSDate date] timeIntervalSince1970] - timestamp.doubleValue;
             if (timeSinceCrash > self.expirationTimeInterval) {
-                NSLog(@"BugSplat: Crash report expired (%.0f seconds old)", timeSinceCrash);
+                BugSplatLogInfo(@"Crash report expired (%.0f seconds old)", timeSinceCrash);
                 return YES;
             }
         }
     } @catch (NSException *exception) {
-        NSLog(@"BugSplat: Exception checking crash report expiration: %@ - %@", exception.name, exception.reason);
+        BugSplatLogError(@"Exception checking crash report expiration: %@ - %@", exception.name, exception.reason);
     }
 #else
     // iOS: User chose "Always Send"
@@ -874,12 +2833,12 @@ didDetectHangWithDuration:(NSTimeInterval)duration
  * Submit a crash report silently (without user interaction).
  */
 - (void)submitCrashSilentlyWithFilename:(NSString *)crashFilename
-                        crashReportText:(NSString *)crashReportText
+                        crashReportData:(NSData *)crashReportData
                                metadata:(NSDictionary *)metadata
 {
     // Use ONLY values from the per-crash metadata - no fallbacks to current values
     [self submitPersistedCrashReportWithFilename:crashFilename 
-                                 crashReportText:crashReportText 
+                                 crashReportData:crashReportData 
                                         metadata:metadata 
                                         userName:metadata[kBugSplatMetaKeyUserName]
                                        userEmail:metadata[kBugSplatMetaKeyUserEmail]
@@ -904,18 +2863,21 @@ didDetectHangWithDuration:(NSTimeInterval)duration
         return @[];
     }
     
-    NSMutableArray<NSString *> *crashFilenames = [NSMutableArray array];
+    // A report may exist as formatted text, raw data awaiting formatting, or briefly both.
+    NSMutableSet<NSString *> *crashFilenameSet = [NSMutableSet set];
     NSString *crashExtension = [NSString stringWithFormat:@".%@", kBugSplatCrashFileExtension];
+    NSString *rawCrashExtension = [NSString stringWithFormat:@".%@", kBugSplatRawCrashFileExtension];
     
     for (NSString *filename in files) {
-        if ([filename hasSuffix:crashExtension]) {
+        if ([filename hasSuffix:crashExtension] || [filename hasSuffix:rawCrashExtension]) {
             // Extract base filename without extension
             NSString *baseName = [filename stringByDeletingPathExtension];
-            [crashFilenames addObject:baseName];
+            [crashFilenameSet addObject:baseName];
         }
     }
     
     // Sort by filename (which is timestamp-based) to process oldest first
+    NSMutableArray<NSString *> *crashFilenames = [[crashFilenameSet allObjects] mutableCopy];
     [crashFilenames sortUsingSelector:@selector(compare:)];
     
     return crashFilenames;
@@ -923,7 +2885,7 @@ didDetectHangWithDuration:(NSTimeInterval)duration
 
 #if TARGET_OS_OSX
 - (void)showCrashReportDialogForFilename:(NSString *)crashFilename
-                         crashReportText:(NSString *)crashReportText
+                         crashReportData:(NSData *)crashReportData
                                 metadata:(NSDictionary *)metadata
 {
     // Notify delegate (wrapped to prevent crashes in crash handler)
@@ -932,7 +2894,7 @@ didDetectHangWithDuration:(NSTimeInterval)duration
             [self.delegate bugSplatWillShowSubmitCrashReportAlert:self];
         }
     } @catch (NSException *exception) {
-        NSLog(@"BugSplat: Exception in bugSplatWillShowSubmitCrashReportAlert delegate: %@ - %@", exception.name, exception.reason);
+        BugSplatLogError(@"Exception in bugSplatWillShowSubmitCrashReportAlert delegate: %@ - %@", exception.name, exception.reason);
     }
     
     dispatch_async(dispatch_get_main_queue(), ^{
@@ -940,7 +2902,7 @@ didDetectHangWithDuration:(NSTimeInterval)duration
             self.crashReportWindow = [[BugSplatCrashReportWindow alloc] init];
             self.crashReportWindow.applicationName = self.resolvedApplicationName;
             self.crashReportWindow.bannerImage = self.bannerImage;
-            self.crashReportWindow.crashReportText = crashReportText;
+            self.crashReportWindow.crashReportText = [self crashReportDisplayTextForData:crashReportData];
             self.crashReportWindow.askUserDetails = self.askUserDetails;
             
             if (self.persistUserDetails) {
@@ -960,7 +2922,7 @@ didDetectHangWithDuration:(NSTimeInterval)duration
                         // Submit this crash with user-provided details
                         // Note: After this completes, remaining crashes will be sent SILENTLY
                         [self submitPersistedCrashReportWithFilename:crashFilename
-                                                     crashReportText:crashReportText
+                                                     crashReportData:crashReportData
                                                             metadata:metadata
                                                             userName:userName
                                                            userEmail:userEmail
@@ -973,16 +2935,16 @@ didDetectHangWithDuration:(NSTimeInterval)duration
                                 [self.delegate bugSplatWillCancelSendingCrashReport:self];
                             }
                         } @catch (NSException *exception) {
-                            NSLog(@"BugSplat: Exception in bugSplatWillCancelSendingCrashReport delegate: %@ - %@", exception.name, exception.reason);
+                            BugSplatLogError(@"Exception in bugSplatWillCancelSendingCrashReport delegate: %@ - %@", exception.name, exception.reason);
                         }
                         
                         // Cleanup ALL pending crash reports since user declined
                         [self cleanupAllPendingCrashReports];
-                        self.attributes = nil;
+                        [self.attributeStore removeAllAttributes];
                         self.sendingInProgress = NO;
                     }
                 } @catch (NSException *exception) {
-                    NSLog(@"BugSplat: Exception in crash report completion handler: %@ - %@", exception.name, exception.reason);
+                    BugSplatLogError(@"Exception in crash report completion handler: %@ - %@", exception.name, exception.reason);
                     [self cleanupCrashReportWithFilename:crashFilename];
                     self.sendingInProgress = NO;
                 }
@@ -996,10 +2958,10 @@ didDetectHangWithDuration:(NSTimeInterval)duration
                 [self.crashReportWindow showWithCompletion:completionHandler];
             }
         } @catch (NSException *exception) {
-            NSLog(@"BugSplat: Exception showing crash report dialog: %@ - %@", exception.name, exception.reason);
+            BugSplatLogError(@"Exception showing crash report dialog: %@ - %@", exception.name, exception.reason);
             // Fall back to auto-submit if dialog fails - use metadata values only
             [self submitPersistedCrashReportWithFilename:crashFilename
-                                         crashReportText:crashReportText
+                                         crashReportData:crashReportData
                                                 metadata:metadata
                                                 userName:metadata[kBugSplatMetaKeyUserName]
                                                userEmail:metadata[kBugSplatMetaKeyUserEmail]
@@ -1011,7 +2973,7 @@ didDetectHangWithDuration:(NSTimeInterval)duration
 #else
 // iOS crash report alert implementation
 - (void)showCrashReportAlertForFilename:(NSString *)crashFilename
-                        crashReportText:(NSString *)crashReportText
+                        crashReportData:(NSData *)crashReportData
                                metadata:(NSDictionary *)metadata
 {
     // Notify delegate (wrapped to prevent crashes in crash handler)
@@ -1020,7 +2982,7 @@ didDetectHangWithDuration:(NSTimeInterval)duration
             [self.delegate bugSplatWillShowSubmitCrashReportAlert:self];
         }
     } @catch (NSException *exception) {
-        NSLog(@"BugSplat: Exception in bugSplatWillShowSubmitCrashReportAlert delegate: %@ - %@", exception.name, exception.reason);
+        BugSplatLogError(@"Exception in bugSplatWillShowSubmitCrashReportAlert delegate: %@ - %@", exception.name, exception.reason);
     }
     
     dispatch_async(dispatch_get_main_queue(), ^{
@@ -1042,12 +3004,12 @@ didDetectHangWithDuration:(NSTimeInterval)duration
                         [self.delegate bugSplatWillCancelSendingCrashReport:self];
                     }
                 } @catch (NSException *exception) {
-                    NSLog(@"BugSplat: Exception in bugSplatWillCancelSendingCrashReport delegate: %@ - %@", exception.name, exception.reason);
+                    BugSplatLogError(@"Exception in bugSplatWillCancelSendingCrashReport delegate: %@ - %@", exception.name, exception.reason);
                 }
                 
                 // Cleanup ALL pending crash reports since user declined
                 [self cleanupAllPendingCrashReports];
-                self.attributes = nil;
+                [self.attributeStore removeAllAttributes];
                 self.sendingInProgress = NO;
             }];
             [alert addAction:dontSendAction];
@@ -1057,7 +3019,7 @@ didDetectHangWithDuration:(NSTimeInterval)duration
                                                                  style:UIAlertActionStyleDefault
                                                                handler:^(UIAlertAction *action) {
                 [self submitPersistedCrashReportWithFilename:crashFilename
-                                             crashReportText:crashReportText
+                                             crashReportData:crashReportData
                                                     metadata:metadata
                                                     userName:metadata[kBugSplatMetaKeyUserName]
                                                    userEmail:metadata[kBugSplatMetaKeyUserEmail]
@@ -1079,11 +3041,11 @@ didDetectHangWithDuration:(NSTimeInterval)duration
                         [self.delegate bugSplatWillSendCrashReportsAlways:self];
                     }
                 } @catch (NSException *exception) {
-                    NSLog(@"BugSplat: Exception in bugSplatWillSendCrashReportsAlways delegate: %@ - %@", exception.name, exception.reason);
+                    BugSplatLogError(@"Exception in bugSplatWillSendCrashReportsAlways delegate: %@ - %@", exception.name, exception.reason);
                 }
                 
                 [self submitPersistedCrashReportWithFilename:crashFilename
-                                             crashReportText:crashReportText
+                                             crashReportData:crashReportData
                                                     metadata:metadata
                                                     userName:metadata[kBugSplatMetaKeyUserName]
                                                    userEmail:metadata[kBugSplatMetaKeyUserEmail]
@@ -1097,10 +3059,10 @@ didDetectHangWithDuration:(NSTimeInterval)duration
             if (presentingViewController) {
                 [presentingViewController presentViewController:alert animated:YES completion:nil];
             } else {
-                NSLog(@"BugSplat: Could not find view controller to present crash report alert, auto-submitting...");
+                BugSplatLogWarning(@"Could not find view controller to present crash report alert, auto-submitting...");
                 // Fall back to auto-submit if no view controller available - use metadata values only
                 [self submitPersistedCrashReportWithFilename:crashFilename
-                                             crashReportText:crashReportText
+                                             crashReportData:crashReportData
                                                     metadata:metadata
                                                     userName:metadata[kBugSplatMetaKeyUserName]
                                                    userEmail:metadata[kBugSplatMetaKeyUserEmail]
@@ -1108,10 +3070,10 @@ didDetectHangWithDuration:(NSTimeInterval)duration
                                                isInteractive:NO];
             }
         } @catch (NSException *exception) {
-            NSLog(@"BugSplat: Exception showing crash report alert: %@ - %@", exception.name, exception.reason);
+            BugSplatLogError(@"Exception showing crash report alert: %@ - %@", exception.name, exception.reason);
             // Fall back to auto-submit if alert fails - use metadata values only
             [self submitPersistedCrashReportWithFilename:crashFilename
-                                         crashReportText:crashReportText
+                                         crashReportData:crashReportData
                                                 metadata:metadata
                                                 userName:metadata[kBugSplatMetaKeyUserName]
                                                userEmail:metadata[kBugSplatMetaKeyUserEmail]
@@ -1192,6 +3154,33 @@ didDetectHangWithDuration:(NSTimeInterval)duration
 }
 #endif
 
+/**
+ * Build upload metadata from the per-crash metadata ONLY.
+ * The metadata is bundled with this crash and contains all values from when the crash occurred.
+ * Do NOT fall back to current BugSplat values - this crash may be uploaded many launches later.
+ */
+- (BugSplatCrashMetadata *)uploadMetadataWithPersistedMetadata:(NSDictionary *)persistedMetadata
+                                                      userName:(nullable NSString *)userName
+                                                     userEmail:(nullable NSString *)userEmail
+                                                      comments:(nullable NSString *)comments
+{
+    BugSplatCrashMetadata *uploadMetadata = [[BugSplatCrashMetadata alloc] init];
+    
+    // All values come from the per-crash metadata
+    uploadMetadata.database = persistedMetadata[kBugSplatMetaKeyDatabase];
+    uploadMetadata.applicationName = persistedMetadata[kBugSplatMetaKeyApplicationName];
+    uploadMetadata.applicationVersion = persistedMetadata[kBugSplatMetaKeyApplicationVersion];
+    uploadMetadata.userName = userName;
+    uploadMetadata.userEmail = userEmail;
+    uploadMetadata.userDescription = comments;
+    uploadMetadata.crashTime = persistedMetadata[kBugSplatMetaKeyTimestamp];
+    uploadMetadata.attributes = persistedMetadata[kBugSplatMetaKeyAttributes];
+    uploadMetadata.applicationLog = persistedMetadata[kBugSplatMetaKeyApplicationLog];
+    uploadMetadata.notes = persistedMetadata[kBugSplatMetaKeyNotes];
+    uploadMetadata.applicationKey = persistedMetadata[kBugSplatMetaKeyAppKey];
+    return uploadMetadata;
+}
+
 /**
  * Submit a persisted crash report.
  * On success, the crash files are deleted and remaining crashes are sent SILENTLY (no dialog).
@@ -1202,7 +3191,7 @@ didDetectHangWithDuration:(NSTimeInterval)duration
  *                      the infoUrl in the browser if one is returned.
  */
 - (void)submitPersistedCrashReportWithFilename:(NSString *)crashFilename
-                               crashReportText:(NSString *)crashReportText
+                               crashReportData:(NSData *)crashReportData
                                       metadata:(NSDictionary *)persistedMetadata
                                       userName:(NSString *)userName
                                      userEmail:(NSString *)userEmail
@@ -1219,39 +3208,18 @@ didDetectHangWithDuration:(NSTimeInterval)duration
             [self.delegate bugSplatWillSendCrashReport:self];
         }
     } @catch (NSException *exception) {
-        NSLog(@"BugSplat: Exception in bugSplatWillSendCrashReport delegate: %@ - %@", exception.name, exception.reason);
+        BugSplatLogError(@"Exception in bugSplatWillSendCrashReport delegate: %@ - %@", exception.name, exception.reason);
     }
     
     // Load attachments from disk for this crash
     NSArray<BugSplatAttachment *> *attachments = [self loadPersistedAttachmentsForCrashFilename:crashFilename];
     
-    // Build upload metadata from the per-crash metadata ONLY
-    // The metadata is bundled with this crash and contains all values from when the crash occurred
-    // Do NOT fall back to current BugSplat values - this crash may be uploaded many launches later
-    BugSplatCrashMetadata *uploadMetadata = [[BugSplatCrashMetadata alloc] init];
-    
-    // All values come from the per-crash metadata
-    uploadMetadata.database = persistedMetadata[kBugSplatMetaKeyDatabase];
-    uploadMetadata.applicationName = persistedMetadata[kBugSplatMetaKeyApplicationName];
-    uploadMetadata.applicationVersion = persistedMetadata[kBugSplatMetaKeyApplicationVersion];
-    uploadMetadata.userName = userName;
-    uploadMetadata.userEmail = userEmail;
-    uploadMetadata.userDescription = comments;
-    uploadMetadata.crashTime = persistedMetadata[kBugSplatMetaKeyTimestamp];
-    uploadMetadata.attributes = persistedMetadata[kBugSplatMetaKeyAttributes];
-    uploadMetadata.applicationLog = persistedMetadata[kBugSplatMetaKeyApplicationLog];
-    uploadMetadata.notes = persistedMetadata[kBugSplatMetaKeyNotes];
-    uploadMetadata.applicationKey = persistedMetadata[kBugSplatMetaKeyAppKey];
-    
-    // Convert text report to data for upload
-    NSData *textCrashData = [crashReportText dataUsingEncoding:NSUTF8StringEncoding];
-    if (!textCrashData) {
-        NSLog(@"BugSplat: Failed to encode crash report text");
-        self.sendingInProgress = NO;
-        return;
-    }
+    BugSplatCrashMetadata *uploadMetadata = [self uploadMetadataWithPersistedMetadata:persistedMetadata
+                                                                             userName:userName
+                                                                            userEmail:userEmail
+                                                                             comments:comments];
     
-    NSLog(@"BugSplat: Uploading crash report %@ (app: %@ %@, database: %@)...", 
+    BugSplatLogInfo(@"Uploading crash report %@ (app: %@ %@, database: %@)...", 
           crashFilename, 
           uploadMetadata.applicationName, 
           uploadMetadata.applicationVersion, 
@@ -1260,7 +3228,7 @@ didDetectHangWithDuration:(NSTimeInterval)duration
     // Upload (NSURLSession handles this on a background thread)
     // Use weak/strong self pattern to avoid retain cycles
     __weak typeof(self) weakSelf = self;
-    [self.uploadService uploadCrashReport:textCrashData
+    [self.uploadService uploadCrashReport:crashReportData
                             crashFilename:@"crash.crashlog"
                               attachments:attachments
                                  metadata:uploadMetadata
@@ -1270,10 +3238,10 @@ didDetectHangWithDuration:(NSTimeInterval)duration
         
         // Completion is called on main queue
         if (success) {
-            NSLog(@"BugSplat: Crash report %@ uploaded successfully", crashFilename);
+            BugSplatLogInfo(@"Crash report %@ uploaded successfully", crashFilename);
             
             // Only cleanup crash files after SUCCESSFUL upload
-            strongSelf.attributes = nil;
+            [strongSelf.attributeStore removeAllAttributes];
             [strongSelf cleanupCrashReportWithFilename:crashFilename];
             
 #if TARGET_OS_OSX
@@ -1281,7 +3249,7 @@ didDetectHangWithDuration:(NSTimeInterval)duration
             if (isInteractive && infoUrl.length > 0) {
                 NSURL *url = [NSURL URLWithString:infoUrl];
                 if (url) {
-                    NSLog(@"BugSplat: Opening crash report URL in browser: %@", infoUrl);
+                    BugSplatLogDebug(@"Opening crash report URL in browser: %@", infoUrl);
                     [[NSWorkspace sharedWorkspace] openURL:url];
                 }
             }
@@ -1293,7 +3261,7 @@ didDetectHangWithDuration:(NSTimeInterval)duration
                     [strongSelf.delegate bugSplatDidFinishSendingCrashReport:strongSelf];
                 }
             } @catch (NSException *exception) {
-                NSLog(@"BugSplat: Exception in bugSplatDidFinishSendingCrashReport delegate: %@ - %@", exception.name, exception.reason);
+                BugSplatLogError(@"Exception in bugSplatDidFinishSendingCrashReport delegate: %@ - %@", exception.name, exception.reason);
             }
             
             strongSelf.sendingInProgress = NO;
@@ -1306,7 +3274,7 @@ didDetectHangWithDuration:(NSTimeInterval)duration
             
         } else {
             // IMPORTANT: On failure, DO NOT delete crash files - they will be retried on next app launch
-            NSLog(@"BugSplat: Failed to upload crash report %@: %@ (will retry on next launch)", crashFilename, error);
+            BugSplatLogWarning(@"Failed to upload crash report %@: %@ (will retry on next launch)", crashFilename, error);
             
             // Notify delegate
             @try {
@@ -1314,7 +3282,7 @@ didDetectHangWithDuration:(NSTimeInterval)duration
                     [strongSelf.delegate bugSplat:strongSelf didFailWithError:error];
                 }
             } @catch (NSException *exception) {
-                NSLog(@"BugSplat: Exception in bugSplat:didFailWithError: delegate: %@ - %@", exception.name, exception.reason);
+                BugSplatLogError(@"Exception in bugSplat:didFailWithError: delegate: %@ - %@", exception.name, exception.reason);
             }
             
             strongSelf.sendingInProgress = NO;
@@ -1373,6 +3341,11 @@ didDetectHangWithDuration:(NSTimeInterval)duration
     metadata.crashTypeId = @"36";
     metadata.attributes = attributes;
 
+    BugSplatAttachment *resourceAttachment = [self currentSessionResourceAttachment];
+    if (resourceAttachment) {
+        attachments = [(attachments ?: @[]) arrayByAddingObject:resourceAttachment];
+    }
+
     [self.uploadService uploadFeedback:title description:description attachments:attachments metadata:metadata completion:completion];
 }
 
@@ -1500,39 +3473,46 @@ didDetectHangWithDuration:(NSTimeInterval)duration
     [self updateCrashReporterCustomData];
 }
 
+#pragma mark - Crash Queue Eviction Counters
+
+- (NSUInteger)reportsEvictedForAge
+{
+    return (NSUInteger)MAX([self.userDefaultsInternal integerForKey:kBugSplatUserDefaultsEvictedForAge], 0);
+}
+
+- (NSUInteger)reportsEvictedForCount
+{
+    return (NSUInteger)MAX([self.userDefaultsInternal integerForKey:kBugSplatUserDefaultsEvictedForCount], 0);
+}
+
+- (NSUInteger)reportsEvictedForSize
+{
+    return (NSUInteger)MAX([self.userDefaultsInternal integerForKey:kBugSplatUserDefaultsEvictedForSize], 0);
+}
+
 #pragma mark - Attributes
 
+- (NSDictionary<NSString *, NSString *> *)attributes
+{
+    return [self.attributeStore snapshot];
+}
+
 - (BOOL)setValue:(nullable NSString *)value forAttribute:(NSString *)attribute
 {
-    if (!attribute || attribute.length == 0) {
-        return NO;
-    }
-    
-    if (self.attributes == nil && value == nil) {
+    if (![self.attributeStore setValue:value forAttribute:attribute]) {
         return NO;
     }
-    
-    NSMutableDictionary<NSString *, NSString *> *mutableAttributes;
-    if (self.attributes) {
-        mutableAttributes = [[NSMutableDictionary alloc] initWithDictionary:self.attributes];
-    } else {
-        mutableAttributes = [NSMutableDictionary dictionary];
-    }
-
-    NSLog(@"BugSplat [setValue:%@ forKey:%@]", value, attribute);
-
-    if (value) {
-        [mutableAttributes setValue:value forKey:attribute];
-    } else {
-        [mutableAttributes removeObjectForKey:attribute];
-    }
-    
-    self.attributes = mutableAttributes;
-    [self updateCrashReporterCustomData];
-    
+    [self scheduleCrashReporterCustomDataUpdate];
     return YES;
 }
 
+- (BOOL)setAttributes:(NSDictionary<NSString *, id> *)attributes
+{
+    BOOL success = [self.attributeStore setAttributes:attributes];
+    [self scheduleCrashReporterCustomDataUpdate];
+    return success;
+}
+
 #pragma mark - PLCrashReporter Custom Data
 
 /**
@@ -1545,6 +3525,35 @@ didDetectHangWithDuration:(NSTimeInterval)duration
  * - Whenever a property changes that should be associated with crashes
  */
 - (void)updateCrashReporterCustomData
+{
+    // Called from property setters on any thread and from the debounced attribute update.
+    @synchronized (self.attributeStore) {
+        [self updateCrashReporterCustomDataLocked];
+    }
+}
+
+/**
+ * Coalesce attribute changes into one customData update per debounce interval, so that
+ * setting attributes from hot code costs a dictionary update rather than a re-encode of
+ * all metadata. A crash inside the interval is reported with the previous attributes.
+ */
+- (void)scheduleCrashReporterCustomDataUpdate
+{
+    if (atomic_exchange(&_customDataUpdateScheduled, true)) {
+        return;
+    }
+    __weak __typeof(self) weakSelf = self;
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(kBugSplatCustomDataUpdateDelay * NSEC_PER_SEC)),
+                   dispatch_get_global_queue(QOS_CLASS_UTILITY, 0), ^{
+        __strong __typeof(weakSelf) strongSelf = weakSelf;
+        if (!strongSelf) return;
+        // Cleared first so changes made while encoding schedule another update.
+        atomic_store(&strongSelf->_customDataUpdateScheduled, false);
+        [strongSelf updateCrashReporterCustomData];
+    });
+}
+
+- (void)updateCrashReporterCustomDataLocked
 {
     NSMutableDictionary *crashMetadata = [NSMutableDictionary dictionary];
     
@@ -1560,21 +3569,20 @@ didDetectHangWithDuration:(NSTimeInterval)duration
     if (self.notes) crashMetadata[kBugSplatMetaKeyNotes] = self.notes;
     
     // Attributes
-    if (self.attributes) crashMetadata[kBugSplatMetaKeyAttributes] = self.attributes;
+    NSDictionary<NSString *, NSString *> *attributes = self.attributes;
+    if (attributes) crashMetadata[kBugSplatMetaKeyAttributes] = attributes;
     
     // Serialize and set on PLCrashReporter
-    NSError *error = nil;
-    NSData *customData = [NSKeyedArchiver archivedDataWithRootObject:crashMetadata
-                                               requiringSecureCoding:NO
-                                                               error:&error];
-    if (customData && !error) {
+    NSData *customData = [BugSplatMetadataCodec dataWithMetadata:crashMetadata];
+    if (customData) {
         self.crashReporter.customData = customData;
-        NSLog(@"BugSplat: Set crash-time metadata on PLCrashReporter - database: %@, app: %@ %@",
+        self.crashTimeMetadata = customData;
+        BugSplatLogDebug(@"Set crash-time metadata on PLCrashReporter - database: %@, app: %@ %@",
               crashMetadata[kBugSplatMetaKeyDatabase],
               crashMetadata[kBugSplatMetaKeyApplicationName],
               crashMetadata[kBugSplatMetaKeyApplicationVersion]);
     } else {
-        NSLog(@"BugSplat: Failed to serialize crash metadata: %@", error);
+        BugSplatLogError(@"Failed to serialize crash metadata");
     }
 }
 
@@ -1603,9 +3611,10 @@ didDetectHangWithDuration:(NSTimeInterval)duration
     NSString *metaFilePath = [[crashesDir stringByAppendingPathComponent:crashFilename] 
                               stringByAppendingPathExtension:kBugSplatMetaFileExtension];
     
-    // Load existing metadata or create new dictionary
+    // Load existing metadata or create new dictionary. Legacy plist metadata is
+    // migrated to the binary format by the write below.
     NSMutableDictionary *metadata = nil;
-    NSDictionary *existingMetadata = [NSDictionary dictionaryWithContentsOfFile:metaFilePath];
+    NSDictionary *existingMetadata = [BugSplatMetadataCodec metadataWithContentsOfFile:metaFilePath];
     if (existingMetadata) {
         metadata = [existingMetadata mutableCopy];
     } else {
@@ -1614,12 +3623,12 @@ didDetectHangWithDuration:(NSTimeInterval)duration
     
     // Mark as user-submitted so we retry silently on future launches
     metadata[kBugSplatMetaKeyUserSubmitted] = @YES;
-    NSLog(@"BugSplat: Marked crash %@ as user-submitted", crashFilename);
+    BugSplatLogDebug(@"Marked crash %@ as user-submitted", crashFilename);
     
     // Update with new values if provided
     if (comments.length > 0) {
         metadata[kBugSplatMetaKeyComments] = comments;
-        NSLog(@"BugSplat: Persisted comments for crash %@", crashFilename);
+        BugSplatLogDebug(@"Persisted comments for crash %@", crashFilename);
     }
     if (userName.length > 0) {
         metadata[kBugSplatMetaKeyUserName] = userName;
@@ -1629,7 +3638,7 @@ didDetectHangWithDuration:(NSTimeInterval)duration
     }
     
     // Write back to disk
-    [metadata writeToFile:metaFilePath atomically:YES];
+    [BugSplatMetadataCodec writeMetadata:metadata toFile:metaFilePath];
 }
 
 - (NSString *)crashesDirectoryPath
@@ -1643,7 +3652,7 @@ didDetectHangWithDuration:(NSTimeInterval)duration
         NSError *error = nil;
         [fileManager createDirectoryAtPath:crashesDir withIntermediateDirectories:YES attributes:nil error:&error];
         if (error) {
-            NSLog(@"BugSplat: Failed to create crashes directory: %@", error);
+            BugSplatLogError(@"Failed to create crashes directory: %@", error);
             return nil;
         }
     }
@@ -1680,18 +3689,15 @@ didDetectHangWithDuration:(NSTimeInterval)duration
                                       kBugSplatAttachmentFileExtension];
                 NSString *filePath = [crashesDir stringByAppendingPathComponent:filename];
                 
-                NSError *error = nil;
-                NSData *archiveData = [NSKeyedArchiver archivedDataWithRootObject:attachment 
-                                                            requiringSecureCoding:YES 
-                                                                            error:&error];
-                if (archiveData && !error) {
-                    [archiveData writeToFile:filePath atomically:YES];
-                    NSLog(@"BugSplat: Persisted attachment to %@", filename);
+                NSData *encodedData = [BugSplatMetadataCodec dataWithAttachment:attachment];
+                if (encodedData) {
+                    [encodedData writeToFile:filePath atomically:YES];
+                    BugSplatLogDebug(@"Persisted attachment to %@", filename);
                 } else {
-                    NSLog(@"BugSplat: Failed to archive attachment: %@", error);
+                    BugSplatLogError(@"Failed to encode attachment %@", filename);
                 }
             } @catch (NSException *exception) {
-                NSLog(@"BugSplat: Exception persisting attachment: %@ - %@", exception.name, exception.reason);
+                BugSplatLogError(@"Exception persisting attachment: %@ - %@", exception.name, exception.reason);
             }
         }
     }
@@ -1718,7 +3724,7 @@ didDetectHangWithDuration:(NSTimeInterval)duration
     @try {
         files = [fileManager contentsOfDirectoryAtPath:crashesDir error:&error];
     } @catch (NSException *exception) {
-        NSLog(@"BugSplat: Exception listing crashes directory: %@ - %@", exception.name, exception.reason);
+        BugSplatLogError(@"Exception listing crashes directory: %@ - %@", exception.name, exception.reason);
         return @[];
     }
     
@@ -1739,23 +3745,27 @@ didDetectHangWithDuration:(NSTimeInterval)duration
                 }
                 
                 NSString *filePath = [crashesDir stringByAppendingPathComponent:filename];
-                NSData *data = [NSData dataWithContentsOfFile:filePath];
+                NSData *data = [NSData dataWithContentsOfFile:filePath options:NSDataReadingMappedIfSafe error:nil];
                 if (!data) {
                     continue;
                 }
                 
-                NSError *unarchiveError = nil;
-                BugSplatAttachment *attachment = [NSKeyedUnarchiver unarchivedObjectOfClass:[BugSplatAttachment class]
-                                                                                   fromData:data
-                                                                                      error:&unarchiveError];
-                if (attachment && !unarchiveError) {
+                // Accepts both the binary format and keyed archives written by older SDK versions.
+                BugSplatAttachment *attachment = [BugSplatMetadataCodec attachmentWithData:data];
+                if ([attachment.filename isEqualToString:kBugSplatHangProfileFilename]) {
+                    // Recorded without symbols so the hang was never waiting on dyld
+                    attachment = [[BugSplatAttachment alloc] initWithFilename:attachment.filename
+                                                               attachmentData:[BugSplatHangSampler symbolicatedProfile:attachment.attachmentData]
+                                                                  contentType:attachment.contentType];
+                }
+                if (attachment) {
                     [attachments addObject:attachment];
-                    NSLog(@"BugSplat: Loaded persisted attachment from %@", filename);
+                    BugSplatLogDebug(@"Loaded persisted attachment from %@", filename);
                 } else {
-                    NSLog(@"BugSplat: Failed to unarchive attachment: %@", unarchiveError);
+                    BugSplatLogError(@"Failed to decode attachment %@", filename);
                 }
             } @catch (NSException *exception) {
-                NSLog(@"BugSplat: Exception loading persisted attachment %@: %@ - %@", filename, exception.name, exception.reason);
+                BugSplatLogError(@"Exception loading persisted attachment %@: %@ - %@", filename, exception.name, exception.reason);
             }
         }
     }
@@ -1787,7 +3797,15 @@ didDetectHangWithDuration:(NSTimeInterval)duration
                                    stringByAppendingPathExtension:kBugSplatCrashFileExtension];
         if ([fileManager fileExistsAtPath:crashFilePath]) {
             [fileManager removeItemAtPath:crashFilePath error:&error];
-            NSLog(@"BugSplat: Cleaned up crash file %@.%@", crashFilename, kBugSplatCrashFileExtension);
+            BugSplatLogDebug(@"Cleaned up crash file %@.%@", crashFilename, kBugSplatCrashFileExtension);
+        }
+        
+        // Delete raw crash data not yet formatted
+        NSString *rawFilePath = [[crashesDir stringByAppendingPathComponent:crashFilename]
+                                 stringByAppendingPathExtension:kBugSplatRawCrashFileExtension];
+        if ([fileManager fileExistsAtPath:rawFilePath]) {
+            [fileManager removeItemAtPath:rawFilePath error:nil];
+            BugSplatLogDebug(@"Cleaned up raw crash file %@.%@", crashFilename, kBugSplatRawCrashFileExtension);
         }
         
         // Delete meta file
@@ -1795,7 +3813,7 @@ didDetectHangWithDuration:(NSTimeInterval)duration
                                   stringByAppendingPathExtension:kBugSplatMetaFileExtension];
         if ([fileManager fileExistsAtPath:metaFilePath]) {
             [fileManager removeItemAtPath:metaFilePath error:nil];
-            NSLog(@"BugSplat: Cleaned up meta file %@.%@", crashFilename, kBugSplatMetaFileExtension);
+            BugSplatLogDebug(@"Cleaned up meta file %@.%@", crashFilename, kBugSplatMetaFileExtension);
         }
         
         // Delete all attachment files for this crash
@@ -1807,14 +3825,109 @@ didDetectHangWithDuration:(NSTimeInterval)duration
             if ([filename hasPrefix:attachmentPrefix] && [filename hasSuffix:attachmentSuffix]) {
                 NSString *filePath = [crashesDir stringByAppendingPathComponent:filename];
                 [fileManager removeItemAtPath:filePath error:nil];
-                NSLog(@"BugSplat: Cleaned up attachment file %@", filename);
+                BugSplatLogDebug(@"Cleaned up attachment file %@", filename);
+            }
+        }
+        
+        BugSplatLogDebug(@"Cleaned up crash report %@", crashFilename);
+        
+    } @catch (NSException *exception) {
+        BugSplatLogError(@"Exception in cleanupCrashReportWithFilename: %@ - %@", exception.name, exception.reason);
+    }
+}
+
+/**
+ * Evict queued reports that exceed maximumPendingReportCount, maximumPendingReportBytes or
+ * maximumPendingReportAge, and add them to the persisted eviction counters.
+ * See BugSplatCrashQueuePolicy for the eviction order.
+ */
+- (void)enforceCrashQueueQuotas
+{
+    BugSplatCrashQueuePolicy *policy = [[BugSplatCrashQueuePolicy alloc] init];
+    policy.maximumCount = self.maximumPendingReportCount;
+    policy.maximumBytes = self.maximumPendingReportBytes;
+    policy.maximumAge = self.maximumPendingReportAge;
+    if (!policy.isEnabled) {
+        return;
+    }
+    
+    NSString *crashesDir = [self crashesDirectoryPath];
+    NSArray<NSString *> *pendingCrashFiles = [self getPendingCrashFiles];
+    if (!crashesDir || pendingCrashFiles.count < 2) {
+        return;
+    }
+    
+    @try {
+        NSFileManager *fileManager = [NSFileManager defaultManager];
+        
+        // Total on-disk size per report: <name>.crash/.plcrash/.meta plus <name>-<i>.data attachments
+        NSMutableDictionary<NSString *, NSNumber *> *reportSizes = [NSMutableDictionary dictionary];
+        NSString *attachmentSuffix = [NSString stringWithFormat:@".%@", kBugSplatAttachmentFileExtension];
+        for (NSString *filename in [fileManager contentsOfDirectoryAtPath:crashesDir error:nil]) {
+            NSString *owner = [filename stringByDeletingPathExtension];
+            if ([filename hasSuffix:attachmentSuffix]) {
+                NSRange separator = [owner rangeOfString:@"-" options:NSBackwardsSearch];
+                if (separator.location == NSNotFound) {
+                    continue;
+                }
+                owner = [owner substringToIndex:separator.location];
             }
+            NSDictionary *fileAttributes = [fileManager attributesOfItemAtPath:[crashesDir stringByAppendingPathComponent:filename] error:nil];
+            reportSizes[owner] = @(reportSizes[owner].unsignedLongLongValue + fileAttributes.fileSize);
         }
         
-        NSLog(@"BugSplat: Cleaned up crash report %@", crashFilename);
+        NSISO8601DateFormatter *isoFormatter = [[NSISO8601DateFormatter alloc] init];
+        isoFormatter.formatOptions = NSISO8601DateFormatWithInternetDateTime;
+        
+        NSMutableArray<BugSplatQueuedReport *> *reports = [NSMutableArray arrayWithCapacity:pendingCrashFiles.count];
+        for (NSString *crashFilename in pendingCrashFiles) {
+            NSString *metaFilePath = [[crashesDir stringByAppendingPathComponent:crashFilename]
+                                      stringByAppendingPathExtension:kBugSplatMetaFileExtension];
+            NSDictionary *metadata = [BugSplatMetadataCodec metadataWithContentsOfFile:metaFilePath];
+            
+            NSString *timestampISO = metadata[kBugSplatMetaKeyLastOccurrence] ?: metadata[kBugSplatMetaKeyTimestamp];
+            NSDate *timestamp = [timestampISO isKindOfClass:[NSString class]] ? [isoFormatter dateFromString:timestampISO] : nil;
+            if (!timestamp) {
+                timestamp = [fileManager attributesOfItemAtPath:metaFilePath error:nil].fileModificationDate ?: [NSDate distantPast];
+            }
+            
+            BugSplatQueuedReportPriority priority = BugSplatQueuedReportPriorityNormal;
+            if ([crashFilename hasSuffix:kBugSplatHangFilenameSuffix] || [crashFilename hasSuffix:kBugSplatCPUFilenameSuffix]
+                || [crashFilename hasSuffix:kBugSplatLaunchFilenameSuffix]) {
+                priority = BugSplatQueuedReportPriorityLow;
+            } else if ([metadata[kBugSplatMetaKeyUserSubmitted] boolValue] && [metadata[kBugSplatMetaKeyComments] length] > 0) {
+                priority = BugSplatQueuedReportPriorityHigh;
+            }
+            
+            [reports addObject:[[BugSplatQueuedReport alloc] initWithFilename:crashFilename
+                                                                    timestamp:timestamp
+                                                                     byteSize:reportSizes[crashFilename].unsignedLongLongValue
+                                                                     priority:priority]];
+        }
         
+        for (BugSplatQueuedReport *report in [policy reportsToEvictFromReports:reports now:[NSDate date]]) {
+            NSString *counterKey = nil;
+            switch (report.evictionReason) {
+                case BugSplatEvictionReasonAge:
+                    counterKey = kBugSplatUserDefaultsEvictedForAge;
+                    break;
+                case BugSplatEvictionReasonCount:
+                    counterKey = kBugSplatUserDefaultsEvictedForCount;
+                    break;
+                case BugSplatEvictionReasonSize:
+                    counterKey = kBugSplatUserDefaultsEvictedForSize;
+                    break;
+                case BugSplatEvictionReasonNone:
+                    continue;
+            }
+            BugSplatLogInfo(@"Evicting queued crash report %@ (%@ quota exceeded)", report.filename,
+                  report.evictionReason == BugSplatEvictionReasonAge ? @"age" :
+                  report.evictionReason == BugSplatEvictionReasonCount ? @"count" : @"size");
+            [self cleanupCrashReportWithFilename:report.filename];
+            [self.userDefaultsInternal setInteger:[self.userDefaultsInternal integerForKey:counterKey] + 1 forKey:counterKey];
+        }
     } @catch (NSException *exception) {
-        NSLog(@"BugSplat: Exception in cleanupCrashReportWithFilename: %@ - %@", exception.name, exception.reason);
+        BugSplatLogError(@"Exception enforcing crash queue quotas: %@ - %@", exception.name, exception.reason);
     }
 }
 
@@ -1826,16 +3939,16 @@ didDetectHangWithDuration:(NSTimeInterval)duration
 {
     @try {
         NSArray<NSString *> *pendingCrashFiles = [self getPendingCrashFiles];
-        NSLog(@"BugSplat: Cleaning up all %lu pending crash report(s)", (unsigned long)pendingCrashFiles.count);
+        BugSplatLogDebug(@"Cleaning up all %lu pending crash report(s)", (unsigned long)pendingCrashFiles.count);
         
         for (NSString *crashFilename in pendingCrashFiles) {
             [self cleanupCrashReportWithFilename:crashFilename];
         }
         
-        NSLog(@"BugSplat: All pending crash reports cleaned up");
+        BugSplatLogDebug(@"All pending crash reports cleaned up");
         
     } @catch (NSException *exception) {
-        NSLog(@"BugSplat: Exception in cleanupAllPendingCrashReports: %@ - %@", exception.name, exception.reason);
+        BugSplatLogError(@"Exception in cleanupAllPendingCrashReports: %@ - %@", exception.name, exception.reason);
     }
 }
 
@@ -1895,6 +4008,7 @@ didDetectHangWithDuration:(NSTimeInterval)duration
 {
     if (!self.hangQueue) {
         self.hangQueue = dispatch_queue_create("com.bugsplat.hang-handler.test", DISPATCH_QUEUE_SERIAL);
+        self.targetHangFilenames = [NSMutableDictionary dictionary];
     }
     if (!self.launchId) {
         self.launchId = [[NSUUID UUID] UUIDString];
@@ -1904,6 +4018,9 @@ didDetectHangWithDuration:(NSTimeInterval)duration
     if (_mainThreadMachPort == MACH_PORT_NULL) {
         _mainThreadMachPort = pthread_mach_thread_np(pthread_self());
     }
+    if (!self.hangSnapshot && self.hangReportEscalationThreshold > self.hangDetectionThreshold) {
+        self.hangSnapshot = [[BugSplatHangSnapshot alloc] initWithMaxFrames:kBugSplatHangSnapshotMaxFrames];
+    }
 }
 
 - (dispatch_queue_t)hangQueueForTesting
@@ -1911,4 +4028,18 @@ didDetectHangWithDuration:(NSTimeInterval)duration
     return self.hangQueue;
 }
 
+- (NSString *)hangFilenameForTargetNamed:(NSString *)name
+{
+    __block NSString *filename = nil;
+    dispatch_sync(self.hangQueue, ^{
+        filename = self.targetHangFilenames[name];
+    });
+    return filename;
+}
+
+- (dispatch_queue_t)ingestQueueForTesting
+{
+    return _ingestQueue;
+}
+
 @end
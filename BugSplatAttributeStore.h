@@ -0,0 +1,44 @@
+//
+//  BugSplatAttributeStore.h
+//
+//  Copyright © BugSplat, LLC. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * Thread-safe attribute name/value storage.
+ *
+ * Updates change a single entry under a lock, so they cost the same regardless of how many
+ * attributes are set and can be made from any thread. `snapshot` hands out an immutable
+ * copy, made at most once per change.
+ */
+@interface BugSplatAttributeStore : NSObject
+
+/**
+ * Set or, with a nil value, remove one attribute.
+ *
+ * @return NO if `attribute` is empty, or a value is removed from an empty store.
+ */
+- (BOOL)setValue:(nullable NSString *)value forAttribute:(NSString *)attribute;
+
+/**
+ * Set several attributes under one lock acquisition. `NSNull` values remove their attribute.
+ * Entries with empty names or values that are neither strings nor `NSNull` are skipped.
+ *
+ * @return NO if any entry was skipped.
+ */
+- (BOOL)setAttributes:(NSDictionary<NSString *, id> *)attributes;
+
+- (void)removeAllAttributes;
+
+/// Current attributes, or nil when there are none.
+- (nullable NSDictionary<NSString *, NSString *> *)snapshot;
+
+@property (nonatomic, readonly) NSUInteger count;
+
+@end
+
+NS_ASSUME_NONNULL_END
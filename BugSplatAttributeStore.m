@@ -0,0 +1,107 @@
+//
+//  BugSplatAttributeStore.m
+//
+//  Copyright © BugSplat, LLC. All rights reserved.
+//
+
+#import "BugSplatAttributeStore.h"
+
+#import <os/lock.h>
+
+@implementation BugSplatAttributeStore
+{
+    os_unfair_lock _lock;
+    NSMutableDictionary<NSString *, NSString *> *_attributes;
+    // Cached result of -snapshot; cleared by every change.
+    NSDictionary<NSString *, NSString *> *_snapshot;
+}
+
+- (instancetype)init
+{
+    if (self = [super init]) {
+        _lock = OS_UNFAIR_LOCK_INIT;
+        _attributes = [NSMutableDictionary dictionary];
+    }
+    return self;
+}
+
+- (BOOL)setValue:(NSString *)value forAttribute:(NSString *)attribute
+{
+    if (attribute.length == 0) {
+        return NO;
+    }
+
+    // Copy outside the lock; callers may pass mutable strings.
+    NSString *key = [attribute copy];
+    NSString *copiedValue = [value copy];
+
+    BOOL success = YES;
+    os_unfair_lock_lock(&_lock);
+    if (copiedValue) {
+        _attributes[key] = copiedValue;
+        _snapshot = nil;
+    } else if (_attributes.count == 0) {
+        success = NO;
+    } else {
+        [_attributes removeObjectForKey:key];
+        _snapshot = nil;
+    }
+    os_unfair_lock_unlock(&_lock);
+    return success;
+}
+
+- (BOOL)setAttributes:(NSDictionary<NSString *, id> *)attributes
+{
+    NSMutableDictionary<NSString *, NSString *> *updates = [NSMutableDictionary dictionaryWithCapacity:attributes.count];
+    NSMutableArray<NSString *> *removals = [NSMutableArray array];
+    __block BOOL allValid = YES;
+    [attributes enumerateKeysAndObjectsUsingBlock:^(NSString *attribute, id value, BOOL *stop) {
+        if (![attribute isKindOfClass:[NSString class]] || attribute.length == 0) {
+            allValid = NO;
+        } else if ([value isKindOfClass:[NSString class]]) {
+            updates[[attribute copy]] = [value copy];
+        } else if (value == [NSNull null]) {
+            [removals addObject:attribute];
+        } else {
+            allValid = NO;
+        }
+    }];
+
+    if (updates.count > 0 || removals.count > 0) {
+        os_unfair_lock_lock(&_lock);
+        [_attributes addEntriesFromDictionary:updates];
+        [_attributes removeObjectsForKeys:removals];
+        _snapshot = nil;
+        os_unfair_lock_unlock(&_lock);
+    }
+    return allValid;
+}
+
+- (void)removeAllAttributes
+{
+    os_unfair_lock_lock(&_lock);
+    [_attributes removeAllObjects];
+    _snapshot = nil;
+    os_unfair_lock_unlock(&_lock);
+}
+
+- (NSDictionary<NSString *, NSString *> *)snapshot
+{
+    os_unfair_lock_lock(&_lock);
+    if (!_snapshot && _attributes.count > 0) {
+        _snapshot = [_attributes copy];
+    }
+    NSDictionary<NSString *, NSString *> *snapshot = _snapshot;
+    os_unfair_lock_unlock(&_lock);
+    return snapshot;
+}
+
+- (NSUInteger)count
+{
+    os_unfair_lock_lock(&_lock);
+    NSUInteger count = _attributes.count;
+    os_unfair_lock_unlock(&_lock);
+    return count;
+}
+
+@end
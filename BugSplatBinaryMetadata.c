@@ -0,0 +1,324 @@
+//
+//  BugSplatBinaryMetadata.c
+//
+//  Copyright © BugSplat, LLC. All rights reserved.
+//
+
+#include "BugSplatBinaryMetadata.h"
+
+#include <string.h>
+
+static const uint8_t kBugSplatMetaMagic[3] = { 'B', 'S', 'M' };
+
+#pragma mark - Varints
+
+static size_t BugSplatVarintLength(uint64_t value)
+{
+    size_t length = 1;
+    while (value >= 0x80) {
+        value >>= 7;
+        length++;
+    }
+    return length;
+}
+
+static void BugSplatWriterAppend(BugSplatMetaWriter *writer, const void *bytes, size_t length)
+{
+    if (length == 0) {
+        return;
+    }
+    if (!writer->overflow && writer->buffer && writer->length + length <= writer->capacity) {
+        memcpy(writer->buffer + writer->length, bytes, length);
+    } else {
+        writer->overflow = true;
+    }
+    writer->length += length;
+}
+
+static void BugSplatWriterAppendVarint(BugSplatMetaWriter *writer, uint64_t value)
+{
+    uint8_t scratch[10];
+    size_t count = 0;
+    do {
+        uint8_t byte = value & 0x7F;
+        value >>= 7;
+        if (value) {
+            byte |= 0x80;
+        }
+        scratch[count++] = byte;
+    } while (value);
+    BugSplatWriterAppend(writer, scratch, count);
+}
+
+/// Reads a varint and advances `*cursor`. Returns false on truncation or overlong encoding.
+static bool BugSplatReadVarint(const uint8_t **cursor, const uint8_t *end, uint64_t *outValue)
+{
+    uint64_t value = 0;
+    unsigned shift = 0;
+    const uint8_t *p = *cursor;
+    while (p < end && shift < 64) {
+        uint8_t byte = *p++;
+        // The 10th byte holds bit 63 alone; anything more (or a continuation) does not fit 64 bits.
+        if (shift == 63 && byte > 1) {
+            return false;
+        }
+        value |= (uint64_t)(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            *cursor = p;
+            *outValue = value;
+            return true;
+        }
+        shift += 7;
+    }
+    return false;
+}
+
+/// Reads a varint length and checks that many bytes remain before `end`.
+static bool BugSplatReadLength(const uint8_t **cursor, const uint8_t *end, size_t *outLength)
+{
+    uint64_t length = 0;
+    if (!BugSplatReadVarint(cursor, end, &length)) {
+        return false;
+    }
+    if (length > (uint64_t)(end - *cursor)) {
+        return false;
+    }
+    *outLength = (size_t)length;
+    return true;
+}
+
+#pragma mark - Writer
+
+void BugSplatMetaWriterInit(BugSplatMetaWriter *writer, uint8_t *buffer, size_t capacity)
+{
+    writer->buffer = buffer;
+    writer->capacity = capacity;
+    writer->length = 0;
+    writer->overflow = false;
+
+    uint8_t header[BugSplatMetaHeaderLength] = { kBugSplatMetaMagic[0], kBugSplatMetaMagic[1], kBugSplatMetaMagic[2], BugSplatMetaFormatVersion };
+    BugSplatWriterAppend(writer, header, sizeof(header));
+}
+
+static void BugSplatWriteFieldPrefix(BugSplatMetaWriter *writer, BugSplatMetaType type, const char *key, size_t keyLength, size_t valueLength)
+{
+    uint8_t typeByte = (uint8_t)type;
+    BugSplatWriterAppend(writer, &typeByte, 1);
+    BugSplatWriterAppendVarint(writer, keyLength);
+    BugSplatWriterAppend(writer, key, keyLength);
+    BugSplatWriterAppendVarint(writer, valueLength);
+}
+
+void BugSplatMetaWriteString(BugSplatMetaWriter *writer, const char *key, size_t keyLength, const char *value, size_t valueLength)
+{
+    BugSplatWriteFieldPrefix(writer, BugSplatMetaTypeString, key, keyLength, valueLength);
+    BugSplatWriterAppend(writer, value, valueLength);
+}
+
+void BugSplatMetaWriteBool(BugSplatMetaWriter *writer, const char *key, size_t keyLength, bool value)
+{
+    uint8_t byte = value ? 1 : 0;
+    BugSplatWriteFieldPrefix(writer, BugSplatMetaTypeBool, key, keyLength, 1);
+    BugSplatWriterAppend(writer, &byte, 1);
+}
+
+void BugSplatMetaWriteInteger(BugSplatMetaWriter *writer, const char *key, size_t keyLength, int64_t value)
+{
+    uint64_t zigzag = ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+    BugSplatWriteFieldPrefix(writer, BugSplatMetaTypeInteger, key, keyLength, BugSplatVarintLength(zigzag));
+    BugSplatWriterAppendVarint(writer, zigzag);
+}
+
+void BugSplatMetaWriteDouble(BugSplatMetaWriter *writer, const char *key, size_t keyLength, double value)
+{
+    uint64_t bits = 0;
+    memcpy(&bits, &value, sizeof(bits));
+    uint8_t bytes[8];
+    for (int i = 0; i < 8; i++) {
+        bytes[i] = (uint8_t)(bits >> (8 * i));
+    }
+    BugSplatWriteFieldPrefix(writer, BugSplatMetaTypeDouble, key, keyLength, sizeof(bytes));
+    BugSplatWriterAppend(writer, bytes, sizeof(bytes));
+}
+
+void BugSplatMetaWriteBytes(BugSplatMetaWriter *writer, const char *key, size_t keyLength, const void *bytes, size_t length)
+{
+    BugSplatWriteFieldPrefix(writer, BugSplatMetaTypeBytes, key, keyLength, length);
+    BugSplatWriterAppend(writer, bytes, length);
+}
+
+size_t BugSplatMetaMapEntryLength(size_t keyLength, size_t valueLength)
+{
+    return BugSplatVarintLength(keyLength) + keyLength + BugSplatVarintLength(valueLength) + valueLength;
+}
+
+size_t BugSplatMetaMapCountLength(size_t count)
+{
+    return BugSplatVarintLength(count);
+}
+
+void BugSplatMetaWriteMapHeader(BugSplatMetaWriter *writer, const char *key, size_t keyLength, size_t count, size_t bodyLength)
+{
+    BugSplatWriteFieldPrefix(writer, BugSplatMetaTypeMap, key, keyLength, BugSplatVarintLength(count) + bodyLength);
+    BugSplatWriterAppendVarint(writer, count);
+}
+
+void BugSplatMetaWriteMapEntry(BugSplatMetaWriter *writer, const char *key, size_t keyLength, const char *value, size_t valueLength)
+{
+    BugSplatWriterAppendVarint(writer, keyLength);
+    BugSplatWriterAppend(writer, key, keyLength);
+    BugSplatWriterAppendVarint(writer, valueLength);
+    BugSplatWriterAppend(writer, value, valueLength);
+}
+
+#pragma mark - Reader
+
+bool BugSplatMetaIsEncoded(const void *bytes, size_t length)
+{
+    return bytes && length >= BugSplatMetaHeaderLength && memcmp(bytes, kBugSplatMetaMagic, sizeof(kBugSplatMetaMagic)) == 0;
+}
+
+BugSplatMetaResult BugSplatMetaReaderInit(BugSplatMetaReader *reader, const void *bytes, size_t length)
+{
+    reader->cursor = NULL;
+    reader->end = NULL;
+    reader->remaining = 0;
+
+    if (!BugSplatMetaIsEncoded(bytes, length)) {
+        return BugSplatMetaResultNotEncoded;
+    }
+    const uint8_t *start = (const uint8_t *)bytes;
+    if (start[3] == 0 || start[3] > BugSplatMetaFormatVersion) {
+        return BugSplatMetaResultUnsupportedVersion;
+    }
+    reader->cursor = start + BugSplatMetaHeaderLength;
+    reader->end = start + length;
+    return BugSplatMetaResultOK;
+}
+
+BugSplatMetaResult BugSplatMetaReaderNext(BugSplatMetaReader *reader, BugSplatMetaField *field)
+{
+    if (!reader->cursor || reader->cursor >= reader->end) {
+        return BugSplatMetaResultEnd;
+    }
+
+    const uint8_t *p = reader->cursor;
+    uint8_t type = *p++;
+    size_t keyLength = 0;
+    if (!BugSplatReadLength(&p, reader->end, &keyLength)) {
+        return BugSplatMetaResultMalformed;
+    }
+    const char *key = (const char *)p;
+    p += keyLength;
+    size_t valueLength = 0;
+    if (!BugSplatReadLength(&p, reader->end, &valueLength)) {
+        return BugSplatMetaResultMalformed;
+    }
+
+    field->type = type;
+    field->key = key;
+    field->keyLength = keyLength;
+    field->value = p;
+    field->valueLength = valueLength;
+    reader->cursor = p + valueLength;
+    return BugSplatMetaResultOK;
+}
+
+bool BugSplatMetaFieldGetBool(const BugSplatMetaField *field, bool *outValue)
+{
+    if (field->type != BugSplatMetaTypeBool || field->valueLength != 1) {
+        return false;
+    }
+    *outValue = field->value[0] != 0;
+    return true;
+}
+
+bool BugSplatMetaFieldGetInteger(const BugSplatMetaField *field, int64_t *outValue)
+{
+    if (field->type != BugSplatMetaTypeInteger) {
+        return false;
+    }
+    const uint8_t *p = field->value;
+    uint64_t zigzag = 0;
+    if (!BugSplatReadVarint(&p, field->value + field->valueLength, &zigzag)) {
+        return false;
+    }
+    *outValue = (int64_t)(zigzag >> 1) ^ -(int64_t)(zigzag & 1);
+    return true;
+}
+
+bool BugSplatMetaFieldGetDouble(const BugSplatMetaField *field, double *outValue)
+{
+    if (field->type != BugSplatMetaTypeDouble || field->valueLength != 8) {
+        return false;
+    }
+    uint64_t bits = 0;
+    for (int i = 0; i < 8; i++) {
+        bits |= (uint64_t)field->value[i] << (8 * i);
+    }
+    memcpy(outValue, &bits, sizeof(bits));
+    return true;
+}
+
+bool BugSplatMetaFieldKeyEquals(const BugSplatMetaField *field, const char *key)
+{
+    size_t length = strlen(key);
+    return field->keyLength == length && memcmp(field->key, key, length) == 0;
+}
+
+BugSplatMetaResult BugSplatMetaMapReaderInit(BugSplatMetaReader *mapReader, const BugSplatMetaField *mapField, size_t *outCount)
+{
+    mapReader->cursor = NULL;
+    mapReader->end = NULL;
+    mapReader->remaining = 0;
+
+    if (mapField->type != BugSplatMetaTypeMap) {
+        return BugSplatMetaResultMalformed;
+    }
+    const uint8_t *p = mapField->value;
+    const uint8_t *end = mapField->value + mapField->valueLength;
+    uint64_t count = 0;
+    if (!BugSplatReadVarint(&p, end, &count)) {
+        return BugSplatMetaResultMalformed;
+    }
+    // Every entry needs at least two length bytes; reject counts the body cannot hold.
+    if (count > (uint64_t)(end - p) / 2) {
+        return BugSplatMetaResultMalformed;
+    }
+    mapReader->cursor = p;
+    mapReader->end = end;
+    mapReader->remaining = (size_t)count;
+    if (outCount) {
+        *outCount = (size_t)count;
+    }
+    return BugSplatMetaResultOK;
+}
+
+BugSplatMetaResult BugSplatMetaMapReaderNext(BugSplatMetaReader *mapReader,
+                                             const char **outKey, size_t *outKeyLength,
+                                             const char **outValue, size_t *outValueLength)
+{
+    if (mapReader->remaining == 0) {
+        return BugSplatMetaResultEnd;
+    }
+
+    const uint8_t *p = mapReader->cursor;
+    size_t keyLength = 0;
+    if (!BugSplatReadLength(&p, mapReader->end, &keyLength)) {
+        return BugSplatMetaResultMalformed;
+    }
+    const char *key = (const char *)p;
+    p += keyLength;
+    size_t valueLength = 0;
+    if (!BugSplatReadLength(&p, mapReader->end, &valueLength)) {
+        return BugSplatMetaResultMalformed;
+    }
+
+    *outKey = key;
+    *outKeyLength = keyLength;
+    *outValue = (const char *)p;
+    *outValueLength = valueLength;
+    mapReader->cursor = p + valueLength;
+    mapReader->remaining--;
+    return BugSplatMetaResultOK;
+}
@@ -0,0 +1,149 @@
+//
+//  BugSplatBinaryMetadata.h
+//
+//  Compact, versioned binary encoding for crash metadata, crash-time properties
+//  and persisted attachments. Plain C with no Foundation dependency so the same
+//  code can run from the hang watchdog, from crash-adjacent paths, and on any
+//  platform with a C compiler.
+//
+//  Copyright © BugSplat, LLC. All rights reserved.
+//
+
+#ifndef BugSplatBinaryMetadata_h
+#define BugSplatBinaryMetadata_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Wire format (all integers are unsigned LEB128 varints unless noted):
+ *
+ *   header:  'B' 'S' 'M' <version:u8>
+ *   field*:  <type:u8> <keyLength> <key bytes> <valueLength> <value bytes>
+ *
+ * Every value is length-prefixed, so readers skip field types they do not
+ * understand. Value encodings by type:
+ *
+ *   String  - UTF-8 bytes, no terminator
+ *   Bool    - one byte, 0 or 1
+ *   Integer - zigzag varint
+ *   Double  - 8 bytes, IEEE 754, little endian
+ *   Bytes   - raw bytes
+ *   Map     - <count> followed by <count> (<keyLength> <key> <valueLength> <value>) string pairs
+ *
+ * Incompatible layout changes must bump the version byte; readers reject
+ * versions newer than `BugSplatMetaFormatVersion`.
+ */
+#define BugSplatMetaFormatVersion 1
+#define BugSplatMetaHeaderLength 4
+
+typedef enum {
+    BugSplatMetaTypeString = 1,
+    BugSplatMetaTypeBool = 2,
+    BugSplatMetaTypeInteger = 3,
+    BugSplatMetaTypeDouble = 4,
+    BugSplatMetaTypeBytes = 5,
+    BugSplatMetaTypeMap = 6,
+} BugSplatMetaType;
+
+typedef enum {
+    BugSplatMetaResultOK = 0,
+    BugSplatMetaResultEnd = 1,
+    BugSplatMetaResultNotEncoded = -1,
+    BugSplatMetaResultUnsupportedVersion = -2,
+    BugSplatMetaResultMalformed = -3,
+} BugSplatMetaResult;
+
+#pragma mark - Writer
+
+/**
+ * Appends fields to a caller-owned buffer. Never allocates.
+ *
+ * When the buffer is too small the writer keeps counting so `length` reports the
+ * size the encoding needs, and sets `overflow`. Initialize with a NULL buffer and
+ * zero capacity to measure without writing.
+ */
+typedef struct {
+    uint8_t *buffer;
+    size_t capacity;
+    size_t length;
+    bool overflow;
+} BugSplatMetaWriter;
+
+/// Reset the writer onto `buffer` and emit the format header.
+void BugSplatMetaWriterInit(BugSplatMetaWriter *writer, uint8_t *buffer, size_t capacity);
+
+void BugSplatMetaWriteString(BugSplatMetaWriter *writer, const char *key, size_t keyLength, const char *value, size_t valueLength);
+void BugSplatMetaWriteBool(BugSplatMetaWriter *writer, const char *key, size_t keyLength, bool value);
+void BugSplatMetaWriteInteger(BugSplatMetaWriter *writer, const char *key, size_t keyLength, int64_t value);
+void BugSplatMetaWriteDouble(BugSplatMetaWriter *writer, const char *key, size_t keyLength, double value);
+void BugSplatMetaWriteBytes(BugSplatMetaWriter *writer, const char *key, size_t keyLength, const void *bytes, size_t length);
+
+/**
+ * Emit a map field header. `bodyLength` must equal the sum of
+ * `BugSplatMetaMapEntryLength` over the `count` entries that follow, each
+ * written with `BugSplatMetaWriteMapEntry`.
+ */
+void BugSplatMetaWriteMapHeader(BugSplatMetaWriter *writer, const char *key, size_t keyLength, size_t count, size_t bodyLength);
+void BugSplatMetaWriteMapEntry(BugSplatMetaWriter *writer, const char *key, size_t keyLength, const char *value, size_t valueLength);
+
+/// Bytes one map entry occupies in a map body.
+size_t BugSplatMetaMapEntryLength(size_t keyLength, size_t valueLength);
+
+/// Bytes the varint prefix for a map of `count` entries occupies in the map body.
+size_t BugSplatMetaMapCountLength(size_t count);
+
+#pragma mark - Reader
+
+/**
+ * Iterates fields in place. All returned pointers alias the input buffer;
+ * nothing is copied and nothing is allocated.
+ */
+typedef struct {
+    const uint8_t *cursor;
+    const uint8_t *end;
+    size_t remaining; // map entries left when iterating a map body
+} BugSplatMetaReader;
+
+typedef struct {
+    uint8_t type;
+    const char *key;
+    size_t keyLength;
+    const uint8_t *value;
+    size_t valueLength;
+} BugSplatMetaField;
+
+/// YES if `bytes` starts with the format header (any version).
+bool BugSplatMetaIsEncoded(const void *bytes, size_t length);
+
+/// Validate the header and position the reader on the first field.
+BugSplatMetaResult BugSplatMetaReaderInit(BugSplatMetaReader *reader, const void *bytes, size_t length);
+
+/// Read the next field. Returns OK, End, or Malformed.
+BugSplatMetaResult BugSplatMetaReaderNext(BugSplatMetaReader *reader, BugSplatMetaField *field);
+
+bool BugSplatMetaFieldGetBool(const BugSplatMetaField *field, bool *outValue);
+bool BugSplatMetaFieldGetInteger(const BugSplatMetaField *field, int64_t *outValue);
+bool BugSplatMetaFieldGetDouble(const BugSplatMetaField *field, double *outValue);
+
+/// Compare a field key against a NUL-terminated C string.
+bool BugSplatMetaFieldKeyEquals(const BugSplatMetaField *field, const char *key);
+
+/// Position `mapReader` on the body of a Map field and report its entry count.
+BugSplatMetaResult BugSplatMetaMapReaderInit(BugSplatMetaReader *mapReader, const BugSplatMetaField *mapField, size_t *outCount);
+
+/// Read the next string pair of a map body. Returns OK, End, or Malformed.
+BugSplatMetaResult BugSplatMetaMapReaderNext(BugSplatMetaReader *mapReader,
+                                             const char **outKey, size_t *outKeyLength,
+                                             const char **outValue, size_t *outValueLength);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BugSplatBinaryMetadata_h */
@@ -0,0 +1,104 @@
+//
+//  BugSplatCPUMonitor.h
+//
+//  Copyright © BugSplat, LLC. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import <mach/mach.h>
+
+#import "BugSplatCPUUsage.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class BugSplatCPUMonitor;
+
+/// One of the threads that used the most CPU over a window above budget.
+@interface BugSplatCPUThreadUsage : NSObject
+
+@property (nonatomic, readonly) uint64_t threadId;
+/// The thread's pthread name, or nil if it has none.
+@property (nonatomic, copy, readonly, nullable) NSString *name;
+/// Share of one core the thread used over the window, e.g. 0.95.
+@property (nonatomic, readonly) double usage;
+/// Send right to the thread while it is alive, released with the receiver; MACH_PORT_NULL if it has exited.
+@property (nonatomic, readonly) mach_port_t thread;
+
+/// `name` if the thread has one, otherwise `thread 0x<id>`.
+- (NSString *)displayName;
+
+@end
+
+/**
+ * Delegate protocol for BugSplatCPUMonitor. The callback runs on the monitor's private queue.
+ */
+@protocol BugSplatCPUMonitorDelegate <NSObject>
+
+/**
+ * Called when the process has used more than the budget over a whole window, once per
+ * stretch above budget and at most `maxReports` times.
+ *
+ * @param usage   Share of one core the process used over the window.
+ * @param span    Time the window spans, in seconds.
+ * @param threads The busiest threads over the window, busiest first.
+ */
+- (void)cpuMonitor:(BugSplatCPUMonitor *)monitor
+didExceedBudgetWithUsage:(double)usage
+              span:(NSTimeInterval)span
+    hottestThreads:(NSArray<BugSplatCPUThreadUsage *> *)threads;
+
+@end
+
+/**
+ * Reports sustained high CPU use, such as a thread spinning in a loop.
+ *
+ * A timer on a private utility queue samples the process's CPU time and each thread's every
+ * `window / 12` (at least a second, with a 10% leeway so wakeups can be coalesced) and feeds
+ * the samples to a `BugSplatCPUWindow`. When the process has averaged more than `budget` of one
+ * core over `window`, the delegate is told, with the busiest threads named. It is told again
+ * only after a full window back under budget, and at most `maxReports` times per session.
+ */
+@interface BugSplatCPUMonitor : NSObject
+
+/**
+ * @param budget     Share of one core the process may use on average over a window, e.g. 0.8.
+ * @param window     Window length in seconds; clamped to at least 1 s.
+ * @param maxReports Reports per session; 0 for no limit.
+ * @param isDebuggerAttachedBlock Optional predicate; while it returns YES nothing is reported
+ *                   (a process stopped at a breakpoint or stepping looks nothing like normal use).
+ */
+- (instancetype)initWithBudget:(double)budget
+                        window:(NSTimeInterval)window
+                    maxReports:(NSUInteger)maxReports
+                      delegate:(id<BugSplatCPUMonitorDelegate>)delegate
+       isDebuggerAttachedBlock:(nullable BOOL(^)(void))isDebuggerAttachedBlock;
+- (instancetype)init NS_UNAVAILABLE;
+
+@property (nonatomic, readonly) double budget;
+@property (nonatomic, readonly) NSTimeInterval window;
+@property (nonatomic, readonly) NSTimeInterval sampleInterval;
+
+/// Start sampling. Safe to call more than once.
+- (void)start;
+
+/// Stop sampling and forget the window. Safe to call more than once.
+- (void)stop;
+
+@property (atomic, readonly, getter=isRunning) BOOL running;
+
+/**
+ * Add a sample to the window and tell the delegate if it puts the process over budget. The
+ * timer calls this with live samples; tests call it with injected ones. Not thread safe: call
+ * it on one queue, and not while the monitor is running.
+ */
+- (BugSplatCPUEvaluation)processSample:(const BugSplatCPUSample *)sample;
+
+/**
+ * Sample the current process's CPU time and that of up to `BugSplatCPUSampleMaxThreads` of
+ * its threads, with the monotonic time.
+ */
++ (void)sampleCurrentProcess:(BugSplatCPUSample *)sample;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,270 @@
+//
+//  BugSplatCPUMonitor.m
+//
+//  Copyright © BugSplat, LLC. All rights reserved.
+//
+
+#import "BugSplatCPUMonitor.h"
+#import "BugSplatLogging.h"
+
+#import <stdlib.h>
+#import <string.h>
+#import <sys/resource.h>
+#import <time.h>
+
+/// Samples per window; finer gives a tighter window edge at the cost of more wakeups.
+static const double kBugSplatCPUSamplesPerWindow = 12;
+static const NSTimeInterval kBugSplatCPUMinSampleInterval = 1.0;
+
+/// Threads named in a report.
+static const size_t kBugSplatCPUHottestThreadCount = 5;
+
+#pragma mark - Thread Usage
+
+@interface BugSplatCPUThreadUsage ()
+- (instancetype)initWithThreadId:(uint64_t)threadId name:(nullable NSString *)name usage:(double)usage thread:(mach_port_t)thread;
+@end
+
+@implementation BugSplatCPUThreadUsage
+
+- (instancetype)initWithThreadId:(uint64_t)threadId name:(NSString *)name usage:(double)usage thread:(mach_port_t)thread
+{
+    if (self = [super init]) {
+        _threadId = threadId;
+        _name = [name copy];
+        _usage = usage;
+        _thread = thread;
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    if (_thread != MACH_PORT_NULL) {
+        mach_port_deallocate(mach_task_self(), _thread);
+    }
+}
+
+- (NSString *)displayName
+{
+    return _name.length > 0 ? _name : [NSString stringWithFormat:@"thread 0x%llx", _threadId];
+}
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"%@ %.1f%%", [self displayName], _usage * 100.0];
+}
+
+@end
+
+#pragma mark - Monitor
+
+@interface BugSplatCPUMonitor ()
+@property (atomic, readwrite, getter=isRunning) BOOL running;
+@end
+
+@implementation BugSplatCPUMonitor
+{
+    __weak id<BugSplatCPUMonitorDelegate> _delegate;
+    BOOL (^_isDebuggerAttachedBlock)(void);
+    dispatch_queue_t _queue;
+    dispatch_source_t _timer;
+    BugSplatCPUSample *_storage;
+    BugSplatCPUSample _sample;
+    BugSplatCPUWindow _cpuWindow;
+}
+
+- (instancetype)initWithBudget:(double)budget
+                        window:(NSTimeInterval)window
+                    maxReports:(NSUInteger)maxReports
+                      delegate:(id<BugSplatCPUMonitorDelegate>)delegate
+       isDebuggerAttachedBlock:(BOOL (^)(void))isDebuggerAttachedBlock
+{
+    if (self = [super init]) {
+        _budget = budget;
+        _window = MAX(window, 1.0);
+        _sampleInterval = MAX(_window / kBugSplatCPUSamplesPerWindow, kBugSplatCPUMinSampleInterval);
+        _delegate = delegate;
+        _isDebuggerAttachedBlock = [isDebuggerAttachedBlock copy];
+        _queue = dispatch_queue_create("com.bugsplat.cpu-monitor",
+                                       dispatch_queue_attr_make_with_qos_class(DISPATCH_QUEUE_SERIAL, QOS_CLASS_UTILITY, 0));
+
+        // A window's worth of samples, the baseline before it, and one for timer slop.
+        size_t capacity = (size_t)ceil(_window / _sampleInterval) + 2;
+        _storage = calloc(capacity, sizeof(BugSplatCPUSample));
+        if (!_storage) {
+            return nil;
+        }
+        BugSplatCPUWindowInit(&_cpuWindow, _storage, capacity, budget, (uint64_t)(_window * USEC_PER_SEC),
+                              (uint32_t)MIN(maxReports, (NSUInteger)UINT32_MAX));
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    if (_timer) {
+        dispatch_source_cancel(_timer);
+    }
+    free(_storage);
+}
+
+- (void)start
+{
+    @synchronized (self) {
+        if (_timer) {
+            return;
+        }
+        uint64_t interval = (uint64_t)(_sampleInterval * NSEC_PER_SEC);
+        dispatch_source_t timer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, _queue);
+        dispatch_source_set_timer(timer, dispatch_time(DISPATCH_TIME_NOW, (int64_t)interval), interval, interval / 10);
+        __weak typeof(self) weakSelf = self;
+        dispatch_source_set_event_handler(timer, ^{
+            [weakSelf sampleAndEvaluate];
+        });
+        _timer = timer;
+        self.running = YES;
+        dispatch_resume(timer);
+    }
+}
+
+- (void)stop
+{
+    @synchronized (self) {
+        if (!_timer) {
+            return;
+        }
+        dispatch_source_cancel(_timer);
+        _timer = nil;
+        self.running = NO;
+    }
+    dispatch_async(_queue, ^{
+        BugSplatCPUWindowReset(&self->_cpuWindow);
+    });
+}
+
+- (void)sampleAndEvaluate
+{
+    [[self class] sampleCurrentProcess:&_sample];
+    [self processSample:&_sample];
+}
+
+- (BugSplatCPUEvaluation)processSample:(const BugSplatCPUSample *)sample
+{
+    if (_isDebuggerAttachedBlock && _isDebuggerAttachedBlock()) {
+        // Time stopped at breakpoints is not use; start over once the debugger lets go.
+        BugSplatCPUWindowReset(&_cpuWindow);
+        return (BugSplatCPUEvaluation){ BugSplatCPUVerdictWarmingUp, 0, 0 };
+    }
+
+    BugSplatCPUEvaluation evaluation = BugSplatCPUWindowAdd(&_cpuWindow, sample);
+    if (evaluation.verdict != BugSplatCPUVerdictExceeded) {
+        return evaluation;
+    }
+
+    BugSplatThreadCPUUsage hottest[kBugSplatCPUHottestThreadCount];
+    size_t count = BugSplatCPUWindowHottestThreads(&_cpuWindow, hottest, kBugSplatCPUHottestThreadCount);
+    NSArray<BugSplatCPUThreadUsage *> *threads = [[self class] threadUsages:hottest count:count];
+    BugSplatLogInfo(@"CPU use %.0f%% over %.0fs is above the %.0f%% budget; busiest: %@",
+                    evaluation.usage * 100.0, (double)evaluation.spanUs / USEC_PER_SEC, _budget * 100.0,
+                    [threads componentsJoinedByString:@", "]);
+    [_delegate cpuMonitor:self
+ didExceedBudgetWithUsage:evaluation.usage
+                     span:(NSTimeInterval)evaluation.spanUs / USEC_PER_SEC
+           hottestThreads:threads];
+    return evaluation;
+}
+
+#pragma mark - Sampling
+
+static uint64_t BugSplatCPUTimeValueUs(time_value_t value)
+{
+    return (uint64_t)value.seconds * USEC_PER_SEC + (uint64_t)value.microseconds;
+}
+
++ (void)sampleCurrentProcess:(BugSplatCPUSample *)sample
+{
+    sample->timestampUs = clock_gettime_nsec_np(CLOCK_UPTIME_RAW) / NSEC_PER_USEC;
+    sample->processCPUTimeUs = 0;
+    sample->threadCount = 0;
+
+    // Includes threads that have already exited, so a short-lived busy thread still counts.
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+        sample->processCPUTimeUs = (uint64_t)usage.ru_utime.tv_sec * USEC_PER_SEC + (uint64_t)usage.ru_utime.tv_usec
+                                 + (uint64_t)usage.ru_stime.tv_sec * USEC_PER_SEC + (uint64_t)usage.ru_stime.tv_usec;
+    }
+
+    thread_act_array_t threads = NULL;
+    mach_msg_type_number_t threadCount = 0;
+    if (task_threads(mach_task_self(), &threads, &threadCount) != KERN_SUCCESS) {
+        return;
+    }
+    for (mach_msg_type_number_t i = 0; i < threadCount; i++) {
+        if (sample->threadCount < BugSplatCPUSampleMaxThreads) {
+            thread_identifier_info_data_t identifier;
+            mach_msg_type_number_t identifierCount = THREAD_IDENTIFIER_INFO_COUNT;
+            thread_basic_info_data_t basic;
+            mach_msg_type_number_t basicCount = THREAD_BASIC_INFO_COUNT;
+            if (thread_info(threads[i], THREAD_IDENTIFIER_INFO, (thread_info_t)&identifier, &identifierCount) == KERN_SUCCESS
+                && thread_info(threads[i], THREAD_BASIC_INFO, (thread_info_t)&basic, &basicCount) == KERN_SUCCESS
+                && !(basic.flags & TH_FLAGS_IDLE)) {
+                BugSplatThreadCPUTime *entry = &sample->threads[sample->threadCount++];
+                entry->threadId = identifier.thread_id;
+                entry->cpuTimeUs = BugSplatCPUTimeValueUs(basic.user_time) + BugSplatCPUTimeValueUs(basic.system_time);
+            }
+        }
+        mach_port_deallocate(mach_task_self(), threads[i]);
+    }
+    vm_deallocate(mach_task_self(), (vm_address_t)threads, threadCount * sizeof(thread_act_t));
+}
+
+/// Names and live ports for `usages`; a thread that has exited since keeps its id and usage only.
++ (NSArray<BugSplatCPUThreadUsage *> *)threadUsages:(const BugSplatThreadCPUUsage *)usages count:(size_t)count
+{
+    mach_port_t ports[kBugSplatCPUHottestThreadCount] = { MACH_PORT_NULL };
+    NSString *names[kBugSplatCPUHottestThreadCount] = { nil };
+
+    thread_act_array_t threads = NULL;
+    mach_msg_type_number_t threadCount = 0;
+    if (task_threads(mach_task_self(), &threads, &threadCount) == KERN_SUCCESS) {
+        for (mach_msg_type_number_t i = 0; i < threadCount; i++) {
+            BOOL kept = NO;
+            thread_identifier_info_data_t identifier;
+            mach_msg_type_number_t identifierCount = THREAD_IDENTIFIER_INFO_COUNT;
+            if (thread_info(threads[i], THREAD_IDENTIFIER_INFO, (thread_info_t)&identifier, &identifierCount) == KERN_SUCCESS) {
+                for (size_t j = 0; j < count; j++) {
+                    if (usages[j].threadId != identifier.thread_id || ports[j] != MACH_PORT_NULL) {
+                        continue;
+                    }
+                    thread_extended_info_data_t extended;
+                    mach_msg_type_number_t extendedCount = THREAD_EXTENDED_INFO_COUNT;
+                    if (thread_info(threads[i], THREAD_EXTENDED_INFO, (thread_info_t)&extended, &extendedCount) == KERN_SUCCESS
+                        && extended.pth_name[0] != '\0') {
+                        extended.pth_name[sizeof(extended.pth_name) - 1] = '\0';
+                        names[j] = [NSString stringWithUTF8String:extended.pth_name];
+                    }
+                    // The send right from task_threads moves to the usage object.
+                    ports[j] = threads[i];
+                    kept = YES;
+                    break;
+                }
+            }
+            if (!kept) {
+                mach_port_deallocate(mach_task_self(), threads[i]);
+            }
+        }
+        vm_deallocate(mach_task_self(), (vm_address_t)threads, threadCount * sizeof(thread_act_t));
+    }
+
+    NSMutableArray<BugSplatCPUThreadUsage *> *result = [NSMutableArray arrayWithCapacity:count];
+    for (size_t j = 0; j < count; j++) {
+        [result addObject:[[BugSplatCPUThreadUsage alloc] initWithThreadId:usages[j].threadId
+                                                                      name:names[j]
+                                                                     usage:usages[j].usage
+                                                                    thread:ports[j]]];
+    }
+    return result;
+}
+
+@end
@@ -0,0 +1,137 @@
+//
+//  BugSplatCPUUsage.c
+//
+//  Copyright © BugSplat, LLC. All rights reserved.
+//
+
+#include "BugSplatCPUUsage.h"
+
+#include <string.h>
+
+#pragma mark - Window
+
+void BugSplatCPUWindowInit(BugSplatCPUWindow *window, BugSplatCPUSample *storage, size_t capacity,
+                           double budget, uint64_t windowUs, uint32_t maxReports)
+{
+    memset(window, 0, sizeof(*window));
+    window->budget = budget;
+    window->windowUs = windowUs;
+    window->maxReports = maxReports;
+    window->samples = storage;
+    window->capacity = capacity;
+}
+
+void BugSplatCPUWindowReset(BugSplatCPUWindow *window)
+{
+    window->first = 0;
+    window->count = 0;
+    window->reported = false;
+}
+
+static const BugSplatCPUSample *BugSplatCPUWindowAt(const BugSplatCPUWindow *window, size_t index)
+{
+    return &window->samples[(window->first + index) % window->capacity];
+}
+
+static const BugSplatCPUSample *BugSplatCPUWindowNewest(const BugSplatCPUWindow *window)
+{
+    return BugSplatCPUWindowAt(window, window->count - 1);
+}
+
+BugSplatCPUEvaluation BugSplatCPUWindowAdd(BugSplatCPUWindow *window, const BugSplatCPUSample *sample)
+{
+    BugSplatCPUEvaluation evaluation = { BugSplatCPUVerdictWarmingUp, 0, 0 };
+    if (window->capacity < 2 || !sample) {
+        return evaluation;
+    }
+    if (window->count > 0 && sample->timestampUs <= BugSplatCPUWindowNewest(window)->timestampUs) {
+        BugSplatCPUWindowReset(window);
+    }
+
+    if (window->count == window->capacity) {
+        window->first = (window->first + 1) % window->capacity;
+        window->count--;
+    }
+    window->samples[(window->first + window->count) % window->capacity] = *sample;
+    window->count++;
+
+    // Drop samples older than needed: the baseline is the newest sample a full window back.
+    while (window->count > 2 && sample->timestampUs - BugSplatCPUWindowAt(window, 1)->timestampUs >= window->windowUs) {
+        window->first = (window->first + 1) % window->capacity;
+        window->count--;
+    }
+
+    const BugSplatCPUSample *baseline = BugSplatCPUWindowAt(window, 0);
+    uint64_t span = sample->timestampUs - baseline->timestampUs;
+    bool full = span >= window->windowUs
+        || (window->count == window->capacity && window->count > 1); // storage covers less than a window
+    if (!full || span == 0) {
+        return evaluation;
+    }
+    evaluation.spanUs = span;
+    uint64_t used = sample->processCPUTimeUs >= baseline->processCPUTimeUs ? sample->processCPUTimeUs - baseline->processCPUTimeUs : 0;
+    evaluation.usage = (double)used / (double)span;
+
+    if (evaluation.usage < window->budget) {
+        window->reported = false;
+        evaluation.verdict = BugSplatCPUVerdictUnderBudget;
+        return evaluation;
+    }
+    if (window->reported || (window->maxReports > 0 && window->reportCount >= window->maxReports)) {
+        evaluation.verdict = BugSplatCPUVerdictStillExceeded;
+        return evaluation;
+    }
+    window->reported = true;
+    window->reportCount++;
+    evaluation.verdict = BugSplatCPUVerdictExceeded;
+    return evaluation;
+}
+
+#pragma mark - Threads
+
+size_t BugSplatCPUWindowHottestThreads(const BugSplatCPUWindow *window, BugSplatThreadCPUUsage *threads, size_t maxThreads)
+{
+    if (window->count < 2 || !threads || maxThreads == 0) {
+        return 0;
+    }
+    const BugSplatCPUSample *baseline = BugSplatCPUWindowAt(window, 0);
+    const BugSplatCPUSample *newest = BugSplatCPUWindowNewest(window);
+    uint64_t span = newest->timestampUs - baseline->timestampUs;
+    if (span == 0) {
+        return 0;
+    }
+
+    size_t count = 0;
+    uint32_t newestCount = newest->threadCount < BugSplatCPUSampleMaxThreads ? newest->threadCount : BugSplatCPUSampleMaxThreads;
+    uint32_t baselineCount = baseline->threadCount < BugSplatCPUSampleMaxThreads ? baseline->threadCount : BugSplatCPUSampleMaxThreads;
+    for (uint32_t i = 0; i < newestCount; i++) {
+        const BugSplatThreadCPUTime *thread = &newest->threads[i];
+        uint64_t before = 0;
+        for (uint32_t j = 0; j < baselineCount; j++) {
+            if (baseline->threads[j].threadId == thread->threadId) {
+                before = baseline->threads[j].cpuTimeUs;
+                break;
+            }
+        }
+        if (thread->cpuTimeUs <= before) {
+            continue;
+        }
+        BugSplatThreadCPUUsage usage = { thread->threadId, (double)(thread->cpuTimeUs - before) / (double)span };
+
+        // Insertion into the sorted top `maxThreads`.
+        size_t position = count < maxThreads ? count : maxThreads;
+        while (position > 0 && threads[position - 1].usage < usage.usage) {
+            if (position < maxThreads) {
+                threads[position] = threads[position - 1];
+            }
+            position--;
+        }
+        if (position < maxThreads) {
+            threads[position] = usage;
+            if (count < maxThreads) {
+                count++;
+            }
+        }
+    }
+    return count;
+}
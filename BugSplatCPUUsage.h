@@ -0,0 +1,122 @@
+//
+//  BugSplatCPUUsage.h
+//
+//  Sustained CPU use over a sliding window. Fed periodic samples of the
+//  process's and each thread's cumulative CPU time, it reports when the
+//  process has used more than a budget (a fraction of one core) across a
+//  whole window, and which threads used the most of it. Plain C with no
+//  clock or sampling of its own, so the logic can be tested on any platform
+//  with recorded or synthetic samples.
+//
+//  Copyright © BugSplat, LLC. All rights reserved.
+//
+
+#ifndef BugSplatCPUUsage_h
+#define BugSplatCPUUsage_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// Threads kept per sample; the process total still counts every thread.
+#define BugSplatCPUSampleMaxThreads 128
+
+typedef struct {
+    /// System-wide unique thread id (not the mach port, which can be reused).
+    uint64_t threadId;
+    /// CPU time the thread has used since it started, in microseconds.
+    uint64_t cpuTimeUs;
+} BugSplatThreadCPUTime;
+
+typedef struct {
+    /// Monotonic time of the sample, in microseconds.
+    uint64_t timestampUs;
+    /// CPU time the process has used since it started, including exited threads, in microseconds.
+    uint64_t processCPUTimeUs;
+    uint32_t threadCount;
+    BugSplatThreadCPUTime threads[BugSplatCPUSampleMaxThreads];
+} BugSplatCPUSample;
+
+typedef struct {
+    uint64_t threadId;
+    /// Share of one core the thread used over the window, e.g. 0.95.
+    double usage;
+} BugSplatThreadCPUUsage;
+
+/**
+ * Detector state over caller-provided sample storage. The window keeps the newest sample and
+ * the samples back to the first one at least `windowUs` older (its baseline); usage is the
+ * CPU time between the two over the time between them.
+ */
+typedef struct {
+    /// Share of one core the process may use on average over a window, e.g. 0.8.
+    double budget;
+    uint64_t windowUs;
+    /// Reports allowed per session; 0 for no limit.
+    uint32_t maxReports;
+
+    BugSplatCPUSample *samples;
+    size_t capacity;
+    /// Index of the oldest sample kept, and how many are kept.
+    size_t first;
+    size_t count;
+
+    uint32_t reportCount;
+    /// Set once a report was made for the current stretch above budget; cleared when a full
+    /// window is back under budget.
+    bool reported;
+} BugSplatCPUWindow;
+
+typedef enum {
+    /// Fewer than a full window of samples so far.
+    BugSplatCPUVerdictWarmingUp = 0,
+    BugSplatCPUVerdictUnderBudget,
+    /// Above budget for the first time in this stretch: report it.
+    BugSplatCPUVerdictExceeded,
+    /// Above budget but already reported in this stretch, or out of reports for the session.
+    BugSplatCPUVerdictStillExceeded,
+} BugSplatCPUVerdict;
+
+typedef struct {
+    BugSplatCPUVerdict verdict;
+    /// Process usage over the window (share of one core); 0 while warming up.
+    double usage;
+    /// Time the window actually spans, in microseconds (at least `windowUs` once warm).
+    uint64_t spanUs;
+} BugSplatCPUEvaluation;
+
+/**
+ * Start an empty window. `storage` holds `capacity` samples and must outlive the window; it
+ * needs room for a window's worth of samples plus two, or usage is measured over the shorter
+ * span the storage covers.
+ */
+void BugSplatCPUWindowInit(BugSplatCPUWindow *window, BugSplatCPUSample *storage, size_t capacity,
+                           double budget, uint64_t windowUs, uint32_t maxReports);
+
+/// Forget every sample (e.g. after the process was suspended); keeps the report count.
+void BugSplatCPUWindowReset(BugSplatCPUWindow *window);
+
+/**
+ * Add the next sample and evaluate the window ending with it. Samples must be added in time
+ * order; one that is not later than the newest resets the window first.
+ */
+BugSplatCPUEvaluation BugSplatCPUWindowAdd(BugSplatCPUWindow *window, const BugSplatCPUSample *sample);
+
+/**
+ * The threads that used the most CPU over the current window, busiest first: each thread's
+ * CPU time since the baseline sample (or all of it, for a thread started since). Threads that
+ * used none are left out.
+ *
+ * @return Number of threads written to `threads`, at most `maxThreads`.
+ */
+size_t BugSplatCPUWindowHottestThreads(const BugSplatCPUWindow *window, BugSplatThreadCPUUsage *threads, size_t maxThreads);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BugSplatCPUUsage_h */
@@ -0,0 +1,192 @@
+//
+//  BugSplatCallTree.c
+//
+//  Copyright © BugSplat, LLC. All rights reserved.
+//
+
+#include "BugSplatCallTree.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+static const int32_t kBugSplatCallTreeNone = -1;
+
+#pragma mark - Building
+
+bool BugSplatCallTreeInit(BugSplatCallTree *tree, BugSplatCallTreeNode *nodes, size_t capacity)
+{
+    memset(tree, 0, sizeof(*tree));
+    if (!nodes || capacity < 2 || capacity > INT32_MAX) {
+        return false;
+    }
+    tree->nodes = nodes;
+    tree->capacity = capacity;
+    BugSplatCallTreeReset(tree);
+    return true;
+}
+
+void BugSplatCallTreeReset(BugSplatCallTree *tree)
+{
+    if (!tree->nodes) {
+        return;
+    }
+    BugSplatCallTreeNode *root = &tree->nodes[0];
+    root->address = 0;
+    root->weight = 0;
+    root->selfWeight = 0;
+    root->firstChild = kBugSplatCallTreeNone;
+    root->nextSibling = kBugSplatCallTreeNone;
+    tree->count = 1;
+    tree->samples = 0;
+    tree->truncatedSamples = 0;
+}
+
+/// Index of the child of `parent` for `address`, created if needed; -1 if the array is full.
+static int32_t BugSplatCallTreeChild(BugSplatCallTree *tree, int32_t parent, uint64_t address)
+{
+    for (int32_t child = tree->nodes[parent].firstChild; child != kBugSplatCallTreeNone; child = tree->nodes[child].nextSibling) {
+        if (tree->nodes[child].address == address) {
+            return child;
+        }
+    }
+    if (tree->count >= tree->capacity) {
+        return kBugSplatCallTreeNone;
+    }
+    int32_t index = (int32_t)tree->count++;
+    BugSplatCallTreeNode *node = &tree->nodes[index];
+    node->address = address;
+    node->weight = 0;
+    node->selfWeight = 0;
+    node->firstChild = kBugSplatCallTreeNone;
+    node->nextSibling = tree->nodes[parent].firstChild;
+    tree->nodes[parent].firstChild = index;
+    return index;
+}
+
+void BugSplatCallTreeAddSample(BugSplatCallTree *tree, const uint64_t *frames, size_t frameCount)
+{
+    if (!tree || !tree->nodes) {
+        return;
+    }
+    if (!frames) {
+        frameCount = 0;
+    }
+    if (frameCount > BugSplatCallTreeMaxDepth) {
+        frameCount = BugSplatCallTreeMaxDepth;
+    }
+
+    tree->samples++;
+    int32_t node = 0;
+    tree->nodes[0].weight++;
+    // Frames are leaf first; the tree grows from the outermost frame down.
+    for (size_t i = frameCount; i > 0; i--) {
+        int32_t child = BugSplatCallTreeChild(tree, node, frames[i - 1]);
+        if (child == kBugSplatCallTreeNone) {
+            tree->truncatedSamples++;
+            break;
+        }
+        node = child;
+        tree->nodes[node].weight++;
+    }
+    tree->nodes[node].selfWeight++;
+}
+
+#pragma mark - Writing
+
+/// Stable insertion sort of each sibling list by descending weight, then ascending address.
+static void BugSplatCallTreeSort(BugSplatCallTree *tree, int32_t parent)
+{
+    BugSplatCallTreeNode *nodes = tree->nodes;
+    int32_t sorted = kBugSplatCallTreeNone;
+    int32_t child = nodes[parent].firstChild;
+    while (child != kBugSplatCallTreeNone) {
+        int32_t next = nodes[child].nextSibling;
+        int32_t *link = &sorted;
+        while (*link != kBugSplatCallTreeNone
+               && (nodes[*link].weight > nodes[child].weight
+                   || (nodes[*link].weight == nodes[child].weight && nodes[*link].address < nodes[child].address))) {
+            link = &nodes[*link].nextSibling;
+        }
+        nodes[child].nextSibling = *link;
+        *link = child;
+        child = next;
+    }
+    nodes[parent].firstChild = sorted;
+}
+
+typedef struct {
+    char *buffer;
+    size_t capacity;
+    size_t length;
+    bool full;
+} BugSplatCallTreeOutput;
+
+/// Append one line if it fits whole; once a line does not fit, nothing more is written.
+static void BugSplatCallTreeAppend(BugSplatCallTreeOutput *output, const char *line, size_t length)
+{
+    if (output->full || length >= output->capacity - output->length) {
+        output->full = true;
+        return;
+    }
+    memcpy(output->buffer + output->length, line, length);
+    output->length += length;
+    output->buffer[output->length] = '\0';
+}
+
+static void BugSplatCallTreeWriteNode(BugSplatCallTree *tree, int32_t index, uint32_t depth, uint32_t minWeight,
+                                      BugSplatCallTreeSymbolizer symbolize, void *context,
+                                      BugSplatCallTreeOutput *output)
+{
+    const BugSplatCallTreeNode *node = &tree->nodes[index];
+    char label[256];
+    if (symbolize) {
+        label[0] = '\0';
+        symbolize(node->address, label, sizeof(label), context);
+    } else {
+        snprintf(label, sizeof(label), "0x%" PRIx64, node->address);
+    }
+    char line[320];
+    int length = snprintf(line, sizeof(line), "%u %u %u %s\n", depth, node->weight, node->selfWeight, label);
+    if (length < 0) {
+        return;
+    }
+    BugSplatCallTreeAppend(output, line, (size_t)length < sizeof(line) ? (size_t)length : sizeof(line) - 1);
+
+    BugSplatCallTreeSort(tree, index);
+    for (int32_t child = node->firstChild; child != kBugSplatCallTreeNone && !output->full; child = tree->nodes[child].nextSibling) {
+        if (tree->nodes[child].weight < minWeight) {
+            break; // Sorted: every later sibling is lighter.
+        }
+        BugSplatCallTreeWriteNode(tree, child, depth + 1, minWeight, symbolize, context, output);
+    }
+}
+
+size_t BugSplatCallTreeWrite(BugSplatCallTree *tree, uint32_t minWeight,
+                             BugSplatCallTreeSymbolizer symbolize, void *context,
+                             char *buffer, size_t capacity)
+{
+    if (!buffer || capacity == 0) {
+        return 0;
+    }
+    buffer[0] = '\0';
+    if (!tree || !tree->nodes) {
+        return 0;
+    }
+
+    BugSplatCallTreeOutput output = { buffer, capacity, 0, false };
+    char line[64];
+    int length = tree->truncatedSamples > 0
+        ? snprintf(line, sizeof(line), "samples %u truncated %u\n", tree->samples, tree->truncatedSamples)
+        : snprintf(line, sizeof(line), "samples %u\n", tree->samples);
+    BugSplatCallTreeAppend(&output, line, (size_t)length);
+
+    BugSplatCallTreeSort(tree, 0);
+    for (int32_t child = tree->nodes[0].firstChild; child != kBugSplatCallTreeNone && !output.full; child = tree->nodes[child].nextSibling) {
+        if (tree->nodes[child].weight < minWeight) {
+            break;
+        }
+        BugSplatCallTreeWriteNode(tree, child, 0, minWeight, symbolize, context, &output);
+    }
+    return output.length;
+}
@@ -0,0 +1,93 @@
+//
+//  BugSplatCallTree.h
+//
+//  Weighted call tree built from stack samples. Plain C over a caller-provided
+//  node array, so samples can be added without allocating (e.g. while the
+//  sampled thread is suspended and may hold the malloc lock), and so the
+//  aggregation can be tested on any platform.
+//
+//  Copyright © BugSplat, LLC. All rights reserved.
+//
+
+#ifndef BugSplatCallTree_h
+#define BugSplatCallTree_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// Deepest path kept per sample; frames beyond it (towards the root) are dropped.
+#define BugSplatCallTreeMaxDepth 256
+
+/**
+ * One node per distinct call path. `weight` counts the samples whose stack passes
+ * through the node, `selfWeight` those whose stack ends at it. Children form a
+ * singly-linked sibling list; -1 ends a list. Node 0 is the root and has no address.
+ */
+typedef struct {
+    uint64_t address;
+    uint32_t weight;
+    uint32_t selfWeight;
+    int32_t firstChild;
+    int32_t nextSibling;
+} BugSplatCallTreeNode;
+
+typedef struct {
+    BugSplatCallTreeNode *nodes;
+    size_t capacity;
+    size_t count;
+    /// Samples added, including truncated ones.
+    uint32_t samples;
+    /// Samples that ran out of nodes and were recorded only down to the last node that fit.
+    uint32_t truncatedSamples;
+} BugSplatCallTree;
+
+/**
+ * Use `nodes` (`capacity` entries) for an empty tree.
+ *
+ * @return false if `capacity` is too small for the root and one frame.
+ */
+bool BugSplatCallTreeInit(BugSplatCallTree *tree, BugSplatCallTreeNode *nodes, size_t capacity);
+
+/// Drop every sample, keeping the node array.
+void BugSplatCallTreeReset(BugSplatCallTree *tree);
+
+/**
+ * Merge one stack into the tree. `frames` are return addresses, innermost (leaf)
+ * first, as a backtrace lists them. Does not allocate; when the node array is full
+ * the sample is counted up to the deepest node that already exists or still fits.
+ */
+void BugSplatCallTreeAddSample(BugSplatCallTree *tree, const uint64_t *frames, size_t frameCount);
+
+/**
+ * Writes a label for `address` into `buffer` (`capacity` bytes, NUL-terminated) and
+ * returns its length. Labels must not contain newlines.
+ */
+typedef size_t (*BugSplatCallTreeSymbolizer)(uint64_t address, char *buffer, size_t capacity, void *context);
+
+/**
+ * Write the tree as text, heaviest paths first:
+ *
+ *   samples <total> [truncated <count>]
+ *   <depth> <weight> <selfWeight> <label>     one line per node, depth-first
+ *
+ * Depth starts at 0 for outermost frames, so a line belongs to the nearest preceding
+ * line of smaller depth. Subtrees lighter than `minWeight` samples are left out.
+ * Labels come from `symbolize`, or are `0x<address>` when it is NULL. Sorts sibling
+ * lists in place. Only whole lines are written; the output is NUL-terminated.
+ *
+ * @return Length of the output, excluding the terminator.
+ */
+size_t BugSplatCallTreeWrite(BugSplatCallTree *tree, uint32_t minWeight,
+                             BugSplatCallTreeSymbolizer symbolize, void *context,
+                             char *buffer, size_t capacity);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BugSplatCallTree_h */
@@ -0,0 +1,78 @@
+//
+//  BugSplatCrashQueuePolicy.h
+//
+//  Copyright © BugSplat, LLC. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// Relative value of a queued report when a quota forces one out. Lower values go first.
+typedef NS_ENUM(NSInteger, BugSplatQueuedReportPriority) {
+    /// Hang reports.
+    BugSplatQueuedReportPriorityLow = 0,
+    /// Crash reports.
+    BugSplatQueuedReportPriorityNormal = 1,
+    /// Crash reports the user chose to send with comments.
+    BugSplatQueuedReportPriorityHigh = 2,
+};
+
+/// Why a queued report was evicted.
+typedef NS_ENUM(NSInteger, BugSplatEvictionReason) {
+    BugSplatEvictionReasonNone = 0,
+    BugSplatEvictionReasonAge,
+    BugSplatEvictionReasonCount,
+    BugSplatEvictionReasonSize,
+};
+
+/**
+ * Summary of one report in the crashes directory, as seen by the eviction policy.
+ */
+@interface BugSplatQueuedReport : NSObject
+
+@property (nonatomic, copy, readonly) NSString *filename;
+/// Time of the (most recent) occurrence the report describes.
+@property (nonatomic, strong, readonly) NSDate *timestamp;
+/// Total size on disk of the report, its metadata and attachments.
+@property (nonatomic, assign, readonly) unsigned long long byteSize;
+@property (nonatomic, assign, readonly) BugSplatQueuedReportPriority priority;
+/// Set by `BugSplatCrashQueuePolicy` on the reports it selects for eviction.
+@property (nonatomic, assign) BugSplatEvictionReason evictionReason;
+
+- (instancetype)initWithFilename:(NSString *)filename
+                       timestamp:(NSDate *)timestamp
+                        byteSize:(unsigned long long)byteSize
+                        priority:(BugSplatQueuedReportPriority)priority;
+
+@end
+
+/**
+ * Decides which queued reports to drop so the crashes directory stays within its quotas.
+ *
+ * Reports older than `maximumAge` go first. If the queue is then still over `maximumCount`
+ * or `maximumBytes`, reports are evicted lowest priority first and, within a priority,
+ * oldest first. The newest report is never evicted, even if it alone exceeds a quota.
+ *
+ * A quota of zero means unlimited.
+ */
+@interface BugSplatCrashQueuePolicy : NSObject
+
+@property (nonatomic, assign) NSUInteger maximumCount;
+@property (nonatomic, assign) unsigned long long maximumBytes;
+@property (nonatomic, assign) NSTimeInterval maximumAge;
+
+/// YES when any quota is set.
+@property (nonatomic, readonly, getter=isEnabled) BOOL enabled;
+
+/**
+ * @param reports The queued reports, in any order.
+ * @param now Reference time for the age quota.
+ * @return The reports to evict, each with `evictionReason` set, in eviction order.
+ */
+- (NSArray<BugSplatQueuedReport *> *)reportsToEvictFromReports:(NSArray<BugSplatQueuedReport *> *)reports
+                                                           now:(NSDate *)now;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,96 @@
+//
+//  BugSplatCrashQueuePolicy.m
+//
+//  Copyright © BugSplat, LLC. All rights reserved.
+//
+
+#import "BugSplatCrashQueuePolicy.h"
+
+@implementation BugSplatQueuedReport
+
+- (instancetype)initWithFilename:(NSString *)filename
+                       timestamp:(NSDate *)timestamp
+                        byteSize:(unsigned long long)byteSize
+                        priority:(BugSplatQueuedReportPriority)priority
+{
+    if (self = [super init]) {
+        _filename = [filename copy];
+        _timestamp = timestamp;
+        _byteSize = byteSize;
+        _priority = priority;
+        _evictionReason = BugSplatEvictionReasonNone;
+    }
+    return self;
+}
+
+@end
+
+@implementation BugSplatCrashQueuePolicy
+
+- (BOOL)isEnabled
+{
+    return self.maximumCount > 0 || self.maximumBytes > 0 || self.maximumAge > 0;
+}
+
+- (NSArray<BugSplatQueuedReport *> *)reportsToEvictFromReports:(NSArray<BugSplatQueuedReport *> *)reports
+                                                           now:(NSDate *)now
+{
+    if (reports.count < 2 || !self.isEnabled) {
+        return @[];
+    }
+
+    // Oldest first; ties broken by filename (timestamp-based) so the order is stable.
+    NSMutableArray<BugSplatQueuedReport *> *remaining = [[reports sortedArrayUsingComparator:^NSComparisonResult(BugSplatQueuedReport *a, BugSplatQueuedReport *b) {
+        NSComparisonResult result = [a.timestamp compare:b.timestamp];
+        return result != NSOrderedSame ? result : [a.filename compare:b.filename];
+    }] mutableCopy];
+    BugSplatQueuedReport *newest = remaining.lastObject;
+    NSMutableArray<BugSplatQueuedReport *> *evicted = [NSMutableArray array];
+
+    if (self.maximumAge > 0) {
+        for (BugSplatQueuedReport *report in [remaining copy]) {
+            if (report != newest && [now timeIntervalSinceDate:report.timestamp] > self.maximumAge) {
+                report.evictionReason = BugSplatEvictionReasonAge;
+                [evicted addObject:report];
+                [remaining removeObject:report];
+            }
+        }
+    }
+
+    while (self.maximumCount > 0 && remaining.count > self.maximumCount) {
+        BugSplatQueuedReport *victim = [self nextVictimInReports:remaining];
+        victim.evictionReason = BugSplatEvictionReasonCount;
+        [evicted addObject:victim];
+        [remaining removeObject:victim];
+    }
+
+    if (self.maximumBytes > 0) {
+        unsigned long long totalBytes = 0;
+        for (BugSplatQueuedReport *report in remaining) {
+            totalBytes += report.byteSize;
+        }
+        while (totalBytes > self.maximumBytes && remaining.count > 1) {
+            BugSplatQueuedReport *victim = [self nextVictimInReports:remaining];
+            victim.evictionReason = BugSplatEvictionReasonSize;
+            totalBytes -= victim.byteSize;
+            [evicted addObject:victim];
+            [remaining removeObject:victim];
+        }
+    }
+
+    return evicted;
+}
+
+/// Lowest priority, then oldest, excluding the newest report. `reports` is sorted oldest first.
+- (BugSplatQueuedReport *)nextVictimInReports:(NSArray<BugSplatQueuedReport *> *)reports
+{
+    BugSplatQueuedReport *victim = nil;
+    for (NSUInteger i = 0; i + 1 < reports.count; i++) {
+        if (!victim || reports[i].priority < victim.priority) {
+            victim = reports[i];
+        }
+    }
+    return victim;
+}
+
+@end
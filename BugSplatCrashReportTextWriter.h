@@ -0,0 +1,116 @@
+//
+//  BugSplatCrashReportTextWriter.h
+//
+//  Copyright © BugSplat, LLC. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+@class PLCrashReport;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * Destination for formatted report text, written in UTF-8 chunks.
+ */
+@protocol BugSplatTextSink <NSObject>
+
+/// @return NO if the bytes could not be written; the writer stops at the first failure.
+- (BOOL)writeBytes:(const void *)bytes length:(size_t)length;
+
+@end
+
+/**
+ * Writes to a file through a fixed-size buffer, so memory use does not grow with the
+ * amount of text written.
+ */
+@interface BugSplatFileTextSink : NSObject <BugSplatTextSink>
+
+/// Default buffer size used by `BugSplatCrashReportTextWriter` when writing to a file.
+@property (class, nonatomic, readonly) size_t defaultBufferSize;
+
+/**
+ * Create (or truncate) the file at `path`.
+ *
+ * @return nil if the file cannot be opened for writing.
+ */
+- (nullable instancetype)initWithPath:(NSString *)path bufferSize:(size_t)bufferSize NS_DESIGNATED_INITIALIZER;
+- (instancetype)init NS_UNAVAILABLE;
+
+/// Total bytes accepted so far, including bytes still buffered.
+@property (nonatomic, readonly) unsigned long long bytesWritten;
+
+/// Flush buffered bytes and close the file. Called from dealloc if needed.
+- (BOOL)close;
+
+@end
+
+/**
+ * Collects text into memory. Used where the caller needs the bytes themselves.
+ */
+@interface BugSplatDataTextSink : NSObject <BugSplatTextSink>
+
+@property (nonatomic, strong, readonly) NSMutableData *data;
+
+@end
+
+/**
+ * Options that shrink a text report while keeping it symbolicatable.
+ */
+@interface BugSplatCrashReportTextOptions : NSObject
+
+/// Options that trim other threads to `frameLimit` frames and drop unreferenced images.
++ (instancetype)slimOptionsWithFrameLimit:(NSUInteger)frameLimit;
+
+/**
+ * List only binary images that contain at least one written frame, plus the main
+ * executable. Every written frame can still be symbolicated. Default: NO
+ */
+@property (nonatomic, assign) BOOL onlyReferencedImages;
+
+/**
+ * Maximum number of frames written for threads other than the crashed thread and the main
+ * thread (thread 0), which are always written in full. Innermost frames are kept.
+ * Zero means unlimited. Default: 0
+ */
+@property (nonatomic, assign) NSUInteger otherThreadFrameLimit;
+
+@end
+
+/**
+ * Formats a PLCrashReporter report in the iOS (Apple) text format, writing it line by line
+ * to a sink instead of building it as one string.
+ *
+ * The output is identical to `+[PLCrashReportTextFormatter stringValueForCrashReport:withTextFormat:]`
+ * with `PLCrashReportTextFormatiOS`, encoded as UTF-8. Only one line - or one thread's
+ * frames - is held in memory at a time, so reports with hundreds of threads and binary
+ * images can be formatted without the large temporary strings the string-based formatter
+ * allocates.
+ *
+ * With `BugSplatCrashReportTextOptions` the same format is written with fewer frames and
+ * binary images; without options (or with default options) the output is unchanged.
+ */
+@interface BugSplatCrashReportTextWriter : NSObject
+
+/// @return NO if the sink rejected a write.
++ (BOOL)writeCrashReport:(PLCrashReport *)crashReport toSink:(id<BugSplatTextSink>)sink;
++ (BOOL)writeCrashReport:(PLCrashReport *)crashReport
+                  toSink:(id<BugSplatTextSink>)sink
+                 options:(nullable BugSplatCrashReportTextOptions *)options;
+
+/**
+ * Write the report's text to `path` through a `BugSplatFileTextSink`. The text is written
+ * to a temporary file that replaces `path` only once complete.
+ */
++ (BOOL)writeCrashReport:(PLCrashReport *)crashReport toFile:(NSString *)path;
++ (BOOL)writeCrashReport:(PLCrashReport *)crashReport
+                  toFile:(NSString *)path
+                 options:(nullable BugSplatCrashReportTextOptions *)options;
+
+/// The report's text as UTF-8 bytes.
++ (NSData *)dataForCrashReport:(PLCrashReport *)crashReport;
++ (NSData *)dataForCrashReport:(PLCrashReport *)crashReport options:(nullable BugSplatCrashReportTextOptions *)options;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,656 @@
+//
+//  BugSplatCrashReportTextWriter.m
+//
+//  Copyright © BugSplat, LLC. All rights reserved.
+//
+
+#import "BugSplatCrashReportTextWriter.h"
+#import "BugSplatLogging.h"
+
+#import <CrashReporter/CrashReporter.h>
+#import <fcntl.h>
+#import <inttypes.h>
+#import <mach/machine.h>
+#import <unistd.h>
+
+#pragma mark - Sinks
+
+@implementation BugSplatFileTextSink
+{
+    int _fd;
+    uint8_t *_buffer;
+    size_t _bufferSize;
+    size_t _buffered;
+}
+
++ (size_t)defaultBufferSize
+{
+    return 64 * 1024;
+}
+
+- (instancetype)initWithPath:(NSString *)path bufferSize:(size_t)bufferSize
+{
+    if (self = [super init]) {
+        _fd = open(path.fileSystemRepresentation, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (_fd < 0) {
+            BugSplatLogError(@"Failed to open %@ for writing: %s", path.lastPathComponent, strerror(errno));
+            return nil;
+        }
+        _bufferSize = MAX(bufferSize, (size_t)512);
+        _buffer = malloc(_bufferSize);
+        if (!_buffer) {
+            close(_fd);
+            _fd = -1;
+            return nil;
+        }
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    [self close];
+}
+
+- (BOOL)flush
+{
+    size_t offset = 0;
+    while (offset < _buffered) {
+        ssize_t written = write(_fd, _buffer + offset, _buffered - offset);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            return NO;
+        }
+        offset += (size_t)written;
+    }
+    _buffered = 0;
+    return YES;
+}
+
+- (BOOL)writeBytes:(const void *)bytes length:(size_t)length
+{
+    if (_fd < 0) {
+        return NO;
+    }
+    _bytesWritten += length;
+
+    const uint8_t *source = bytes;
+    while (length > 0) {
+        if (_buffered == _bufferSize && ![self flush]) {
+            return NO;
+        }
+        size_t chunk = MIN(length, _bufferSize - _buffered);
+        memcpy(_buffer + _buffered, source, chunk);
+        _buffered += chunk;
+        source += chunk;
+        length -= chunk;
+    }
+    return YES;
+}
+
+- (BOOL)close
+{
+    if (_fd < 0) {
+        return NO;
+    }
+    BOOL success = [self flush];
+    success = (close(_fd) == 0) && success;
+    _fd = -1;
+    free(_buffer);
+    _buffer = NULL;
+    return success;
+}
+
+@end
+
+@implementation BugSplatDataTextSink
+
+- (instancetype)init
+{
+    if (self = [super init]) {
+        _data = [NSMutableData data];
+    }
+    return self;
+}
+
+- (BOOL)writeBytes:(const void *)bytes length:(size_t)length
+{
+    [_data appendBytes:bytes length:length];
+    return YES;
+}
+
+@end
+
+#pragma mark - Options
+
+@implementation BugSplatCrashReportTextOptions
+
++ (instancetype)slimOptionsWithFrameLimit:(NSUInteger)frameLimit
+{
+    BugSplatCrashReportTextOptions *options = [[self alloc] init];
+    options.onlyReferencedImages = YES;
+    options.otherThreadFrameLimit = frameLimit;
+    return options;
+}
+
+@end
+
+#pragma mark - Writer
+
+// PLCrashReporter numbers threads in task order; the main thread is always first.
+static const NSInteger kBugSplatMainThreadNumber = 0;
+
+@interface BugSplatCrashReportTextWriter ()
+@property (nonatomic, strong) id<BugSplatTextSink> sink;
+@property (nonatomic, strong) PLCrashReport *report;
+@property (nonatomic, strong, nullable) BugSplatCrashReportTextOptions *options;
+/// Base addresses of images containing a written frame; only tracked with onlyReferencedImages.
+@property (nonatomic, strong, nullable) NSMutableSet<NSNumber *> *referencedImageAddresses;
+@property (nonatomic, assign) BOOL lp64;
+@property (nonatomic, assign) BOOL failed;
+- (void)appendFormat:(NSString *)format, ... NS_FORMAT_FUNCTION(1,2);
+@end
+
+@implementation BugSplatCrashReportTextWriter
+
++ (BOOL)writeCrashReport:(PLCrashReport *)crashReport toSink:(id<BugSplatTextSink>)sink
+{
+    return [self writeCrashReport:crashReport toSink:sink options:nil];
+}
+
++ (BOOL)writeCrashReport:(PLCrashReport *)crashReport
+                  toSink:(id<BugSplatTextSink>)sink
+                 options:(BugSplatCrashReportTextOptions *)options
+{
+    BugSplatCrashReportTextWriter *writer = [[self alloc] init];
+    writer.sink = sink;
+    writer.report = crashReport;
+    writer.options = options;
+    if (options.onlyReferencedImages) {
+        writer.referencedImageAddresses = [NSMutableSet set];
+    }
+    [writer writeReport];
+    return !writer.failed;
+}
+
++ (BOOL)writeCrashReport:(PLCrashReport *)crashReport toFile:(NSString *)path
+{
+    return [self writeCrashReport:crashReport toFile:path options:nil];
+}
+
++ (BOOL)writeCrashReport:(PLCrashReport *)crashReport
+                  toFile:(NSString *)path
+                 options:(BugSplatCrashReportTextOptions *)options
+{
+    NSString *temporaryPath = [path stringByAppendingString:@".tmp"];
+    BugSplatFileTextSink *sink = [[BugSplatFileTextSink alloc] initWithPath:temporaryPath
+                                                                 bufferSize:BugSplatFileTextSink.defaultBufferSize];
+    if (!sink) {
+        return NO;
+    }
+    BOOL success = [self writeCrashReport:crashReport toSink:sink options:options];
+    success = [sink close] && success;
+    if (success) {
+        success = rename(temporaryPath.fileSystemRepresentation, path.fileSystemRepresentation) == 0;
+    }
+    if (!success) {
+        unlink(temporaryPath.fileSystemRepresentation);
+    }
+    return success;
+}
+
++ (NSData *)dataForCrashReport:(PLCrashReport *)crashReport
+{
+    return [self dataForCrashReport:crashReport options:nil];
+}
+
++ (NSData *)dataForCrashReport:(PLCrashReport *)crashReport options:(BugSplatCrashReportTextOptions *)options
+{
+    BugSplatDataTextSink *sink = [[BugSplatDataTextSink alloc] init];
+    [self writeCrashReport:crashReport toSink:sink options:options];
+    return sink.data;
+}
+
+#pragma mark - Output
+
+- (void)appendString:(NSString *)string
+{
+    if (self.failed || string.length == 0) {
+        return;
+    }
+
+    uint8_t chunk[1024];
+    NSRange remaining = NSMakeRange(0, string.length);
+    while (remaining.length > 0) {
+        NSUInteger used = 0;
+        [string getBytes:chunk
+               maxLength:sizeof(chunk)
+              usedLength:&used
+                encoding:NSUTF8StringEncoding
+                 options:0
+                   range:remaining
+          remainingRange:&remaining];
+        if (used == 0) {
+            // Not representable as UTF-8 (e.g. an unpaired surrogate in a symbol name).
+            NSData *lossy = [[string substringWithRange:remaining] dataUsingEncoding:NSUTF8StringEncoding allowLossyConversion:YES];
+            self.failed = ![self.sink writeBytes:lossy.bytes length:lossy.length];
+            return;
+        }
+        if (![self.sink writeBytes:chunk length:used]) {
+            self.failed = YES;
+            return;
+        }
+    }
+}
+
+- (void)appendFormat:(NSString *)format, ...
+{
+    va_list args;
+    va_start(args, format);
+    NSString *string = [[NSString alloc] initWithFormat:format arguments:args];
+    va_end(args);
+    [self appendString:string];
+}
+
+#pragma mark - Report sections
+
+// Section by section, the output mirrors PLCrashReportTextFormatter's iOS format. Each
+// section formats one line at a time inside its own autorelease pool.
+
+- (void)writeReport
+{
+    PLCrashReport *report = self.report;
+    NSString *codeType = [self codeType];
+
+    @autoreleasepool {
+        [self writeHeaderWithCodeType:codeType];
+    }
+
+    @autoreleasepool {
+        [self appendFormat:@"Exception Type:  %@\n", report.signalInfo.name];
+        [self appendFormat:@"Exception Codes: %@ at 0x%" PRIx64 "\n", report.signalInfo.code, report.signalInfo.address];
+        for (PLCrashReportThreadInfo *thread in report.threads) {
+            if (thread.crashed) {
+                [self appendFormat:@"Crashed Thread:  %ld\n", (long)thread.threadNumber];
+                break;
+            }
+        }
+        [self appendString:@"\n"];
+
+        if (report.hasExceptionInfo) {
+            [self appendString:@"Application Specific Information:\n"];
+            [self appendFormat:@"*** Terminating app due to uncaught exception '%@', reason: '%@'\n",
+             report.exceptionInfo.exceptionName, report.exceptionInfo.exceptionReason];
+            [self appendString:@"\n"];
+        }
+    }
+
+    NSArray<PLCrashReportStackFrameInfo *> *exceptionFrames = report.exceptionInfo.stackFrames;
+    if (exceptionFrames.count > 0) {
+        @autoreleasepool {
+            [self appendString:@"Last Exception Backtrace:\n"];
+            [self writeStackFrames:exceptionFrames];
+            [self appendString:@"\n"];
+        }
+    }
+
+    PLCrashReportThreadInfo *crashedThread = nil;
+    for (PLCrashReportThreadInfo *thread in report.threads) {
+        @autoreleasepool {
+            if (thread.crashed) {
+                [self appendFormat:@"Thread %ld Crashed:\n", (long)thread.threadNumber];
+                crashedThread = thread;
+            } else {
+                [self appendFormat:@"Thread %ld:\n", (long)thread.threadNumber];
+            }
+            NSArray<PLCrashReportStackFrameInfo *> *stackFrames = thread.stackFrames;
+            NSUInteger frameLimit = self.options.otherThreadFrameLimit;
+            if (frameLimit > 0 && stackFrames.count > frameLimit
+                && !thread.crashed && thread.threadNumber != kBugSplatMainThreadNumber) {
+                stackFrames = [stackFrames subarrayWithRange:NSMakeRange(0, frameLimit)];
+            }
+            [self writeStackFrames:stackFrames];
+            [self appendString:@"\n"];
+        }
+    }
+
+    if (crashedThread) {
+        @autoreleasepool {
+            [self writeRegistersOfThread:crashedThread codeType:codeType];
+        }
+    }
+
+    [self writeBinaryImages];
+}
+
+/// Apple-style code type from the first Mach-typed image, falling back on the legacy
+/// architecture field. Also decides whether addresses are formatted as 64-bit.
+- (NSString *)codeType
+{
+    PLCrashReport *report = self.report;
+    self.lp64 = YES;
+
+    for (PLCrashReportBinaryImageInfo *image in report.images) {
+        if (image.codeType == nil || image.codeType.typeEncoding != PLCrashReportProcessorTypeEncodingMach) {
+            continue;
+        }
+        switch (image.codeType.type) {
+            case CPU_TYPE_ARM:
+                self.lp64 = NO;
+                return @"ARM";
+            case CPU_TYPE_ARM64:
+                self.lp64 = YES;
+                return @"ARM-64";
+            case CPU_TYPE_X86:
+                self.lp64 = NO;
+                return @"X86";
+            case CPU_TYPE_X86_64:
+                self.lp64 = YES;
+                return @"X86-64";
+            case CPU_TYPE_POWERPC:
+                self.lp64 = NO;
+                return @"PPC";
+            default:
+                break;
+        }
+    }
+
+    switch (report.systemInfo.architecture) {
+        case PLCrashReportArchitectureARMv6:
+        case PLCrashReportArchitectureARMv7:
+            self.lp64 = NO;
+            return @"ARM";
+        case PLCrashReportArchitectureX86_32:
+            self.lp64 = NO;
+            return @"X86";
+        case PLCrashReportArchitectureX86_64:
+            self.lp64 = YES;
+            return @"X86-64";
+        case PLCrashReportArchitecturePPC:
+            self.lp64 = NO;
+            return @"PPC";
+        default:
+            self.lp64 = YES;
+            return [NSString stringWithFormat:@"Unknown (%d)", report.systemInfo.architecture];
+    }
+}
+
+- (void)writeHeaderWithCodeType:(NSString *)codeType
+{
+    PLCrashReport *report = self.report;
+
+    NSString *osName;
+    switch (report.systemInfo.operatingSystem) {
+        case PLCrashReportOperatingSystemMacOSX:
+            osName = @"Mac OS X";
+            break;
+        case PLCrashReportOperatingSystemiPhoneOS:
+            osName = @"iPhone OS";
+            break;
+        case PLCrashReportOperatingSystemiPhoneSimulator:
+            osName = @"Mac OS X";
+            break;
+        case PLCrashReportOperatingSystemAppleTVOS:
+            osName = @"Apple tvOS";
+            break;
+        default:
+            osName = [NSString stringWithFormat:@"Unknown (%d)", report.systemInfo.operatingSystem];
+            break;
+    }
+
+    NSString *hardwareModel = @"???";
+    if (report.hasMachineInfo && report.machineInfo.modelName != nil) {
+        hardwareModel = report.machineInfo.modelName;
+    }
+    NSString *incidentIdentifier = @"???";
+    if (report.uuidRef != NULL) {
+        incidentIdentifier = (NSString *)CFBridgingRelease(CFUUIDCreateString(NULL, report.uuidRef));
+    }
+    [self appendFormat:@"Incident Identifier: %@\n", incidentIdentifier];
+    [self appendString:@"CrashReporter Key:   TODO\n"];
+    [self appendFormat:@"Hardware Model:      %@\n", hardwareModel];
+
+    NSString *processName = @"???";
+    NSString *processId = @"???";
+    NSString *processPath = @"???";
+    NSString *parentProcessName = @"???";
+    NSString *parentProcessId = @"???";
+    if (report.hasProcessInfo) {
+        if (report.processInfo.processName != nil) {
+            processName = report.processInfo.processName;
+        }
+        processId = [[NSNumber numberWithUnsignedInteger:report.processInfo.processID] stringValue];
+        if (report.processInfo.processPath != nil) {
+            processPath = report.processInfo.processPath;
+#if TARGET_OS_MAC && !TARGET_OS_IPHONE
+            // Remove the user name from the path, as the string-based formatter does.
+            if (processPath.length > 0) {
+                processPath = [processPath stringByAbbreviatingWithTildeInPath];
+            }
+            if (processPath.length > 0 && [[processPath substringToIndex:1] isEqualToString:@"~"]) {
+                processPath = [NSString stringWithFormat:@"/Users/USER%@", [processPath substringFromIndex:1]];
+            }
+#endif
+        }
+        if (report.processInfo.parentProcessName != nil) {
+            parentProcessName = report.processInfo.parentProcessName;
+        }
+        parentProcessId = [[NSNumber numberWithUnsignedInteger:report.processInfo.parentProcessID] stringValue];
+    }
+
+    NSString *versionString = report.applicationInfo.applicationVersion;
+    if (report.applicationInfo.applicationMarketingVersion != nil) {
+        versionString = [NSString stringWithFormat:@"%@ (%@)",
+                         report.applicationInfo.applicationMarketingVersion,
+                         report.applicationInfo.applicationVersion];
+    }
+
+    [self appendFormat:@"Process:         %@ [%@]\n", processName, processId];
+    [self appendFormat:@"Path:            %@\n", processPath];
+    [self appendFormat:@"Identifier:      %@\n", report.applicationInfo.applicationIdentifier];
+    [self appendFormat:@"Version:         %@\n", versionString];
+    [self appendFormat:@"Code Type:       %@\n", codeType];
+    [self appendFormat:@"Parent Process:  %@ [%@]\n", parentProcessName, parentProcessId];
+    [self appendString:@"\n"];
+
+    NSString *osBuild = @"???";
+    if (report.systemInfo.operatingSystemBuild != nil) {
+        osBuild = report.systemInfo.operatingSystemBuild;
+    }
+    NSDateFormatter *rfc3339Formatter = [[NSDateFormatter alloc] init];
+    rfc3339Formatter.locale = [[NSLocale alloc] initWithLocaleIdentifier:@"en_US_POSIX"];
+    rfc3339Formatter.dateFormat = @"yyyy'-'MM'-'dd' 'HH':'mm':'ss'.'SSS ZZZ";
+    rfc3339Formatter.timeZone = [NSTimeZone timeZoneForSecondsFromGMT:0];
+
+    [self appendFormat:@"Date/Time:       %@\n", [rfc3339Formatter stringFromDate:report.systemInfo.timestamp]];
+    [self appendFormat:@"OS Version:      %@ %@ (%@)\n", osName, report.systemInfo.operatingSystemVersion, osBuild];
+    [self appendString:@"Report Version:  104\n"];
+    [self appendString:@"\n"];
+}
+
+- (void)writeStackFrames:(NSArray<PLCrashReportStackFrameInfo *> *)stackFrames
+{
+    NSUInteger frameIndex = 0;
+    for (PLCrashReportStackFrameInfo *frame in stackFrames) {
+        [self writeStackFrame:frame frameIndex:frameIndex++];
+    }
+}
+
+- (void)writeStackFrame:(PLCrashReportStackFrameInfo *)frameInfo frameIndex:(NSUInteger)frameIndex
+{
+    PLCrashReport *report = self.report;
+    uint64_t baseAddress = 0x0;
+    uint64_t pcOffset = 0x0;
+    NSString *imageName = @"\?\?\?";
+    NSString *symbolString = nil;
+
+    PLCrashReportBinaryImageInfo *imageInfo = [report imageForAddress:frameInfo.instructionPointer];
+    if (imageInfo != nil) {
+        [self.referencedImageAddresses addObject:@(imageInfo.imageBaseAddress)];
+        imageName = [imageInfo.imageName lastPathComponent];
+        baseAddress = imageInfo.imageBaseAddress;
+        pcOffset = frameInfo.instructionPointer - imageInfo.imageBaseAddress;
+    }
+
+    // Truncate long image names and pad short ones to a fixed column, counting composed
+    // character sequences rather than UTF-16 units - exactly as the string-based formatter.
+    NSInteger offset = 0;
+    NSInteger index = 0;
+    for (index = 0; index < (NSInteger)imageName.length; index++) {
+        NSRange range = [imageName rangeOfComposedCharacterSequenceAtIndex:index];
+        if (range.length > 1) {
+            offset += range.length - 1;
+            index += range.length - 1;
+        }
+        if (index > 32) {
+            imageName = [NSString stringWithFormat:@"%@... ", [imageName substringToIndex:index - 1]];
+            index += 3;
+            break;
+        }
+    }
+    if (index - offset < 36) {
+        imageName = [imageName stringByPaddingToLength:36 + offset withString:@" " startingAtIndex:0];
+    }
+
+    if (frameInfo.symbolInfo != nil) {
+        NSString *symbolName = frameInfo.symbolInfo.symbolName;
+        // Apple strips the leading underscore on its own platforms.
+        if ([symbolName rangeOfString:@"_"].location == 0 && symbolName.length > 1) {
+            switch (report.systemInfo.operatingSystem) {
+                case PLCrashReportOperatingSystemMacOSX:
+                case PLCrashReportOperatingSystemiPhoneOS:
+                case PLCrashReportOperatingSystemAppleTVOS:
+                case PLCrashReportOperatingSystemiPhoneSimulator:
+                    symbolName = [symbolName substringFromIndex:1];
+                    break;
+                default:
+                    break;
+            }
+        }
+        uint64_t symbolOffset = frameInfo.instructionPointer - frameInfo.symbolInfo.startAddress;
+        symbolString = [NSString stringWithFormat:@"%@ + %" PRId64, symbolName, symbolOffset];
+    } else {
+        symbolString = [NSString stringWithFormat:@"0x%" PRIx64 " + %" PRId64, baseAddress, pcOffset];
+    }
+
+    // %S (UTF-16) honours the width specifier, which %@ does not.
+    [self appendFormat:@"%-4ld%-35S 0x%0*" PRIx64 " %@\n",
+     (long)frameIndex,
+     (const unichar *)[imageName cStringUsingEncoding:NSUTF16StringEncoding],
+     self.lp64 ? 16 : 8, frameInfo.instructionPointer,
+     symbolString];
+}
+
+- (void)writeRegistersOfThread:(PLCrashReportThreadInfo *)thread codeType:(NSString *)codeType
+{
+    PLCrashReport *report = self.report;
+    [self appendFormat:@"Thread %ld crashed with %@ Thread State:\n", (long)thread.threadNumber, codeType];
+
+    // Apple uses 'ip' rather than 'r12' on ARM.
+    BOOL isARM = NO;
+    if (report.machineInfo != nil && report.machineInfo.processorInfo.typeEncoding == PLCrashReportProcessorTypeEncodingMach) {
+        isARM = (report.machineInfo.processorInfo.type & ~CPU_ARCH_MASK) == CPU_TYPE_ARM;
+    }
+
+    int column = 0;
+    for (PLCrashReportRegisterInfo *reg in thread.registers) {
+        NSString *registerName = reg.registerName;
+        if (isARM && [registerName isEqual:@"r12"]) {
+            registerName = @"ip";
+        }
+        if (self.lp64) {
+            [self appendFormat:@"%6s: 0x%016" PRIx64 " ", registerName.UTF8String, reg.registerValue];
+        } else {
+            [self appendFormat:@"%6s: 0x%08" PRIx64 " ", registerName.UTF8String, reg.registerValue];
+        }
+        if (++column == 4) {
+            [self appendString:@"\n"];
+            column = 0;
+        }
+    }
+    if (column != 0) {
+        [self appendString:@"\n"];
+    }
+    [self appendString:@"\n"];
+}
+
+- (NSString *)architectureNameForImage:(PLCrashReportBinaryImageInfo *)imageInfo
+{
+    if (imageInfo.codeType == nil || imageInfo.codeType.typeEncoding != PLCrashReportProcessorTypeEncodingMach) {
+        return @"???";
+    }
+    switch (imageInfo.codeType.type) {
+        case CPU_TYPE_ARM:
+            switch (imageInfo.codeType.subtype) {
+                case CPU_SUBTYPE_ARM_V6:
+                    return @"armv6";
+                case CPU_SUBTYPE_ARM_V7:
+                    return @"armv7";
+                case CPU_SUBTYPE_ARM_V7S:
+                    return @"armv7s";
+                default:
+                    return @"arm-unknown";
+            }
+        case CPU_TYPE_ARM64:
+            switch (imageInfo.codeType.subtype & ~CPU_SUBTYPE_MASK) {
+                case CPU_SUBTYPE_ARM64_ALL:
+                    return @"arm64";
+                case CPU_SUBTYPE_ARM64_V8:
+                    return @"armv8";
+                case CPU_SUBTYPE_ARM64E:
+                    return @"arm64e";
+                default:
+                    return @"arm64-unknown";
+            }
+        case CPU_TYPE_X86:
+            return @"i386";
+        case CPU_TYPE_X86_64:
+            return @"x86_64";
+        case CPU_TYPE_POWERPC:
+            return @"powerpc";
+        default:
+            return @"???";
+    }
+}
+
+/// Binary images in ascending order of base address, as in Apple's reports.
+- (void)writeBinaryImages
+{
+    PLCrashReport *report = self.report;
+    [self appendString:@"Binary Images:\n"];
+
+    NSMutableArray<PLCrashReportBinaryImageInfo *> *images = [NSMutableArray arrayWithArray:report.images];
+    [images sortUsingDescriptors:@[[[NSSortDescriptor alloc] initWithKey:@"imageBaseAddress" ascending:YES]]];
+
+    NSString *processPath = report.processInfo.processPath;
+    NSSet<NSNumber *> *referencedImageAddresses = self.referencedImageAddresses;
+    for (PLCrashReportBinaryImageInfo *imageInfo in images) {
+        // The main executable stays listed so the report still identifies the app build.
+        if (referencedImageAddresses && ![referencedImageAddresses containsObject:@(imageInfo.imageBaseAddress)]
+            && ![imageInfo.imageName isEqual:processPath]) {
+            continue;
+        }
+        @autoreleasepool {
+            NSString *uuid = imageInfo.hasImageUUID ? imageInfo.imageUUID : @"???";
+            NSString *binaryDesignator = [imageInfo.imageName isEqual:processPath] ? @"+" : @" ";
+            // The Apple format uses an inclusive range.
+            uint64_t endAddress = imageInfo.imageBaseAddress + (MAX(1, imageInfo.imageSize) - 1);
+
+            if (self.lp64) {
+                [self appendFormat:@"%18#" PRIx64 " - %18#" PRIx64 " %@%@ %@  <%@> %@\n",
+                 imageInfo.imageBaseAddress, endAddress, binaryDesignator,
+                 [imageInfo.imageName lastPathComponent], [self architectureNameForImage:imageInfo],
+                 uuid, imageInfo.imageName];
+            } else {
+                [self appendFormat:@"%10#" PRIx64 " - %10#" PRIx64 " %@%@ %@  <%@> %@\n",
+                 imageInfo.imageBaseAddress, endAddress, binaryDesignator,
+                 [imageInfo.imageName lastPathComponent], [self architectureNameForImage:imageInfo],
+                 uuid, imageInfo.imageName];
+            }
+        }
+    }
+}
+
+@end
@@ -0,0 +1,50 @@
+//
+//  BugSplatCrashSignature.h
+//
+//  Copyright © BugSplat, LLC. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+@class PLCrashReport;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// Number of top frames that contribute to a crash signature.
+extern const NSUInteger kBugSplatCrashSignatureFrameCount;
+
+/**
+ * Computes a stable signature for a crash, used to recognise repeated occurrences of the
+ * same crash on-device.
+ *
+ * The signature is a hash of the exception type and the top frames of the faulting stack.
+ * Frames are identified by binary image name and offset into that image, so the signature
+ * is stable across launches despite ASLR, and changes when the app binary is rebuilt.
+ */
+@interface BugSplatCrashSignature : NSObject
+
+/**
+ * Signature of a parsed PLCrashReporter report.
+ *
+ * The exception type is the Objective-C exception name when the report carries one,
+ * otherwise the signal name and code. Frames are taken from the exception's backtrace when
+ * available (the crashed thread's top frames are then just the abort path shared by every
+ * uncaught exception), otherwise from the crashed thread.
+ *
+ * @return A hex string, or nil if the report has neither exception nor signal information.
+ */
++ (nullable NSString *)signatureForCrashReport:(PLCrashReport *)crashReport frameCount:(NSUInteger)frameCount;
+
+/**
+ * Signature from already-extracted components. At most `frameCount` leading frames are used.
+ *
+ * @param exceptionType E.g. `NSInvalidArgumentException` or `SIGSEGV SEGV_ACCERR`.
+ * @param frames Frame identifiers, innermost first, e.g. `MyApp+0x1a2b`.
+ */
++ (NSString *)signatureWithExceptionType:(NSString *)exceptionType
+                                  frames:(NSArray<NSString *> *)frames
+                              frameCount:(NSUInteger)frameCount;
+
+@end
+
+NS_ASSUME_NONNULL_END
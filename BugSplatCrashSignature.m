@@ -0,0 +1,83 @@
+//
+//  BugSplatCrashSignature.m
+//
+//  Copyright © BugSplat, LLC. All rights reserved.
+//
+
+#import "BugSplatCrashSignature.h"
+
+#import <CommonCrypto/CommonDigest.h>
+#import <CrashReporter/CrashReporter.h>
+
+const NSUInteger kBugSplatCrashSignatureFrameCount = 8;
+
+// Leading digest bytes kept in the signature string; 128 bits is ample for on-device matching.
+static const NSUInteger kBugSplatSignatureDigestBytes = 16;
+
+@implementation BugSplatCrashSignature
+
++ (NSString *)signatureForCrashReport:(PLCrashReport *)crashReport frameCount:(NSUInteger)frameCount
+{
+    NSString *exceptionType = nil;
+    NSArray<PLCrashReportStackFrameInfo *> *stackFrames = nil;
+
+    if (crashReport.hasExceptionInfo && crashReport.exceptionInfo.exceptionName.length > 0) {
+        exceptionType = crashReport.exceptionInfo.exceptionName;
+        stackFrames = crashReport.exceptionInfo.stackFrames;
+    } else if (crashReport.signalInfo.name.length > 0) {
+        exceptionType = [NSString stringWithFormat:@"%@ %@", crashReport.signalInfo.name, crashReport.signalInfo.code ?: @""];
+    } else {
+        return nil;
+    }
+
+    if (stackFrames.count == 0) {
+        for (PLCrashReportThreadInfo *thread in crashReport.threads) {
+            if (thread.crashed) {
+                stackFrames = thread.stackFrames;
+                break;
+            }
+        }
+    }
+
+    NSMutableArray<NSString *> *frames = [NSMutableArray arrayWithCapacity:MIN(stackFrames.count, frameCount)];
+    for (PLCrashReportStackFrameInfo *frame in stackFrames) {
+        if (frames.count == frameCount) {
+            break;
+        }
+        PLCrashReportBinaryImageInfo *image = [crashReport imageForAddress:frame.instructionPointer];
+        if (image) {
+            [frames addObject:[NSString stringWithFormat:@"%@+0x%llx",
+                               image.imageName.lastPathComponent,
+                               frame.instructionPointer - image.imageBaseAddress]];
+        } else {
+            // Absolute addresses outside any known image vary with ASLR; only their presence counts.
+            [frames addObject:@"?"];
+        }
+    }
+
+    return [self signatureWithExceptionType:exceptionType frames:frames frameCount:frameCount];
+}
+
++ (NSString *)signatureWithExceptionType:(NSString *)exceptionType
+                                  frames:(NSArray<NSString *> *)frames
+                              frameCount:(NSUInteger)frameCount
+{
+    NSMutableString *canonical = [NSMutableString stringWithString:exceptionType];
+    NSUInteger count = MIN(frames.count, frameCount);
+    for (NSUInteger i = 0; i < count; i++) {
+        [canonical appendFormat:@"\n%@", frames[i]];
+    }
+
+    NSData *data = [canonical dataUsingEncoding:NSUTF8StringEncoding];
+    unsigned char digest[CC_SHA256_DIGEST_LENGTH];
+    CC_SHA256(data.bytes, (CC_LONG)data.length, digest);
+
+    NSMutableString *hashString = [NSMutableString stringWithCapacity:kBugSplatSignatureDigestBytes * 2];
+    for (NSUInteger i = 0; i < kBugSplatSignatureDigestBytes; i++) {
+        [hashString appendFormat:@"%02x", digest[i]];
+    }
+
+    return [hashString copy];
+}
+
+@end
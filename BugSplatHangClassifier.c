@@ -0,0 +1,251 @@
+//
+//  BugSplatHangClassifier.c
+//
+//  Copyright © BugSplat, LLC. All rights reserved.
+//
+
+#include "BugSplatHangClassifier.h"
+
+#include <ctype.h>
+#include <string.h>
+
+#pragma mark - Rules
+
+const BugSplatHangRule BugSplatHangDefaultRules[] = {
+    // Waiting for input in the run loop: the thread is idle, not blocked.
+    { "idle", "__CFRunLoopServiceMachPort", "CoreFoundation" },
+
+    { "xpc-sync", "xpc_connection_send_message_with_reply_sync", NULL },
+    { "xpc-sync", "__NSXPCCONNECTION_IS_WAITING_FOR_A_SYNCHRONOUS_REPLY__", NULL },
+
+    { "sqlite", "sqlite3*", NULL },
+
+    { "dispatch-sync", "dispatch_sync*", NULL },
+    { "dispatch-sync", "dispatch_barrier_sync*", NULL },
+    { "dispatch-sync", "_dispatch_sync_f_slow", NULL },
+    { "dispatch-sync", "_dispatch_barrier_sync_f_slow", NULL },
+    { "dispatch-sync", "__DISPATCH_WAIT_FOR_QUEUE__", NULL },
+    { "dispatch-sync", "-[NSManagedObjectContext performBlockAndWait:]", NULL },
+    { "dispatch-sync", "-[NSObject(NSThreadPerformAdditions) performSelector:onThread:withObject:waitUntilDone:modes:]", NULL },
+
+    { "socket-io", "recv", NULL },
+    { "socket-io", "recvfrom", NULL },
+    { "socket-io", "recvmsg", NULL },
+    { "socket-io", "__recvfrom*", NULL },
+    { "socket-io", "__recvmsg*", NULL },
+    { "socket-io", "send", NULL },
+    { "socket-io", "sendto", NULL },
+    { "socket-io", "sendmsg", NULL },
+    { "socket-io", "__sendto*", NULL },
+    { "socket-io", "__sendmsg*", NULL },
+    { "socket-io", "connect", NULL },
+    { "socket-io", "__connect*", NULL },
+    { "socket-io", "accept", NULL },
+    { "socket-io", "__accept*", NULL },
+    { "socket-io", "getaddrinfo", NULL },
+    { "socket-io", "select", NULL },
+    { "socket-io", "__select*", NULL },
+    { "socket-io", "poll", NULL },
+    { "socket-io", "__poll*", NULL },
+    { "socket-io", "+[NSURLConnection sendSynchronousRequest:returningResponse:error:]", NULL },
+
+    { "file-io", "read", NULL },
+    { "file-io", "pread", NULL },
+    { "file-io", "__read_nocancel", NULL },
+    { "file-io", "__pread_nocancel", NULL },
+    { "file-io", "write", NULL },
+    { "file-io", "pwrite", NULL },
+    { "file-io", "__write_nocancel", NULL },
+    { "file-io", "__pwrite_nocancel", NULL },
+    { "file-io", "open", NULL },
+    { "file-io", "__open", NULL },
+    { "file-io", "__open_nocancel", NULL },
+    { "file-io", "openat", NULL },
+    { "file-io", "__openat", NULL },
+    { "file-io", "close", NULL },
+    { "file-io", "fsync", NULL },
+    { "file-io", "__fsync_nocancel", NULL },
+    { "file-io", "fcntl", NULL },
+    { "file-io", "__fcntl_nocancel", NULL },
+    { "file-io", "stat*", NULL },
+    { "file-io", "fstat*", NULL },
+    { "file-io", "lstat*", NULL },
+    { "file-io", "getattrlist*", NULL },
+    { "file-io", "getdirentries*", NULL },
+    { "file-io", "rename", NULL },
+    { "file-io", "unlink", NULL },
+    { "file-io", "mkdir", NULL },
+    { "file-io", "rmdir", NULL },
+
+    { "condition-wait", "__psynch_cvwait", NULL },
+    { "condition-wait", "pthread_cond_wait", NULL },
+    { "condition-wait", "pthread_cond_timedwait*", NULL },
+    { "condition-wait", "-[NSCondition wait*", NULL },
+    { "condition-wait", "-[NSConditionLock lockWhenCondition:*", NULL },
+
+    { "mutex", "__psynch_mutexwait", NULL },
+    { "mutex", "__psynch_rw_*", NULL },
+    { "mutex", "pthread_mutex_lock", NULL },
+    { "mutex", "_pthread_mutex_firstfit_lock_slow", NULL },
+    { "mutex", "pthread_rwlock_*", NULL },
+    { "mutex", "os_unfair_lock_lock*", NULL },
+    { "mutex", "_os_unfair_lock_lock_slow", NULL },
+    { "mutex", "os_unfair_recursive_lock_lock*", NULL },
+    { "mutex", "objc_sync_enter", NULL },
+    { "mutex", "-[NSLock lock*", NULL },
+    { "mutex", "-[NSRecursiveLock lock*", NULL },
+    { "mutex", "_dispatch_once_wait", NULL },
+
+    { "semaphore", "dispatch_semaphore_wait", NULL },
+    { "semaphore", "_dispatch_semaphore_wait_slow", NULL },
+    { "semaphore", "dispatch_group_wait", NULL },
+    { "semaphore", "_dispatch_group_wait_slow", NULL },
+    { "semaphore", "dispatch_block_wait", NULL },
+    { "semaphore", "semaphore_wait_trap", NULL },
+    { "semaphore", "semaphore_timedwait_trap", NULL },
+
+    { "sleep", "__semwait_signal", NULL },
+    { "sleep", "nanosleep", NULL },
+    { "sleep", "usleep", NULL },
+    { "sleep", "sleep", NULL },
+    { "sleep", "mach_wait_until", NULL },
+    { "sleep", "+[NSThread sleepForTimeInterval:]", NULL },
+    { "sleep", "+[NSThread sleepUntilDate:]", NULL },
+
+    // Last: every other synchronous Mach message, e.g. to a system daemon.
+    { "ipc", "mach_msg", NULL },
+    { "ipc", "mach_msg_trap", NULL },
+    { "ipc", "mach_msg2_trap", NULL },
+    { "ipc", "mach_msg_overwrite", NULL },
+};
+
+const size_t BugSplatHangDefaultRuleCount = sizeof(BugSplatHangDefaultRules) / sizeof(BugSplatHangDefaultRules[0]);
+
+#pragma mark - Matching
+
+static bool BugSplatHangSymbolMatches(const char *pattern, const char *symbol)
+{
+    size_t length = strlen(pattern);
+    if (length > 0 && pattern[length - 1] == '*') {
+        return strncmp(pattern, symbol, length - 1) == 0;
+    }
+    return strcmp(pattern, symbol) == 0;
+}
+
+static bool BugSplatHangRuleMatches(const BugSplatHangRule *rule, const BugSplatHangFrame *frame)
+{
+    if (!frame->symbol || !rule->symbol || !BugSplatHangSymbolMatches(rule->symbol, frame->symbol)) {
+        return false;
+    }
+    return !rule->image || (frame->image && strcmp(rule->image, frame->image) == 0);
+}
+
+BugSplatHangClassification BugSplatHangClassify(const BugSplatHangFrame *frames, size_t frameCount,
+                                                const BugSplatHangRule *rules, size_t ruleCount)
+{
+    BugSplatHangClassification result = { BugSplatHangCategoryUnknown, BugSplatHangNoFrame, BugSplatHangNoFrame };
+    if (!frames) {
+        return result;
+    }
+
+    size_t limit = frameCount;
+    for (size_t i = 0; i < frameCount; i++) {
+        if (frames[i].isApp) {
+            result.appFrame = i;
+            limit = i;
+            break;
+        }
+    }
+
+    size_t best = ruleCount;
+    for (size_t i = 0; i < limit && best > 0; i++) {
+        for (size_t r = 0; r < best; r++) {
+            if (BugSplatHangRuleMatches(&rules[r], &frames[i])) {
+                best = r;
+                result.blockingFrame = i;
+                break;
+            }
+        }
+    }
+
+    if (best < ruleCount) {
+        result.category = rules[best].category;
+    } else if (result.appFrame == 0) {
+        result.category = BugSplatHangCategoryBusy;
+    }
+    return result;
+}
+
+#pragma mark - Parsing
+
+static const char *BugSplatHangSkipSpaces(const char *cursor)
+{
+    while (*cursor == ' ' || *cursor == '\t') {
+        cursor++;
+    }
+    return cursor;
+}
+
+bool BugSplatHangFrameParseLine(const char *line, const char *appImage, BugSplatHangFrame *frame,
+                                char *buffer, size_t bufferSize)
+{
+    memset(frame, 0, sizeof(*frame));
+    if (!line || !buffer || bufferSize == 0) {
+        return false;
+    }
+
+    // Frame number.
+    const char *cursor = BugSplatHangSkipSpaces(line);
+    if (!isdigit((unsigned char)*cursor)) {
+        return false;
+    }
+    while (isdigit((unsigned char)*cursor)) {
+        cursor++;
+    }
+    if (*cursor != ' ' && *cursor != '\t') {
+        return false;
+    }
+    cursor = BugSplatHangSkipSpaces(cursor);
+
+    // Image names may contain spaces, so the image runs up to the address.
+    const char *address = strstr(cursor, " 0x");
+    if (!address || address == cursor) {
+        return false;
+    }
+    const char *imageEnd = address;
+    while (imageEnd > cursor && (imageEnd[-1] == ' ' || imageEnd[-1] == '\t')) {
+        imageEnd--;
+    }
+
+    // Skip the address; what follows is the symbol, or `0x<base> + <offset>` when unsymbolicated.
+    const char *symbol = address + 3;
+    while (isxdigit((unsigned char)*symbol)) {
+        symbol++;
+    }
+    symbol = BugSplatHangSkipSpaces(symbol);
+    const char *symbolEnd = strstr(symbol, " + ");
+    if (!symbolEnd) {
+        symbolEnd = symbol + strcspn(symbol, "\r\n");
+    }
+    while (symbolEnd > symbol && (symbolEnd[-1] == ' ' || symbolEnd[-1] == '\t')) {
+        symbolEnd--;
+    }
+    bool symbolicated = symbolEnd > symbol && strncmp(symbol, "0x", 2) != 0;
+
+    size_t imageLength = (size_t)(imageEnd - cursor);
+    size_t symbolLength = symbolicated ? (size_t)(symbolEnd - symbol) : 0;
+    if (imageLength + 1 + symbolLength + 1 > bufferSize) {
+        return false;
+    }
+    memcpy(buffer, cursor, imageLength);
+    buffer[imageLength] = '\0';
+    frame->image = buffer;
+    if (symbolicated) {
+        char *symbolBuffer = buffer + imageLength + 1;
+        memcpy(symbolBuffer, symbol, symbolLength);
+        symbolBuffer[symbolLength] = '\0';
+        frame->symbol = symbolBuffer;
+    }
+    frame->isApp = appImage && strcmp(frame->image, appImage) == 0;
+    return true;
+}
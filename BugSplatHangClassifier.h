@@ -0,0 +1,95 @@
+//
+//  BugSplatHangClassifier.h
+//
+//  Classifies why a hung thread is blocked from its backtrace: the first
+//  frames above the app's own code are matched against a table of known
+//  blocking calls (locks, semaphores, synchronous dispatch, I/O, sqlite,
+//  synchronous IPC). Plain C over symbol names, so the rules can be tested
+//  on any platform against text reports.
+//
+//  Copyright © BugSplat, LLC. All rights reserved.
+//
+
+#ifndef BugSplatHangClassifier_h
+#define BugSplatHangClassifier_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// Index returned when there is no such frame.
+#define BugSplatHangNoFrame SIZE_MAX
+
+/// Category of a thread running the app's own code rather than waiting in a known call.
+#define BugSplatHangCategoryBusy "busy"
+
+/// Category of a thread blocked somewhere no rule recognises.
+#define BugSplatHangCategoryUnknown "unknown"
+
+/**
+ * One rule: a frame whose symbol (and image, if given) matches is blocked in `category`.
+ * `symbol` is an exact name, or a prefix when it ends in `*`. Earlier rules in a table win,
+ * so calls that say why a thread waits (sqlite3_step, dispatch_sync) come before the
+ * primitives they wait with (mutexes, semaphores, mach_msg).
+ */
+typedef struct {
+    const char *category;
+    const char *symbol;
+    /// Image basename, e.g. `libsqlite3.dylib`; NULL matches any image.
+    const char *image;
+} BugSplatHangRule;
+
+/// Built-in rules, in priority order.
+extern const BugSplatHangRule BugSplatHangDefaultRules[];
+extern const size_t BugSplatHangDefaultRuleCount;
+
+typedef struct {
+    /// Image basename; NULL if unknown.
+    const char *image;
+    /// Symbol name without the leading underscore; NULL for unsymbolicated frames.
+    const char *symbol;
+    /// Whether the frame is in the app's own code (its executable or bundled frameworks).
+    bool isApp;
+} BugSplatHangFrame;
+
+typedef struct {
+    /// A rule's category, `BugSplatHangCategoryBusy` or `BugSplatHangCategoryUnknown`.
+    const char *category;
+    /// Frame that matched the rule, or BugSplatHangNoFrame.
+    size_t blockingFrame;
+    /// Innermost app frame, or BugSplatHangNoFrame if the stack has none.
+    size_t appFrame;
+} BugSplatHangClassification;
+
+/**
+ * Classify a backtrace, innermost frame first. Only frames above the innermost app frame
+ * are matched, so a blocking call the app makes is attributed to the call site rather than
+ * to whatever the app's callers happen to wait on. Among those frames the highest-priority
+ * rule wins. A stack whose innermost frame is app code is `busy`.
+ */
+BugSplatHangClassification BugSplatHangClassify(const BugSplatHangFrame *frames, size_t frameCount,
+                                                const BugSplatHangRule *rules, size_t ruleCount);
+
+/**
+ * Parse one backtrace line of a text crash report:
+ *
+ *   3   libsqlite3.dylib      0x00000001a2b3c4d5 sqlite3_step + 1234
+ *
+ * The image and symbol are copied NUL-terminated into `buffer`, and `frame` points into it.
+ * Unsymbolicated lines (`0x... 0x1a2b3000 + 1234`) get a NULL symbol. `appImage` is the
+ * app executable's name; frames in it are marked `isApp`.
+ *
+ * @return false if `line` is not a backtrace line or does not fit `buffer`.
+ */
+bool BugSplatHangFrameParseLine(const char *line, const char *appImage, BugSplatHangFrame *frame,
+                                char *buffer, size_t bufferSize);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BugSplatHangClassifier_h */
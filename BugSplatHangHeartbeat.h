@@ -0,0 +1,38 @@
+//
+//  BugSplatHangHeartbeat.h
+//
+//  Feed heartbeat-based hang detection from a custom event loop (C, C++,
+//  Objective-C or Swift).
+//
+//  Copyright © BugSplat, LLC. All rights reserved.
+//
+
+#ifndef BugSplatHangHeartbeat_h
+#define BugSplatHangHeartbeat_h
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Record that the main thread's event loop made progress.
+ *
+ * Only needed with `hangDetectionMode` set to `BugSplatHangDetectionModeHeartbeat` when the
+ * main thread runs its own loop instead of returning to the run loop (e.g. a game loop that
+ * never yields): call it once per iteration. The main run loop is ticked automatically.
+ * Costs one monotonic clock read and one atomic store; does nothing when heartbeat
+ * detection is not running.
+ */
+void BugSplatHangHeartbeatTick(void);
+
+/**
+ * Record that the loop is about to block waiting for work, so time spent waiting is not
+ * counted as a hang. The next `BugSplatHangHeartbeatTick` ends the idle period.
+ */
+void BugSplatHangHeartbeatIdle(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BugSplatHangHeartbeat_h */
@@ -0,0 +1,108 @@
+//
+//  BugSplatHangReportSlot.h
+//
+//  Copyright © BugSplat, LLC. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// Default capacity of a hang report slot; live reports are typically well under this.
+extern const size_t kBugSplatHangReportSlotDefaultCapacity;
+
+/**
+ * A fixed-size, memory-mapped file reserved up front to hold one hang report.
+ *
+ * Reserving the slot (creating the file at full size, mapping it and faulting in its pages)
+ * happens when hang detection starts. Recording a hang is then a copy into the mapping plus
+ * a few header stores: no files are created, nothing is allocated and no Foundation objects
+ * are formatted. Because the mapping is shared, the record survives the process being killed
+ * (e.g. by the watchdog) without an explicit flush. Recovery just clears the header's valid
+ * flag.
+ *
+ * A slot holds the raw PLCrashReporter report, a pre-encoded metadata blob (the same binary
+ * encoding as crash-time customData), the hang profile, and the hang's duration, detection
+ * time, app state, launch id and cause (category and app frame, in fixed-size fields). On the
+ * next launch the record is converted into a regular queued report.
+ *
+ * Not thread-safe; callers serialise record / invalidate (BugSplat uses its hang queue).
+ */
+@interface BugSplatHangReportSlot : NSObject
+
+/**
+ * Open (creating if needed) a slot file of the given capacity and map it read-write.
+ * An existing valid record is left intact.
+ *
+ * @return nil if the file cannot be created, sized or mapped.
+ */
+- (nullable instancetype)initWithPath:(NSString *)path capacity:(size_t)capacity NS_DESIGNATED_INITIALIZER;
+- (instancetype)init NS_UNAVAILABLE;
+
+/// YES when the file at `path` holds a valid hang record. Reads only the header.
++ (BOOL)fileAtPathHasValidRecord:(NSString *)path;
+
+@property (nonatomic, copy, readonly) NSString *path;
+@property (nonatomic, assign, readonly) size_t capacity;
+
+/**
+ * Store the per-launch id written with every subsequent record. Call once after reserving.
+ */
+- (void)setLaunchId:(NSString *)launchId;
+
+/**
+ * Copy a hang record into the slot and mark it valid.
+ *
+ * @param appState A short ASCII state string; truncated to 15 bytes.
+ * @return NO if report plus metadata exceed the slot's capacity (the slot is left invalid).
+ */
+- (BOOL)recordReportBytes:(const void *)reportBytes
+             reportLength:(size_t)reportLength
+            metadataBytes:(nullable const void *)metadataBytes
+           metadataLength:(size_t)metadataLength
+               durationMs:(uint64_t)durationMs
+               detectedAt:(NSTimeInterval)detectedAt
+                 appState:(const char *)appState;
+
+/**
+ * Copy a hang record with its profile and cause into the slot and mark it valid. The cause
+ * strings are truncated to the header's fixed fields (31 and 127 bytes); either may be NULL.
+ *
+ * @return NO if report, metadata and profile exceed the slot's capacity (the slot is left invalid).
+ */
+- (BOOL)recordReportBytes:(const void *)reportBytes
+             reportLength:(size_t)reportLength
+            metadataBytes:(nullable const void *)metadataBytes
+           metadataLength:(size_t)metadataLength
+             profileBytes:(nullable const void *)profileBytes
+            profileLength:(size_t)profileLength
+            causeCategory:(nullable const char *)causeCategory
+                 appFrame:(nullable const char *)appFrame
+               durationMs:(uint64_t)durationMs
+               detectedAt:(NSTimeInterval)detectedAt
+                 appState:(const char *)appState;
+
+/// Mark the record invalid. A single store; the file stays reserved.
+- (void)invalidate;
+
+#pragma mark - Reading a record
+
+@property (nonatomic, readonly) BOOL hasValidRecord;
+/// Raw PLCrashReporter report of the valid record, or nil.
+@property (nonatomic, readonly, nullable) NSData *reportData;
+/// Metadata blob of the valid record, or nil if none was recorded.
+@property (nonatomic, readonly, nullable) NSData *metadataData;
+/// Hang profile of the valid record, or nil if none was recorded.
+@property (nonatomic, readonly, nullable) NSData *profileData;
+/// Cause category and innermost app frame of the record, or nil if not classified.
+@property (nonatomic, readonly, nullable) NSString *causeCategory;
+@property (nonatomic, readonly, nullable) NSString *appFrame;
+@property (nonatomic, readonly) uint64_t durationMs;
+/// Detection time, seconds since the reference date.
+@property (nonatomic, readonly) NSTimeInterval detectedAt;
+@property (nonatomic, readonly) NSString *appState;
+@property (nonatomic, readonly, nullable) NSString *launchId;
+
+@end
+
+NS_ASSUME_NONNULL_END
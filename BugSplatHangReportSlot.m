@@ -0,0 +1,280 @@
+//
+//  BugSplatHangReportSlot.m
+//
+//  Copyright © BugSplat, LLC. All rights reserved.
+//
+
+#import "BugSplatHangReportSlot.h"
+#import "BugSplatMappedFile.h"
+
+#import <fcntl.h>
+#import <stdatomic.h>
+#import <sys/stat.h>
+#import <unistd.h>
+
+const size_t kBugSplatHangReportSlotDefaultCapacity = 1024 * 1024;
+
+static const uint32_t kBugSplatHangSlotMagic = 0x53485342; // "BSHS", little-endian
+static const uint32_t kBugSplatHangSlotVersion = 2;
+static const uint32_t kBugSplatHangSlotStateInvalid = 0;
+static const uint32_t kBugSplatHangSlotStateValid = 1;
+
+/// On-disk header. The payload (metadata, then profile, then report) follows immediately.
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    _Atomic(uint32_t) state;
+    uint32_t reportLength;
+    uint32_t metadataLength;
+    uint32_t profileLength;
+    uint64_t durationMs;
+    double detectedAt;
+    char appState[16];
+    char launchId[40];
+    char causeCategory[32];
+    char appFrame[128];
+} BugSplatHangSlotHeader;
+
+/// Whether the lengths a header claims fit a slot of `capacity` bytes. They come from disk,
+/// so a file that was truncated, resized or corrupted must not send reads past the mapping.
+static BOOL BugSplatHangSlotRecordFits(const BugSplatHangSlotHeader *header, size_t capacity)
+{
+    if (capacity < sizeof(BugSplatHangSlotHeader)) {
+        return NO;
+    }
+    size_t payloadCapacity = capacity - sizeof(BugSplatHangSlotHeader);
+    return header->reportLength <= payloadCapacity
+        && header->metadataLength <= payloadCapacity - header->reportLength
+        && header->profileLength <= payloadCapacity - header->reportLength - header->metadataLength;
+}
+
+/// NUL-terminated copy of `string` (empty if NULL) into a fixed header field.
+static void BugSplatHangSlotCopyField(char *field, size_t fieldSize, const char *string)
+{
+    memset(field, 0, fieldSize);
+    if (string) {
+        strncpy(field, string, fieldSize - 1);
+    }
+}
+
+/// A fixed header field as a string, or nil if it is empty.
+static NSString *BugSplatHangSlotFieldString(const char *field, size_t fieldSize)
+{
+    size_t length = strnlen(field, fieldSize);
+    return length > 0 ? [[NSString alloc] initWithBytes:field length:length encoding:NSUTF8StringEncoding] : nil;
+}
+
+@implementation BugSplatHangReportSlot
+{
+    BugSplatMappedFile *_file;
+    uint8_t *_mapping;
+}
+
+- (instancetype)initWithPath:(NSString *)path capacity:(size_t)capacity
+{
+    if (self = [super init]) {
+        _path = [path copy];
+        _capacity = MAX(capacity, sizeof(BugSplatHangSlotHeader));
+
+        // Every block exists and every page is faulted in now rather than during the hang.
+        _file = [[BugSplatMappedFile alloc] initWithPath:path
+                                                    size:_capacity
+                                                 options:BugSplatMappedFileOptionsPrefault
+                                                    name:@"hang report slot"];
+        if (!_file) {
+            return nil;
+        }
+        _mapping = _file.bytes;
+
+        BugSplatHangSlotHeader *header = (BugSplatHangSlotHeader *)_mapping;
+        if (header->magic != kBugSplatHangSlotMagic || header->version != kBugSplatHangSlotVersion) {
+            memset(header, 0, sizeof(*header));
+            header->magic = kBugSplatHangSlotMagic;
+            header->version = kBugSplatHangSlotVersion;
+        }
+    }
+    return self;
+}
+
++ (BOOL)fileAtPathHasValidRecord:(NSString *)path
+{
+    int fd = open(path.fileSystemRepresentation, O_RDONLY);
+    if (fd < 0) {
+        return NO;
+    }
+    BugSplatHangSlotHeader header;
+    struct stat info;
+    BOOL valid = pread(fd, &header, sizeof(header), 0) == (ssize_t)sizeof(header)
+        && header.magic == kBugSplatHangSlotMagic
+        && header.version == kBugSplatHangSlotVersion
+        && atomic_load(&header.state) == kBugSplatHangSlotStateValid
+        && fstat(fd, &info) == 0
+        && BugSplatHangSlotRecordFits(&header, (size_t)info.st_size);
+    close(fd);
+    return valid;
+}
+
+- (BugSplatHangSlotHeader *)header
+{
+    return (BugSplatHangSlotHeader *)_mapping;
+}
+
+- (void)setLaunchId:(NSString *)launchId
+{
+    BugSplatHangSlotHeader *header = [self header];
+    memset(header->launchId, 0, sizeof(header->launchId));
+    [launchId getCString:header->launchId maxLength:sizeof(header->launchId) encoding:NSUTF8StringEncoding];
+}
+
+- (BOOL)recordReportBytes:(const void *)reportBytes
+             reportLength:(size_t)reportLength
+            metadataBytes:(const void *)metadataBytes
+           metadataLength:(size_t)metadataLength
+               durationMs:(uint64_t)durationMs
+               detectedAt:(NSTimeInterval)detectedAt
+                 appState:(const char *)appState
+{
+    return [self recordReportBytes:reportBytes
+                      reportLength:reportLength
+                     metadataBytes:metadataBytes
+                    metadataLength:metadataLength
+                      profileBytes:NULL
+                     profileLength:0
+                     causeCategory:NULL
+                          appFrame:NULL
+                        durationMs:durationMs
+                        detectedAt:detectedAt
+                          appState:appState];
+}
+
+- (BOOL)recordReportBytes:(const void *)reportBytes
+             reportLength:(size_t)reportLength
+            metadataBytes:(const void *)metadataBytes
+           metadataLength:(size_t)metadataLength
+             profileBytes:(const void *)profileBytes
+            profileLength:(size_t)profileLength
+            causeCategory:(const char *)causeCategory
+                 appFrame:(const char *)appFrame
+               durationMs:(uint64_t)durationMs
+               detectedAt:(NSTimeInterval)detectedAt
+                 appState:(const char *)appState
+{
+    BugSplatHangSlotHeader *header = [self header];
+
+    // Invalidate first so a kill mid-copy leaves no half-written record behind.
+    atomic_store(&header->state, kBugSplatHangSlotStateInvalid);
+
+    size_t payloadCapacity = _capacity - sizeof(BugSplatHangSlotHeader);
+    if (!metadataBytes) {
+        metadataLength = 0;
+    }
+    if (!profileBytes) {
+        profileLength = 0;
+    }
+    if (reportLength > payloadCapacity
+        || metadataLength > payloadCapacity - reportLength
+        || profileLength > payloadCapacity - reportLength - metadataLength) {
+        return NO;
+    }
+
+    uint8_t *payload = _mapping + sizeof(BugSplatHangSlotHeader);
+    if (metadataLength > 0) {
+        memcpy(payload, metadataBytes, metadataLength);
+    }
+    if (profileLength > 0) {
+        memcpy(payload + metadataLength, profileBytes, profileLength);
+    }
+    memcpy(payload + metadataLength + profileLength, reportBytes, reportLength);
+
+    header->metadataLength = (uint32_t)metadataLength;
+    header->profileLength = (uint32_t)profileLength;
+    header->reportLength = (uint32_t)reportLength;
+    header->durationMs = durationMs;
+    header->detectedAt = detectedAt;
+    BugSplatHangSlotCopyField(header->appState, sizeof(header->appState), appState ?: "unknown");
+    BugSplatHangSlotCopyField(header->causeCategory, sizeof(header->causeCategory), causeCategory);
+    BugSplatHangSlotCopyField(header->appFrame, sizeof(header->appFrame), appFrame);
+
+    // Release ordering publishes the payload before the flag.
+    atomic_store_explicit(&header->state, kBugSplatHangSlotStateValid, memory_order_release);
+    [_file syncAsynchronously];
+    return YES;
+}
+
+- (void)invalidate
+{
+    atomic_store(&[self header]->state, kBugSplatHangSlotStateInvalid);
+}
+
+#pragma mark - Reading a record
+
+- (BOOL)hasValidRecord
+{
+    BugSplatHangSlotHeader *header = [self header];
+    return atomic_load_explicit(&header->state, memory_order_acquire) == kBugSplatHangSlotStateValid
+        && BugSplatHangSlotRecordFits(header, _capacity);
+}
+
+- (NSData *)reportData
+{
+    if (!self.hasValidRecord) {
+        return nil;
+    }
+    BugSplatHangSlotHeader *header = [self header];
+    return [NSData dataWithBytes:_mapping + sizeof(BugSplatHangSlotHeader) + header->metadataLength + header->profileLength
+                          length:header->reportLength];
+}
+
+- (NSData *)metadataData
+{
+    if (!self.hasValidRecord || [self header]->metadataLength == 0) {
+        return nil;
+    }
+    return [NSData dataWithBytes:_mapping + sizeof(BugSplatHangSlotHeader) length:[self header]->metadataLength];
+}
+
+- (NSData *)profileData
+{
+    if (!self.hasValidRecord || [self header]->profileLength == 0) {
+        return nil;
+    }
+    BugSplatHangSlotHeader *header = [self header];
+    return [NSData dataWithBytes:_mapping + sizeof(BugSplatHangSlotHeader) + header->metadataLength
+                          length:header->profileLength];
+}
+
+- (NSString *)causeCategory
+{
+    BugSplatHangSlotHeader *header = [self header];
+    return BugSplatHangSlotFieldString(header->causeCategory, sizeof(header->causeCategory));
+}
+
+- (NSString *)appFrame
+{
+    BugSplatHangSlotHeader *header = [self header];
+    return BugSplatHangSlotFieldString(header->appFrame, sizeof(header->appFrame));
+}
+
+- (uint64_t)durationMs
+{
+    return [self header]->durationMs;
+}
+
+- (NSTimeInterval)detectedAt
+{
+    return [self header]->detectedAt;
+}
+
+- (NSString *)appState
+{
+    BugSplatHangSlotHeader *header = [self header];
+    return BugSplatHangSlotFieldString(header->appState, sizeof(header->appState)) ?: @"unknown";
+}
+
+- (NSString *)launchId
+{
+    BugSplatHangSlotHeader *header = [self header];
+    return BugSplatHangSlotFieldString(header->launchId, sizeof(header->launchId));
+}
+
+@end
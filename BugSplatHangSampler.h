@@ -0,0 +1,66 @@
+//
+//  BugSplatHangSampler.h
+//
+//  Copyright © BugSplat, LLC. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import <mach/mach.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * Copy the return addresses on `thread`'s stack, innermost first, by suspending it and
+ * walking its frame pointers. Does not allocate or take locks, so it is safe while the
+ * thread is hung holding one. Must not be called on `thread` itself.
+ *
+ * @return Number of addresses written to `frames` (0 if the thread could not be sampled).
+ */
+size_t BugSplatSampleThreadStack(thread_t thread, uint64_t *frames, size_t maxFrames);
+
+/**
+ * Samples one thread's stack at a fixed interval while a stall is in progress and merges
+ * the samples into a weighted call tree (see BugSplatCallTree.h).
+ *
+ * Storage for the tree is allocated up front, so sampling never allocates while the
+ * sampled thread is suspended. Samples are taken on a private serial queue; every method
+ * may be called from any thread.
+ */
+@interface BugSplatHangSampler : NSObject
+
+/**
+ * @param thread     Thread to sample (BugSplat passes the main thread's port).
+ * @param interval   Time between samples.
+ * @param maxSamples Sampling stops by itself after this many samples.
+ */
+- (instancetype)initWithThread:(thread_t)thread
+                      interval:(NSTimeInterval)interval
+                    maxSamples:(NSUInteger)maxSamples NS_DESIGNATED_INITIALIZER;
+- (instancetype)init NS_UNAVAILABLE;
+
+@property (nonatomic, readonly) NSTimeInterval interval;
+
+/// Discard any previous samples and start sampling. Ignored while already sampling.
+- (void)begin;
+
+/**
+ * Stop sampling and return the call tree as text, or nil if nothing was sampled since
+ * `-begin`. Frames are labelled `image+0xoffset` from the image list, without dladdr, so
+ * this can run while the sampled thread holds the dyld lock. A `Binary Images:` section
+ * with one `<uuid> <image>` line per image follows the tree; see `+symbolicatedProfile:`.
+ */
+- (nullable NSData *)finish;
+
+/**
+ * A profile from `-finish` with each frame's symbol appended (`image+0xoffset symbol`),
+ * for images loaded in this process with the same UUID. Frames in other images, e.g.
+ * from a build that has since been updated, are left as they are.
+ */
++ (NSData *)symbolicatedProfile:(NSData *)profile;
+
+/// Stop sampling and discard the samples.
+- (void)cancel;
+
+@end
+
+NS_ASSUME_NONNULL_END
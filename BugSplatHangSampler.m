@@ -0,0 +1,308 @@
+//
+//  BugSplatHangSampler.m
+//
+//  Copyright © BugSplat, LLC. All rights reserved.
+//
+
+#import "BugSplatHangSampler.h"
+#import "BugSplatCallTree.h"
+#import "BugSplatImageList.h"
+
+#import <dlfcn.h>
+#import <pthread.h>
+#import <stdatomic.h>
+#if __has_include(<ptrauth.h>)
+#import <ptrauth.h>
+#endif
+
+/// Enough distinct paths for a few hundred samples of deep, mostly shared stacks.
+static const size_t kBugSplatHangSamplerNodeCapacity = 8192;
+
+/// Frames deeper than this are not sampled; hang stacks rarely get close.
+static const size_t kBugSplatHangSamplerMaxFrames = 128;
+
+/// Output buffer for -finish; the tree is pruned to fit.
+static const size_t kBugSplatHangSamplerOutputCapacity = 64 * 1024;
+
+/// Distinct images listed after the tree; frames in further images are labelled by address.
+#define kBugSplatHangSamplerMaxImages 128
+
+static NSString *const kBugSplatHangSamplerImagesHeader = @"Binary Images:";
+
+#pragma mark - Stack walking
+
+static uint64_t BugSplatStripPointer(uint64_t address)
+{
+#if __has_feature(ptrauth_calls)
+    return (uint64_t)ptrauth_strip((void *)address, ptrauth_key_return_address);
+#else
+    return address;
+#endif
+}
+
+/// Read memory that may be unmapped without faulting.
+static bool BugSplatReadMemory(uint64_t address, void *buffer, size_t length)
+{
+    vm_size_t copied = 0;
+    return vm_read_overwrite(mach_task_self(), (vm_address_t)address, length, (vm_address_t)buffer, &copied) == KERN_SUCCESS
+        && copied == length;
+}
+
+size_t BugSplatSampleThreadStack(thread_t thread, uint64_t *frames, size_t maxFrames)
+{
+    if (thread == MACH_PORT_NULL || maxFrames == 0 || thread == pthread_mach_thread_np(pthread_self())) {
+        return 0;
+    }
+    if (thread_suspend(thread) != KERN_SUCCESS) {
+        return 0;
+    }
+
+    uint64_t pc = 0;
+    uint64_t fp = 0;
+#if defined(__arm64__)
+    arm_thread_state64_t state;
+    mach_msg_type_number_t stateCount = ARM_THREAD_STATE64_COUNT;
+    if (thread_get_state(thread, ARM_THREAD_STATE64, (thread_state_t)&state, &stateCount) == KERN_SUCCESS) {
+        pc = (uint64_t)arm_thread_state64_get_pc(state);
+        fp = (uint64_t)arm_thread_state64_get_fp(state);
+    }
+#elif defined(__x86_64__)
+    x86_thread_state64_t state;
+    mach_msg_type_number_t stateCount = x86_THREAD_STATE64_COUNT;
+    if (thread_get_state(thread, x86_THREAD_STATE64, (thread_state_t)&state, &stateCount) == KERN_SUCCESS) {
+        pc = state.__rip;
+        fp = state.__rbp;
+    }
+#endif
+
+    size_t count = 0;
+    if (pc != 0) {
+        frames[count++] = BugSplatStripPointer(pc);
+    }
+    // Each frame record is { previous frame pointer, return address }; stacks grow down,
+    // so a valid chain strictly increases.
+    while (fp != 0 && fp % sizeof(uint64_t) == 0 && count < maxFrames) {
+        uint64_t record[2];
+        if (!BugSplatReadMemory(fp, record, sizeof(record))) {
+            break;
+        }
+        uint64_t returnAddress = BugSplatStripPointer(record[1]);
+        if (returnAddress == 0) {
+            break;
+        }
+        frames[count++] = returnAddress;
+        if (record[0] <= fp) {
+            break;
+        }
+        fp = record[0];
+    }
+
+    thread_resume(thread);
+    return count;
+}
+
+#pragma mark - Labels
+
+/// Images the labels written so far refer to.
+typedef struct {
+    BugSplatImage images[kBugSplatHangSamplerMaxImages];
+    size_t count;
+} BugSplatProfileImages;
+
+/// Label a frame `image+0xoffset`, remembering its image for the `Binary Images:` section.
+static size_t BugSplatLabelAddress(uint64_t address, char *buffer, size_t capacity, void *context)
+{
+    BugSplatProfileImages *images = context;
+    BugSplatImage image;
+    int length = 0;
+    if (BugSplatImageListFindAddress(address, &image)) {
+        bool listed = false;
+        for (size_t i = 0; i < images->count && !listed; i++) {
+            listed = images->images[i].base == image.base;
+        }
+        if (!listed && images->count < kBugSplatHangSamplerMaxImages) {
+            images->images[images->count++] = image;
+            listed = true;
+        }
+        length = listed
+            ? snprintf(buffer, capacity, "%s+0x%llx", image.name, address - image.base)
+            : snprintf(buffer, capacity, "0x%llx", address);
+    } else {
+        length = snprintf(buffer, capacity, "0x%llx", address);
+    }
+    return length < 0 ? 0 : MIN((size_t)length, capacity - 1);
+}
+
+#pragma mark - BugSplatHangSampler
+
+@interface BugSplatHangSampler ()
+@property (nonatomic, strong) dispatch_queue_t queue;
+@property (nonatomic, strong, nullable) dispatch_source_t timer;
+@property (nonatomic, strong) NSMutableData *nodeStorage;
+@end
+
+@implementation BugSplatHangSampler
+{
+    thread_t _thread;
+    NSUInteger _maxSamples;
+    BugSplatCallTree _tree;
+    uint64_t _frames[kBugSplatHangSamplerMaxFrames];
+    BugSplatProfileImages _images;
+}
+
+- (instancetype)initWithThread:(thread_t)thread interval:(NSTimeInterval)interval maxSamples:(NSUInteger)maxSamples
+{
+    if (self = [super init]) {
+        _thread = thread;
+        _interval = interval;
+        _maxSamples = maxSamples;
+        BugSplatImageListInstall();
+        _queue = dispatch_queue_create("com.bugsplat.hang-sampler",
+                                       dispatch_queue_attr_make_with_qos_class(DISPATCH_QUEUE_SERIAL, QOS_CLASS_USER_INITIATED, 0));
+        _nodeStorage = [NSMutableData dataWithLength:kBugSplatHangSamplerNodeCapacity * sizeof(BugSplatCallTreeNode)];
+        BugSplatCallTreeInit(&_tree, _nodeStorage.mutableBytes, kBugSplatHangSamplerNodeCapacity);
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    if (_timer) {
+        dispatch_source_cancel(_timer);
+    }
+}
+
+- (void)begin
+{
+    dispatch_async(self.queue, ^{
+        if (self.timer) {
+            return;
+        }
+        BugSplatCallTreeReset(&self->_tree);
+        dispatch_source_t timer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, self.queue);
+        uint64_t interval = (uint64_t)(self.interval * NSEC_PER_SEC);
+        dispatch_source_set_timer(timer, dispatch_time(DISPATCH_TIME_NOW, 0), interval, interval / 10);
+        __weak __typeof(self) weakSelf = self;
+        dispatch_source_set_event_handler(timer, ^{
+            [weakSelf takeSample];
+        });
+        self.timer = timer;
+        dispatch_resume(timer);
+    });
+}
+
+/// Runs on the sampler queue.
+- (void)takeSample
+{
+    size_t count = BugSplatSampleThreadStack(_thread, _frames, kBugSplatHangSamplerMaxFrames);
+    if (count > 0) {
+        BugSplatCallTreeAddSample(&_tree, _frames, count);
+    }
+    if (_tree.samples >= _maxSamples) {
+        [self stopTimer];
+    }
+}
+
+/// Runs on the sampler queue.
+- (void)stopTimer
+{
+    if (self.timer) {
+        dispatch_source_cancel(self.timer);
+        self.timer = nil;
+    }
+}
+
+- (NSData *)finish
+{
+    __block NSData *result = nil;
+    dispatch_sync(self.queue, ^{
+        [self stopTimer];
+        if (self->_tree.samples == 0) {
+            return;
+        }
+        NSMutableData *output = [NSMutableData dataWithLength:kBugSplatHangSamplerOutputCapacity];
+        // Keep paths seen in at least 1% of samples so a long hang still fits the output.
+        uint32_t minWeight = MAX(1u, self->_tree.samples / 100);
+        self->_images.count = 0;
+        size_t length = BugSplatCallTreeWrite(&self->_tree, minWeight, BugSplatLabelAddress, &self->_images,
+                                              output.mutableBytes, output.length);
+        output.length = length;
+        BugSplatCallTreeReset(&self->_tree);
+
+        NSMutableString *images = [NSMutableString stringWithFormat:@"%@\n", kBugSplatHangSamplerImagesHeader];
+        for (size_t i = 0; i < self->_images.count; i++) {
+            const BugSplatImage *image = &self->_images.images[i];
+            if (image->hasUUID) {
+                char uuid[BugSplatImageUUIDStringLength];
+                BugSplatImageFormatUUID(image->uuid, uuid);
+                [images appendFormat:@"%s %s\n", uuid, image->name];
+            }
+        }
+        [output appendData:[images dataUsingEncoding:NSUTF8StringEncoding]];
+        result = output;
+    });
+    return result;
+}
+
++ (NSData *)symbolicatedProfile:(NSData *)profile
+{
+    NSString *text = [[NSString alloc] initWithData:profile encoding:NSUTF8StringEncoding];
+    NSArray<NSString *> *lines = [text componentsSeparatedByString:@"\n"];
+    NSUInteger imagesHeader = [lines indexOfObject:kBugSplatHangSamplerImagesHeader];
+    if (imagesHeader == NSNotFound) {
+        return profile;
+    }
+
+    // Loaded images by the name the profile uses, for those whose UUID still matches
+    NSMutableDictionary<NSString *, NSNumber *> *images = [NSMutableDictionary dictionary];
+    for (NSUInteger i = imagesHeader + 1; i < lines.count; i++) {
+        NSRange separator = [lines[i] rangeOfString:@" "];
+        uint8_t uuid[16];
+        BugSplatImage image;
+        if (separator.location != NSNotFound
+            && BugSplatImageParseUUID([lines[i] substringToIndex:separator.location].UTF8String, uuid)
+            && BugSplatImageListFindUUID(uuid, &image)) {
+            images[[lines[i] substringFromIndex:NSMaxRange(separator)]] = @(image.base);
+        }
+    }
+
+    NSMutableArray<NSString *> *symbolicated = [lines mutableCopy];
+    for (NSUInteger i = 1; i < imagesHeader; i++) {
+        // <depth> <weight> <selfWeight> <image>+0x<offset>
+        NSString *line = lines[i];
+        NSRange offsetMarker = [line rangeOfString:@"+0x" options:NSBackwardsSearch];
+        NSRange labelStart = NSMakeRange(0, 0);
+        for (int field = 0; field < 3 && labelStart.location != NSNotFound; field++) {
+            labelStart = [line rangeOfString:@" " options:0 range:NSMakeRange(NSMaxRange(labelStart), line.length - NSMaxRange(labelStart))];
+        }
+        if (offsetMarker.location == NSNotFound || labelStart.location == NSNotFound
+            || offsetMarker.location < NSMaxRange(labelStart)) {
+            continue;
+        }
+        NSString *offsetText = [line substringFromIndex:NSMaxRange(offsetMarker)];
+        if ([offsetText rangeOfString:@" "].location != NSNotFound) {
+            continue; // Already has a symbol
+        }
+        NSString *name = [line substringWithRange:NSMakeRange(NSMaxRange(labelStart), offsetMarker.location - NSMaxRange(labelStart))];
+        NSNumber *base = images[name];
+        if (!base) {
+            continue;
+        }
+        uint64_t address = base.unsignedLongLongValue + strtoull(offsetText.UTF8String, NULL, 16);
+        Dl_info info;
+        if (dladdr((const void *)(uintptr_t)address, &info) && info.dli_sname) {
+            symbolicated[i] = [NSString stringWithFormat:@"%@ %s", line, info.dli_sname];
+        }
+    }
+    return [[symbolicated componentsJoinedByString:@"\n"] dataUsingEncoding:NSUTF8StringEncoding] ?: profile;
+}
+
+- (void)cancel
+{
+    dispatch_async(self.queue, ^{
+        [self stopTimer];
+        BugSplatCallTreeReset(&self->_tree);
+    });
+}
+
+@end
@@ -0,0 +1,50 @@
+//
+//  BugSplatHangSnapshot.h
+//
+//  Copyright © BugSplat, LLC. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import <mach/mach.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * Cheap first-tier hang capture: one thread's backtrace, taken into a buffer allocated up
+ * front, and formatted as a small report in the same text format as a full crash report
+ * (header, exception, the one thread, and the binary images its frames fall in).
+ *
+ * A full live report suspends and walks every thread and records every loaded image; this
+ * suspends one thread for a frame-pointer walk and writes a few kilobytes. Frames are resolved
+ * through BugSplatImageList, never dladdr, so neither step waits on a thread hung holding the
+ * dyld lock; only exported symbols of system libraries are named. Capture and formatting run
+ * on the caller's thread; not thread-safe.
+ */
+@interface BugSplatHangSnapshot : NSObject
+
+/// @param maxFrames Deepest backtrace kept; the buffer is allocated here.
+- (instancetype)initWithMaxFrames:(NSUInteger)maxFrames NS_DESIGNATED_INITIALIZER;
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ * Replace the buffer contents with `thread`'s current backtrace. Does not allocate.
+ *
+ * @return NO if the thread could not be sampled.
+ */
+- (BOOL)captureThread:(thread_t)thread;
+
+/// Number of frames captured by the last `-captureThread:`.
+@property (nonatomic, readonly) NSUInteger frameCount;
+
+/// Captured return addresses, innermost first; valid up to `frameCount`.
+@property (nonatomic, readonly) const uint64_t *frames NS_RETURNS_INNER_POINTER;
+
+/**
+ * Report text for the captured backtrace, marked as the crashed thread of an uncaught
+ * `exceptionName` exception so it groups with full reports of the same hang.
+ */
+- (NSData *)reportTextWithExceptionName:(NSString *)exceptionName reason:(NSString *)reason;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,172 @@
+//
+//  BugSplatHangSnapshot.m
+//
+//  Copyright © BugSplat, LLC. All rights reserved.
+//
+
+#import "BugSplatHangSnapshot.h"
+#import "BugSplatHangSampler.h"
+#import "BugSplatImageList.h"
+
+#import <inttypes.h>
+#import <sys/sysctl.h>
+#import <TargetConditionals.h>
+
+/// Most distinct images one snapshot lists; frames in further images print without one.
+static const NSUInteger kBugSplatSnapshotMaxImages = 64;
+
+@implementation BugSplatHangSnapshot
+{
+    uint64_t *_frames;
+    NSUInteger _maxFrames;
+    BugSplatImage _images[kBugSplatSnapshotMaxImages];
+    NSUInteger _imageCount;
+}
+
+- (instancetype)initWithMaxFrames:(NSUInteger)maxFrames
+{
+    if (self = [super init]) {
+        _maxFrames = MAX(maxFrames, 1u);
+        _frames = calloc(_maxFrames, sizeof(uint64_t));
+        BugSplatImageListInstall();
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    free(_frames);
+}
+
+- (const uint64_t *)frames
+{
+    return _frames;
+}
+
+- (BOOL)captureThread:(thread_t)thread
+{
+    _frameCount = BugSplatSampleThreadStack(thread, _frames, _maxFrames);
+    return _frameCount > 0;
+}
+
+#pragma mark - Report text
+
+- (NSData *)reportTextWithExceptionName:(NSString *)exceptionName reason:(NSString *)reason
+{
+    NSMutableString *text = [NSMutableString stringWithCapacity:4096];
+    [self appendHeaderToText:text];
+
+    // Live reports carry SIGTRAP; matching it keeps both tiers in the same crash group.
+    [text appendString:@"Exception Type:  SIGTRAP\n"];
+    [text appendString:@"Exception Codes: #0 at 0x0\n"];
+    [text appendString:@"Crashed Thread:  0\n\n"];
+    [text appendString:@"Application Specific Information:\n"];
+    [text appendFormat:@"*** Terminating app due to uncaught exception '%@', reason: '%@'\n\n", exceptionName, reason];
+
+    _imageCount = 0;
+    [text appendString:@"Thread 0 Crashed:\n"];
+    for (NSUInteger i = 0; i < _frameCount; i++) {
+        [self appendFrame:_frames[i] index:i toText:text];
+    }
+    [text appendString:@"\n"];
+
+    [text appendString:@"Binary Images:\n"];
+    qsort_b(_images, _imageCount, sizeof(BugSplatImage), ^int(const void *a, const void *b) {
+        uint64_t left = ((const BugSplatImage *)a)->base;
+        uint64_t right = ((const BugSplatImage *)b)->base;
+        return left < right ? -1 : left > right;
+    });
+    NSString *executablePath = [NSBundle mainBundle].executablePath;
+    for (NSUInteger i = 0; i < _imageCount; i++) {
+        const BugSplatImage *image = &_images[i];
+        char uuid[BugSplatImageUUIDStringLength] = "???";
+        if (image->hasUUID) {
+            BugSplatImageFormatUUID(image->uuid, uuid);
+        }
+        NSString *path = @(image->path);
+        uint64_t endAddress = image->base + (MAX(1, image->textSize) - 1);
+        [text appendFormat:@"%18#" PRIx64 " - %18#" PRIx64 " %@%s %s  <%s> %@\n",
+         image->base, endAddress, [path isEqual:executablePath] ? @"+" : @" ",
+         image->name, BugSplatImageArchitectureName(image), uuid, path];
+    }
+    return [text dataUsingEncoding:NSUTF8StringEncoding];
+}
+
+- (void)appendHeaderToText:(NSMutableString *)text
+{
+    NSProcessInfo *processInfo = [NSProcessInfo processInfo];
+    NSBundle *bundle = [NSBundle mainBundle];
+    NSString *version = [bundle objectForInfoDictionaryKey:@"CFBundleVersion"] ?: @"???";
+    NSString *marketingVersion = [bundle objectForInfoDictionaryKey:@"CFBundleShortVersionString"];
+    if (marketingVersion) {
+        version = [NSString stringWithFormat:@"%@ (%@)", marketingVersion, version];
+    }
+#if TARGET_OS_OSX || TARGET_OS_SIMULATOR
+    NSString *osName = @"Mac OS X";
+#elif TARGET_OS_TV
+    NSString *osName = @"Apple tvOS";
+#else
+    NSString *osName = @"iPhone OS";
+#endif
+    char osBuild[32] = "???";
+    size_t osBuildLength = sizeof(osBuild);
+    sysctlbyname("kern.osversion", osBuild, &osBuildLength, NULL, 0);
+    NSOperatingSystemVersion osVersion = processInfo.operatingSystemVersion;
+#if defined(__arm64__)
+    NSString *codeType = @"ARM-64";
+#else
+    NSString *codeType = @"X86-64";
+#endif
+
+    NSDateFormatter *rfc3339Formatter = [[NSDateFormatter alloc] init];
+    rfc3339Formatter.locale = [[NSLocale alloc] initWithLocaleIdentifier:@"en_US_POSIX"];
+    rfc3339Formatter.dateFormat = @"yyyy'-'MM'-'dd' 'HH':'mm':'ss'.'SSS ZZZ";
+    rfc3339Formatter.timeZone = [NSTimeZone timeZoneForSecondsFromGMT:0];
+
+    [text appendFormat:@"Incident Identifier: %@\n", [NSUUID UUID].UUIDString];
+    [text appendString:@"CrashReporter Key:   TODO\n"];
+    [text appendString:@"Hardware Model:      ???\n"];
+    [text appendFormat:@"Process:         %@ [%d]\n", processInfo.processName, processInfo.processIdentifier];
+    [text appendFormat:@"Path:            %@\n", bundle.executablePath ?: @"???"];
+    [text appendFormat:@"Identifier:      %@\n", bundle.bundleIdentifier ?: @"???"];
+    [text appendFormat:@"Version:         %@\n", version];
+    [text appendFormat:@"Code Type:       %@\n", codeType];
+    [text appendString:@"Parent Process:  ??? [???]\n\n"];
+    [text appendFormat:@"Date/Time:       %@\n", [rfc3339Formatter stringFromDate:[NSDate date]]];
+    [text appendFormat:@"OS Version:      %@ %ld.%ld.%ld (%s)\n", osName, (long)osVersion.majorVersion,
+     (long)osVersion.minorVersion, (long)osVersion.patchVersion, osBuild];
+    [text appendString:@"Report Version:  104\n\n"];
+}
+
+/// One frame line in the full report's layout; adds the frame's image to the list once.
+/// Resolved from the image list rather than dladdr, which would wait for a thread hung
+/// holding the dyld lock.
+- (void)appendFrame:(uint64_t)address index:(NSUInteger)index toText:(NSMutableString *)text
+{
+    BugSplatImage image;
+    if (!BugSplatImageListFindAddress(address, &image)) {
+        [text appendFormat:@"%-4lu%-35s 0x%016" PRIx64 " 0x%" PRIx64 "\n", (unsigned long)index, "???", address, address];
+        return;
+    }
+
+    BOOL listed = NO;
+    for (NSUInteger i = 0; i < _imageCount && !listed; i++) {
+        listed = _images[i].base == image.base;
+    }
+    if (!listed && _imageCount < kBugSplatSnapshotMaxImages) {
+        _images[_imageCount++] = image;
+    }
+
+    uint64_t symbolAddress = 0;
+    const char *symbolName = BugSplatImageFindSymbol(&image, address, &symbolAddress);
+    NSString *symbol = symbolName
+        ? [NSString stringWithFormat:@"%s + %" PRIu64, symbolName, address - symbolAddress]
+        : [NSString stringWithFormat:@"0x%" PRIx64 " + %" PRIu64, image.base, address - image.base];
+    NSString *imageName = @(image.name);
+    if (imageName.length > 35) {
+        imageName = [[imageName substringToIndex:31] stringByAppendingString:@"... "];
+    }
+    [text appendFormat:@"%-4lu%-35s 0x%016" PRIx64 " %@\n", (unsigned long)index, imageName.UTF8String, address, symbol];
+}
+
+@end
@@ -6,6 +6,8 @@
 
 #import <Foundation/Foundation.h>
 
+#import "BugSplatLatencyHistogram.h"
+
 NS_ASSUME_NONNULL_BEGIN
 
 @class BugSplatHangTracker;
@@ -40,19 +42,46 @@ didDetectHangWithDuration:(NSTimeInterval)duration
  */
 - (void)hangTrackerDidRecoverFromHang:(BugSplatHangTracker *)tracker;
 
+@optional
+
+/**
+ * Called on the watchdog thread, once per stall, when the main thread has been unresponsive
+ * for `stallThresholdSeconds` - early enough to start collecting evidence before a hang
+ * is declared.
+ */
+- (void)hangTracker:(BugSplatHangTracker *)tracker didDetectStallWithDuration:(NSTimeInterval)duration;
+
+/**
+ * Called when a stall reported through `hangTracker:didDetectStallWithDuration:` ended before
+ * it became a hang. Stalls that became hangs end with `hangTrackerDidRecoverFromHang:` instead.
+ * Dispatched like the recovery callback.
+ */
+- (void)hangTrackerDidEndStall:(BugSplatHangTracker *)tracker;
+
 @end
 
 
 /**
  * Monitors the main thread for hangs.
  *
- * A dedicated low-QoS watchdog thread polls every `threshold / 5` seconds (clamped to
- * at least 100ms). Each poll dispatches a small "ping" block to the main queue and
- * increments an atomic counter; the ping block, when serviced, resets that counter.
- * If the counter accumulates enough unanswered pings to cover `thresholdSeconds`, the
- * main thread is considered hung and the delegate is notified. When the main thread
- * later services a ping, a recovery callback fires so the integrator can discard a
- * previously persisted hang report.
+ * A dedicated low-QoS watchdog thread polls the main thread. Each poll dispatches a small
+ * "ping" block to the main queue (unless one is still queued) and adds the time it slept
+ * to an atomic counter while the ping is unanswered; the ping block, when serviced, resets
+ * that counter. If the counter covers `thresholdSeconds`, the main thread is considered
+ * hung and the delegate is notified. When the main thread later services a ping, a recovery
+ * callback fires so the integrator can discard a previously persisted hang report.
+ *
+ * Polls start at `threshold / 5` (clamped to at least 100ms). With `adaptivePolling` the
+ * interval doubles while pings come back quickly, up to half the threshold, and drops back
+ * as soon as one is slow or still queued; while the app is inactive the thread parks until
+ * `-wake`. Polls are run-loop timers with a tolerance so the system can coalesce them.
+ *
+ * With `usesHeartbeat` set, no pings are sent. The main run loop instead records a
+ * monotonic heartbeat timestamp (through a run-loop observer, or `-tick` / `-markIdle`
+ * from a custom event loop) and the watchdog only reads it: a hang is declared when the
+ * heartbeat is older than `thresholdSeconds` while the loop is not idle, and the reported
+ * duration is the exact age of the heartbeat. The watchdog sleeps until the earliest time
+ * the current stall could reach the threshold (or a full threshold while idle).
  *
  * Callers are expected to invoke `-start` from the main thread.
  */
@@ -81,7 +110,8 @@ didDetectHangWithDuration:(NSTimeInterval)duration
 
 /**
  * Start monitoring. Spawns the watchdog thread, which will begin pinging the main
- * queue on its poll interval. Must be called from the main thread.
+ * queue on its poll interval (or reading the heartbeat when `usesHeartbeat` is set).
+ * Must be called from the main thread.
  */
 - (void)start;
 
@@ -96,6 +126,69 @@ didDetectHangWithDuration:(NSTimeInterval)duration
 /// Configured threshold in seconds (clamped to >= 0.1).
 @property (nonatomic, readonly) NSTimeInterval thresholdSeconds;
 
+/**
+ * Detect hangs from a heartbeat timestamp instead of pinging the main queue. When started,
+ * the tracker installs a main run-loop observer that ticks on every loop iteration and marks
+ * the loop idle before it waits, and routes `BugSplatHangHeartbeatTick` /
+ * `BugSplatHangHeartbeatIdle` to itself. Must be set before `-start`. Default: NO
+ */
+@property (nonatomic, assign) BOOL usesHeartbeat;
+
+/**
+ * Report stalls longer than this, below `thresholdSeconds`, through the optional delegate
+ * stall callbacks. 0 disables them. Must be set before `-start`. Default: 0
+ */
+@property (nonatomic, assign) NSTimeInterval stallThresholdSeconds;
+
+/**
+ * Histogram that receives main-thread latencies, in microseconds: the round trip of every
+ * ping, or in heartbeat mode the length of every run-loop stretch between waits (how long an
+ * incoming event could have waited). Not retained; must outlive the tracker. Must be set
+ * before `-start`. Default: NULL
+ */
+@property (nonatomic, assign, nullable) BugSplatLatencyHistogram *latencyHistogram;
+
+/**
+ * Back off polling while the main thread answers pings quickly and park while the app is
+ * inactive (ping mode only). Set to NO for a fixed `threshold / 5` interval. Must be set
+ * before `-start`. Default: YES
+ */
+@property (nonatomic, assign) BOOL adaptivePolling;
+
+/**
+ * Work run on the watchdog thread after a poll (or heartbeat check) once at least
+ * `periodicWorkInterval` has passed since it last ran, e.g. resource sampling. It shares the
+ * watchdog's wakeups and never adds one, so it runs on the first poll and then at the next
+ * poll due, less often while polling is backed off or parked. Must be set before `-start`.
+ * Default: nil
+ */
+@property (nonatomic, copy, nullable) void (^periodicWork)(void);
+
+/// Minimum time between runs of `periodicWork`, in seconds. Must be set before `-start`. Default: 5
+@property (nonatomic, assign) NSTimeInterval periodicWorkInterval;
+
+/**
+ * Called on the main thread, once, when the first ping after `-start` is answered: the first
+ * main-queue block serviced after the tracker started. Ping mode only; in heartbeat mode it
+ * is never called. Must be set before `-start`. Default: nil
+ */
+@property (nonatomic, copy, nullable) void (^firstPongHandler)(void);
+
+/// Number of times the watchdog thread has woken up to poll (or read the heartbeat) since `-start`.
+@property (nonatomic, readonly) uint64_t pollCount;
+
+/**
+ * Resume polling if the watchdog is parked because the app was inactive. Call when the app
+ * becomes active; safe from any thread. Without it a parked watchdog rechecks once a minute.
+ */
+- (void)wake;
+
+/// Record that the monitored loop made progress. Lock-free; one clock read and one store.
+- (void)tick;
+
+/// Record that the monitored loop is about to block waiting for work (not a hang).
+- (void)markIdle;
+
 @end
 
 NS_ASSUME_NONNULL_END
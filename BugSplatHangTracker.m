@@ -5,26 +5,63 @@
 //
 
 #import "BugSplatHangTracker.h"
+#import "BugSplatHangHeartbeat.h"
 
 #import <math.h>
 #import <stdatomic.h>
+#import <time.h>
 
 static const NSTimeInterval kMinThresholdSeconds = 0.1;
 static const NSTimeInterval kMinPollIntervalSeconds = 0.1;
 
-/// Poll interval is threshold / 5, clamped to a reasonable floor.
+/// Base poll interval is threshold / 5, clamped to a reasonable floor.
 static inline NSTimeInterval BugSplatHangPollInterval(NSTimeInterval threshold) {
     NSTimeInterval interval = threshold / 5.0;
     return interval < kMinPollIntervalSeconds ? kMinPollIntervalSeconds : interval;
 }
 
-/// Maximum number of consecutive unanswered pings before declaring a hang.
-/// `ceil(threshold / pollInterval)` ensures the elapsed time covered by the
-/// unanswered pings is at least `threshold`.
-static inline NSInteger BugSplatHangMaxUnansweredPings(NSTimeInterval threshold) {
-    NSTimeInterval pollInterval = BugSplatHangPollInterval(threshold);
-    NSInteger n = (NSInteger)ceil(threshold / pollInterval);
-    return n < 1 ? 1 : n;
+/// Adaptive polling backs off to at most this fraction of the threshold (or stall threshold).
+static const double kBugSplatHangMaxPollFraction = 0.5;
+
+/// A ping answered within this fraction of the base interval lets polling back off.
+static const double kBugSplatHangQuickPongFraction = 0.25;
+
+/// Timer tolerance as a fraction of the interval, so the system can coalesce wakeups.
+static const double kBugSplatHangPollTolerance = 0.1;
+
+/// How often a parked watchdog rechecks the app state if nobody calls -wake.
+static const NSTimeInterval kBugSplatHangParkedRecheckSeconds = 60.0;
+
+/// Returned by -_nextPollIntervalAfter: when the watchdog should park.
+static const NSTimeInterval kBugSplatHangPollParked = -1.0;
+
+/// Shortest heartbeat-mode sleep, so a stall just short of the threshold doesn't spin.
+static const NSTimeInterval kMinHeartbeatSleepSeconds = 0.01;
+
+/// Heartbeat value recorded while the monitored loop waits for work.
+static const uint64_t kBugSplatHeartbeatIdle = 0;
+
+/// Monotonic time for heartbeats. Excludes time the device spends asleep, so a stall that
+/// spans system sleep is measured by the time the app could actually have run.
+static inline uint64_t BugSplatHeartbeatNow(void) {
+    return clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+}
+
+/// Heartbeat word of the started heartbeat-mode tracker, fed by the C functions.
+static _Atomic(_Atomic(uint64_t) *) sBugSplatActiveHeartbeat = NULL;
+
+void BugSplatHangHeartbeatTick(void) {
+    _Atomic(uint64_t) *heartbeat = atomic_load_explicit(&sBugSplatActiveHeartbeat, memory_order_acquire);
+    if (heartbeat) {
+        atomic_store_explicit(heartbeat, BugSplatHeartbeatNow(), memory_order_relaxed);
+    }
+}
+
+void BugSplatHangHeartbeatIdle(void) {
+    _Atomic(uint64_t) *heartbeat = atomic_load_explicit(&sBugSplatActiveHeartbeat, memory_order_acquire);
+    if (heartbeat) {
+        atomic_store_explicit(heartbeat, kBugSplatHeartbeatIdle, memory_order_relaxed);
+    }
 }
 
 
@@ -36,17 +73,16 @@ static inline NSInteger BugSplatHangMaxUnansweredPings(NSTimeInterval threshold)
 @property (nonatomic, copy) CFAbsoluteTime(^clockBlock)(void);
 @property (nonatomic, copy) void(^recoveryDispatcher)(dispatch_block_t);
 @property (nonatomic, copy) void(^pingDispatcher)(dispatch_block_t);
-@property (nonatomic, strong, nullable) NSThread *watchdogThread;
+@property (atomic, strong, nullable) NSThread *watchdogThread;
 @end
 
 
 @implementation BugSplatHangTracker {
-    // Number of consecutive watchdog polls during which the main thread has
-    // not serviced a dispatched ping. Each poll increments this; the ping
-    // block, when serviced on the main queue, resets it to 0. If the counter
-    // reaches the threshold-derived limit, the main thread has been blocked
-    // for at least `thresholdSeconds`.
-    _Atomic(int32_t) _unansweredPings;
+    // Watchdog sleep time, in nanoseconds, during which the main thread has
+    // not serviced a dispatched ping. Each poll that finds the ping still queued
+    // adds the time it slept; the ping block, when serviced on the main queue,
+    // resets it to 0. Once it covers `thresholdSeconds` the main thread is hung.
+    _Atomic(uint64_t) _unansweredNanoseconds;
 
     // YES while a ping block is queued on the main queue but has not yet run.
     // Gates dispatch so that during a long hang we don't accumulate an
@@ -54,9 +90,41 @@ static inline NSInteger BugSplatHangMaxUnansweredPings(NSTimeInterval threshold)
     // sufficient to detect responsiveness either way.
     _Atomic(bool) _pingOutstanding;
 
+    // Heartbeat clock time the outstanding ping was dispatched, for its round-trip latency.
+    _Atomic(uint64_t) _pingSentAt;
+
+    // Round trip of the most recently answered ping, in nanoseconds; drives adaptive polling.
+    _Atomic(uint64_t) _lastPongLatency;
+
+    // Ping mode: poll timer and the run loop of the watchdog thread it fires on, set while
+    // that thread runs (guarded by @synchronized(self)), and whether the timer is parked.
+    CFRunLoopTimerRef _pollTimer;
+    CFRunLoopRef _watchdogRunLoop;
+    _Atomic(bool) _parked;
+    _Atomic(uint64_t) _pollCount;
+
     // Set to YES once a hang has been reported for the current window;
     // cleared by the next pong (which also triggers a recovery callback).
     _Atomic(bool) _hangReportedForCurrentWindow;
+
+    // Set once the current window passed `stallThresholdSeconds` and the delegate was told;
+    // cleared when the window ends, with a stall-end callback unless it became a hang.
+    _Atomic(bool) _stallReportedForCurrentWindow;
+
+    // Heartbeat mode: monotonic time the monitored loop last made progress,
+    // or kBugSplatHeartbeatIdle while it waits for work. Written by the loop,
+    // only read by the watchdog (apart from the suspension rebase).
+    _Atomic(uint64_t) _heartbeat;
+
+    // Heartbeat mode, watchdog thread only: the heartbeat value a reported stall or
+    // hang was measured from. Any other value means the loop moved on (recovery).
+    uint64_t _reportedHeartbeat;
+
+    // Heartbeat mode: main run-loop observer that ticks the heartbeat.
+    CFRunLoopObserverRef _runLoopObserver;
+
+    // Watchdog thread only: clock time `periodicWork` last ran, -INFINITY before it first runs.
+    CFAbsoluteTime _lastPeriodicWork;
 }
 
 - (instancetype)initWithThresholdSeconds:(NSTimeInterval)thresholdSeconds
@@ -87,7 +155,9 @@ static inline NSInteger BugSplatHangMaxUnansweredPings(NSTimeInterval threshold)
         if (clockBlock) {
             _clockBlock = [clockBlock copy];
         } else {
-            _clockBlock = ^CFAbsoluteTime{ return CFAbsoluteTimeGetCurrent(); };
+            // Monotonic (unaffected by wall-clock changes) but still counting device sleep,
+            // which is what the suspension guard needs to see.
+            _clockBlock = ^CFAbsoluteTime{ return (CFAbsoluteTime)clock_gettime_nsec_np(CLOCK_MONOTONIC_RAW) / NSEC_PER_SEC; };
         }
         if (recoveryDispatcher) {
             _recoveryDispatcher = [recoveryDispatcher copy];
@@ -103,9 +173,17 @@ static inline NSInteger BugSplatHangMaxUnansweredPings(NSTimeInterval threshold)
                 dispatch_async(dispatch_get_main_queue(), b);
             };
         }
-        atomic_init(&_unansweredPings, 0);
+        _adaptivePolling = YES;
+        _periodicWorkInterval = 5.0;
+        atomic_init(&_unansweredNanoseconds, 0);
         atomic_init(&_pingOutstanding, false);
+        atomic_init(&_pingSentAt, 0);
+        atomic_init(&_lastPongLatency, 0);
+        atomic_init(&_parked, false);
+        atomic_init(&_pollCount, 0);
         atomic_init(&_hangReportedForCurrentWindow, false);
+        atomic_init(&_stallReportedForCurrentWindow, false);
+        atomic_init(&_heartbeat, kBugSplatHeartbeatIdle);
     }
     return self;
 }
@@ -122,12 +200,25 @@ static inline NSInteger BugSplatHangMaxUnansweredPings(NSTimeInterval threshold)
         return;
     }
     self.running = YES;
-    atomic_store(&_unansweredPings, 0);
+    atomic_store(&_unansweredNanoseconds, 0);
     atomic_store(&_pingOutstanding, false);
+    atomic_store(&_parked, false);
+    atomic_store(&_pollCount, 0);
     atomic_store(&_hangReportedForCurrentWindow, false);
+    atomic_store(&_stallReportedForCurrentWindow, false);
+    _lastPeriodicWork = -INFINITY;
+
+    SEL threadMain = @selector(watchdogThreadMain);
+    if (self.usesHeartbeat) {
+        // -start runs on the main thread while it is busy (typically launching).
+        [self tick];
+        [self installRunLoopObserver];
+        atomic_store_explicit(&sBugSplatActiveHeartbeat, &_heartbeat, memory_order_release);
+        threadMain = @selector(heartbeatWatchdogThreadMain);
+    }
 
     NSThread *thread = [[NSThread alloc] initWithTarget:self
-                                               selector:@selector(watchdogThreadMain)
+                                               selector:threadMain
                                                  object:nil];
     thread.name = @"com.bugsplat.hang-tracker";
     thread.qualityOfService = NSQualityOfServiceUtility;
@@ -144,68 +235,225 @@ static inline NSInteger BugSplatHangMaxUnansweredPings(NSTimeInterval threshold)
     // ping callback can call into a deallocated tracker.
     self.running = NO;
     self.watchdogThread = nil;
+    @synchronized (self) {
+        if (_watchdogRunLoop) {
+            CFRunLoopStop(_watchdogRunLoop);
+        }
+    }
+
+    _Atomic(uint64_t) *expected = &_heartbeat;
+    atomic_compare_exchange_strong(&sBugSplatActiveHeartbeat, &expected, NULL);
+    if (_runLoopObserver) {
+        CFRunLoopObserverInvalidate(_runLoopObserver);
+        CFRelease(_runLoopObserver);
+        _runLoopObserver = NULL;
+    }
+}
+
+- (void)wake {
+    @synchronized (self) {
+        if (_pollTimer && atomic_exchange(&_parked, false)) {
+            CFRunLoopTimerSetNextFireDate(_pollTimer, CFAbsoluteTimeGetCurrent());
+            CFRunLoopWakeUp(_watchdogRunLoop);
+        }
+    }
+}
+
+- (uint64_t)pollCount {
+    return atomic_load_explicit(&_pollCount, memory_order_relaxed);
+}
+
+- (void)tick {
+    [self recordHeartbeat:BugSplatHeartbeatNow()];
+}
+
+- (void)markIdle {
+    [self recordHeartbeat:kBugSplatHeartbeatIdle];
+}
+
+#pragma mark - Heartbeat
+
+- (void)recordHeartbeat:(uint64_t)heartbeat {
+    atomic_store_explicit(&_heartbeat, heartbeat, memory_order_relaxed);
+}
+
+- (uint64_t)lastHeartbeat {
+    return atomic_load_explicit(&_heartbeat, memory_order_relaxed);
+}
+
+/// Tick at the start of every main run-loop pass and whenever it wakes up; mark it idle
+/// just before it sleeps. Common modes cover tracking and modal panel loops too.
+- (void)installRunLoopObserver {
+    // The handler captures the heartbeat word and histogram, not self; the observer is
+    // invalidated in -stop (and so in -dealloc) before either goes away.
+    _Atomic(uint64_t) *heartbeat = &_heartbeat;
+    BugSplatLatencyHistogram *histogram = self.latencyHistogram;
+    __block uint64_t busySince = 0;
+    CFOptionFlags activities = kCFRunLoopEntry | kCFRunLoopBeforeTimers | kCFRunLoopBeforeSources
+                             | kCFRunLoopBeforeWaiting | kCFRunLoopAfterWaiting;
+    _runLoopObserver = CFRunLoopObserverCreateWithHandler(kCFAllocatorDefault, activities, true, 0,
+        ^(CFRunLoopObserverRef observer, CFRunLoopActivity activity) {
+            uint64_t now = BugSplatHeartbeatNow();
+            if (activity == kCFRunLoopBeforeWaiting) {
+                atomic_store_explicit(heartbeat, kBugSplatHeartbeatIdle, memory_order_relaxed);
+                if (histogram && busySince != 0) {
+                    BugSplatLatencyHistogramRecord(histogram, (now - busySince) / NSEC_PER_USEC);
+                }
+                busySince = 0;
+                return;
+            }
+            if (busySince == 0) {
+                busySince = now;
+            }
+            atomic_store_explicit(heartbeat, now, memory_order_relaxed);
+        });
+    CFRunLoopAddObserver(CFRunLoopGetMain(), _runLoopObserver, kCFRunLoopCommonModes);
 }
 
 #pragma mark - Watchdog Thread
 
+/// Ping-mode watchdog. Polls are fired by a run-loop timer on this thread rather than a
+/// plain sleep, so each wakeup can carry a tolerance and be parked or woken from outside.
 - (void)watchdogThreadMain {
-    NSTimeInterval pollInterval = BugSplatHangPollInterval(self.thresholdSeconds);
-
     __weak __typeof(self) weakSelf = self;
     dispatch_block_t ping = ^{
         __strong __typeof(weakSelf) strongSelf = weakSelf;
         [strongSelf handleMainQueuePong];
     };
 
-    while (self.isRunning) {
-        @autoreleasepool {
-            // Send a ping to the main queue if there isn't one already in flight.
-            // A single outstanding ping is sufficient to observe responsiveness;
-            // dispatching on every poll during a long hang would accumulate an
-            // unbounded backlog that all flushes the moment main resumes.
-            bool wasOutstanding = atomic_exchange(&_pingOutstanding, true);
-            if (!wasOutstanding) {
-                self.pingDispatcher(ping);
+    // Send a ping to the main queue if there isn't one already in flight.
+    // A single outstanding ping is sufficient to observe responsiveness;
+    // dispatching on every poll during a long hang would accumulate an
+    // unbounded backlog that all flushes the moment main resumes.
+    [self sendPingIfNeeded:ping];
+
+    __block NSTimeInterval pollInterval = BugSplatHangPollInterval(self.thresholdSeconds);
+    __block CFAbsoluteTime sleepStart = self.clockBlock();
+    // Repeating in name only: every poll sets the next fire date itself.
+    CFRunLoopTimerRef timer = CFRunLoopTimerCreateWithHandler(kCFAllocatorDefault,
+        CFAbsoluteTimeGetCurrent() + pollInterval, kBugSplatHangParkedRecheckSeconds, 0, 0,
+        ^(CFRunLoopTimerRef firedTimer) {
+            @autoreleasepool {
+                if (!self.isRunning) {
+                    return;
+                }
+                atomic_fetch_add_explicit(&self->_pollCount, 1, memory_order_relaxed);
+                atomic_store(&self->_parked, false);
+
+                CFAbsoluteTime sleepEnd = self.clockBlock();
+                [self _processPollWithActualSleepDuration:(sleepEnd - sleepStart)];
+                [self runPeriodicWorkIfDueAt:sleepEnd];
+                sleepStart = sleepEnd;
+
+                pollInterval = [self _nextPollIntervalAfter:pollInterval];
+                NSTimeInterval sleep = pollInterval;
+                if (pollInterval == kBugSplatHangPollParked) {
+                    atomic_store(&self->_parked, true);
+                    sleep = kBugSplatHangParkedRecheckSeconds;
+                    pollInterval = BugSplatHangPollInterval(self.thresholdSeconds);
+                } else {
+                    [self sendPingIfNeeded:ping];
+                }
+                CFRunLoopTimerSetTolerance(firedTimer, sleep * kBugSplatHangPollTolerance);
+                CFRunLoopTimerSetNextFireDate(firedTimer, CFAbsoluteTimeGetCurrent() + sleep);
             }
+        });
+    CFRunLoopTimerSetTolerance(timer, pollInterval * kBugSplatHangPollTolerance);
+    CFRunLoopAddTimer(CFRunLoopGetCurrent(), timer, kCFRunLoopDefaultMode);
+    @synchronized (self) {
+        _pollTimer = timer;
+        _watchdogRunLoop = (CFRunLoopRef)CFRetain(CFRunLoopGetCurrent());
+    }
 
-            CFAbsoluteTime sleepStart = self.clockBlock();
-            [NSThread sleepForTimeInterval:pollInterval];
-
-            if (!self.isRunning) {
-                break;
-            }
+    // -stop stops the run loop once _watchdogRunLoop is set; before that, running is already NO.
+    // A quick -stop / -start replaces watchdogThread, so this thread also exits then.
+    NSThread *thisThread = [NSThread currentThread];
+    while (self.isRunning && self.watchdogThread == thisThread) {
+        @autoreleasepool {
+            CFRunLoopRunInMode(kCFRunLoopDefaultMode, kBugSplatHangParkedRecheckSeconds, false);
+        }
+    }
 
-            CFAbsoluteTime sleepEnd = self.clockBlock();
-            [self _processPollWithActualSleepDuration:(sleepEnd - sleepStart)];
+    CFRunLoopTimerInvalidate(timer);
+    @synchronized (self) {
+        if (_pollTimer == timer) {
+            _pollTimer = NULL;
+            CFRelease(_watchdogRunLoop);
+            _watchdogRunLoop = NULL;
         }
     }
+    CFRelease(timer);
+}
+
+/// Interval until the next ping-mode poll, or kBugSplatHangPollParked while the app is
+/// inactive. Called after each poll with the interval it slept; factored out for tests.
+- (NSTimeInterval)_nextPollIntervalAfter:(NSTimeInterval)interval {
+    NSTimeInterval base = BugSplatHangPollInterval(self.thresholdSeconds);
+    if (!self.adaptivePolling) {
+        return base;
+    }
+    BOOL(^activeCheck)(void) = self.isAppActiveBlock;
+    if (activeCheck && !activeCheck()) {
+        return kBugSplatHangPollParked;
+    }
+    // A ping still queued means latency is rising: poll at the base rate until it is answered.
+    if (atomic_load(&_pingOutstanding)) {
+        return base;
+    }
+    NSTimeInterval limit = self.thresholdSeconds;
+    if (self.stallThresholdSeconds > 0) {
+        limit = MIN(limit, self.stallThresholdSeconds);
+    }
+    NSTimeInterval maxInterval = MAX(base, limit * kBugSplatHangMaxPollFraction);
+    NSTimeInterval latency = (NSTimeInterval)atomic_load(&_lastPongLatency) / NSEC_PER_SEC;
+    if (latency < base * kBugSplatHangQuickPongFraction) {
+        return MIN(interval * 2.0, maxInterval);
+    }
+    return MAX(interval / 2.0, base);
+}
+
+/// Run `periodicWork` if it has not run within `periodicWorkInterval` of `now` (clock time).
+- (void)runPeriodicWorkIfDueAt:(CFAbsoluteTime)now {
+    void (^work)(void) = self.periodicWork;
+    if (!work || now - _lastPeriodicWork < self.periodicWorkInterval) {
+        return;
+    }
+    _lastPeriodicWork = now;
+    work();
+}
+
+- (void)sendPingIfNeeded:(dispatch_block_t)ping {
+    bool wasOutstanding = atomic_exchange(&_pingOutstanding, true);
+    if (!wasOutstanding) {
+        atomic_store_explicit(&_pingSentAt, BugSplatHeartbeatNow(), memory_order_relaxed);
+        self.pingDispatcher(ping);
+    }
 }
 
 /// Per-poll watchdog logic, factored out of the thread loop so tests can drive
 /// it deterministically without spawning a real thread.
 - (void)_processPollWithActualSleepDuration:(NSTimeInterval)actualSleep {
     NSTimeInterval threshold = self.thresholdSeconds;
-    NSInteger maxUnansweredPings = BugSplatHangMaxUnansweredPings(threshold);
 
     // Suspension guard: if our sleep took noticeably longer than the threshold,
     // the device was suspended or the process was put to sleep. Reset state -
     // we don't want the unanswered backlog to fire a "hang" the moment we wake.
     if (actualSleep > threshold * 2.0) {
-        atomic_store(&_unansweredPings, 0);
+        atomic_store(&_unansweredNanoseconds, 0);
         return;
     }
 
     // Debugger guard.
     BOOL(^debuggerCheck)(void) = self.isDebuggerAttachedBlock;
     if (debuggerCheck && debuggerCheck()) {
-        atomic_store(&_unansweredPings, 0);
+        atomic_store(&_unansweredNanoseconds, 0);
         return;
     }
 
     // App-active guard.
     BOOL(^activeCheck)(void) = self.isAppActiveBlock;
     if (activeCheck && !activeCheck()) {
-        atomic_store(&_unansweredPings, 0);
+        atomic_store(&_unansweredNanoseconds, 0);
         return;
     }
 
@@ -214,8 +462,19 @@ static inline NSInteger BugSplatHangMaxUnansweredPings(NSTimeInterval threshold)
         return;
     }
 
-    int32_t pings = atomic_fetch_add(&_unansweredPings, 1) + 1;
-    if (pings < maxUnansweredPings) {
+    // A ping answered during the sleep already reset the counter; the time after that
+    // answer is not known to be unresponsive, so nothing is added.
+    if (!atomic_load(&_pingOutstanding)) {
+        return;
+    }
+    uint64_t sleptNanoseconds = (uint64_t)llround(actualSleep * NSEC_PER_SEC);
+    NSTimeInterval unanswered = (NSTimeInterval)(atomic_fetch_add(&_unansweredNanoseconds, sleptNanoseconds) + sleptNanoseconds) / NSEC_PER_SEC;
+    NSTimeInterval stallThreshold = self.stallThresholdSeconds;
+    if (stallThreshold > 0 && unanswered >= stallThreshold
+        && !atomic_exchange(&_stallReportedForCurrentWindow, true)) {
+        [self notifyDelegateOfStallWithDuration:unanswered];
+    }
+    if (unanswered < threshold) {
         return;
     }
 
@@ -225,8 +484,95 @@ static inline NSInteger BugSplatHangMaxUnansweredPings(NSTimeInterval threshold)
         return;
     }
 
-    NSTimeInterval duration = pings * BugSplatHangPollInterval(threshold);
-    [self notifyDelegateOfHangWithDuration:duration];
+    [self notifyDelegateOfHangWithDuration:unanswered];
+}
+
+- (void)heartbeatWatchdogThreadMain {
+    NSTimeInterval sleepInterval = self.thresholdSeconds;
+    while (self.isRunning) {
+        @autoreleasepool {
+            CFAbsoluteTime sleepStart = self.clockBlock();
+            [NSThread sleepForTimeInterval:sleepInterval];
+
+            if (!self.isRunning) {
+                break;
+            }
+
+            atomic_fetch_add_explicit(&_pollCount, 1, memory_order_relaxed);
+            CFAbsoluteTime sleepEnd = self.clockBlock();
+            sleepInterval = [self _processHeartbeatAtTime:BugSplatHeartbeatNow()
+                                       actualSleepDuration:(sleepEnd - sleepStart)
+                                     expectedSleepDuration:sleepInterval];
+            [self runPeriodicWorkIfDueAt:sleepEnd];
+        }
+    }
+}
+
+/// Heartbeat-mode counterpart of `_processPollWithActualSleepDuration:`. Reads the
+/// heartbeat once, reports or recovers, and returns how long to sleep before the next
+/// check: until the current stall could first reach the threshold, a full threshold
+/// while the loop is idle, or a fifth of it while waiting for a reported hang to end.
+- (NSTimeInterval)_processHeartbeatAtTime:(uint64_t)now
+                      actualSleepDuration:(NSTimeInterval)actualSleep
+                    expectedSleepDuration:(NSTimeInterval)expectedSleep {
+    NSTimeInterval threshold = self.thresholdSeconds;
+    NSTimeInterval pollInterval = BugSplatHangPollInterval(threshold);
+    uint64_t heartbeat = atomic_load_explicit(&_heartbeat, memory_order_relaxed);
+
+    if (atomic_load(&_hangReportedForCurrentWindow)) {
+        if (heartbeat != _reportedHeartbeat) {
+            atomic_store(&_stallReportedForCurrentWindow, false);
+            atomic_store(&_hangReportedForCurrentWindow, false);
+            [self notifyDelegateOfRecovery];
+        }
+        return pollInterval;
+    }
+    if (atomic_load(&_stallReportedForCurrentWindow) && heartbeat != _reportedHeartbeat) {
+        atomic_store(&_stallReportedForCurrentWindow, false);
+        [self notifyDelegateOfStallEnd];
+    }
+
+    // Suspension guard: the loop was frozen along with us, so its stale heartbeat would
+    // read as a stall. Restart the measurement from now unless it ticked meanwhile.
+    if (actualSleep > expectedSleep + threshold) {
+        if (heartbeat != kBugSplatHeartbeatIdle) {
+            atomic_compare_exchange_strong(&_heartbeat, &heartbeat, now);
+        }
+        return threshold;
+    }
+
+    BOOL(^debuggerCheck)(void) = self.isDebuggerAttachedBlock;
+    BOOL(^activeCheck)(void) = self.isAppActiveBlock;
+    if ((debuggerCheck && debuggerCheck()) || (activeCheck && !activeCheck())) {
+        return threshold;
+    }
+
+    if (heartbeat == kBugSplatHeartbeatIdle || heartbeat >= now) {
+        return threshold;
+    }
+
+    NSTimeInterval stalled = (NSTimeInterval)(now - heartbeat) / NSEC_PER_SEC;
+    NSTimeInterval stallThreshold = self.stallThresholdSeconds;
+    if (stallThreshold > 0 && stalled >= stallThreshold && !atomic_load(&_stallReportedForCurrentWindow)) {
+        _reportedHeartbeat = heartbeat;
+        atomic_store(&_stallReportedForCurrentWindow, true);
+        [self notifyDelegateOfStallWithDuration:stalled];
+    }
+    if (stalled < threshold) {
+        NSTimeInterval untilNext = threshold - stalled;
+        if (stallThreshold > 0 && stalled < stallThreshold) {
+            untilNext = stallThreshold - stalled;
+        } else if (atomic_load(&_stallReportedForCurrentWindow)) {
+            // Notice a stall ending promptly; its delegate is waiting to hear either way.
+            untilNext = MIN(untilNext, pollInterval);
+        }
+        return MAX(untilNext, kMinHeartbeatSleepSeconds);
+    }
+
+    _reportedHeartbeat = heartbeat;
+    atomic_store(&_hangReportedForCurrentWindow, true);
+    [self notifyDelegateOfHangWithDuration:stalled];
+    return pollInterval;
 }
 
 /// Called on the main thread when the ping block runs (i.e. main is responsive).
@@ -234,13 +580,37 @@ static inline NSInteger BugSplatHangMaxUnansweredPings(NSTimeInterval threshold)
 /// just-ended window, dispatches a recovery callback so the integrator can
 /// discard any persisted hang report.
 - (void)handleMainQueuePong {
+    uint64_t sentAt = atomic_load_explicit(&_pingSentAt, memory_order_relaxed);
+    if (sentAt != 0 && atomic_load(&_pingOutstanding)) {
+        uint64_t latency = BugSplatHeartbeatNow() - sentAt;
+        atomic_store_explicit(&_lastPongLatency, latency, memory_order_relaxed);
+        BugSplatLatencyHistogram *histogram = self.latencyHistogram;
+        if (histogram) {
+            BugSplatLatencyHistogramRecord(histogram, latency / NSEC_PER_USEC);
+        }
+    }
     atomic_store(&_pingOutstanding, false);
-    atomic_store(&_unansweredPings, 0);
+    atomic_store(&_unansweredNanoseconds, 0);
+    void (^firstPongHandler)(void) = self.firstPongHandler;
+    if (firstPongHandler) {
+        // Main thread only, like every pong.
+        self.firstPongHandler = nil;
+        firstPongHandler();
+    }
+    bool wasStalled = atomic_exchange(&_stallReportedForCurrentWindow, false);
     bool wasReported = atomic_exchange(&_hangReportedForCurrentWindow, false);
     if (!wasReported) {
+        if (wasStalled) {
+            [self notifyDelegateOfStallEnd];
+        }
         return;
     }
+    [self notifyDelegateOfRecovery];
+}
+
+#pragma mark - Notification
 
+- (void)notifyDelegateOfRecovery {
     id<BugSplatHangTrackerDelegate> delegate = self.delegate;
     if (![delegate respondsToSelector:@selector(hangTrackerDidRecoverFromHang:)]) {
         return;
@@ -255,8 +625,6 @@ static inline NSInteger BugSplatHangMaxUnansweredPings(NSTimeInterval threshold)
     });
 }
 
-#pragma mark - Notification
-
 - (void)notifyDelegateOfHangWithDuration:(NSTimeInterval)duration {
     id<BugSplatHangTrackerDelegate> delegate = self.delegate;
     if (![delegate respondsToSelector:@selector(hangTracker:didDetectHangWithDuration:appState:)]) {
@@ -267,6 +635,28 @@ static inline NSInteger BugSplatHangMaxUnansweredPings(NSTimeInterval threshold)
     [delegate hangTracker:self didDetectHangWithDuration:duration appState:appState];
 }
 
+- (void)notifyDelegateOfStallWithDuration:(NSTimeInterval)duration {
+    id<BugSplatHangTrackerDelegate> delegate = self.delegate;
+    if ([delegate respondsToSelector:@selector(hangTracker:didDetectStallWithDuration:)]) {
+        [delegate hangTracker:self didDetectStallWithDuration:duration];
+    }
+}
+
+- (void)notifyDelegateOfStallEnd {
+    id<BugSplatHangTrackerDelegate> delegate = self.delegate;
+    if (![delegate respondsToSelector:@selector(hangTrackerDidEndStall:)]) {
+        return;
+    }
+
+    __weak __typeof(self) weakSelf = self;
+    self.recoveryDispatcher(^{
+        __strong __typeof(weakSelf) strongSelf = weakSelf;
+        if (strongSelf) {
+            [delegate hangTrackerDidEndStall:strongSelf];
+        }
+    });
+}
+
 - (NSString *)currentAppStateDescription {
     BOOL(^activeCheck)(void) = self.isAppActiveBlock;
     if (!activeCheck) {
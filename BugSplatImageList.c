@@ -0,0 +1,239 @@
+//
+//  BugSplatImageList.c
+//
+//  Copyright © BugSplat, LLC. All rights reserved.
+//
+
+#include "BugSplatImageList.h"
+
+#include <dlfcn.h>
+#include <mach-o/dyld.h>
+#include <mach-o/loader.h>
+#include <mach-o/nlist.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+/// Apps rarely load more than a few hundred images; later ones go unrecorded.
+#define BugSplatImageListCapacity 2048
+
+typedef struct {
+    BugSplatImage image;
+    _Atomic(bool) removed;
+} BugSplatImageEntry;
+
+/// Written only by the dyld callbacks, which dyld serialises. An entry is complete before
+/// the count that covers it is published, and is never reused.
+static BugSplatImageEntry *sBugSplatImageEntries = NULL;
+static _Atomic(size_t) sBugSplatImageCount = 0;
+static pthread_once_t sBugSplatImageListOnce = PTHREAD_ONCE_INIT;
+
+#pragma mark - Recording
+
+/// Fill in everything but the path from the image's load commands.
+static bool BugSplatImageParseHeader(const struct mach_header *header, intptr_t slide, BugSplatImage *image)
+{
+    if (header->magic != MH_MAGIC_64) {
+        return false;
+    }
+    const struct mach_header_64 *header64 = (const struct mach_header_64 *)header;
+    image->base = (uint64_t)(uintptr_t)header;
+    image->slide = slide;
+    image->cpuType = header64->cputype;
+    image->cpuSubtype = header64->cpusubtype;
+
+    const struct segment_command_64 *linkedit = NULL;
+    const struct symtab_command *symtab = NULL;
+    const uint8_t *command = (const uint8_t *)(header64 + 1);
+    for (uint32_t i = 0; i < header64->ncmds; i++) {
+        const struct load_command *loadCommand = (const struct load_command *)command;
+        if (loadCommand->cmd == LC_UUID) {
+            memcpy(image->uuid, ((const struct uuid_command *)loadCommand)->uuid, sizeof(image->uuid));
+            image->hasUUID = true;
+        } else if (loadCommand->cmd == LC_SEGMENT_64) {
+            const struct segment_command_64 *segment = (const struct segment_command_64 *)loadCommand;
+            if (strncmp(segment->segname, SEG_TEXT, sizeof(segment->segname)) == 0) {
+                image->textStart = segment->vmaddr + (uint64_t)slide;
+                image->textSize = segment->vmsize;
+            } else if (strncmp(segment->segname, SEG_LINKEDIT, sizeof(segment->segname)) == 0) {
+                linkedit = segment;
+            }
+        } else if (loadCommand->cmd == LC_SYMTAB) {
+            symtab = (const struct symtab_command *)loadCommand;
+        }
+        command += loadCommand->cmdsize;
+    }
+
+    if (linkedit && symtab) {
+        // File offsets in LC_SYMTAB are relative to where __LINKEDIT was mapped.
+        uint64_t linkeditBase = linkedit->vmaddr + (uint64_t)slide - linkedit->fileoff;
+        image->symbols = (const void *)(uintptr_t)(linkeditBase + symtab->symoff);
+        image->symbolCount = symtab->nsyms;
+        image->strings = (const char *)(uintptr_t)(linkeditBase + symtab->stroff);
+        image->stringsSize = symtab->strsize;
+    }
+    return image->textSize > 0;
+}
+
+static void BugSplatImageListAddImage(const struct mach_header *header, intptr_t slide)
+{
+    size_t count = atomic_load_explicit(&sBugSplatImageCount, memory_order_relaxed);
+    if (count >= BugSplatImageListCapacity) {
+        return;
+    }
+    BugSplatImageEntry *entry = &sBugSplatImageEntries[count];
+    memset(&entry->image, 0, sizeof(entry->image));
+    atomic_store_explicit(&entry->removed, false, memory_order_relaxed);
+    if (!BugSplatImageParseHeader(header, slide, &entry->image)) {
+        return;
+    }
+
+    // dyld calls back while loading, before any hang this list is read for.
+    Dl_info info;
+    const char *path = dladdr(header, &info) && info.dli_fname ? info.dli_fname : "???";
+    entry->image.path = strdup(path) ?: "???";
+    const char *name = strrchr(entry->image.path, '/');
+    entry->image.name = name ? name + 1 : entry->image.path;
+
+    atomic_store_explicit(&sBugSplatImageCount, count + 1, memory_order_release);
+}
+
+static void BugSplatImageListRemoveImage(const struct mach_header *header, intptr_t slide)
+{
+    (void)slide;
+    size_t count = atomic_load_explicit(&sBugSplatImageCount, memory_order_acquire);
+    for (size_t i = 0; i < count; i++) {
+        if (sBugSplatImageEntries[i].image.base == (uint64_t)(uintptr_t)header) {
+            atomic_store_explicit(&sBugSplatImageEntries[i].removed, true, memory_order_release);
+        }
+    }
+}
+
+static void BugSplatImageListRegister(void)
+{
+    sBugSplatImageEntries = calloc(BugSplatImageListCapacity, sizeof(BugSplatImageEntry));
+    if (!sBugSplatImageEntries) {
+        return;
+    }
+    // Registering also calls back once for every image already loaded.
+    _dyld_register_func_for_add_image(BugSplatImageListAddImage);
+    _dyld_register_func_for_remove_image(BugSplatImageListRemoveImage);
+}
+
+void BugSplatImageListInstall(void)
+{
+    pthread_once(&sBugSplatImageListOnce, BugSplatImageListRegister);
+}
+
+#pragma mark - Lookup
+
+bool BugSplatImageListFindAddress(uint64_t address, BugSplatImage *image)
+{
+    size_t count = atomic_load_explicit(&sBugSplatImageCount, memory_order_acquire);
+    for (size_t i = 0; i < count; i++) {
+        const BugSplatImageEntry *entry = &sBugSplatImageEntries[i];
+        if (address - entry->image.textStart < entry->image.textSize
+            && !atomic_load_explicit(&entry->removed, memory_order_acquire)) {
+            *image = entry->image;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool BugSplatImageListFindUUID(const uint8_t uuid[16], BugSplatImage *image)
+{
+    size_t count = atomic_load_explicit(&sBugSplatImageCount, memory_order_acquire);
+    for (size_t i = 0; i < count; i++) {
+        const BugSplatImageEntry *entry = &sBugSplatImageEntries[i];
+        if (entry->image.hasUUID && memcmp(entry->image.uuid, uuid, sizeof(entry->image.uuid)) == 0
+            && !atomic_load_explicit(&entry->removed, memory_order_acquire)) {
+            *image = entry->image;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char *BugSplatImageFindSymbol(const BugSplatImage *image, uint64_t address, uint64_t *symbolAddress)
+{
+    if (!image->symbols || !image->strings) {
+        return NULL;
+    }
+    // Symbol values are link addresses.
+    uint64_t target = address - (uint64_t)image->slide;
+    const struct nlist_64 *symbols = image->symbols;
+    const struct nlist_64 *best = NULL;
+    for (uint32_t i = 0; i < image->symbolCount; i++) {
+        const struct nlist_64 *symbol = &symbols[i];
+        if ((symbol->n_type & N_STAB) != 0 || (symbol->n_type & N_TYPE) != N_SECT || symbol->n_value == 0) {
+            continue;
+        }
+        if (symbol->n_value <= target && (!best || symbol->n_value > best->n_value)) {
+            best = symbol;
+        }
+    }
+    if (!best || best->n_un.n_strx == 0 || best->n_un.n_strx >= image->stringsSize) {
+        return NULL;
+    }
+    if (symbolAddress) {
+        *symbolAddress = best->n_value + (uint64_t)image->slide;
+    }
+    const char *name = image->strings + best->n_un.n_strx;
+    return name[0] == '_' ? name + 1 : name;
+}
+
+const char *BugSplatImageArchitectureName(const BugSplatImage *image)
+{
+    if (image->cpuType == CPU_TYPE_ARM64) {
+        return (image->cpuSubtype & ~CPU_SUBTYPE_MASK) == CPU_SUBTYPE_ARM64E ? "arm64e" : "arm64";
+    }
+    if (image->cpuType == CPU_TYPE_X86_64) {
+        return "x86_64";
+    }
+    return "???";
+}
+
+#pragma mark - UUIDs
+
+void BugSplatImageFormatUUID(const uint8_t uuid[16], char buffer[BugSplatImageUUIDStringLength])
+{
+    static const char digits[] = "0123456789abcdef";
+    for (size_t i = 0; i < 16; i++) {
+        buffer[2 * i] = digits[uuid[i] >> 4];
+        buffer[2 * i + 1] = digits[uuid[i] & 0xf];
+    }
+    buffer[32] = '\0';
+}
+
+static int BugSplatImageHexValue(char c)
+{
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+bool BugSplatImageParseUUID(const char *string, uint8_t uuid[16])
+{
+    size_t digits = 0;
+    for (const char *c = string; *c; c++) {
+        if (*c == '-') {
+            continue;
+        }
+        int value = BugSplatImageHexValue(*c);
+        if (value < 0 || digits == 32) {
+            return false;
+        }
+        uuid[digits / 2] = (uint8_t)(digits % 2 == 0 ? value << 4 : (uuid[digits / 2] | value));
+        digits++;
+    }
+    return digits == 32;
+}
@@ -0,0 +1,91 @@
+//
+//  BugSplatImageList.h
+//
+//  The binary images loaded in this process, recorded as dyld loads them so that
+//  an address can be attributed to its image, and to the nearest exported symbol,
+//  without dladdr. dladdr takes the dyld loader lock, which a hung thread stuck in
+//  dlopen or a +load method holds; nothing here locks or allocates once the list
+//  is installed, so it can run while such a thread is hung or suspended.
+//
+//  Copyright © BugSplat, LLC. All rights reserved.
+//
+
+#ifndef BugSplatImageList_h
+#define BugSplatImageList_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// Length of a UUID formatted by BugSplatImageFormatUUID, including the terminator.
+#define BugSplatImageUUIDStringLength 33
+
+typedef struct {
+    /// Address of the Mach-O header.
+    uint64_t base;
+    /// Difference between the image's load address and its link address.
+    int64_t slide;
+    /// Loaded __TEXT segment; Apple's reports end an image there, also in the shared cache.
+    uint64_t textStart;
+    uint64_t textSize;
+    uint8_t uuid[16];
+    bool hasUUID;
+    int32_t cpuType;
+    int32_t cpuSubtype;
+    /// Full path; stays valid after the image is unloaded.
+    const char *path;
+    /// Last path component of `path`.
+    const char *name;
+    /// Symbol table (nlist_64 entries) and its string table in the mapped __LINKEDIT.
+    const void *symbols;
+    uint32_t symbolCount;
+    const char *strings;
+    uint32_t stringsSize;
+} BugSplatImage;
+
+/**
+ * Start recording images. Images already loaded are recorded before this returns; later
+ * ones as dyld loads them. Idempotent and thread-safe; call it before anything that must
+ * not wait for dyld needs the list.
+ */
+void BugSplatImageListInstall(void);
+
+/**
+ * Copy the image whose __TEXT segment contains `address` into `image`.
+ * Async-signal-safe.
+ *
+ * @return false if no recorded image contains it.
+ */
+bool BugSplatImageListFindAddress(uint64_t address, BugSplatImage *image);
+
+/// Copy the loaded image with `uuid` into `image`. Async-signal-safe.
+bool BugSplatImageListFindUUID(const uint8_t uuid[16], BugSplatImage *image);
+
+/**
+ * Nearest symbol at or below `address` in `image`'s symbol table, with the leading
+ * underscore of C symbols removed. Only what the loaded symbol table holds is found:
+ * for system libraries that is their exported symbols. Async-signal-safe.
+ *
+ * @param symbolAddress Receives the symbol's loaded address; may be NULL.
+ * @return The name, pointing into the image; NULL if there is none.
+ */
+const char *BugSplatImageFindSymbol(const BugSplatImage *image, uint64_t address, uint64_t *symbolAddress);
+
+/// `arm64e`, `arm64`, `x86_64`, or `???`.
+const char *BugSplatImageArchitectureName(const BugSplatImage *image);
+
+/// Write `uuid` as 32 lowercase hex digits, the form crash reports use.
+void BugSplatImageFormatUUID(const uint8_t uuid[16], char buffer[BugSplatImageUUIDStringLength]);
+
+/// Parse 32 hex digits, optionally with dashes. @return false if `string` is not a UUID.
+bool BugSplatImageParseUUID(const char *string, uint8_t uuid[16]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BugSplatImageList_h */
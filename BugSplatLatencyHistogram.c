@@ -0,0 +1,120 @@
+//
+//  BugSplatLatencyHistogram.c
+//
+//  Copyright © BugSplat, LLC. All rights reserved.
+//
+
+#include "BugSplatLatencyHistogram.h"
+
+#include <math.h>
+#include <string.h>
+
+static const uint32_t kBugSplatLatencyHistogramMagic = 0x48445342; // "BSDH", little-endian
+
+/// Values below 2^7 get a bucket each; above, each power of two is split into 2^6 buckets.
+static const unsigned kBugSplatLatencyHistogramSubBucketBits = 7;
+static const uint64_t kBugSplatLatencyHistogramSubBucketCount = 1 << kBugSplatLatencyHistogramSubBucketBits;
+static const uint64_t kBugSplatLatencyHistogramSubBucketHalf = kBugSplatLatencyHistogramSubBucketCount / 2;
+
+#pragma mark - Buckets
+
+static unsigned BugSplatLatencyHistogramHighestBit(uint64_t value)
+{
+    return 63 - (unsigned)__builtin_clzll(value);
+}
+
+size_t BugSplatLatencyHistogramBucketIndex(uint64_t value)
+{
+    if (value > BugSplatLatencyHistogramMaxValue) {
+        value = BugSplatLatencyHistogramMaxValue;
+    }
+    if (value < kBugSplatLatencyHistogramSubBucketCount) {
+        return (size_t)value;
+    }
+    // Shift so the value keeps its top 7 bits: 64...127 within its power of two.
+    unsigned shift = BugSplatLatencyHistogramHighestBit(value) - (kBugSplatLatencyHistogramSubBucketBits - 1);
+    uint64_t subBucket = (value >> shift) - kBugSplatLatencyHistogramSubBucketHalf;
+    return (size_t)(kBugSplatLatencyHistogramSubBucketCount + (shift - 1) * kBugSplatLatencyHistogramSubBucketHalf + subBucket);
+}
+
+uint64_t BugSplatLatencyHistogramBucketUpperBound(size_t index)
+{
+    if (index < kBugSplatLatencyHistogramSubBucketCount) {
+        return index;
+    }
+    if (index >= BugSplatLatencyHistogramBucketCount) {
+        return BugSplatLatencyHistogramMaxValue;
+    }
+    size_t offset = index - kBugSplatLatencyHistogramSubBucketCount;
+    unsigned shift = (unsigned)(offset / kBugSplatLatencyHistogramSubBucketHalf) + 1;
+    uint64_t subBucket = offset % kBugSplatLatencyHistogramSubBucketHalf + kBugSplatLatencyHistogramSubBucketHalf;
+    return ((subBucket + 1) << shift) - 1;
+}
+
+#pragma mark - Recording
+
+void BugSplatLatencyHistogramInit(BugSplatLatencyHistogram *histogram)
+{
+    memset(histogram, 0, sizeof(*histogram));
+    histogram->magic = kBugSplatLatencyHistogramMagic;
+    histogram->version = BugSplatLatencyHistogramVersion;
+}
+
+bool BugSplatLatencyHistogramIsValid(const BugSplatLatencyHistogram *histogram)
+{
+    return histogram
+        && histogram->magic == kBugSplatLatencyHistogramMagic
+        && histogram->version == BugSplatLatencyHistogramVersion;
+}
+
+void BugSplatLatencyHistogramRecord(BugSplatLatencyHistogram *histogram, uint64_t value)
+{
+    if (!histogram) {
+        return;
+    }
+    if (value > BugSplatLatencyHistogramMaxValue) {
+        value = BugSplatLatencyHistogramMaxValue;
+    }
+    atomic_fetch_add_explicit(&histogram->buckets[BugSplatLatencyHistogramBucketIndex(value)], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&histogram->total, value, memory_order_relaxed);
+    uint64_t max = atomic_load_explicit(&histogram->max, memory_order_relaxed);
+    while (value > max
+           && !atomic_compare_exchange_weak_explicit(&histogram->max, &max, value, memory_order_relaxed, memory_order_relaxed)) {
+    }
+    atomic_fetch_add_explicit(&histogram->count, 1, memory_order_relaxed);
+}
+
+#pragma mark - Reading
+
+uint64_t BugSplatLatencyHistogramValueAtPercentile(const BugSplatLatencyHistogram *histogram, double percentile)
+{
+    if (!histogram) {
+        return 0;
+    }
+    uint64_t max = atomic_load_explicit(&histogram->max, memory_order_relaxed);
+    uint64_t count = 0;
+    for (size_t i = 0; i < BugSplatLatencyHistogramBucketCount; i++) {
+        count += atomic_load_explicit(&histogram->buckets[i], memory_order_relaxed);
+    }
+    if (count == 0) {
+        return 0;
+    }
+    if (percentile >= 100.0) {
+        return max;
+    }
+
+    double clamped = percentile > 0.0 ? percentile : 0.0;
+    uint64_t rank = (uint64_t)ceil(clamped / 100.0 * (double)count);
+    if (rank == 0) {
+        rank = 1;
+    }
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BugSplatLatencyHistogramBucketCount; i++) {
+        seen += atomic_load_explicit(&histogram->buckets[i], memory_order_relaxed);
+        if (seen >= rank) {
+            uint64_t bound = BugSplatLatencyHistogramBucketUpperBound(i);
+            return bound < max ? bound : max;
+        }
+    }
+    return max;
+}
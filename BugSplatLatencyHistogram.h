@@ -0,0 +1,72 @@
+//
+//  BugSplatLatencyHistogram.h
+//
+//  Fixed-size latency histogram with HDR-style log-linear buckets: exact up
+//  to 127 us and within 1/64 (about 1.6%) above, up to about 71 minutes. Plain
+//  C over caller-provided memory, so it can live in a shared file mapping that
+//  outlives a crash, and the bucketing can be tested on any platform.
+//
+//  Copyright © BugSplat, LLC. All rights reserved.
+//
+
+#ifndef BugSplatLatencyHistogram_h
+#define BugSplatLatencyHistogram_h
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BugSplatLatencyHistogramVersion 1
+
+/// 128 exact buckets, then 64 buckets for each power of two up to 2^32 us.
+#define BugSplatLatencyHistogramBucketCount 1728
+
+/// Largest value kept; larger values are recorded as this.
+#define BugSplatLatencyHistogramMaxValue ((uint64_t)UINT32_MAX)
+
+/**
+ * Values are microseconds. Counters are updated with relaxed atomics, so recording is
+ * lock-free and readers see a slightly stale but never torn histogram.
+ */
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    _Atomic(uint64_t) count;
+    _Atomic(uint64_t) total;
+    _Atomic(uint64_t) max;
+    _Atomic(uint32_t) buckets[BugSplatLatencyHistogramBucketCount];
+} BugSplatLatencyHistogram;
+
+/// Make `histogram` an empty histogram of this version, discarding anything in it.
+void BugSplatLatencyHistogramInit(BugSplatLatencyHistogram *histogram);
+
+/// True if `histogram` was initialized by this version (e.g. in a file from an earlier process).
+bool BugSplatLatencyHistogramIsValid(const BugSplatLatencyHistogram *histogram);
+
+/// Count one value. Lock-free; does not allocate.
+void BugSplatLatencyHistogramRecord(BugSplatLatencyHistogram *histogram, uint64_t value);
+
+/// Bucket counting `value` (values above the maximum go to the last bucket).
+size_t BugSplatLatencyHistogramBucketIndex(uint64_t value);
+
+/// Largest value counted by bucket `index`.
+uint64_t BugSplatLatencyHistogramBucketUpperBound(size_t index);
+
+/**
+ * Smallest bucket bound that at least `percentile` percent of the values do not exceed,
+ * capped at the largest value recorded; 100 returns that largest value exactly.
+ *
+ * @return 0 for an empty histogram.
+ */
+uint64_t BugSplatLatencyHistogramValueAtPercentile(const BugSplatLatencyHistogram *histogram, double percentile);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BugSplatLatencyHistogram_h */
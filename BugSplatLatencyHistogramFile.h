@@ -0,0 +1,44 @@
+//
+//  BugSplatLatencyHistogramFile.h
+//
+//  Copyright © BugSplat, LLC. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+#import "BugSplatLatencyHistogram.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * A `BugSplatLatencyHistogram` in a memory-mapped file, so the histogram a session
+ * recorded is still there on the next launch when the session ended in a crash or kill.
+ */
+@interface BugSplatLatencyHistogramFile : NSObject
+
+/**
+ * Open (creating if needed) the histogram file and map it read-write. A histogram of this
+ * version already in the file is kept; anything else is replaced by an empty histogram.
+ *
+ * @return nil if the file cannot be created, sized or mapped.
+ */
+- (nullable instancetype)initWithPath:(NSString *)path NS_DESIGNATED_INITIALIZER;
+- (instancetype)init NS_UNAVAILABLE;
+
+@property (nonatomic, copy, readonly) NSString *path;
+
+/// The mapped histogram; valid for the lifetime of the receiver.
+@property (nonatomic, readonly) BugSplatLatencyHistogram *histogram;
+
+/// Number of values recorded.
+@property (nonatomic, readonly) uint64_t count;
+
+/// Value at `percentile`, as for `BugSplatLatencyHistogramValueAtPercentile`.
+- (uint64_t)valueAtPercentile:(double)percentile;
+
+/// Drop every value. Must not race with recording.
+- (void)reset;
+
+@end
+
+NS_ASSUME_NONNULL_END
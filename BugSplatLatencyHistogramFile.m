@@ -0,0 +1,55 @@
+//
+//  BugSplatLatencyHistogramFile.m
+//
+//  Copyright © BugSplat, LLC. All rights reserved.
+//
+
+#import "BugSplatLatencyHistogramFile.h"
+#import "BugSplatMappedFile.h"
+
+@implementation BugSplatLatencyHistogramFile
+{
+    BugSplatMappedFile *_file;
+}
+
+- (instancetype)initWithPath:(NSString *)path
+{
+    if (self = [super init]) {
+        _path = [path copy];
+        // Recording never has to allocate or fault in a page.
+        _file = [[BugSplatMappedFile alloc] initWithPath:path
+                                                    size:[BugSplatMappedFile pageAlignedSize:sizeof(BugSplatLatencyHistogram)]
+                                                 options:BugSplatMappedFileOptionsPrefault
+                                                    name:@"latency histogram"];
+        if (!_file) {
+            return nil;
+        }
+
+        if (!BugSplatLatencyHistogramIsValid(self.histogram)) {
+            BugSplatLatencyHistogramInit(self.histogram);
+        }
+    }
+    return self;
+}
+
+- (BugSplatLatencyHistogram *)histogram
+{
+    return (BugSplatLatencyHistogram *)_file.bytes;
+}
+
+- (uint64_t)count
+{
+    return atomic_load_explicit(&self.histogram->count, memory_order_relaxed);
+}
+
+- (uint64_t)valueAtPercentile:(double)percentile
+{
+    return BugSplatLatencyHistogramValueAtPercentile(self.histogram, percentile);
+}
+
+- (void)reset
+{
+    BugSplatLatencyHistogramInit(self.histogram);
+}
+
+@end
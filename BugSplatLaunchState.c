@@ -0,0 +1,164 @@
+//
+//  BugSplatLaunchState.c
+//
+//  Copyright © BugSplat, LLC. All rights reserved.
+//
+
+#include "BugSplatLaunchState.h"
+
+#include <string.h>
+
+static const uint32_t kBugSplatLaunchStateMagic = 0x534C5342; // "BSLS", little-endian
+
+#pragma mark - Recording
+
+static void BugSplatLaunchStateCopyString(char *field, const char *value)
+{
+    memset(field, 0, BugSplatLaunchStateVersionLength);
+    if (value) {
+        strncpy(field, value, BugSplatLaunchStateVersionLength - 1);
+    }
+}
+
+void BugSplatLaunchStateBegin(BugSplatLaunchState *state, const char *appVersion, const char *osVersion,
+                              uint64_t launchTime, uint64_t bootTime)
+{
+    memset(state, 0, sizeof(*state));
+    state->launchTime = launchTime;
+    state->bootTime = bootTime;
+    BugSplatLaunchStateCopyString(state->appVersion, appVersion);
+    BugSplatLaunchStateCopyString(state->osVersion, osVersion);
+    atomic_store_explicit(&state->stateChangedAt, launchTime, memory_order_relaxed);
+    state->version = BugSplatLaunchStateVersion;
+    // Last, so a launch killed while beginning leaves no valid record.
+    state->magic = kBugSplatLaunchStateMagic;
+}
+
+bool BugSplatLaunchStateIsValid(const BugSplatLaunchState *state)
+{
+    return state && state->magic == kBugSplatLaunchStateMagic && state->version == BugSplatLaunchStateVersion;
+}
+
+void BugSplatLaunchStateSetAppState(BugSplatLaunchState *state, BugSplatLaunchAppState appState, uint64_t now)
+{
+    atomic_store_explicit(&state->appState, (uint32_t)appState, memory_order_relaxed);
+    atomic_store_explicit(&state->stateChangedAt, now, memory_order_relaxed);
+}
+
+void BugSplatLaunchStateSetHangState(BugSplatLaunchState *state, BugSplatLaunchHangState hangState)
+{
+    atomic_store_explicit(&state->hangState, (uint32_t)hangState, memory_order_relaxed);
+}
+
+void BugSplatLaunchStateSetMemoryPressure(BugSplatLaunchState *state, BugSplatLaunchMemoryPressure pressure)
+{
+    atomic_store_explicit(&state->memoryPressure, (uint32_t)pressure, memory_order_relaxed);
+}
+
+void BugSplatLaunchStateRecordFootprint(BugSplatLaunchState *state, uint64_t footprint, uint64_t limit, uint64_t now)
+{
+    atomic_store_explicit(&state->footprint, footprint, memory_order_relaxed);
+    atomic_store_explicit(&state->footprintLimit, limit, memory_order_relaxed);
+    atomic_store_explicit(&state->footprintSampledAt, now, memory_order_relaxed);
+    uint64_t peak = atomic_load_explicit(&state->peakFootprint, memory_order_relaxed);
+    while (footprint > peak
+           && !atomic_compare_exchange_weak_explicit(&state->peakFootprint, &peak, footprint,
+                                                     memory_order_relaxed, memory_order_relaxed)) {
+    }
+}
+
+void BugSplatLaunchStateMarkCleanExit(BugSplatLaunchState *state)
+{
+    atomic_store_explicit(&state->cleanExit, 1, memory_order_relaxed);
+}
+
+#pragma mark - Inference
+
+static bool BugSplatLaunchStateVersionChanged(const char *recorded, const char *current)
+{
+    if (!current) {
+        return false;
+    }
+    return strncmp(recorded, current, BugSplatLaunchStateVersionLength - 1) != 0;
+}
+
+BugSplatTermination BugSplatLaunchStateInferTermination(const BugSplatLaunchState *previous,
+                                                        const BugSplatLaunchContext *current)
+{
+    if (!BugSplatLaunchStateIsValid(previous) || !current) {
+        return BugSplatTerminationUnknown;
+    }
+    if (atomic_load_explicit(&previous->cleanExit, memory_order_relaxed)) {
+        return BugSplatTerminationCleanExit;
+    }
+    uint32_t hangState = atomic_load_explicit(&previous->hangState, memory_order_relaxed);
+    if (current->crashReported || hangState == BugSplatLaunchHangReported) {
+        return BugSplatTerminationReported;
+    }
+    if (atomic_load_explicit(&previous->debuggerAttached, memory_order_relaxed)) {
+        return BugSplatTerminationDebugger;
+    }
+    if (BugSplatLaunchStateVersionChanged(previous->appVersion, current->appVersion)) {
+        return BugSplatTerminationAppUpdate;
+    }
+    if (BugSplatLaunchStateVersionChanged(previous->osVersion, current->osVersion)) {
+        return BugSplatTerminationOSUpdate;
+    }
+    // The boot time moves by a few seconds when the clock is set; only a boot after the
+    // previous launch started means the device restarted under it.
+    if (current->bootTime > previous->launchTime) {
+        return BugSplatTerminationReboot;
+    }
+    if (hangState == BugSplatLaunchHangUnreported) {
+        return BugSplatTerminationWatchdog;
+    }
+    if (atomic_load_explicit(&previous->appState, memory_order_relaxed) == BugSplatLaunchAppStateBackground) {
+        return BugSplatTerminationBackground;
+    }
+    return BugSplatTerminationOutOfMemory;
+}
+
+bool BugSplatTerminationIsReportable(BugSplatTermination termination)
+{
+    return termination == BugSplatTerminationWatchdog || termination == BugSplatTerminationOutOfMemory;
+}
+
+#pragma mark - Names
+
+const char *BugSplatTerminationName(BugSplatTermination termination)
+{
+    switch (termination) {
+        case BugSplatTerminationCleanExit: return "clean-exit";
+        case BugSplatTerminationReported: return "reported";
+        case BugSplatTerminationDebugger: return "debugger";
+        case BugSplatTerminationAppUpdate: return "app-update";
+        case BugSplatTerminationOSUpdate: return "os-update";
+        case BugSplatTerminationReboot: return "reboot";
+        case BugSplatTerminationWatchdog: return "watchdog";
+        case BugSplatTerminationOutOfMemory: return "out-of-memory";
+        case BugSplatTerminationBackground: return "background";
+        case BugSplatTerminationUnknown: break;
+    }
+    return "unknown";
+}
+
+const char *BugSplatLaunchAppStateName(BugSplatLaunchAppState appState)
+{
+    switch (appState) {
+        case BugSplatLaunchAppStateActive: return "active";
+        case BugSplatLaunchAppStateInactive: return "inactive";
+        case BugSplatLaunchAppStateBackground: return "background";
+        case BugSplatLaunchAppStateUnknown: break;
+    }
+    return "unknown";
+}
+
+const char *BugSplatLaunchMemoryPressureName(BugSplatLaunchMemoryPressure pressure)
+{
+    switch (pressure) {
+        case BugSplatLaunchMemoryPressureWarning: return "warning";
+        case BugSplatLaunchMemoryPressureCritical: return "critical";
+        case BugSplatLaunchMemoryPressureNormal: break;
+    }
+    return "normal";
+}
@@ -0,0 +1,161 @@
+//
+//  BugSplatLaunchState.h
+//
+//  Per-launch state sentinel. Each launch keeps a small record of how it is
+//  doing - whether it exited cleanly, whether it was in the foreground, its
+//  last memory footprint, whether the main thread was hung - in a shared file
+//  mapping, so the next launch can tell how it ended even when the system
+//  killed it without a crash report (memory pressure, watchdog). Plain C, so
+//  the inference can be tested on any platform against recorded states.
+//
+//  Copyright © BugSplat, LLC. All rights reserved.
+//
+
+#ifndef BugSplatLaunchState_h
+#define BugSplatLaunchState_h
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BugSplatLaunchStateVersion 1
+
+/// Room for a version string, including the terminating NUL.
+#define BugSplatLaunchStateVersionLength 32
+
+typedef enum {
+    BugSplatLaunchAppStateUnknown = 0,
+    /// In the foreground and receiving events.
+    BugSplatLaunchAppStateActive = 1,
+    /// In the foreground but not receiving events, e.g. while launching or under a system alert.
+    BugSplatLaunchAppStateInactive = 2,
+    BugSplatLaunchAppStateBackground = 3,
+} BugSplatLaunchAppState;
+
+typedef enum {
+    BugSplatLaunchHangNone = 0,
+    /// The main thread was hung and no report of the hang had been written yet.
+    BugSplatLaunchHangUnreported = 1,
+    /// The main thread was hung and its hang report was written (files or reserved slot).
+    BugSplatLaunchHangReported = 2,
+} BugSplatLaunchHangState;
+
+/// System memory pressure as last reported, e.g. by a dispatch memory pressure source.
+typedef enum {
+    BugSplatLaunchMemoryPressureNormal = 0,
+    BugSplatLaunchMemoryPressureWarning = 1,
+    BugSplatLaunchMemoryPressureCritical = 2,
+} BugSplatLaunchMemoryPressure;
+
+/**
+ * One launch's record. The identity fields are written once when the launch begins; the rest
+ * are updated with relaxed atomics from whichever thread observes the change, without locks
+ * or allocation. Times are seconds since 1970.
+ */
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t launchTime;
+    /// When the device last booted, to tell a reboot from a kill.
+    uint64_t bootTime;
+    char appVersion[BugSplatLaunchStateVersionLength];
+    char osVersion[BugSplatLaunchStateVersionLength];
+
+    /// Set only when the process exits normally; a kill or crash leaves it clear.
+    _Atomic(uint32_t) cleanExit;
+    _Atomic(uint32_t) appState;
+    _Atomic(uint32_t) hangState;
+    _Atomic(uint32_t) debuggerAttached;
+    _Atomic(uint32_t) memoryPressure;
+    _Atomic(uint32_t) memoryWarnings;
+    _Atomic(uint64_t) stateChangedAt;
+
+    /// Last sampled memory footprint, its limit (0 if unknown) and the session's peak, in bytes.
+    _Atomic(uint64_t) footprint;
+    _Atomic(uint64_t) footprintLimit;
+    _Atomic(uint64_t) peakFootprint;
+    _Atomic(uint64_t) footprintSampledAt;
+} BugSplatLaunchState;
+
+/// Start a new launch's record in `state`, discarding anything in it. Strings are truncated to fit.
+void BugSplatLaunchStateBegin(BugSplatLaunchState *state, const char *appVersion, const char *osVersion,
+                              uint64_t launchTime, uint64_t bootTime);
+
+/// True if `state` was begun by this version (e.g. in a file left by an earlier process).
+bool BugSplatLaunchStateIsValid(const BugSplatLaunchState *state);
+
+void BugSplatLaunchStateSetAppState(BugSplatLaunchState *state, BugSplatLaunchAppState appState, uint64_t now);
+
+void BugSplatLaunchStateSetHangState(BugSplatLaunchState *state, BugSplatLaunchHangState hangState);
+
+void BugSplatLaunchStateSetMemoryPressure(BugSplatLaunchState *state, BugSplatLaunchMemoryPressure pressure);
+
+/// Record a footprint sample, in bytes; `limit` is 0 when unknown. Also raises the peak.
+void BugSplatLaunchStateRecordFootprint(BugSplatLaunchState *state, uint64_t footprint, uint64_t limit, uint64_t now);
+
+/// Mark the launch as having exited normally. Async-signal-safe.
+void BugSplatLaunchStateMarkCleanExit(BugSplatLaunchState *state);
+
+typedef enum {
+    /// No valid record of the previous launch, e.g. on first launch.
+    BugSplatTerminationUnknown = 0,
+    BugSplatTerminationCleanExit,
+    /// The previous launch left a report of its own (a crash, or a fatal hang).
+    BugSplatTerminationReported,
+    /// A debugger was attached; it may have stopped the process.
+    BugSplatTerminationDebugger,
+    /// The app was updated; the old version is terminated to install it.
+    BugSplatTerminationAppUpdate,
+    /// The OS was updated.
+    BugSplatTerminationOSUpdate,
+    /// The device rebooted or shut down.
+    BugSplatTerminationReboot,
+    /// Killed while the main thread was hung, before a hang report was written.
+    BugSplatTerminationWatchdog,
+    /// Killed in the foreground with no other explanation: almost always memory pressure.
+    BugSplatTerminationOutOfMemory,
+    /// Killed in the background. The system reclaims suspended apps routinely, so this is
+    /// not a failure on its own.
+    BugSplatTerminationBackground,
+} BugSplatTermination;
+
+/// What the current launch knows about how the previous one ended.
+typedef struct {
+    const char *appVersion;
+    const char *osVersion;
+    uint64_t bootTime;
+    /// The previous launch left a crash report.
+    bool crashReported;
+} BugSplatLaunchContext;
+
+/**
+ * Infer how the launch recorded in `previous` ended. Explanations are tried in order - clean
+ * exit, its own report, debugger, app or OS update, reboot - before concluding it was killed:
+ * by the watchdog if the main thread was hung, otherwise for memory in the foreground, or
+ * routinely in the background.
+ */
+BugSplatTermination BugSplatLaunchStateInferTermination(const BugSplatLaunchState *previous,
+                                                        const BugSplatLaunchContext *current);
+
+/// Whether `termination` is a failure worth a report of its own (watchdog or out-of-memory kill).
+bool BugSplatTerminationIsReportable(BugSplatTermination termination);
+
+/// Short stable name, e.g. `out-of-memory`, for report attributes.
+const char *BugSplatTerminationName(BugSplatTermination termination);
+
+/// Short stable name, e.g. `background`.
+const char *BugSplatLaunchAppStateName(BugSplatLaunchAppState appState);
+
+/// Short stable name, e.g. `critical`.
+const char *BugSplatLaunchMemoryPressureName(BugSplatLaunchMemoryPressure pressure);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BugSplatLaunchState_h */
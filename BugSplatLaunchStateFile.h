@@ -0,0 +1,60 @@
+//
+//  BugSplatLaunchStateFile.h
+//
+//  Copyright © BugSplat, LLC. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+#import "BugSplatLaunchState.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * A `BugSplatLaunchState` in a memory-mapped file. Updates are stores into the shared
+ * mapping, which the kernel keeps when the process is killed, so the next launch reads
+ * back where this one left off.
+ */
+@interface BugSplatLaunchStateFile : NSObject
+
+/**
+ * Open (creating if needed) the state file and map it read-write. A valid record already
+ * in the file is copied to `previousState` before anything is written.
+ *
+ * @return nil if the file cannot be created, sized or mapped.
+ */
+- (nullable instancetype)initWithPath:(NSString *)path NS_DESIGNATED_INITIALIZER;
+- (instancetype)init NS_UNAVAILABLE;
+
+@property (nonatomic, copy, readonly) NSString *path;
+
+/// The previous launch's record as it was when the file was opened; NULL if there was none.
+@property (nonatomic, readonly, nullable) const BugSplatLaunchState *previousState;
+
+/// This launch's record, in the mapping; valid for the lifetime of the receiver.
+@property (nonatomic, readonly) BugSplatLaunchState *state;
+
+/// Begin this launch's record with the current OS version, boot time and clock.
+- (void)beginLaunchWithAppVersion:(NSString *)appVersion;
+
+/// Sample the process's memory footprint (and its limit, where the OS reports one) into the record.
+- (void)recordMemoryFootprint;
+
+/// Mark this launch's record as cleanly exited when the process calls `exit`. The file must stay alive while active.
+- (void)activate;
+
+/// Stop marking this record on exit, if it is active.
+- (void)deactivate;
+
+/// Seconds since 1970, as recorded in launch states.
++ (uint64_t)now;
+
+/// When the device booted, in seconds since 1970.
++ (uint64_t)bootTime;
+
+/// The running OS version and build, e.g. `17.4.1 (21E236)`.
++ (NSString *)operatingSystemVersion;
+
+@end
+
+NS_ASSUME_NONNULL_END
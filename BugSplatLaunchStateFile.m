@@ -0,0 +1,140 @@
+//
+//  BugSplatLaunchStateFile.m
+//
+//  Copyright © BugSplat, LLC. All rights reserved.
+//
+
+#import "BugSplatLaunchStateFile.h"
+#import "BugSplatMappedFile.h"
+
+#import <TargetConditionals.h>
+#import <mach/mach.h>
+#import <stdatomic.h>
+#import <stdlib.h>
+#import <string.h>
+#import <sys/sysctl.h>
+#if TARGET_OS_IOS || TARGET_OS_TV
+#import <os/proc.h>
+#endif
+
+/// Record marked cleanly exited by the atexit handler; NULL until a file is activated.
+static _Atomic(BugSplatLaunchState *) sBugSplatActiveLaunchState = NULL;
+
+static void BugSplatLaunchStateExitHandler(void)
+{
+    BugSplatLaunchState *state = atomic_load_explicit(&sBugSplatActiveLaunchState, memory_order_acquire);
+    if (state) {
+        BugSplatLaunchStateMarkCleanExit(state);
+    }
+}
+
+@implementation BugSplatLaunchStateFile
+{
+    BugSplatMappedFile *_file;
+    BugSplatLaunchState _previousState;
+    BOOL _hasPreviousState;
+}
+
+- (instancetype)initWithPath:(NSString *)path
+{
+    if (self = [super init]) {
+        _path = [path copy];
+        // An update never has to allocate a page.
+        _file = [[BugSplatMappedFile alloc] initWithPath:path
+                                                    size:[BugSplatMappedFile pageAlignedSize:sizeof(BugSplatLaunchState)]
+                                                 options:BugSplatMappedFileOptionsNone
+                                                    name:@"launch state"];
+        if (!_file) {
+            return nil;
+        }
+
+        if (BugSplatLaunchStateIsValid(self.state)) {
+            memcpy(&_previousState, self.state, sizeof(_previousState));
+            _hasPreviousState = YES;
+        }
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    [self deactivate];
+}
+
+- (BugSplatLaunchState *)state
+{
+    return (BugSplatLaunchState *)_file.bytes;
+}
+
+- (const BugSplatLaunchState *)previousState
+{
+    return _hasPreviousState ? &_previousState : NULL;
+}
+
+- (void)beginLaunchWithAppVersion:(NSString *)appVersion
+{
+    BugSplatLaunchStateBegin(self.state, appVersion.UTF8String, [[self class] operatingSystemVersion].UTF8String,
+                             [[self class] now], [[self class] bootTime]);
+}
+
+- (void)recordMemoryFootprint
+{
+    task_vm_info_data_t info;
+    mach_msg_type_number_t count = TASK_VM_INFO_COUNT;
+    if (task_info(mach_task_self(), TASK_VM_INFO, (task_info_t)&info, &count) != KERN_SUCCESS) {
+        return;
+    }
+    uint64_t footprint = info.phys_footprint;
+    uint64_t limit = 0;
+#if TARGET_OS_IOS || TARGET_OS_TV
+    // What is left before the system terminates the app; 0 where there is no limit (e.g. simulator).
+    size_t available = os_proc_available_memory();
+    if (available > 0) {
+        limit = footprint + available;
+    }
+#endif
+    BugSplatLaunchStateRecordFootprint(self.state, footprint, limit, [[self class] now]);
+}
+
+- (void)activate
+{
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        atexit(BugSplatLaunchStateExitHandler);
+    });
+    atomic_store_explicit(&sBugSplatActiveLaunchState, self.state, memory_order_release);
+}
+
+- (void)deactivate
+{
+    BugSplatLaunchState *expected = self.state;
+    atomic_compare_exchange_strong(&sBugSplatActiveLaunchState, &expected, NULL);
+}
+
++ (uint64_t)now
+{
+    return (uint64_t)time(NULL);
+}
+
++ (uint64_t)bootTime
+{
+    struct timeval bootTime = { 0 };
+    size_t size = sizeof(bootTime);
+    int mib[2] = { CTL_KERN, KERN_BOOTTIME };
+    if (sysctl(mib, 2, &bootTime, &size, NULL, 0) != 0) {
+        return 0;
+    }
+    return (uint64_t)bootTime.tv_sec;
+}
+
++ (NSString *)operatingSystemVersion
+{
+    NSOperatingSystemVersion version = [NSProcessInfo processInfo].operatingSystemVersion;
+    char build[32] = "";
+    size_t buildLength = sizeof(build);
+    sysctlbyname("kern.osversion", build, &buildLength, NULL, 0);
+    return [NSString stringWithFormat:@"%ld.%ld.%ld (%s)", (long)version.majorVersion,
+            (long)version.minorVersion, (long)version.patchVersion, build];
+}
+
+@end
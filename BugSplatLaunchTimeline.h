@@ -0,0 +1,60 @@
+//
+//  BugSplatLaunchTimeline.h
+//
+//  Copyright © BugSplat, LLC. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// Points in a launch after the process started, in the order they normally happen.
+typedef NS_ENUM(NSUInteger, BugSplatLaunchMark) {
+    /// `-[BugSplat start]` was called.
+    BugSplatLaunchMarkStart = 0,
+    /// The main queue serviced its first block after `start`: the main thread is running its run loop.
+    BugSplatLaunchMarkFirstMainQueueBlock,
+    /// The app called `-[BugSplat markLaunchReady]`: it is ready to use.
+    BugSplatLaunchMarkReady,
+};
+
+/// Number of BugSplatLaunchMark values.
+static const NSUInteger BugSplatLaunchMarkCount = 3;
+
+/// Short name of a mark, e.g. `first-main-queue-block`.
+NSString *BugSplatLaunchMarkName(BugSplatLaunchMark mark);
+
+/**
+ * When each point of a launch was reached, relative to the process start time the kernel
+ * recorded (before dyld and static initializers ran). Each mark is recorded once; thread safe.
+ */
+@interface BugSplatLaunchTimeline : NSObject
+
+/// The current process's start time from the kernel, or nil if it cannot be read.
++ (nullable NSDate *)currentProcessStartDate;
+
+- (instancetype)initWithProcessStartDate:(NSDate *)processStartDate;
+- (instancetype)init NS_UNAVAILABLE;
+
+@property (nonatomic, readonly) NSDate *processStartDate;
+
+/**
+ * Record that the launch reached `mark` at `date`.
+ *
+ * @return NO if `mark` was already recorded (the first date is kept).
+ */
+- (BOOL)recordMark:(BugSplatLaunchMark)mark atDate:(NSDate *)date;
+
+/// Seconds from process start to `mark`, or a negative value if it has not been reached.
+- (NSTimeInterval)timeToMark:(BugSplatLaunchMark)mark;
+
+/**
+ * The timeline as text, one line per mark in the order reached with the time since process
+ * start and since the previous mark, e.g. `first-main-queue-block   2140 ms  (+1890 ms)`.
+ * Marks not reached are listed last as `not reached`.
+ */
+- (NSString *)timelineDescription;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,102 @@
+//
+//  BugSplatLaunchTimeline.m
+//
+//  Copyright © BugSplat, LLC. All rights reserved.
+//
+
+#import "BugSplatLaunchTimeline.h"
+
+#include <sys/sysctl.h>
+#include <unistd.h>
+
+NSString *BugSplatLaunchMarkName(BugSplatLaunchMark mark)
+{
+    switch (mark) {
+        case BugSplatLaunchMarkStart:
+            return @"start";
+        case BugSplatLaunchMarkFirstMainQueueBlock:
+            return @"first-main-queue-block";
+        case BugSplatLaunchMarkReady:
+            return @"ready";
+    }
+    return @"unknown";
+}
+
+@implementation BugSplatLaunchTimeline
+{
+    NSDate *_marks[BugSplatLaunchMarkCount];
+}
+
++ (NSDate *)currentProcessStartDate
+{
+    struct kinfo_proc info;
+    size_t size = sizeof(info);
+    int mib[4] = { CTL_KERN, KERN_PROC, KERN_PROC_PID, getpid() };
+    if (sysctl(mib, 4, &info, &size, NULL, 0) != 0 || size == 0) {
+        return nil;
+    }
+    struct timeval start = info.kp_proc.p_starttime;
+    return [NSDate dateWithTimeIntervalSince1970:(NSTimeInterval)start.tv_sec + (NSTimeInterval)start.tv_usec / USEC_PER_SEC];
+}
+
+- (instancetype)initWithProcessStartDate:(NSDate *)processStartDate
+{
+    if (self = [super init]) {
+        _processStartDate = processStartDate;
+    }
+    return self;
+}
+
+- (BOOL)recordMark:(BugSplatLaunchMark)mark atDate:(NSDate *)date
+{
+    if (mark >= BugSplatLaunchMarkCount) {
+        return NO;
+    }
+    @synchronized (self) {
+        if (_marks[mark]) {
+            return NO;
+        }
+        _marks[mark] = date;
+    }
+    return YES;
+}
+
+- (NSTimeInterval)timeToMark:(BugSplatLaunchMark)mark
+{
+    if (mark >= BugSplatLaunchMarkCount) {
+        return -1;
+    }
+    NSDate *date;
+    @synchronized (self) {
+        date = _marks[mark];
+    }
+    // A mark a clock adjustment put before the process start still counts as reached.
+    return date ? MAX([date timeIntervalSinceDate:_processStartDate], 0) : -1;
+}
+
+- (NSString *)timelineDescription
+{
+    NSMutableArray<NSNumber *> *reached = [NSMutableArray array];
+    NSMutableArray<NSNumber *> *pending = [NSMutableArray array];
+    for (NSUInteger mark = 0; mark < BugSplatLaunchMarkCount; mark++) {
+        [([self timeToMark:mark] >= 0 ? reached : pending) addObject:@(mark)];
+    }
+    [reached sortWithOptions:NSSortStable usingComparator:^NSComparisonResult(NSNumber *a, NSNumber *b) {
+        return [@([self timeToMark:a.unsignedIntegerValue]) compare:@([self timeToMark:b.unsignedIntegerValue])];
+    }];
+
+    NSMutableString *text = [NSMutableString stringWithFormat:@"%-24s %7d ms\n", "process-start", 0];
+    NSTimeInterval previous = 0;
+    for (NSNumber *mark in reached) {
+        NSTimeInterval time = [self timeToMark:mark.unsignedIntegerValue];
+        [text appendFormat:@"%-24s %7.0f ms  (+%.0f ms)\n", BugSplatLaunchMarkName(mark.unsignedIntegerValue).UTF8String,
+                           time * 1000.0, (time - previous) * 1000.0];
+        previous = time;
+    }
+    for (NSNumber *mark in pending) {
+        [text appendFormat:@"%-24s not reached\n", BugSplatLaunchMarkName(mark.unsignedIntegerValue).UTF8String];
+    }
+    return text;
+}
+
+@end
@@ -0,0 +1,45 @@
+//
+//  BugSplatLogBuffer.h
+//
+//  Append messages to the BugSplat log buffer from C, C++, Objective-C or Swift.
+//
+//  Copyright © BugSplat, LLC. All rights reserved.
+//
+
+#ifndef BugSplatLogBuffer_h
+#define BugSplatLogBuffer_h
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Append a message to the log buffer enabled with `BugSplat.enableLogBuffer`.
+ *
+ * The message is copied into a memory-mapped file that survives a crash; the newest
+ * messages are attached to the report of a crash or fatal hang on the next launch.
+ * Safe to call from any thread, including several at once: a write is one atomic add
+ * and a copy, and never takes a lock or allocates. Messages written before `-start`
+ * (or with the buffer disabled) are dropped.
+ *
+ * Each call is one record; a newline is added when the buffer is attached if the
+ * message does not end with one. Very long messages are truncated.
+ */
+void BugSplatLogBufferWrite(const char *bytes, size_t length);
+
+/// Append a NUL-terminated message. See `BugSplatLogBufferWrite`.
+void BugSplatLogBufferWriteString(const char *message);
+
+/**
+ * Format and append a message (at most 1 KB after formatting). Formatting happens on the
+ * calling thread; prefer `BugSplatLogBufferWrite` on hot paths.
+ */
+void BugSplatLogBufferPrintf(const char *format, ...) __attribute__((format(printf, 1, 2)));
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BugSplatLogBuffer_h */
@@ -0,0 +1,244 @@
+//
+//  BugSplatLogRing.c
+//
+//  Copyright © BugSplat, LLC. All rights reserved.
+//
+
+#include "BugSplatLogRing.h"
+
+#include <string.h>
+
+static const uint32_t kBugSplatLogRingMagic = 0x4C525342; // "BSRL", little-endian
+
+/// Smallest data capacity accepted; leaves room for records of a useful size.
+static const size_t kBugSplatLogRingMinimumCapacity = 256;
+
+typedef struct {
+    uint32_t length;
+    _Atomic(uint32_t) tag;
+} BugSplatLogRecordHeader;
+
+typedef struct {
+    uint32_t length;
+    uint32_t reserved;
+} BugSplatLogRecordTrailer;
+
+#pragma mark - Layout
+
+static size_t BugSplatLogRingAlign(size_t value)
+{
+    return (value + 7) & ~(size_t)7;
+}
+
+static uint64_t BugSplatLogRingRecordSize(size_t length)
+{
+    return sizeof(BugSplatLogRecordHeader) + BugSplatLogRingAlign(length) + sizeof(BugSplatLogRecordTrailer);
+}
+
+/// Non-zero tag identifying a record written at `position`, including its lap.
+static uint32_t BugSplatLogRingTag(uint64_t position)
+{
+    return (uint32_t)(position >> 3) + 1;
+}
+
+static void *BugSplatLogRingAt(const BugSplatLogRing *ring, uint64_t position)
+{
+    return ring->data + (size_t)(position % ring->capacity);
+}
+
+static void BugSplatLogRingCopyIn(BugSplatLogRing *ring, uint64_t position, const void *bytes, size_t length)
+{
+    size_t offset = (size_t)(position % ring->capacity);
+    size_t first = ring->capacity - offset < length ? ring->capacity - offset : length;
+    memcpy(ring->data + offset, bytes, first);
+    if (first < length) {
+        memcpy(ring->data, (const uint8_t *)bytes + first, length - first);
+    }
+}
+
+static void BugSplatLogRingCopyOut(const BugSplatLogRing *ring, uint64_t position, void *buffer, size_t length)
+{
+    size_t offset = (size_t)(position % ring->capacity);
+    size_t first = ring->capacity - offset < length ? ring->capacity - offset : length;
+    memcpy(buffer, ring->data + offset, first);
+    if (first < length) {
+        memcpy((uint8_t *)buffer + first, ring->data, length - first);
+    }
+}
+
+size_t BugSplatLogRingRegionSize(size_t capacity)
+{
+    return sizeof(BugSplatLogRingHeader) + BugSplatLogRingAlign(capacity);
+}
+
+#pragma mark - Setup
+
+static bool BugSplatLogRingBind(BugSplatLogRing *ring, void *region, size_t capacity)
+{
+    ring->header = (BugSplatLogRingHeader *)region;
+    ring->data = (uint8_t *)region + sizeof(BugSplatLogRingHeader);
+    ring->capacity = capacity;
+    return true;
+}
+
+bool BugSplatLogRingFormat(BugSplatLogRing *ring, void *region, size_t regionSize)
+{
+    memset(ring, 0, sizeof(*ring));
+    if (!region || regionSize < sizeof(BugSplatLogRingHeader) + kBugSplatLogRingMinimumCapacity) {
+        return false;
+    }
+    size_t capacity = (regionSize - sizeof(BugSplatLogRingHeader)) & ~(size_t)7;
+    if (capacity > UINT32_MAX) {
+        capacity = (size_t)UINT32_MAX & ~(size_t)7;
+    }
+
+    BugSplatLogRingHeader *header = (BugSplatLogRingHeader *)region;
+    header->magic = kBugSplatLogRingMagic;
+    header->version = BugSplatLogRingVersion;
+    header->capacity = (uint32_t)capacity;
+    header->reserved = 0;
+    BugSplatLogRingBind(ring, region, capacity);
+    BugSplatLogRingReset(ring);
+    return true;
+}
+
+bool BugSplatLogRingAttach(BugSplatLogRing *ring, void *region, size_t regionSize)
+{
+    memset(ring, 0, sizeof(*ring));
+    if (!region || regionSize < sizeof(BugSplatLogRingHeader)) {
+        return false;
+    }
+    const BugSplatLogRingHeader *header = (const BugSplatLogRingHeader *)region;
+    if (header->magic != kBugSplatLogRingMagic
+        || header->version != BugSplatLogRingVersion
+        || header->capacity < kBugSplatLogRingMinimumCapacity
+        || header->capacity % 8 != 0
+        || header->capacity > regionSize - sizeof(BugSplatLogRingHeader)) {
+        return false;
+    }
+    return BugSplatLogRingBind(ring, region, header->capacity);
+}
+
+void BugSplatLogRingReset(BugSplatLogRing *ring)
+{
+    if (!ring->header) {
+        return;
+    }
+    // Zeroed data cannot be mistaken for a record: a zero length ends the backward walk.
+    memset(ring->data, 0, ring->capacity);
+    atomic_store_explicit(&ring->header->head, 0, memory_order_release);
+}
+
+size_t BugSplatLogRingMaxMessageLength(const BugSplatLogRing *ring)
+{
+    return ring->capacity / 4 - sizeof(BugSplatLogRecordHeader) - sizeof(BugSplatLogRecordTrailer);
+}
+
+#pragma mark - Writing
+
+void BugSplatLogRingWrite(BugSplatLogRing *ring, const void *bytes, size_t length)
+{
+    if (!ring || !ring->header || !bytes || length == 0) {
+        return;
+    }
+    size_t maxLength = BugSplatLogRingMaxMessageLength(ring);
+    if (length > maxLength) {
+        length = maxLength;
+    }
+
+    uint64_t size = BugSplatLogRingRecordSize(length);
+    uint64_t start = atomic_fetch_add_explicit(&ring->header->head, size, memory_order_relaxed);
+
+    // Clear the tag before anything else so a crash mid-copy cannot publish a stale tag
+    // that happens to match; the lengths come next so readers can step over the record.
+    BugSplatLogRecordHeader *record = BugSplatLogRingAt(ring, start);
+    atomic_store_explicit(&record->tag, 0, memory_order_relaxed);
+    record->length = (uint32_t)length;
+    BugSplatLogRecordTrailer *trailer = BugSplatLogRingAt(ring, start + size - sizeof(BugSplatLogRecordTrailer));
+    trailer->length = (uint32_t)length;
+    trailer->reserved = 0;
+
+    BugSplatLogRingCopyIn(ring, start + sizeof(BugSplatLogRecordHeader), bytes, length);
+
+    atomic_store_explicit(&record->tag, BugSplatLogRingTag(start), memory_order_release);
+}
+
+#pragma mark - Reading
+
+/// Bytes a record contributes to CopyTail output: its payload plus a newline if missing.
+static size_t BugSplatLogRingOutputLength(const BugSplatLogRing *ring, uint64_t start, size_t length)
+{
+    uint8_t last = 0;
+    BugSplatLogRingCopyOut(ring, start + sizeof(BugSplatLogRecordHeader) + length - 1, &last, 1);
+    return last == '\n' ? length : length + 1;
+}
+
+static bool BugSplatLogRingIsPublished(const BugSplatLogRing *ring, uint64_t start)
+{
+    BugSplatLogRecordHeader *record = BugSplatLogRingAt(ring, start);
+    return atomic_load_explicit(&record->tag, memory_order_acquire) == BugSplatLogRingTag(start);
+}
+
+size_t BugSplatLogRingCopyTail(const BugSplatLogRing *ring, void *buffer, size_t bufferCapacity)
+{
+    if (!ring || !ring->header || !buffer || bufferCapacity == 0) {
+        return 0;
+    }
+    uint64_t head = atomic_load_explicit(&ring->header->head, memory_order_acquire);
+    uint64_t oldest = head > ring->capacity ? head - ring->capacity : 0;
+    size_t maxLength = BugSplatLogRingMaxMessageLength(ring);
+
+    // Walk back from head to find the oldest record that still fits the buffer.
+    uint64_t position = head;
+    uint64_t from = head;
+    size_t total = 0;
+    while (position - oldest >= BugSplatLogRingRecordSize(1)) {
+        const BugSplatLogRecordTrailer *trailer = BugSplatLogRingAt(ring, position - sizeof(BugSplatLogRecordTrailer));
+        size_t length = trailer->length;
+        if (length == 0 || length > maxLength) {
+            break;
+        }
+        uint64_t size = BugSplatLogRingRecordSize(length);
+        if (size > position - oldest) {
+            break;
+        }
+        uint64_t start = position - size;
+        const BugSplatLogRecordHeader *record = BugSplatLogRingAt(ring, start);
+        if (record->length != length) {
+            break;
+        }
+        if (BugSplatLogRingIsPublished(ring, start)) {
+            size_t outputLength = BugSplatLogRingOutputLength(ring, start, length);
+            if (outputLength > bufferCapacity - total) {
+                break;
+            }
+            total += outputLength;
+            from = start;
+        }
+        position = start;
+    }
+
+    // Copy forward, oldest first, over the same record boundaries.
+    uint8_t *output = buffer;
+    size_t copied = 0;
+    for (position = from; position < head;) {
+        const BugSplatLogRecordHeader *record = BugSplatLogRingAt(ring, position);
+        size_t length = record->length;
+        if (length == 0 || length > maxLength) {
+            break;
+        }
+        if (BugSplatLogRingIsPublished(ring, position)) {
+            size_t outputLength = BugSplatLogRingOutputLength(ring, position, length);
+            if (outputLength > bufferCapacity - copied) {
+                break;
+            }
+            BugSplatLogRingCopyOut(ring, position + sizeof(BugSplatLogRecordHeader), output + copied, length);
+            copied += length;
+            if (outputLength > length) {
+                output[copied++] = '\n';
+            }
+        }
+        position += BugSplatLogRingRecordSize(length);
+    }
+    return copied;
+}
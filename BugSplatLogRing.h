@@ -0,0 +1,109 @@
+//
+//  BugSplatLogRing.h
+//
+//  Fixed-size ring of log records that multiple threads append to without
+//  locks. Plain C over a caller-provided memory region, so the region can be
+//  a shared file mapping that outlives a crash, and the same code can be
+//  tested (and reused) on any platform with C11 atomics.
+//
+//  Copyright © BugSplat, LLC. All rights reserved.
+//
+
+#ifndef BugSplatLogRing_h
+#define BugSplatLogRing_h
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Region layout:
+ *
+ *   header:  magic, version, data capacity, then the write position `head`
+ *   data:    <capacity> bytes used as a ring
+ *
+ * `head` counts every byte ever reserved, so a record's position also tells
+ * which lap of the ring it was written in. Records are 8-byte aligned and never
+ * straddle the end of the ring except for their payload:
+ *
+ *   record:  <length:u32> <tag:u32> <payload> <padding to 8> <length:u32> <reserved:u32>
+ *
+ * A writer reserves a record with one atomic add on `head`, writes both
+ * lengths, copies the payload and finally publishes `tag` (derived from the
+ * record's position) with release ordering. Readers walk backwards from `head`
+ * using the trailing length and accept a record only when both lengths agree
+ * and the tag matches its position; records that were reserved but never
+ * published (the writer crashed mid-copy) are skipped.
+ *
+ * If writers lap the ring while another writer is still copying, that
+ * writer's record - and at most the record it overlaps - may be lost. Messages
+ * are truncated to a quarter of the capacity so this needs several large
+ * writes during one copy.
+ */
+#define BugSplatLogRingVersion 1
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t capacity;
+    uint32_t reserved;
+    _Atomic(uint64_t) head;
+} BugSplatLogRingHeader;
+
+typedef struct {
+    BugSplatLogRingHeader *header;
+    uint8_t *data;
+    size_t capacity;
+} BugSplatLogRing;
+
+/// Region size needed for a ring holding `capacity` bytes of records (rounded up to 8).
+size_t BugSplatLogRingRegionSize(size_t capacity);
+
+/**
+ * Initialize an empty ring in `region`, discarding anything in it.
+ *
+ * @return false if `regionSize` is too small for a header and one minimal record.
+ */
+bool BugSplatLogRingFormat(BugSplatLogRing *ring, void *region, size_t regionSize);
+
+/**
+ * Use a ring previously formatted in `region` (e.g. a file written by an earlier process).
+ *
+ * @return false if the region does not hold a ring of this version that fits `regionSize`.
+ */
+bool BugSplatLogRingAttach(BugSplatLogRing *ring, void *region, size_t regionSize);
+
+/// Drop every record. Must not race with writers.
+void BugSplatLogRingReset(BugSplatLogRing *ring);
+
+/// Longest payload a single record keeps; longer messages are truncated.
+size_t BugSplatLogRingMaxMessageLength(const BugSplatLogRing *ring);
+
+/**
+ * Append one record. Lock-free and safe to call from any number of threads;
+ * does not allocate. Empty messages are ignored.
+ */
+void BugSplatLogRingWrite(BugSplatLogRing *ring, const void *bytes, size_t length);
+
+/**
+ * Copy the newest complete records, oldest first, into `buffer`. Each record
+ * is followed by a newline unless its payload already ends with one. Only
+ * whole records are copied; the result is at most `bufferCapacity` bytes.
+ *
+ * Intended for a ring with no active writers (a previous session's file);
+ * records written concurrently may be skipped.
+ *
+ * @return Number of bytes copied.
+ */
+size_t BugSplatLogRingCopyTail(const BugSplatLogRing *ring, void *buffer, size_t bufferCapacity);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BugSplatLogRing_h */
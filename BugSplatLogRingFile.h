@@ -0,0 +1,61 @@
+//
+//  BugSplatLogRingFile.h
+//
+//  Copyright © BugSplat, LLC. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * A `BugSplatLogRing` in a memory-mapped file.
+ *
+ * The file is created at full size and its pages are faulted in when it is opened, so
+ * writing a message is a copy into the shared mapping; the kernel keeps the pages when
+ * the process crashes or is killed, and the next launch reads them back from the file.
+ *
+ * One file at a time can be made active for `BugSplatLogBufferWrite` and friends.
+ */
+@interface BugSplatLogRingFile : NSObject
+
+/**
+ * Open (creating if needed) a ring file holding `capacity` bytes of records and map it
+ * read-write. A ring of the same capacity already in the file is kept; anything else is
+ * reformatted.
+ *
+ * @return nil if the file cannot be created, sized or mapped.
+ */
+- (nullable instancetype)initWithPath:(NSString *)path capacity:(size_t)capacity NS_DESIGNATED_INITIALIZER;
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ * The newest complete records of the ring file at `path`, oldest first, one per line and
+ * at most `maxLength` bytes. Reads the file without mapping it for writing.
+ *
+ * @return nil if there is no ring at `path` or it holds no records.
+ */
++ (nullable NSData *)tailOfFileAtPath:(NSString *)path maxLength:(size_t)maxLength;
+
+@property (nonatomic, copy, readonly) NSString *path;
+/// Bytes of records the ring holds, including per-record overhead.
+@property (nonatomic, assign, readonly) size_t capacity;
+
+/// Append one record. See `BugSplatLogBufferWrite`.
+- (void)writeBytes:(const void *)bytes length:(size_t)length;
+
+/// The newest records, as for `tailOfFileAtPath:maxLength:`.
+- (nullable NSData *)tailWithMaxLength:(size_t)maxLength;
+
+/// Drop every record. Must not race with writers.
+- (void)reset;
+
+/// Route the global `BugSplatLogBuffer` functions to this file. The file must stay alive while active.
+- (void)activate;
+
+/// Stop routing the global functions to this file, if it is active.
+- (void)deactivate;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,140 @@
+//
+//  BugSplatLogRingFile.m
+//
+//  Copyright © BugSplat, LLC. All rights reserved.
+//
+
+#import "BugSplatLogRingFile.h"
+#import "BugSplatLogBuffer.h"
+#import "BugSplatLogRing.h"
+#import "BugSplatLogging.h"
+#import "BugSplatMappedFile.h"
+
+#import <stdarg.h>
+#import <stdatomic.h>
+#import <stdio.h>
+#import <string.h>
+
+/// Ring the BugSplatLogBuffer functions write to; NULL until a file is activated.
+static _Atomic(BugSplatLogRing *) sBugSplatActiveLogRing = NULL;
+
+#pragma mark - BugSplatLogBuffer
+
+void BugSplatLogBufferWrite(const char *bytes, size_t length)
+{
+    BugSplatLogRing *ring = atomic_load_explicit(&sBugSplatActiveLogRing, memory_order_acquire);
+    if (ring) {
+        BugSplatLogRingWrite(ring, bytes, length);
+    }
+}
+
+void BugSplatLogBufferWriteString(const char *message)
+{
+    if (message) {
+        BugSplatLogBufferWrite(message, strlen(message));
+    }
+}
+
+void BugSplatLogBufferPrintf(const char *format, ...)
+{
+    if (!format || !atomic_load_explicit(&sBugSplatActiveLogRing, memory_order_relaxed)) {
+        return;
+    }
+    char message[1024];
+    va_list arguments;
+    va_start(arguments, format);
+    int length = vsnprintf(message, sizeof(message), format, arguments);
+    va_end(arguments);
+    if (length > 0) {
+        BugSplatLogBufferWrite(message, MIN((size_t)length, sizeof(message) - 1));
+    }
+}
+
+#pragma mark - BugSplatLogRingFile
+
+@implementation BugSplatLogRingFile
+{
+    BugSplatMappedFile *_file;
+    BugSplatLogRing _ring;
+}
+
+- (instancetype)initWithPath:(NSString *)path capacity:(size_t)capacity
+{
+    if (self = [super init]) {
+        _path = [path copy];
+        // No page has to be allocated or faulted in while logging; a larger buffer's
+        // leftovers are dropped.
+        _file = [[BugSplatMappedFile alloc] initWithPath:path
+                                                    size:BugSplatLogRingRegionSize(capacity)
+                                                 options:BugSplatMappedFileOptionsTruncate | BugSplatMappedFileOptionsPrefault
+                                                    name:@"log buffer"];
+        if (!_file) {
+            return nil;
+        }
+
+        if (!BugSplatLogRingAttach(&_ring, _file.bytes, _file.size) || _ring.capacity != _file.size - sizeof(BugSplatLogRingHeader)) {
+            if (!BugSplatLogRingFormat(&_ring, _file.bytes, _file.size)) {
+                BugSplatLogError(@"Log buffer capacity %zu is too small", capacity);
+                return nil;
+            }
+        }
+        _capacity = _ring.capacity;
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    [self deactivate];
+}
+
++ (NSData *)tailOfFileAtPath:(NSString *)path maxLength:(size_t)maxLength
+{
+    NSData *contents = [NSData dataWithContentsOfFile:path options:NSDataReadingMappedIfSafe error:nil];
+    BugSplatLogRing ring;
+    // CopyTail only reads, so the read-only mapping is safe to hand over.
+    if (!contents || !BugSplatLogRingAttach(&ring, (void *)contents.bytes, contents.length)) {
+        return nil;
+    }
+    return [self tailOfRing:&ring maxLength:maxLength];
+}
+
++ (NSData *)tailOfRing:(const BugSplatLogRing *)ring maxLength:(size_t)maxLength
+{
+    // Output is never larger than the ring itself.
+    NSMutableData *tail = [NSMutableData dataWithLength:MIN(maxLength, ring->capacity)];
+    size_t length = BugSplatLogRingCopyTail(ring, tail.mutableBytes, tail.length);
+    if (length == 0) {
+        return nil;
+    }
+    tail.length = length;
+    return tail;
+}
+
+- (void)writeBytes:(const void *)bytes length:(size_t)length
+{
+    BugSplatLogRingWrite(&_ring, bytes, length);
+}
+
+- (NSData *)tailWithMaxLength:(size_t)maxLength
+{
+    return [[self class] tailOfRing:&_ring maxLength:maxLength];
+}
+
+- (void)reset
+{
+    BugSplatLogRingReset(&_ring);
+}
+
+- (void)activate
+{
+    atomic_store_explicit(&sBugSplatActiveLogRing, &_ring, memory_order_release);
+}
+
+- (void)deactivate
+{
+    BugSplatLogRing *expected = &_ring;
+    atomic_compare_exchange_strong(&sBugSplatActiveLogRing, &expected, NULL);
+}
+
+@end
@@ -0,0 +1,60 @@
+//
+//  BugSplatLogging.h
+//
+//  Leveled logging for the SDK's own diagnostics. Every message goes through
+//  one of the macros below, which check the level before any argument is
+//  evaluated or formatted. Debug messages are compiled out entirely unless
+//  BUGSPLAT_LOG_DEBUG is non-zero (the default in DEBUG builds).
+//
+//  Copyright © BugSplat, LLC. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import <BugSplat/BugSplat.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+#ifndef BUGSPLAT_LOG_DEBUG
+#if DEBUG
+#define BUGSPLAT_LOG_DEBUG 1
+#else
+#define BUGSPLAT_LOG_DEBUG 0
+#endif
+#endif
+
+/// Backing storage for `BugSplat.logLevel` and `BugSplat.logHandler`.
+FOUNDATION_EXPORT BugSplatLogLevel BugSplatLogGetLevel(void);
+FOUNDATION_EXPORT void BugSplatLogSetLevel(BugSplatLogLevel level);
+FOUNDATION_EXPORT _Nullable BugSplatLogHandler BugSplatLogGetHandler(void);
+FOUNDATION_EXPORT void BugSplatLogSetHandler(_Nullable BugSplatLogHandler handler);
+
+/// YES if messages of `level` pass the current `BugSplat.logLevel`.
+FOUNDATION_EXPORT BOOL BugSplatLogIsEnabled(BugSplatLogLevel level);
+
+/// Format and deliver a message to `BugSplat.logHandler`, or to the unified log. Use the macros instead.
+FOUNDATION_EXPORT void BugSplatLogEmit(BugSplatLogLevel level, NSString *format, ...) NS_FORMAT_FUNCTION(2, 3);
+
+#define BugSplatLogAtLevel(level, format, ...) \
+    do { \
+        if (BugSplatLogIsEnabled(level)) { \
+            BugSplatLogEmit(level, format, ##__VA_ARGS__); \
+        } \
+    } while (0)
+
+#define BugSplatLogError(format, ...) BugSplatLogAtLevel(BugSplatLogLevelError, format, ##__VA_ARGS__)
+#define BugSplatLogWarning(format, ...) BugSplatLogAtLevel(BugSplatLogLevelWarning, format, ##__VA_ARGS__)
+#define BugSplatLogInfo(format, ...) BugSplatLogAtLevel(BugSplatLogLevelInfo, format, ##__VA_ARGS__)
+
+#if BUGSPLAT_LOG_DEBUG
+#define BugSplatLogDebug(format, ...) BugSplatLogAtLevel(BugSplatLogLevelDebug, format, ##__VA_ARGS__)
+#else
+// Still type-checked, so arguments stay "used", but no code is generated.
+#define BugSplatLogDebug(format, ...) \
+    do { \
+        if (0) { \
+            BugSplatLogEmit(BugSplatLogLevelDebug, format, ##__VA_ARGS__); \
+        } \
+    } while (0)
+#endif
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,82 @@
+//
+//  BugSplatLogging.m
+//
+//  Copyright © BugSplat, LLC. All rights reserved.
+//
+
+#import "BugSplatLogging.h"
+
+#import <os/lock.h>
+#import <os/log.h>
+#import <stdatomic.h>
+
+static _Atomic(NSInteger) sBugSplatLogLevel = BugSplatLogLevelWarning;
+
+static os_unfair_lock sBugSplatLogHandlerLock = OS_UNFAIR_LOCK_INIT;
+static BugSplatLogHandler sBugSplatLogHandler = nil;
+
+BugSplatLogLevel BugSplatLogGetLevel(void)
+{
+    return (BugSplatLogLevel)atomic_load_explicit(&sBugSplatLogLevel, memory_order_relaxed);
+}
+
+void BugSplatLogSetLevel(BugSplatLogLevel level)
+{
+    atomic_store_explicit(&sBugSplatLogLevel, level, memory_order_relaxed);
+}
+
+BugSplatLogHandler BugSplatLogGetHandler(void)
+{
+    os_unfair_lock_lock(&sBugSplatLogHandlerLock);
+    BugSplatLogHandler handler = sBugSplatLogHandler;
+    os_unfair_lock_unlock(&sBugSplatLogHandlerLock);
+    return handler;
+}
+
+void BugSplatLogSetHandler(BugSplatLogHandler handler)
+{
+    BugSplatLogHandler copied = [handler copy];
+    os_unfair_lock_lock(&sBugSplatLogHandlerLock);
+    sBugSplatLogHandler = copied;
+    os_unfair_lock_unlock(&sBugSplatLogHandlerLock);
+}
+
+BOOL BugSplatLogIsEnabled(BugSplatLogLevel level)
+{
+    return level != BugSplatLogLevelNone && level <= BugSplatLogGetLevel();
+}
+
+static os_log_type_t BugSplatOSLogType(BugSplatLogLevel level)
+{
+    switch (level) {
+        case BugSplatLogLevelError:
+            return OS_LOG_TYPE_ERROR;
+        case BugSplatLogLevelInfo:
+            return OS_LOG_TYPE_INFO;
+        case BugSplatLogLevelDebug:
+            return OS_LOG_TYPE_DEBUG;
+        default:
+            return OS_LOG_TYPE_DEFAULT;
+    }
+}
+
+void BugSplatLogEmit(BugSplatLogLevel level, NSString *format, ...)
+{
+    va_list arguments;
+    va_start(arguments, format);
+    NSString *message = [[NSString alloc] initWithFormat:format arguments:arguments];
+    va_end(arguments);
+
+    BugSplatLogHandler handler = BugSplatLogGetHandler();
+    if (handler) {
+        handler(level, message);
+        return;
+    }
+
+    static os_log_t log;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        log = os_log_create("com.bugsplat", "BugSplat");
+    });
+    os_log_with_type(log, BugSplatOSLogType(level), "BugSplat: %{public}@", message);
+}
@@ -11,5 +11,7 @@
 #import <BugSplat/BugSplat.h>
 #import <BugSplat/BugSplatDelegate.h>
 #import <BugSplat/BugSplatAttachment.h>
+#import <BugSplat/BugSplatLogBuffer.h>
+#import <BugSplat/BugSplatHangHeartbeat.h>
 
 #endif /* BugSplatMac_h */
@@ -0,0 +1,54 @@
+//
+//  BugSplatMappedFile.h
+//
+//  Copyright © BugSplat, LLC. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+typedef NS_OPTIONS(NSUInteger, BugSplatMappedFileOptions) {
+    BugSplatMappedFileOptionsNone = 0,
+    /// Drop anything beyond `size` left in the file by a larger earlier mapping.
+    BugSplatMappedFileOptionsTruncate = 1 << 0,
+    /// Fault every page in when the file is opened, so the first write to each does not.
+    BugSplatMappedFileOptionsPrefault = 1 << 1,
+};
+
+/**
+ * A file of fixed size mapped read-write and shared, the storage under the ring buffers,
+ * hang report slot, latency histogram and launch state sentinel.
+ *
+ * The file is sized with real zeros rather than ftruncate, so its blocks exist before anything
+ * is written to the mapping and a write during a crash or hang never has to allocate one.
+ * Because the mapping is shared, what is written survives the process being killed without
+ * an explicit flush. The mapping is removed and the file closed when the receiver is released.
+ */
+@interface BugSplatMappedFile : NSObject
+
+/**
+ * Open (creating if needed) the file at `path`, grow it to `size` bytes and map it.
+ *
+ * @param name What the file holds, for log messages (e.g. "log buffer").
+ * @return nil if the file cannot be created, sized or mapped.
+ */
+- (nullable instancetype)initWithPath:(NSString *)path
+                                 size:(size_t)size
+                              options:(BugSplatMappedFileOptions)options
+                                 name:(NSString *)name NS_DESIGNATED_INITIALIZER;
+- (instancetype)init NS_UNAVAILABLE;
+
+/// `size` rounded up to a whole number of pages.
++ (size_t)pageAlignedSize:(size_t)size;
+
+/// The mapping; valid for the lifetime of the receiver.
+@property (nonatomic, readonly) void *bytes;
+@property (nonatomic, readonly) size_t size;
+
+/// Ask the kernel to start writing dirty pages back, without waiting.
+- (void)syncAsynchronously;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,95 @@
+//
+//  BugSplatMappedFile.m
+//
+//  Copyright © BugSplat, LLC. All rights reserved.
+//
+
+#import "BugSplatMappedFile.h"
+#import "BugSplatLogging.h"
+
+#import <fcntl.h>
+#import <string.h>
+#import <sys/mman.h>
+#import <sys/stat.h>
+#import <unistd.h>
+
+@implementation BugSplatMappedFile
+{
+    int _fd;
+}
+
+- (instancetype)initWithPath:(NSString *)path
+                        size:(size_t)size
+                     options:(BugSplatMappedFileOptions)options
+                        name:(NSString *)name
+{
+    if (self = [super init]) {
+        _size = size;
+        _fd = open(path.fileSystemRepresentation, O_RDWR | O_CREAT, 0600);
+        if (_fd < 0) {
+            BugSplatLogError(@"Failed to open %@: %s", name, strerror(errno));
+            return nil;
+        }
+
+        struct stat info;
+        if (fstat(_fd, &info) != 0) {
+            return nil;
+        }
+        if ((options & BugSplatMappedFileOptionsTruncate) && (size_t)info.st_size > size
+            && ftruncate(_fd, (off_t)size) != 0) {
+            return nil;
+        }
+        if ((size_t)info.st_size < size) {
+            static const uint8_t zeros[16 * 1024] = { 0 };
+            off_t offset = info.st_size;
+            while ((size_t)offset < size) {
+                size_t chunk = MIN(sizeof(zeros), size - (size_t)offset);
+                ssize_t written = pwrite(_fd, zeros, chunk, offset);
+                if (written <= 0) {
+                    BugSplatLogError(@"Failed to size %@: %s", name, strerror(errno));
+                    return nil;
+                }
+                offset += written;
+            }
+        }
+
+        void *mapping = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0);
+        if (mapping == MAP_FAILED) {
+            BugSplatLogError(@"Failed to map %@: %s", name, strerror(errno));
+            return nil;
+        }
+        _bytes = mapping;
+
+        if (options & BugSplatMappedFileOptionsPrefault) {
+            long pageSize = sysconf(_SC_PAGESIZE);
+            for (size_t offset = 0; offset < size; offset += (size_t)pageSize) {
+                volatile uint8_t touch = ((uint8_t *)_bytes)[offset];
+                (void)touch;
+            }
+        }
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    if (_bytes) {
+        munmap(_bytes, _size);
+    }
+    if (_fd >= 0) {
+        close(_fd);
+    }
+}
+
++ (size_t)pageAlignedSize:(size_t)size
+{
+    size_t pageSize = (size_t)sysconf(_SC_PAGESIZE);
+    return (size + pageSize - 1) & ~(pageSize - 1);
+}
+
+- (void)syncAsynchronously
+{
+    msync(_bytes, _size, MS_ASYNC);
+}
+
+@end
@@ -0,0 +1,41 @@
+//
+//  BugSplatMetadataCodec.h
+//
+//  Copyright © BugSplat, LLC. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+@class BugSplatAttachment;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * Foundation-facing wrapper around the compact binary format in BugSplatBinaryMetadata.h.
+ *
+ * Used for three payloads that were previously property lists or keyed archives:
+ *  - per-crash `.meta` files (formerly XML plists),
+ *  - crash-time properties stored in PLCrashReporter `customData` (formerly NSKeyedArchiver),
+ *  - persisted `.data` attachment files (formerly NSKeyedArchiver).
+ *
+ * Migration: every decode method also accepts the legacy encoding, so reports written by an
+ * older SDK (or embedded in a crash that happened before an update) are still read. Legacy
+ * `.meta` files are rewritten in the binary format the next time their metadata is persisted.
+ *
+ * Supported metadata value types: NSString, NSNumber (booleans, integers, doubles), NSData and
+ * NSDictionary<NSString *, NSString *>. Values of any other type are skipped when encoding.
+ */
+@interface BugSplatMetadataCodec : NSObject
+
++ (nullable NSData *)dataWithMetadata:(NSDictionary<NSString *, id> *)metadata;
++ (nullable NSDictionary<NSString *, id> *)metadataWithData:(NSData *)data;
+
++ (BOOL)writeMetadata:(NSDictionary<NSString *, id> *)metadata toFile:(NSString *)path;
++ (nullable NSDictionary<NSString *, id> *)metadataWithContentsOfFile:(NSString *)path;
+
++ (nullable NSData *)dataWithAttachment:(BugSplatAttachment *)attachment;
++ (nullable BugSplatAttachment *)attachmentWithData:(NSData *)data;
+
+@end
+
+NS_ASSUME_NONNULL_END
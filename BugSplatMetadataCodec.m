@@ -0,0 +1,370 @@
+//
+//  BugSplatMetadataCodec.m
+//
+//  Copyright © BugSplat, LLC. All rights reserved.
+//
+
+#import "BugSplatMetadataCodec.h"
+#import "BugSplatAttachment.h"
+#import "BugSplatBinaryMetadata.h"
+#import "BugSplatLogging.h"
+
+// Field keys used for persisted attachments.
+static const char *const kBugSplatAttachmentFieldFilename = "filename";
+static const char *const kBugSplatAttachmentFieldContentType = "contentType";
+static const char *const kBugSplatAttachmentFieldData = "data";
+
+// Metadata rarely exceeds a few hundred bytes; encode into a stack buffer first and
+// only fall back to a heap buffer sized by the measuring pass when it doesn't fit.
+static const size_t kBugSplatMetaStackBufferSize = 4096;
+
+static inline NSString *BugSplatStringFromBytes(const void *bytes, size_t length)
+{
+    return [[NSString alloc] initWithBytes:bytes length:length encoding:NSUTF8StringEncoding];
+}
+
+/// A string's UTF-8 bytes. Short strings stay in `stack`; longer ones are copied to the heap.
+typedef struct {
+    char stack[256];
+    char *heap;
+    const char *bytes;
+    size_t length;
+} BugSplatMetaUTF8;
+
+/**
+ * Load `string`'s full UTF-8 encoding into `utf8`. Unlike UTF8String and strlen, this keeps
+ * everything after an embedded NUL character. Release with BugSplatMetaUTF8Free.
+ */
+static void BugSplatMetaUTF8Load(BugSplatMetaUTF8 *utf8, NSString *string)
+{
+    NSUInteger capacity = [string lengthOfBytesUsingEncoding:NSUTF8StringEncoding];
+    char *bytes = utf8->stack;
+    utf8->heap = NULL;
+    if (capacity > sizeof(utf8->stack)) {
+        bytes = utf8->heap = malloc(capacity);
+    }
+    NSUInteger used = 0;
+    if (bytes) {
+        [string getBytes:bytes
+               maxLength:capacity
+              usedLength:&used
+                encoding:NSUTF8StringEncoding
+                 options:0
+                   range:NSMakeRange(0, string.length)
+          remainingRange:NULL];
+    }
+    utf8->bytes = bytes ?: "";
+    utf8->length = used;
+}
+
+static void BugSplatMetaUTF8Free(BugSplatMetaUTF8 *utf8)
+{
+    free(utf8->heap);
+    utf8->heap = NULL;
+}
+
+@implementation BugSplatMetadataCodec
+
+#pragma mark - Metadata
+
+/// Writes every supported entry of `metadata`. Called twice when the stack buffer is too small.
++ (void)writeMetadata:(NSDictionary<NSString *, id> *)metadata toWriter:(BugSplatMetaWriter *)writer
+{
+    [metadata enumerateKeysAndObjectsUsingBlock:^(NSString *key, id value, BOOL *stop) {
+        if (![key isKindOfClass:[NSString class]]) {
+            return;
+        }
+        BugSplatMetaUTF8 keyUTF8;
+        BugSplatMetaUTF8Load(&keyUTF8, key);
+        const char *keyBytes = keyUTF8.bytes;
+        size_t keyLength = keyUTF8.length;
+
+        if ([value isKindOfClass:[NSString class]]) {
+            BugSplatMetaUTF8 valueUTF8;
+            BugSplatMetaUTF8Load(&valueUTF8, value);
+            BugSplatMetaWriteString(writer, keyBytes, keyLength, valueUTF8.bytes, valueUTF8.length);
+            BugSplatMetaUTF8Free(&valueUTF8);
+        } else if ([value isKindOfClass:[NSNumber class]]) {
+            NSNumber *number = value;
+            const char *objCType = number.objCType;
+            if (CFGetTypeID((__bridge CFTypeRef)number) == CFBooleanGetTypeID()) {
+                BugSplatMetaWriteBool(writer, keyBytes, keyLength, number.boolValue);
+            } else if (strcmp(objCType, @encode(double)) == 0 || strcmp(objCType, @encode(float)) == 0) {
+                BugSplatMetaWriteDouble(writer, keyBytes, keyLength, number.doubleValue);
+            } else {
+                BugSplatMetaWriteInteger(writer, keyBytes, keyLength, number.longLongValue);
+            }
+        } else if ([value isKindOfClass:[NSData class]]) {
+            NSData *data = value;
+            BugSplatMetaWriteBytes(writer, keyBytes, keyLength, data.bytes, data.length);
+        } else if ([value isKindOfClass:[NSDictionary class]]) {
+            NSDictionary *map = value;
+            __block size_t count = 0;
+            __block size_t bodyLength = 0;
+            [map enumerateKeysAndObjectsUsingBlock:^(id mapKey, id mapValue, BOOL *innerStop) {
+                if ([mapKey isKindOfClass:[NSString class]] && [mapValue isKindOfClass:[NSString class]]) {
+                    count++;
+                    bodyLength += BugSplatMetaMapEntryLength([mapKey lengthOfBytesUsingEncoding:NSUTF8StringEncoding],
+                                                             [mapValue lengthOfBytesUsingEncoding:NSUTF8StringEncoding]);
+                }
+            }];
+            BugSplatMetaWriteMapHeader(writer, keyBytes, keyLength, count, bodyLength);
+            [map enumerateKeysAndObjectsUsingBlock:^(id mapKey, id mapValue, BOOL *innerStop) {
+                if ([mapKey isKindOfClass:[NSString class]] && [mapValue isKindOfClass:[NSString class]]) {
+                    BugSplatMetaUTF8 k;
+                    BugSplatMetaUTF8 v;
+                    BugSplatMetaUTF8Load(&k, mapKey);
+                    BugSplatMetaUTF8Load(&v, mapValue);
+                    BugSplatMetaWriteMapEntry(writer, k.bytes, k.length, v.bytes, v.length);
+                    BugSplatMetaUTF8Free(&k);
+                    BugSplatMetaUTF8Free(&v);
+                }
+            }];
+        }
+        BugSplatMetaUTF8Free(&keyUTF8);
+    }];
+}
+
++ (NSData *)dataWithMetadata:(NSDictionary<NSString *, id> *)metadata
+{
+    if (!metadata) {
+        return nil;
+    }
+
+    uint8_t stackBuffer[kBugSplatMetaStackBufferSize];
+    BugSplatMetaWriter writer;
+    BugSplatMetaWriterInit(&writer, stackBuffer, sizeof(stackBuffer));
+    [self writeMetadata:metadata toWriter:&writer];
+    if (!writer.overflow) {
+        return [NSData dataWithBytes:stackBuffer length:writer.length];
+    }
+
+    NSMutableData *data = [NSMutableData dataWithLength:writer.length];
+    BugSplatMetaWriterInit(&writer, data.mutableBytes, data.length);
+    [self writeMetadata:metadata toWriter:&writer];
+    if (writer.overflow) {
+        // Metadata mutated between passes; the caller should retry with a stable snapshot.
+        return nil;
+    }
+    data.length = writer.length;
+    return data;
+}
+
++ (NSDictionary<NSString *, id> *)metadataWithData:(NSData *)data
+{
+    if (data.length == 0) {
+        return nil;
+    }
+
+    BugSplatMetaReader reader;
+    BugSplatMetaResult result = BugSplatMetaReaderInit(&reader, data.bytes, data.length);
+    if (result == BugSplatMetaResultNotEncoded) {
+        return [self legacyMetadataWithData:data];
+    }
+    if (result != BugSplatMetaResultOK) {
+        BugSplatLogError(@"Unsupported metadata format version");
+        return nil;
+    }
+
+    NSMutableDictionary<NSString *, id> *metadata = [NSMutableDictionary dictionary];
+    BugSplatMetaField field;
+    while ((result = BugSplatMetaReaderNext(&reader, &field)) == BugSplatMetaResultOK) {
+        NSString *key = BugSplatStringFromBytes(field.key, field.keyLength);
+        if (!key) {
+            continue;
+        }
+        id value = nil;
+        switch (field.type) {
+            case BugSplatMetaTypeString:
+                value = BugSplatStringFromBytes(field.value, field.valueLength);
+                break;
+            case BugSplatMetaTypeBool: {
+                bool boolValue = false;
+                if (BugSplatMetaFieldGetBool(&field, &boolValue)) {
+                    value = @(boolValue ? YES : NO);
+                }
+                break;
+            }
+            case BugSplatMetaTypeInteger: {
+                int64_t integerValue = 0;
+                if (BugSplatMetaFieldGetInteger(&field, &integerValue)) {
+                    value = @(integerValue);
+                }
+                break;
+            }
+            case BugSplatMetaTypeDouble: {
+                double doubleValue = 0;
+                if (BugSplatMetaFieldGetDouble(&field, &doubleValue)) {
+                    value = @(doubleValue);
+                }
+                break;
+            }
+            case BugSplatMetaTypeBytes:
+                value = [NSData dataWithBytes:field.value length:field.valueLength];
+                break;
+            case BugSplatMetaTypeMap:
+                value = [self mapWithField:&field];
+                break;
+            default:
+                // Unknown field types from a newer minor revision are skipped.
+                break;
+        }
+        if (value) {
+            metadata[key] = value;
+        }
+    }
+
+    if (result == BugSplatMetaResultMalformed) {
+        BugSplatLogWarning(@"Malformed metadata; keeping %lu decoded field(s)", (unsigned long)metadata.count);
+    }
+    return metadata;
+}
+
++ (NSDictionary<NSString *, NSString *> *)mapWithField:(const BugSplatMetaField *)field
+{
+    BugSplatMetaReader mapReader;
+    size_t count = 0;
+    if (BugSplatMetaMapReaderInit(&mapReader, field, &count) != BugSplatMetaResultOK) {
+        return nil;
+    }
+
+    NSMutableDictionary<NSString *, NSString *> *map = [NSMutableDictionary dictionaryWithCapacity:count];
+    const char *key = NULL;
+    const char *value = NULL;
+    size_t keyLength = 0;
+    size_t valueLength = 0;
+    while (BugSplatMetaMapReaderNext(&mapReader, &key, &keyLength, &value, &valueLength) == BugSplatMetaResultOK) {
+        NSString *keyString = BugSplatStringFromBytes(key, keyLength);
+        NSString *valueString = BugSplatStringFromBytes(value, valueLength);
+        if (keyString && valueString) {
+            map[keyString] = valueString;
+        }
+    }
+    return map;
+}
+
+/// Decodes metadata written by SDK versions that predate the binary format: XML plists for
+/// `.meta` files and NSKeyedArchiver archives for PLCrashReporter customData.
++ (NSDictionary<NSString *, id> *)legacyMetadataWithData:(NSData *)data
+{
+    id plist = nil;
+    @try {
+        plist = [NSPropertyListSerialization propertyListWithData:data
+                                                          options:NSPropertyListImmutable
+                                                           format:NULL
+                                                            error:nil];
+    } @catch (NSException *exception) {
+        BugSplatLogError(@"Exception decoding legacy metadata: %@ - %@", exception.name, exception.reason);
+        return nil;
+    }
+
+    if (![plist isKindOfClass:[NSDictionary class]]) {
+        return nil;
+    }
+
+    // Keyed archives are binary plists too; unwrap them instead of returning the archive graph.
+    if (plist[@"$archiver"]) {
+        NSSet *classes = [NSSet setWithObjects:[NSDictionary class], [NSString class], [NSNumber class], [NSData class], nil];
+        @try {
+            id unarchived = [NSKeyedUnarchiver unarchivedObjectOfClasses:classes fromData:data error:nil];
+            return [unarchived isKindOfClass:[NSDictionary class]] ? unarchived : nil;
+        } @catch (NSException *exception) {
+            BugSplatLogError(@"Exception unarchiving legacy metadata: %@ - %@", exception.name, exception.reason);
+            return nil;
+        }
+    }
+
+    return plist;
+}
+
++ (BOOL)writeMetadata:(NSDictionary<NSString *, id> *)metadata toFile:(NSString *)path
+{
+    NSData *data = [self dataWithMetadata:metadata];
+    if (!data) {
+        return NO;
+    }
+    return [data writeToFile:path atomically:YES];
+}
+
++ (NSDictionary<NSString *, id> *)metadataWithContentsOfFile:(NSString *)path
+{
+    NSData *data = [NSData dataWithContentsOfFile:path options:NSDataReadingMappedIfSafe error:nil];
+    if (!data) {
+        return nil;
+    }
+    return [self metadataWithData:data];
+}
+
+#pragma mark - Attachments
+
++ (NSData *)dataWithAttachment:(BugSplatAttachment *)attachment
+{
+    if (!attachment.filename || !attachment.attachmentData) {
+        return nil;
+    }
+
+    const char *filename = attachment.filename.UTF8String;
+    const char *contentType = (attachment.contentType ?: @"application/octet-stream").UTF8String;
+    NSData *payload = attachment.attachmentData;
+
+    // Measure first so the payload is copied exactly once, straight into the output.
+    BugSplatMetaWriter writer;
+    BugSplatMetaWriterInit(&writer, NULL, 0);
+    BugSplatMetaWriteString(&writer, kBugSplatAttachmentFieldFilename, strlen(kBugSplatAttachmentFieldFilename), filename, strlen(filename));
+    BugSplatMetaWriteString(&writer, kBugSplatAttachmentFieldContentType, strlen(kBugSplatAttachmentFieldContentType), contentType, strlen(contentType));
+    BugSplatMetaWriteBytes(&writer, kBugSplatAttachmentFieldData, strlen(kBugSplatAttachmentFieldData), payload.bytes, payload.length);
+
+    NSMutableData *data = [NSMutableData dataWithLength:writer.length];
+    BugSplatMetaWriterInit(&writer, data.mutableBytes, data.length);
+    BugSplatMetaWriteString(&writer, kBugSplatAttachmentFieldFilename, strlen(kBugSplatAttachmentFieldFilename), filename, strlen(filename));
+    BugSplatMetaWriteString(&writer, kBugSplatAttachmentFieldContentType, strlen(kBugSplatAttachmentFieldContentType), contentType, strlen(contentType));
+    BugSplatMetaWriteBytes(&writer, kBugSplatAttachmentFieldData, strlen(kBugSplatAttachmentFieldData), payload.bytes, payload.length);
+    return writer.overflow ? nil : data;
+}
+
++ (BugSplatAttachment *)attachmentWithData:(NSData *)data
+{
+    if (data.length == 0) {
+        return nil;
+    }
+
+    BugSplatMetaReader reader;
+    BugSplatMetaResult result = BugSplatMetaReaderInit(&reader, data.bytes, data.length);
+    if (result == BugSplatMetaResultNotEncoded) {
+        NSError *error = nil;
+        BugSplatAttachment *legacy = [NSKeyedUnarchiver unarchivedObjectOfClass:[BugSplatAttachment class]
+                                                                        fromData:data
+                                                                           error:&error];
+        if (!legacy) {
+            BugSplatLogError(@"Failed to unarchive legacy attachment: %@", error);
+        }
+        return legacy;
+    }
+    if (result != BugSplatMetaResultOK) {
+        return nil;
+    }
+
+    NSString *filename = nil;
+    NSString *contentType = nil;
+    NSData *payload = nil;
+    BugSplatMetaField field;
+    while (BugSplatMetaReaderNext(&reader, &field) == BugSplatMetaResultOK) {
+        if (field.type == BugSplatMetaTypeString && BugSplatMetaFieldKeyEquals(&field, kBugSplatAttachmentFieldFilename)) {
+            filename = BugSplatStringFromBytes(field.value, field.valueLength);
+        } else if (field.type == BugSplatMetaTypeString && BugSplatMetaFieldKeyEquals(&field, kBugSplatAttachmentFieldContentType)) {
+            contentType = BugSplatStringFromBytes(field.value, field.valueLength);
+        } else if (field.type == BugSplatMetaTypeBytes && BugSplatMetaFieldKeyEquals(&field, kBugSplatAttachmentFieldData)) {
+            // An owned slice of the decoded buffer, not a live view of whatever `data` was read from.
+            payload = [data subdataWithRange:NSMakeRange((NSUInteger)(field.value - (const uint8_t *)data.bytes), field.valueLength)];
+        }
+    }
+
+    if (!filename || !payload) {
+        return nil;
+    }
+    return [[BugSplatAttachment alloc] initWithFilename:filename
+                                         attachmentData:payload
+                                            contentType:contentType ?: @"application/octet-stream"];
+}
+
+@end
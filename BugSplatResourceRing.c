@@ -0,0 +1,159 @@
+//
+//  BugSplatResourceRing.c
+//
+//  Copyright © BugSplat, LLC. All rights reserved.
+//
+
+#include "BugSplatResourceRing.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+static const uint32_t kBugSplatResourceRingMagic = 0x52525342; // "BSRR", little-endian
+
+/// Fewest slots accepted; CPU use needs two samples.
+static const size_t kBugSplatResourceRingMinimumCapacity = 2;
+
+static const char kBugSplatResourceCSVHeader[] = "time,footprint_mb,cpu_percent,threads,fds\n";
+
+#pragma mark - Setup
+
+size_t BugSplatResourceRingRegionSize(size_t capacity)
+{
+    return sizeof(BugSplatResourceRingHeader) + capacity * sizeof(BugSplatResourceSlot);
+}
+
+static void BugSplatResourceRingBind(BugSplatResourceRing *ring, void *region, size_t capacity)
+{
+    ring->header = (BugSplatResourceRingHeader *)region;
+    ring->slots = (BugSplatResourceSlot *)((uint8_t *)region + sizeof(BugSplatResourceRingHeader));
+    ring->capacity = capacity;
+}
+
+bool BugSplatResourceRingFormat(BugSplatResourceRing *ring, void *region, size_t regionSize)
+{
+    memset(ring, 0, sizeof(*ring));
+    if (!region || regionSize < BugSplatResourceRingRegionSize(kBugSplatResourceRingMinimumCapacity)) {
+        return false;
+    }
+    size_t capacity = (regionSize - sizeof(BugSplatResourceRingHeader)) / sizeof(BugSplatResourceSlot);
+    if (capacity > UINT32_MAX) {
+        capacity = UINT32_MAX;
+    }
+
+    BugSplatResourceRingHeader *header = (BugSplatResourceRingHeader *)region;
+    header->magic = kBugSplatResourceRingMagic;
+    header->version = BugSplatResourceRingVersion;
+    header->capacity = (uint32_t)capacity;
+    header->reserved = 0;
+    BugSplatResourceRingBind(ring, region, capacity);
+    BugSplatResourceRingReset(ring);
+    return true;
+}
+
+bool BugSplatResourceRingAttach(BugSplatResourceRing *ring, void *region, size_t regionSize)
+{
+    memset(ring, 0, sizeof(*ring));
+    if (!region || regionSize < sizeof(BugSplatResourceRingHeader)) {
+        return false;
+    }
+    const BugSplatResourceRingHeader *header = (const BugSplatResourceRingHeader *)region;
+    if (header->magic != kBugSplatResourceRingMagic
+        || header->version != BugSplatResourceRingVersion
+        || header->capacity < kBugSplatResourceRingMinimumCapacity
+        || BugSplatResourceRingRegionSize(header->capacity) > regionSize) {
+        return false;
+    }
+    BugSplatResourceRingBind(ring, region, header->capacity);
+    return true;
+}
+
+void BugSplatResourceRingReset(BugSplatResourceRing *ring)
+{
+    if (!ring->header) {
+        return;
+    }
+    // A zero sequence never matches a position, so zeroed slots read as empty.
+    memset(ring->slots, 0, ring->capacity * sizeof(BugSplatResourceSlot));
+    atomic_store_explicit(&ring->header->head, 0, memory_order_release);
+}
+
+#pragma mark - Samples
+
+void BugSplatResourceRingRecord(BugSplatResourceRing *ring, const BugSplatResourceSample *sample)
+{
+    if (!ring->header || !sample) {
+        return;
+    }
+    uint64_t position = atomic_load_explicit(&ring->header->head, memory_order_relaxed);
+    BugSplatResourceSlot *slot = &ring->slots[position % ring->capacity];
+    atomic_store_explicit(&slot->sequence, 0, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    slot->sample = *sample;
+    atomic_store_explicit(&slot->sequence, position + 1, memory_order_release);
+    atomic_store_explicit(&ring->header->head, position + 1, memory_order_release);
+}
+
+size_t BugSplatResourceRingCopySamples(const BugSplatResourceRing *ring, BugSplatResourceSample *samples, size_t maxSamples)
+{
+    if (!ring->header || !samples || maxSamples == 0) {
+        return 0;
+    }
+    uint64_t head = atomic_load_explicit(&ring->header->head, memory_order_acquire);
+    uint64_t available = head < ring->capacity ? head : ring->capacity;
+    if (available > maxSamples) {
+        available = maxSamples;
+    }
+
+    size_t count = 0;
+    for (uint64_t position = head - available; position < head; position++) {
+        BugSplatResourceSlot *slot = &ring->slots[position % ring->capacity];
+        if (atomic_load_explicit(&slot->sequence, memory_order_acquire) != position + 1) {
+            continue;
+        }
+        BugSplatResourceSample copy = slot->sample;
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&slot->sequence, memory_order_relaxed) != position + 1) {
+            continue;
+        }
+        samples[count++] = copy;
+    }
+    return count;
+}
+
+#pragma mark - CSV
+
+size_t BugSplatResourceSamplesFormatCSV(const BugSplatResourceSample *samples, size_t count,
+                                        char *buffer, size_t bufferCapacity)
+{
+    size_t headerLength = sizeof(kBugSplatResourceCSVHeader) - 1;
+    if (!buffer || bufferCapacity <= headerLength) {
+        if (buffer && bufferCapacity > 0) {
+            buffer[0] = '\0';
+        }
+        return 0;
+    }
+    memcpy(buffer, kBugSplatResourceCSVHeader, headerLength + 1);
+    size_t length = headerLength;
+
+    for (size_t i = 0; i < count; i++) {
+        const BugSplatResourceSample *sample = &samples[i];
+        char cpu[24] = "";
+        if (i > 0 && sample->timestampMs > samples[i - 1].timestampMs && sample->cpuTimeUs >= samples[i - 1].cpuTimeUs) {
+            double elapsedUs = (double)(sample->timestampMs - samples[i - 1].timestampMs) * 1000.0;
+            snprintf(cpu, sizeof(cpu), "%.1f", (double)(sample->cpuTimeUs - samples[i - 1].cpuTimeUs) * 100.0 / elapsedUs);
+        }
+        char line[128];
+        int lineLength = snprintf(line, sizeof(line), "%" PRIu64 ".%03u,%.1f,%s,%u,%u\n",
+                                  sample->timestampMs / 1000, (unsigned)(sample->timestampMs % 1000),
+                                  (double)sample->footprint / (1024.0 * 1024.0), cpu,
+                                  sample->threadCount, sample->fileDescriptorCount);
+        if (lineLength <= 0 || (size_t)lineLength >= sizeof(line) || length + (size_t)lineLength >= bufferCapacity) {
+            break;
+        }
+        memcpy(buffer + length, line, (size_t)lineLength + 1);
+        length += (size_t)lineLength;
+    }
+    return length;
+}
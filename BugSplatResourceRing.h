@@ -0,0 +1,120 @@
+//
+//  BugSplatResourceRing.h
+//
+//  Fixed-size ring of resource-usage samples (memory footprint, CPU time,
+//  threads, file descriptors) taken periodically by one writer. Plain C over a
+//  caller-provided memory region, so the region can be a shared file mapping
+//  that outlives a crash, and the same code can be tested on any platform.
+//
+//  Copyright © BugSplat, LLC. All rights reserved.
+//
+
+#ifndef BugSplatResourceRing_h
+#define BugSplatResourceRing_h
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Region layout:
+ *
+ *   header:  magic, version, slot capacity, then the write position `head`
+ *   slots:   <capacity> fixed-size slots, each a sequence number and one sample
+ *
+ * `head` counts every sample ever recorded; the sample at position p lives in
+ * slot p % capacity. There is a single writer. It clears the slot's sequence,
+ * writes the sample, then publishes the sequence (p + 1) and `head` with
+ * release ordering. Readers accept a slot only if its sequence is p + 1 both
+ * before and after copying it, so a sample being overwritten concurrently (or
+ * left half-written by a crash) is skipped rather than returned torn.
+ */
+#define BugSplatResourceRingVersion 1
+
+typedef struct {
+    /// Wall-clock time of the sample, in milliseconds since 1970.
+    uint64_t timestampMs;
+    /// Physical memory footprint, in bytes.
+    uint64_t footprint;
+    /// User plus system CPU time the process has used since it started, in microseconds.
+    uint64_t cpuTimeUs;
+    uint32_t threadCount;
+    uint32_t fileDescriptorCount;
+} BugSplatResourceSample;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t capacity;
+    uint32_t reserved;
+    _Atomic(uint64_t) head;
+} BugSplatResourceRingHeader;
+
+typedef struct {
+    _Atomic(uint64_t) sequence;
+    BugSplatResourceSample sample;
+} BugSplatResourceSlot;
+
+typedef struct {
+    BugSplatResourceRingHeader *header;
+    BugSplatResourceSlot *slots;
+    size_t capacity;
+} BugSplatResourceRing;
+
+/// Region size needed for a ring of `capacity` samples.
+size_t BugSplatResourceRingRegionSize(size_t capacity);
+
+/**
+ * Initialize an empty ring in `region`, discarding anything in it.
+ *
+ * @return false if `regionSize` is too small for a header and two samples.
+ */
+bool BugSplatResourceRingFormat(BugSplatResourceRing *ring, void *region, size_t regionSize);
+
+/**
+ * Use a ring previously formatted in `region` (e.g. a file written by an earlier process).
+ *
+ * @return false if the region does not hold a ring of this version that fits `regionSize`.
+ */
+bool BugSplatResourceRingAttach(BugSplatResourceRing *ring, void *region, size_t regionSize);
+
+/// Drop every sample. Must not race with the writer.
+void BugSplatResourceRingReset(BugSplatResourceRing *ring);
+
+/// Record one sample, overwriting the oldest when full. Single writer; lock-free, no allocation.
+void BugSplatResourceRingRecord(BugSplatResourceRing *ring, const BugSplatResourceSample *sample);
+
+/**
+ * Copy up to `maxSamples` of the newest complete samples, oldest first, into `samples`.
+ * Safe to call while the writer records; a sample overwritten during the copy is skipped.
+ *
+ * @return Number of samples copied.
+ */
+size_t BugSplatResourceRingCopySamples(const BugSplatResourceRing *ring, BugSplatResourceSample *samples, size_t maxSamples);
+
+/**
+ * Format `samples` (oldest first) as CSV into `buffer`: a header line, then one line per
+ * sample with its time (seconds since 1970), footprint in MB, CPU use since the previous
+ * sample as a percentage of one core (empty for the first), thread and descriptor counts:
+ *
+ *   time,footprint_mb,cpu_percent,threads,fds
+ *   1760000307.512,1402.3,,41,63
+ *   1760000312.518,1450.0,87.5,43,64
+ *
+ * Only whole lines are written; the result is NUL-terminated when `bufferCapacity` > 0.
+ *
+ * @return Length of the text written, excluding the NUL; 0 if not even the header fits.
+ */
+size_t BugSplatResourceSamplesFormatCSV(const BugSplatResourceSample *samples, size_t count,
+                                        char *buffer, size_t bufferCapacity);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BugSplatResourceRing_h */
@@ -0,0 +1,68 @@
+//
+//  BugSplatResourceRingFile.h
+//
+//  Copyright © BugSplat, LLC. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+#import "BugSplatResourceRing.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * A `BugSplatResourceRing` in a memory-mapped file.
+ *
+ * The file is created at full size when it is opened, so recording a sample is a copy into
+ * the shared mapping; the kernel keeps the pages when the process crashes or is killed, and
+ * the next launch reads the samples back from the file.
+ */
+@interface BugSplatResourceRingFile : NSObject
+
+/**
+ * Open (creating if needed) a ring file holding `capacity` samples and map it read-write.
+ * A ring of the same capacity already in the file is kept; anything else is reformatted.
+ *
+ * @return nil if the file cannot be created, sized or mapped.
+ */
+- (nullable instancetype)initWithPath:(NSString *)path capacity:(size_t)capacity NS_DESIGNATED_INITIALIZER;
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ * The samples in the ring file at `path` as CSV (see `BugSplatResourceSamplesFormatCSV`).
+ * Reads the file without mapping it for writing.
+ *
+ * @return nil if there is no ring at `path` or it holds no samples.
+ */
++ (nullable NSData *)CSVOfFileAtPath:(NSString *)path;
+
+/**
+ * Take a sample of the current process: wall-clock time, physical memory footprint, CPU time
+ * used, thread count and open file descriptors (counting descriptors below 1024 only).
+ *
+ * @return NO if the footprint could not be read; the other fields are still filled in.
+ */
++ (BOOL)sampleCurrentProcess:(BugSplatResourceSample *)sample;
+
+@property (nonatomic, copy, readonly) NSString *path;
+/// Samples the ring holds before the oldest is overwritten.
+@property (nonatomic, assign, readonly) size_t capacity;
+
+/// Record one sample. Single writer; see `BugSplatResourceRingRecord`.
+- (void)recordSample:(const BugSplatResourceSample *)sample;
+
+/// Sample the current process and record it.
+- (void)recordCurrentUsage;
+
+/// Copy up to `maxSamples` of the newest samples, oldest first; see `BugSplatResourceRingCopySamples`.
+- (size_t)copySamples:(BugSplatResourceSample *)samples maxSamples:(size_t)maxSamples;
+
+/// The samples as CSV, as for `CSVOfFileAtPath:`; nil if there are none.
+- (nullable NSData *)CSV;
+
+/// Drop every sample. Must not race with the writer.
+- (void)reset;
+
+@end
+
+NS_ASSUME_NONNULL_END
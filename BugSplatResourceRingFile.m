@@ -0,0 +1,147 @@
+//
+//  BugSplatResourceRingFile.m
+//
+//  Copyright © BugSplat, LLC. All rights reserved.
+//
+
+#import "BugSplatResourceRingFile.h"
+#import "BugSplatLogging.h"
+#import "BugSplatMappedFile.h"
+
+#import <fcntl.h>
+#import <mach/mach.h>
+#import <string.h>
+#import <sys/resource.h>
+#import <sys/time.h>
+#import <unistd.h>
+
+/// Descriptors above this are not counted, so one sample costs at most this many fcntl calls.
+static const int kBugSplatResourceMaxDescriptorScan = 1024;
+
+/// CSV bytes reserved per sample; a line is at most about 60.
+static const size_t kBugSplatResourceCSVLineLength = 128;
+
+@implementation BugSplatResourceRingFile
+{
+    BugSplatMappedFile *_file;
+    BugSplatResourceRing _ring;
+}
+
+- (instancetype)initWithPath:(NSString *)path capacity:(size_t)capacity
+{
+    if (self = [super init]) {
+        _path = [path copy];
+        // Recording never has to allocate a page; a larger ring's leftovers are dropped.
+        _file = [[BugSplatMappedFile alloc] initWithPath:path
+                                                    size:BugSplatResourceRingRegionSize(capacity)
+                                                 options:BugSplatMappedFileOptionsTruncate
+                                                    name:@"resource samples"];
+        if (!_file) {
+            return nil;
+        }
+
+        if (!BugSplatResourceRingAttach(&_ring, _file.bytes, _file.size) || _ring.capacity != capacity) {
+            if (!BugSplatResourceRingFormat(&_ring, _file.bytes, _file.size)) {
+                BugSplatLogError(@"Resource sample capacity %zu is too small", capacity);
+                return nil;
+            }
+        }
+        _capacity = _ring.capacity;
+    }
+    return self;
+}
+
++ (NSData *)CSVOfFileAtPath:(NSString *)path
+{
+    NSData *contents = [NSData dataWithContentsOfFile:path options:NSDataReadingMappedIfSafe error:nil];
+    BugSplatResourceRing ring;
+    // Copying samples only reads, so the read-only mapping is safe to hand over.
+    if (!contents || !BugSplatResourceRingAttach(&ring, (void *)contents.bytes, contents.length)) {
+        return nil;
+    }
+    return [self CSVOfRing:&ring];
+}
+
++ (NSData *)CSVOfRing:(const BugSplatResourceRing *)ring
+{
+    NSMutableData *samples = [NSMutableData dataWithLength:ring->capacity * sizeof(BugSplatResourceSample)];
+    size_t count = BugSplatResourceRingCopySamples(ring, samples.mutableBytes, ring->capacity);
+    if (count == 0) {
+        return nil;
+    }
+    NSMutableData *csv = [NSMutableData dataWithLength:(count + 1) * kBugSplatResourceCSVLineLength];
+    csv.length = BugSplatResourceSamplesFormatCSV(samples.bytes, count, csv.mutableBytes, csv.length);
+    return csv;
+}
+
++ (BOOL)sampleCurrentProcess:(BugSplatResourceSample *)sample
+{
+    memset(sample, 0, sizeof(*sample));
+
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    sample->timestampMs = (uint64_t)now.tv_sec * 1000 + (uint64_t)now.tv_usec / 1000;
+
+    // Includes threads that have already exited, unlike TASK_THREAD_TIMES_INFO.
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+        sample->cpuTimeUs = (uint64_t)usage.ru_utime.tv_sec * USEC_PER_SEC + (uint64_t)usage.ru_utime.tv_usec
+                          + (uint64_t)usage.ru_stime.tv_sec * USEC_PER_SEC + (uint64_t)usage.ru_stime.tv_usec;
+    }
+
+    thread_act_array_t threads = NULL;
+    mach_msg_type_number_t threadCount = 0;
+    if (task_threads(mach_task_self(), &threads, &threadCount) == KERN_SUCCESS) {
+        sample->threadCount = threadCount;
+        for (mach_msg_type_number_t i = 0; i < threadCount; i++) {
+            mach_port_deallocate(mach_task_self(), threads[i]);
+        }
+        vm_deallocate(mach_task_self(), (vm_address_t)threads, threadCount * sizeof(thread_act_t));
+    }
+
+    // There is no public call that counts open descriptors on iOS; probing each is a
+    // cheap syscall and the table is usually small (256 by default).
+    int scanLimit = MIN(getdtablesize(), kBugSplatResourceMaxDescriptorScan);
+    for (int fd = 0; fd < scanLimit; fd++) {
+        if (fcntl(fd, F_GETFD) != -1) {
+            sample->fileDescriptorCount++;
+        }
+    }
+
+    task_vm_info_data_t info;
+    mach_msg_type_number_t count = TASK_VM_INFO_COUNT;
+    if (task_info(mach_task_self(), TASK_VM_INFO, (task_info_t)&info, &count) != KERN_SUCCESS) {
+        return NO;
+    }
+    sample->footprint = info.phys_footprint;
+    return YES;
+}
+
+- (void)recordSample:(const BugSplatResourceSample *)sample
+{
+    BugSplatResourceRingRecord(&_ring, sample);
+}
+
+- (void)recordCurrentUsage
+{
+    BugSplatResourceSample sample;
+    [[self class] sampleCurrentProcess:&sample];
+    BugSplatResourceRingRecord(&_ring, &sample);
+}
+
+- (size_t)copySamples:(BugSplatResourceSample *)samples maxSamples:(size_t)maxSamples
+{
+    return BugSplatResourceRingCopySamples(&_ring, samples, maxSamples);
+}
+
+- (NSData *)CSV
+{
+    return [[self class] CSVOfRing:&_ring];
+}
+
+- (void)reset
+{
+    BugSplatResourceRingReset(&_ring);
+}
+
+@end
@@ -115,6 +115,30 @@ typedef void(^BugSplatFeedbackUploadCompletion)(BugSplatFeedbackResult * _Nullab
                  metadata:(nullable BugSplatCrashMetadata *)metadata
                completion:(BugSplatUploadCompletion)completion;
 
+/**
+ * Uploads a crash report and blocks the calling thread until the upload finishes or
+ * `timeout` passes, whichever comes first. On timeout the upload is cancelled.
+ *
+ * Meant for uploads that must finish before the caller returns, such as a crash that keeps
+ * happening during launch. Completions are delivered on a private queue for the duration of
+ * the call, so it is safe to call on the main thread. Do not call it while another upload
+ * is in progress.
+ *
+ * @param crashData The crash report data (will be zipped before upload).
+ * @param crashFilename The filename to use for the crash report inside the zip.
+ * @param attachments Optional array of attachments to include.
+ * @param metadata Optional metadata (user info, description, etc).
+ * @param timeout Longest time to block, in seconds.
+ * @param error Set to the reason when the upload failed or timed out.
+ * @return YES if the upload finished successfully within `timeout`.
+ */
+- (BOOL)uploadCrashReportSynchronously:(NSData *)crashData
+                         crashFilename:(NSString *)crashFilename
+                           attachments:(nullable NSArray<BugSplatAttachment *> *)attachments
+                              metadata:(nullable BugSplatCrashMetadata *)metadata
+                               timeout:(NSTimeInterval)timeout
+                                 error:(NSError * _Nullable * _Nullable)error;
+
 /**
  * Uploads user feedback to BugSplat.
  *
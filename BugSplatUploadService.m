@@ -7,6 +7,7 @@
 #import "BugSplatUploadService.h"
 #import "BugSplatZipHelper.h"
 #import "BugSplatTestSupport.h"
+#import "BugSplatLogging.h"
 
 NSString *const BugSplatUploadErrorDomain = @"com.bugsplat.upload";
 
@@ -15,7 +16,8 @@ typedef NS_ENUM(NSInteger, BugSplatUploadErrorCode) {
     BugSplatUploadErrorCodeNetworkError = 2,
     BugSplatUploadErrorCodeServerError = 3,
     BugSplatUploadErrorCodeRateLimited = 4,
-    BugSplatUploadErrorCodeCancelled = 5
+    BugSplatUploadErrorCodeCancelled = 5,
+    BugSplatUploadErrorCodeTimedOut = 6
 };
 
 @implementation BugSplatCrashMetadata
@@ -98,7 +100,7 @@ typedef NS_ENUM(NSInteger, BugSplatUploadErrorCode) {
 {
     // Defensive: ensure completion is not nil
     if (!completion) {
-        NSLog(@"BugSplat: uploadCrashReport called with nil completion handler");
+        BugSplatLogError(@"uploadCrashReport called with nil completion handler");
         return;
     }
     
@@ -127,10 +129,10 @@ typedef NS_ENUM(NSInteger, BugSplatUploadErrorCode) {
             @try {
                 if (attachment && attachment.attachmentData && attachment.filename) {
                     [zipEntries addObject:[BugSplatZipEntry entryWithFilename:attachment.filename data:attachment.attachmentData]];
-                    NSLog(@"BugSplat: Adding attachment to ZIP: %@", attachment.filename);
+                    BugSplatLogDebug(@"Adding attachment to ZIP: %@", attachment.filename);
                 }
             } @catch (NSException *exception) {
-                NSLog(@"BugSplat: Exception adding attachment to ZIP: %@ - %@", exception.name, exception.reason);
+                BugSplatLogError(@"Exception adding attachment to ZIP: %@ - %@", exception.name, exception.reason);
                 // Continue with remaining attachments
             }
         }
@@ -175,7 +177,7 @@ typedef NS_ENUM(NSInteger, BugSplatUploadErrorCode) {
             }];
         }];
     } @catch (NSException *exception) {
-        NSLog(@"BugSplat: Exception in uploadCrashReport: %@ - %@", exception.name, exception.reason);
+        BugSplatLogError(@"Exception in uploadCrashReport: %@ - %@", exception.name, exception.reason);
         NSError *error = [NSError errorWithDomain:BugSplatUploadErrorDomain
                                              code:BugSplatUploadErrorCodeInvalidData
                                          userInfo:@{NSLocalizedDescriptionKey: [NSString stringWithFormat:@"Exception: %@", exception.reason]}];
@@ -183,6 +185,53 @@ typedef NS_ENUM(NSInteger, BugSplatUploadErrorCode) {
     }
 }
 
+- (BOOL)uploadCrashReportSynchronously:(NSData *)crashData
+                         crashFilename:(NSString *)crashFilename
+                           attachments:(NSArray<BugSplatAttachment *> *)attachments
+                              metadata:(BugSplatCrashMetadata *)metadata
+                               timeout:(NSTimeInterval)timeout
+                                 error:(NSError **)error
+{
+    // The default dispatcher hops to the main queue between steps, which never runs while
+    // the caller blocks it. Deliver on a private queue until this upload is over.
+    void (^previousDispatcher)(dispatch_block_t) = self.completionDispatcher;
+    dispatch_queue_t completionQueue = dispatch_queue_create("com.bugsplat.upload.sync",
+                                                             dispatch_queue_attr_make_with_qos_class(DISPATCH_QUEUE_SERIAL, QOS_CLASS_USER_INITIATED, 0));
+    self.completionDispatcher = ^(dispatch_block_t block) {
+        dispatch_async(completionQueue, block);
+    };
+
+    dispatch_semaphore_t finished = dispatch_semaphore_create(0);
+    __block BOOL uploaded = NO;
+    __block NSError *uploadError = nil;
+    [self uploadCrashReport:crashData
+              crashFilename:crashFilename
+                attachments:attachments
+                   metadata:metadata
+                 completion:^(BOOL success, NSError *completionError, NSString *infoUrl, NSNumber *crashId) {
+        uploaded = success;
+        uploadError = completionError;
+        dispatch_semaphore_signal(finished);
+    }];
+
+    long timedOut = dispatch_semaphore_wait(finished, dispatch_time(DISPATCH_TIME_NOW, (int64_t)(MAX(timeout, 0) * NSEC_PER_SEC)));
+    self.completionDispatcher = previousDispatcher;
+    if (timedOut) {
+        [self cancelUpload];
+        BugSplatLogWarning(@"Synchronous upload did not finish within %.1f s; cancelled", timeout);
+        if (error) {
+            *error = [NSError errorWithDomain:BugSplatUploadErrorDomain
+                                         code:BugSplatUploadErrorCodeTimedOut
+                                     userInfo:@{NSLocalizedDescriptionKey: @"Upload timed out"}];
+        }
+        return NO;
+    }
+    if (!uploaded && error) {
+        *error = uploadError;
+    }
+    return uploaded;
+}
+
 - (void)uploadFeedback:(NSString *)title
            description:(NSString *)description
            attachments:(NSArray<BugSplatAttachment *> *)attachments
@@ -225,10 +274,10 @@ typedef NS_ENUM(NSInteger, BugSplatUploadErrorCode) {
             @try {
                 if (attachment && attachment.attachmentData && attachment.filename) {
                     [zipEntries addObject:[BugSplatZipEntry entryWithFilename:attachment.filename data:attachment.attachmentData]];
-                    NSLog(@"BugSplat: Adding attachment to feedback ZIP: %@", attachment.filename);
+                    BugSplatLogDebug(@"Adding attachment to feedback ZIP: %@", attachment.filename);
                 }
             } @catch (NSException *exception) {
-                NSLog(@"BugSplat: Exception adding attachment to feedback ZIP: %@ - %@", exception.name, exception.reason);
+                BugSplatLogError(@"Exception adding attachment to feedback ZIP: %@ - %@", exception.name, exception.reason);
                 // Continue with remaining attachments
             }
         }
@@ -276,7 +325,7 @@ typedef NS_ENUM(NSInteger, BugSplatUploadErrorCode) {
                                    metadata:metadata
                                  completion:^(BOOL commitSuccess, NSError *commitError, NSString *infoUrl, NSNumber *crashId) {
                     if (commitSuccess) {
-                        NSLog(@"BugSplat: User feedback uploaded successfully");
+                        BugSplatLogInfo(@"User feedback uploaded successfully");
                         BugSplatFeedbackResult *result = [[BugSplatFeedbackResult alloc] initWithCrashId:crashId
                                                                                                  infoUrl:infoUrl];
                         safeCompletion(result, nil);
@@ -287,7 +336,7 @@ typedef NS_ENUM(NSInteger, BugSplatUploadErrorCode) {
             }];
         }];
     } @catch (NSException *exception) {
-        NSLog(@"BugSplat: Exception in uploadFeedback: %@ - %@", exception.name, exception.reason);
+        BugSplatLogError(@"Exception in uploadFeedback: %@ - %@", exception.name, exception.reason);
         NSError *error = [NSError errorWithDomain:BugSplatUploadErrorDomain
                                              code:BugSplatUploadErrorCodeInvalidData
                                          userInfo:@{NSLocalizedDescriptionKey: [NSString stringWithFormat:@"Exception: %@", exception.reason]}];
@@ -546,7 +595,7 @@ typedef NS_ENUM(NSInteger, BugSplatUploadErrorCode) {
                 id rawInfoUrl = responseJson[@"infoUrl"];
                 if ([rawInfoUrl isKindOfClass:[NSString class]]) {
                     infoUrl = rawInfoUrl;
-                    NSLog(@"BugSplat: Crash report info URL: %@", infoUrl);
+                    BugSplatLogDebug(@"Crash report info URL: %@", infoUrl);
                 }
                 // crashId is a JSON integer, but tolerate a string-encoded value too.
                 id rawCrashId = responseJson[@"crashId"];
@@ -564,12 +613,12 @@ typedef NS_ENUM(NSInteger, BugSplatUploadErrorCode) {
                     }
                 }
                 if (crashId) {
-                    NSLog(@"BugSplat: Crash report id: %@", crashId);
+                    BugSplatLogDebug(@"Crash report id: %@", crashId);
                 }
             }
         }
 
-        NSLog(@"BugSplat: Crash report uploaded successfully");
+        BugSplatLogDebug(@"Crash report uploaded successfully");
         [self deliverCompletion:^{
             completion(YES, nil, infoUrl, crashId);
         }];
@@ -5,6 +5,7 @@
 //
 
 #import "BugSplatUtilities.h"
+#import "BugSplatLogging.h"
 
 
 @implementation NSArray (XMLArrayUtility)
@@ -73,7 +74,7 @@
     NSArray<NSValue *> *cDataTokenPairRanges = [self tokenPairRangesForStartToken:@"<![CDATA[" endToken:@"]]>" error:&error];
 
     if (error != nil) {
-        NSLog(@"CDATA parsing error was found!");
+        BugSplatLogWarning(@"CDATA parsing error was found!");
     }
 
     error = nil; // reset
@@ -81,7 +82,7 @@
     NSArray<NSValue *> *commentTokenPairRanges = [self tokenPairRangesForStartToken:@"<!--" endToken:@"-->" error:&error];
 
     if (error != nil) {
-        NSLog(@"XML Comment parsing error was found!");
+        BugSplatLogWarning(@"XML Comment parsing error was found!");
     }
 
     // processing instructions not currently supported
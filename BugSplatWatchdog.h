@@ -0,0 +1,97 @@
+//
+//  BugSplatWatchdog.h
+//
+//  Copyright © BugSplat, LLC. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import <mach/mach.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class BugSplatWatchdog;
+
+/**
+ * Delegate protocol for BugSplatWatchdog. Both callbacks run on the watchdog thread.
+ */
+@protocol BugSplatWatchdogDelegate <NSObject>
+
+/**
+ * Called once per stall when a target has not serviced a ping for its threshold.
+ *
+ * @param name     The stalled target.
+ * @param duration Time since the unanswered ping was dispatched, in seconds.
+ * @param thread   Thread that last serviced one of the target's pings (for a thread-bound
+ *                 target, the one that is stuck), or MACH_PORT_NULL if none has or the target
+ *                 does not record threads.
+ */
+- (void)watchdog:(BugSplatWatchdog *)watchdog
+      targetNamed:(NSString *)name
+didStallWithDuration:(NSTimeInterval)duration
+           thread:(mach_port_t)thread;
+
+/// Called when a target reported through the stall callback services its ping again.
+- (void)watchdog:(BugSplatWatchdog *)watchdog targetNamedDidRecover:(NSString *)name;
+
+@end
+
+
+/**
+ * Monitors any number of named targets - worker threads, serial queues, custom event
+ * loops - from one shared watchdog thread.
+ *
+ * Each target has its own threshold and a ping dispatcher that runs a block on the target
+ * (e.g. `dispatch_async` to its queue, or posting to its job system). The watchdog keeps
+ * one ping outstanding per target and polls each at a fifth of its threshold (at least
+ * 100 ms); a target whose ping has waited `threshold` is reported, with the thread that last
+ * ran one of its pings. The thread is started with the first target, sleeps until the next
+ * target is due, and parks without waking while no targets are registered.
+ *
+ * The main thread is monitored by BugSplatHangTracker, not by this class.
+ */
+@interface BugSplatWatchdog : NSObject
+
+/**
+ * @param isDebuggerAttachedBlock Optional predicate; while it returns YES nothing is reported.
+ */
+- (instancetype)initWithDelegate:(id<BugSplatWatchdogDelegate>)delegate
+          isDebuggerAttachedBlock:(nullable BOOL(^)(void))isDebuggerAttachedBlock;
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ * Start monitoring a target. Thresholds below 0.1 s are clamped to 0.1 s.
+ *
+ * @return NO if a target with this name is already monitored.
+ */
+- (BOOL)addTargetWithName:(NSString *)name
+                threshold:(NSTimeInterval)threshold
+           pingDispatcher:(void(^)(dispatch_block_t ping))pingDispatcher;
+
+/**
+ * Start monitoring a target, choosing whether stalls name the thread that last ran a ping.
+ * Pass NO when pings may run on any thread, e.g. a dispatch queue served by the GCD pool:
+ * the last thread to run one is unrelated to the one that is stuck now.
+ */
+- (BOOL)addTargetWithName:(NSString *)name
+                threshold:(NSTimeInterval)threshold
+            recordsThread:(BOOL)recordsThread
+           pingDispatcher:(void(^)(dispatch_block_t ping))pingDispatcher;
+
+/// Stop monitoring a target. A ping already dispatched to it still runs, harmlessly.
+- (void)removeTargetWithName:(NSString *)name;
+
+/**
+ * Stop monitoring every target and let the watchdog thread exit. Adding a target afterwards
+ * starts a new thread. Safe to call multiple times.
+ */
+- (void)stop;
+
+/// Names of the monitored targets.
+@property (nonatomic, readonly) NSArray<NSString *> *targetNames;
+
+/// YES once the watchdog thread has been started by the first target, until `-stop`.
+@property (atomic, readonly, getter=isRunning) BOOL running;
+
+@end
+
+NS_ASSUME_NONNULL_END
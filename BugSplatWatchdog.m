@@ -0,0 +1,251 @@
+//
+//  BugSplatWatchdog.m
+//
+//  Copyright © BugSplat, LLC. All rights reserved.
+//
+
+#import "BugSplatWatchdog.h"
+
+#import <os/lock.h>
+#import <pthread.h>
+#import <stdatomic.h>
+#import <time.h>
+
+static const NSTimeInterval kBugSplatWatchdogMinThreshold = 0.1;
+static const NSTimeInterval kBugSplatWatchdogMinPollInterval = 0.1;
+
+/// Same clock as the hang tracker's heartbeat: stops while the device sleeps.
+static inline uint64_t BugSplatWatchdogNow(void) {
+    return clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+}
+
+#pragma mark - Target
+
+@interface BugSplatWatchdogTarget : NSObject
+@property (nonatomic, copy) NSString *name;
+@property (nonatomic, assign) NSTimeInterval threshold;
+@property (nonatomic, copy) void(^pingDispatcher)(dispatch_block_t);
+@property (nonatomic, assign) BOOL recordsThread;
+// Watchdog thread only.
+@property (nonatomic, assign) uint64_t nextPollAt;
+@property (nonatomic, assign) BOOL stallReported;
+@end
+
+@implementation BugSplatWatchdogTarget
+{
+@public
+    // YES while a ping is queued on the target but has not run.
+    _Atomic(bool) _pingOutstanding;
+    // When the outstanding ping was dispatched.
+    _Atomic(uint64_t) _pingSentAt;
+    // Thread that ran the most recent ping.
+    _Atomic(mach_port_t) _lastThread;
+}
+
+- (NSTimeInterval)pollInterval {
+    return MAX(self.threshold / 5.0, kBugSplatWatchdogMinPollInterval);
+}
+
+@end
+
+#pragma mark - BugSplatWatchdog
+
+@interface BugSplatWatchdog ()
+@property (atomic, readwrite, getter=isRunning) BOOL running;
+@property (nonatomic, weak) id<BugSplatWatchdogDelegate> delegate;
+@property (nonatomic, copy, nullable) BOOL(^isDebuggerAttachedBlock)(void);
+@property (atomic, strong) dispatch_semaphore_t wakeup;
+// The current watchdog thread; any other one exits.
+@property (atomic, strong, nullable) NSThread *watchdogThread;
+@end
+
+@implementation BugSplatWatchdog
+{
+    os_unfair_lock _lock;
+    BOOL _startsThread;
+    // Replaced, never mutated, so the watchdog thread can iterate a snapshot.
+    NSArray<BugSplatWatchdogTarget *> *_targets;
+}
+
+- (instancetype)initWithDelegate:(id<BugSplatWatchdogDelegate>)delegate
+          isDebuggerAttachedBlock:(BOOL(^)(void))isDebuggerAttachedBlock {
+    return [self initWithDelegate:delegate isDebuggerAttachedBlock:isDebuggerAttachedBlock startsThread:YES];
+}
+
+/// Testing initializer: with `startsThread` NO, tests drive `_pollAtTime:` themselves.
+- (instancetype)initWithDelegate:(id<BugSplatWatchdogDelegate>)delegate
+          isDebuggerAttachedBlock:(BOOL(^)(void))isDebuggerAttachedBlock
+                     startsThread:(BOOL)startsThread {
+    if (self = [super init]) {
+        _startsThread = startsThread;
+        _delegate = delegate;
+        _isDebuggerAttachedBlock = [isDebuggerAttachedBlock copy];
+        _wakeup = dispatch_semaphore_create(0);
+        _lock = OS_UNFAIR_LOCK_INIT;
+        _targets = @[];
+    }
+    return self;
+}
+
+#pragma mark - Targets
+
+- (NSArray<BugSplatWatchdogTarget *> *)targets {
+    os_unfair_lock_lock(&_lock);
+    NSArray<BugSplatWatchdogTarget *> *targets = _targets;
+    os_unfair_lock_unlock(&_lock);
+    return targets;
+}
+
+- (NSArray<NSString *> *)targetNames {
+    return [self.targets valueForKey:@"name"];
+}
+
+- (BOOL)addTargetWithName:(NSString *)name
+                threshold:(NSTimeInterval)threshold
+           pingDispatcher:(void(^)(dispatch_block_t))pingDispatcher {
+    return [self addTargetWithName:name threshold:threshold recordsThread:YES pingDispatcher:pingDispatcher];
+}
+
+- (BOOL)addTargetWithName:(NSString *)name
+                threshold:(NSTimeInterval)threshold
+            recordsThread:(BOOL)recordsThread
+           pingDispatcher:(void(^)(dispatch_block_t))pingDispatcher {
+    BugSplatWatchdogTarget *target = [[BugSplatWatchdogTarget alloc] init];
+    target.name = name;
+    target.threshold = MAX(threshold, kBugSplatWatchdogMinThreshold);
+    target.recordsThread = recordsThread;
+    target.pingDispatcher = pingDispatcher;
+
+    NSThread *thread = nil;
+    os_unfair_lock_lock(&_lock);
+    BOOL exists = [[_targets valueForKey:@"name"] containsObject:name];
+    if (!exists) {
+        _targets = [_targets arrayByAddingObject:target];
+        if (!self.running && _startsThread) {
+            // Each thread waits on its own semaphore, so the wakeup -stop sends a thread is
+            // never taken by the one that replaces it.
+            self.wakeup = dispatch_semaphore_create(0);
+            thread = [[NSThread alloc] initWithTarget:self selector:@selector(watchdogThreadMain:) object:self.wakeup];
+            thread.name = @"com.bugsplat.watchdog";
+            thread.qualityOfService = NSQualityOfServiceUtility;
+            self.watchdogThread = thread;
+        }
+        self.running = YES;
+    }
+    os_unfair_lock_unlock(&_lock);
+    if (exists) {
+        return NO;
+    }
+
+    if (thread) {
+        [thread start];
+    } else {
+        // Send the new target its first ping now rather than after the current sleep.
+        dispatch_semaphore_signal(self.wakeup);
+    }
+    return YES;
+}
+
+- (void)removeTargetWithName:(NSString *)name {
+    os_unfair_lock_lock(&_lock);
+    _targets = [_targets filteredArrayUsingPredicate:[NSPredicate predicateWithFormat:@"name != %@", name]];
+    os_unfair_lock_unlock(&_lock);
+}
+
+- (void)stop {
+    os_unfair_lock_lock(&_lock);
+    BOOL wasRunning = self.running;
+    // Flipping running=NO makes the watchdog thread return once woken. It retains self
+    // until then, so a ping still in flight never calls into a deallocated watchdog.
+    self.running = NO;
+    self.watchdogThread = nil;
+    _targets = @[];
+    dispatch_semaphore_t wakeup = self.wakeup;
+    os_unfair_lock_unlock(&_lock);
+    if (wasRunning) {
+        dispatch_semaphore_signal(wakeup);
+    }
+}
+
+#pragma mark - Watchdog Thread
+
+- (void)watchdogThreadMain:(dispatch_semaphore_t)wakeup {
+    NSTimeInterval sleepInterval = 0;
+    // A quick -stop / add replaces watchdogThread, so this thread also exits then.
+    NSThread *thisThread = [NSThread currentThread];
+    for (;;) {
+        @autoreleasepool {
+            uint64_t sleepStart = BugSplatWatchdogNow();
+            dispatch_time_t deadline = sleepInterval > 0
+                ? dispatch_time(DISPATCH_TIME_NOW, (int64_t)(sleepInterval * NSEC_PER_SEC))
+                : (sleepInterval < 0 ? DISPATCH_TIME_FOREVER : DISPATCH_TIME_NOW);
+            dispatch_semaphore_wait(wakeup, deadline);
+            if (!self.isRunning || self.watchdogThread != thisThread) {
+                return;
+            }
+
+            uint64_t now = BugSplatWatchdogNow();
+            sleepInterval = [self _pollAtTime:now
+                          actualSleepDuration:(NSTimeInterval)(now - sleepStart) / NSEC_PER_SEC
+                        expectedSleepDuration:MAX(sleepInterval, 0)];
+        }
+    }
+}
+
+/// Poll every due target and return how long to sleep until the next one is due, or -1
+/// (sleep until woken) when there are no targets. Factored out so tests can drive it.
+- (NSTimeInterval)_pollAtTime:(uint64_t)now
+          actualSleepDuration:(NSTimeInterval)actualSleep
+        expectedSleepDuration:(NSTimeInterval)expectedSleep {
+    NSArray<BugSplatWatchdogTarget *> *targets = self.targets;
+    if (targets.count == 0) {
+        return -1;
+    }
+    BOOL(^debuggerCheck)(void) = self.isDebuggerAttachedBlock;
+    BOOL debuggerAttached = debuggerCheck && debuggerCheck();
+    id<BugSplatWatchdogDelegate> delegate = self.delegate;
+
+    uint64_t nextDue = UINT64_MAX;
+    for (BugSplatWatchdogTarget *target in targets) {
+        bool outstanding = atomic_load(&target->_pingOutstanding);
+        if (target.stallReported && !outstanding) {
+            target.stallReported = NO;
+            [delegate watchdog:self targetNamedDidRecover:target.name];
+        }
+
+        if (now >= target.nextPollAt) {
+            if (!outstanding) {
+                [self sendPingToTarget:target at:now];
+            } else if (actualSleep > expectedSleep + target.threshold) {
+                // Suspension guard: the whole process was frozen, target included.
+                atomic_store(&target->_pingSentAt, now);
+            } else if (!debuggerAttached && !target.stallReported) {
+                NSTimeInterval stalled = (NSTimeInterval)(now - atomic_load(&target->_pingSentAt)) / NSEC_PER_SEC;
+                if (stalled >= target.threshold) {
+                    target.stallReported = YES;
+                    [delegate watchdog:self
+                           targetNamed:target.name
+                  didStallWithDuration:stalled
+                                thread:atomic_load(&target->_lastThread)];
+                }
+            }
+            target.nextPollAt = now + (uint64_t)(target.pollInterval * NSEC_PER_SEC);
+        }
+        nextDue = MIN(nextDue, target.nextPollAt);
+    }
+    return nextDue > now ? (NSTimeInterval)(nextDue - now) / NSEC_PER_SEC : 0;
+}
+
+- (void)sendPingToTarget:(BugSplatWatchdogTarget *)target at:(uint64_t)now {
+    atomic_store(&target->_pingSentAt, now);
+    atomic_store(&target->_pingOutstanding, true);
+    BOOL recordsThread = target.recordsThread;
+    target.pingDispatcher(^{
+        if (recordsThread) {
+            atomic_store(&target->_lastThread, pthread_mach_thread_np(pthread_self()));
+        }
+        atomic_store(&target->_pingOutstanding, false);
+    });
+}
+
+@end
@@ -0,0 +1,219 @@
+//
+//  BugSplatAsyncStartTests.m
+//  BugSplatTests
+//
+//  Tests for `startAsynchronously`: capture must be enabled before the previous
+//  session's report is ingested, and ingestion must run off the calling thread.
+//  The pending report is a real PLCrashReporter live report served through
+//  MockCrashReporter; uploads go to a MockURLSession that always fails.
+//
+//  Copyright © BugSplat, LLC. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+#import <CrashReporter/CrashReporter.h>
+
+#import <BugSplat/BugSplat.h>
+#import "BugSplat+Testing.h"
+#import "MockCrashReporter.h"
+#import "MockCrashStorage.h"
+#import "MockUserDefaults.h"
+#import "MockBundle.h"
+#import "MockURLSession.h"
+
+/// Delegate that records the conditions under which ingestion called back into the app.
+@interface AsyncStartRecordingDelegate : NSObject <BugSplatDelegate>
+@property (nonatomic, strong) MockCrashReporter *crashReporter;
+@property (atomic, assign) BOOL wasCalled;
+@property (atomic, assign) BOOL reporterWasEnabledWhenCalled;
+@property (atomic, assign) BOOL wasCalledOnMainThread;
+@end
+
+@implementation AsyncStartRecordingDelegate
+
+- (NSString *)applicationLogForBugSplat:(BugSplat *)bugSplat
+{
+    self.wasCalled = YES;
+    self.reporterWasEnabledWhenCalled = self.crashReporter.wasEnabled;
+    self.wasCalledOnMainThread = [NSThread isMainThread];
+    return @"log";
+}
+
+@end
+
+@interface BugSplatAsyncStartTests : XCTestCase
+@property (nonatomic, strong) BugSplat *bugSplat;
+@property (nonatomic, strong) MockCrashReporter *mockCrashReporter;
+@property (nonatomic, strong) AsyncStartRecordingDelegate *recordingDelegate;
+@end
+
+@implementation BugSplatAsyncStartTests
+
+- (void)setUp
+{
+    [super setUp];
+
+    self.mockCrashReporter = [[MockCrashReporter alloc] init];
+    MockBundle *bundle = [[MockBundle alloc] init];
+    [bundle setObject:@"AsyncStartApp" forInfoDictionaryKey:@"CFBundleName"];
+    [bundle setObject:@"1.0.0" forInfoDictionaryKey:@"CFBundleShortVersionString"];
+    [bundle setObject:@"asyncstartdb" forInfoDictionaryKey:@"BugSplatDatabase"];
+
+    self.bugSplat = [BugSplat testInstanceWithCrashReporter:self.mockCrashReporter
+                                               crashStorage:[[MockCrashStorage alloc] init]
+                                               userDefaults:[[MockUserDefaults alloc] init]
+                                                     bundle:bundle];
+    [self.bugSplat setDebuggerAttachedOverride:@NO];
+    self.bugSplat.autoSubmitCrashReport = YES;
+
+    MockURLSession *session = [[MockURLSession alloc] init];
+    session.nextError = [NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorNotConnectedToInternet userInfo:nil];
+    [self.bugSplat setUploadServiceForTesting:[[BugSplatUploadService alloc] initWithDatabase:@"asyncstartdb"
+                                                                              applicationName:@"AsyncStartApp"
+                                                                           applicationVersion:@"1.0.0"
+                                                                                   urlSession:session]];
+
+    self.recordingDelegate = [[AsyncStartRecordingDelegate alloc] init];
+    self.recordingDelegate.crashReporter = self.mockCrashReporter;
+    self.bugSplat.delegate = self.recordingDelegate;
+}
+
+- (void)tearDown
+{
+    NSString *filename = [self.bugSplat currentCrashFilename];
+    if (filename) {
+        NSString *dir = [self.bugSplat crashesDirectoryPath];
+        for (NSString *ext in @[@"crash", @"meta"]) {
+            NSString *path = [[dir stringByAppendingPathComponent:filename] stringByAppendingPathExtension:ext];
+            [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+        }
+    }
+    self.bugSplat = nil;
+    [super tearDown];
+}
+
+#pragma mark - Helpers
+
+- (void)givenPendingLiveReport
+{
+    PLCrashReporter *reporter = [[PLCrashReporter alloc] initWithConfiguration:[PLCrashReporterConfig defaultConfiguration]];
+    NSError *error = nil;
+    NSData *report = [reporter generateLiveReportAndReturnError:&error];
+    XCTAssertNotNil(report, @"Failed to generate live report: %@", error);
+
+    self.mockCrashReporter.hasPendingReport = YES;
+    self.mockCrashReporter.pendingCrashReportData = report;
+}
+
+- (void)drainIngestQueue
+{
+    dispatch_queue_t queue = [self.bugSplat ingestQueueForTesting];
+    XCTAssertNotNil(queue);
+    dispatch_sync(queue, ^{});
+}
+
+#pragma mark - Tests
+
+- (void)testAsyncStart_EnablesCaptureAndTakesPendingReportBeforeReturning
+{
+    [self givenPendingLiveReport];
+    self.bugSplat.startAsynchronously = YES;
+
+    [self.bugSplat start];
+
+    XCTAssertTrue([self.bugSplat isStartInvoked]);
+    XCTAssertTrue(self.mockCrashReporter.wasEnabled);
+    XCTAssertTrue(self.mockCrashReporter.wasPurged, @"Pending report must be taken before a new crash can overwrite it");
+    [self drainIngestQueue];
+}
+
+- (void)testAsyncStart_IngestsPendingReportOffCallingThreadAfterEnabling
+{
+    [self givenPendingLiveReport];
+    self.bugSplat.startAsynchronously = YES;
+
+    [self.bugSplat start];
+    [self drainIngestQueue];
+
+    XCTAssertTrue(self.recordingDelegate.wasCalled);
+    XCTAssertTrue(self.recordingDelegate.reporterWasEnabledWhenCalled);
+    XCTAssertFalse(self.recordingDelegate.wasCalledOnMainThread);
+
+    NSString *filename = [self.bugSplat currentCrashFilename];
+    XCTAssertNotNil(filename);
+    NSString *crashPath = [[[self.bugSplat crashesDirectoryPath] stringByAppendingPathComponent:filename] stringByAppendingPathExtension:@"crash"];
+    XCTAssertTrue([[NSFileManager defaultManager] fileExistsAtPath:crashPath]);
+}
+
+- (void)testAsyncStart_StillIngestsWhenDebuggerAttached
+{
+    [self givenPendingLiveReport];
+    self.bugSplat.startAsynchronously = YES;
+    [self.bugSplat setDebuggerAttachedOverride:@YES];
+
+    [self.bugSplat start];
+    [self drainIngestQueue];
+
+    XCTAssertFalse(self.mockCrashReporter.wasEnabled);
+    XCTAssertTrue(self.mockCrashReporter.wasPurged);
+    XCTAssertTrue(self.recordingDelegate.wasCalled);
+}
+
+- (void)testAsyncStart_StagesRawReportBeforePurging
+{
+    [self givenPendingLiveReport];
+    self.bugSplat.startAsynchronously = YES;
+    NSString *dir = [self.bugSplat crashesDirectoryPath];
+    NSArray<NSString *> *filesBefore = [[NSFileManager defaultManager] contentsOfDirectoryAtPath:dir error:nil] ?: @[];
+    __block NSArray<NSString *> *stagedFiles = nil;
+    self.mockCrashReporter.purgeHandler = ^{
+        NSArray<NSString *> *files = [[NSFileManager defaultManager] contentsOfDirectoryAtPath:dir error:nil] ?: @[];
+        stagedFiles = [[files filteredArrayUsingPredicate:[NSPredicate predicateWithFormat:@"pathExtension == 'plcrash'"]]
+                       filteredArrayUsingPredicate:[NSPredicate predicateWithFormat:@"NOT (SELF IN %@)", filesBefore]];
+    };
+
+    [self.bugSplat start];
+    [self drainIngestQueue];
+
+    XCTAssertEqual(stagedFiles.count, 1u, @"Raw report must be on disk before the reporter lets go of it");
+    NSString *filename = [self.bugSplat currentCrashFilename];
+    XCTAssertEqualObjects(stagedFiles.firstObject, [filename stringByAppendingPathExtension:@"plcrash"], @"Ingestion completes the staged report");
+    NSString *basePath = [dir stringByAppendingPathComponent:filename];
+    XCTAssertTrue([[NSFileManager defaultManager] fileExistsAtPath:[basePath stringByAppendingPathExtension:@"meta"]]);
+    XCTAssertFalse([[NSFileManager defaultManager] fileExistsAtPath:[basePath stringByAppendingPathExtension:@"plcrash"]],
+                   @"Replaced by the formatted text");
+}
+
+- (void)testStart_ResumesReportStagedByEarlierLaunch
+{
+    [self givenPendingLiveReport];
+    NSData *report = self.mockCrashReporter.pendingCrashReportData;
+    self.mockCrashReporter.hasPendingReport = NO;
+    self.mockCrashReporter.pendingCrashReportData = nil;
+
+    // What a launch that was killed between staging and ingesting leaves behind
+    NSString *filename = [NSString stringWithFormat:@"%.0f", [NSDate timeIntervalSinceReferenceDate] - 86400.0];
+    NSString *basePath = [[self.bugSplat crashesDirectoryPath] stringByAppendingPathComponent:filename];
+    XCTAssertTrue([report writeToFile:[basePath stringByAppendingPathExtension:@"plcrash"] atomically:YES]);
+
+    [self.bugSplat start];
+
+    XCTAssertEqualObjects([self.bugSplat currentCrashFilename], filename);
+    XCTAssertTrue([[NSFileManager defaultManager] fileExistsAtPath:[basePath stringByAppendingPathExtension:@"meta"]]);
+    XCTAssertTrue([[NSFileManager defaultManager] fileExistsAtPath:[basePath stringByAppendingPathExtension:@"crash"]]);
+    XCTAssertFalse([[NSFileManager defaultManager] fileExistsAtPath:[basePath stringByAppendingPathExtension:@"plcrash"]]);
+}
+
+- (void)testSyncStart_IngestsBeforeEnabling
+{
+    [self givenPendingLiveReport];
+
+    [self.bugSplat start];
+
+    XCTAssertNil([self.bugSplat ingestQueueForTesting]);
+    XCTAssertTrue(self.recordingDelegate.wasCalled);
+    XCTAssertFalse(self.recordingDelegate.reporterWasEnabledWhenCalled);
+    XCTAssertTrue(self.mockCrashReporter.wasEnabled);
+}
+
+@end
@@ -0,0 +1,130 @@
+//
+//  BugSplatAttributeStoreTests.m
+//  BugSplatTests
+//
+//  Tests for the thread-safe attribute store and for BugSplat coalescing
+//  attribute changes into a single crash reporter customData update.
+//
+//  Copyright © BugSplat, LLC. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+
+#import <BugSplat/BugSplat.h>
+#import "BugSplat+Testing.h"
+#import "BugSplatAttributeStore.h"
+#import "BugSplatMetadataCodec.h"
+#import "MockCrashReporter.h"
+#import "MockCrashStorage.h"
+#import "MockUserDefaults.h"
+#import "MockBundle.h"
+
+@interface BugSplatAttributeStoreTests : XCTestCase
+@property (nonatomic, strong) BugSplatAttributeStore *store;
+@end
+
+@implementation BugSplatAttributeStoreTests
+
+- (void)setUp
+{
+    [super setUp];
+    self.store = [[BugSplatAttributeStore alloc] init];
+}
+
+#pragma mark - Store
+
+- (void)testSetValue_AddsReplacesAndRemoves
+{
+    XCTAssertTrue([self.store setValue:@"1" forAttribute:@"a"]);
+    XCTAssertTrue([self.store setValue:@"2" forAttribute:@"a"]);
+    XCTAssertEqualObjects([self.store snapshot], @{ @"a": @"2" });
+
+    XCTAssertTrue([self.store setValue:nil forAttribute:@"a"]);
+    XCTAssertNil([self.store snapshot]);
+    XCTAssertEqual(self.store.count, 0u);
+}
+
+- (void)testSetValue_RejectsEmptyAttributeAndRemovalFromEmptyStore
+{
+    XCTAssertFalse([self.store setValue:@"value" forAttribute:@""]);
+    XCTAssertFalse([self.store setValue:nil forAttribute:@"missing"]);
+    XCTAssertNil([self.store snapshot]);
+}
+
+- (void)testSetValue_CopiesMutableStrings
+{
+    NSMutableString *value = [NSMutableString stringWithString:@"before"];
+    [self.store setValue:value forAttribute:@"a"];
+    [value setString:@"after"];
+    XCTAssertEqualObjects([self.store snapshot][@"a"], @"before");
+}
+
+- (void)testSetAttributes_AppliesUpdatesAndNullRemovals
+{
+    [self.store setAttributes:@{ @"keep": @"1", @"drop": @"2" }];
+
+    XCTAssertTrue([self.store setAttributes:@{ @"drop": [NSNull null], @"new": @"3" }]);
+    XCTAssertEqualObjects([self.store snapshot], (@{ @"keep": @"1", @"new": @"3" }));
+}
+
+- (void)testSetAttributes_SkipsInvalidEntriesButAppliesTheRest
+{
+    XCTAssertFalse([self.store setAttributes:@{ @"": @"empty", @"number": @42, @"valid": @"yes" }]);
+    XCTAssertEqualObjects([self.store snapshot], @{ @"valid": @"yes" });
+}
+
+- (void)testSnapshot_IsCachedUntilNextChange
+{
+    [self.store setValue:@"1" forAttribute:@"a"];
+    NSDictionary *first = [self.store snapshot];
+    XCTAssertEqual([self.store snapshot], first, @"Unchanged store should return the same snapshot");
+
+    [self.store setValue:@"2" forAttribute:@"b"];
+    NSDictionary *second = [self.store snapshot];
+    XCTAssertNotEqual(second, first);
+    XCTAssertEqualObjects(first, @{ @"a": @"1" }, @"Earlier snapshots are immutable");
+}
+
+- (void)testConcurrentWriters_AllUpdatesLand
+{
+    const size_t writers = 8;
+    const NSUInteger perWriter = 500;
+    dispatch_apply(writers, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^(size_t writer) {
+        for (NSUInteger i = 0; i < perWriter; i++) {
+            NSString *attribute = [NSString stringWithFormat:@"w%zu-%lu", writer, (unsigned long)i];
+            [self.store setValue:@"v" forAttribute:attribute];
+            [self.store snapshot];
+        }
+    });
+    XCTAssertEqual(self.store.count, writers * perWriter);
+}
+
+#pragma mark - BugSplat customData debounce
+
+- (void)testAttributeChanges_AreCoalescedIntoOneCustomDataUpdate
+{
+    MockCrashReporter *reporter = [[MockCrashReporter alloc] init];
+    BugSplat *bugSplat = [BugSplat testInstanceWithCrashReporter:reporter
+                                                    crashStorage:[[MockCrashStorage alloc] init]
+                                                    userDefaults:[[MockUserDefaults alloc] init]
+                                                          bundle:[[MockBundle alloc] init]];
+    [reporter reset];
+
+    for (NSUInteger i = 0; i < 200; i++) {
+        [bugSplat setValue:[NSString stringWithFormat:@"%lu", (unsigned long)i] forAttribute:@"counter"];
+    }
+    [bugSplat setAttributes:@{ @"user-tier": @"gold" }];
+    XCTAssertEqual(reporter.customDataUpdateCount, 0u, @"Updates should not be written synchronously");
+
+    XCTestExpectation *settled = [self expectationWithDescription:@"debounce interval elapsed"];
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(0.5 * NSEC_PER_SEC)), dispatch_get_main_queue(), ^{
+        [settled fulfill];
+    });
+    [self waitForExpectationsWithTimeout:2.0 handler:nil];
+
+    XCTAssertEqual(reporter.customDataUpdateCount, 1u);
+    NSDictionary *metadata = [BugSplatMetadataCodec metadataWithData:reporter.customData];
+    XCTAssertEqualObjects(metadata[@"attributes"], (@{ @"counter": @"199", @"user-tier": @"gold" }));
+}
+
+@end
@@ -0,0 +1,285 @@
+//
+//  BugSplatCPUMonitorTests.m
+//  BugSplatTests
+//
+//  Tests for sustained high CPU detection: the sliding window on injected
+//  samples (budget, rate limiting, hottest threads), the monitor's delegate
+//  callback and live sampling, and the report BugSplat queues for it.
+//
+//  Copyright © BugSplat, LLC. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+
+#import <BugSplat/BugSplat.h>
+#import "BugSplat+Testing.h"
+#import "BugSplatCrashFilesTestCase.h"
+#import "BugSplatCPUMonitor.h"
+#import "BugSplatCPUUsage.h"
+#import "BugSplatMetadataCodec.h"
+
+#import <pthread.h>
+
+static const uint64_t kSecond = 1000000;
+
+@interface BugSplatCPUMonitorTests : BugSplatCrashFilesTestCase <BugSplatCPUMonitorDelegate>
+@property (nonatomic, strong, nullable) BugSplat *bugSplat;
+@property (nonatomic, assign) NSUInteger reportCount;
+@property (nonatomic, assign) double reportedUsage;
+@property (nonatomic, copy, nullable) NSArray<BugSplatCPUThreadUsage *> *reportedThreads;
+@end
+
+@implementation BugSplatCPUMonitorTests
+{
+    BugSplatCPUSample _storage[16];
+    BugSplatCPUWindow _window;
+}
+
+- (void)setUp
+{
+    [super setUp];
+    // 80% of one core over 60 s, one report per session.
+    BugSplatCPUWindowInit(&_window, _storage, 16, 0.8, 60 * kSecond, 1);
+}
+
+- (void)tearDown
+{
+    self.bugSplat = nil;
+    [super tearDown];
+}
+
+#pragma mark - Helpers
+
+/// A sample at `seconds` with thread 1 and thread 2 at the given cumulative CPU seconds; the
+/// process total is their sum plus 10 s used by threads that have exited.
+static BugSplatCPUSample Sample(double seconds, double thread1, double thread2)
+{
+    BugSplatCPUSample sample = {
+        .timestampUs = 1000 * kSecond + (uint64_t)(seconds * kSecond),
+        .processCPUTimeUs = (uint64_t)((10 + thread1 + thread2) * kSecond),
+        .threadCount = 2,
+    };
+    sample.threads[0] = (BugSplatThreadCPUTime){ 1, (uint64_t)(thread1 * kSecond) };
+    sample.threads[1] = (BugSplatThreadCPUTime){ 2, (uint64_t)(thread2 * kSecond) };
+    return sample;
+}
+
+- (void)cpuMonitor:(BugSplatCPUMonitor *)monitor
+didExceedBudgetWithUsage:(double)usage
+              span:(NSTimeInterval)span
+    hottestThreads:(NSArray<BugSplatCPUThreadUsage *> *)threads
+{
+    self.reportCount++;
+    self.reportedUsage = usage;
+    self.reportedThreads = threads;
+}
+
+#pragma mark - Window
+
+- (void)testWindow_WarmsUpUntilAFullWindowIsCovered
+{
+    BugSplatCPUSample sample = Sample(0, 0, 0);
+    XCTAssertEqual(BugSplatCPUWindowAdd(&_window, &sample).verdict, BugSplatCPUVerdictWarmingUp);
+    for (int t = 5; t < 60; t += 5) {
+        sample = Sample(t, t, 0);
+        XCTAssertEqual(BugSplatCPUWindowAdd(&_window, &sample).verdict, BugSplatCPUVerdictWarmingUp, @"t=%d", t);
+    }
+    sample = Sample(60, 60, 0);
+    BugSplatCPUEvaluation evaluation = BugSplatCPUWindowAdd(&_window, &sample);
+    XCTAssertEqual(evaluation.verdict, BugSplatCPUVerdictExceeded);
+    XCTAssertEqualWithAccuracy(evaluation.usage, 1.0, 0.001);
+    XCTAssertEqual(evaluation.spanUs, 60 * kSecond);
+}
+
+- (void)testWindow_BurstBelowAverageBudgetIsNotReported
+{
+    // A 20 s burst at a full core inside a minute that is otherwise idle: 33% on average.
+    for (int t = 0; t <= 120; t += 5) {
+        double busy = MIN(MAX(t - 30, 0), 20);
+        BugSplatCPUSample sample = Sample(t, busy, 0.01 * t);
+        BugSplatCPUEvaluation evaluation = BugSplatCPUWindowAdd(&_window, &sample);
+        XCTAssertNotEqual(evaluation.verdict, BugSplatCPUVerdictExceeded, @"t=%d", t);
+        XCTAssertNotEqual(evaluation.verdict, BugSplatCPUVerdictStillExceeded, @"t=%d", t);
+    }
+}
+
+- (void)testWindow_ReportsOncePerStretchAndRespectsSessionLimit
+{
+    BugSplatCPUWindowInit(&_window, _storage, 16, 0.8, 60 * kSecond, 2);
+    NSMutableArray<NSNumber *> *reportedAt = [NSMutableArray array];
+    double thread1 = 0;
+    for (int t = 0; t <= 400; t += 5) {
+        // Three stretches of spinning a thread, with idle minutes between them.
+        BOOL spinning = (t > 0 && t <= 120) || (t > 240 && t <= 300) || t > 360;
+        if (spinning) {
+            thread1 += 5 * 0.95;
+        }
+        BugSplatCPUSample sample = Sample(t, thread1, 0);
+        if (BugSplatCPUWindowAdd(&_window, &sample).verdict == BugSplatCPUVerdictExceeded) {
+            [reportedAt addObject:@(t)];
+        }
+    }
+    // The first stretch once, the second once; the third is over the session's two reports.
+    XCTAssertEqualObjects(reportedAt, (@[@60, @295]));
+    XCTAssertEqual(_window.reportCount, 2u);
+}
+
+- (void)testWindow_HottestThreadsAreBusiestFirstAndSkipIdleThreads
+{
+    BugSplatCPUSample sample = Sample(0, 100, 50);
+    BugSplatCPUWindowAdd(&_window, &sample);
+    sample = Sample(60, 154, 53);
+    sample.threads[2] = (BugSplatThreadCPUTime){ 3, 30 * kSecond }; // started within the window
+    sample.threads[3] = (BugSplatThreadCPUTime){ 4, 0 };            // idle
+    sample.threadCount = 4;
+    sample.processCPUTimeUs += 30 * kSecond;
+    BugSplatCPUEvaluation evaluation = BugSplatCPUWindowAdd(&_window, &sample);
+    XCTAssertEqual(evaluation.verdict, BugSplatCPUVerdictExceeded);
+    XCTAssertEqualWithAccuracy(evaluation.usage, (54.0 + 3 + 30) / 60, 0.001);
+
+    BugSplatThreadCPUUsage threads[8];
+    size_t count = BugSplatCPUWindowHottestThreads(&_window, threads, 8);
+    XCTAssertEqual(count, 3u);
+    XCTAssertEqual(threads[0].threadId, 1u);
+    XCTAssertEqualWithAccuracy(threads[0].usage, 0.9, 0.001);
+    XCTAssertEqual(threads[1].threadId, 3u);
+    XCTAssertEqualWithAccuracy(threads[1].usage, 0.5, 0.001);
+    XCTAssertEqual(threads[2].threadId, 2u);
+
+    XCTAssertEqual(BugSplatCPUWindowHottestThreads(&_window, threads, 1), 1u);
+    XCTAssertEqual(threads[0].threadId, 1u);
+}
+
+- (void)testWindow_ClockGoingBackwardsStartsOver
+{
+    BugSplatCPUSample sample = Sample(0, 0, 0);
+    BugSplatCPUWindowAdd(&_window, &sample);
+    sample = Sample(60, 60, 0);
+    XCTAssertEqual(BugSplatCPUWindowAdd(&_window, &sample).verdict, BugSplatCPUVerdictExceeded);
+
+    sample = Sample(30, 90, 0);
+    XCTAssertEqual(BugSplatCPUWindowAdd(&_window, &sample).verdict, BugSplatCPUVerdictWarmingUp);
+    XCTAssertEqual(_window.count, 1u);
+    XCTAssertEqual(_window.reportCount, 1u, @"A reset keeps the session's report count");
+}
+
+#pragma mark - Monitor
+
+- (void)testMonitor_InjectedSamplesReachDelegate
+{
+    BugSplatCPUMonitor *monitor = [[BugSplatCPUMonitor alloc] initWithBudget:0.8 window:60 maxReports:1 delegate:self isDebuggerAttachedBlock:nil];
+    XCTAssertEqualWithAccuracy(monitor.sampleInterval, 5.0, 0.001);
+
+    for (int t = 0; t <= 120; t += 5) {
+        BugSplatCPUSample sample = Sample(t, 0.9 * t, 0.05 * t);
+        [monitor processSample:&sample];
+    }
+    XCTAssertEqual(self.reportCount, 1u);
+    XCTAssertEqualWithAccuracy(self.reportedUsage, 0.95, 0.001);
+    XCTAssertEqual(self.reportedThreads.count, 2u);
+    XCTAssertEqual(self.reportedThreads[0].threadId, 1u);
+    XCTAssertEqualWithAccuracy(self.reportedThreads[0].usage, 0.9, 0.001);
+    XCTAssertEqual(self.reportedThreads[0].thread, MACH_PORT_NULL, @"No such thread in this process");
+    XCTAssertEqualObjects([self.reportedThreads[0] displayName], @"thread 0x1");
+}
+
+- (void)testMonitor_NothingReportedWhileDebuggerAttached
+{
+    __block BOOL attached = YES;
+    BugSplatCPUMonitor *monitor = [[BugSplatCPUMonitor alloc] initWithBudget:0.8 window:60 maxReports:0 delegate:self isDebuggerAttachedBlock:^BOOL{
+        return attached;
+    }];
+    for (int t = 0; t <= 120; t += 5) {
+        BugSplatCPUSample sample = Sample(t, t, 0);
+        [monitor processSample:&sample];
+    }
+    XCTAssertEqual(self.reportCount, 0u);
+
+    attached = NO;
+    for (int t = 125; t <= 185; t += 5) {
+        BugSplatCPUSample sample = Sample(t, t, 0);
+        [monitor processSample:&sample];
+    }
+    XCTAssertEqual(self.reportCount, 1u, @"A full window after the debugger let go");
+}
+
+- (void)testMonitor_SamplesCurrentProcess
+{
+    BugSplatCPUSample first, second;
+    [BugSplatCPUMonitor sampleCurrentProcess:&first];
+    uint64_t threadId = 0;
+    pthread_threadid_np(NULL, &threadId);
+
+    // Burn a little CPU on this thread.
+    volatile double sink = 0;
+    CFAbsoluteTime until = CFAbsoluteTimeGetCurrent() + 0.05;
+    while (CFAbsoluteTimeGetCurrent() < until) {
+        sink += 1.0;
+    }
+    [BugSplatCPUMonitor sampleCurrentProcess:&second];
+
+    XCTAssertGreaterThan(second.timestampUs, first.timestampUs);
+    XCTAssertGreaterThan(second.processCPUTimeUs, first.processCPUTimeUs);
+    XCTAssertGreaterThan(second.threadCount, 0u);
+    uint64_t before = 0, after = 0;
+    for (uint32_t i = 0; i < first.threadCount; i++) {
+        if (first.threads[i].threadId == threadId) before = first.threads[i].cpuTimeUs;
+    }
+    for (uint32_t i = 0; i < second.threadCount; i++) {
+        if (second.threads[i].threadId == threadId) after = second.threads[i].cpuTimeUs;
+    }
+    XCTAssertGreaterThan(after, before, @"This thread's CPU time is sampled");
+}
+
+#pragma mark - Reports
+
+- (void)testCPUReport_NamesHottestThreadAndIsQueuedSilently
+{
+    self.bugSplat = [[BugSplat alloc] init];
+    [self snapshotCrashFilesOfBugSplat:self.bugSplat];
+    pthread_setname_np("com.example.spinner");
+    uint64_t threadId = 0;
+    pthread_threadid_np(NULL, &threadId);
+
+    // This thread as the busiest, so the report has a live port to mark as crashed.
+    BugSplatCPUMonitor *monitor = [[BugSplatCPUMonitor alloc] initWithBudget:0.8 window:60 maxReports:1 delegate:self isDebuggerAttachedBlock:nil];
+    for (int t = 0; t <= 60; t += 5) {
+        BugSplatCPUSample sample = Sample(t, 0.05 * t, 0);
+        sample.threads[2] = (BugSplatThreadCPUTime){ threadId, (uint64_t)(0.88 * t * kSecond) };
+        sample.threadCount = 3;
+        sample.processCPUTimeUs += sample.threads[2].cpuTimeUs;
+        [monitor processSample:&sample];
+    }
+    pthread_setname_np("");
+    XCTAssertEqual(self.reportCount, 1u);
+    XCTAssertEqualObjects(self.reportedThreads.firstObject.name, @"com.example.spinner");
+    XCTAssertNotEqual(self.reportedThreads.firstObject.thread, MACH_PORT_NULL);
+
+    NSString *filename = [self.bugSplat persistCPUReportWithUsage:self.reportedUsage budget:0.8 span:60 hottestThreads:self.reportedThreads];
+    XCTAssertTrue([filename hasSuffix:@"-cpu"]);
+    NSString *basePath = [[self.bugSplat crashesDirectoryPath] stringByAppendingPathComponent:filename];
+
+    NSString *text = [NSString stringWithContentsOfFile:[basePath stringByAppendingPathExtension:@"crash"] encoding:NSUTF8StringEncoding error:nil];
+    XCTAssertTrue([text containsString:@"Excessive CPU Use"]);
+
+    NSDictionary *metadata = [BugSplatMetadataCodec metadataWithContentsOfFile:[basePath stringByAppendingPathExtension:@"meta"]];
+    NSDictionary *attributes = metadata[@"attributes"];
+    XCTAssertEqualObjects(attributes[@"bugsplat-cpu-percent"], @"93.0");
+    XCTAssertEqualObjects(attributes[@"bugsplat-cpu-budget-percent"], @"80");
+    XCTAssertEqualObjects(attributes[@"bugsplat-cpu-window-seconds"], @"60");
+    XCTAssertEqualObjects(attributes[@"bugsplat-cpu-hot-threads"], @"com.example.spinner 88.0%, thread 0x1 5.0%");
+    XCTAssertEqualObjects(metadata[@"userSubmitted"], @YES);
+}
+
+- (void)testStart_CPUMonitoringDisabledByDefault
+{
+    self.bugSplat = [[BugSplat alloc] init];
+    XCTAssertFalse(self.bugSplat.enableCPUMonitoring);
+    XCTAssertEqualWithAccuracy(self.bugSplat.cpuUsageBudget, 0.8, 0.001);
+    XCTAssertEqual(self.bugSplat.cpuUsageWindow, 60.0);
+    XCTAssertEqual(self.bugSplat.maxCPUReportsPerSession, 1u);
+    [self.bugSplat startCPUMonitoringIfEnabled];
+    XCTAssertNil([self.bugSplat cpuMonitor]);
+}
+
+@end
@@ -0,0 +1,222 @@
+//
+//  BugSplatCallTreeTests.m
+//  BugSplatTests
+//
+//  Tests for the hang profiler: merging synthetic stack samples into a
+//  weighted call tree, its text form, and sampling a real thread.
+//
+//  Copyright © BugSplat, LLC. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+#import <pthread.h>
+
+#import "BugSplatCallTree.h"
+#import "BugSplatHangSampler.h"
+#import "BugSplatImageList.h"
+
+@interface BugSplatCallTreeTests : XCTestCase
+@property (nonatomic, strong) NSMutableData *nodes;
+@end
+
+@implementation BugSplatCallTreeTests
+{
+    BugSplatCallTree _tree;
+}
+
+- (void)setUp
+{
+    [super setUp];
+    [self useNodeCapacity:64];
+}
+
+- (void)useNodeCapacity:(size_t)capacity
+{
+    self.nodes = [NSMutableData dataWithLength:capacity * sizeof(BugSplatCallTreeNode)];
+    XCTAssertTrue(BugSplatCallTreeInit(&_tree, self.nodes.mutableBytes, capacity));
+}
+
+#pragma mark - Helpers
+
+/// Add a sample written outermost first ("main,run,work") to match how the output reads.
+- (void)addPath:(NSString *)path times:(NSUInteger)times
+{
+    NSArray<NSString *> *names = [path componentsSeparatedByString:@","];
+    uint64_t frames[16];
+    for (NSUInteger i = 0; i < names.count; i++) {
+        frames[names.count - 1 - i] = strtoull(names[i].UTF8String, NULL, 16);
+    }
+    for (NSUInteger i = 0; i < times; i++) {
+        BugSplatCallTreeAddSample(&_tree, frames, names.count);
+    }
+}
+
+- (NSString *)textWithMinWeight:(uint32_t)minWeight capacity:(size_t)capacity
+{
+    NSMutableData *buffer = [NSMutableData dataWithLength:capacity];
+    size_t length = BugSplatCallTreeWrite(&_tree, minWeight, NULL, NULL, buffer.mutableBytes, buffer.length);
+    XCTAssertEqual(strlen(buffer.bytes), length);
+    return [[NSString alloc] initWithBytes:buffer.bytes length:length encoding:NSUTF8StringEncoding];
+}
+
+static size_t UppercaseSymbolizer(uint64_t address, char *buffer, size_t capacity, void *context)
+{
+    int length = snprintf(buffer, capacity, "%s_%llX", (const char *)context, address);
+    return (size_t)length;
+}
+
+#pragma mark - Aggregation
+
+- (void)testEmptyTree_WritesOnlyHeader
+{
+    XCTAssertEqualObjects([self textWithMinWeight:0 capacity:256], @"samples 0\n");
+}
+
+- (void)testIdenticalStacks_ShareOnePath
+{
+    [self addPath:@"a,b,c" times:3];
+    NSString *expected = @"samples 3\n"
+                          "0 3 0 0xa\n"
+                          "1 3 0 0xb\n"
+                          "2 3 3 0xc\n";
+    XCTAssertEqualObjects([self textWithMinWeight:0 capacity:256], expected);
+    XCTAssertEqual(_tree.count, 4u, @"Root plus one node per frame");
+}
+
+- (void)testBranches_HeaviestFirstWithSelfWeights
+{
+    [self addPath:@"a,b,d" times:1];
+    [self addPath:@"a,b,c" times:4];
+    [self addPath:@"a,b" times:2];
+    [self addPath:@"e" times:1];
+    NSString *expected = @"samples 8\n"
+                          "0 7 0 0xa\n"
+                          "1 7 2 0xb\n"
+                          "2 4 4 0xc\n"
+                          "2 1 1 0xd\n"
+                          "0 1 1 0xe\n";
+    XCTAssertEqualObjects([self textWithMinWeight:0 capacity:256], expected);
+}
+
+- (void)testEqualWeights_OrderedByAddress
+{
+    [self addPath:@"a,30" times:1];
+    [self addPath:@"a,10" times:1];
+    [self addPath:@"a,20" times:1];
+    NSArray<NSString *> *lines = [[self textWithMinWeight:0 capacity:256] componentsSeparatedByString:@"\n"];
+    XCTAssertEqualObjects([lines subarrayWithRange:NSMakeRange(2, 3)], (@[ @"1 1 1 0x10", @"1 1 1 0x20", @"1 1 1 0x30" ]));
+}
+
+- (void)testMinWeight_PrunesLightSubtrees
+{
+    [self addPath:@"a,b" times:5];
+    [self addPath:@"a,c,d" times:1];
+    [self addPath:@"e" times:1];
+    NSString *expected = @"samples 7\n"
+                          "0 6 0 0xa\n"
+                          "1 5 5 0xb\n";
+    XCTAssertEqualObjects([self textWithMinWeight:2 capacity:256], expected);
+}
+
+- (void)testFullNodeArray_CountsTruncatedSamples
+{
+    [self useNodeCapacity:3];
+    [self addPath:@"a,b,c" times:2];
+    NSString *expected = @"samples 2 truncated 2\n"
+                          "0 2 0 0xa\n"
+                          "1 2 2 0xb\n";
+    XCTAssertEqualObjects([self textWithMinWeight:0 capacity:256], expected, @"Weight stops at the deepest node that fit");
+}
+
+- (void)testSmallBuffer_WritesWholeLinesOnly
+{
+    [self addPath:@"a,b,c" times:1];
+    NSString *text = [self textWithMinWeight:0 capacity:25];
+    XCTAssertEqualObjects(text, @"samples 1\n0 1 0 0xa\n");
+}
+
+- (void)testReset_DropsSamples
+{
+    [self addPath:@"a,b" times:2];
+    BugSplatCallTreeReset(&_tree);
+    XCTAssertEqual(_tree.samples, 0u);
+    XCTAssertEqual(_tree.count, 1u);
+    XCTAssertEqualObjects([self textWithMinWeight:0 capacity:256], @"samples 0\n");
+}
+
+- (void)testSymbolizer_LabelsEveryFrame
+{
+    [self addPath:@"a,b" times:1];
+    NSMutableData *buffer = [NSMutableData dataWithLength:256];
+    BugSplatCallTreeWrite(&_tree, 0, UppercaseSymbolizer, "fn", buffer.mutableBytes, buffer.length);
+    XCTAssertEqualObjects([NSString stringWithUTF8String:buffer.bytes], @"samples 1\n0 1 0 fn_A\n1 1 1 fn_B\n");
+}
+
+#pragma mark - Sampling a real thread
+
+- (void)testSampleThreadStack_WalksABlockedThread
+{
+    dispatch_semaphore_t started = dispatch_semaphore_create(0);
+    dispatch_semaphore_t release = dispatch_semaphore_create(0);
+    __block thread_t blockedThread = MACH_PORT_NULL;
+    dispatch_async(dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^{
+        blockedThread = pthread_mach_thread_np(pthread_self());
+        dispatch_semaphore_signal(started);
+        dispatch_semaphore_wait(release, DISPATCH_TIME_FOREVER);
+    });
+    dispatch_semaphore_wait(started, DISPATCH_TIME_FOREVER);
+    [NSThread sleepForTimeInterval:0.05];
+
+    uint64_t frames[128];
+    size_t count = BugSplatSampleThreadStack(blockedThread, frames, 128);
+    dispatch_semaphore_signal(release);
+
+    XCTAssertGreaterThan(count, 3u, @"Blocked in a semaphore wait under the dispatch worker frames");
+    for (size_t i = 0; i < count; i++) {
+        XCTAssertNotEqual(frames[i], 0u);
+    }
+    XCTAssertEqual(BugSplatSampleThreadStack(pthread_mach_thread_np(pthread_self()), frames, 128), 0u,
+                   @"A thread cannot sample itself");
+}
+
+- (void)testSampler_ProfilesUntilFinished
+{
+    BugSplatHangSampler *sampler = [[BugSplatHangSampler alloc] initWithThread:pthread_mach_thread_np(pthread_self())
+                                                                      interval:0.005
+                                                                    maxSamples:1000];
+    XCTAssertNil([sampler finish], @"Nothing sampled yet");
+
+    [sampler begin];
+    [NSThread sleepForTimeInterval:0.1]; // "Hang" the sampled thread.
+    NSData *profile = [sampler finish];
+    NSString *text = [[NSString alloc] initWithData:profile encoding:NSUTF8StringEncoding];
+    XCTAssertTrue([text hasPrefix:@"samples "], @"%@", text);
+    XCTAssertGreaterThan([[text componentsSeparatedByString:@"\n"] count], 3u);
+    XCTAssertTrue([text containsString:@"\nBinary Images:\n"], @"%@", text);
+    XCTAssertNil([sampler finish], @"Finishing consumes the samples");
+
+    [sampler begin];
+    [sampler cancel];
+    XCTAssertNil([sampler finish]);
+}
+
+- (void)testSymbolicatedProfile_AddsSymbolsForImagesStillLoaded
+{
+    BugSplatImageListInstall();
+    BugSplatImage image;
+    uint64_t address = (uint64_t)(uintptr_t)BugSplatSampleThreadStack;
+    XCTAssertTrue(BugSplatImageListFindAddress(address, &image));
+    char uuid[BugSplatImageUUIDStringLength];
+    BugSplatImageFormatUUID(image.uuid, uuid);
+
+    NSString *profile = [NSString stringWithFormat:
+                         @"samples 2\n0 2 0 %s+0x%llx\n1 2 2 Gone+0x10\nBinary Images:\n%s %s\n0123456789abcdef0123456789abcdef Gone\n",
+                         image.name, address - image.base, uuid, image.name];
+    NSString *text = [[NSString alloc] initWithData:[BugSplatHangSampler symbolicatedProfile:[profile dataUsingEncoding:NSUTF8StringEncoding]]
+                                           encoding:NSUTF8StringEncoding];
+    NSString *expectedFrame = [NSString stringWithFormat:@"0 2 0 %s+0x%llx BugSplatSampleThreadStack\n", image.name, address - image.base];
+    XCTAssertTrue([text containsString:expectedFrame], @"%@", text);
+    XCTAssertTrue([text containsString:@"\n1 2 2 Gone+0x10\n"], @"Images not loaded are left alone: %@", text);
+}
+
+@end
@@ -0,0 +1,28 @@
+//
+//  BugSplatCrashFilesTestCase.h
+//  BugSplatTests
+//
+//  Base class for tests that make BugSplat queue reports in the real crashes directory.
+//  Snapshot the directory before the code under test runs; everything added since is
+//  listed by -newCrashFiles and deleted in -tearDown.
+//
+//  Copyright © BugSplat, LLC. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+
+@class BugSplat;
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface BugSplatCrashFilesTestCase : XCTestCase
+
+/// Remember what `bugSplat`'s crashes directory holds now. Can be called again to move the baseline.
+- (void)snapshotCrashFilesOfBugSplat:(BugSplat *)bugSplat;
+
+/// Files added to the crashes directory since the snapshot; empty without one.
+- (NSArray<NSString *> *)newCrashFiles;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,46 @@
+//
+//  BugSplatCrashFilesTestCase.m
+//  BugSplatTests
+//
+//  Copyright © BugSplat, LLC. All rights reserved.
+//
+
+#import "BugSplatCrashFilesTestCase.h"
+
+#import <BugSplat/BugSplat.h>
+#import "BugSplat+Testing.h"
+
+@implementation BugSplatCrashFilesTestCase
+{
+    NSString *_crashesDirectory;
+    NSArray<NSString *> *_crashFilesBefore;
+}
+
+- (void)tearDown
+{
+    for (NSString *file in [self newCrashFiles]) {
+        [[NSFileManager defaultManager] removeItemAtPath:[_crashesDirectory stringByAppendingPathComponent:file] error:nil];
+    }
+    _crashesDirectory = nil;
+    _crashFilesBefore = nil;
+    [super tearDown];
+}
+
+- (void)snapshotCrashFilesOfBugSplat:(BugSplat *)bugSplat
+{
+    _crashesDirectory = [bugSplat crashesDirectoryPath];
+    _crashFilesBefore = [[NSFileManager defaultManager] contentsOfDirectoryAtPath:_crashesDirectory error:nil] ?: @[];
+}
+
+- (NSArray<NSString *> *)newCrashFiles
+{
+    if (!_crashesDirectory) {
+        return @[];
+    }
+    NSArray<NSString *> *files = [[NSFileManager defaultManager] contentsOfDirectoryAtPath:_crashesDirectory error:nil] ?: @[];
+    NSMutableArray<NSString *> *added = [files mutableCopy];
+    [added removeObjectsInArray:_crashFilesBefore];
+    return added;
+}
+
+@end
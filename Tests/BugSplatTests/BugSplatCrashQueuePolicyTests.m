@@ -0,0 +1,107 @@
+//
+//  BugSplatCrashQueuePolicyTests.m
+//  BugSplatTests
+//
+//  Tests for crash queue quota enforcement order.
+//
+//  Copyright © BugSplat, LLC. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+
+#import "BugSplatCrashQueuePolicy.h"
+
+@interface BugSplatCrashQueuePolicyTests : XCTestCase
+@property (nonatomic, strong) NSDate *now;
+@end
+
+@implementation BugSplatCrashQueuePolicyTests
+
+- (void)setUp
+{
+    [super setUp];
+    self.now = [NSDate dateWithTimeIntervalSinceReferenceDate:1000000];
+}
+
+#pragma mark - Helpers
+
+- (BugSplatQueuedReport *)report:(NSString *)name
+                          ageDays:(double)ageDays
+                            bytes:(unsigned long long)bytes
+                         priority:(BugSplatQueuedReportPriority)priority
+{
+    return [[BugSplatQueuedReport alloc] initWithFilename:name
+                                                timestamp:[self.now dateByAddingTimeInterval:-ageDays * 86400.0]
+                                                 byteSize:bytes
+                                                 priority:priority];
+}
+
+- (NSArray<NSString *> *)filenames:(NSArray<BugSplatQueuedReport *> *)reports
+{
+    return [reports valueForKey:@"filename"];
+}
+
+#pragma mark - Tests
+
+- (void)testPolicy_NoQuotasEvictsNothing
+{
+    BugSplatCrashQueuePolicy *policy = [[BugSplatCrashQueuePolicy alloc] init];
+    NSArray *reports = @[[self report:@"a" ageDays:400 bytes:1 << 30 priority:BugSplatQueuedReportPriorityNormal],
+                         [self report:@"b" ageDays:1 bytes:1 priority:BugSplatQueuedReportPriorityNormal]];
+    XCTAssertFalse(policy.isEnabled);
+    XCTAssertEqual([policy reportsToEvictFromReports:reports now:self.now].count, 0);
+}
+
+- (void)testPolicy_EvictsExpiredReportsButKeepsNewest
+{
+    BugSplatCrashQueuePolicy *policy = [[BugSplatCrashQueuePolicy alloc] init];
+    policy.maximumAge = 30 * 86400.0;
+    NSArray *reports = @[[self report:@"old" ageDays:60 bytes:10 priority:BugSplatQueuedReportPriorityHigh],
+                         [self report:@"older" ageDays:90 bytes:10 priority:BugSplatQueuedReportPriorityNormal],
+                         [self report:@"newest" ageDays:45 bytes:10 priority:BugSplatQueuedReportPriorityNormal]];
+
+    NSArray<BugSplatQueuedReport *> *evicted = [policy reportsToEvictFromReports:reports now:self.now];
+    XCTAssertEqualObjects([self filenames:evicted], (@[@"older", @"old"]));
+    XCTAssertEqual(evicted.firstObject.evictionReason, BugSplatEvictionReasonAge);
+}
+
+- (void)testPolicy_CountQuotaEvictsLowestPriorityThenOldest
+{
+    BugSplatCrashQueuePolicy *policy = [[BugSplatCrashQueuePolicy alloc] init];
+    policy.maximumCount = 2;
+    NSArray *reports = @[[self report:@"crash-1" ageDays:5 bytes:10 priority:BugSplatQueuedReportPriorityNormal],
+                         [self report:@"hang" ageDays:3 bytes:10 priority:BugSplatQueuedReportPriorityLow],
+                         [self report:@"crash-2" ageDays:4 bytes:10 priority:BugSplatQueuedReportPriorityNormal],
+                         [self report:@"newest" ageDays:1 bytes:10 priority:BugSplatQueuedReportPriorityLow]];
+
+    NSArray<BugSplatQueuedReport *> *evicted = [policy reportsToEvictFromReports:reports now:self.now];
+    XCTAssertEqualObjects([self filenames:evicted], (@[@"hang", @"crash-1"]));
+    XCTAssertEqual(evicted.lastObject.evictionReason, BugSplatEvictionReasonCount);
+}
+
+- (void)testPolicy_SizeQuotaEvictsUntilUnderLimit
+{
+    BugSplatCrashQueuePolicy *policy = [[BugSplatCrashQueuePolicy alloc] init];
+    policy.maximumBytes = 250;
+    NSArray *reports = @[[self report:@"a" ageDays:3 bytes:100 priority:BugSplatQueuedReportPriorityHigh],
+                         [self report:@"b" ageDays:2 bytes:100 priority:BugSplatQueuedReportPriorityNormal],
+                         [self report:@"c" ageDays:1 bytes:100 priority:BugSplatQueuedReportPriorityNormal]];
+
+    NSArray<BugSplatQueuedReport *> *evicted = [policy reportsToEvictFromReports:reports now:self.now];
+    XCTAssertEqualObjects([self filenames:evicted], (@[@"b"]));
+    XCTAssertEqual(evicted.firstObject.evictionReason, BugSplatEvictionReasonSize);
+}
+
+- (void)testPolicy_NewestReportSurvivesEvenIfItAloneExceedsQuota
+{
+    BugSplatCrashQueuePolicy *policy = [[BugSplatCrashQueuePolicy alloc] init];
+    policy.maximumBytes = 10;
+    policy.maximumCount = 1;
+    NSArray *reports = @[[self report:@"a" ageDays:2 bytes:5 priority:BugSplatQueuedReportPriorityNormal],
+                         [self report:@"huge" ageDays:1 bytes:1000 priority:BugSplatQueuedReportPriorityLow]];
+
+    NSArray<BugSplatQueuedReport *> *evicted = [policy reportsToEvictFromReports:reports now:self.now];
+    XCTAssertEqualObjects([self filenames:evicted], (@[@"a"]));
+}
+
+@end
@@ -0,0 +1,238 @@
+//
+//  BugSplatCrashReportTextWriterTests.m
+//  BugSplatTests
+//
+//  The streaming text writer must reproduce PLCrashReportTextFormatter's iOS
+//  format byte for byte. The corpus is generated with a real PLCrashReporter
+//  so it covers the images, threads and registers of the machine running the
+//  tests.
+//
+//  Copyright © BugSplat, LLC. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+#import <CrashReporter/CrashReporter.h>
+
+#import "BugSplatCrashReportTextWriter.h"
+
+@interface BugSplatCrashReportTextWriterTests : XCTestCase
+@property (nonatomic, strong) PLCrashReporter *reporter;
+@property (nonatomic, copy) NSString *outputPath;
+@end
+
+@implementation BugSplatCrashReportTextWriterTests
+
+- (void)setUp
+{
+    [super setUp];
+    PLCrashReporterConfig *config = [[PLCrashReporterConfig alloc] initWithSignalHandlerType:PLCrashReporterSignalHandlerTypeBSD
+                                                                       symbolicationStrategy:PLCrashReporterSymbolicationStrategyAll];
+    self.reporter = [[PLCrashReporter alloc] initWithConfiguration:config];
+    self.outputPath = [NSTemporaryDirectory() stringByAppendingPathComponent:
+                       [NSString stringWithFormat:@"BugSplatTextWriter-%@.crash", [NSUUID UUID].UUIDString]];
+}
+
+- (void)tearDown
+{
+    [[NSFileManager defaultManager] removeItemAtPath:self.outputPath error:nil];
+    [super tearDown];
+}
+
+#pragma mark - Helpers
+
+- (PLCrashReport *)parse:(NSData *)data
+{
+    NSError *error = nil;
+    PLCrashReport *report = [[PLCrashReport alloc] initWithData:data error:&error];
+    XCTAssertNotNil(report, @"%@", error);
+    return report;
+}
+
+- (NSArray<PLCrashReport *> *)corpus
+{
+    NSMutableArray<PLCrashReport *> *corpus = [NSMutableArray array];
+
+    // Plain live report: signal info, all threads, no exception.
+    [corpus addObject:[self parse:[self.reporter generateLiveReportAndReturnError:nil]]];
+
+    // Uncaught-exception style report with an exception backtrace and a non-ASCII reason.
+    NSException *exception = nil;
+    @try {
+        @throw [NSException exceptionWithName:NSInvalidArgumentException reason:@"Bad argument — «ünïcode»" userInfo:nil];
+    } @catch (NSException *caught) {
+        exception = caught;
+    }
+    [corpus addObject:[self parse:[self.reporter generateLiveReportWithException:exception error:nil]]];
+
+    // Hang-style report: exception without backtrace, captured for another thread.
+    __block NSData *threadReport = nil;
+    mach_port_t mainThread = pthread_mach_thread_np(pthread_self());
+    dispatch_sync(dispatch_get_global_queue(QOS_CLASS_DEFAULT, 0), ^{
+        NSException *hang = [NSException exceptionWithName:@"App Hang (Fatal)" reason:@"Main thread unresponsive for 2000 ms" userInfo:nil];
+        threadReport = [self.reporter generateLiveReportWithThread:mainThread exception:hang error:nil];
+    });
+    [corpus addObject:[self parse:threadReport]];
+
+    return corpus;
+}
+
+- (NSData *)referenceTextForReport:(PLCrashReport *)report
+{
+    NSString *text = [PLCrashReportTextFormatter stringValueForCrashReport:report withTextFormat:PLCrashReportTextFormatiOS];
+    return [text dataUsingEncoding:NSUTF8StringEncoding];
+}
+
+#pragma mark - Output matches PLCrashReportTextFormatter
+
+- (void)testCorpus_MatchesStringFormatterByteForByte
+{
+    NSUInteger index = 0;
+    for (PLCrashReport *report in [self corpus]) {
+        NSData *expected = [self referenceTextForReport:report];
+        NSData *actual = [BugSplatCrashReportTextWriter dataForCrashReport:report];
+        XCTAssertEqualObjects(actual, expected, @"Corpus report %lu differs:\n%@",
+                              (unsigned long)index, [[NSString alloc] initWithData:actual encoding:NSUTF8StringEncoding]);
+        index++;
+    }
+}
+
+- (void)testWriteToFile_MatchesStringFormatter
+{
+    for (PLCrashReport *report in [self corpus]) {
+        XCTAssertTrue([BugSplatCrashReportTextWriter writeCrashReport:report toFile:self.outputPath]);
+        XCTAssertEqualObjects([NSData dataWithContentsOfFile:self.outputPath], [self referenceTextForReport:report]);
+    }
+    NSString *temporaryPath = [self.outputPath stringByAppendingString:@".tmp"];
+    XCTAssertFalse([[NSFileManager defaultManager] fileExistsAtPath:temporaryPath]);
+}
+
+#pragma mark - File sink
+
+- (void)testFileSink_SmallBufferFlushesEverything
+{
+    BugSplatFileTextSink *sink = [[BugSplatFileTextSink alloc] initWithPath:self.outputPath bufferSize:512];
+    XCTAssertNotNil(sink);
+
+    NSMutableData *expected = [NSMutableData data];
+    for (NSUInteger i = 0; i < 300; i++) {
+        NSData *line = [[NSString stringWithFormat:@"line %lu of the report\n", (unsigned long)i] dataUsingEncoding:NSUTF8StringEncoding];
+        XCTAssertTrue([sink writeBytes:line.bytes length:line.length]);
+        [expected appendData:line];
+    }
+    XCTAssertEqual(sink.bytesWritten, (unsigned long long)expected.length);
+    XCTAssertTrue([sink close]);
+
+    XCTAssertEqualObjects([NSData dataWithContentsOfFile:self.outputPath], expected);
+    XCTAssertFalse([sink writeBytes:"x" length:1], @"A closed sink rejects writes");
+}
+
+- (void)testFileSink_UnwritablePathReturnsNil
+{
+    NSString *path = [NSTemporaryDirectory() stringByAppendingPathComponent:@"does-not-exist/report.crash"];
+    XCTAssertNil([[BugSplatFileTextSink alloc] initWithPath:path bufferSize:4096]);
+    XCTAssertFalse([BugSplatCrashReportTextWriter writeCrashReport:[self corpus].firstObject toFile:path]);
+}
+
+#pragma mark - Slimming
+
+- (NSArray<NSString *> *)linesOfData:(NSData *)data
+{
+    NSString *text = [[NSString alloc] initWithData:data encoding:NSUTF8StringEncoding];
+    return [text componentsSeparatedByString:@"\n"];
+}
+
+/// Number of frame lines written under each "Thread N:" / "Thread N Crashed:" header.
+- (NSDictionary<NSNumber *, NSNumber *> *)frameCountsByThreadInText:(NSData *)data
+{
+    NSMutableDictionary<NSNumber *, NSNumber *> *counts = [NSMutableDictionary dictionary];
+    NSNumber *currentThread = nil;
+    for (NSString *line in [self linesOfData:data]) {
+        NSInteger threadNumber = 0;
+        NSScanner *scanner = [NSScanner scannerWithString:line];
+        if ([scanner scanString:@"Thread " intoString:NULL] && [scanner scanInteger:&threadNumber]
+            && ([line hasSuffix:@" Crashed:"] || [line hasSuffix:@":"]) && ![line containsString:@"Thread State"]) {
+            currentThread = @(threadNumber);
+            counts[currentThread] = @0;
+        } else if (line.length == 0) {
+            currentThread = nil;
+        } else if (currentThread) {
+            counts[currentThread] = @(counts[currentThread].integerValue + 1);
+        }
+    }
+    return counts;
+}
+
+- (NSArray<NSString *> *)binaryImageLinesInText:(NSData *)data
+{
+    NSArray<NSString *> *lines = [self linesOfData:data];
+    NSUInteger start = [lines indexOfObject:@"Binary Images:"];
+    XCTAssertNotEqual(start, NSNotFound);
+    NSArray<NSString *> *imageLines = [lines subarrayWithRange:NSMakeRange(start + 1, lines.count - start - 1)];
+    return [imageLines filteredArrayUsingPredicate:[NSPredicate predicateWithFormat:@"length > 0"]];
+}
+
+- (void)testDefaultOptions_MatchStringFormatter
+{
+    PLCrashReport *report = [self corpus].firstObject;
+    BugSplatCrashReportTextOptions *options = [[BugSplatCrashReportTextOptions alloc] init];
+    XCTAssertEqualObjects([BugSplatCrashReportTextWriter dataForCrashReport:report options:options],
+                          [self referenceTextForReport:report]);
+}
+
+- (void)testSlimOptions_CapOtherThreadsOnly
+{
+    const NSUInteger limit = 2;
+    for (PLCrashReport *report in [self corpus]) {
+        NSData *slim = [BugSplatCrashReportTextWriter dataForCrashReport:report
+                                                                 options:[BugSplatCrashReportTextOptions slimOptionsWithFrameLimit:limit]];
+        NSDictionary<NSNumber *, NSNumber *> *counts = [self frameCountsByThreadInText:slim];
+
+        for (PLCrashReportThreadInfo *thread in report.threads) {
+            NSUInteger written = counts[@(thread.threadNumber)].unsignedIntegerValue;
+            if (thread.crashed || thread.threadNumber == 0) {
+                XCTAssertEqual(written, thread.stackFrames.count, @"Thread %ld should be complete", (long)thread.threadNumber);
+            } else {
+                XCTAssertEqual(written, MIN(thread.stackFrames.count, limit), @"Thread %ld should be capped", (long)thread.threadNumber);
+            }
+        }
+    }
+}
+
+- (void)testSlimOptions_ListOnlyReferencedImagesAndMainExecutable
+{
+    const NSUInteger limit = 2;
+    for (PLCrashReport *report in [self corpus]) {
+        NSData *slim = [BugSplatCrashReportTextWriter dataForCrashReport:report
+                                                                 options:[BugSplatCrashReportTextOptions slimOptionsWithFrameLimit:limit]];
+
+        // Images expected: every image containing a written frame, plus the main executable.
+        NSMutableSet<NSString *> *expectedImages = [NSMutableSet set];
+        NSMutableArray<PLCrashReportStackFrameInfo *> *writtenFrames = [NSMutableArray arrayWithArray:report.exceptionInfo.stackFrames ?: @[]];
+        for (PLCrashReportThreadInfo *thread in report.threads) {
+            BOOL full = thread.crashed || thread.threadNumber == 0;
+            NSUInteger count = full ? thread.stackFrames.count : MIN(thread.stackFrames.count, limit);
+            [writtenFrames addObjectsFromArray:[thread.stackFrames subarrayWithRange:NSMakeRange(0, count)]];
+        }
+        for (PLCrashReportStackFrameInfo *frame in writtenFrames) {
+            PLCrashReportBinaryImageInfo *image = [report imageForAddress:frame.instructionPointer];
+            if (image) {
+                [expectedImages addObject:image.imageName];
+            }
+        }
+        for (PLCrashReportBinaryImageInfo *image in report.images) {
+            if ([image.imageName isEqual:report.processInfo.processPath]) {
+                [expectedImages addObject:image.imageName];
+            }
+        }
+
+        NSArray<NSString *> *imageLines = [self binaryImageLinesInText:slim];
+        XCTAssertEqual(imageLines.count, expectedImages.count);
+        XCTAssertLessThan(imageLines.count, report.images.count, @"Slimming should drop unreferenced images");
+        for (NSString *imageName in expectedImages) {
+            NSPredicate *listsImage = [NSPredicate predicateWithFormat:@"SELF ENDSWITH %@", [@" " stringByAppendingString:imageName]];
+            XCTAssertEqual([imageLines filteredArrayUsingPredicate:listsImage].count, 1u, @"%@ should be listed", imageName);
+        }
+    }
+}
+
+@end
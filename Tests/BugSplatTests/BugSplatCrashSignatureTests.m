@@ -0,0 +1,131 @@
+//
+//  BugSplatCrashSignatureTests.m
+//  BugSplatTests
+//
+//  Tests for crash signatures and for coalescing repeated crashes into one
+//  pending report. Live reports come from a real PLCrashReporter.
+//
+//  Copyright © BugSplat, LLC. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+#import <CrashReporter/CrashReporter.h>
+
+#import <BugSplat/BugSplat.h>
+#import "BugSplat+Testing.h"
+#import "BugSplatCrashSignature.h"
+#import "BugSplatMetadataCodec.h"
+#import "MockBundle.h"
+#import "MockCrashReporter.h"
+#import "MockCrashStorage.h"
+#import "MockUserDefaults.h"
+
+@interface BugSplatCrashSignatureTests : XCTestCase
+@property (nonatomic, copy, nullable) NSString *filenameToCleanup;
+@end
+
+@implementation BugSplatCrashSignatureTests
+
+- (void)tearDown
+{
+    if (self.filenameToCleanup) {
+        NSString *dir = [[BugSplat shared] crashesDirectoryPath];
+        for (NSString *ext in @[@"crash", @"plcrash", @"meta"]) {
+            NSString *path = [[dir stringByAppendingPathComponent:self.filenameToCleanup] stringByAppendingPathExtension:ext];
+            [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+        }
+    }
+    self.filenameToCleanup = nil;
+    [super tearDown];
+}
+
+#pragma mark - Helpers
+
+/// Live reports generated from the same call site share their top frames.
+- (NSArray<NSData *> *)liveReportsFromSameCallSite:(NSUInteger)count
+{
+    PLCrashReporter *reporter = [[PLCrashReporter alloc] initWithConfiguration:[PLCrashReporterConfig defaultConfiguration]];
+    NSException *exception = [NSException exceptionWithName:@"BugSplatSignatureTestException" reason:@"test" userInfo:nil];
+    NSMutableArray<NSData *> *reports = [NSMutableArray array];
+    for (NSUInteger i = 0; i < count; i++) {
+        NSData *report = [reporter generateLiveReportWithException:exception error:nil];
+        XCTAssertNotNil(report);
+        [reports addObject:report];
+    }
+    return reports;
+}
+
+#pragma mark - Signatures
+
+- (void)testSignature_IsDeterministic
+{
+    NSArray *frames = @[@"MyApp+0x1a2b", @"UIKitCore+0x40"];
+    NSString *first = [BugSplatCrashSignature signatureWithExceptionType:@"SIGSEGV SEGV_ACCERR" frames:frames frameCount:8];
+    NSString *second = [BugSplatCrashSignature signatureWithExceptionType:@"SIGSEGV SEGV_ACCERR" frames:frames frameCount:8];
+    XCTAssertEqualObjects(first, second);
+    XCTAssertEqual(first.length, 32);
+}
+
+- (void)testSignature_DependsOnExceptionTypeAndFrames
+{
+    NSArray *frames = @[@"MyApp+0x1a2b", @"UIKitCore+0x40"];
+    NSString *base = [BugSplatCrashSignature signatureWithExceptionType:@"SIGSEGV SEGV_ACCERR" frames:frames frameCount:8];
+
+    XCTAssertNotEqualObjects(base, [BugSplatCrashSignature signatureWithExceptionType:@"SIGABRT #0" frames:frames frameCount:8]);
+    XCTAssertNotEqualObjects(base, [BugSplatCrashSignature signatureWithExceptionType:@"SIGSEGV SEGV_ACCERR"
+                                                                               frames:@[@"MyApp+0x1a2c", @"UIKitCore+0x40"]
+                                                                           frameCount:8]);
+    XCTAssertNotEqualObjects(base, [BugSplatCrashSignature signatureWithExceptionType:@"SIGSEGV SEGV_ACCERR"
+                                                                               frames:@[@"UIKitCore+0x40", @"MyApp+0x1a2b"]
+                                                                           frameCount:8]);
+}
+
+- (void)testSignature_IgnoresFramesBeyondFrameCount
+{
+    NSString *shallow = [BugSplatCrashSignature signatureWithExceptionType:@"SIGBUS" frames:@[@"a+0x1", @"b+0x2", @"c+0x3"] frameCount:2];
+    NSString *deeper = [BugSplatCrashSignature signatureWithExceptionType:@"SIGBUS" frames:@[@"a+0x1", @"b+0x2", @"d+0x4"] frameCount:2];
+    XCTAssertEqualObjects(shallow, deeper);
+}
+
+- (void)testSignature_MatchesForReportsFromSameCallSite
+{
+    NSArray<NSData *> *reports = [self liveReportsFromSameCallSite:2];
+    PLCrashReport *first = [[PLCrashReport alloc] initWithData:reports[0] error:nil];
+    PLCrashReport *second = [[PLCrashReport alloc] initWithData:reports[1] error:nil];
+
+    NSString *signature = [BugSplatCrashSignature signatureForCrashReport:first frameCount:kBugSplatCrashSignatureFrameCount];
+    XCTAssertNotNil(signature);
+    XCTAssertEqualObjects(signature, [BugSplatCrashSignature signatureForCrashReport:second frameCount:kBugSplatCrashSignatureFrameCount]);
+}
+
+#pragma mark - Coalescing
+
+- (void)testCoalescing_MergesRepeatedCrashIntoPendingReport
+{
+    MockBundle *bundle = [[MockBundle alloc] init];
+    [bundle setObject:@"coalescedb" forInfoDictionaryKey:@"BugSplatDatabase"];
+    BugSplat *bugSplat = [BugSplat testInstanceWithCrashReporter:[[MockCrashReporter alloc] init]
+                                                    crashStorage:[[MockCrashStorage alloc] init]
+                                                    userDefaults:[[MockUserDefaults alloc] init]
+                                                          bundle:bundle];
+    bugSplat.coalesceRepeatedCrashes = YES;
+
+    NSArray<NSData *> *reports = [self liveReportsFromSameCallSite:3];
+    [bugSplat persistCrashReportData:reports[0]];
+    NSString *filename = [bugSplat currentCrashFilename];
+    XCTAssertNotNil(filename);
+    self.filenameToCleanup = filename;
+
+    [bugSplat persistCrashReportData:reports[1]];
+    [bugSplat persistCrashReportData:reports[2]];
+    XCTAssertEqualObjects([bugSplat currentCrashFilename], filename, @"Repeats should merge into the first report");
+
+    NSString *metaPath = [[[bugSplat crashesDirectoryPath] stringByAppendingPathComponent:filename] stringByAppendingPathExtension:@"meta"];
+    NSDictionary *metadata = [BugSplatMetadataCodec metadataWithContentsOfFile:metaPath];
+    NSDictionary *attributes = metadata[@"attributes"];
+    XCTAssertEqualObjects(attributes[@"bugsplat-occurrence-count"], @"3");
+    XCTAssertEqualObjects(attributes[@"bugsplat-first-occurrence"], metadata[@"timestamp"]);
+    XCTAssertNotNil(attributes[@"bugsplat-last-occurrence"]);
+}
+
+@end
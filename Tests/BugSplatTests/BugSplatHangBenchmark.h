@@ -0,0 +1,133 @@
+//
+//  BugSplatHangBenchmark.h
+//  BugSplatTests
+//
+//  Accuracy and overhead harness for BugSplatHangTracker. Runs a real tracker
+//  against a synthetic main loop that stalls on a schedule drawn from a
+//  configurable distribution, and scores what the tracker reported against
+//  what actually happened.
+//
+//  Copyright © BugSplat, LLC. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+typedef NS_ENUM(NSInteger, BugSplatHangBenchmarkEventKind) {
+    /// The loop is blocked for `duration`.
+    BugSplatHangBenchmarkEventKindStall = 0,
+    /// The loop is blocked for `duration`, and halfway through the tracker's clock jumps by
+    /// `suspendGap` as if the device had been asleep. Never a hang.
+    BugSplatHangBenchmarkEventKindSuspend = 1,
+};
+
+/// One scheduled loop stall.
+@interface BugSplatHangBenchmarkEvent : NSObject
+@property (nonatomic, assign) BugSplatHangBenchmarkEventKind kind;
+/// Seconds from the start of the run.
+@property (nonatomic, assign) NSTimeInterval start;
+@property (nonatomic, assign) NSTimeInterval duration;
+@property (nonatomic, assign) NSTimeInterval suspendGap;
+@end
+
+/**
+ * Distribution the schedule is drawn from. Each draw is one of: a hang (1.2-3x the
+ * threshold), a near-threshold stall (0.9-1.1x), a burst of 3-6 short stalls (0.2-0.7x) a
+ * few milliseconds apart, a suspend gap (0.5-3x) during a short stall, or otherwise a short
+ * stall (0.02-0.6x, log-uniform). Draws are separated by exponentially distributed idle time.
+ */
+@interface BugSplatHangBenchmarkConfiguration : NSObject
+/// Default: 0.5
+@property (nonatomic, assign) NSTimeInterval threshold;
+/// Same seed, same schedule. Default: 1
+@property (nonatomic, assign) uint64_t seed;
+/// Default: 40
+@property (nonatomic, assign) NSUInteger drawCount;
+/// Default: 0.25
+@property (nonatomic, assign) NSTimeInterval meanIdleGap;
+/// Default: 0.15
+@property (nonatomic, assign) double hangFraction;
+/// Default: 0.15
+@property (nonatomic, assign) double nearThresholdFraction;
+/// Default: 0.15
+@property (nonatomic, assign) double burstFraction;
+/// Default: 0.1
+@property (nonatomic, assign) double suspendFraction;
+/// Stalls within this fraction of the threshold either way count as borderline, not as
+/// hangs that must be detected or stalls that must not be. Default: 0.1
+@property (nonatomic, assign) double borderlineMargin;
+@end
+
+/// What happened to one scheduled event during a run.
+@interface BugSplatHangBenchmarkObservation : NSObject
+@property (nonatomic, assign) BugSplatHangBenchmarkEventKind kind;
+/// Measured time the loop was blocked.
+@property (nonatomic, assign) NSTimeInterval duration;
+/// Seconds from the start of the stall to the first hang report, or -1 if none.
+@property (nonatomic, assign) NSTimeInterval detectedAfter;
+@end
+
+@interface BugSplatHangBenchmarkResult : NSObject
+/// Stalls that must be detected, must not be, and borderline ones.
+@property (nonatomic, assign) NSUInteger positives;
+@property (nonatomic, assign) NSUInteger negatives;
+@property (nonatomic, assign) NSUInteger borderline;
+@property (nonatomic, assign) NSUInteger truePositives;
+@property (nonatomic, assign) NSUInteger falseNegatives;
+/// Detected negatives plus `spuriousDetections`.
+@property (nonatomic, assign) NSUInteger falsePositives;
+/// Reports received while the loop was not stalled at all.
+@property (nonatomic, assign) NSUInteger spuriousDetections;
+@property (nonatomic, assign) NSUInteger borderlineDetected;
+/// Detection time past the threshold for each true positive, in seconds, ascending.
+@property (nonatomic, copy) NSArray<NSNumber *> *detectionLatencies;
+@property (nonatomic, assign) NSTimeInterval wallSeconds;
+/// CPU time of the watchdog thread.
+@property (nonatomic, assign) NSTimeInterval watchdogCPUSeconds;
+@property (nonatomic, assign) uint64_t wakeups;
+
+@property (nonatomic, readonly) double falsePositiveRate;
+@property (nonatomic, readonly) double falseNegativeRate;
+@property (nonatomic, readonly) double wakeupsPerSecond;
+/// Watchdog CPU time as a percentage of one core.
+@property (nonatomic, readonly) double watchdogCPUPercent;
+
+/// Nearest-rank percentile (0-100) of `detectionLatencies`; 0 when there are none.
+- (NSTimeInterval)detectionLatencyAtPercentile:(double)percentile;
+
+/// One-line summary for the test log.
+- (NSString *)summary;
+@end
+
+@interface BugSplatHangBenchmark : NSObject
+
+/// Schedule for `configuration`, in start order.
++ (NSArray<BugSplatHangBenchmarkEvent *> *)eventsForConfiguration:(BugSplatHangBenchmarkConfiguration *)configuration;
+
+/**
+ * Score observations: a stall at least `threshold * (1 + margin)` long must be detected,
+ * one shorter than `threshold * (1 - margin)` or a suspend event must not be.
+ * `spuriousDetections` are reports received while no event was running.
+ */
++ (BugSplatHangBenchmarkResult *)resultForObservations:(NSArray<BugSplatHangBenchmarkObservation *> *)observations
+                                    spuriousDetections:(NSUInteger)spuriousDetections
+                                             threshold:(NSTimeInterval)threshold
+                                      borderlineMargin:(double)margin;
+
+- (instancetype)initWithConfiguration:(BugSplatHangBenchmarkConfiguration *)configuration;
+
+/// Tracker mode under test. Defaults: NO, YES
+@property (nonatomic, assign) BOOL usesHeartbeat;
+@property (nonatomic, assign) BOOL adaptivePolling;
+
+/**
+ * Play the schedule against a started tracker in real time and score it. Blocks for the
+ * length of the schedule; must be called on the main thread (which the tracker's `-start`
+ * requires), and the main run loop is not run meanwhile.
+ */
+- (BugSplatHangBenchmarkResult *)run;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,380 @@
+//
+//  BugSplatHangBenchmark.m
+//  BugSplatTests
+//
+//  Copyright © BugSplat, LLC. All rights reserved.
+//
+
+#import "BugSplatHangBenchmark.h"
+#import "BugSplatHangTracker.h"
+
+#import <mach/mach.h>
+#import <math.h>
+#import <pthread.h>
+#import <stdatomic.h>
+#import <time.h>
+
+/// Private testing surface implemented in BugSplatHangTracker.m.
+@interface BugSplatHangTracker (Benchmark)
+- (instancetype)initWithThresholdSeconds:(NSTimeInterval)thresholdSeconds
+                                 delegate:(id<BugSplatHangTrackerDelegate>)delegate
+                   isDebuggerAttachedBlock:(BOOL(^)(void))isDebuggerAttachedBlock
+                         isAppActiveBlock:(BOOL(^)(void))isAppActiveBlock
+                                clockBlock:(CFAbsoluteTime(^)(void))clockBlock
+                       recoveryDispatcher:(void(^)(dispatch_block_t))recoveryDispatcher
+                            pingDispatcher:(void(^)(dispatch_block_t))pingDispatcher;
+@end
+
+/// Time after the last event for late reports to arrive, in thresholds.
+static const double kBugSplatBenchmarkSettleThresholds = 2.0;
+
+static uint64_t BugSplatBenchmarkNow(void)
+{
+    return clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+}
+
+static void BugSplatBenchmarkWaitUntil(uint64_t deadline)
+{
+    uint64_t now;
+    while ((now = BugSplatBenchmarkNow()) < deadline) {
+        uint64_t remaining = deadline - now;
+        struct timespec interval = { (time_t)(remaining / NSEC_PER_SEC), (long)(remaining % NSEC_PER_SEC) };
+        nanosleep(&interval, NULL);
+    }
+}
+
+#pragma mark - Schedule
+
+@implementation BugSplatHangBenchmarkEvent
+@end
+
+@implementation BugSplatHangBenchmarkConfiguration
+
+- (instancetype)init
+{
+    if (self = [super init]) {
+        _threshold = 0.5;
+        _seed = 1;
+        _drawCount = 40;
+        _meanIdleGap = 0.25;
+        _hangFraction = 0.15;
+        _nearThresholdFraction = 0.15;
+        _burstFraction = 0.15;
+        _suspendFraction = 0.1;
+        _borderlineMargin = 0.1;
+    }
+    return self;
+}
+
+@end
+
+/// xorshift64*: small, and the same sequence on every platform.
+typedef struct {
+    uint64_t state;
+} BugSplatBenchmarkRandom;
+
+static double BugSplatBenchmarkRandomUniform(BugSplatBenchmarkRandom *random)
+{
+    random->state ^= random->state >> 12;
+    random->state ^= random->state << 25;
+    random->state ^= random->state >> 27;
+    uint64_t value = random->state * 0x2545F4914F6CDD1DULL;
+    return (double)(value >> 11) / (double)(1ULL << 53);
+}
+
+static double BugSplatBenchmarkRandomBetween(BugSplatBenchmarkRandom *random, double low, double high)
+{
+    return low + (high - low) * BugSplatBenchmarkRandomUniform(random);
+}
+
+#pragma mark - Results
+
+@implementation BugSplatHangBenchmarkObservation
+@end
+
+@implementation BugSplatHangBenchmarkResult
+
+- (double)falsePositiveRate
+{
+    NSUInteger opportunities = self.negatives + self.spuriousDetections;
+    return opportunities ? (double)self.falsePositives / opportunities : 0;
+}
+
+- (double)falseNegativeRate
+{
+    return self.positives ? (double)self.falseNegatives / self.positives : 0;
+}
+
+- (double)wakeupsPerSecond
+{
+    return self.wallSeconds > 0 ? self.wakeups / self.wallSeconds : 0;
+}
+
+- (double)watchdogCPUPercent
+{
+    return self.wallSeconds > 0 ? 100.0 * self.watchdogCPUSeconds / self.wallSeconds : 0;
+}
+
+- (NSTimeInterval)detectionLatencyAtPercentile:(double)percentile
+{
+    NSUInteger count = self.detectionLatencies.count;
+    if (count == 0) {
+        return 0;
+    }
+    NSUInteger rank = (NSUInteger)ceil(MAX(0.0, MIN(percentile, 100.0)) / 100.0 * count);
+    return self.detectionLatencies[rank > 0 ? rank - 1 : 0].doubleValue;
+}
+
+- (NSString *)summary
+{
+    return [NSString stringWithFormat:@"detected %lu/%lu hangs (FN %.1f%%), FP %lu/%lu (%.1f%%), borderline %lu/%lu; "
+            "latency p50 %.0fms p90 %.0fms p99 %.0fms max %.0fms; watchdog CPU %.3f%%, %.1f wakeups/s",
+            (unsigned long)self.truePositives, (unsigned long)self.positives, self.falseNegativeRate * 100.0,
+            (unsigned long)self.falsePositives, (unsigned long)self.negatives, self.falsePositiveRate * 100.0,
+            (unsigned long)self.borderlineDetected, (unsigned long)self.borderline,
+            [self detectionLatencyAtPercentile:50] * 1000.0, [self detectionLatencyAtPercentile:90] * 1000.0,
+            [self detectionLatencyAtPercentile:99] * 1000.0, [self detectionLatencyAtPercentile:100] * 1000.0,
+            self.watchdogCPUPercent, self.wakeupsPerSecond];
+}
+
+@end
+
+#pragma mark - Benchmark
+
+@interface BugSplatHangBenchmark () <BugSplatHangTrackerDelegate>
+@property (nonatomic, strong) BugSplatHangBenchmarkConfiguration *configuration;
+/// Guarded by @synchronized(self).
+@property (nonatomic, strong, nullable) BugSplatHangBenchmarkObservation *activeObservation;
+@property (nonatomic, assign) uint64_t activeStart;
+@property (nonatomic, assign) NSUInteger spuriousDetections;
+@end
+
+@implementation BugSplatHangBenchmark
+{
+    // Added to the tracker's clock by suspend events, in nanoseconds.
+    _Atomic(uint64_t) _clockOffset;
+    // Watchdog thread, captured the first time it reads the clock.
+    _Atomic(mach_port_t) _watchdogThread;
+}
+
++ (NSArray<BugSplatHangBenchmarkEvent *> *)eventsForConfiguration:(BugSplatHangBenchmarkConfiguration *)configuration
+{
+    BugSplatBenchmarkRandom random = { configuration.seed ? configuration.seed : 1 };
+    NSTimeInterval threshold = configuration.threshold;
+    NSMutableArray<BugSplatHangBenchmarkEvent *> *events = [NSMutableArray array];
+    __block NSTimeInterval time = 0;
+    void (^add)(BugSplatHangBenchmarkEventKind, NSTimeInterval, NSTimeInterval) =
+        ^(BugSplatHangBenchmarkEventKind kind, NSTimeInterval duration, NSTimeInterval suspendGap) {
+            BugSplatHangBenchmarkEvent *event = [[BugSplatHangBenchmarkEvent alloc] init];
+            event.kind = kind;
+            event.start = time;
+            event.duration = duration;
+            event.suspendGap = suspendGap;
+            [events addObject:event];
+            time += duration;
+        };
+
+    for (NSUInteger draw = 0; draw < configuration.drawCount; draw++) {
+        time += -configuration.meanIdleGap * log(1.0 - BugSplatBenchmarkRandomUniform(&random));
+        double pick = BugSplatBenchmarkRandomUniform(&random);
+        if ((pick -= configuration.hangFraction) < 0) {
+            add(BugSplatHangBenchmarkEventKindStall, threshold * BugSplatBenchmarkRandomBetween(&random, 1.2, 3.0), 0);
+        } else if ((pick -= configuration.nearThresholdFraction) < 0) {
+            add(BugSplatHangBenchmarkEventKindStall, threshold * BugSplatBenchmarkRandomBetween(&random, 0.9, 1.1), 0);
+        } else if ((pick -= configuration.burstFraction) < 0) {
+            NSUInteger count = 3 + (NSUInteger)(BugSplatBenchmarkRandomUniform(&random) * 4);
+            for (NSUInteger i = 0; i < count; i++) {
+                if (i > 0) {
+                    time += BugSplatBenchmarkRandomBetween(&random, 0.005, 0.02);
+                }
+                add(BugSplatHangBenchmarkEventKindStall, threshold * BugSplatBenchmarkRandomBetween(&random, 0.2, 0.7), 0);
+            }
+        } else if ((pick -= configuration.suspendFraction) < 0) {
+            add(BugSplatHangBenchmarkEventKindSuspend, threshold * 0.4, threshold * BugSplatBenchmarkRandomBetween(&random, 0.5, 3.0));
+        } else {
+            add(BugSplatHangBenchmarkEventKindStall, threshold * exp(BugSplatBenchmarkRandomBetween(&random, log(0.02), log(0.6))), 0);
+        }
+    }
+    return events;
+}
+
++ (BugSplatHangBenchmarkResult *)resultForObservations:(NSArray<BugSplatHangBenchmarkObservation *> *)observations
+                                    spuriousDetections:(NSUInteger)spuriousDetections
+                                             threshold:(NSTimeInterval)threshold
+                                      borderlineMargin:(double)margin
+{
+    BugSplatHangBenchmarkResult *result = [[BugSplatHangBenchmarkResult alloc] init];
+    result.spuriousDetections = spuriousDetections;
+    result.falsePositives = spuriousDetections;
+    NSMutableArray<NSNumber *> *latencies = [NSMutableArray array];
+    for (BugSplatHangBenchmarkObservation *observation in observations) {
+        BOOL detected = observation.detectedAfter >= 0;
+        if (observation.kind == BugSplatHangBenchmarkEventKindSuspend || observation.duration < threshold * (1.0 - margin)) {
+            result.negatives++;
+            result.falsePositives += detected ? 1 : 0;
+        } else if (observation.duration < threshold * (1.0 + margin)) {
+            result.borderline++;
+            result.borderlineDetected += detected ? 1 : 0;
+        } else {
+            result.positives++;
+            if (detected) {
+                result.truePositives++;
+                [latencies addObject:@(observation.detectedAfter - threshold)];
+            } else {
+                result.falseNegatives++;
+            }
+        }
+    }
+    result.detectionLatencies = [latencies sortedArrayUsingSelector:@selector(compare:)];
+    return result;
+}
+
+- (instancetype)initWithConfiguration:(BugSplatHangBenchmarkConfiguration *)configuration
+{
+    if (self = [super init]) {
+        _configuration = configuration;
+        _adaptivePolling = YES;
+        atomic_init(&_clockOffset, 0);
+        atomic_init(&_watchdogThread, MACH_PORT_NULL);
+    }
+    return self;
+}
+
+- (BugSplatHangBenchmarkResult *)run
+{
+    NSArray<BugSplatHangBenchmarkEvent *> *events = [[self class] eventsForConfiguration:self.configuration];
+    NSMutableArray<BugSplatHangBenchmarkObservation *> *observations = [NSMutableArray arrayWithCapacity:events.count];
+    self.spuriousDetections = 0;
+    atomic_store(&_clockOffset, 0);
+    atomic_store(&_watchdogThread, MACH_PORT_NULL);
+
+    // Stands in for the main queue: pings and stalls run here.
+    dispatch_queue_t loop = dispatch_queue_create("com.bugsplat.benchmark.loop",
+        dispatch_queue_attr_make_with_qos_class(DISPATCH_QUEUE_SERIAL, QOS_CLASS_USER_INTERACTIVE, 0));
+
+    __weak __typeof(self) weakSelf = self;
+    BugSplatHangTracker *tracker = [[BugSplatHangTracker alloc] initWithThresholdSeconds:self.configuration.threshold
+                                                                                delegate:self
+                                                                  isDebuggerAttachedBlock:nil
+                                                                        isAppActiveBlock:nil
+                                                                               clockBlock:^CFAbsoluteTime{
+        __strong __typeof(weakSelf) strongSelf = weakSelf;
+        if (strongSelf && ![NSThread isMainThread]) {
+            mach_port_t expected = MACH_PORT_NULL;
+            atomic_compare_exchange_strong(&strongSelf->_watchdogThread, &expected, pthread_mach_thread_np(pthread_self()));
+        }
+        uint64_t offset = strongSelf ? atomic_load(&strongSelf->_clockOffset) : 0;
+        return (CFAbsoluteTime)(clock_gettime_nsec_np(CLOCK_MONOTONIC_RAW) + offset) / NSEC_PER_SEC;
+    }
+                                                                       recoveryDispatcher:nil
+                                                                           pingDispatcher:^(dispatch_block_t ping) {
+        dispatch_async(loop, ping);
+    }];
+    tracker.usesHeartbeat = self.usesHeartbeat;
+    tracker.adaptivePolling = self.adaptivePolling;
+    [tracker start];
+    if (self.usesHeartbeat) {
+        // -start marks the main loop busy; the synthetic loop starts out waiting.
+        [tracker markIdle];
+    }
+
+    uint64_t origin = BugSplatBenchmarkNow();
+    for (BugSplatHangBenchmarkEvent *event in events) {
+        BugSplatBenchmarkWaitUntil(origin + (uint64_t)(event.start * NSEC_PER_SEC));
+        BugSplatHangBenchmarkObservation *observation = [[BugSplatHangBenchmarkObservation alloc] init];
+        observation.kind = event.kind;
+        observation.detectedAfter = -1;
+        [observations addObject:observation];
+        dispatch_async(loop, ^{
+            [self playEvent:event observation:observation tracker:tracker];
+        });
+    }
+    dispatch_sync(loop, ^{});
+    BugSplatBenchmarkWaitUntil(BugSplatBenchmarkNow() + (uint64_t)(kBugSplatBenchmarkSettleThresholds * self.configuration.threshold * NSEC_PER_SEC));
+    uint64_t end = BugSplatBenchmarkNow();
+
+    NSTimeInterval cpu = [self watchdogCPUSeconds];
+    uint64_t wakeups = tracker.pollCount;
+    [tracker stop];
+
+    BugSplatHangBenchmarkResult *result;
+    @synchronized (self) {
+        result = [[self class] resultForObservations:observations
+                                  spuriousDetections:self.spuriousDetections
+                                           threshold:self.configuration.threshold
+                                    borderlineMargin:self.configuration.borderlineMargin];
+    }
+    result.wallSeconds = (NSTimeInterval)(end - origin) / NSEC_PER_SEC;
+    result.watchdogCPUSeconds = cpu;
+    result.wakeups = wakeups;
+    return result;
+}
+
+/// Runs on the loop queue: block it as the event says, as a main-thread stall would.
+- (void)playEvent:(BugSplatHangBenchmarkEvent *)event
+      observation:(BugSplatHangBenchmarkObservation *)observation
+          tracker:(BugSplatHangTracker *)tracker
+{
+    uint64_t start = BugSplatBenchmarkNow();
+    @synchronized (self) {
+        self.activeObservation = observation;
+        self.activeStart = start;
+    }
+    if (self.usesHeartbeat) {
+        [tracker tick];
+    }
+
+    uint64_t duration = (uint64_t)(event.duration * NSEC_PER_SEC);
+    if (event.kind == BugSplatHangBenchmarkEventKindSuspend) {
+        BugSplatBenchmarkWaitUntil(start + duration / 2);
+        // The monotonic clock keeps counting while a device sleeps; uptime does not.
+        atomic_fetch_add(&_clockOffset, (uint64_t)(event.suspendGap * NSEC_PER_SEC));
+    }
+    BugSplatBenchmarkWaitUntil(start + duration);
+
+    if (self.usesHeartbeat) {
+        [tracker markIdle];
+    }
+    @synchronized (self) {
+        observation.duration = (NSTimeInterval)(BugSplatBenchmarkNow() - start) / NSEC_PER_SEC;
+        self.activeObservation = nil;
+    }
+}
+
+- (NSTimeInterval)watchdogCPUSeconds
+{
+    mach_port_t thread = atomic_load(&_watchdogThread);
+    if (thread == MACH_PORT_NULL) {
+        return 0;
+    }
+    thread_basic_info_data_t info;
+    mach_msg_type_number_t count = THREAD_BASIC_INFO_COUNT;
+    if (thread_info(thread, THREAD_BASIC_INFO, (thread_info_t)&info, &count) != KERN_SUCCESS) {
+        return 0;
+    }
+    return info.user_time.seconds + info.user_time.microseconds / 1e6
+         + info.system_time.seconds + info.system_time.microseconds / 1e6;
+}
+
+#pragma mark - BugSplatHangTrackerDelegate
+
+- (void)hangTracker:(BugSplatHangTracker *)tracker
+didDetectHangWithDuration:(NSTimeInterval)duration
+           appState:(NSString *)appState
+{
+    uint64_t now = BugSplatBenchmarkNow();
+    @synchronized (self) {
+        BugSplatHangBenchmarkObservation *observation = self.activeObservation;
+        if (!observation) {
+            self.spuriousDetections++;
+        } else if (observation.detectedAfter < 0) {
+            observation.detectedAfter = (NSTimeInterval)(now - self.activeStart) / NSEC_PER_SEC;
+        }
+    }
+}
+
+- (void)hangTrackerDidRecoverFromHang:(BugSplatHangTracker *)tracker
+{
+}
+
+@end
@@ -0,0 +1,163 @@
+//
+//  BugSplatHangBenchmarkTests.m
+//  BugSplatTests
+//
+//  Checks the hang benchmark harness itself: the schedule it draws and the way it
+//  scores a run. The full benchmark runs live in BugSplatPerformanceTests.
+//
+//  Copyright © BugSplat, LLC. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+#import "BugSplatHangBenchmark.h"
+
+@interface BugSplatHangBenchmarkTests : XCTestCase
+@end
+
+@implementation BugSplatHangBenchmarkTests
+
+- (BugSplatHangBenchmarkObservation *)observationWithDuration:(NSTimeInterval)duration
+                                                 detectedAfter:(NSTimeInterval)detectedAfter
+{
+    BugSplatHangBenchmarkObservation *observation = [[BugSplatHangBenchmarkObservation alloc] init];
+    observation.kind = BugSplatHangBenchmarkEventKindStall;
+    observation.duration = duration;
+    observation.detectedAfter = detectedAfter;
+    return observation;
+}
+
+#pragma mark - Schedule
+
+- (void)testSchedule_SameSeedSameEvents
+{
+    BugSplatHangBenchmarkConfiguration *configuration = [[BugSplatHangBenchmarkConfiguration alloc] init];
+    configuration.seed = 42;
+    NSArray<BugSplatHangBenchmarkEvent *> *first = [BugSplatHangBenchmark eventsForConfiguration:configuration];
+    NSArray<BugSplatHangBenchmarkEvent *> *second = [BugSplatHangBenchmark eventsForConfiguration:configuration];
+
+    XCTAssertEqual(first.count, second.count);
+    for (NSUInteger i = 0; i < first.count; i++) {
+        XCTAssertEqual(first[i].kind, second[i].kind);
+        XCTAssertEqual(first[i].start, second[i].start);
+        XCTAssertEqual(first[i].duration, second[i].duration);
+        XCTAssertEqual(first[i].suspendGap, second[i].suspendGap);
+    }
+
+    configuration.seed = 43;
+    NSArray<BugSplatHangBenchmarkEvent *> *other = [BugSplatHangBenchmark eventsForConfiguration:configuration];
+    XCTAssertNotEqual(first.firstObject.start, other.firstObject.start);
+}
+
+- (void)testSchedule_DrawsEveryKindInOrderWithoutOverlap
+{
+    BugSplatHangBenchmarkConfiguration *configuration = [[BugSplatHangBenchmarkConfiguration alloc] init];
+    configuration.drawCount = 400;
+    NSTimeInterval threshold = configuration.threshold;
+    NSArray<BugSplatHangBenchmarkEvent *> *events = [BugSplatHangBenchmark eventsForConfiguration:configuration];
+
+    NSUInteger hangs = 0, nearThreshold = 0, suspends = 0, bursts = 0;
+    NSTimeInterval previousEnd = 0;
+    for (BugSplatHangBenchmarkEvent *event in events) {
+        XCTAssertGreaterThanOrEqual(event.start, previousEnd);
+        if (event.start - previousEnd < 0.025 && previousEnd > 0) {
+            bursts++;
+        }
+        previousEnd = event.start + event.duration;
+
+        if (event.kind == BugSplatHangBenchmarkEventKindSuspend) {
+            suspends++;
+            XCTAssertLessThan(event.duration, threshold);
+            XCTAssertGreaterThanOrEqual(event.suspendGap, threshold * 0.5);
+        } else if (event.duration >= threshold * 1.2) {
+            hangs++;
+            XCTAssertLessThanOrEqual(event.duration, threshold * 3.0);
+        } else if (event.duration >= threshold * 0.9) {
+            nearThreshold++;
+        }
+    }
+    XCTAssertGreaterThan(events.count, configuration.drawCount);
+    XCTAssertGreaterThan(hangs, 0u);
+    XCTAssertGreaterThan(nearThreshold, 0u);
+    XCTAssertGreaterThan(suspends, 0u);
+    XCTAssertGreaterThan(bursts, 0u);
+}
+
+#pragma mark - Scoring
+
+- (void)testScoring_ClassifiesByDurationAndDetection
+{
+    BugSplatHangBenchmarkObservation *suspend = [self observationWithDuration:0.2 detectedAfter:0.6];
+    suspend.kind = BugSplatHangBenchmarkEventKindSuspend;
+    NSArray *observations = @[
+        [self observationWithDuration:1.0 detectedAfter:0.6],   // detected hang
+        [self observationWithDuration:1.5 detectedAfter:0.7],   // detected hang
+        [self observationWithDuration:0.8 detectedAfter:-1],    // missed hang
+        [self observationWithDuration:0.2 detectedAfter:-1],    // short stall, quiet
+        [self observationWithDuration:0.4 detectedAfter:0.42],  // short stall, reported
+        [self observationWithDuration:0.5 detectedAfter:-1],    // borderline
+        suspend,                                                // suspend gap, reported
+    ];
+
+    BugSplatHangBenchmarkResult *result = [BugSplatHangBenchmark resultForObservations:observations
+                                                                    spuriousDetections:1
+                                                                             threshold:0.5
+                                                                      borderlineMargin:0.1];
+    XCTAssertEqual(result.positives, 3u);
+    XCTAssertEqual(result.truePositives, 2u);
+    XCTAssertEqual(result.falseNegatives, 1u);
+    XCTAssertEqual(result.negatives, 3u);
+    XCTAssertEqual(result.falsePositives, 3u);
+    XCTAssertEqual(result.borderline, 1u);
+    XCTAssertEqual(result.borderlineDetected, 0u);
+    XCTAssertEqualWithAccuracy(result.falseNegativeRate, 1.0 / 3.0, 1e-9);
+    XCTAssertEqualWithAccuracy(result.falsePositiveRate, 3.0 / 4.0, 1e-9);
+}
+
+- (void)testScoring_LatencyPercentiles
+{
+    NSMutableArray *observations = [NSMutableArray array];
+    for (NSUInteger i = 100; i >= 1; i--) {
+        [observations addObject:[self observationWithDuration:2.0 detectedAfter:0.5 + i / 1000.0]];
+    }
+    BugSplatHangBenchmarkResult *result = [BugSplatHangBenchmark resultForObservations:observations
+                                                                    spuriousDetections:0
+                                                                             threshold:0.5
+                                                                      borderlineMargin:0.1];
+    XCTAssertEqual(result.detectionLatencies.count, 100u);
+    XCTAssertEqualWithAccuracy([result detectionLatencyAtPercentile:50], 0.050, 1e-9);
+    XCTAssertEqualWithAccuracy([result detectionLatencyAtPercentile:90], 0.090, 1e-9);
+    XCTAssertEqualWithAccuracy([result detectionLatencyAtPercentile:99], 0.099, 1e-9);
+    XCTAssertEqualWithAccuracy([result detectionLatencyAtPercentile:100], 0.100, 1e-9);
+    XCTAssertEqualWithAccuracy([result detectionLatencyAtPercentile:0], 0.001, 1e-9);
+
+    BugSplatHangBenchmarkResult *empty = [BugSplatHangBenchmark resultForObservations:@[]
+                                                                   spuriousDetections:0
+                                                                            threshold:0.5
+                                                                     borderlineMargin:0.1];
+    XCTAssertEqual([empty detectionLatencyAtPercentile:50], 0);
+    XCTAssertEqual(empty.falsePositiveRate, 0);
+}
+
+#pragma mark - Live run
+
+- (void)testRun_HeartbeatDetectsClearHangs
+{
+    BugSplatHangBenchmarkConfiguration *configuration = [[BugSplatHangBenchmarkConfiguration alloc] init];
+    configuration.threshold = 0.2;
+    configuration.drawCount = 6;
+    configuration.meanIdleGap = 0.1;
+    configuration.hangFraction = 1.0;
+    BugSplatHangBenchmark *benchmark = [[BugSplatHangBenchmark alloc] initWithConfiguration:configuration];
+    benchmark.usesHeartbeat = YES;
+
+    BugSplatHangBenchmarkResult *result = [benchmark run];
+
+    XCTAssertEqual(result.positives, 6u);
+    XCTAssertEqual(result.truePositives, 6u);
+    XCTAssertEqual(result.falsePositives, 0u);
+    XCTAssertGreaterThan(result.wakeups, 0u);
+    XCTAssertGreaterThan(result.wallSeconds, 0);
+    XCTAssertGreaterThanOrEqual([result detectionLatencyAtPercentile:0], 0);
+}
+
+@end
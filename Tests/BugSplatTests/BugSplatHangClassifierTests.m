@@ -0,0 +1,259 @@
+//
+//  BugSplatHangClassifierTests.m
+//  BugSplatTests
+//
+//  Tests for the hang cause classifier: the rule table against backtraces
+//  taken from text reports, the report-line parser, and BugSplat tagging
+//  live threads blocked in known calls.
+//
+//  Copyright © BugSplat, LLC. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+#import <pthread.h>
+
+#import <BugSplat/BugSplat.h>
+#import "BugSplat+Testing.h"
+#import "BugSplatHangClassifier.h"
+#import "BugSplatImageList.h"
+
+static NSString *const kHangAttrCategory = @"bugsplat-hang-category";
+
+#pragma mark - Fixtures
+
+// Crashed-thread backtraces in the text report format; the app executable is "My App".
+
+static NSString *const kFixtureSqlite =
+    @"0   libsystem_kernel.dylib        0x00000001d7c1a4a8 __psynch_mutexwait + 8\n"
+    @"1   libsystem_pthread.dylib       0x00000001f1c4b6a4 _pthread_mutex_firstfit_lock_wait + 84\n"
+    @"2   libsystem_pthread.dylib       0x00000001f1c4b5b8 _pthread_mutex_firstfit_lock_slow + 248\n"
+    @"3   libsqlite3.dylib              0x00000001b9a6e0fc sqlite3_step + 1234\n"
+    @"4   My App                        0x0000000100a3c4d8 0x100a00000 + 247000\n"
+    @"5   UIKitCore                     0x00000001a2b3c4d5 -[UIApplication _run] + 888\n";
+
+static NSString *const kFixtureMutex =
+    @"0   libsystem_kernel.dylib        0x00000001d7c1a4a8 __psynch_mutexwait + 8\n"
+    @"1   libsystem_pthread.dylib       0x00000001f1c4b6a4 _pthread_mutex_firstfit_lock_wait + 84\n"
+    @"2   libsystem_pthread.dylib       0x00000001f1c4b5b8 _pthread_mutex_firstfit_lock_slow + 248\n"
+    @"3   My App                        0x0000000100a3c4d8 -[Cache objectForKey:] + 40\n"
+    @"4   My App                        0x0000000100a3b000 -[FeedController reload] + 120\n";
+
+static NSString *const kFixtureDispatchSync =
+    @"0   libsystem_kernel.dylib        0x00000001d7c1b0e0 __ulock_wait + 8\n"
+    @"1   libdispatch.dylib             0x00000001b0c5e6b0 _dlock_wait + 56\n"
+    @"2   libdispatch.dylib             0x00000001b0c5e3d4 _dispatch_thread_event_wait_slow + 56\n"
+    @"3   libdispatch.dylib             0x00000001b0c6c9a4 __DISPATCH_WAIT_FOR_QUEUE__ + 368\n"
+    @"4   libdispatch.dylib             0x00000001b0c6c4a0 _dispatch_sync_f_slow + 148\n"
+    @"5   My App                        0x0000000100a3c4d8 -[Store save] + 64\n";
+
+static NSString *const kFixtureSemaphore =
+    @"0   libsystem_kernel.dylib        0x00000001d7c19a48 semaphore_wait_trap + 8\n"
+    @"1   libdispatch.dylib             0x00000001b0c5f3e8 _dispatch_sema4_wait + 28\n"
+    @"2   libdispatch.dylib             0x00000001b0c5fa84 _dispatch_semaphore_wait_slow + 132\n"
+    @"3   My App                        0x0000000100a3c4d8 -[Client fetchSynchronously] + 200\n";
+
+static NSString *const kFixtureFileRead =
+    @"0   libsystem_kernel.dylib        0x00000001d7c1c7e8 read + 8\n"
+    @"1   Foundation                    0x00000001a0f7a3a0 _NSReadBytesFromFileWithExtendedAttributes + 444\n"
+    @"2   Foundation                    0x00000001a0f79f40 -[NSData(NSData) initWithContentsOfFile:] + 64\n"
+    @"3   My App                        0x0000000100a3c4d8 0x100a00000 + 247000\n";
+
+static NSString *const kFixtureSocket =
+    @"0   libsystem_kernel.dylib        0x00000001d7c1d2c4 __recvfrom + 8\n"
+    @"1   libsystem_c.dylib             0x00000001b1d3e5a0 recv + 32\n"
+    @"2   My App                        0x0000000100a3c4d8 -[LegacySocket readLine] + 88\n";
+
+static NSString *const kFixtureXPC =
+    @"0   libsystem_kernel.dylib        0x00000001d7c19b08 mach_msg2_trap + 8\n"
+    @"1   libsystem_kernel.dylib        0x00000001d7c1c3d0 mach_msg2_internal + 80\n"
+    @"2   libsystem_kernel.dylib        0x00000001d7c1c2a4 mach_msg_overwrite + 436\n"
+    @"3   libxpc.dylib                  0x00000001f1d5a2c0 _xpc_pipe_mach_msg + 56\n"
+    @"4   libxpc.dylib                  0x00000001f1d4e8f4 xpc_connection_send_message_with_reply_sync + 240\n"
+    @"5   My App                        0x0000000100a3c4d8 -[Helper queryDaemon] + 112\n";
+
+static NSString *const kFixtureIdleRunLoop =
+    @"0   libsystem_kernel.dylib        0x00000001d7c19b08 mach_msg2_trap + 8\n"
+    @"1   libsystem_kernel.dylib        0x00000001d7c1c2a4 mach_msg_overwrite + 436\n"
+    @"2   libsystem_kernel.dylib        0x00000001d7c1c0f4 mach_msg + 24\n"
+    @"3   CoreFoundation                0x00000001a1a2b3c4 __CFRunLoopServiceMachPort + 160\n"
+    @"4   CoreFoundation                0x00000001a1a2a1c0 __CFRunLoopRun + 1208\n"
+    @"5   CoreFoundation                0x00000001a1a298a8 CFRunLoopRunSpecific + 608\n"
+    @"6   My App                        0x0000000100a3c4d8 main + 64\n";
+
+static NSString *const kFixtureBusy =
+    @"0   My App                        0x0000000100a3c4d8 -[ImageFilter applyToPixels:] + 2040\n"
+    @"1   My App                        0x0000000100a3b000 -[Editor render] + 120\n"
+    @"2   UIKitCore                     0x00000001a2b3c4d5 -[UIApplication _run] + 888\n";
+
+static NSString *const kFixtureUnknown =
+    @"0   libsystem_kernel.dylib        0x00000001d7c1b0e0 __workq_kernreturn + 8\n"
+    @"1   SomeFramework                 0x00000001c0000000 0x1c0000000 + 0\n";
+
+
+@interface BugSplatHangClassifierTests : XCTestCase
+@end
+
+@implementation BugSplatHangClassifierTests
+
+#pragma mark - Helpers
+
+/// Category and innermost app frame index of a fixture backtrace, as "category@index".
+- (NSString *)classifyFixture:(NSString *)fixture
+{
+    NSArray<NSString *> *lines = [fixture componentsSeparatedByString:@"\n"];
+    NSMutableData *frames = [NSMutableData dataWithLength:lines.count * sizeof(BugSplatHangFrame)];
+    NSMutableData *storage = [NSMutableData dataWithLength:lines.count * 256];
+    size_t count = 0;
+    for (NSString *line in lines) {
+        BugSplatHangFrame *frame = (BugSplatHangFrame *)frames.mutableBytes + count;
+        if (BugSplatHangFrameParseLine(line.UTF8String, "My App", frame, (char *)storage.mutableBytes + count * 256, 256)) {
+            count++;
+        }
+    }
+    BugSplatHangClassification result = BugSplatHangClassify(frames.bytes, count, BugSplatHangDefaultRules,
+                                                              BugSplatHangDefaultRuleCount);
+    if (result.appFrame == BugSplatHangNoFrame) {
+        return @(result.category);
+    }
+    return [NSString stringWithFormat:@"%s@%zu", result.category, result.appFrame];
+}
+
+#pragma mark - Rules
+
+- (void)testFixtures_MapToCategories
+{
+    XCTAssertEqualObjects([self classifyFixture:kFixtureSqlite], @"sqlite@4", @"sqlite wins over the mutex it waits on");
+    XCTAssertEqualObjects([self classifyFixture:kFixtureMutex], @"mutex@3");
+    XCTAssertEqualObjects([self classifyFixture:kFixtureDispatchSync], @"dispatch-sync@5");
+    XCTAssertEqualObjects([self classifyFixture:kFixtureSemaphore], @"semaphore@3");
+    XCTAssertEqualObjects([self classifyFixture:kFixtureFileRead], @"file-io@3");
+    XCTAssertEqualObjects([self classifyFixture:kFixtureSocket], @"socket-io@2");
+    XCTAssertEqualObjects([self classifyFixture:kFixtureXPC], @"xpc-sync@5", @"XPC wins over the mach_msg it waits in");
+    XCTAssertEqualObjects([self classifyFixture:kFixtureIdleRunLoop], @"idle@6");
+    XCTAssertEqualObjects([self classifyFixture:kFixtureBusy], @"busy@0");
+    XCTAssertEqualObjects([self classifyFixture:kFixtureUnknown], @"unknown");
+}
+
+- (void)testFramesBelowAppCode_AreNotMatched
+{
+    // The app's caller waiting in a semaphore doesn't explain the app spinning above it.
+    BugSplatHangFrame frames[] = {
+        { "My App", NULL, true },
+        { "libdispatch.dylib", "dispatch_semaphore_wait", false },
+    };
+    BugSplatHangClassification result = BugSplatHangClassify(frames, 2, BugSplatHangDefaultRules, BugSplatHangDefaultRuleCount);
+    XCTAssertEqualObjects(@(result.category), @"busy");
+    XCTAssertEqual(result.blockingFrame, BugSplatHangNoFrame);
+}
+
+- (void)testCustomRules_PrefixAndImage
+{
+    const BugSplatHangRule rules[] = {
+        { "realm", "realm::*", NULL },
+        { "network", "nw_*", "libnetwork.dylib" },
+    };
+    BugSplatHangFrame frames[] = {
+        { "Other.dylib", "nw_connection_wait", false },
+        { "libnetwork.dylib", "nw_connection_wait", false },
+    };
+    BugSplatHangClassification result = BugSplatHangClassify(frames, 2, rules, 2);
+    XCTAssertEqualObjects(@(result.category), @"network", @"The image must match too");
+    XCTAssertEqual(result.blockingFrame, 1u);
+
+    BugSplatHangFrame realm[] = { { "Realm", "realm::Transaction::commit", false } };
+    XCTAssertEqualObjects(@(BugSplatHangClassify(realm, 1, rules, 2).category), @"realm");
+}
+
+- (void)testDefaultRules_AreWellFormed
+{
+    for (size_t i = 0; i < BugSplatHangDefaultRuleCount; i++) {
+        const BugSplatHangRule *rule = &BugSplatHangDefaultRules[i];
+        XCTAssertTrue(rule->category && strlen(rule->category) > 0);
+        XCTAssertTrue(rule->symbol && strlen(rule->symbol) > 0);
+        XCTAssertTrue(strchr(rule->category, ' ') == NULL, @"Rule %zu: categories are attribute values", i);
+    }
+}
+
+#pragma mark - Parsing
+
+- (void)testParseLine_SymbolicatedAndNot
+{
+    BugSplatHangFrame frame;
+    char buffer[256];
+    XCTAssertTrue(BugSplatHangFrameParseLine("12  Google Chrome Framework     0x0000000110000000 ChromeMain + 40", NULL, &frame, buffer, sizeof(buffer)));
+    XCTAssertEqualObjects(@(frame.image), @"Google Chrome Framework");
+    XCTAssertEqualObjects(@(frame.symbol), @"ChromeMain");
+    XCTAssertFalse(frame.isApp);
+
+    XCTAssertTrue(BugSplatHangFrameParseLine("4   My App    0x0000000100a3c4d8 0x100a00000 + 247000", "My App", &frame, buffer, sizeof(buffer)));
+    XCTAssertEqualObjects(@(frame.image), @"My App");
+    XCTAssertTrue(frame.symbol == NULL);
+    XCTAssertTrue(frame.isApp);
+}
+
+- (void)testParseLine_RejectsOtherLines
+{
+    BugSplatHangFrame frame;
+    char buffer[256];
+    XCTAssertFalse(BugSplatHangFrameParseLine("Thread 0 Crashed:", NULL, &frame, buffer, sizeof(buffer)));
+    XCTAssertFalse(BugSplatHangFrameParseLine("0x100a00000 - 0x100a3ffff +My App arm64  <uuid> /path", NULL, &frame, buffer, sizeof(buffer)));
+    XCTAssertFalse(BugSplatHangFrameParseLine("", NULL, &frame, buffer, sizeof(buffer)));
+    XCTAssertFalse(BugSplatHangFrameParseLine("0   libsystem_kernel.dylib 0x00000001d7c1a4a8 __psynch_mutexwait + 8", NULL, &frame, buffer, 8),
+                   @"Too long for the buffer");
+}
+
+#pragma mark - Live threads
+
+- (void)testLiveThreadBlockedOnSemaphore_IsTaggedSemaphore
+{
+    // Installed with the hang queue when hang detection starts.
+    BugSplatImageListInstall();
+    BugSplat *bugSplat = [[BugSplat alloc] init];
+    dispatch_semaphore_t blocker = dispatch_semaphore_create(0);
+    dispatch_semaphore_t started = dispatch_semaphore_create(0);
+    __block mach_port_t port = MACH_PORT_NULL;
+    NSThread *thread = [[NSThread alloc] initWithBlock:^{
+        port = pthread_mach_thread_np(pthread_self());
+        dispatch_semaphore_signal(started);
+        dispatch_semaphore_wait(blocker, DISPATCH_TIME_FOREVER);
+    }];
+    [thread start];
+    dispatch_semaphore_wait(started, DISPATCH_TIME_FOREVER);
+    [NSThread sleepForTimeInterval:0.05];
+
+    NSDictionary<NSString *, NSString *> *attributes = [bugSplat hangCauseAttributesForThread:port];
+    dispatch_semaphore_signal(blocker);
+    XCTAssertEqualObjects(attributes[kHangAttrCategory], @"semaphore", @"%@", attributes);
+}
+
+- (void)testLiveThreadBlockedOnMutex_IsTaggedMutex
+{
+    // Installed with the hang queue when hang detection starts.
+    BugSplatImageListInstall();
+    BugSplat *bugSplat = [[BugSplat alloc] init];
+    static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+    pthread_mutex_lock(&mutex);
+    dispatch_semaphore_t started = dispatch_semaphore_create(0);
+    __block mach_port_t port = MACH_PORT_NULL;
+    NSThread *thread = [[NSThread alloc] initWithBlock:^{
+        port = pthread_mach_thread_np(pthread_self());
+        dispatch_semaphore_signal(started);
+        pthread_mutex_lock(&mutex);
+        pthread_mutex_unlock(&mutex);
+    }];
+    [thread start];
+    dispatch_semaphore_wait(started, DISPATCH_TIME_FOREVER);
+    [NSThread sleepForTimeInterval:0.05];
+
+    NSDictionary<NSString *, NSString *> *attributes = [bugSplat hangCauseAttributesForThread:port];
+    pthread_mutex_unlock(&mutex);
+    XCTAssertEqualObjects(attributes[kHangAttrCategory], @"mutex", @"%@", attributes);
+}
+
+- (void)testInvalidThread_HasNoAttributes
+{
+    BugSplat *bugSplat = [[BugSplat alloc] init];
+    XCTAssertEqualObjects([bugSplat hangCauseAttributesForThread:MACH_PORT_NULL], @{});
+}
+
+@end
@@ -15,6 +15,7 @@
 
 #import <BugSplat/BugSplat.h>
 #import "BugSplat+Testing.h"
+#import "BugSplatMetadataCodec.h"
 
 // Keys shared with BugSplat.m. Duplicated here rather than exposed via a
 // testing header because they are an implementation detail the backend also
@@ -27,6 +28,7 @@ static NSString *const kHangAttrDurationMs = @"bugsplat-hang-duration-ms";
 static NSString *const kHangAttrAppState = @"bugsplat-hang-app-state";
 static NSString *const kHangAttrDetectedAt = @"bugsplat-hang-detected-at";
 static NSString *const kHangAttrLaunchId = @"bugsplat-hang-launch-id";
+static NSString *const kHangAttrCategory = @"bugsplat-hang-category";
 
 
 @interface BugSplatHangPersistenceTests : XCTestCase
@@ -66,7 +68,7 @@ static NSString *const kHangAttrLaunchId = @"bugsplat-hang-launch-id";
 {
     NSString *dir = [self.bugSplat crashesDirectoryPath];
     NSFileManager *fm = [NSFileManager defaultManager];
-    for (NSString *ext in @[@"crash", @"meta"]) {
+    for (NSString *ext in @[@"crash", @"plcrash", @"meta"]) {
         NSString *path = [[dir stringByAppendingPathComponent:filename] stringByAppendingPathExtension:ext];
         if ([fm fileExistsAtPath:path]) {
             [fm removeItemAtPath:path error:nil];
@@ -133,7 +135,7 @@ static NSString *const kHangAttrLaunchId = @"bugsplat-hang-launch-id";
 
     NSString *dir = [self.bugSplat crashesDirectoryPath];
     NSString *metaPath = [[dir stringByAppendingPathComponent:filename] stringByAppendingPathExtension:@"meta"];
-    NSDictionary *meta = [NSDictionary dictionaryWithContentsOfFile:metaPath];
+    NSDictionary *meta = [BugSplatMetadataCodec metadataWithContentsOfFile:metaPath];
     XCTAssertNotNil(meta);
 
     XCTAssertEqualObjects(meta[kDatabaseKey], @"hangtestdb");
@@ -152,7 +154,7 @@ static NSString *const kHangAttrLaunchId = @"bugsplat-hang-launch-id";
 
     NSString *dir = [self.bugSplat crashesDirectoryPath];
     NSString *metaPath = [[dir stringByAppendingPathComponent:filename] stringByAppendingPathExtension:@"meta"];
-    NSDictionary *meta = [NSDictionary dictionaryWithContentsOfFile:metaPath];
+    NSDictionary *meta = [BugSplatMetadataCodec metadataWithContentsOfFile:metaPath];
     NSDictionary *attributes = meta[kAttributesKey];
     XCTAssertNotNil(attributes);
 
@@ -197,9 +199,100 @@ static NSString *const kHangAttrLaunchId = @"bugsplat-hang-launch-id";
 
     NSString *dir = [self.bugSplat crashesDirectoryPath];
     NSString *metaPath = [[dir stringByAppendingPathComponent:filename] stringByAppendingPathExtension:@"meta"];
-    NSDictionary *meta = [NSDictionary dictionaryWithContentsOfFile:metaPath];
+    NSDictionary *meta = [BugSplatMetadataCodec metadataWithContentsOfFile:metaPath];
     NSDictionary *attributes = meta[kAttributesKey];
     XCTAssertEqualObjects(attributes[kHangAttrAppState], @"unknown");
 }
 
+- (void)testHangDelegate_MetadataHasCauseCategory
+{
+    [self.bugSplat hangTracker:nil didDetectHangWithDuration:2.0 appState:@"active"];
+    [self drainHangQueue];
+
+    NSString *filename = [self.bugSplat currentHangFilename];
+    XCTAssertNotNil(filename);
+    self.filenameToCleanup = filename;
+
+    NSString *dir = [self.bugSplat crashesDirectoryPath];
+    NSString *metaPath = [[dir stringByAppendingPathComponent:filename] stringByAppendingPathExtension:@"meta"];
+    NSDictionary *attributes = [BugSplatMetadataCodec metadataWithContentsOfFile:metaPath][kAttributesKey];
+    // The main thread is somewhere in the test runner; only check it was classified.
+    XCTAssertGreaterThan([attributes[kHangAttrCategory] length], 0u);
+}
+
+#pragma mark - Deferred Formatting
+
+- (void)testHangDelegate_DeferredFormattingPersistsRawReportOnly
+{
+    self.bugSplat.deferCrashReportFormatting = YES;
+    [self.bugSplat hangTracker:nil didDetectHangWithDuration:3.0 appState:@"active"];
+    [self drainHangQueue];
+
+    NSString *filename = [self.bugSplat currentHangFilename];
+    XCTAssertNotNil(filename);
+    self.filenameToCleanup = filename;
+
+    NSString *base = [[self.bugSplat crashesDirectoryPath] stringByAppendingPathComponent:filename];
+    NSFileManager *fm = [NSFileManager defaultManager];
+    XCTAssertTrue([fm fileExistsAtPath:[base stringByAppendingPathExtension:@"plcrash"]]);
+    XCTAssertTrue([fm fileExistsAtPath:[base stringByAppendingPathExtension:@"meta"]]);
+    XCTAssertFalse([fm fileExistsAtPath:[base stringByAppendingPathExtension:@"crash"]],
+                   @"Text should not be formatted until the report is submitted");
+}
+
+- (void)testHangDelegate_DeferredFormattingRecoveryRemovesRawReport
+{
+    self.bugSplat.deferCrashReportFormatting = YES;
+    [self.bugSplat hangTracker:nil didDetectHangWithDuration:3.0 appState:@"active"];
+    [self drainHangQueue];
+
+    NSString *filename = [self.bugSplat currentHangFilename];
+    XCTAssertNotNil(filename);
+    NSString *rawPath = [[[self.bugSplat crashesDirectoryPath] stringByAppendingPathComponent:filename] stringByAppendingPathExtension:@"plcrash"];
+
+    [self.bugSplat hangTrackerDidRecoverFromHang:nil];
+    [self drainHangQueue];
+
+    XCTAssertFalse([[NSFileManager defaultManager] fileExistsAtPath:rawPath]);
+}
+
+- (void)testDeferredReport_FormatsOnFirstUseAndCachesText
+{
+    self.bugSplat.deferCrashReportFormatting = YES;
+    [self.bugSplat hangTracker:nil didDetectHangWithDuration:3.5 appState:@"active"];
+    [self drainHangQueue];
+
+    NSString *filename = [self.bugSplat currentHangFilename];
+    XCTAssertNotNil(filename);
+    self.filenameToCleanup = filename;
+
+    NSData *data = [self.bugSplat crashReportDataForFilename:filename];
+    NSString *text = [[NSString alloc] initWithData:data encoding:NSUTF8StringEncoding];
+    XCTAssertTrue([text containsString:@"App Hang (Fatal)"], @"got:\n%@", text);
+    XCTAssertTrue([text containsString:@"Main thread unresponsive for 3500 ms"], @"got:\n%@", text);
+
+    NSString *base = [[self.bugSplat crashesDirectoryPath] stringByAppendingPathComponent:filename];
+    NSFileManager *fm = [NSFileManager defaultManager];
+    XCTAssertTrue([fm fileExistsAtPath:[base stringByAppendingPathExtension:@"crash"]], @"Formatted text should be cached");
+    XCTAssertFalse([fm fileExistsAtPath:[base stringByAppendingPathExtension:@"plcrash"]]);
+
+    // A retry reads the cache rather than formatting again.
+    XCTAssertEqualObjects([self.bugSplat crashReportDataForFilename:filename], data);
+}
+
+- (void)testPersistedReport_BytesAreReturnedUnmodified
+{
+    // Not valid UTF-8: the bytes must still reach the upload unchanged rather than being
+    // rejected or transcoded.
+    const uint8_t bytes[] = { 'I', 'n', 'c', 'i', 'd', 'e', 'n', 't', ':', ' ', 0xC3, 0x28, 0xFF, '\n' };
+    NSData *reportData = [NSData dataWithBytes:bytes length:sizeof(bytes)];
+    NSString *filename = [NSString stringWithFormat:@"%.0f", [NSDate timeIntervalSinceReferenceDate] * 1000.0];
+    self.filenameToCleanup = filename;
+
+    NSString *base = [[self.bugSplat crashesDirectoryPath] stringByAppendingPathComponent:filename];
+    XCTAssertTrue([reportData writeToFile:[base stringByAppendingPathExtension:@"crash"] atomically:YES]);
+
+    XCTAssertEqualObjects([self.bugSplat crashReportDataForFilename:filename], reportData);
+}
+
 @end
@@ -0,0 +1,298 @@
+//
+//  BugSplatHangReportSlotTests.m
+//  BugSplatTests
+//
+//  Tests for the reserved hang report slot: the mapped record itself, and
+//  BugSplat recording a hang into the slot and converting it into a queued
+//  report on the next launch.
+//
+//  Copyright © BugSplat, LLC. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+
+#import <BugSplat/BugSplat.h>
+#import "BugSplat+Testing.h"
+#import "BugSplatCrashFilesTestCase.h"
+#import "BugSplatHangReportSlot.h"
+#import "BugSplatMetadataCodec.h"
+
+static NSString *const kHangSlotFilename = @"HangReport.slot";
+static NSString *const kHangSlotPendingFilename = @"HangReport.slot.pending";
+
+@interface BugSplatHangReportSlotTests : BugSplatCrashFilesTestCase
+@property (nonatomic, copy) NSString *slotPath;
+@property (nonatomic, strong, nullable) BugSplat *bugSplat;
+@end
+
+@implementation BugSplatHangReportSlotTests
+
+- (void)setUp
+{
+    [super setUp];
+    self.slotPath = [NSTemporaryDirectory() stringByAppendingPathComponent:
+                     [NSString stringWithFormat:@"BugSplatHangSlot-%@", [NSUUID UUID].UUIDString]];
+}
+
+- (void)tearDown
+{
+    [[NSFileManager defaultManager] removeItemAtPath:self.slotPath error:nil];
+
+    if (self.bugSplat) {
+        NSString *dir = [self.bugSplat crashesDirectoryPath];
+        NSString *slotDir = [dir stringByDeletingLastPathComponent];
+        [[NSFileManager defaultManager] removeItemAtPath:[slotDir stringByAppendingPathComponent:kHangSlotFilename] error:nil];
+        [[NSFileManager defaultManager] removeItemAtPath:[slotDir stringByAppendingPathComponent:kHangSlotPendingFilename] error:nil];
+    }
+    self.bugSplat = nil;
+    [super tearDown];
+}
+
+#pragma mark - Helpers
+
+- (BOOL)recordReport:(NSData *)report metadata:(nullable NSData *)metadata inSlot:(BugSplatHangReportSlot *)slot
+{
+    return [slot recordReportBytes:report.bytes
+                      reportLength:report.length
+                     metadataBytes:metadata.bytes
+                    metadataLength:metadata.length
+                        durationMs:4200
+                        detectedAt:700000000.5
+                          appState:"active"];
+}
+
+#pragma mark - Slot
+
+- (void)testNewSlot_HasNoValidRecord
+{
+    BugSplatHangReportSlot *slot = [[BugSplatHangReportSlot alloc] initWithPath:self.slotPath capacity:64 * 1024];
+    XCTAssertNotNil(slot);
+    XCTAssertFalse(slot.hasValidRecord);
+    XCTAssertNil(slot.reportData);
+    XCTAssertFalse([BugSplatHangReportSlot fileAtPathHasValidRecord:self.slotPath]);
+
+    NSDictionary *attributes = [[NSFileManager defaultManager] attributesOfItemAtPath:self.slotPath error:nil];
+    XCTAssertEqual([attributes fileSize], 64 * 1024ULL, @"Slot file should be sized up front");
+}
+
+- (void)testRecord_RoundTrips
+{
+    BugSplatHangReportSlot *slot = [[BugSplatHangReportSlot alloc] initWithPath:self.slotPath capacity:64 * 1024];
+    [slot setLaunchId:@"launch-1"];
+    NSData *report = [@"raw report bytes" dataUsingEncoding:NSUTF8StringEncoding];
+    NSData *metadata = [BugSplatMetadataCodec dataWithMetadata:@{ @"database": @"slotdb" }];
+
+    XCTAssertTrue([self recordReport:report metadata:metadata inSlot:slot]);
+    XCTAssertTrue(slot.hasValidRecord);
+    XCTAssertEqualObjects(slot.reportData, report);
+    XCTAssertEqualObjects(slot.metadataData, metadata);
+    XCTAssertEqual(slot.durationMs, 4200ULL);
+    XCTAssertEqualWithAccuracy(slot.detectedAt, 700000000.5, 0.001);
+    XCTAssertEqualObjects(slot.appState, @"active");
+    XCTAssertEqualObjects(slot.launchId, @"launch-1");
+}
+
+- (void)testRecord_SurvivesReopen
+{
+    NSData *report = [@"persisted" dataUsingEncoding:NSUTF8StringEncoding];
+    @autoreleasepool {
+        BugSplatHangReportSlot *slot = [[BugSplatHangReportSlot alloc] initWithPath:self.slotPath capacity:64 * 1024];
+        XCTAssertTrue([self recordReport:report metadata:nil inSlot:slot]);
+        slot = nil;
+    }
+
+    XCTAssertTrue([BugSplatHangReportSlot fileAtPathHasValidRecord:self.slotPath]);
+    BugSplatHangReportSlot *reopened = [[BugSplatHangReportSlot alloc] initWithPath:self.slotPath capacity:64 * 1024];
+    XCTAssertTrue(reopened.hasValidRecord);
+    XCTAssertEqualObjects(reopened.reportData, report);
+    XCTAssertNil(reopened.metadataData);
+}
+
+- (void)testRecord_WithProfileAndCauseRoundTrips
+{
+    BugSplatHangReportSlot *slot = [[BugSplatHangReportSlot alloc] initWithPath:self.slotPath capacity:64 * 1024];
+    NSData *report = [@"raw report bytes" dataUsingEncoding:NSUTF8StringEncoding];
+    NSData *metadata = [BugSplatMetadataCodec dataWithMetadata:@{ @"database": @"slotdb" }];
+    NSData *profile = [@"profile" dataUsingEncoding:NSUTF8StringEncoding];
+    char longFrame[200];
+    memset(longFrame, 'f', sizeof(longFrame) - 1);
+    longFrame[sizeof(longFrame) - 1] = '\0';
+
+    XCTAssertTrue([slot recordReportBytes:report.bytes
+                             reportLength:report.length
+                            metadataBytes:metadata.bytes
+                           metadataLength:metadata.length
+                             profileBytes:profile.bytes
+                            profileLength:profile.length
+                            causeCategory:"dispatch-sync"
+                                 appFrame:longFrame
+                               durationMs:4200
+                               detectedAt:700000000.5
+                                 appState:"active"]);
+    XCTAssertEqualObjects(slot.reportData, report);
+    XCTAssertEqualObjects(slot.metadataData, metadata);
+    XCTAssertEqualObjects(slot.profileData, profile);
+    XCTAssertEqualObjects(slot.causeCategory, @"dispatch-sync");
+    XCTAssertEqual(slot.appFrame.length, 127u, @"Truncated to the fixed field");
+
+    XCTAssertTrue([self recordReport:report metadata:nil inSlot:slot]);
+    XCTAssertNil(slot.profileData);
+    XCTAssertNil(slot.causeCategory, @"A new record clears the previous cause");
+    XCTAssertNil(slot.appFrame);
+}
+
+- (void)testInvalidate_ClearsRecord
+{
+    BugSplatHangReportSlot *slot = [[BugSplatHangReportSlot alloc] initWithPath:self.slotPath capacity:64 * 1024];
+    XCTAssertTrue([self recordReport:[NSData dataWithBytes:"x" length:1] metadata:nil inSlot:slot]);
+
+    [slot invalidate];
+
+    XCTAssertFalse(slot.hasValidRecord);
+    XCTAssertNil(slot.reportData);
+    XCTAssertFalse([BugSplatHangReportSlot fileAtPathHasValidRecord:self.slotPath]);
+}
+
+- (void)testRecord_RejectsReportLargerThanCapacity
+{
+    BugSplatHangReportSlot *slot = [[BugSplatHangReportSlot alloc] initWithPath:self.slotPath capacity:4096];
+    XCTAssertTrue([self recordReport:[NSData dataWithBytes:"x" length:1] metadata:nil inSlot:slot]);
+
+    NSData *tooLarge = [NSMutableData dataWithLength:8192];
+    XCTAssertFalse([self recordReport:tooLarge metadata:nil inSlot:slot]);
+    XCTAssertFalse(slot.hasValidRecord, @"A rejected record must not leave the previous one valid");
+}
+
+- (void)testRecord_WithLengthsPastCapacityIsTreatedAsEmpty
+{
+    @autoreleasepool {
+        BugSplatHangReportSlot *slot = [[BugSplatHangReportSlot alloc] initWithPath:self.slotPath capacity:4096];
+        XCTAssertTrue([self recordReport:[NSData dataWithBytes:"x" length:1] metadata:nil inSlot:slot]);
+        slot = nil;
+    }
+
+    // Corrupt the header's report and metadata lengths so their sum wraps 32 bits
+    uint32_t lengths[2] = { 0xFFFFFFF0u, 0x20u };
+    NSFileHandle *handle = [NSFileHandle fileHandleForWritingAtPath:self.slotPath];
+    [handle seekToFileOffset:12];
+    [handle writeData:[NSData dataWithBytes:lengths length:sizeof(lengths)]];
+    [handle closeFile];
+
+    XCTAssertFalse([BugSplatHangReportSlot fileAtPathHasValidRecord:self.slotPath]);
+    BugSplatHangReportSlot *reopened = [[BugSplatHangReportSlot alloc] initWithPath:self.slotPath capacity:4096];
+    XCTAssertFalse(reopened.hasValidRecord);
+    XCTAssertNil(reopened.reportData);
+    XCTAssertNil(reopened.metadataData);
+}
+
+#pragma mark - BugSplat integration
+
+- (void)testHangRecordedInSlot_IsQueuedOnNextLaunch
+{
+    self.bugSplat = [[BugSplat alloc] init];
+    self.bugSplat.bugSplatDatabase = @"slotdb";
+    self.bugSplat.applicationName = @"SlotTest";
+    self.bugSplat.applicationVersion = @"2.0";
+    self.bugSplat.enableHangDetection = YES;
+    self.bugSplat.reserveHangReportStorage = YES;
+    [self.bugSplat setupHangInfrastructureForTesting];
+    [self snapshotCrashFilesOfBugSplat:self.bugSplat];
+
+    [self.bugSplat reserveHangReportSlot];
+    XCTAssertNotNil([self.bugSplat hangReportSlot]);
+
+    [self.bugSplat hangTracker:nil didDetectHangWithDuration:3.0 appState:@"active"];
+    dispatch_sync([self.bugSplat hangQueueForTesting], ^{});
+
+    XCTAssertTrue([self.bugSplat hangReportSlot].hasValidRecord);
+    XCTAssertEqual([self newCrashFiles].count, 0u, @"Recording into the slot should not create queue files");
+
+    // Next launch: a fresh instance without a reservation of its own picks up the record.
+    BugSplat *nextLaunch = [[BugSplat alloc] init];
+    nextLaunch.bugSplatDatabase = @"otherdb";
+    [nextLaunch recoverReservedHangReport];
+
+    NSArray<NSString *> *added = [self newCrashFiles];
+    NSString *crashFile = [[added filteredArrayUsingPredicate:[NSPredicate predicateWithFormat:@"SELF ENDSWITH '-hang.crash'"]] firstObject];
+    NSString *metaFile = [[added filteredArrayUsingPredicate:[NSPredicate predicateWithFormat:@"SELF ENDSWITH '-hang.meta'"]] firstObject];
+    XCTAssertNotNil(crashFile);
+    XCTAssertNotNil(metaFile);
+
+    NSString *dir = [self.bugSplat crashesDirectoryPath];
+    NSString *crashText = [NSString stringWithContentsOfFile:[dir stringByAppendingPathComponent:crashFile] encoding:NSUTF8StringEncoding error:nil];
+    XCTAssertTrue([crashText containsString:@"App Hang (Fatal)"]);
+
+    NSDictionary *meta = [BugSplatMetadataCodec metadataWithContentsOfFile:[dir stringByAppendingPathComponent:metaFile]];
+    XCTAssertEqualObjects(meta[@"database"], @"slotdb", @"Metadata should come from the hung launch, not the current one");
+    XCTAssertEqualObjects(meta[@"userSubmitted"], @YES);
+    XCTAssertEqualObjects(meta[@"attributes"][@"bugsplat-hang-duration-ms"], @"3000");
+    XCTAssertEqualObjects(meta[@"attributes"][@"bugsplat-hang-app-state"], @"active");
+    XCTAssertGreaterThan([meta[@"attributes"][@"bugsplat-hang-category"] length], 0u, @"Cause attributes travel in the slot");
+
+    NSString *slotDir = [dir stringByDeletingLastPathComponent];
+    XCTAssertFalse([BugSplatHangReportSlot fileAtPathHasValidRecord:[slotDir stringByAppendingPathComponent:kHangSlotPendingFilename]]);
+}
+
+- (void)testRecoveredHang_KeepsCauseAttributesAndProfile
+{
+    self.bugSplat = [[BugSplat alloc] init];
+    [self snapshotCrashFilesOfBugSplat:self.bugSplat];
+    NSString *dir = [self.bugSplat crashesDirectoryPath];
+    NSString *slotPath = [[dir stringByDeletingLastPathComponent] stringByAppendingPathComponent:kHangSlotFilename];
+
+    // What the hung launch recorded: crash-time properties, the profile and the cause.
+    NSData *profile = [@"Hang profile: 10 samples\n" dataUsingEncoding:NSUTF8StringEncoding];
+    NSData *metadata = [BugSplatMetadataCodec dataWithMetadata:@{ @"database": @"slotdb" }];
+    NSData *report = [@"not a plcrash report" dataUsingEncoding:NSUTF8StringEncoding];
+    BugSplatHangReportSlot *slot = [[BugSplatHangReportSlot alloc] initWithPath:slotPath
+                                                                       capacity:kBugSplatHangReportSlotDefaultCapacity];
+    XCTAssertTrue([slot recordReportBytes:report.bytes
+                             reportLength:report.length
+                            metadataBytes:metadata.bytes
+                           metadataLength:metadata.length
+                             profileBytes:profile.bytes
+                            profileLength:profile.length
+                            causeCategory:"mutex"
+                                 appFrame:"MyApp+0x1f00"
+                               durationMs:4200
+                               detectedAt:700000000.5
+                                 appState:"active"]);
+    slot = nil;
+
+    [self.bugSplat recoverReservedHangReport];
+
+    NSArray<NSString *> *added = [self newCrashFiles];
+    NSString *metaFile = [[added filteredArrayUsingPredicate:[NSPredicate predicateWithFormat:@"SELF ENDSWITH '-hang.meta'"]] firstObject];
+    XCTAssertNotNil(metaFile, @"%@", added);
+    NSDictionary *meta = [BugSplatMetadataCodec metadataWithContentsOfFile:[dir stringByAppendingPathComponent:metaFile]];
+    XCTAssertEqualObjects(meta[@"database"], @"slotdb");
+    XCTAssertEqualObjects(meta[@"attributes"][@"bugsplat-hang-category"], @"mutex");
+    XCTAssertEqualObjects(meta[@"attributes"][@"bugsplat-hang-app-frame"], @"MyApp+0x1f00");
+
+    NSString *base = [metaFile stringByDeletingPathExtension];
+    NSData *encoded = [NSData dataWithContentsOfFile:[dir stringByAppendingPathComponent:[base stringByAppendingString:@"-0.data"]]];
+    BugSplatAttachment *attachment = encoded ? [BugSplatMetadataCodec attachmentWithData:encoded] : nil;
+    XCTAssertEqualObjects(attachment.filename, @"BugSplatHangProfile.txt");
+    XCTAssertEqualObjects(attachment.attachmentData, profile);
+}
+
+- (void)testRecoveredHang_LeavesSlotEmpty
+{
+    self.bugSplat = [[BugSplat alloc] init];
+    self.bugSplat.bugSplatDatabase = @"slotdb";
+    self.bugSplat.enableHangDetection = YES;
+    self.bugSplat.reserveHangReportStorage = YES;
+    [self.bugSplat setupHangInfrastructureForTesting];
+    [self snapshotCrashFilesOfBugSplat:self.bugSplat];
+    [self.bugSplat reserveHangReportSlot];
+
+    [self.bugSplat hangTracker:nil didDetectHangWithDuration:3.0 appState:@"active"];
+    [self.bugSplat hangTrackerDidRecoverFromHang:nil];
+    dispatch_sync([self.bugSplat hangQueueForTesting], ^{});
+
+    XCTAssertFalse([self.bugSplat hangReportSlot].hasValidRecord);
+    [[[BugSplat alloc] init] recoverReservedHangReport];
+    XCTAssertEqual([self newCrashFiles].count, 0u);
+}
+
+@end
@@ -0,0 +1,184 @@
+//
+//  BugSplatHangSnapshotTests.m
+//  BugSplatTests
+//
+//  Tests for tiered hang capture: the single-thread snapshot and its report
+//  text, and BugSplat writing a snapshot at detection, dropping it when the
+//  main thread recovers, and replacing it with a full live report when the
+//  hang outlasts the escalation threshold.
+//
+//  Copyright © BugSplat, LLC. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+#import <pthread.h>
+
+#import <BugSplat/BugSplat.h>
+#import "BugSplat+Testing.h"
+#import "BugSplatHangSnapshot.h"
+#import "BugSplatImageList.h"
+
+@interface BugSplatHangSnapshotTests : XCTestCase
+@property (nonatomic, strong, nullable) BugSplat *bugSplat;
+@end
+
+@implementation BugSplatHangSnapshotTests
+
+- (void)tearDown
+{
+    if (self.bugSplat) {
+        NSString *dir = [self.bugSplat crashesDirectoryPath];
+        for (NSString *file in [[NSFileManager defaultManager] contentsOfDirectoryAtPath:dir error:nil]) {
+            if ([file containsString:@"-hang"]) {
+                [[NSFileManager defaultManager] removeItemAtPath:[dir stringByAppendingPathComponent:file] error:nil];
+            }
+        }
+    }
+    self.bugSplat = nil;
+    [super tearDown];
+}
+
+#pragma mark - Helpers
+
+- (void)setUpBugSplatWithEscalationThreshold:(NSTimeInterval)escalationThreshold
+{
+    self.bugSplat = [[BugSplat alloc] init];
+    self.bugSplat.bugSplatDatabase = @"snapshotdb";
+    self.bugSplat.enableHangDetection = YES;
+    self.bugSplat.hangDetectionThreshold = 2.0;
+    self.bugSplat.hangReportEscalationThreshold = escalationThreshold;
+    [self.bugSplat setupHangInfrastructureForTesting];
+}
+
+- (void)drainHangQueue
+{
+    dispatch_sync([self.bugSplat hangQueueForTesting], ^{});
+}
+
+- (NSString *)reportTextForFilename:(NSString *)filename
+{
+    NSString *path = [[[self.bugSplat crashesDirectoryPath] stringByAppendingPathComponent:filename] stringByAppendingPathExtension:@"crash"];
+    return [NSString stringWithContentsOfFile:path encoding:NSUTF8StringEncoding error:nil];
+}
+
+- (BOOL)reportExistsForFilename:(NSString *)filename
+{
+    NSString *base = [[self.bugSplat crashesDirectoryPath] stringByAppendingPathComponent:filename];
+    NSFileManager *fm = [NSFileManager defaultManager];
+    return [fm fileExistsAtPath:[base stringByAppendingPathExtension:@"crash"]]
+        || [fm fileExistsAtPath:[base stringByAppendingPathExtension:@"meta"]];
+}
+
+#pragma mark - Snapshot
+
+- (void)testCapture_RecordsBlockedThreadAndFormatsReport
+{
+    BugSplatHangSnapshot *snapshot = [[BugSplatHangSnapshot alloc] initWithMaxFrames:128];
+    mach_port_t mainThread = pthread_mach_thread_np(pthread_self());
+
+    // Capture this (the main) thread from another thread while it waits.
+    __block BOOL captured = NO;
+    dispatch_sync(dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^{
+        captured = [snapshot captureThread:mainThread];
+    });
+    XCTAssertTrue(captured);
+    XCTAssertGreaterThan(snapshot.frameCount, 0u);
+    XCTAssertLessThanOrEqual(snapshot.frameCount, 128u);
+    XCTAssertNotEqual(snapshot.frames[0], 0u);
+
+    NSString *text = [[NSString alloc] initWithData:[snapshot reportTextWithExceptionName:@"App Hang (Fatal)"
+                                                                                  reason:@"Main thread unresponsive for 2000 ms"]
+                                           encoding:NSUTF8StringEncoding];
+    XCTAssertTrue([text containsString:@"Exception Type:  SIGTRAP"], @"%@", text);
+    XCTAssertTrue([text containsString:@"'App Hang (Fatal)', reason: 'Main thread unresponsive for 2000 ms'"], @"%@", text);
+    XCTAssertTrue([text containsString:@"Thread 0 Crashed:\n0   "], @"%@", text);
+    XCTAssertTrue([text containsString:@"Binary Images:\n0x"], @"%@", text);
+    XCTAssertFalse([text containsString:@"Thread 1"], @"Only the captured thread is written");
+
+    BugSplatImage image;
+    XCTAssertTrue(BugSplatImageListFindAddress(snapshot.frames[0], &image));
+    char uuid[BugSplatImageUUIDStringLength];
+    BugSplatImageFormatUUID(image.uuid, uuid);
+    XCTAssertTrue([text containsString:[NSString stringWithFormat:@"<%s> %s\n", uuid, image.path]],
+                  @"The innermost frame's image is listed: %@", text);
+}
+
+- (void)testCapture_InvalidThreadFails
+{
+    BugSplatHangSnapshot *snapshot = [[BugSplatHangSnapshot alloc] initWithMaxFrames:16];
+    XCTAssertFalse([snapshot captureThread:MACH_PORT_NULL]);
+    XCTAssertEqual(snapshot.frameCount, 0u);
+}
+
+#pragma mark - Tiered capture
+
+- (void)testEscalationDisabled_WritesFullReportAtDetection
+{
+    [self setUpBugSplatWithEscalationThreshold:0];
+    [self.bugSplat hangTracker:nil didDetectHangWithDuration:2.0 appState:@"active"];
+    [self drainHangQueue];
+
+    NSString *text = [self reportTextForFilename:[self.bugSplat currentHangFilename]];
+    XCTAssertTrue([text containsString:@"Thread 1"], @"Full live reports include every thread");
+}
+
+- (void)testDetection_WritesSnapshotReport
+{
+    [self setUpBugSplatWithEscalationThreshold:60.0];
+    [self.bugSplat hangTracker:nil didDetectHangWithDuration:2.0 appState:@"active"];
+    [self drainHangQueue];
+
+    NSString *filename = [self.bugSplat currentHangFilename];
+    XCTAssertNotNil(filename);
+    NSString *text = [self reportTextForFilename:filename];
+    XCTAssertTrue([text containsString:@"App Hang (Fatal)"], @"%@", text);
+    XCTAssertTrue([text containsString:@"Thread 0 Crashed:"], @"%@", text);
+    XCTAssertFalse([text containsString:@"Thread 1"], @"The snapshot holds the main thread only");
+    XCTAssertTrue([self reportExistsForFilename:filename]);
+}
+
+- (void)testRecoveryBeforeEscalation_RemovesSnapshotAndSkipsFullReport
+{
+    [self setUpBugSplatWithEscalationThreshold:2.2];
+    [self.bugSplat hangTracker:nil didDetectHangWithDuration:2.0 appState:@"active"];
+    [self drainHangQueue];
+    NSString *snapshotFilename = [self.bugSplat currentHangFilename];
+    XCTAssertNotNil(snapshotFilename);
+
+    [self.bugSplat hangTrackerDidRecoverFromHang:nil];
+    [self drainHangQueue];
+    XCTAssertFalse([self reportExistsForFilename:snapshotFilename]);
+
+    // Let the escalation deadline pass; it must find the hang over.
+    [NSThread sleepForTimeInterval:0.4];
+    [self drainHangQueue];
+    XCTAssertNil([self.bugSplat currentHangFilename]);
+}
+
+- (void)testHangPastEscalation_ReplacesSnapshotWithFullReport
+{
+    [self setUpBugSplatWithEscalationThreshold:2.2];
+    [self.bugSplat hangTracker:nil didDetectHangWithDuration:2.0 appState:@"active"];
+    [self drainHangQueue];
+    NSString *snapshotFilename = [self.bugSplat currentHangFilename];
+    XCTAssertNotNil(snapshotFilename);
+
+    [NSThread sleepForTimeInterval:0.4];
+    [self drainHangQueue];
+
+    NSString *fullFilename = [self.bugSplat currentHangFilename];
+    XCTAssertNotNil(fullFilename);
+    XCTAssertNotEqualObjects(fullFilename, snapshotFilename);
+    XCTAssertFalse([self reportExistsForFilename:snapshotFilename]);
+
+    NSString *text = [self reportTextForFilename:fullFilename];
+    XCTAssertTrue([text containsString:@"App Hang (Fatal)"], @"%@", text);
+    XCTAssertTrue([text containsString:@"Thread 1"], @"The escalated report includes every thread");
+
+    // Recovering now removes the full report.
+    [self.bugSplat hangTrackerDidRecoverFromHang:nil];
+    [self drainHangQueue];
+    XCTAssertFalse([self reportExistsForFilename:fullFilename]);
+}
+
+@end
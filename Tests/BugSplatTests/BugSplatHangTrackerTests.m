@@ -8,6 +8,7 @@
 #import <XCTest/XCTest.h>
 #import <CoreFoundation/CoreFoundation.h>
 #import "BugSplatHangTracker.h"
+#import "BugSplatHangHeartbeat.h"
 
 
 /// Private testing surface. Implementations live in `BugSplatHangTracker.m`;
@@ -24,12 +25,25 @@
                             pingDispatcher:(void(^)(dispatch_block_t))pingDispatcher;
 - (void)_processPollWithActualSleepDuration:(NSTimeInterval)actualSleep;
 - (void)handleMainQueuePong;
+- (NSTimeInterval)_processHeartbeatAtTime:(uint64_t)now
+                      actualSleepDuration:(NSTimeInterval)actualSleep
+                    expectedSleepDuration:(NSTimeInterval)expectedSleep;
+- (void)recordHeartbeat:(uint64_t)heartbeat;
+- (void)sendPingIfNeeded:(dispatch_block_t)ping;
+- (NSTimeInterval)_nextPollIntervalAfter:(NSTimeInterval)interval;
+- (uint64_t)lastHeartbeat;
 @end
 
+/// Heartbeat timestamps in the tests are whole nanoseconds from an arbitrary origin.
+static const uint64_t kSecond = NSEC_PER_SEC;
+
 
 @interface MockHangTrackerDelegate : NSObject <BugSplatHangTrackerDelegate>
 @property (atomic, assign) NSInteger hangCount;
 @property (atomic, assign) NSInteger recoverCount;
+@property (atomic, assign) NSInteger stallCount;
+@property (atomic, assign) NSInteger stallEndCount;
+@property (atomic, assign) NSTimeInterval lastStallDuration;
 @property (atomic, assign) NSTimeInterval lastDuration;
 @property (atomic, copy, nullable) NSString *lastAppState;
 @end
@@ -50,6 +64,17 @@ didDetectHangWithDuration:(NSTimeInterval)duration
     self.recoverCount += 1;
 }
 
+- (void)hangTracker:(BugSplatHangTracker *)tracker didDetectStallWithDuration:(NSTimeInterval)duration
+{
+    self.stallCount += 1;
+    self.lastStallDuration = duration;
+}
+
+- (void)hangTrackerDidEndStall:(BugSplatHangTracker *)tracker
+{
+    self.stallEndCount += 1;
+}
+
 @end
 
 
@@ -93,10 +118,18 @@ didDetectHangWithDuration:(NSTimeInterval)duration
     // Use a normal (non-suspension) sleep duration so the guard doesn't reset.
     NSTimeInterval normalSleep = tracker.thresholdSeconds / 5.0;
     for (NSInteger i = 0; i < n; i++) {
-        [tracker _processPollWithActualSleepDuration:normalSleep];
+        [self pollTracker:tracker afterSleeping:normalSleep];
     }
 }
 
+/// One poll as the watchdog runs it: a ping is in flight (the no-op dispatcher drops it,
+/// so it stays unanswered until -handleMainQueuePong) while the watchdog sleeps.
+- (void)pollTracker:(BugSplatHangTracker *)tracker afterSleeping:(NSTimeInterval)sleep
+{
+    [tracker sendPingIfNeeded:^{}];
+    [tracker _processPollWithActualSleepDuration:sleep];
+}
+
 #pragma mark - Initializer
 
 - (void)testInit_ClampsBelowMinimumThreshold
@@ -187,6 +220,22 @@ didDetectHangWithDuration:(NSTimeInterval)duration
     XCTAssertEqual(self.mockDelegate.recoverCount, 0);
 }
 
+- (void)testFirstPongHandler_RunsOnceOnFirstPong
+{
+    BugSplatHangTracker *tracker = [self trackerWithThreshold:2.0 debuggerAttached:NO appActive:YES];
+    __block NSInteger calls = 0;
+    tracker.firstPongHandler = ^{
+        calls++;
+    };
+
+    [self pollTracker:tracker times:1];
+    XCTAssertEqual(calls, 0, @"Not before the main queue answers");
+    [tracker handleMainQueuePong];
+    [tracker handleMainQueuePong];
+    XCTAssertEqual(calls, 1);
+    XCTAssertNil(tracker.firstPongHandler);
+}
+
 #pragma mark - Throttle
 
 - (void)testThrottle_OnlyOneHangPerProcessingWindow
@@ -223,7 +272,7 @@ didDetectHangWithDuration:(NSTimeInterval)duration
     XCTAssertEqual(self.mockDelegate.hangCount, 0);
 
     // A long sleep (e.g. device suspended) - guard resets the counter.
-    [tracker _processPollWithActualSleepDuration:30.0];
+    [self pollTracker:tracker afterSleeping:30.0];
     XCTAssertEqual(self.mockDelegate.hangCount, 0);
 
     // The next few polls should not be enough to fire because the counter
@@ -241,11 +290,328 @@ didDetectHangWithDuration:(NSTimeInterval)duration
     // scheduling.
     NSTimeInterval slightlyLong = 0.45;
     for (NSInteger i = 0; i < 5; i++) {
-        [tracker _processPollWithActualSleepDuration:slightlyLong];
+        [self pollTracker:tracker afterSleeping:slightlyLong];
     }
     XCTAssertEqual(self.mockDelegate.hangCount, 1);
 }
 
+#pragma mark - Heartbeat
+
+/// One heartbeat-mode watchdog pass with an on-time sleep.
+- (NSTimeInterval)checkHeartbeatOf:(BugSplatHangTracker *)tracker at:(uint64_t)now
+{
+    return [tracker _processHeartbeatAtTime:now actualSleepDuration:0.5 expectedSleepDuration:0.5];
+}
+
+- (void)testHeartbeat_IdleLoopIsNotAHang
+{
+    BugSplatHangTracker *tracker = [self trackerWithThreshold:2.0 debuggerAttached:NO appActive:YES];
+    [tracker markIdle];
+
+    NSTimeInterval sleep = [self checkHeartbeatOf:tracker at:600 * kSecond];
+    XCTAssertEqual(self.mockDelegate.hangCount, 0);
+    XCTAssertEqualWithAccuracy(sleep, 2.0, 0.0001, @"An idle loop needs a full threshold to hang");
+}
+
+- (void)testHeartbeat_SleepsUntilStallCouldReachThreshold
+{
+    BugSplatHangTracker *tracker = [self trackerWithThreshold:2.0 debuggerAttached:NO appActive:YES];
+    [tracker recordHeartbeat:100 * kSecond];
+
+    NSTimeInterval sleep = [self checkHeartbeatOf:tracker at:100 * kSecond + kSecond / 2];
+    XCTAssertEqual(self.mockDelegate.hangCount, 0);
+    XCTAssertEqualWithAccuracy(sleep, 1.5, 0.0001);
+}
+
+- (void)testHeartbeat_ReportsExactStallDuration
+{
+    BugSplatHangTracker *tracker = [self trackerWithThreshold:2.0 debuggerAttached:NO appActive:YES];
+    [tracker recordHeartbeat:100 * kSecond];
+
+    [self checkHeartbeatOf:tracker at:102 * kSecond + 37 * NSEC_PER_MSEC];
+    XCTAssertEqual(self.mockDelegate.hangCount, 1);
+    XCTAssertEqualWithAccuracy(self.mockDelegate.lastDuration, 2.037, 0.000001);
+    XCTAssertEqualObjects(self.mockDelegate.lastAppState, @"active");
+
+    // Still stuck on the same heartbeat: reported once.
+    [self checkHeartbeatOf:tracker at:110 * kSecond];
+    XCTAssertEqual(self.mockDelegate.hangCount, 1);
+    XCTAssertEqual(self.mockDelegate.recoverCount, 0);
+}
+
+- (void)testHeartbeat_RecoversWhenLoopTicksOrGoesIdle
+{
+    BugSplatHangTracker *tracker = [self trackerWithThreshold:2.0 debuggerAttached:NO appActive:YES];
+    [tracker recordHeartbeat:100 * kSecond];
+    [self checkHeartbeatOf:tracker at:103 * kSecond];
+    XCTAssertEqual(self.mockDelegate.hangCount, 1);
+
+    [tracker recordHeartbeat:104 * kSecond];
+    [self checkHeartbeatOf:tracker at:104 * kSecond + 1];
+    XCTAssertEqual(self.mockDelegate.recoverCount, 1);
+
+    // A second stall is a new window; the loop going idle ends it.
+    [self checkHeartbeatOf:tracker at:107 * kSecond];
+    XCTAssertEqual(self.mockDelegate.hangCount, 2);
+    [tracker markIdle];
+    [self checkHeartbeatOf:tracker at:108 * kSecond];
+    XCTAssertEqual(self.mockDelegate.recoverCount, 2);
+}
+
+- (void)testHeartbeat_GuardsSuppressDetection
+{
+    BugSplatHangTracker *debugged = [self trackerWithThreshold:2.0 debuggerAttached:YES appActive:YES];
+    [debugged recordHeartbeat:100 * kSecond];
+    [self checkHeartbeatOf:debugged at:110 * kSecond];
+
+    BugSplatHangTracker *inactive = [self trackerWithThreshold:2.0 debuggerAttached:NO appActive:NO];
+    [inactive recordHeartbeat:100 * kSecond];
+    [self checkHeartbeatOf:inactive at:110 * kSecond];
+
+    XCTAssertEqual(self.mockDelegate.hangCount, 0);
+}
+
+- (void)testHeartbeat_SuspensionRestartsTheMeasurement
+{
+    BugSplatHangTracker *tracker = [self trackerWithThreshold:2.0 debuggerAttached:NO appActive:YES];
+    [tracker recordHeartbeat:100 * kSecond];
+
+    // The watchdog overslept by far more than the threshold: process was suspended.
+    [tracker _processHeartbeatAtTime:160 * kSecond actualSleepDuration:60.0 expectedSleepDuration:0.5];
+    XCTAssertEqual(self.mockDelegate.hangCount, 0);
+    XCTAssertEqual([tracker lastHeartbeat], 160 * kSecond);
+
+    [self checkHeartbeatOf:tracker at:161 * kSecond];
+    XCTAssertEqual(self.mockDelegate.hangCount, 0);
+    [self checkHeartbeatOf:tracker at:162 * kSecond];
+    XCTAssertEqual(self.mockDelegate.hangCount, 1);
+    XCTAssertEqualWithAccuracy(self.mockDelegate.lastDuration, 2.0, 0.000001);
+}
+
+- (void)testHeartbeat_CFunctionsFeedOnlyTheStartedTracker
+{
+    BugSplatHangTracker *tracker = [self trackerWithThreshold:2.0 debuggerAttached:NO appActive:YES];
+    tracker.usesHeartbeat = YES;
+    [tracker markIdle];
+    BugSplatHangHeartbeatTick();
+    XCTAssertEqual([tracker lastHeartbeat], 0u, @"Not started yet");
+
+    [tracker start];
+    XCTAssertNotEqual([tracker lastHeartbeat], 0u, @"-start ticks: the main thread is busy right now");
+    BugSplatHangHeartbeatIdle();
+    XCTAssertEqual([tracker lastHeartbeat], 0u);
+    BugSplatHangHeartbeatTick();
+    XCTAssertNotEqual([tracker lastHeartbeat], 0u);
+
+    [tracker stop];
+    BugSplatHangHeartbeatIdle();
+    XCTAssertNotEqual([tracker lastHeartbeat], 0u, @"Stopped trackers are detached");
+}
+
+- (void)testHeartbeat_MainRunLoopObserverTicks
+{
+    BugSplatHangTracker *tracker = [self trackerWithThreshold:2.0 debuggerAttached:NO appActive:YES];
+    tracker.usesHeartbeat = YES;
+    [tracker start];
+    [tracker markIdle];
+
+    // Spinning the run loop runs the observer; it leaves the loop marked idle before waiting.
+    __block uint64_t seenWhileRunning = 0;
+    dispatch_async(dispatch_get_main_queue(), ^{
+        seenWhileRunning = [tracker lastHeartbeat];
+    });
+    [[NSRunLoop mainRunLoop] runMode:NSDefaultRunLoopMode beforeDate:[NSDate dateWithTimeIntervalSinceNow:0.1]];
+    XCTAssertNotEqual(seenWhileRunning, 0u, @"Busy loop passes carry a timestamp");
+    [tracker stop];
+}
+
+#pragma mark - Stall callbacks
+
+- (void)testStall_PingModeReportsOnceBeforeHang
+{
+    BugSplatHangTracker *tracker = [self trackerWithThreshold:2.0 debuggerAttached:NO appActive:YES];
+    tracker.stallThresholdSeconds = 1.0;
+
+    [self pollTracker:tracker times:2];
+    XCTAssertEqual(self.mockDelegate.stallCount, 0);
+    [self pollTracker:tracker times:1];
+    XCTAssertEqual(self.mockDelegate.stallCount, 1);
+    XCTAssertEqualWithAccuracy(self.mockDelegate.lastStallDuration, 1.2, 0.0001);
+
+    [self pollTracker:tracker times:2];
+    XCTAssertEqual(self.mockDelegate.stallCount, 1);
+    XCTAssertEqual(self.mockDelegate.hangCount, 1);
+
+    // It became a hang, so it ends with recovery rather than a stall end.
+    [tracker handleMainQueuePong];
+    XCTAssertEqual(self.mockDelegate.recoverCount, 1);
+    XCTAssertEqual(self.mockDelegate.stallEndCount, 0);
+}
+
+- (void)testStall_PingModeEndsWithoutHang
+{
+    BugSplatHangTracker *tracker = [self trackerWithThreshold:2.0 debuggerAttached:NO appActive:YES];
+    tracker.stallThresholdSeconds = 1.0;
+
+    [self pollTracker:tracker times:3];
+    [tracker handleMainQueuePong];
+    XCTAssertEqual(self.mockDelegate.stallEndCount, 1);
+    XCTAssertEqual(self.mockDelegate.recoverCount, 0);
+
+    [tracker handleMainQueuePong];
+    XCTAssertEqual(self.mockDelegate.stallEndCount, 1, @"Only a reported stall ends");
+}
+
+- (void)testStall_DisabledByDefault
+{
+    BugSplatHangTracker *tracker = [self trackerWithThreshold:2.0 debuggerAttached:NO appActive:YES];
+    [self pollTracker:tracker times:5];
+    [tracker handleMainQueuePong];
+    XCTAssertEqual(self.mockDelegate.stallCount, 0);
+    XCTAssertEqual(self.mockDelegate.stallEndCount, 0);
+}
+
+- (void)testStall_HeartbeatModeWakesAtStallThreshold
+{
+    BugSplatHangTracker *tracker = [self trackerWithThreshold:2.0 debuggerAttached:NO appActive:YES];
+    tracker.stallThresholdSeconds = 1.0;
+    [tracker recordHeartbeat:100 * kSecond];
+
+    NSTimeInterval sleep = [self checkHeartbeatOf:tracker at:100 * kSecond + kSecond / 4];
+    XCTAssertEqualWithAccuracy(sleep, 0.75, 0.0001, @"Next check is when the stall threshold is reached");
+
+    sleep = [self checkHeartbeatOf:tracker at:101 * kSecond];
+    XCTAssertEqual(self.mockDelegate.stallCount, 1);
+    XCTAssertEqualWithAccuracy(self.mockDelegate.lastStallDuration, 1.0, 0.000001);
+    XCTAssertEqualWithAccuracy(sleep, 0.4, 0.0001, @"Polls while the stall is in progress");
+
+    [tracker recordHeartbeat:101 * kSecond + kSecond / 2];
+    [self checkHeartbeatOf:tracker at:101 * kSecond + kSecond / 2 + 1];
+    XCTAssertEqual(self.mockDelegate.stallEndCount, 1);
+    XCTAssertEqual(self.mockDelegate.hangCount, 0);
+}
+
+#pragma mark - Adaptive polling
+
+- (void)testAdaptive_QuickPongsBackOffToHalfThreshold
+{
+    BugSplatHangTracker *tracker = [self trackerWithThreshold:2.0 debuggerAttached:NO appActive:YES];
+    [tracker sendPingIfNeeded:^{}];
+    [tracker handleMainQueuePong];
+
+    XCTAssertEqualWithAccuracy([tracker _nextPollIntervalAfter:0.4], 0.8, 0.0001);
+    XCTAssertEqualWithAccuracy([tracker _nextPollIntervalAfter:0.8], 1.0, 0.0001);
+    XCTAssertEqualWithAccuracy([tracker _nextPollIntervalAfter:1.0], 1.0, 0.0001);
+}
+
+- (void)testAdaptive_QueuedPingReturnsToBaseInterval
+{
+    BugSplatHangTracker *tracker = [self trackerWithThreshold:2.0 debuggerAttached:NO appActive:YES];
+    [tracker sendPingIfNeeded:^{}];
+    XCTAssertEqualWithAccuracy([tracker _nextPollIntervalAfter:1.0], 0.4, 0.0001);
+}
+
+- (void)testAdaptive_SlowPongHalvesTowardBaseInterval
+{
+    BugSplatHangTracker *tracker = [self trackerWithThreshold:2.0 debuggerAttached:NO appActive:YES];
+    [tracker sendPingIfNeeded:^{}];
+    [NSThread sleepForTimeInterval:0.15];
+    [tracker handleMainQueuePong];
+
+    XCTAssertEqualWithAccuracy([tracker _nextPollIntervalAfter:1.0], 0.5, 0.0001);
+    XCTAssertEqualWithAccuracy([tracker _nextPollIntervalAfter:0.5], 0.4, 0.0001);
+}
+
+- (void)testAdaptive_StallThresholdCapsBackoff
+{
+    BugSplatHangTracker *tracker = [self trackerWithThreshold:2.0 debuggerAttached:NO appActive:YES];
+    tracker.stallThresholdSeconds = 1.0;
+    [tracker sendPingIfNeeded:^{}];
+    [tracker handleMainQueuePong];
+    XCTAssertEqualWithAccuracy([tracker _nextPollIntervalAfter:0.4], 0.5, 0.0001);
+}
+
+- (void)testAdaptive_InactiveAppParks
+{
+    BugSplatHangTracker *tracker = [self trackerWithThreshold:2.0 debuggerAttached:NO appActive:NO];
+    XCTAssertLessThan([tracker _nextPollIntervalAfter:0.4], 0);
+}
+
+- (void)testAdaptive_DisabledKeepsFixedInterval
+{
+    BugSplatHangTracker *tracker = [self trackerWithThreshold:2.0 debuggerAttached:NO appActive:NO];
+    tracker.adaptivePolling = NO;
+    [tracker sendPingIfNeeded:^{}];
+    [tracker handleMainQueuePong];
+    XCTAssertEqualWithAccuracy([tracker _nextPollIntervalAfter:0.4], 0.4, 0.0001);
+}
+
+- (void)testAdaptive_AnsweredPingAddsNoUnresponsiveTime
+{
+    BugSplatHangTracker *tracker = [self trackerWithThreshold:2.0 debuggerAttached:NO appActive:YES];
+    // Long backed-off sleeps during which main answered every ping.
+    for (NSInteger i = 0; i < 3; i++) {
+        [tracker sendPingIfNeeded:^{}];
+        [tracker handleMainQueuePong];
+        [tracker _processPollWithActualSleepDuration:1.0];
+    }
+    // Main hangs right after the last answer: the full threshold still has to pass.
+    [self pollTracker:tracker times:4];
+    XCTAssertEqual(self.mockDelegate.hangCount, 0);
+    [self pollTracker:tracker times:1];
+    XCTAssertEqual(self.mockDelegate.hangCount, 1);
+    XCTAssertEqualWithAccuracy(self.mockDelegate.lastDuration, 2.0, 0.0001);
+}
+
+- (void)testAdaptive_ParkedWatchdogResumesOnWake
+{
+    __block BOOL appActive = NO;
+    BugSplatHangTracker *tracker = [[BugSplatHangTracker alloc] initWithThresholdSeconds:0.5
+                                                                                delegate:self.mockDelegate
+                                                                  isDebuggerAttachedBlock:nil
+                                                                        isAppActiveBlock:^BOOL { return appActive; }];
+    [tracker start];
+    [[NSRunLoop mainRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.6]];
+    XCTAssertEqual(tracker.pollCount, 1u, @"Parks after the first poll finds the app inactive");
+
+    appActive = YES;
+    [tracker wake];
+    [[NSRunLoop mainRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.3]];
+    XCTAssertGreaterThan(tracker.pollCount, 1u);
+    [tracker stop];
+}
+
+#pragma mark - Periodic work
+
+- (void)testPeriodicWork_RunsOnWatchdogThreadAtMostOncePerInterval
+{
+    __block NSUInteger runs = 0;
+    __block BOOL ranOnMainThread = NO;
+    BugSplatHangTracker *tracker = [[BugSplatHangTracker alloc] initWithThresholdSeconds:0.5
+                                                                                delegate:self.mockDelegate
+                                                                  isDebuggerAttachedBlock:nil
+                                                                        isAppActiveBlock:nil];
+    tracker.adaptivePolling = NO;
+    tracker.periodicWorkInterval = 0.25;
+    tracker.periodicWork = ^{
+        @synchronized (self) {
+            runs++;
+            ranOnMainThread = ranOnMainThread || [NSThread isMainThread];
+        }
+    };
+    [tracker start];
+    [[NSRunLoop mainRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:1.1]];
+    [tracker stop];
+
+    @synchronized (self) {
+        // Polls every 0.1 s: runs on the first poll, then on the first poll at least 0.25 s later.
+        XCTAssertGreaterThanOrEqual(runs, 2u);
+        XCTAssertLessThanOrEqual(runs, 5u);
+        XCTAssertLessThan(runs, tracker.pollCount);
+        XCTAssertFalse(ranOnMainThread);
+    }
+}
+
 #pragma mark - Start / stop wiring (smoke)
 
 - (void)testStart_SetsRunning
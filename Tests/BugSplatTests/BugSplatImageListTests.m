@@ -0,0 +1,106 @@
+//
+//  BugSplatImageListTests.m
+//  BugSplatTests
+//
+//  Tests for the async-safe image list: attributing addresses to images and
+//  symbols without dladdr, and the UUID form used in reports and profiles.
+//
+//  Copyright © BugSplat, LLC. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+#import <dlfcn.h>
+#import <pthread.h>
+#if __has_include(<ptrauth.h>)
+#import <ptrauth.h>
+#endif
+
+#import "BugSplatImageList.h"
+
+/// Address of a function in this test bundle.
+static void BugSplatImageListTestFunction(void) {}
+
+static uint64_t BugSplatImageListTestAddress(void (*function)(void))
+{
+#if __has_feature(ptrauth_calls)
+    return (uint64_t)(uintptr_t)ptrauth_strip((void *)function, ptrauth_key_function_pointer);
+#else
+    return (uint64_t)(uintptr_t)function;
+#endif
+}
+
+@interface BugSplatImageListTests : XCTestCase
+@end
+
+@implementation BugSplatImageListTests
+
+- (void)setUp
+{
+    [super setUp];
+    BugSplatImageListInstall();
+}
+
+#pragma mark - Lookup
+
+- (void)testFindAddress_MatchesDladdr
+{
+    uint64_t address = BugSplatImageListTestAddress(BugSplatImageListTestFunction);
+    BugSplatImage image;
+    XCTAssertTrue(BugSplatImageListFindAddress(address, &image));
+
+    Dl_info info;
+    XCTAssertTrue(dladdr((const void *)(uintptr_t)address, &info));
+    XCTAssertEqual(image.base, (uint64_t)(uintptr_t)info.dli_fbase);
+    XCTAssertEqualObjects(@(image.path), @(info.dli_fname));
+    XCTAssertEqualObjects(@(image.name), @(info.dli_fname).lastPathComponent);
+    XCTAssertTrue(image.hasUUID);
+    XCTAssertNotEqual(strcmp(BugSplatImageArchitectureName(&image), "???"), 0);
+}
+
+- (void)testFindAddress_UnmappedAddressIsNotFound
+{
+    BugSplatImage image;
+    XCTAssertFalse(BugSplatImageListFindAddress(0x10, &image));
+}
+
+- (void)testFindSymbol_FindsExportedSystemSymbol
+{
+    uint64_t address = BugSplatImageListTestAddress((void (*)(void))pthread_mutex_lock);
+    BugSplatImage image;
+    XCTAssertTrue(BugSplatImageListFindAddress(address + 4, &image));
+
+    uint64_t symbolAddress = 0;
+    const char *symbol = BugSplatImageFindSymbol(&image, address + 4, &symbolAddress);
+    XCTAssertEqualObjects(symbol ? @(symbol) : nil, @"pthread_mutex_lock");
+    XCTAssertEqual(symbolAddress, address);
+}
+
+- (void)testFindUUID_FindsTheSameImage
+{
+    BugSplatImage image;
+    XCTAssertTrue(BugSplatImageListFindAddress(BugSplatImageListTestAddress(BugSplatImageListTestFunction), &image));
+
+    BugSplatImage byUUID;
+    XCTAssertTrue(BugSplatImageListFindUUID(image.uuid, &byUUID));
+    XCTAssertEqual(byUUID.base, image.base);
+
+    uint8_t unknown[16] = { 0 };
+    XCTAssertFalse(BugSplatImageListFindUUID(unknown, &byUUID));
+}
+
+#pragma mark - UUIDs
+
+- (void)testUUID_FormatsAndParses
+{
+    uint8_t uuid[16];
+    XCTAssertTrue(BugSplatImageParseUUID("01234567-89AB-CDEF-0123-456789abcdef", uuid));
+    char text[BugSplatImageUUIDStringLength];
+    BugSplatImageFormatUUID(uuid, text);
+    XCTAssertEqualObjects(@(text), @"0123456789abcdef0123456789abcdef");
+
+    XCTAssertFalse(BugSplatImageParseUUID("0123", uuid));
+    XCTAssertFalse(BugSplatImageParseUUID("0123456789abcdef0123456789abcdef00", uuid));
+    XCTAssertFalse(BugSplatImageParseUUID("0123456789abcdef0123456789abcdeg", uuid));
+}
+
+@end
@@ -0,0 +1,222 @@
+//
+//  BugSplatLatencyHistogramTests.m
+//  BugSplatTests
+//
+//  Tests for the main-thread latency histogram: bucketing and percentiles,
+//  the mapped file that carries it across a crash, the hang tracker feeding
+//  it, and the attributes BugSplat reports from it.
+//
+//  Copyright © BugSplat, LLC. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+
+#import <BugSplat/BugSplat.h>
+#import "BugSplat+Testing.h"
+#import "BugSplatHangTracker.h"
+#import "BugSplatLatencyHistogram.h"
+#import "BugSplatLatencyHistogramFile.h"
+
+@interface BugSplatHangTracker (LatencyTesting)
+- (instancetype)initWithThresholdSeconds:(NSTimeInterval)thresholdSeconds
+                                 delegate:(id<BugSplatHangTrackerDelegate>)delegate
+                   isDebuggerAttachedBlock:(BOOL(^)(void))isDebuggerAttachedBlock
+                         isAppActiveBlock:(BOOL(^)(void))isAppActiveBlock
+                                clockBlock:(CFAbsoluteTime(^)(void))clockBlock
+                       recoveryDispatcher:(void(^)(dispatch_block_t))recoveryDispatcher
+                            pingDispatcher:(void(^)(dispatch_block_t))pingDispatcher;
+- (void)sendPingIfNeeded:(dispatch_block_t)ping;
+- (void)handleMainQueuePong;
+@end
+
+@interface BugSplatLatencyHistogramTests : XCTestCase <BugSplatHangTrackerDelegate>
+@property (nonatomic, strong) NSMutableData *storage;
+@property (nonatomic, copy) NSString *filePath;
+@property (nonatomic, strong, nullable) BugSplat *bugSplat;
+@end
+
+@implementation BugSplatLatencyHistogramTests
+
+- (void)setUp
+{
+    [super setUp];
+    self.storage = [NSMutableData dataWithLength:sizeof(BugSplatLatencyHistogram)];
+    BugSplatLatencyHistogramInit(self.histogram);
+    self.filePath = [NSTemporaryDirectory() stringByAppendingPathComponent:
+                     [NSString stringWithFormat:@"BugSplatLatency-%@", [NSUUID UUID].UUIDString]];
+}
+
+- (void)tearDown
+{
+    [[NSFileManager defaultManager] removeItemAtPath:self.filePath error:nil];
+    if (self.bugSplat) {
+        [[NSFileManager defaultManager] removeItemAtPath:[self.bugSplat latencyHistogramPath] error:nil];
+    }
+    self.bugSplat = nil;
+    [super tearDown];
+}
+
+- (BugSplatLatencyHistogram *)histogram
+{
+    return self.storage.mutableBytes;
+}
+
+- (void)hangTracker:(BugSplatHangTracker *)tracker didDetectHangWithDuration:(NSTimeInterval)duration appState:(NSString *)appState
+{
+}
+
+- (void)hangTrackerDidRecoverFromHang:(BugSplatHangTracker *)tracker
+{
+}
+
+#pragma mark - Buckets
+
+- (void)testSmallValues_AreExact
+{
+    for (uint64_t value = 0; value < 128; value++) {
+        XCTAssertEqual(BugSplatLatencyHistogramBucketUpperBound(BugSplatLatencyHistogramBucketIndex(value)), value);
+    }
+}
+
+- (void)testBuckets_CoverEveryValueWithBoundedError
+{
+    size_t previous = 0;
+    for (uint64_t value = 1; value <= BugSplatLatencyHistogramMaxValue; value += value / 50 + 1) {
+        size_t index = BugSplatLatencyHistogramBucketIndex(value);
+        XCTAssertGreaterThanOrEqual(index, previous, @"Buckets are ordered");
+        XCTAssertLessThan(index, (size_t)BugSplatLatencyHistogramBucketCount);
+        uint64_t upper = BugSplatLatencyHistogramBucketUpperBound(index);
+        XCTAssertGreaterThanOrEqual(upper, value);
+        XCTAssertLessThanOrEqual((double)(upper - value), (double)value / 64.0 + 1.0);
+        previous = index;
+    }
+    XCTAssertEqual(BugSplatLatencyHistogramBucketIndex(UINT64_MAX), (size_t)BugSplatLatencyHistogramBucketCount - 1,
+                   @"Values past the maximum land in the last bucket");
+}
+
+#pragma mark - Percentiles
+
+- (void)testEmptyHistogram_ReportsZero
+{
+    XCTAssertEqual(BugSplatLatencyHistogramValueAtPercentile(self.histogram, 50), 0u);
+    XCTAssertEqual(BugSplatLatencyHistogramValueAtPercentile(self.histogram, 100), 0u);
+}
+
+- (void)testPercentiles_OfUniformMilliseconds
+{
+    for (uint64_t ms = 1; ms <= 100; ms++) {
+        BugSplatLatencyHistogramRecord(self.histogram, ms * 1000);
+    }
+    XCTAssertEqual(atomic_load(&self.histogram->count), 100u);
+    XCTAssertEqualWithAccuracy((double)BugSplatLatencyHistogramValueAtPercentile(self.histogram, 50), 50000, 50000 / 64.0);
+    XCTAssertEqualWithAccuracy((double)BugSplatLatencyHistogramValueAtPercentile(self.histogram, 99), 99000, 99000 / 64.0);
+    XCTAssertEqual(BugSplatLatencyHistogramValueAtPercentile(self.histogram, 100), 100000u, @"Max is exact");
+    XCTAssertEqualWithAccuracy((double)BugSplatLatencyHistogramValueAtPercentile(self.histogram, 0), 1000, 1000 / 64.0);
+}
+
+- (void)testPercentile_NeverExceedsMax
+{
+    BugSplatLatencyHistogramRecord(self.histogram, 1000);
+    XCTAssertEqual(BugSplatLatencyHistogramValueAtPercentile(self.histogram, 99.9), 1000u);
+}
+
+- (void)testOneOutlier_ShowsOnlyInTail
+{
+    for (int i = 0; i < 999; i++) {
+        BugSplatLatencyHistogramRecord(self.histogram, 2000);
+    }
+    BugSplatLatencyHistogramRecord(self.histogram, 5000000);
+    XCTAssertLessThan(BugSplatLatencyHistogramValueAtPercentile(self.histogram, 99), 2100u);
+    XCTAssertEqual(BugSplatLatencyHistogramValueAtPercentile(self.histogram, 100), 5000000u);
+}
+
+#pragma mark - File
+
+- (void)testFile_KeepsValuesAcrossReopenUntilReset
+{
+    @autoreleasepool {
+        BugSplatLatencyHistogramFile *file = [[BugSplatLatencyHistogramFile alloc] initWithPath:self.filePath];
+        XCTAssertNotNil(file);
+        XCTAssertEqual(file.count, 0u);
+        BugSplatLatencyHistogramRecord(file.histogram, 1500);
+        file = nil;
+    }
+
+    BugSplatLatencyHistogramFile *reopened = [[BugSplatLatencyHistogramFile alloc] initWithPath:self.filePath];
+    XCTAssertEqual(reopened.count, 1u);
+    XCTAssertEqual([reopened valueAtPercentile:100], 1500u);
+
+    [reopened reset];
+    XCTAssertEqual(reopened.count, 0u);
+}
+
+- (void)testFile_ReplacesForeignContents
+{
+    [[@"not a histogram" dataUsingEncoding:NSUTF8StringEncoding] writeToFile:self.filePath atomically:YES];
+    BugSplatLatencyHistogramFile *file = [[BugSplatLatencyHistogramFile alloc] initWithPath:self.filePath];
+    XCTAssertTrue(BugSplatLatencyHistogramIsValid(file.histogram));
+    XCTAssertEqual(file.count, 0u);
+}
+
+#pragma mark - Hang tracker
+
+- (void)testTracker_RecordsPingRoundTrips
+{
+    BugSplatHangTracker *tracker = [[BugSplatHangTracker alloc] initWithThresholdSeconds:2.0
+                                                                                delegate:self
+                                                                  isDebuggerAttachedBlock:nil
+                                                                        isAppActiveBlock:nil
+                                                                               clockBlock:nil
+                                                                      recoveryDispatcher:^(dispatch_block_t b) { b(); }
+                                                                           pingDispatcher:^(dispatch_block_t b) { /* delivered by hand */ }];
+    tracker.latencyHistogram = self.histogram;
+
+    [tracker sendPingIfNeeded:^{}];
+    [NSThread sleepForTimeInterval:0.02];
+    [tracker handleMainQueuePong];
+    XCTAssertEqual(atomic_load(&self.histogram->count), 1u);
+    XCTAssertGreaterThanOrEqual(BugSplatLatencyHistogramValueAtPercentile(self.histogram, 100), 20000u);
+
+    [tracker handleMainQueuePong];
+    XCTAssertEqual(atomic_load(&self.histogram->count), 1u, @"A pong without an outstanding ping records nothing");
+}
+
+#pragma mark - BugSplat integration
+
+- (void)testPreviousSession_SummaryBecomesReportAttributes
+{
+    self.bugSplat = [[BugSplat alloc] init];
+    self.bugSplat.enableHangDetection = YES;
+    self.bugSplat.enableLatencyHistogram = YES;
+
+    @autoreleasepool {
+        BugSplatLatencyHistogramFile *previous = [[BugSplatLatencyHistogramFile alloc] initWithPath:[self.bugSplat latencyHistogramPath]];
+        [previous reset];
+        for (uint64_t ms = 1; ms <= 100; ms++) {
+            BugSplatLatencyHistogramRecord(previous.histogram, ms * 1000);
+        }
+    }
+
+    [self.bugSplat openLatencyHistogram];
+    NSDictionary<NSString *, NSString *> *attributes = [self.bugSplat previousSessionLatencyAttributes];
+    XCTAssertEqualObjects(attributes[@"bugsplat-latency-count"], @"100");
+    XCTAssertEqualObjects(attributes[@"bugsplat-latency-max-ms"], @"100.0");
+    XCTAssertEqualWithAccuracy(attributes[@"bugsplat-latency-p50-ms"].doubleValue, 50.0, 1.0);
+    XCTAssertEqualWithAccuracy(attributes[@"bugsplat-latency-p99-ms"].doubleValue, 99.0, 2.0);
+
+    XCTAssertEqual(self.bugSplat.mainThreadLatencySampleCount, 0u, @"This session starts empty");
+    BugSplatLatencyHistogramRecord([self.bugSplat latencyHistogramFile].histogram, 250000);
+    XCTAssertEqual(self.bugSplat.mainThreadLatencySampleCount, 1u);
+    XCTAssertEqualWithAccuracy([self.bugSplat mainThreadLatencyAtPercentile:100], 0.25, 0.000001);
+}
+
+- (void)testDisabled_OpensNothing
+{
+    self.bugSplat = [[BugSplat alloc] init];
+    self.bugSplat.enableHangDetection = YES;
+    [self.bugSplat openLatencyHistogram];
+    XCTAssertNil([self.bugSplat latencyHistogramFile]);
+    XCTAssertEqual([self.bugSplat mainThreadLatencyAtPercentile:50], 0.0);
+}
+
+@end
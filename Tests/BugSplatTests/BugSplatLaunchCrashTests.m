@@ -0,0 +1,243 @@
+//
+//  BugSplatLaunchCrashTests.m
+//  BugSplatTests
+//
+//  Tests for launch crash safe mode: counting launches that crash within the launch
+//  crash window, and uploading the newest report before `-start` returns once they
+//  repeat. The pending report is a real PLCrashReporter live report served through
+//  MockCrashReporter; uploads go to a MockURLSession.
+//
+//  Copyright © BugSplat, LLC. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+#import <CrashReporter/CrashReporter.h>
+
+#import <BugSplat/BugSplat.h>
+#import "BugSplat+Testing.h"
+#import "BugSplatCrashFilesTestCase.h"
+#import "BugSplatMetadataCodec.h"
+#import "MockCrashReporter.h"
+#import "MockCrashStorage.h"
+#import "MockUserDefaults.h"
+#import "MockBundle.h"
+#import "MockURLSession.h"
+
+/// Delegate that records whether persisting a crash called back into the app.
+@interface LaunchCrashRecordingDelegate : NSObject <BugSplatDelegate>
+@property (atomic, assign) BOOL attachmentRequested;
+@property (atomic, assign) BOOL applicationLogRequested;
+@end
+
+@implementation LaunchCrashRecordingDelegate
+
+- (BugSplatAttachment *)attachmentForBugSplat:(BugSplat *)bugSplat
+{
+    self.attachmentRequested = YES;
+    return [[BugSplatAttachment alloc] initWithFilename:@"app.txt"
+                                         attachmentData:[@"app" dataUsingEncoding:NSUTF8StringEncoding]
+                                            contentType:@"text/plain"];
+}
+
+- (NSString *)applicationLogForBugSplat:(BugSplat *)bugSplat
+{
+    self.applicationLogRequested = YES;
+    return @"log";
+}
+
+@end
+
+@interface BugSplatLaunchCrashTests : BugSplatCrashFilesTestCase
+@property (nonatomic, strong) BugSplat *bugSplat;
+@property (nonatomic, strong) MockCrashReporter *mockCrashReporter;
+@property (nonatomic, strong) MockURLSession *session;
+@property (nonatomic, strong) LaunchCrashRecordingDelegate *recordingDelegate;
+@end
+
+@implementation BugSplatLaunchCrashTests
+
+- (void)setUp
+{
+    [super setUp];
+
+    self.mockCrashReporter = [[MockCrashReporter alloc] init];
+    MockBundle *bundle = [[MockBundle alloc] init];
+    [bundle setObject:@"LaunchCrashApp" forInfoDictionaryKey:@"CFBundleName"];
+    [bundle setObject:@"1.0.0" forInfoDictionaryKey:@"CFBundleShortVersionString"];
+    [bundle setObject:@"launchcrashdb" forInfoDictionaryKey:@"BugSplatDatabase"];
+
+    self.bugSplat = [BugSplat testInstanceWithCrashReporter:self.mockCrashReporter
+                                               crashStorage:[[MockCrashStorage alloc] init]
+                                               userDefaults:[[MockUserDefaults alloc] init]
+                                                     bundle:bundle];
+    [self.bugSplat setDebuggerAttachedOverride:@NO];
+    self.bugSplat.autoSubmitCrashReport = NO;
+    self.bugSplat.enableLaunchCrashSafeMode = YES;
+    // Keep this launch's marker in place for the whole test
+    self.bugSplat.launchCrashWindow = 600.0;
+
+    self.session = [[MockURLSession alloc] init];
+    [self.bugSplat setUploadServiceForTesting:[[BugSplatUploadService alloc] initWithDatabase:@"launchcrashdb"
+                                                                              applicationName:@"LaunchCrashApp"
+                                                                           applicationVersion:@"1.0.0"
+                                                                                   urlSession:self.session]];
+
+    self.recordingDelegate = [[LaunchCrashRecordingDelegate alloc] init];
+    self.bugSplat.delegate = self.recordingDelegate;
+
+    [self snapshotCrashFilesOfBugSplat:self.bugSplat];
+    [[NSFileManager defaultManager] removeItemAtPath:[self.bugSplat launchCrashMarkerPath] error:nil];
+}
+
+- (void)tearDown
+{
+    [[NSFileManager defaultManager] removeItemAtPath:[self.bugSplat launchCrashMarkerPath] error:nil];
+    self.bugSplat = nil;
+    [super tearDown];
+}
+
+#pragma mark - Helpers
+
+- (void)givenPendingLiveReport
+{
+    PLCrashReporter *reporter = [[PLCrashReporter alloc] initWithConfiguration:[PLCrashReporterConfig defaultConfiguration]];
+    NSError *error = nil;
+    NSData *report = [reporter generateLiveReportAndReturnError:&error];
+    XCTAssertNotNil(report, @"Failed to generate live report: %@", error);
+
+    self.mockCrashReporter.hasPendingReport = YES;
+    self.mockCrashReporter.pendingCrashReportData = report;
+}
+
+/// The marker the previous launch left if it ended within the window after `count` launch crashes in a row.
+- (void)givenPreviousLaunchMarkerWithCount:(NSUInteger)count
+{
+    NSString *contents = [NSString stringWithFormat:@"%lu", (unsigned long)count];
+    XCTAssertTrue([contents writeToFile:[self.bugSplat launchCrashMarkerPath] atomically:YES encoding:NSUTF8StringEncoding error:nil]);
+}
+
+- (NSString *)markerContents
+{
+    return [NSString stringWithContentsOfFile:[self.bugSplat launchCrashMarkerPath] encoding:NSUTF8StringEncoding error:nil];
+}
+
+- (void)givenSuccessfulUpload
+{
+    NSData *presignedData = [NSJSONSerialization dataWithJSONObject:@{@"url": @"https://s3.amazonaws.com/bucket/key"} options:0 error:nil];
+    [self.session queueResponseWithData:presignedData
+                               response:[MockURLSession jsonResponseWithStatusCode:200]
+                                  error:nil];
+    [self.session queueResponseWithData:nil
+                               response:[MockURLSession responseWithStatusCode:200]
+                                  error:nil];
+    [self.session queueResponseWithData:[@"{}" dataUsingEncoding:NSUTF8StringEncoding]
+                               response:[MockURLSession jsonResponseWithStatusCode:200]
+                                  error:nil];
+}
+
+#pragma mark - Detection
+
+- (void)testDetection_CountsLaunchesThatCrashedWithinWindow
+{
+    [self givenPreviousLaunchMarkerWithCount:0];
+    [self givenPendingLiveReport];
+    [self.bugSplat beginLaunchCrashDetection];
+
+    XCTAssertEqual([self.bugSplat launchCrashCount], 1u);
+    XCTAssertFalse(self.bugSplat.isInLaunchCrashSafeMode, @"One launch crash is not a loop");
+    XCTAssertEqualObjects([self markerContents], @"1");
+}
+
+- (void)testDetection_ResetsWhenPreviousLaunchDidNotCrash
+{
+    [self givenPreviousLaunchMarkerWithCount:3];
+    [self.bugSplat beginLaunchCrashDetection];
+
+    XCTAssertEqual([self.bugSplat launchCrashCount], 0u);
+    XCTAssertFalse(self.bugSplat.isInLaunchCrashSafeMode);
+    XCTAssertEqualObjects([self markerContents], @"0");
+}
+
+- (void)testDetection_IgnoresCrashAfterWindow
+{
+    // No marker: the previous launch lived through the window before crashing
+    [self givenPendingLiveReport];
+    [self.bugSplat beginLaunchCrashDetection];
+
+    XCTAssertEqual([self.bugSplat launchCrashCount], 0u);
+    XCTAssertFalse(self.bugSplat.isInLaunchCrashSafeMode);
+}
+
+- (void)testDetection_RemovesMarkerOnceWindowPasses
+{
+    self.bugSplat.launchCrashWindow = 0.1;
+    [self.bugSplat beginLaunchCrashDetection];
+    XCTAssertNotNil([self markerContents]);
+
+    NSDate *deadline = [NSDate dateWithTimeIntervalSinceNow:5.0];
+    while ([self markerContents] && deadline.timeIntervalSinceNow > 0) {
+        [NSThread sleepForTimeInterval:0.05];
+    }
+    XCTAssertNil([self markerContents]);
+}
+
+#pragma mark - Safe Mode
+
+- (void)testCrashLoop_UploadsNewestReportBeforeStartReturns
+{
+    [self givenPreviousLaunchMarkerWithCount:1];
+    [self givenPendingLiveReport];
+    [self givenSuccessfulUpload];
+    self.bugSplat.startAsynchronously = YES;
+
+    [self.bugSplat start];
+
+    XCTAssertTrue(self.bugSplat.isInLaunchCrashSafeMode);
+    XCTAssertEqual([self.bugSplat launchCrashCount], 2u);
+    XCTAssertTrue(self.mockCrashReporter.wasPurged);
+    XCTAssertTrue(self.mockCrashReporter.wasEnabled);
+    XCTAssertEqual(self.session.requestCount, 3u, @"Uploaded synchronously");
+    XCTAssertEqual([self newCrashFiles].count, 0u, @"Removed from the queue once uploaded");
+    XCTAssertFalse(self.recordingDelegate.attachmentRequested);
+    XCTAssertFalse(self.recordingDelegate.applicationLogRequested);
+
+    NSString *commitBody = [[NSString alloc] initWithData:self.session.recordedRequests[2].request.HTTPBody encoding:NSUTF8StringEncoding];
+    XCTAssertTrue([commitBody containsString:@"bugsplat-launch-crash-count"]);
+}
+
+- (void)testCrashLoop_FailedUploadStaysQueuedForSilentRetry
+{
+    [self givenPreviousLaunchMarkerWithCount:1];
+    [self givenPendingLiveReport];
+    self.session.nextError = [NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorNotConnectedToInternet userInfo:nil];
+
+    [self.bugSplat start];
+
+    NSString *crashFilename = [self.bugSplat currentCrashFilename];
+    XCTAssertNotNil(crashFilename);
+    NSString *basePath = [[self.bugSplat crashesDirectoryPath] stringByAppendingPathComponent:crashFilename];
+    NSDictionary *metadata = [BugSplatMetadataCodec metadataWithContentsOfFile:[basePath stringByAppendingPathExtension:@"meta"]];
+    XCTAssertNotNil(metadata);
+    XCTAssertEqualObjects(metadata[@"attributes"][@"bugsplat-launch-crash-count"], @"2");
+    XCTAssertNil(metadata[@"applicationLog"]);
+    XCTAssertTrue([self.bugSplat shouldSendCrashSilently:metadata], @"Never shown in a dialog");
+    XCTAssertFalse([[NSFileManager defaultManager] fileExistsAtPath:[basePath stringByAppendingString:@"-0.data"]]);
+}
+
+- (void)testSafeMode_DisabledByDefault
+{
+    BugSplat *bugSplat = [[BugSplat alloc] init];
+    XCTAssertFalse(bugSplat.enableLaunchCrashSafeMode);
+    XCTAssertEqual(bugSplat.launchCrashWindow, 10.0);
+    XCTAssertEqual(bugSplat.launchCrashLoopThreshold, 2u);
+    XCTAssertEqual(bugSplat.launchCrashUploadTimeout, 5.0);
+
+    self.bugSplat.enableLaunchCrashSafeMode = NO;
+    [self givenPreviousLaunchMarkerWithCount:5];
+    [self givenPendingLiveReport];
+    [self.bugSplat beginLaunchCrashDetection];
+    XCTAssertFalse(self.bugSplat.isInLaunchCrashSafeMode);
+    XCTAssertEqualObjects([self markerContents], @"5", @"Left untouched");
+}
+
+@end
@@ -0,0 +1,328 @@
+//
+//  BugSplatLaunchStateTests.m
+//  BugSplatTests
+//
+//  Tests for termination detection: inferring how a launch ended from the
+//  state it recorded (including a recorded sentinel file), the mapped file
+//  the state lives in, and BugSplat queueing a report for a launch the
+//  system killed.
+//
+//  Copyright © BugSplat, LLC. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+
+#import <BugSplat/BugSplat.h>
+#import "BugSplat+Testing.h"
+#import "BugSplatCrashFilesTestCase.h"
+#import "BugSplatLaunchState.h"
+#import "BugSplatLaunchStateFile.h"
+#import "BugSplatMetadataCodec.h"
+
+/// Launch state recorded by a session killed in the foreground: app 2.4.1 (317) on 17.4.1 (21E236),
+/// launched at 1760000000 after a boot at 1759990000, active, critical memory pressure, 3 memory
+/// warnings, last footprint 1450 MB of 1536 MB (peak 1480 MB) sampled at 1760000312.
+static NSString *const kRecordedForegroundKill =
+    @"42534c53010000000078e76800000000f050e76800000000322e342e31202833"
+    @"31372900000000000000000000000000000000000000000031372e342e312028"
+    @"3231453233362900000000000000000000000000000000000000000001000000"
+    @"000000000000000002000000030000002c79e768000000000000a05a00000000"
+    @"00000060000000000000805c000000003879e76800000000";
+
+static const uint64_t kLaunchTime = 1760000000;
+static const uint64_t kBootTime = 1759990000;
+
+@interface BugSplatLaunchStateTests : BugSplatCrashFilesTestCase
+@property (nonatomic, copy) NSString *filePath;
+@property (nonatomic, strong, nullable) BugSplat *bugSplat;
+@end
+
+@implementation BugSplatLaunchStateTests
+
+- (void)setUp
+{
+    [super setUp];
+    self.filePath = [NSTemporaryDirectory() stringByAppendingPathComponent:
+                     [NSString stringWithFormat:@"BugSplatLaunchState-%@", [NSUUID UUID].UUIDString]];
+}
+
+- (void)tearDown
+{
+    [[NSFileManager defaultManager] removeItemAtPath:self.filePath error:nil];
+    if (self.bugSplat) {
+        [[NSFileManager defaultManager] removeItemAtPath:[self.bugSplat launchStatePath] error:nil];
+    }
+    self.bugSplat = nil;
+    [super tearDown];
+}
+
+#pragma mark - Helpers
+
+- (NSData *)dataWithHex:(NSString *)hex
+{
+    NSMutableData *data = [NSMutableData dataWithCapacity:hex.length / 2];
+    for (NSUInteger i = 0; i + 1 < hex.length; i += 2) {
+        uint8_t byte = (uint8_t)strtoul([hex substringWithRange:NSMakeRange(i, 2)].UTF8String, NULL, 16);
+        [data appendBytes:&byte length:1];
+    }
+    return data;
+}
+
+/// A launch of 1.0 on 17.0 that was active and is still running, as the next launch finds it.
+- (BugSplatLaunchState)runningState
+{
+    BugSplatLaunchState state;
+    BugSplatLaunchStateBegin(&state, "1.0 (1)", "17.0 (21A329)", kLaunchTime, kBootTime);
+    BugSplatLaunchStateSetAppState(&state, BugSplatLaunchAppStateActive, kLaunchTime + 1);
+    return state;
+}
+
+- (BugSplatLaunchContext)sameContext
+{
+    return (BugSplatLaunchContext){ "1.0 (1)", "17.0 (21A329)", kBootTime, false };
+}
+
+#pragma mark - Inference
+
+- (void)testInference_UnexplainedForegroundKillIsOutOfMemory
+{
+    BugSplatLaunchState state = [self runningState];
+    BugSplatLaunchContext context = [self sameContext];
+    XCTAssertEqual(BugSplatLaunchStateInferTermination(&state, &context), BugSplatTerminationOutOfMemory);
+
+    BugSplatLaunchStateSetAppState(&state, BugSplatLaunchAppStateInactive, kLaunchTime + 2);
+    XCTAssertEqual(BugSplatLaunchStateInferTermination(&state, &context), BugSplatTerminationOutOfMemory,
+                   @"Inactive is still in the foreground");
+    XCTAssertTrue(BugSplatTerminationIsReportable(BugSplatTerminationOutOfMemory));
+}
+
+- (void)testInference_BackgroundKillIsNotReportable
+{
+    BugSplatLaunchState state = [self runningState];
+    BugSplatLaunchStateSetAppState(&state, BugSplatLaunchAppStateBackground, kLaunchTime + 60);
+    BugSplatLaunchContext context = [self sameContext];
+
+    XCTAssertEqual(BugSplatLaunchStateInferTermination(&state, &context), BugSplatTerminationBackground);
+    XCTAssertFalse(BugSplatTerminationIsReportable(BugSplatTerminationBackground));
+}
+
+- (void)testInference_HungMainThreadIsWatchdogUnlessItsHangWasReported
+{
+    BugSplatLaunchState state = [self runningState];
+    BugSplatLaunchContext context = [self sameContext];
+
+    BugSplatLaunchStateSetHangState(&state, BugSplatLaunchHangUnreported);
+    XCTAssertEqual(BugSplatLaunchStateInferTermination(&state, &context), BugSplatTerminationWatchdog);
+
+    BugSplatLaunchStateSetAppState(&state, BugSplatLaunchAppStateBackground, kLaunchTime + 60);
+    XCTAssertEqual(BugSplatLaunchStateInferTermination(&state, &context), BugSplatTerminationWatchdog,
+                   @"A hung app is killed by the watchdog in the background too");
+
+    BugSplatLaunchStateSetHangState(&state, BugSplatLaunchHangReported);
+    XCTAssertEqual(BugSplatLaunchStateInferTermination(&state, &context), BugSplatTerminationReported);
+}
+
+- (void)testInference_ExplanationsWinInOrder
+{
+    BugSplatLaunchState state = [self runningState];
+    BugSplatLaunchStateSetHangState(&state, BugSplatLaunchHangUnreported);
+    BugSplatLaunchContext context = [self sameContext];
+
+    context.bootTime = kLaunchTime + 100;
+    XCTAssertEqual(BugSplatLaunchStateInferTermination(&state, &context), BugSplatTerminationReboot);
+
+    context.osVersion = "17.1 (21B74)";
+    XCTAssertEqual(BugSplatLaunchStateInferTermination(&state, &context), BugSplatTerminationOSUpdate);
+
+    context.appVersion = "1.1 (2)";
+    XCTAssertEqual(BugSplatLaunchStateInferTermination(&state, &context), BugSplatTerminationAppUpdate);
+
+    atomic_store(&state.debuggerAttached, 1);
+    XCTAssertEqual(BugSplatLaunchStateInferTermination(&state, &context), BugSplatTerminationDebugger);
+
+    context.crashReported = true;
+    XCTAssertEqual(BugSplatLaunchStateInferTermination(&state, &context), BugSplatTerminationReported);
+
+    BugSplatLaunchStateMarkCleanExit(&state);
+    XCTAssertEqual(BugSplatLaunchStateInferTermination(&state, &context), BugSplatTerminationCleanExit);
+}
+
+- (void)testInference_BootTimeDriftIsNotAReboot
+{
+    BugSplatLaunchState state = [self runningState];
+    BugSplatLaunchContext context = [self sameContext];
+    context.bootTime = kBootTime + 3;
+    XCTAssertEqual(BugSplatLaunchStateInferTermination(&state, &context), BugSplatTerminationOutOfMemory);
+}
+
+- (void)testInference_WithoutValidRecordIsUnknown
+{
+    BugSplatLaunchState state;
+    memset(&state, 0, sizeof(state));
+    BugSplatLaunchContext context = [self sameContext];
+    XCTAssertEqual(BugSplatLaunchStateInferTermination(&state, &context), BugSplatTerminationUnknown);
+    XCTAssertEqual(BugSplatLaunchStateInferTermination(NULL, &context), BugSplatTerminationUnknown);
+
+    state = [self runningState];
+    state.version = BugSplatLaunchStateVersion + 1;
+    XCTAssertEqual(BugSplatLaunchStateInferTermination(&state, &context), BugSplatTerminationUnknown);
+}
+
+- (void)testRecordedFixture_IsReadAndInferred
+{
+    NSData *fixture = [self dataWithHex:kRecordedForegroundKill];
+    XCTAssertEqual(fixture.length, sizeof(BugSplatLaunchState), @"Record layout changed; bump BugSplatLaunchStateVersion");
+
+    BugSplatLaunchState state;
+    memcpy(&state, fixture.bytes, sizeof(state));
+    XCTAssertTrue(BugSplatLaunchStateIsValid(&state));
+    XCTAssertEqualObjects(@(state.appVersion), @"2.4.1 (317)");
+    XCTAssertEqualObjects(@(state.osVersion), @"17.4.1 (21E236)");
+    XCTAssertEqual(atomic_load(&state.appState), (uint32_t)BugSplatLaunchAppStateActive);
+    XCTAssertEqual(atomic_load(&state.memoryPressure), (uint32_t)BugSplatLaunchMemoryPressureCritical);
+    XCTAssertEqual(atomic_load(&state.memoryWarnings), 3u);
+    XCTAssertEqual(atomic_load(&state.footprint), 1450ull * 1024 * 1024);
+    XCTAssertEqual(atomic_load(&state.footprintLimit), 1536ull * 1024 * 1024);
+    XCTAssertEqual(atomic_load(&state.peakFootprint), 1480ull * 1024 * 1024);
+
+    BugSplatLaunchContext context = { "2.4.1 (317)", "17.4.1 (21E236)", kBootTime, false };
+    XCTAssertEqual(BugSplatLaunchStateInferTermination(&state, &context), BugSplatTerminationOutOfMemory);
+    XCTAssertEqualObjects(@(BugSplatTerminationName(BugSplatTerminationOutOfMemory)), @"out-of-memory");
+}
+
+#pragma mark - Recording
+
+- (void)testRecording_FootprintRaisesPeakOnly
+{
+    BugSplatLaunchState state = [self runningState];
+    BugSplatLaunchStateRecordFootprint(&state, 500, 1000, kLaunchTime + 5);
+    BugSplatLaunchStateRecordFootprint(&state, 300, 1000, kLaunchTime + 10);
+
+    XCTAssertEqual(atomic_load(&state.footprint), 300u);
+    XCTAssertEqual(atomic_load(&state.peakFootprint), 500u);
+    XCTAssertEqual(atomic_load(&state.footprintSampledAt), kLaunchTime + 10);
+}
+
+- (void)testRecording_LongVersionsAreTruncated
+{
+    BugSplatLaunchState state;
+    BugSplatLaunchStateBegin(&state, "1.0.0-beta.12+build.2026.10.18.1234", NULL, kLaunchTime, kBootTime);
+    XCTAssertEqual(strlen(state.appVersion), (size_t)BugSplatLaunchStateVersionLength - 1);
+    XCTAssertEqual(strlen(state.osVersion), 0u);
+}
+
+- (void)testFile_KeepsPreviousRecordAndBeginsNew
+{
+    @autoreleasepool {
+        BugSplatLaunchStateFile *first = [[BugSplatLaunchStateFile alloc] initWithPath:self.filePath];
+        XCTAssertNotNil(first);
+        XCTAssertTrue(first.previousState == NULL, @"A new file has no previous launch");
+        [first beginLaunchWithAppVersion:@"1.0"];
+        [first recordMemoryFootprint];
+        BugSplatLaunchStateSetAppState(first.state, BugSplatLaunchAppStateBackground, [BugSplatLaunchStateFile now]);
+        XCTAssertGreaterThan(atomic_load(&first.state->footprint), 0u);
+    }
+
+    BugSplatLaunchStateFile *second = [[BugSplatLaunchStateFile alloc] initWithPath:self.filePath];
+    XCTAssertTrue(second.previousState != NULL);
+    XCTAssertEqualObjects(@(second.previousState->appVersion), @"1.0");
+    XCTAssertEqual(atomic_load(&second.previousState->appState), (uint32_t)BugSplatLaunchAppStateBackground);
+    XCTAssertEqual(atomic_load(&second.previousState->cleanExit), 0u, @"Closing the file is not an exit");
+
+    [second beginLaunchWithAppVersion:@"1.1"];
+    XCTAssertEqualObjects(@(second.state->appVersion), @"1.1");
+    XCTAssertEqual(atomic_load(&second.state->appState), (uint32_t)BugSplatLaunchAppStateUnknown);
+    XCTAssertEqualObjects(@(second.previousState->appVersion), @"1.0", @"The previous record is a copy");
+}
+
+#pragma mark - Termination Reports
+
+- (void)testTerminationReport_CarriesLastRecordedState
+{
+    self.bugSplat = [[BugSplat alloc] init];
+    [self snapshotCrashFilesOfBugSplat:self.bugSplat];
+
+    BugSplatLaunchState state;
+    memcpy(&state, [self dataWithHex:kRecordedForegroundKill].bytes, sizeof(state));
+    XCTAssertTrue([self.bugSplat queueTerminationReportForState:&state termination:BugSplatTerminationOutOfMemory]);
+
+    NSArray<NSString *> *files = [self newCrashFiles];
+    NSString *crashFile = [files filteredArrayUsingPredicate:[NSPredicate predicateWithFormat:@"SELF ENDSWITH '-termination.crash'"]].firstObject;
+    XCTAssertNotNil(crashFile);
+    NSString *basePath = [[self.bugSplat crashesDirectoryPath] stringByAppendingPathComponent:crashFile.stringByDeletingPathExtension];
+
+    NSString *text = [NSString stringWithContentsOfFile:[basePath stringByAppendingPathExtension:@"crash"] encoding:NSUTF8StringEncoding error:nil];
+    XCTAssertTrue([text hasPrefix:@"Out of Memory (Inferred)\n"]);
+    XCTAssertTrue([text containsString:@"1450.0 MB of 1536.0 MB (peak 1480.0 MB)"]);
+
+    NSDictionary *metadata = [BugSplatMetadataCodec metadataWithContentsOfFile:[basePath stringByAppendingPathExtension:@"meta"]];
+    NSDictionary *attributes = metadata[@"attributes"];
+    XCTAssertEqualObjects(attributes[@"bugsplat-termination-reason"], @"out-of-memory");
+    XCTAssertEqualObjects(attributes[@"bugsplat-termination-app-state"], @"active");
+    XCTAssertEqualObjects(attributes[@"bugsplat-termination-footprint-mb"], @"1450.0");
+    XCTAssertEqualObjects(attributes[@"bugsplat-termination-footprint-limit-mb"], @"1536.0");
+    XCTAssertEqualObjects(attributes[@"bugsplat-termination-memory-pressure"], @"critical");
+    XCTAssertEqualObjects(attributes[@"bugsplat-termination-memory-warnings"], @"3");
+    XCTAssertEqualObjects(attributes[@"bugsplat-termination-session-seconds"], @"312");
+    XCTAssertEqualObjects(metadata[@"userSubmitted"], @YES);
+}
+
+#if !TARGET_OS_OSX
+- (void)testOpenLaunchState_QueuesReportForKilledPreviousLaunchOnce
+{
+    self.bugSplat = [[BugSplat alloc] init];
+    self.bugSplat.enableTerminationDetection = YES;
+    [self snapshotCrashFilesOfBugSplat:self.bugSplat];
+
+    @autoreleasepool {
+        BugSplatLaunchStateFile *previous = [[BugSplatLaunchStateFile alloc] initWithPath:[self.bugSplat launchStatePath]];
+        [previous beginLaunchWithAppVersion:[self.bugSplat resolvedApplicationVersion]];
+        BugSplatLaunchStateSetAppState(previous.state, BugSplatLaunchAppStateActive, [BugSplatLaunchStateFile now]);
+        BugSplatLaunchStateSetHangState(previous.state, BugSplatLaunchHangUnreported);
+    }
+
+    [self.bugSplat openLaunchState];
+    XCTAssertNotNil([self.bugSplat launchStateFile]);
+    [self.bugSplat queuePreviousSessionTerminationReport];
+    [self.bugSplat queuePreviousSessionTerminationReport];
+
+    NSArray<NSString *> *reports = [[self newCrashFiles] filteredArrayUsingPredicate:
+                                    [NSPredicate predicateWithFormat:@"SELF ENDSWITH '-termination.crash'"]];
+    XCTAssertEqual(reports.count, 1u);
+    NSString *text = [NSString stringWithContentsOfFile:[[self.bugSplat crashesDirectoryPath] stringByAppendingPathComponent:reports.firstObject]
+                                               encoding:NSUTF8StringEncoding error:nil];
+    XCTAssertTrue([text hasPrefix:@"Watchdog Termination (Inferred)\n"]);
+
+    BugSplatLaunchState *current = [self.bugSplat launchStateFile].state;
+    XCTAssertTrue(BugSplatLaunchStateIsValid(current));
+    XCTAssertEqual(atomic_load(&current->hangState), (uint32_t)BugSplatLaunchHangNone);
+    XCTAssertGreaterThan(atomic_load(&current->footprint), 0u);
+}
+
+- (void)testOpenLaunchState_CleanExitQueuesNothing
+{
+    self.bugSplat = [[BugSplat alloc] init];
+    self.bugSplat.enableTerminationDetection = YES;
+    [self snapshotCrashFilesOfBugSplat:self.bugSplat];
+
+    @autoreleasepool {
+        BugSplatLaunchStateFile *previous = [[BugSplatLaunchStateFile alloc] initWithPath:[self.bugSplat launchStatePath]];
+        [previous beginLaunchWithAppVersion:[self.bugSplat resolvedApplicationVersion]];
+        BugSplatLaunchStateSetAppState(previous.state, BugSplatLaunchAppStateActive, [BugSplatLaunchStateFile now]);
+        BugSplatLaunchStateMarkCleanExit(previous.state);
+    }
+
+    [self.bugSplat openLaunchState];
+    [self.bugSplat queuePreviousSessionTerminationReport];
+    XCTAssertEqual([self newCrashFiles].count, 0u);
+}
+#endif
+
+- (void)testDisabled_OpensNothing
+{
+    self.bugSplat = [[BugSplat alloc] init];
+    [self.bugSplat openLaunchState];
+    XCTAssertNil([self.bugSplat launchStateFile]);
+}
+
+@end
@@ -0,0 +1,172 @@
+//
+//  BugSplatLaunchTimelineTests.m
+//  BugSplatTests
+//
+//  Tests for launch monitoring: the startup timeline and its text form, the
+//  process start time, and the slow launch report BugSplat queues when a
+//  launch ends over the threshold.
+//
+//  Copyright © BugSplat, LLC. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+
+#import <BugSplat/BugSplat.h>
+#import "BugSplat+Testing.h"
+#import "BugSplatCrashFilesTestCase.h"
+#import "BugSplatLaunchTimeline.h"
+#import "BugSplatMetadataCodec.h"
+
+@interface BugSplatLaunchTimelineTests : BugSplatCrashFilesTestCase
+@property (nonatomic, strong, nullable) BugSplat *bugSplat;
+@end
+
+@implementation BugSplatLaunchTimelineTests
+
+- (void)tearDown
+{
+    self.bugSplat = nil;
+    [super tearDown];
+}
+
+#pragma mark - Helpers
+
+/// A BugSplat monitoring a launch that started `elapsed` seconds ago and called -start 1 s in.
+- (BugSplat *)bugSplatWithLaunchStartedSecondsAgo:(NSTimeInterval)elapsed
+{
+    self.bugSplat = [[BugSplat alloc] init];
+    self.bugSplat.enableLaunchMonitoring = YES;
+    self.bugSplat.slowLaunchThreshold = 5.0;
+    [self snapshotCrashFilesOfBugSplat:self.bugSplat];
+
+    NSDate *processStart = [NSDate dateWithTimeIntervalSinceNow:-elapsed];
+    BugSplatLaunchTimeline *timeline = [[BugSplatLaunchTimeline alloc] initWithProcessStartDate:processStart];
+    [timeline recordMark:BugSplatLaunchMarkStart atDate:[processStart dateByAddingTimeInterval:1.0]];
+    [self.bugSplat beginLaunchMonitoringWithTimeline:timeline];
+    return self.bugSplat;
+}
+
+- (void)drainHangQueue
+{
+    dispatch_sync([self.bugSplat hangQueueForTesting], ^{});
+}
+
+- (NSArray<NSString *> *)launchReports
+{
+    return [[self newCrashFiles] filteredArrayUsingPredicate:[NSPredicate predicateWithFormat:@"SELF ENDSWITH '-launch.crash'"]];
+}
+
+#pragma mark - Timeline
+
+- (void)testTimeline_KeepsFirstDatePerMark
+{
+    NSDate *start = [NSDate dateWithTimeIntervalSinceReferenceDate:1000];
+    BugSplatLaunchTimeline *timeline = [[BugSplatLaunchTimeline alloc] initWithProcessStartDate:start];
+    XCTAssertLessThan([timeline timeToMark:BugSplatLaunchMarkReady], 0);
+
+    XCTAssertTrue([timeline recordMark:BugSplatLaunchMarkReady atDate:[start dateByAddingTimeInterval:2.5]]);
+    XCTAssertFalse([timeline recordMark:BugSplatLaunchMarkReady atDate:[start dateByAddingTimeInterval:9.0]]);
+    XCTAssertEqualWithAccuracy([timeline timeToMark:BugSplatLaunchMarkReady], 2.5, 0.0001);
+}
+
+- (void)testTimeline_DescriptionListsMarksInOrderReached
+{
+    NSDate *start = [NSDate dateWithTimeIntervalSinceReferenceDate:1000];
+    BugSplatLaunchTimeline *timeline = [[BugSplatLaunchTimeline alloc] initWithProcessStartDate:start];
+    [timeline recordMark:BugSplatLaunchMarkStart atDate:[start dateByAddingTimeInterval:0.25]];
+    [timeline recordMark:BugSplatLaunchMarkReady atDate:[start dateByAddingTimeInterval:0.5]];
+
+    NSArray<NSString *> *lines = [[timeline timelineDescription] componentsSeparatedByString:@"\n"];
+    XCTAssertEqualObjects(lines[0], @"process-start                  0 ms");
+    XCTAssertEqualObjects(lines[1], @"start                        250 ms  (+250 ms)");
+    XCTAssertEqualObjects(lines[2], @"ready                        500 ms  (+250 ms)");
+    XCTAssertEqualObjects(lines[3], @"first-main-queue-block   not reached");
+}
+
+- (void)testCurrentProcessStartDate_IsBeforeNow
+{
+    NSDate *processStart = [BugSplatLaunchTimeline currentProcessStartDate];
+    XCTAssertNotNil(processStart);
+    XCTAssertLessThan(processStart.timeIntervalSinceNow, 0);
+    XCTAssertGreaterThan(processStart.timeIntervalSinceNow, -24 * 60 * 60, @"Started within the last day");
+}
+
+#pragma mark - Slow Launch Reports
+
+- (void)testSlowLaunch_ReportsTimelineWithMainThreadSample
+{
+    BugSplat *bugSplat = [self bugSplatWithLaunchStartedSecondsAgo:8.0];
+    dispatch_sync([bugSplat hangQueueForTesting], ^{
+        [bugSplat sampleSlowLaunch];
+    });
+    [bugSplat launchReachedMark:BugSplatLaunchMarkFirstMainQueueBlock];
+    [self drainHangQueue];
+
+    NSArray<NSString *> *reports = [self launchReports];
+    XCTAssertEqual(reports.count, 1u);
+    NSString *basePath = [[bugSplat crashesDirectoryPath] stringByAppendingPathComponent:reports.firstObject.stringByDeletingPathExtension];
+    NSString *text = [NSString stringWithContentsOfFile:[basePath stringByAppendingPathExtension:@"crash"] encoding:NSUTF8StringEncoding error:nil];
+    XCTAssertTrue([text containsString:@"Slow Launch"]);
+
+    NSDictionary *metadata = [BugSplatMetadataCodec metadataWithContentsOfFile:[basePath stringByAppendingPathExtension:@"meta"]];
+    NSDictionary *attributes = metadata[@"attributes"];
+    XCTAssertGreaterThanOrEqual([attributes[@"bugsplat-launch-duration-ms"] integerValue], 8000);
+    XCTAssertLessThan([attributes[@"bugsplat-launch-duration-ms"] integerValue], 60000);
+    XCTAssertEqualObjects(attributes[@"bugsplat-launch-threshold-ms"], @"5000");
+    XCTAssertEqualObjects(attributes[@"bugsplat-launch-end"], @"first-main-queue-block");
+    XCTAssertEqualObjects(attributes[@"bugsplat-launch-start-ms"], @"1000");
+    XCTAssertEqualObjects(attributes[@"bugsplat-launch-first-main-queue-block-ms"], attributes[@"bugsplat-launch-duration-ms"]);
+    XCTAssertNil(attributes[@"bugsplat-launch-ready-ms"]);
+    XCTAssertEqualObjects(metadata[@"userSubmitted"], @YES);
+
+    NSString *timeline = [NSString stringWithContentsOfFile:[basePath stringByAppendingString:@"-0.data"] encoding:NSUTF8StringEncoding error:nil];
+    XCTAssertTrue([timeline containsString:@"first-main-queue-block"]);
+    XCTAssertTrue([timeline containsString:@"ready                    not reached"]);
+
+    // Later marks do not report the launch again.
+    [bugSplat markLaunchReady];
+    [self drainHangQueue];
+    XCTAssertEqual([self launchReports].count, 1u);
+}
+
+- (void)testFastLaunch_IsNotReported
+{
+    BugSplat *bugSplat = [self bugSplatWithLaunchStartedSecondsAgo:2.0];
+    [bugSplat launchReachedMark:BugSplatLaunchMarkFirstMainQueueBlock];
+    [self drainHangQueue];
+    dispatch_sync([bugSplat hangQueueForTesting], ^{
+        [bugSplat sampleSlowLaunch];
+    });
+    XCTAssertEqual([self launchReports].count, 0u);
+}
+
+- (void)testWaitsForReadyMark_EndsLaunchAtReadyMark
+{
+    BugSplat *bugSplat = [self bugSplatWithLaunchStartedSecondsAgo:6.0];
+    bugSplat.waitsForLaunchReadyMark = YES;
+    [bugSplat launchReachedMark:BugSplatLaunchMarkFirstMainQueueBlock];
+    [self drainHangQueue];
+    XCTAssertEqual([self launchReports].count, 0u, @"Not over until the app is ready");
+
+    [bugSplat markLaunchReady];
+    [self drainHangQueue];
+    NSArray<NSString *> *reports = [self launchReports];
+    XCTAssertEqual(reports.count, 1u);
+    NSString *metaPath = [[[bugSplat crashesDirectoryPath] stringByAppendingPathComponent:reports.firstObject.stringByDeletingPathExtension]
+                          stringByAppendingPathExtension:@"meta"];
+    NSDictionary *attributes = [BugSplatMetadataCodec metadataWithContentsOfFile:metaPath][@"attributes"];
+    XCTAssertEqualObjects(attributes[@"bugsplat-launch-end"], @"ready");
+    XCTAssertNotNil(attributes[@"bugsplat-launch-first-main-queue-block-ms"]);
+}
+
+- (void)testLaunchMonitoring_DisabledByDefault
+{
+    self.bugSplat = [[BugSplat alloc] init];
+    XCTAssertFalse(self.bugSplat.enableLaunchMonitoring);
+    XCTAssertEqual(self.bugSplat.slowLaunchThreshold, 5.0);
+    XCTAssertFalse(self.bugSplat.waitsForLaunchReadyMark);
+    [self.bugSplat markLaunchReady];
+    XCTAssertNil([self.bugSplat launchTimeline]);
+}
+
+@end
@@ -0,0 +1,236 @@
+//
+//  BugSplatLogBufferTests.m
+//  BugSplatTests
+//
+//  Tests for the log buffer: the lock-free ring itself, the mapped file it
+//  lives in, and BugSplat attaching the previous session's log to the
+//  crash that ended it.
+//
+//  Copyright © BugSplat, LLC. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+#import <CrashReporter/CrashReporter.h>
+
+#import <BugSplat/BugSplat.h>
+#import "BugSplat+Testing.h"
+#import "BugSplatCrashFilesTestCase.h"
+#import "BugSplatLogRing.h"
+#import "BugSplatLogRingFile.h"
+#import "BugSplatMetadataCodec.h"
+
+@interface BugSplatLogBufferTests : BugSplatCrashFilesTestCase
+@property (nonatomic, strong) NSMutableData *region;
+@property (nonatomic, copy) NSString *filePath;
+@property (nonatomic, strong, nullable) BugSplat *bugSplat;
+@end
+
+@implementation BugSplatLogBufferTests
+{
+    BugSplatLogRing _ring;
+}
+
+- (void)setUp
+{
+    [super setUp];
+    self.region = [NSMutableData dataWithLength:BugSplatLogRingRegionSize(4096)];
+    XCTAssertTrue(BugSplatLogRingFormat(&_ring, self.region.mutableBytes, self.region.length));
+    self.filePath = [NSTemporaryDirectory() stringByAppendingPathComponent:
+                     [NSString stringWithFormat:@"BugSplatLogRing-%@", [NSUUID UUID].UUIDString]];
+}
+
+- (void)tearDown
+{
+    [[NSFileManager defaultManager] removeItemAtPath:self.filePath error:nil];
+    if (self.bugSplat) {
+        [self.bugSplat.logRingFile deactivate];
+        [[NSFileManager defaultManager] removeItemAtPath:[self.bugSplat logBufferPath] error:nil];
+    }
+    self.bugSplat = nil;
+    [super tearDown];
+}
+
+#pragma mark - Helpers
+
+- (void)write:(NSString *)message
+{
+    NSData *bytes = [message dataUsingEncoding:NSUTF8StringEncoding];
+    BugSplatLogRingWrite(&_ring, bytes.bytes, bytes.length);
+}
+
+- (NSString *)tailWithCapacity:(size_t)capacity
+{
+    NSMutableData *buffer = [NSMutableData dataWithLength:capacity];
+    size_t length = BugSplatLogRingCopyTail(&_ring, buffer.mutableBytes, buffer.length);
+    return [[NSString alloc] initWithBytes:buffer.bytes length:length encoding:NSUTF8StringEncoding];
+}
+
+#pragma mark - Ring
+
+- (void)testEmptyRing_HasNoTail
+{
+    XCTAssertEqualObjects([self tailWithCapacity:4096], @"");
+}
+
+- (void)testTail_ReturnsRecordsOldestFirstWithOneNewlineEach
+{
+    [self write:@"first"];
+    [self write:@"second\n"];
+    [self write:@"third"];
+    XCTAssertEqualObjects([self tailWithCapacity:4096], @"first\nsecond\nthird\n");
+}
+
+- (void)testTail_KeepsNewestWholeRecordsThatFit
+{
+    [self write:@"aaaa"];
+    [self write:@"bbbb"];
+    [self write:@"cccc"];
+    XCTAssertEqualObjects([self tailWithCapacity:12], @"bbbb\ncccc\n", @"Partial records are never copied");
+}
+
+- (void)testWrap_OverwritesOldestRecords
+{
+    for (NSUInteger i = 0; i < 1000; i++) {
+        [self write:[NSString stringWithFormat:@"line %lu", (unsigned long)i]];
+    }
+    NSArray<NSString *> *lines = [[self tailWithCapacity:8192] componentsSeparatedByString:@"\n"];
+    XCTAssertEqualObjects(lines[lines.count - 2], @"line 999");
+    XCTAssertFalse([lines containsObject:@"line 0"]);
+
+    // What is left is a contiguous run of the newest records.
+    NSInteger expected = [[lines.firstObject substringFromIndex:5] integerValue];
+    for (NSString *line in [lines subarrayWithRange:NSMakeRange(0, lines.count - 1)]) {
+        XCTAssertEqualObjects(line, ([NSString stringWithFormat:@"line %ld", (long)expected++]));
+    }
+}
+
+- (void)testLongMessage_IsTruncated
+{
+    NSString *longMessage = [@"" stringByPaddingToLength:4000 withString:@"x" startingAtIndex:0];
+    [self write:longMessage];
+    NSString *tail = [self tailWithCapacity:8192];
+    XCTAssertEqual(tail.length, BugSplatLogRingMaxMessageLength(&_ring) + 1);
+}
+
+- (void)testUnpublishedRecord_IsSkipped
+{
+    [self write:@"before"];
+    [self write:@"torn"];
+    [self write:@"after"];
+
+    // Simulate a writer that crashed mid-copy: clear the tag of the middle record.
+    // "before" occupies 16 + 8 bytes, so "torn" starts at offset 24; its tag is the second word.
+    uint8_t *data = (uint8_t *)self.region.mutableBytes + sizeof(BugSplatLogRingHeader);
+    memset(data + 24 + sizeof(uint32_t), 0, sizeof(uint32_t));
+
+    XCTAssertEqualObjects([self tailWithCapacity:4096], @"before\nafter\n");
+}
+
+- (void)testConcurrentWriters_LeaveOnlyIntactRecords
+{
+    const size_t writers = 8;
+    dispatch_apply(writers, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^(size_t writer) {
+        char message[32];
+        for (int i = 0; i < 5000; i++) {
+            int length = snprintf(message, sizeof(message), "writer %zu message %d", writer, i);
+            BugSplatLogRingWrite(&self->_ring, message, (size_t)length);
+        }
+    });
+
+    NSArray<NSString *> *lines = [[self tailWithCapacity:4096] componentsSeparatedByString:@"\n"];
+    XCTAssertGreaterThan(lines.count, 10u);
+    NSRegularExpression *pattern = [NSRegularExpression regularExpressionWithPattern:@"^writer [0-7] message [0-9]+$" options:0 error:nil];
+    for (NSString *line in [lines subarrayWithRange:NSMakeRange(0, lines.count - 1)]) {
+        XCTAssertEqual([pattern numberOfMatchesInString:line options:0 range:NSMakeRange(0, line.length)], 1u, @"Torn record: %@", line);
+    }
+}
+
+- (void)testAttach_RejectsUnformattedRegion
+{
+    NSMutableData *zeros = [NSMutableData dataWithLength:4096];
+    BugSplatLogRing ring;
+    XCTAssertFalse(BugSplatLogRingAttach(&ring, zeros.mutableBytes, zeros.length));
+    XCTAssertTrue(BugSplatLogRingAttach(&ring, self.region.mutableBytes, self.region.length));
+}
+
+#pragma mark - File
+
+- (void)testFile_RecordsSurviveReopen
+{
+    @autoreleasepool {
+        BugSplatLogRingFile *file = [[BugSplatLogRingFile alloc] initWithPath:self.filePath capacity:8192];
+        XCTAssertNotNil(file);
+        [file writeBytes:"session one" length:11];
+        file = nil;
+    }
+
+    NSData *tail = [BugSplatLogRingFile tailOfFileAtPath:self.filePath maxLength:8192];
+    XCTAssertEqualObjects(tail, [@"session one\n" dataUsingEncoding:NSUTF8StringEncoding]);
+
+    BugSplatLogRingFile *reopened = [[BugSplatLogRingFile alloc] initWithPath:self.filePath capacity:8192];
+    XCTAssertEqualObjects([reopened tailWithMaxLength:8192], tail, @"Same capacity keeps the records");
+
+    BugSplatLogRingFile *resized = [[BugSplatLogRingFile alloc] initWithPath:self.filePath capacity:16384];
+    XCTAssertNil([resized tailWithMaxLength:16384], @"A different capacity starts a new ring");
+}
+
+- (void)testGlobalWrite_GoesToActiveFileOnly
+{
+    BugSplatLogRingFile *file = [[BugSplatLogRingFile alloc] initWithPath:self.filePath capacity:8192];
+    BugSplatLogBufferWriteString("dropped before activation");
+
+    [file activate];
+    BugSplatLogBufferWriteString("kept");
+    BugSplatLogBufferPrintf("formatted %d", 42);
+    [file deactivate];
+    BugSplatLogBufferWriteString("dropped after deactivation");
+
+    XCTAssertEqualObjects([file tailWithMaxLength:8192], [@"kept\nformatted 42\n" dataUsingEncoding:NSUTF8StringEncoding]);
+}
+
+#pragma mark - BugSplat integration
+
+- (void)testPreviousSessionLog_IsAttachedToItsCrash
+{
+    self.bugSplat = [[BugSplat alloc] init];
+    self.bugSplat.bugSplatDatabase = @"logdb";
+    self.bugSplat.enableLogBuffer = YES;
+    [self snapshotCrashFilesOfBugSplat:self.bugSplat];
+
+    // The previous session logged two lines, then crashed.
+    @autoreleasepool {
+        BugSplatLogRingFile *previous = [[BugSplatLogRingFile alloc] initWithPath:[self.bugSplat logBufferPath]
+                                                                         capacity:self.bugSplat.logBufferSize];
+        [previous reset];
+        [previous writeBytes:"loading level 3" length:15];
+        [previous writeBytes:"spawned 12 enemies" length:18];
+        previous = nil;
+    }
+
+    [self.bugSplat openLogBuffer];
+    NSData *expectedLog = [@"loading level 3\nspawned 12 enemies\n" dataUsingEncoding:NSUTF8StringEncoding];
+    XCTAssertEqualObjects([self.bugSplat previousSessionLog], expectedLog);
+    XCTAssertNil([[self.bugSplat logRingFile] tailWithMaxLength:4096], @"This session starts with an empty log");
+
+    PLCrashReporter *reporter = [[PLCrashReporter alloc] initWithConfiguration:[PLCrashReporterConfig defaultConfiguration]];
+    [self.bugSplat persistCrashReportData:[reporter generateLiveReportAndReturnError:nil]];
+
+    NSString *attachmentFile = [[[self newCrashFiles] filteredArrayUsingPredicate:
+                                 [NSPredicate predicateWithFormat:@"SELF ENDSWITH '.data'"]] firstObject];
+    XCTAssertNotNil(attachmentFile);
+    NSData *encoded = [NSData dataWithContentsOfFile:[[self.bugSplat crashesDirectoryPath] stringByAppendingPathComponent:attachmentFile]];
+    BugSplatAttachment *attachment = [BugSplatMetadataCodec attachmentWithData:encoded];
+    XCTAssertEqualObjects(attachment.filename, @"BugSplatLog.txt");
+    XCTAssertEqualObjects(attachment.contentType, @"text/plain");
+    XCTAssertEqualObjects(attachment.attachmentData, expectedLog);
+}
+
+- (void)testLogBufferDisabled_OpensNothing
+{
+    self.bugSplat = [[BugSplat alloc] init];
+    [self.bugSplat openLogBuffer];
+    XCTAssertNil([self.bugSplat logRingFile]);
+    XCTAssertNil([self.bugSplat previousSessionLog]);
+}
+
+@end
@@ -0,0 +1,122 @@
+//
+//  BugSplatLoggingTests.m
+//  BugSplatTests
+//
+//  Tests for the SDK's leveled diagnostic logging and the host log handler.
+//
+//  Copyright © BugSplat, LLC. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+
+#import <BugSplat/BugSplat.h>
+#import "BugSplatLogging.h"
+
+@interface BugSplatLoggingTests : XCTestCase
+@property (nonatomic, assign) BugSplatLogLevel originalLevel;
+@property (nonatomic, strong) NSMutableArray<NSString *> *messages;
+@property (nonatomic, assign) NSUInteger evaluations;
+@end
+
+@implementation BugSplatLoggingTests
+
+- (void)setUp
+{
+    [super setUp];
+    self.originalLevel = BugSplat.logLevel;
+    self.messages = [NSMutableArray array];
+    self.evaluations = 0;
+
+    __weak __typeof(self) weakSelf = self;
+    BugSplat.logHandler = ^(BugSplatLogLevel level, NSString *message) {
+        [weakSelf.messages addObject:[NSString stringWithFormat:@"%ld %@", (long)level, message]];
+    };
+}
+
+- (void)tearDown
+{
+    BugSplat.logHandler = nil;
+    BugSplat.logLevel = self.originalLevel;
+    [super tearDown];
+}
+
+- (NSString *)expensiveArgument
+{
+    self.evaluations++;
+    return @"value";
+}
+
+- (void)logAtEveryLevel
+{
+    BugSplatLogError(@"error %d", 1);
+    BugSplatLogWarning(@"warning %d", 2);
+    BugSplatLogInfo(@"info %d", 3);
+    BugSplatLogDebug(@"debug %d", 4);
+}
+
+#pragma mark - Levels
+
+- (void)testDefaultLevel_IsWarning
+{
+    // Fresh processes start at Warning; the test host may have changed it, so check the constant.
+    BugSplat.logLevel = BugSplatLogLevelWarning;
+    [self logAtEveryLevel];
+    XCTAssertEqualObjects(self.messages, (@[ @"1 error 1", @"2 warning 2" ]));
+}
+
+- (void)testLevelNone_SuppressesEverything
+{
+    BugSplat.logLevel = BugSplatLogLevelNone;
+    [self logAtEveryLevel];
+    XCTAssertEqual(self.messages.count, 0u);
+}
+
+- (void)testLevelInfo_AddsInfoMessages
+{
+    BugSplat.logLevel = BugSplatLogLevelInfo;
+    [self logAtEveryLevel];
+    XCTAssertEqualObjects(self.messages, (@[ @"1 error 1", @"2 warning 2", @"3 info 3" ]));
+}
+
+- (void)testLevelDebug_IncludesDebugOnlyWhenCompiledIn
+{
+    BugSplat.logLevel = BugSplatLogLevelDebug;
+    [self logAtEveryLevel];
+#if BUGSPLAT_LOG_DEBUG
+    XCTAssertEqualObjects(self.messages.lastObject, @"4 debug 4");
+    XCTAssertEqual(self.messages.count, 4u);
+#else
+    XCTAssertEqual(self.messages.count, 3u);
+#endif
+}
+
+- (void)testDisabledLevel_DoesNotEvaluateArguments
+{
+    BugSplat.logLevel = BugSplatLogLevelError;
+    BugSplatLogInfo(@"%@", [self expensiveArgument]);
+    BugSplatLogDebug(@"%@", [self expensiveArgument]);
+    XCTAssertEqual(self.evaluations, 0u);
+
+    BugSplatLogError(@"%@", [self expensiveArgument]);
+    XCTAssertEqual(self.evaluations, 1u);
+}
+
+#pragma mark - Handler
+
+- (void)testHandler_ReceivesMessageWithoutPrefix
+{
+    BugSplat.logLevel = BugSplatLogLevelError;
+    BugSplatLogError(@"Failed to write %@", @"report.crash");
+    XCTAssertEqualObjects(self.messages, @[ @"1 Failed to write report.crash" ]);
+}
+
+- (void)testClearingHandler_StopsDelivery
+{
+    BugSplat.logLevel = BugSplatLogLevelError;
+    BugSplat.logHandler = nil;
+    BugSplatLogError(@"goes to the unified log");
+    XCTAssertEqual(self.messages.count, 0u);
+    XCTAssertNil(BugSplat.logHandler);
+}
+
+@end
@@ -0,0 +1,235 @@
+//
+//  BugSplatMetadataCodecTests.m
+//  BugSplatTests
+//
+//  Round-trip, legacy-migration and robustness tests for the compact binary
+//  metadata format.
+//
+//  Copyright © BugSplat, LLC. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+
+#import "BugSplatAttachment.h"
+#import "BugSplatBinaryMetadata.h"
+#import "BugSplatMetadataCodec.h"
+
+@interface BugSplatMetadataCodecTests : XCTestCase
+@end
+
+@implementation BugSplatMetadataCodecTests
+
+- (NSDictionary *)sampleMetadata
+{
+    return @{
+        @"database": @"fred",
+        @"applicationName": @"My App",
+        @"applicationVersion": @"1.2.3 (45)",
+        @"userName": @"Fred Ünïcödé",
+        @"timestamp": @"2024-01-01T00:00:00Z",
+        @"userSubmitted": @YES,
+        @"occurrences": @(42),
+        @"attributes": @{ @"build": @"release", @"empty": @"" },
+    };
+}
+
+#pragma mark - Metadata
+
+- (void)testMetadata_RoundTrip
+{
+    NSDictionary *metadata = [self sampleMetadata];
+    NSData *data = [BugSplatMetadataCodec dataWithMetadata:metadata];
+    XCTAssertNotNil(data);
+    XCTAssertTrue(BugSplatMetaIsEncoded(data.bytes, data.length));
+
+    NSDictionary *decoded = [BugSplatMetadataCodec metadataWithData:data];
+    XCTAssertEqualObjects(decoded, metadata);
+}
+
+- (void)testMetadata_PreservesBooleanType
+{
+    NSData *data = [BugSplatMetadataCodec dataWithMetadata:@{ @"userSubmitted": @YES }];
+    NSNumber *decoded = [BugSplatMetadataCodec metadataWithData:data][@"userSubmitted"];
+    XCTAssertEqual(CFGetTypeID((__bridge CFTypeRef)decoded), CFBooleanGetTypeID());
+    XCTAssertTrue(decoded.boolValue);
+}
+
+- (void)testMetadata_LargeValuesSpillPastStackBuffer
+{
+    NSString *longLog = [@"" stringByPaddingToLength:64 * 1024 withString:@"log line\n" startingAtIndex:0];
+    NSDictionary *metadata = @{ @"applicationLog": longLog, @"database": @"fred" };
+    NSDictionary *decoded = [BugSplatMetadataCodec metadataWithData:[BugSplatMetadataCodec dataWithMetadata:metadata]];
+    XCTAssertEqualObjects(decoded, metadata);
+}
+
+- (void)testMetadata_KeepsEmbeddedNULCharacters
+{
+    NSString *withNUL = [NSString stringWithFormat:@"before%Cafter", (unichar)0];
+    NSString *longWithNUL = [[@"" stringByPaddingToLength:1024 withString:@"x" startingAtIndex:0] stringByAppendingString:withNUL];
+    NSDictionary *metadata = @{ @"notes": withNUL, @"applicationLog": longWithNUL, @"attributes": @{ @"key": withNUL } };
+    NSDictionary *decoded = [BugSplatMetadataCodec metadataWithData:[BugSplatMetadataCodec dataWithMetadata:metadata]];
+    XCTAssertEqualObjects(decoded, metadata);
+}
+
+- (void)testMetadata_IsSmallerThanXMLPlist
+{
+    NSDictionary *metadata = [self sampleMetadata];
+    NSData *binary = [BugSplatMetadataCodec dataWithMetadata:metadata];
+    NSData *plist = [NSPropertyListSerialization dataWithPropertyList:metadata
+                                                               format:NSPropertyListXMLFormat_v1_0
+                                                              options:0
+                                                                error:nil];
+    XCTAssertLessThan(binary.length, plist.length / 3);
+}
+
+- (void)testMetadata_DecodesLegacyXMLPlist
+{
+    NSDictionary *metadata = [self sampleMetadata];
+    NSData *plist = [NSPropertyListSerialization dataWithPropertyList:metadata
+                                                               format:NSPropertyListXMLFormat_v1_0
+                                                              options:0
+                                                                error:nil];
+    XCTAssertEqualObjects([BugSplatMetadataCodec metadataWithData:plist], metadata);
+}
+
+- (void)testMetadata_DecodesLegacyKeyedArchive
+{
+    NSDictionary *metadata = [self sampleMetadata];
+    NSData *archive = [NSKeyedArchiver archivedDataWithRootObject:metadata requiringSecureCoding:NO error:nil];
+    XCTAssertEqualObjects([BugSplatMetadataCodec metadataWithData:archive], metadata);
+}
+
+- (void)testMetadata_MigratesLegacyFileOnRewrite
+{
+    NSString *path = [NSTemporaryDirectory() stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]];
+    NSDictionary *metadata = [self sampleMetadata];
+    XCTAssertTrue([metadata writeToFile:path atomically:YES]);
+
+    NSMutableDictionary *loaded = [[BugSplatMetadataCodec metadataWithContentsOfFile:path] mutableCopy];
+    XCTAssertEqualObjects(loaded, metadata);
+    loaded[@"comments"] = @"it crashed";
+    XCTAssertTrue([BugSplatMetadataCodec writeMetadata:loaded toFile:path]);
+
+    NSData *rewritten = [NSData dataWithContentsOfFile:path];
+    XCTAssertTrue(BugSplatMetaIsEncoded(rewritten.bytes, rewritten.length));
+    XCTAssertEqualObjects([BugSplatMetadataCodec metadataWithContentsOfFile:path], loaded);
+    [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+}
+
+- (void)testMetadata_RejectsNewerVersion
+{
+    NSMutableData *data = [[BugSplatMetadataCodec dataWithMetadata:@{ @"database": @"fred" }] mutableCopy];
+    ((uint8_t *)data.mutableBytes)[3] = BugSplatMetaFormatVersion + 1;
+    XCTAssertNil([BugSplatMetadataCodec metadataWithData:data]);
+}
+
+- (void)testMetadata_TruncatedInputNeverReadsPastEnd
+{
+    NSData *data = [BugSplatMetadataCodec dataWithMetadata:[self sampleMetadata]];
+    for (NSUInteger length = 0; length < data.length; length++) {
+        NSData *truncated = [data subdataWithRange:NSMakeRange(0, length)];
+        XCTAssertNoThrow([BugSplatMetadataCodec metadataWithData:truncated]);
+    }
+}
+
+- (void)testMetadata_SkipsUnknownFieldTypes
+{
+    uint8_t buffer[128];
+    BugSplatMetaWriter writer;
+    BugSplatMetaWriterInit(&writer, buffer, sizeof(buffer));
+    BugSplatMetaWriteString(&writer, "database", 8, "fred", 4);
+    // Hand-roll a field with an unassigned type id: <type> <keyLen> <key> <valueLen> <value>
+    const uint8_t unknown[] = { 0x7F, 1, 'x', 2, 0xAA, 0xBB };
+    memcpy(buffer + writer.length, unknown, sizeof(unknown));
+    size_t length = writer.length + sizeof(unknown);
+
+    NSDictionary *decoded = [BugSplatMetadataCodec metadataWithData:[NSData dataWithBytes:buffer length:length]];
+    XCTAssertEqualObjects(decoded, @{ @"database": @"fred" });
+}
+
+- (void)testMetadata_RejectsOverlongVarint
+{
+    // A key length spread over 11 bytes, and an integer whose 10th byte sets bits past bit 63
+    const uint8_t overlong[] = { 'B', 'S', 'M', BugSplatMetaFormatVersion, BugSplatMetaTypeString,
+                                 0x81, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x00 };
+    const uint8_t tooWide[] = { 'B', 'S', 'M', BugSplatMetaFormatVersion, BugSplatMetaTypeInteger, 1, 'n', 10,
+                                0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x02 };
+
+    BugSplatMetaReader reader;
+    BugSplatMetaField field;
+    XCTAssertEqual(BugSplatMetaReaderInit(&reader, overlong, sizeof(overlong)), BugSplatMetaResultOK);
+    XCTAssertEqual(BugSplatMetaReaderNext(&reader, &field), BugSplatMetaResultMalformed);
+
+    XCTAssertEqual(BugSplatMetaReaderInit(&reader, tooWide, sizeof(tooWide)), BugSplatMetaResultOK);
+    XCTAssertEqual(BugSplatMetaReaderNext(&reader, &field), BugSplatMetaResultOK);
+    int64_t value = 0;
+    XCTAssertFalse(BugSplatMetaFieldGetInteger(&field, &value));
+}
+
+- (void)testMetadata_AcceptsLargestVarint
+{
+    uint8_t buffer[64];
+    BugSplatMetaWriter writer;
+    BugSplatMetaWriterInit(&writer, buffer, sizeof(buffer));
+    BugSplatMetaWriteInteger(&writer, "n", 1, INT64_MIN);
+
+    BugSplatMetaReader reader;
+    BugSplatMetaField field;
+    XCTAssertEqual(BugSplatMetaReaderInit(&reader, buffer, writer.length), BugSplatMetaResultOK);
+    XCTAssertEqual(BugSplatMetaReaderNext(&reader, &field), BugSplatMetaResultOK);
+    XCTAssertEqual(field.valueLength, 10u);
+    int64_t value = 0;
+    XCTAssertTrue(BugSplatMetaFieldGetInteger(&field, &value));
+    XCTAssertEqual(value, INT64_MIN);
+}
+
+#pragma mark - Reader
+
+- (void)testReader_IteratesInPlace
+{
+    NSData *data = [BugSplatMetadataCodec dataWithMetadata:@{ @"attributes": @{ @"a": @"1", @"b": @"2" } }];
+
+    BugSplatMetaReader reader;
+    XCTAssertEqual(BugSplatMetaReaderInit(&reader, data.bytes, data.length), BugSplatMetaResultOK);
+    BugSplatMetaField field;
+    XCTAssertEqual(BugSplatMetaReaderNext(&reader, &field), BugSplatMetaResultOK);
+    XCTAssertTrue(BugSplatMetaFieldKeyEquals(&field, "attributes"));
+    XCTAssertTrue(field.value > (const uint8_t *)data.bytes && field.value < (const uint8_t *)data.bytes + data.length,
+                  @"Field values should alias the input buffer");
+
+    BugSplatMetaReader mapReader;
+    size_t count = 0;
+    XCTAssertEqual(BugSplatMetaMapReaderInit(&mapReader, &field, &count), BugSplatMetaResultOK);
+    XCTAssertEqual(count, 2);
+    XCTAssertEqual(BugSplatMetaReaderNext(&reader, &field), BugSplatMetaResultEnd);
+}
+
+#pragma mark - Attachments
+
+- (void)testAttachment_RoundTrip
+{
+    uint8_t bytes[] = { 0x00, 0x01, 0xFE, 0xFF };
+    BugSplatAttachment *attachment = [[BugSplatAttachment alloc] initWithFilename:@"blob.bin"
+                                                                   attachmentData:[NSData dataWithBytes:bytes length:sizeof(bytes)]
+                                                                      contentType:@"application/octet-stream"];
+    NSData *data = [BugSplatMetadataCodec dataWithAttachment:attachment];
+    BugSplatAttachment *decoded = [BugSplatMetadataCodec attachmentWithData:data];
+
+    XCTAssertEqualObjects(decoded.filename, attachment.filename);
+    XCTAssertEqualObjects(decoded.contentType, attachment.contentType);
+    XCTAssertEqualObjects(decoded.attachmentData, attachment.attachmentData);
+}
+
+- (void)testAttachment_DecodesLegacyKeyedArchive
+{
+    BugSplatAttachment *attachment = [[BugSplatAttachment alloc] initWithFilename:@"log.txt"
+                                                                   attachmentData:[@"hello" dataUsingEncoding:NSUTF8StringEncoding]
+                                                                      contentType:@"text/plain"];
+    NSData *archive = [NSKeyedArchiver archivedDataWithRootObject:attachment requiringSecureCoding:YES error:nil];
+    BugSplatAttachment *decoded = [BugSplatMetadataCodec attachmentWithData:archive];
+
+    XCTAssertEqualObjects(decoded.filename, @"log.txt");
+    XCTAssertEqualObjects(decoded.attachmentData, attachment.attachmentData);
+}
+
+@end
@@ -0,0 +1,594 @@
+//
+//  BugSplatPerformanceTests.m
+//  BugSplatTests
+//
+//  XCTest performance benchmarks for SDK hot paths. Each benchmark pairs the
+//  current implementation with the path it replaced so regressions and wins
+//  show up side by side in the Xcode performance report.
+//
+//  Copyright © BugSplat, LLC. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+#import <CrashReporter/CrashReporter.h>
+#import <mach/mach.h>
+
+#import <BugSplat/BugSplat.h>
+#import "BugSplat+Testing.h"
+#import "BugSplatAttachment.h"
+#import "BugSplatCrashReportTextWriter.h"
+#import "BugSplatHangBenchmark.h"
+#import "BugSplatLogRingFile.h"
+#import "BugSplatMetadataCodec.h"
+#import "BugSplatResourceRingFile.h"
+#import "BugSplatZipHelper.h"
+#import "MockBundle.h"
+#import "MockCrashReporter.h"
+#import "MockCrashStorage.h"
+#import "MockURLSession.h"
+#import "MockUserDefaults.h"
+
+// Iterations per measured block - large enough to dominate timer noise.
+static const NSUInteger kBenchmarkIterations = 1000;
+
+// Idle period each watchdog benchmark iteration runs the main run loop for.
+static const NSTimeInterval kIdleWatchdogSeconds = 3.0;
+
+@interface BugSplatPerformanceTests : XCTestCase <BugSplatHangTrackerDelegate>
+@end
+
+@implementation BugSplatPerformanceTests
+
+- (NSDictionary *)typicalMetadata
+{
+    NSMutableDictionary *attributes = [NSMutableDictionary dictionary];
+    for (NSUInteger i = 0; i < 20; i++) {
+        attributes[[NSString stringWithFormat:@"attribute-%lu", (unsigned long)i]] = [NSString stringWithFormat:@"value-%lu", (unsigned long)i];
+    }
+    return @{
+        @"database": @"fred",
+        @"applicationName": @"My App",
+        @"applicationVersion": @"1.2.3 (45)",
+        @"userName": @"Fred",
+        @"userEmail": @"fred@example.com",
+        @"timestamp": @"2024-01-01T00:00:00Z",
+        @"userSubmitted": @YES,
+        @"attributes": attributes,
+    };
+}
+
+- (BugSplatAttachment *)typicalAttachment
+{
+    NSMutableData *data = [NSMutableData dataWithLength:256 * 1024];
+    arc4random_buf(data.mutableBytes, data.length);
+    return [[BugSplatAttachment alloc] initWithFilename:@"attachment.bin" attachmentData:data contentType:@"application/octet-stream"];
+}
+
+#pragma mark - Metadata (.meta files)
+
+- (void)testPerformance_MetadataEncodeDecode_XMLPlist
+{
+    NSDictionary *metadata = [self typicalMetadata];
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < kBenchmarkIterations; i++) {
+            @autoreleasepool {
+                NSData *data = [NSPropertyListSerialization dataWithPropertyList:metadata format:NSPropertyListXMLFormat_v1_0 options:0 error:nil];
+                (void)[NSPropertyListSerialization propertyListWithData:data options:NSPropertyListImmutable format:NULL error:nil];
+            }
+        }
+    }];
+}
+
+- (void)testPerformance_MetadataEncodeDecode_Binary
+{
+    NSDictionary *metadata = [self typicalMetadata];
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < kBenchmarkIterations; i++) {
+            @autoreleasepool {
+                NSData *data = [BugSplatMetadataCodec dataWithMetadata:metadata];
+                (void)[BugSplatMetadataCodec metadataWithData:data];
+            }
+        }
+    }];
+}
+
+#pragma mark - Crash-time properties (PLCrashReporter customData)
+
+- (void)testPerformance_CustomDataEncodeDecode_KeyedArchiver
+{
+    NSDictionary *metadata = [self typicalMetadata];
+    NSSet *classes = [NSSet setWithObjects:[NSDictionary class], [NSString class], [NSNumber class], nil];
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < kBenchmarkIterations; i++) {
+            @autoreleasepool {
+                NSData *data = [NSKeyedArchiver archivedDataWithRootObject:metadata requiringSecureCoding:NO error:nil];
+                (void)[NSKeyedUnarchiver unarchivedObjectOfClasses:classes fromData:data error:nil];
+            }
+        }
+    }];
+}
+
+- (void)testPerformance_CustomDataEncode_Binary
+{
+    // customData is re-encoded on every property change but decoded only once per crash,
+    // so the encode side is what matters at runtime.
+    NSDictionary *metadata = [self typicalMetadata];
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < kBenchmarkIterations; i++) {
+            @autoreleasepool {
+                (void)[BugSplatMetadataCodec dataWithMetadata:metadata];
+            }
+        }
+    }];
+}
+
+#pragma mark - Attachments (.data files)
+
+- (void)testPerformance_AttachmentEncodeDecode_KeyedArchiver
+{
+    BugSplatAttachment *attachment = [self typicalAttachment];
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < kBenchmarkIterations / 10; i++) {
+            @autoreleasepool {
+                NSData *data = [NSKeyedArchiver archivedDataWithRootObject:attachment requiringSecureCoding:YES error:nil];
+                (void)[NSKeyedUnarchiver unarchivedObjectOfClass:[BugSplatAttachment class] fromData:data error:nil];
+            }
+        }
+    }];
+}
+
+- (void)testPerformance_AttachmentEncodeDecode_Binary
+{
+    BugSplatAttachment *attachment = [self typicalAttachment];
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < kBenchmarkIterations / 10; i++) {
+            @autoreleasepool {
+                NSData *data = [BugSplatMetadataCodec dataWithAttachment:attachment];
+                (void)[BugSplatMetadataCodec attachmentWithData:data];
+            }
+        }
+    }];
+}
+
+#pragma mark - Attribute updates
+
+/// Previous path: copy the whole attribute dictionary and re-encode customData on every call.
+- (void)testPerformance_SetAttribute_CopyAndEncode
+{
+    NSMutableDictionary *metadata = [[self typicalMetadata] mutableCopy];
+    [self measureBlock:^{
+        NSDictionary<NSString *, NSString *> *attributes = @{};
+        for (NSUInteger i = 0; i < kBenchmarkIterations; i++) {
+            @autoreleasepool {
+                NSMutableDictionary *mutableAttributes = [attributes mutableCopy];
+                mutableAttributes[[NSString stringWithFormat:@"attr%lu", (unsigned long)(i % 50)]] = @"value";
+                attributes = mutableAttributes;
+                metadata[@"attributes"] = attributes;
+                (void)[BugSplatMetadataCodec dataWithMetadata:metadata];
+            }
+        }
+    }];
+}
+
+/// Current path: update one entry in the attribute store; customData is written once, later.
+- (void)testPerformance_SetAttribute_Store
+{
+    BugSplat *bugSplat = [BugSplat testInstanceWithCrashReporter:[[MockCrashReporter alloc] init]
+                                                    crashStorage:[[MockCrashStorage alloc] init]
+                                                    userDefaults:[[MockUserDefaults alloc] init]
+                                                          bundle:[[MockBundle alloc] init]];
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < kBenchmarkIterations; i++) {
+            @autoreleasepool {
+                [bugSplat setValue:@"value" forAttribute:[NSString stringWithFormat:@"attr%lu", (unsigned long)(i % 50)]];
+            }
+        }
+    }];
+}
+
+#pragma mark - Log buffer
+
+/// Baseline: copy each message into a ring-sized buffer with no framing or atomics.
+- (void)testPerformance_LogWrite_Memcpy
+{
+    NSMutableData *buffer = [NSMutableData dataWithLength:64 * 1024];
+    const char *message = "request finished: GET /api/v2/items status=200 duration=41ms";
+    size_t length = strlen(message);
+    [self measureBlock:^{
+        uint8_t *bytes = buffer.mutableBytes;
+        size_t offset = 0;
+        for (NSUInteger i = 0; i < kBenchmarkIterations * 100; i++) {
+            if (offset + length > buffer.length) {
+                offset = 0;
+            }
+            memcpy(bytes + offset, message, length);
+            offset += length;
+        }
+    }];
+}
+
+/// Current path: append the same message to a mapped log ring file.
+- (void)testPerformance_LogWrite_Ring
+{
+    NSString *path = [NSTemporaryDirectory() stringByAppendingPathComponent:@"BugSplatBenchmark.ring"];
+    BugSplatLogRingFile *file = [[BugSplatLogRingFile alloc] initWithPath:path capacity:64 * 1024];
+    const char *message = "request finished: GET /api/v2/items status=200 duration=41ms";
+    size_t length = strlen(message);
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < kBenchmarkIterations * 100; i++) {
+            [file writeBytes:message length:length];
+        }
+    }];
+    file = nil;
+    [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+}
+
+#pragma mark - Launch (-start)
+
+/// A BugSplat instance whose previous session left `pendingReport` behind. Uploads fail
+/// immediately against a mock session so only local work is measured.
+- (BugSplat *)launchInstanceWithPendingReport:(NSData *)pendingReport
+{
+    MockCrashReporter *crashReporter = [[MockCrashReporter alloc] init];
+    crashReporter.hasPendingReport = YES;
+    crashReporter.pendingCrashReportData = pendingReport;
+
+    MockBundle *bundle = [[MockBundle alloc] init];
+    [bundle setObject:@"LaunchBenchmark" forInfoDictionaryKey:@"CFBundleName"];
+    [bundle setObject:@"1.0.0" forInfoDictionaryKey:@"CFBundleShortVersionString"];
+    [bundle setObject:@"benchmarkdb" forInfoDictionaryKey:@"BugSplatDatabase"];
+
+    BugSplat *bugSplat = [BugSplat testInstanceWithCrashReporter:crashReporter
+                                                    crashStorage:[[MockCrashStorage alloc] init]
+                                                    userDefaults:[[MockUserDefaults alloc] init]
+                                                          bundle:bundle];
+    [bugSplat setDebuggerAttachedOverride:@NO];
+    bugSplat.autoSubmitCrashReport = YES;
+
+    MockURLSession *session = [[MockURLSession alloc] init];
+    session.nextError = [NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorNotConnectedToInternet userInfo:nil];
+    [bugSplat setUploadServiceForTesting:[[BugSplatUploadService alloc] initWithDatabase:@"benchmarkdb"
+                                                                         applicationName:@"LaunchBenchmark"
+                                                                      applicationVersion:@"1.0.0"
+                                                                              urlSession:session]];
+    return bugSplat;
+}
+
+- (NSData *)liveReport
+{
+    PLCrashReporter *reporter = [[PLCrashReporter alloc] initWithConfiguration:[PLCrashReporterConfig defaultConfiguration]];
+    return [reporter generateLiveReportAndReturnError:nil];
+}
+
+- (void)removeCrashFilesForInstance:(BugSplat *)bugSplat
+{
+    NSString *filename = [bugSplat currentCrashFilename];
+    if (!filename) {
+        return;
+    }
+    NSString *dir = [bugSplat crashesDirectoryPath];
+    for (NSString *ext in @[@"crash", @"meta"]) {
+        [[NSFileManager defaultManager] removeItemAtPath:[[dir stringByAppendingPathComponent:filename] stringByAppendingPathExtension:ext] error:nil];
+    }
+}
+
+/// Calling-thread time of -start with a pending crash, in the default synchronous mode.
+- (void)testPerformance_LaunchWithPendingCrash_Synchronous
+{
+    NSData *report = [self liveReport];
+    [self measureMetrics:@[XCTPerformanceMetric_WallClockTime] automaticallyStartMeasuring:NO forBlock:^{
+        BugSplat *bugSplat = [self launchInstanceWithPendingReport:report];
+        [self startMeasuring];
+        [bugSplat start];
+        [self stopMeasuring];
+        [self removeCrashFilesForInstance:bugSplat];
+    }];
+}
+
+/// Calling-thread time of -start with a pending crash when `startAsynchronously` is set.
+/// Ingestion drains outside the measured region.
+- (void)testPerformance_LaunchWithPendingCrash_Asynchronous
+{
+    NSData *report = [self liveReport];
+    [self measureMetrics:@[XCTPerformanceMetric_WallClockTime] automaticallyStartMeasuring:NO forBlock:^{
+        BugSplat *bugSplat = [self launchInstanceWithPendingReport:report];
+        bugSplat.startAsynchronously = YES;
+        [self startMeasuring];
+        [bugSplat start];
+        [self stopMeasuring];
+        dispatch_sync([bugSplat ingestQueueForTesting], ^{});
+        [self removeCrashFilesForInstance:bugSplat];
+    }];
+}
+
+#pragma mark - Hang persistence
+
+- (void)measureHangPersistenceDeferringFormatting:(BOOL)deferFormatting escalationThreshold:(NSTimeInterval)escalationThreshold
+{
+    BugSplat *bugSplat = [[BugSplat alloc] init];
+    bugSplat.bugSplatDatabase = @"benchmarkdb";
+    bugSplat.deferCrashReportFormatting = deferFormatting;
+    bugSplat.hangReportEscalationThreshold = escalationThreshold;
+    [bugSplat setupHangInfrastructureForTesting];
+    dispatch_queue_t hangQueue = [bugSplat hangQueueForTesting];
+
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < 10; i++) {
+            [bugSplat hangTracker:nil didDetectHangWithDuration:2.0 appState:@"active"];
+            dispatch_sync(hangQueue, ^{});
+            // Recovery deletes the report, as for most detected hangs.
+            [bugSplat hangTrackerDidRecoverFromHang:nil];
+            dispatch_sync(hangQueue, ^{});
+        }
+    }];
+}
+
+/// Detect-and-recover cycle with the report formatted at detection time.
+- (void)testPerformance_HangPersistence_Formatted
+{
+    [self measureHangPersistenceDeferringFormatting:NO escalationThreshold:0];
+}
+
+/// Detect-and-recover cycle with `deferCrashReportFormatting`; the raw report is never formatted.
+- (void)testPerformance_HangPersistence_Deferred
+{
+    [self measureHangPersistenceDeferringFormatting:YES escalationThreshold:0];
+}
+
+/// Detect-and-recover cycle with tiered capture; only the main-thread snapshot is written.
+- (void)testPerformance_HangPersistence_Snapshot
+{
+    [self measureHangPersistenceDeferringFormatting:NO escalationThreshold:60.0];
+}
+
+#pragma mark - Upload preparation
+
+/// Writes a ~4 MB text report into the crashes directory and returns its basename.
+- (NSString *)writeLargeCrashReportForInstance:(BugSplat *)bugSplat
+{
+    NSMutableString *text = [NSMutableString string];
+    for (NSUInteger i = 0; i < 40000; i++) {
+        [text appendFormat:@"%-4lu MyApp  0x%016lx -[MyViewController handleTap:] + %lu\n",
+         (unsigned long)(i % 512), (unsigned long)(0x100000000 + i * 16), (unsigned long)(i % 97)];
+    }
+    NSString *filename = [NSString stringWithFormat:@"%.0f-benchmark", [NSDate timeIntervalSinceReferenceDate]];
+    NSString *path = [[[bugSplat crashesDirectoryPath] stringByAppendingPathComponent:filename] stringByAppendingPathExtension:@"crash"];
+    [[text dataUsingEncoding:NSUTF8StringEncoding] writeToFile:path atomically:YES];
+    return filename;
+}
+
+- (void)measureUploadPreparation:(NSData *(^)(BugSplat *bugSplat, NSString *filename))loadReport
+{
+    BugSplat *bugSplat = [[BugSplat alloc] init];
+    NSString *filename = [self writeLargeCrashReportForInstance:bugSplat];
+    void (^prepare)(void) = ^{
+        @autoreleasepool {
+            NSData *report = loadReport(bugSplat, filename);
+            NSData *zip = [BugSplatZipHelper zipEntries:@[[BugSplatZipEntry entryWithFilename:@"crash.crashlog" data:report]]];
+            XCTAssertNotNil(zip);
+        }
+    };
+    if (@available(macOS 10.15, iOS 13.0, tvOS 13.0, *)) {
+        [self measureWithMetrics:@[[[XCTClockMetric alloc] init], [[XCTMemoryMetric alloc] init]] block:prepare];
+    } else {
+        [self measureBlock:prepare];
+    }
+    [[NSFileManager defaultManager] removeItemAtPath:[[[bugSplat crashesDirectoryPath] stringByAppendingPathComponent:filename]
+                                                      stringByAppendingPathExtension:@"crash"] error:nil];
+}
+
+/// Previous path: read the .crash file, decode it to a string and re-encode it before zipping.
+- (void)testPerformance_UploadPreparation_StringRoundTrip
+{
+    [self measureUploadPreparation:^NSData *(BugSplat *bugSplat, NSString *filename) {
+        NSString *path = [[[bugSplat crashesDirectoryPath] stringByAppendingPathComponent:filename] stringByAppendingPathExtension:@"crash"];
+        NSString *text = [[NSString alloc] initWithData:[NSData dataWithContentsOfFile:path] encoding:NSUTF8StringEncoding];
+        return [text dataUsingEncoding:NSUTF8StringEncoding];
+    }];
+}
+
+/// Current path: the mapped file bytes go straight into the archive.
+- (void)testPerformance_UploadPreparation_MappedBytes
+{
+    [self measureUploadPreparation:^NSData *(BugSplat *bugSplat, NSString *filename) {
+        return [bugSplat crashReportDataForFilename:filename];
+    }];
+}
+
+#pragma mark - Report text formatting
+
+/// A live report of this process while `threadCount` extra threads are parked, so the report
+/// has hundreds of threads as well as every loaded image.
+- (PLCrashReport *)reportWithExtraThreads:(NSUInteger)threadCount
+{
+    dispatch_semaphore_t release = dispatch_semaphore_create(0);
+    dispatch_group_t parked = dispatch_group_create();
+    NSMutableArray<NSThread *> *threads = [NSMutableArray array];
+    for (NSUInteger i = 0; i < threadCount; i++) {
+        dispatch_group_enter(parked);
+        NSThread *thread = [[NSThread alloc] initWithBlock:^{
+            dispatch_group_leave(parked);
+            dispatch_semaphore_wait(release, DISPATCH_TIME_FOREVER);
+        }];
+        [thread start];
+        [threads addObject:thread];
+    }
+    dispatch_group_wait(parked, DISPATCH_TIME_FOREVER);
+
+    NSData *data = [self liveReport];
+    for (NSUInteger i = 0; i < threadCount; i++) {
+        dispatch_semaphore_signal(release);
+    }
+    return [[PLCrashReport alloc] initWithData:data error:nil];
+}
+
+- (void)measureFormattingWithBlock:(void (^)(void))block
+{
+    if (@available(macOS 10.15, iOS 13.0, tvOS 13.0, *)) {
+        [self measureWithMetrics:@[[[XCTClockMetric alloc] init], [[XCTMemoryMetric alloc] init]] block:^{
+            @autoreleasepool {
+                block();
+            }
+        }];
+    } else {
+        [self measureBlock:block];
+    }
+}
+
+- (NSString *)formattingOutputPath
+{
+    return [NSTemporaryDirectory() stringByAppendingPathComponent:@"BugSplatFormattingBenchmark.crash"];
+}
+
+/// Previous path: format into one string, convert it to data and write that out.
+- (void)testPerformance_ReportFormatting_StringFormatter
+{
+    PLCrashReport *report = [self reportWithExtraThreads:300];
+    NSString *path = [self formattingOutputPath];
+    [self measureFormattingWithBlock:^{
+        NSString *text = [PLCrashReportTextFormatter stringValueForCrashReport:report withTextFormat:PLCrashReportTextFormatiOS];
+        [[text dataUsingEncoding:NSUTF8StringEncoding] writeToFile:path atomically:YES];
+    }];
+    [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+}
+
+/// Current path: stream the text into a buffered file sink.
+- (void)testPerformance_ReportFormatting_StreamingWriter
+{
+    PLCrashReport *report = [self reportWithExtraThreads:300];
+    NSString *path = [self formattingOutputPath];
+    [self measureFormattingWithBlock:^{
+        [BugSplatCrashReportTextWriter writeCrashReport:report toFile:path];
+    }];
+    [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+}
+
+#pragma mark - Hang watchdog
+
+- (void)hangTracker:(BugSplatHangTracker *)tracker didDetectHangWithDuration:(NSTimeInterval)duration appState:(NSString *)appState
+{
+}
+
+- (void)hangTrackerDidRecoverFromHang:(BugSplatHangTracker *)tracker
+{
+}
+
+/// Run a ping-mode tracker over an idle, responsive main thread; measures process CPU time
+/// and logs how often the watchdog woke up.
+- (void)measureIdleWatchdogWithAdaptivePolling:(BOOL)adaptivePolling
+{
+    __block uint64_t wakeups = 0;
+    __block NSUInteger runs = 0;
+    XCTMeasureOptions *options = [XCTMeasureOptions defaultOptions];
+    options.iterationCount = 3;
+    [self measureWithMetrics:@[ [[XCTCPUMetric alloc] init], [[XCTClockMetric alloc] init] ] options:options block:^{
+        BugSplatHangTracker *tracker = [[BugSplatHangTracker alloc] initWithThresholdSeconds:2.0
+                                                                                    delegate:self
+                                                                      isDebuggerAttachedBlock:nil
+                                                                            isAppActiveBlock:nil];
+        tracker.adaptivePolling = adaptivePolling;
+        [tracker start];
+        [[NSRunLoop mainRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:kIdleWatchdogSeconds]];
+        [tracker stop];
+        wakeups += tracker.pollCount;
+        runs++;
+    }];
+    NSLog(@"Idle watchdog (%@): %.1f wakeups/s", adaptivePolling ? @"adaptive" : @"fixed",
+          (double)wakeups / (runs * kIdleWatchdogSeconds));
+}
+
+/// Baseline: poll every threshold / 5 regardless of how the main thread responds.
+- (void)testPerformance_IdleWatchdog_FixedInterval
+{
+    [self measureIdleWatchdogWithAdaptivePolling:NO];
+}
+
+/// Current path: back off to threshold / 2 while pings return quickly, with timer tolerance.
+- (void)testPerformance_IdleWatchdog_Adaptive
+{
+    [self measureIdleWatchdogWithAdaptivePolling:YES];
+}
+
+#pragma mark - Hang detection accuracy
+
+/// Play the default stall schedule (about 20 s) against one tracker mode and log detection
+/// latency, false positive / negative rates and watchdog overhead. Misses and false alarms
+/// are what this reports, not what it fails on; it only checks the tracker detected anything.
+- (void)runHangBenchmarkWithHeartbeat:(BOOL)usesHeartbeat adaptivePolling:(BOOL)adaptivePolling
+{
+    BugSplatHangBenchmark *benchmark = [[BugSplatHangBenchmark alloc] initWithConfiguration:[[BugSplatHangBenchmarkConfiguration alloc] init]];
+    benchmark.usesHeartbeat = usesHeartbeat;
+    benchmark.adaptivePolling = adaptivePolling;
+    BugSplatHangBenchmarkResult *result = [benchmark run];
+    NSLog(@"Hang detection (%@): %@", usesHeartbeat ? @"heartbeat" : (adaptivePolling ? @"ping, adaptive" : @"ping, fixed"),
+          [result summary]);
+    XCTAssertGreaterThan(result.truePositives, 0u);
+}
+
+/// Baseline: ping every threshold / 5.
+- (void)testHangBenchmark_PingFixedInterval
+{
+    [self runHangBenchmarkWithHeartbeat:NO adaptivePolling:NO];
+}
+
+/// Ping with adaptive back-off; detection can lag by up to the longer poll interval.
+- (void)testHangBenchmark_PingAdaptive
+{
+    [self runHangBenchmarkWithHeartbeat:NO adaptivePolling:YES];
+}
+
+/// Heartbeat read at the moment a stall could first reach the threshold.
+- (void)testHangBenchmark_Heartbeat
+{
+    [self runHangBenchmarkWithHeartbeat:YES adaptivePolling:YES];
+}
+
+#pragma mark - Resource sampling
+
+/// Baseline: read only the memory footprint, as the launch state sampler does.
+- (void)testPerformance_ResourceSample_FootprintOnly
+{
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < kBenchmarkIterations; i++) {
+            task_vm_info_data_t info;
+            mach_msg_type_number_t count = TASK_VM_INFO_COUNT;
+            task_info(mach_task_self(), TASK_VM_INFO, (task_info_t)&info, &count);
+        }
+    }];
+}
+
+/// Current path: a full sample (footprint, CPU time, threads, descriptors) recorded into a
+/// mapped ring, as the watchdog thread takes it every few seconds. Logs the cost per sample.
+- (void)testPerformance_ResourceSample_Full
+{
+    NSString *path = [NSTemporaryDirectory() stringByAppendingPathComponent:@"BugSplatBenchmark.resources"];
+    BugSplatResourceRingFile *file = [[BugSplatResourceRingFile alloc] initWithPath:path capacity:64];
+    [self measureBlock:^{
+        CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+        for (NSUInteger i = 0; i < kBenchmarkIterations; i++) {
+            [file recordCurrentUsage];
+        }
+        NSLog(@"Resource sample: %.1f us each", (CFAbsoluteTimeGetCurrent() - start) * 1e6 / kBenchmarkIterations);
+    }];
+    file = nil;
+    [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+}
+
+#pragma mark - Report size
+
+/// Not a timing benchmark: logs and checks the text size of a live report with 300 extra
+/// threads, full and slimmed, so size regressions show up in the test log.
+- (void)testReportSize_Slimmed
+{
+    PLCrashReport *report = [self reportWithExtraThreads:300];
+    NSData *full = [BugSplatCrashReportTextWriter dataForCrashReport:report];
+    NSData *slim = [BugSplatCrashReportTextWriter dataForCrashReport:report
+                                                             options:[BugSplatCrashReportTextOptions slimOptionsWithFrameLimit:10]];
+
+    NSLog(@"Report text size: full %lu bytes, slimmed %lu bytes (%.0f%%), %lu threads, %lu images",
+          (unsigned long)full.length, (unsigned long)slim.length, 100.0 * slim.length / MAX(full.length, 1u),
+          (unsigned long)report.threads.count, (unsigned long)report.images.count);
+    XCTAssertLessThan(slim.length, full.length);
+}
+
+@end
@@ -0,0 +1,266 @@
+//
+//  BugSplatResourceRingTests.m
+//  BugSplatTests
+//
+//  Tests for resource sampling: the sample ring itself and its CSV form, the
+//  mapped file it lives in, sampling the current process, and BugSplat
+//  attaching the previous session's samples to the report of how it ended.
+//
+//  Copyright © BugSplat, LLC. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+
+#import <BugSplat/BugSplat.h>
+#import "BugSplat+Testing.h"
+#import "BugSplatCrashFilesTestCase.h"
+#import "BugSplatAttachment.h"
+#import "BugSplatMetadataCodec.h"
+#import "BugSplatResourceRing.h"
+#import "BugSplatResourceRingFile.h"
+
+#import <fcntl.h>
+#import <unistd.h>
+
+@interface BugSplatResourceRingTests : BugSplatCrashFilesTestCase
+@property (nonatomic, strong) NSMutableData *region;
+@property (nonatomic, copy) NSString *filePath;
+@property (nonatomic, strong, nullable) BugSplat *bugSplat;
+@end
+
+@implementation BugSplatResourceRingTests
+{
+    BugSplatResourceRing _ring;
+}
+
+- (void)setUp
+{
+    [super setUp];
+    self.region = [NSMutableData dataWithLength:BugSplatResourceRingRegionSize(4)];
+    XCTAssertTrue(BugSplatResourceRingFormat(&_ring, self.region.mutableBytes, self.region.length));
+    self.filePath = [NSTemporaryDirectory() stringByAppendingPathComponent:
+                     [NSString stringWithFormat:@"BugSplatResourceRing-%@", [NSUUID UUID].UUIDString]];
+}
+
+- (void)tearDown
+{
+    [[NSFileManager defaultManager] removeItemAtPath:self.filePath error:nil];
+    if (self.bugSplat) {
+        [[NSFileManager defaultManager] removeItemAtPath:[self.bugSplat resourceSamplesPath] error:nil];
+    }
+    self.bugSplat = nil;
+    [super tearDown];
+}
+
+#pragma mark - Helpers
+
+/// The i-th of a steady series: every 5 s, 10 MB more, half a core, one more thread and descriptor.
+- (BugSplatResourceSample)sampleNumber:(uint32_t)i
+{
+    return (BugSplatResourceSample){
+        .timestampMs = 1760000300512ull + i * 5000ull,
+        .footprint = (1400ull + i * 10) * 1024 * 1024,
+        .cpuTimeUs = 1000000ull + i * 2500000ull,
+        .threadCount = 40 + i,
+        .fileDescriptorCount = 60 + i,
+    };
+}
+
+- (void)recordSamples:(uint32_t)count
+{
+    for (uint32_t i = 0; i < count; i++) {
+        BugSplatResourceSample sample = [self sampleNumber:i];
+        BugSplatResourceRingRecord(&_ring, &sample);
+    }
+}
+
+- (NSString *)CSVOfRing
+{
+    BugSplatResourceSample samples[8];
+    size_t count = BugSplatResourceRingCopySamples(&_ring, samples, 8);
+    char buffer[1024];
+    size_t length = BugSplatResourceSamplesFormatCSV(samples, count, buffer, sizeof(buffer));
+    return [[NSString alloc] initWithBytes:buffer length:length encoding:NSUTF8StringEncoding];
+}
+
+#pragma mark - Ring
+
+- (void)testRing_EmptyCopiesNothing
+{
+    BugSplatResourceSample samples[4];
+    XCTAssertEqual(BugSplatResourceRingCopySamples(&_ring, samples, 4), 0u);
+}
+
+- (void)testRing_KeepsNewestSamplesOldestFirst
+{
+    [self recordSamples:6];
+
+    BugSplatResourceSample samples[8];
+    XCTAssertEqual(BugSplatResourceRingCopySamples(&_ring, samples, 8), 4u);
+    XCTAssertEqual(samples[0].threadCount, 42u);
+    XCTAssertEqual(samples[3].threadCount, 45u);
+
+    XCTAssertEqual(BugSplatResourceRingCopySamples(&_ring, samples, 2), 2u);
+    XCTAssertEqual(samples[0].threadCount, 44u, @"A short buffer gets the newest samples");
+}
+
+- (void)testRing_SkipsUnpublishedSlot
+{
+    [self recordSamples:4];
+    // As if the writer was interrupted while overwriting the second sample.
+    atomic_store(&_ring.slots[1].sequence, 0);
+
+    BugSplatResourceSample samples[4];
+    XCTAssertEqual(BugSplatResourceRingCopySamples(&_ring, samples, 4), 3u);
+    XCTAssertEqual(samples[0].threadCount, 40u);
+    XCTAssertEqual(samples[1].threadCount, 42u);
+}
+
+- (void)testRing_AttachRejectsOtherRegions
+{
+    BugSplatResourceRing ring;
+    NSMutableData *zeros = [NSMutableData dataWithLength:self.region.length];
+    XCTAssertFalse(BugSplatResourceRingAttach(&ring, zeros.mutableBytes, zeros.length));
+    XCTAssertFalse(BugSplatResourceRingAttach(&ring, self.region.mutableBytes, self.region.length - 1),
+                   @"A truncated file does not hold every slot");
+    XCTAssertTrue(BugSplatResourceRingAttach(&ring, self.region.mutableBytes, self.region.length));
+    XCTAssertEqual(ring.capacity, 4u);
+}
+
+#pragma mark - CSV
+
+- (void)testCSV_FormatsSamplesWithCPUFromDeltas
+{
+    [self recordSamples:3];
+    XCTAssertEqualObjects([self CSVOfRing],
+                          @"time,footprint_mb,cpu_percent,threads,fds\n"
+                          @"1760000300.512,1400.0,,40,60\n"
+                          @"1760000305.512,1410.0,50.0,41,61\n"
+                          @"1760000310.512,1420.0,50.0,42,62\n");
+}
+
+- (void)testCSV_WritesOnlyWholeLines
+{
+    BugSplatResourceSample samples[2] = { [self sampleNumber:0], [self sampleNumber:1] };
+    char buffer[80];
+    size_t length = BugSplatResourceSamplesFormatCSV(samples, 2, buffer, sizeof(buffer));
+    XCTAssertEqualObjects(@(buffer), @"time,footprint_mb,cpu_percent,threads,fds\n1760000300.512,1400.0,,40,60\n");
+    XCTAssertEqual(length, strlen(buffer));
+
+    XCTAssertEqual(BugSplatResourceSamplesFormatCSV(samples, 2, buffer, 10), 0u);
+    XCTAssertEqual(buffer[0], '\0');
+}
+
+- (void)testCSV_LeavesCPUEmptyWhenTheClockWentBack
+{
+    BugSplatResourceSample samples[2] = { [self sampleNumber:1], [self sampleNumber:0] };
+    char buffer[256];
+    BugSplatResourceSamplesFormatCSV(samples, 2, buffer, sizeof(buffer));
+    XCTAssertTrue([@(buffer) hasSuffix:@"\n1760000300.512,1400.0,,40,60\n"]);
+}
+
+#pragma mark - File
+
+- (void)testFile_SamplesSurviveReopen
+{
+    @autoreleasepool {
+        BugSplatResourceRingFile *file = [[BugSplatResourceRingFile alloc] initWithPath:self.filePath capacity:8];
+        XCTAssertEqual(file.capacity, 8u);
+        for (uint32_t i = 0; i < 3; i++) {
+            BugSplatResourceSample sample = [self sampleNumber:i];
+            [file recordSample:&sample];
+        }
+    }
+
+    NSString *csv = [[NSString alloc] initWithData:[BugSplatResourceRingFile CSVOfFileAtPath:self.filePath] encoding:NSUTF8StringEncoding];
+    XCTAssertTrue([csv hasSuffix:@"1760000310.512,1420.0,50.0,42,62\n"]);
+
+    BugSplatResourceRingFile *reopened = [[BugSplatResourceRingFile alloc] initWithPath:self.filePath capacity:8];
+    XCTAssertEqualObjects([reopened CSV], [csv dataUsingEncoding:NSUTF8StringEncoding]);
+    [reopened reset];
+    XCTAssertNil([reopened CSV]);
+}
+
+- (void)testFile_OtherCapacityStartsOver
+{
+    @autoreleasepool {
+        BugSplatResourceRingFile *file = [[BugSplatResourceRingFile alloc] initWithPath:self.filePath capacity:8];
+        BugSplatResourceSample sample = [self sampleNumber:0];
+        [file recordSample:&sample];
+    }
+    BugSplatResourceRingFile *file = [[BugSplatResourceRingFile alloc] initWithPath:self.filePath capacity:16];
+    XCTAssertEqual(file.capacity, 16u);
+    XCTAssertNil([file CSV]);
+}
+
+- (void)testFile_MissingFileHasNoCSV
+{
+    XCTAssertNil([BugSplatResourceRingFile CSVOfFileAtPath:self.filePath]);
+}
+
+#pragma mark - Sampling
+
+- (void)testSampleCurrentProcess_ReadsUsage
+{
+    BugSplatResourceSample sample;
+    XCTAssertTrue([BugSplatResourceRingFile sampleCurrentProcess:&sample]);
+    XCTAssertGreaterThan(sample.footprint, 0u);
+    XCTAssertGreaterThan(sample.cpuTimeUs, 0u);
+    XCTAssertGreaterThanOrEqual(sample.threadCount, 1u);
+    XCTAssertEqualWithAccuracy((double)sample.timestampMs / 1000.0, [NSDate date].timeIntervalSince1970, 5.0);
+
+    int fd = open(NSTemporaryDirectory().fileSystemRepresentation, O_RDONLY);
+    XCTAssertGreaterThanOrEqual(fd, 0);
+    BugSplatResourceSample withFile;
+    [BugSplatResourceRingFile sampleCurrentProcess:&withFile];
+    close(fd);
+    XCTAssertGreaterThan(withFile.fileDescriptorCount, 0u, @"Counts at least the descriptor just opened");
+}
+
+#pragma mark - BugSplat
+
+- (void)testOpenResourceSamples_AttachesPreviousSessionToTerminationReport
+{
+    self.bugSplat = [[BugSplat alloc] init];
+    self.bugSplat.enableHangDetection = YES;
+    self.bugSplat.enableResourceSampling = YES;
+    [self snapshotCrashFilesOfBugSplat:self.bugSplat];
+
+    @autoreleasepool {
+        BugSplatResourceRingFile *previous = [[BugSplatResourceRingFile alloc] initWithPath:[self.bugSplat resourceSamplesPath] capacity:64];
+        [previous reset];
+        for (uint32_t i = 0; i < 2; i++) {
+            BugSplatResourceSample sample = [self sampleNumber:i];
+            [previous recordSample:&sample];
+        }
+    }
+    [self.bugSplat openResourceSamples];
+    NSData *expected = [@"time,footprint_mb,cpu_percent,threads,fds\n"
+                        @"1760000300.512,1400.0,,40,60\n"
+                        @"1760000305.512,1410.0,50.0,41,61\n" dataUsingEncoding:NSUTF8StringEncoding];
+    XCTAssertEqualObjects([self.bugSplat previousSessionResources], expected);
+    XCTAssertNil([[self.bugSplat resourceRingFile] CSV], @"This session starts with no samples");
+
+    BugSplatLaunchState state;
+    BugSplatLaunchStateBegin(&state, "1.0", "17.0", 1760000300, 1760000000);
+    XCTAssertTrue([self.bugSplat queueTerminationReportForState:&state termination:BugSplatTerminationOutOfMemory]);
+
+    NSString *attachmentFile = [[[self newCrashFiles] filteredArrayUsingPredicate:
+                                 [NSPredicate predicateWithFormat:@"SELF ENDSWITH '.data'"]] firstObject];
+    XCTAssertNotNil(attachmentFile);
+    NSData *encoded = [NSData dataWithContentsOfFile:[[self.bugSplat crashesDirectoryPath] stringByAppendingPathComponent:attachmentFile]];
+    BugSplatAttachment *attachment = [BugSplatMetadataCodec attachmentWithData:encoded];
+    XCTAssertEqualObjects(attachment.filename, @"BugSplatResources.csv");
+    XCTAssertEqualObjects(attachment.contentType, @"text/csv");
+    XCTAssertEqualObjects(attachment.attachmentData, expected);
+}
+
+- (void)testResourceSampling_NeedsHangDetection
+{
+    self.bugSplat = [[BugSplat alloc] init];
+    self.bugSplat.enableResourceSampling = YES;
+    [self.bugSplat openResourceSamples];
+    XCTAssertNil([self.bugSplat resourceRingFile]);
+}
+
+@end
@@ -511,6 +511,52 @@
     XCTAssertEqual(bytes[1], 'K');
 }
 
+#pragma mark - Synchronous Upload Tests
+
+- (void)testUploadCrashReportSynchronously_ReturnsAfterAllStepsOnMainThread
+{
+    NSData *presignedData = [NSJSONSerialization dataWithJSONObject:@{@"url": @"https://s3.amazonaws.com/bucket/key"} options:0 error:nil];
+    [self.mockSession queueResponseWithData:presignedData
+                                   response:[MockURLSession jsonResponseWithStatusCode:200]
+                                      error:nil];
+    [self.mockSession queueResponseWithData:nil
+                                   response:[MockURLSession responseWithStatusCode:200]
+                                      error:nil];
+    [self.mockSession queueResponseWithData:[@"{}" dataUsingEncoding:NSUTF8StringEncoding]
+                                   response:[MockURLSession jsonResponseWithStatusCode:200]
+                                      error:nil];
+
+    NSError *error = nil;
+    BOOL uploaded = [self.uploadService uploadCrashReportSynchronously:[@"Crash report content" dataUsingEncoding:NSUTF8StringEncoding]
+                                                         crashFilename:@"crash.crashlog"
+                                                           attachments:nil
+                                                              metadata:nil
+                                                               timeout:5.0
+                                                                 error:&error];
+    XCTAssertTrue(uploaded);
+    XCTAssertNil(error);
+    XCTAssertEqual(self.mockSession.requestCount, 3u);
+}
+
+- (void)testUploadCrashReportSynchronously_GivesUpAtTimeout
+{
+    // Responses arrive on the main queue, which the call blocks until it times out
+    self.mockSession.completeSynchronously = NO;
+
+    NSError *error = nil;
+    NSDate *began = [NSDate date];
+    BOOL uploaded = [self.uploadService uploadCrashReportSynchronously:[@"Crash report content" dataUsingEncoding:NSUTF8StringEncoding]
+                                                         crashFilename:@"crash.crashlog"
+                                                           attachments:nil
+                                                              metadata:nil
+                                                               timeout:0.2
+                                                                 error:&error];
+    XCTAssertFalse(uploaded);
+    XCTAssertEqualObjects(error.domain, @"com.bugsplat.upload");
+    XCTAssertEqual(error.code, 6, @"Timed out error code is 6");
+    XCTAssertLessThan(-began.timeIntervalSinceNow, 2.0);
+}
+
 #pragma mark - Cancel Tests
 
 - (void)testCancelUpload_CancelsCurrentTask
@@ -0,0 +1,284 @@
+//
+//  BugSplatWatchdogTests.m
+//  BugSplatTests
+//
+//  Tests for the multi-target watchdog: per-target stall detection and recovery
+//  driven through its poll method with manual ping dispatchers, and BugSplat
+//  persisting and discarding reports for a stalled target.
+//
+//  Copyright © BugSplat, LLC. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+#import <pthread.h>
+
+#import <BugSplat/BugSplat.h>
+#import "BugSplat+Testing.h"
+#import "BugSplatMetadataCodec.h"
+#import "BugSplatWatchdog.h"
+
+/// Private testing surface implemented in BugSplatWatchdog.m.
+@interface BugSplatWatchdog (Testing)
+- (instancetype)initWithDelegate:(id<BugSplatWatchdogDelegate>)delegate
+          isDebuggerAttachedBlock:(BOOL(^)(void))isDebuggerAttachedBlock
+                     startsThread:(BOOL)startsThread;
+- (NSTimeInterval)_pollAtTime:(uint64_t)now
+          actualSleepDuration:(NSTimeInterval)actualSleep
+        expectedSleepDuration:(NSTimeInterval)expectedSleep;
+@end
+
+static const uint64_t kSecond = NSEC_PER_SEC;
+
+
+@interface BugSplatWatchdogTests : XCTestCase <BugSplatWatchdogDelegate>
+@property (nonatomic, strong) BugSplatWatchdog *watchdog;
+@property (nonatomic, assign) BOOL debuggerAttached;
+/// Pings handed to each target's dispatcher and not yet run, by target name.
+@property (nonatomic, strong) NSMutableDictionary<NSString *, NSMutableArray<dispatch_block_t> *> *pendingPings;
+@property (nonatomic, strong) NSMutableArray<NSString *> *events;
+@property (nonatomic, assign) NSTimeInterval lastStallDuration;
+@property (nonatomic, assign) mach_port_t lastStallThread;
+@property (nonatomic, strong, nullable) BugSplat *bugSplat;
+@end
+
+@implementation BugSplatWatchdogTests
+
+- (void)setUp
+{
+    [super setUp];
+    self.pendingPings = [NSMutableDictionary dictionary];
+    self.events = [NSMutableArray array];
+    __weak __typeof(self) weakSelf = self;
+    self.watchdog = [[BugSplatWatchdog alloc] initWithDelegate:self
+                                        isDebuggerAttachedBlock:^BOOL { return weakSelf.debuggerAttached; }
+                                                   startsThread:NO];
+}
+
+- (void)tearDown
+{
+    if (self.bugSplat) {
+        NSString *dir = [self.bugSplat crashesDirectoryPath];
+        for (NSString *file in [[NSFileManager defaultManager] contentsOfDirectoryAtPath:dir error:nil]) {
+            if ([file containsString:@"-hang"]) {
+                [[NSFileManager defaultManager] removeItemAtPath:[dir stringByAppendingPathComponent:file] error:nil];
+            }
+        }
+    }
+    self.bugSplat = nil;
+    [super tearDown];
+}
+
+#pragma mark - Helpers
+
+- (void)addTarget:(NSString *)name threshold:(NSTimeInterval)threshold
+{
+    __weak __typeof(self) weakSelf = self;
+    XCTAssertTrue([self.watchdog addTargetWithName:name threshold:threshold pingDispatcher:^(dispatch_block_t ping) {
+        NSMutableArray<dispatch_block_t> *pings = weakSelf.pendingPings[name] ?: [NSMutableArray array];
+        [pings addObject:ping];
+        weakSelf.pendingPings[name] = pings;
+    }]);
+}
+
+/// Run every ping queued for `name`, as the target itself would.
+- (void)serviceTarget:(NSString *)name
+{
+    NSArray<dispatch_block_t> *pings = [self.pendingPings[name] copy];
+    [self.pendingPings removeObjectForKey:name];
+    for (dispatch_block_t ping in pings) {
+        ping();
+    }
+}
+
+- (NSTimeInterval)pollAt:(uint64_t)now
+{
+    return [self.watchdog _pollAtTime:now actualSleepDuration:0.2 expectedSleepDuration:0.2];
+}
+
+#pragma mark - BugSplatWatchdogDelegate
+
+- (void)watchdog:(BugSplatWatchdog *)watchdog
+      targetNamed:(NSString *)name
+didStallWithDuration:(NSTimeInterval)duration
+           thread:(mach_port_t)thread
+{
+    [self.events addObject:[@"stall " stringByAppendingString:name]];
+    self.lastStallDuration = duration;
+    self.lastStallThread = thread;
+}
+
+- (void)watchdog:(BugSplatWatchdog *)watchdog targetNamedDidRecover:(NSString *)name
+{
+    [self.events addObject:[@"recover " stringByAppendingString:name]];
+}
+
+#pragma mark - Registry
+
+- (void)testDuplicateName_IsRejected
+{
+    [self addTarget:@"db" threshold:1.0];
+    XCTAssertFalse([self.watchdog addTargetWithName:@"db" threshold:2.0 pingDispatcher:^(dispatch_block_t ping) {}]);
+    XCTAssertEqualObjects(self.watchdog.targetNames, @[ @"db" ]);
+}
+
+- (void)testNoTargets_SleepsUntilWoken
+{
+    XCTAssertEqual([self pollAt:1 * kSecond], -1.0);
+    [self addTarget:@"db" threshold:1.0];
+    [self.watchdog removeTargetWithName:@"db"];
+    XCTAssertEqual(self.watchdog.targetNames.count, 0u);
+    XCTAssertEqual([self pollAt:2 * kSecond], -1.0);
+}
+
+- (void)testStop_ClearsTargetsAndRunning
+{
+    [self addTarget:@"db" threshold:1.0];
+    XCTAssertTrue(self.watchdog.isRunning);
+    [self.watchdog stop];
+    XCTAssertFalse(self.watchdog.isRunning);
+    XCTAssertEqual(self.watchdog.targetNames.count, 0u);
+    XCTAssertEqual([self pollAt:10 * kSecond], -1.0);
+    XCTAssertEqual(self.events.count, 0u);
+
+    [self.watchdog stop];
+    [self addTarget:@"db" threshold:1.0];
+    XCTAssertTrue(self.watchdog.isRunning);
+}
+
+- (void)testSleep_IsUntilTheSoonestTargetIsDue
+{
+    [self addTarget:@"slow" threshold:5.0];
+    [self addTarget:@"fast" threshold:1.0];
+    XCTAssertEqualWithAccuracy([self pollAt:10 * kSecond], 0.2, 0.001, @"Fast target polls at a fifth of its threshold");
+}
+
+#pragma mark - Stalls
+
+- (void)testUnservicedPing_IsReportedOnceWithDuration
+{
+    [self addTarget:@"db" threshold:1.0];
+    [self pollAt:10 * kSecond];
+    XCTAssertEqual(self.pendingPings[@"db"].count, 1u);
+
+    [self pollAt:10 * kSecond + kSecond / 2];
+    XCTAssertEqual(self.events.count, 0u, @"Half the threshold is not a stall");
+
+    [self pollAt:11 * kSecond + kSecond / 5];
+    XCTAssertEqualObjects(self.events, @[ @"stall db" ]);
+    XCTAssertEqualWithAccuracy(self.lastStallDuration, 1.2, 0.001);
+
+    [self pollAt:12 * kSecond];
+    XCTAssertEqual(self.events.count, 1u, @"One report per stall");
+    XCTAssertEqual(self.pendingPings[@"db"].count, 1u, @"No second ping while one is outstanding");
+}
+
+- (void)testStall_NamesTheThreadThatLastServicedAPing
+{
+    [self addTarget:@"worker" threshold:1.0];
+    [self pollAt:10 * kSecond];
+    [self serviceTarget:@"worker"];
+    [self pollAt:10 * kSecond + kSecond / 5];
+    [self pollAt:12 * kSecond];
+    XCTAssertEqualObjects(self.events, @[ @"stall worker" ]);
+    XCTAssertEqual(self.lastStallThread, pthread_mach_thread_np(pthread_self()));
+}
+
+- (void)testStall_OfTargetNotRecordingThreadsNamesNoThread
+{
+    __weak __typeof(self) weakSelf = self;
+    XCTAssertTrue([self.watchdog addTargetWithName:@"queue" threshold:1.0 recordsThread:NO pingDispatcher:^(dispatch_block_t ping) {
+        NSMutableArray<dispatch_block_t> *pings = weakSelf.pendingPings[@"queue"] ?: [NSMutableArray array];
+        [pings addObject:ping];
+        weakSelf.pendingPings[@"queue"] = pings;
+    }]);
+    [self pollAt:10 * kSecond];
+    [self serviceTarget:@"queue"];
+    [self pollAt:10 * kSecond + kSecond / 5];
+    [self pollAt:12 * kSecond];
+    XCTAssertEqualObjects(self.events, @[ @"stall queue" ]);
+    XCTAssertEqual(self.lastStallThread, (mach_port_t)MACH_PORT_NULL, @"The report falls back to all threads");
+}
+
+- (void)testServicedPing_RecoversAndRearms
+{
+    [self addTarget:@"db" threshold:1.0];
+    [self pollAt:10 * kSecond];
+    [self pollAt:12 * kSecond];
+    [self serviceTarget:@"db"];
+    [self pollAt:12 * kSecond + kSecond / 5];
+    XCTAssertEqualObjects(self.events, (@[ @"stall db", @"recover db" ]));
+
+    // A fresh ping went out with the recovery poll; a second stall is reported again.
+    [self pollAt:14 * kSecond];
+    XCTAssertEqualObjects(self.events.lastObject, @"stall db");
+}
+
+- (void)testTargets_AreIndependent
+{
+    [self addTarget:@"db" threshold:1.0];
+    [self addTarget:@"net" threshold:1.0];
+    [self pollAt:10 * kSecond];
+    [self serviceTarget:@"net"];
+    [self pollAt:10 * kSecond + kSecond / 2];
+    [self serviceTarget:@"net"];
+    [self pollAt:11 * kSecond + kSecond / 2];
+    XCTAssertEqualObjects(self.events, @[ @"stall db" ]);
+}
+
+- (void)testOversleep_IsNotReportedAsStall
+{
+    [self addTarget:@"db" threshold:1.0];
+    [self pollAt:10 * kSecond];
+    // The whole process was suspended for a minute between polls.
+    [self.watchdog _pollAtTime:70 * kSecond actualSleepDuration:60.0 expectedSleepDuration:0.2];
+    XCTAssertEqual(self.events.count, 0u);
+
+    [self pollAt:71 * kSecond + kSecond / 5];
+    XCTAssertEqualObjects(self.events, @[ @"stall db" ], @"The stall is timed from the end of the suspension");
+    XCTAssertEqualWithAccuracy(self.lastStallDuration, 1.2, 0.001);
+}
+
+- (void)testDebuggerAttached_SuppressesReports
+{
+    self.debuggerAttached = YES;
+    [self addTarget:@"db" threshold:1.0];
+    [self pollAt:10 * kSecond];
+    [self pollAt:15 * kSecond];
+    XCTAssertEqual(self.events.count, 0u);
+}
+
+- (void)testRemovedTarget_IsNotReported
+{
+    [self addTarget:@"db" threshold:1.0];
+    [self pollAt:10 * kSecond];
+    [self.watchdog removeTargetWithName:@"db"];
+    [self pollAt:15 * kSecond];
+    XCTAssertEqual(self.events.count, 0u);
+}
+
+#pragma mark - BugSplat integration
+
+- (void)testTargetStall_PersistsReportNamingTargetAndRecoveryRemovesIt
+{
+    self.bugSplat = [[BugSplat alloc] init];
+    self.bugSplat.bugSplatDatabase = @"watchdogdb";
+    [self.bugSplat setupHangInfrastructureForTesting];
+
+    [self.bugSplat watchdog:self.watchdog targetNamed:@"db" didStallWithDuration:2.5 thread:pthread_mach_thread_np(pthread_self())];
+    NSString *filename = [self.bugSplat hangFilenameForTargetNamed:@"db"];
+    XCTAssertNotNil(filename);
+    XCTAssertNil([self.bugSplat currentHangFilename], @"Target hangs do not touch the main-thread report");
+
+    NSString *basePath = [[self.bugSplat crashesDirectoryPath] stringByAppendingPathComponent:filename];
+    NSString *crashPath = [basePath stringByAppendingPathExtension:@"crash"];
+    NSString *crashText = [NSString stringWithContentsOfFile:crashPath encoding:NSUTF8StringEncoding error:nil];
+    XCTAssertTrue([crashText containsString:@"db unresponsive for 2500 ms"], @"%@", crashText);
+    NSDictionary *meta = [BugSplatMetadataCodec metadataWithContentsOfFile:[basePath stringByAppendingPathExtension:@"meta"]];
+    XCTAssertEqualObjects(meta[@"attributes"][@"bugsplat-hang-target"], @"db");
+
+    [self.bugSplat watchdog:self.watchdog targetNamedDidRecover:@"db"];
+    XCTAssertNil([self.bugSplat hangFilenameForTargetNamed:@"db"]);
+    XCTAssertFalse([[NSFileManager defaultManager] fileExistsAtPath:crashPath]);
+}
+
+@end
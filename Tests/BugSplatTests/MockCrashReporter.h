@@ -47,11 +47,21 @@ NS_ASSUME_NONNULL_BEGIN
  */
 @property (nonatomic, readonly) BOOL wasPurged;
 
+/**
+ * Called when the pending report is purged, before it is cleared.
+ */
+@property (nonatomic, copy, nullable) void (^purgeHandler)(void);
+
 /**
  * Custom data set on the crash reporter.
  */
 @property (nonatomic, strong, nullable) NSData *customData;
 
+/**
+ * Number of times customData has been set.
+ */
+@property (atomic, readonly) NSUInteger customDataUpdateCount;
+
 /**
  * Reset the mock state.
  */
@@ -10,6 +10,7 @@
 @interface MockCrashReporter ()
 @property (nonatomic, assign) BOOL wasEnabled;
 @property (nonatomic, assign) BOOL wasPurged;
+@property (atomic, assign) NSUInteger customDataUpdateCount;
 @end
 
 @implementation MockCrashReporter
@@ -31,9 +32,17 @@
     self.pendingCrashReportData = nil;
     self.loadError = nil;
     self.enableError = nil;
-    self.customData = nil;
+    _customData = nil;
+    self.customDataUpdateCount = 0;
     self.wasEnabled = NO;
     self.wasPurged = NO;
+    self.purgeHandler = nil;
+}
+
+- (void)setCustomData:(NSData *)customData
+{
+    _customData = customData;
+    self.customDataUpdateCount++;
 }
 
 #pragma mark - BugSplatCrashReporterProtocol
@@ -56,6 +65,9 @@
 
 - (void)purgePendingCrashReport
 {
+    if (self.purgeHandler) {
+        self.purgeHandler();
+    }
     self.wasPurged = YES;
     self.hasPendingReport = NO;
     self.pendingCrashReportData = nil;
@@ -57,4 +57,18 @@
     self.storage[defaultName] = @(value);
 }
 
+- (NSInteger)integerForKey:(NSString *)defaultName
+{
+    id value = self.storage[defaultName];
+    if ([value isKindOfClass:[NSNumber class]]) {
+        return [value integerValue];
+    }
+    return 0;
+}
+
+- (void)setInteger:(NSInteger)value forKey:(NSString *)defaultName
+{
+    self.storage[defaultName] = @(value);
+}
+
 @end